@@ -6,6 +6,8 @@
  */
 
 #include "admin.h"
+#include "admin_cache.h"
+#include "game_state.h"
 #include "../db_manager.h"
 
 #include <stdio.h>
@@ -13,6 +15,7 @@
 #include <string.h>
 #include <stdarg.h>
 #include <ctype.h>
+#include <time.h>
 #include <libpq-fe.h>
 
 /*
@@ -26,6 +29,11 @@ static int         g_adminSocket = -1;
 static struct sockaddr_in g_qagameAddr;
 static bool        g_qagameAddrSet = false;
 
+/* Game state mirror, see Admin_HandleGameState() */
+static AdminGameState g_gameState;
+static uint16_t    g_gameStateSeq;
+static bool        g_gameStateSeqValid = false;
+
 /* Forward declarations */
 extern int getAdminSocket(void);
 void Admin_SetQagameAddr(struct sockaddr_in *addr);
@@ -118,6 +126,8 @@ bool Admin_Init(void) {
 
     /* Clear player state */
     memset(g_players, 0, sizeof(g_players));
+    memset(&g_gameState, 0, sizeof(g_gameState));
+    g_gameStateSeqValid = false;
 
     /* Database connection is already handled by db_manager */
     if (!DB_IsConnected()) {
@@ -131,6 +141,14 @@ bool Admin_Init(void) {
     printf("[ADMIN] Admin system initialized with %d commands\n",
            (int)(sizeof(g_commands) / sizeof(g_commands[0]) - 1));
 
+    if (sizeof(g_commands) / sizeof(g_commands[0]) - 1 > ADMIN_CACHE_MAX_COMMANDS) {
+        printf("[ADMIN] Warning: overrides of commands past the first %d are ignored\n",
+               ADMIN_CACHE_MAX_COMMANDS);
+    }
+
+    /* Levels, overrides, bans and mutes are checked in memory */
+    AdminCache_Init();
+
     return true;
 }
 
@@ -152,6 +170,9 @@ void Admin_Shutdown(void) {
     if (!g_initialized) return;
 
     memset(g_players, 0, sizeof(g_players));
+    memset(&g_gameState, 0, sizeof(g_gameState));
+    g_gameStateSeqValid = false;
+    AdminCache_Shutdown();
     g_initialized = false;
 
     printf("[ADMIN] Admin system shutdown\n");
@@ -170,32 +191,11 @@ static const AdminCommand* findCommand(const char *name) {
 }
 
 /*
- * Get player level from database
+ * Registry index of a command, -1 if unknown
  */
-static int getPlayerLevel(const char *guid) {
-    if (!DB_IsConnected() || !guid || !guid[0]) {
-        return ADMIN_LEVEL_GUEST;
-    }
-
-    PGconn *conn = DB_GetConnection();
-    if (!conn) return ADMIN_LEVEL_GUEST;
-
-    const char *query =
-        "SELECT COALESCE(l.level, 0) "
-        "FROM admin_players p "
-        "JOIN admin_levels l ON p.level_id = l.id "
-        "WHERE p.guid = $1";
-
-    const char *params[1] = { guid };
-    PGresult *res = PQexecParams(conn, query, 1, NULL, params, NULL, NULL, 0);
-
-    int level = ADMIN_LEVEL_GUEST;
-    if (PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) > 0) {
-        level = atoi(PQgetvalue(res, 0, 0));
-    }
-
-    PQclear(res);
-    return level;
+int Admin_CommandIndex(const char *name) {
+    const AdminCommand *cmd = name ? findCommand(name) : NULL;
+    return cmd ? (int)(cmd - g_commands) : -1;
 }
 
 /*
@@ -205,33 +205,13 @@ bool Admin_HasPermission(const char *guid, const char *cmdName) {
     const AdminCommand *cmd = findCommand(cmdName);
     if (!cmd) return false;
 
-    /* Get player level */
-    int playerLevel = getPlayerLevel(guid);
-
-    /* Check for per-player override in database */
-    if (DB_IsConnected()) {
-        PGconn *conn = DB_GetConnection();
-        if (conn) {
-            const char *query =
-                "SELECT pp.granted FROM admin_player_permissions pp "
-                "JOIN admin_players p ON pp.player_id = p.id "
-                "JOIN admin_commands c ON pp.command_id = c.id "
-                "WHERE p.guid = $1 AND c.name = $2";
-
-            const char *params[2] = { guid, cmdName };
-            PGresult *res = PQexecParams(conn, query, 2, NULL, params, NULL, NULL, 0);
-
-            if (PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) > 0) {
-                bool granted = PQgetvalue(res, 0, 0)[0] == 't';
-                PQclear(res);
-                return granted;
-            }
-            PQclear(res);
-        }
+    /* A per-player override wins over the level */
+    bool granted;
+    if (AdminCache_GetOverride(guid, (int)(cmd - g_commands), &granted)) {
+        return granted;
     }
 
-    /* Fall back to level check */
-    return playerLevel >= cmd->minLevel;
+    return AdminCache_GetLevel(guid) >= cmd->minLevel;
 }
 
 /*
@@ -271,7 +251,7 @@ void Admin_HandleCommand(int clientSlot, const char *guid, const char *name,
     player->name[ADMIN_MAX_NAME_LEN] = '\0';
     Admin_StripColors(name, player->cleanName, ADMIN_MAX_NAME_LEN);
     Admin_ToLower(player->cleanName);
-    player->level = getPlayerLevel(guid);
+    player->level = AdminCache_GetLevel(guid);
 
     /* Update database (player record, alias) */
     if (DB_IsConnected()) {
@@ -349,7 +329,7 @@ void Admin_PlayerConnect(int slot, const char *guid, const char *name, uint8_t t
     Admin_ToLower(p->cleanName);
     p->team = team;
     p->connectTime = time(NULL);
-    p->level = getPlayerLevel(guid);
+    p->level = AdminCache_GetLevel(guid);
     p->playerId = -1;
 
     /* Get or create player in database and update alias */
@@ -387,8 +367,10 @@ void Admin_PlayerConnect(int slot, const char *guid, const char *name, uint8_t t
         /* Send kick action to qagame */
         char kickData[512];
         if (banExpires) {
+            char until[32];
+            strftime(until, sizeof(until), "%Y-%m-%d %H:%M", localtime(&banExpires));
             snprintf(kickData, sizeof(kickData), "Banned until %s: %s",
-                     ctime(&banExpires), banReason);
+                     until, banReason);
         } else {
             snprintf(kickData, sizeof(kickData), "Permanently banned: %s", banReason);
         }
@@ -431,6 +413,102 @@ void Admin_PlayerNameChange(int slot, const char *newName) {
     }
 }
 
+/*
+ * Game state pushed by qagame
+ */
+static uint64_t gameStateNowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void requestGameState(void) {
+    uint8_t type = PKT_GAME_STATE_REQUEST;
+    int sock = getAdminSocket();
+
+    if (!g_qagameAddrSet || sock < 0) return;
+    sendto(sock, &type, 1, 0, (struct sockaddr *)&g_qagameAddr, sizeof(g_qagameAddr));
+}
+
+static void applyPlayerRecord(int slot, uint8_t team, const char *guid, const char *name) {
+    AdminPlayer *p = &g_players[slot];
+
+    if (!p->connected || strcmp(p->guid, guid) != 0) {
+        Admin_PlayerConnect(slot, guid, name, team);
+        return;
+    }
+    p->team = team;
+    if (strcmp(p->name, name) != 0) {
+        Admin_PlayerNameChange(slot, name);
+    }
+}
+
+void Admin_HandleGameState(const uint8_t *data, int len) {
+    if (len < 3) return;
+
+    /* qagame numbers every packet and restarts at 0 with each map, so any
+     * other jump means a lost packet (or a restart on our side) */
+    uint16_t seq = GameState_Sequence(data);
+    if (seq != 0 && (!g_gameStateSeqValid || seq != (uint16_t)(g_gameStateSeq + 1))) {
+        printf("[ADMIN] Game state out of sequence (%u), requesting full state\n", seq);
+        requestGameState();
+    }
+    g_gameStateSeq = seq;
+    g_gameStateSeqValid = true;
+
+    GameStateRecord rec;
+    int pos = 0;
+    int result;
+
+    while ((result = GameState_NextRecord(data, len, &pos, &rec)) > 0) {
+        switch (rec.type) {
+            case GAME_STATE_REC_MAP:
+                memcpy(g_gameState.mapname, rec.mapname, sizeof(g_gameState.mapname));
+                break;
+
+            case GAME_STATE_REC_LEVEL:
+                g_gameState.elapsedMs = rec.elapsedMs;
+                g_gameState.timelimitMs = rec.timelimitMs;
+                g_gameState.gamestate = rec.gamestate;
+                g_gameState.round = rec.round;
+                g_gameState.receivedAt = gameStateNowMs();
+                g_gameState.valid = g_gameState.mapname[0] != '\0';
+                break;
+
+            case GAME_STATE_REC_PLAYER:
+                if (rec.slot >= ADMIN_MAX_PLAYERS) {
+                    break;
+                }
+                if (!rec.connected) {
+                    if (g_players[rec.slot].connected) {
+                        Admin_PlayerDisconnect(rec.slot);
+                    }
+                } else {
+                    applyPlayerRecord(rec.slot, rec.team, rec.guid, rec.name);
+                }
+                break;
+        }
+    }
+
+    if (result < 0) {
+        printf("[ADMIN] Malformed game state record %d at offset %d\n", data[pos], pos);
+    }
+}
+
+const AdminGameState* Admin_GetGameState(void) {
+    return &g_gameState;
+}
+
+int Admin_GetElapsedMs(void) {
+    if (!g_gameState.valid) return -1;
+
+    uint64_t elapsed = g_gameState.elapsedMs;
+    if (g_gameState.gamestate == GAME_STATE_PLAYING) {
+        elapsed += gameStateNowMs() - g_gameState.receivedAt;
+    }
+    return elapsed > INT32_MAX ? INT32_MAX : (int)elapsed;
+}
+
 /*
  * Send response to player via qagame
  */
@@ -575,64 +653,12 @@ int Admin_GetPlayerCount(void) {
  * Check ban status
  */
 bool Admin_IsBanned(const char *guid, char *outReason, time_t *outExpires) {
-    if (!DB_IsConnected() || !guid) return false;
-
-    PGconn *conn = DB_GetConnection();
-    if (!conn) return false;
-
-    const char *query =
-        "SELECT b.reason, b.expires_at "
-        "FROM admin_bans b "
-        "JOIN admin_players p ON b.player_id = p.id "
-        "WHERE p.guid = $1 AND b.active = true "
-        "AND (b.expires_at IS NULL OR b.expires_at > NOW()) "
-        "ORDER BY b.issued_at DESC LIMIT 1";
-
-    const char *params[1] = { guid };
-    PGresult *res = PQexecParams(conn, query, 1, NULL, params, NULL, NULL, 0);
-
-    bool banned = false;
-    if (PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) > 0) {
-        banned = true;
-        if (outReason) {
-            strncpy(outReason, PQgetvalue(res, 0, 0), 255);
-        }
-        if (outExpires) {
-            const char *expiresStr = PQgetvalue(res, 0, 1);
-            if (expiresStr && expiresStr[0]) {
-                /* Parse timestamp - simplified */
-                *outExpires = 0;  /* TODO: proper parsing */
-            } else {
-                *outExpires = 0;  /* Permanent */
-            }
-        }
-    }
-
-    PQclear(res);
-    return banned;
+    return AdminCache_IsBanned(guid, outReason, outExpires);
 }
 
 /*
  * Check mute status
  */
 bool Admin_IsMuted(const char *guid) {
-    if (!DB_IsConnected() || !guid) return false;
-
-    PGconn *conn = DB_GetConnection();
-    if (!conn) return false;
-
-    const char *query =
-        "SELECT 1 FROM admin_mutes m "
-        "JOIN admin_players p ON m.player_id = p.id "
-        "WHERE p.guid = $1 AND m.active = true "
-        "AND (m.expires_at IS NULL OR m.expires_at > NOW()) "
-        "LIMIT 1";
-
-    const char *params[1] = { guid };
-    PGresult *res = PQexecParams(conn, query, 1, NULL, params, NULL, NULL, 0);
-
-    bool muted = (PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) > 0);
-    PQclear(res);
-
-    return muted;
+    return AdminCache_IsMuted(guid);
 }
@@ -14,11 +14,7 @@
 #include <stddef.h>
 #include <time.h>
 
-#ifdef _WIN32
-    #include <winsock2.h>
-#else
-    #include <netinet/in.h>
-#endif
+#include <netinet/in.h>
 
 /*
  * Admin Command Packet Types (qagame -> etman-server)
@@ -29,6 +25,26 @@
 #define PKT_ADMIN_ACTION        0x42  /* Action for qagame to execute */
 #define PKT_PLAYER_LIST         0x43  /* Full player list sync */
 #define PKT_PLAYER_UPDATE       0x44  /* Single player connect/disconnect */
+#define PKT_GAME_STATE          0x45  /* Game state delta: <seq:2> then records */
+#define PKT_GAME_STATE_REQUEST  0x46  /* etman-server -> qagame: resend everything */
+
+/*
+ * Game state records (inside PKT_GAME_STATE, multi-byte values big endian)
+ * Must match g_etman.h
+ */
+#define GAME_STATE_REC_MAP      1     /* <len:1><mapname:len> */
+#define GAME_STATE_REC_LEVEL    2     /* <elapsedMs:4><timelimitMs:4><gamestate:1><round:1> */
+#define GAME_STATE_REC_PLAYER   3     /* <slot:1><connected:1>[<team:1><guid:32><nameLen:1><name:nameLen>] */
+
+/* Record sizes including the record type byte */
+#define GAME_STATE_MAP_LEN(nameLen)     (2 + (nameLen))
+#define GAME_STATE_LEVEL_LEN            11
+#define GAME_STATE_LEFT_LEN             3
+#define GAME_STATE_PLAYER_LEN(nameLen)  (4 + ADMIN_GUID_LEN + 1 + (nameLen))
+
+/* g_gamestate values */
+#define GAME_STATE_PLAYING      0
+#define GAME_STATE_INTERMISSION 3
 
 /*
  * Admin Action Types (etman-server -> qagame)
@@ -153,6 +169,19 @@ typedef struct {
 
 #pragma pack(pop)
 
+/*
+ * Mirror of the game state pushed by qagame
+ */
+typedef struct {
+    bool     valid;                         /* Map and level records received */
+    char     mapname[64];
+    uint32_t elapsedMs;                     /* Level time when the record arrived */
+    uint32_t timelimitMs;                   /* 0 = no limit */
+    uint8_t  gamestate;                     /* GAME_STATE_* */
+    uint8_t  round;
+    uint64_t receivedAt;                    /* Monotonic ms of the level record */
+} AdminGameState;
+
 /*
  * API Functions
  */
@@ -223,6 +252,27 @@ void Admin_SendResponse(int slot, const char *fmt, ...);
  */
 void Admin_SendAction(uint8_t action, uint8_t targetSlot, const char *data);
 
+/**
+ * Apply a PKT_GAME_STATE packet to the mirrored game state and roster.
+ * Asks qagame for everything again when a packet was lost.
+ * @param data Packet including the type byte
+ * @param len Packet length
+ */
+void Admin_HandleGameState(const uint8_t *data, int len);
+
+/**
+ * Mirrored game state.
+ * @return State as last pushed by qagame (valid is false until it arrives)
+ */
+const AdminGameState* Admin_GetGameState(void);
+
+/**
+ * Current level time, extrapolated from the last level record while the
+ * round is being played.
+ * @return Elapsed milliseconds, or -1 if no state was received yet
+ */
+int Admin_GetElapsedMs(void);
+
 /**
  * Set the qagame address for sending responses.
  * Called by main.c when receiving admin commands.
@@ -233,12 +283,20 @@ void Admin_SetQagameAddr(struct sockaddr_in *addr);
 /**
  * Check if player has permission for a command.
  * Checks both level permissions and per-player overrides.
+ * Answered from the admin cache, never touches the database.
  * @param guid Player GUID
  * @param cmdName Command name
  * @return true if allowed
  */
 bool Admin_HasPermission(const char *guid, const char *cmdName);
 
+/**
+ * Look up a command in the registry.
+ * @param name Command name
+ * @return Registry index, or -1 if unknown
+ */
+int Admin_CommandIndex(const char *name);
+
 /**
  * Get player by slot number.
  * @param slot Player slot
@@ -0,0 +1,411 @@
+/**
+ * @file admin_cache.c
+ * @brief In-memory admin levels, permission overrides, bans and mutes
+ */
+
+#include "admin_cache.h"
+#include "admin.h"
+#include "../db_manager.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libpq-fe.h>
+
+/*
+ * Everything known about one GUID
+ */
+typedef struct AdminCacheEntry_s {
+    char        guid[ADMIN_GUID_LEN + 1];
+    uint32_t    hash;
+    int         level;
+    uint64_t    overrideMask;               /* Commands with a per-player override */
+    uint64_t    grantMask;                  /* Overrides that grant (others revoke) */
+    bool        banned;
+    time_t      banExpires;                 /* 0 = permanent */
+    char        banReason[ADMIN_CACHE_REASON_LEN];
+    bool        muted;
+    time_t      muteExpires;                /* 0 = permanent */
+
+    struct AdminCacheEntry_s *hashNext;
+} AdminCacheEntry;
+
+/*
+ * One complete load of the tables
+ */
+typedef struct {
+    AdminCacheEntry *buckets[ADMIN_CACHE_HASH_BUCKETS];
+    time_t           nextExpiry;            /* Earliest ban/mute expiry, 0 if none */
+    int              players;
+    int              bans;
+    int              mutes;
+    int              overrides;
+} AdminCacheTable;
+
+/*
+ * Module state
+ */
+static struct {
+    AdminCacheTable  table;
+    PGconn          *listener;
+    bool             dirty;                 /* Reload on the next poll */
+    bool             lastFailed;
+    time_t           lastReload;
+    time_t           lastAttempt;
+    time_t           lastListenAttempt;
+    AdminCacheStats  stats;
+} g_admin;
+
+
+/*
+ * Helper: FNV-1a over the GUID
+ */
+static uint32_t hashGuid(const char *guid) {
+    uint32_t h = 2166136261u;
+    for (const char *p = guid; *p; p++) {
+        h = (h ^ (uint8_t)*p) * 16777619u;
+    }
+    return h;
+}
+
+static AdminCacheEntry *findEntry(const AdminCacheTable *t, const char *guid) {
+    if (!guid || !guid[0]) return NULL;
+
+    uint32_t h = hashGuid(guid);
+    for (AdminCacheEntry *e = t->buckets[h % ADMIN_CACHE_HASH_BUCKETS]; e; e = e->hashNext) {
+        if (e->hash == h && strcmp(e->guid, guid) == 0) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Helper: Find or add the entry of a GUID (NULL on allocation failure)
+ */
+static AdminCacheEntry *getEntry(AdminCacheTable *t, const char *guid) {
+    AdminCacheEntry *e = findEntry(t, guid);
+    if (e || !guid || !guid[0]) return e;
+
+    e = calloc(1, sizeof(*e));
+    if (!e) return NULL;
+
+    strncpy(e->guid, guid, ADMIN_GUID_LEN);
+    e->hash = hashGuid(e->guid);
+    e->level = ADMIN_LEVEL_GUEST;
+
+    AdminCacheEntry **bucket = &t->buckets[e->hash % ADMIN_CACHE_HASH_BUCKETS];
+    e->hashNext = *bucket;
+    *bucket = e;
+    t->players++;
+    return e;
+}
+
+static void freeTable(AdminCacheTable *t) {
+    for (int i = 0; i < ADMIN_CACHE_HASH_BUCKETS; i++) {
+        AdminCacheEntry *e = t->buckets[i];
+        while (e) {
+            AdminCacheEntry *next = e->hashNext;
+            free(e);
+            e = next;
+        }
+    }
+    memset(t, 0, sizeof(*t));
+}
+
+static void noteExpiry(AdminCacheTable *t, time_t expires) {
+    if (expires && (!t->nextExpiry || expires < t->nextExpiry)) {
+        t->nextExpiry = expires;
+    }
+}
+
+/*
+ * Helper: Seconds-left column to an absolute expiry time (0 = permanent).
+ * Computed by the database against NOW() so clock skew doesn't matter.
+ */
+static time_t expiryField(PGresult *res, int row, int col, time_t now) {
+    if (PQgetisnull(res, row, col)) return 0;
+    long long left = atoll(PQgetvalue(res, row, col));
+    return now + (time_t)(left > 0 ? left : 1);
+}
+
+static PGresult *queryTuples(PGconn *conn, const char *query) {
+    PGresult *res = PQexec(conn, query);
+    if (PQresultStatus(res) != PGRES_TUPLES_OK) {
+        printf("[ADMIN] Cache load failed: %s", PQresultErrorMessage(res));
+        PQclear(res);
+        return NULL;
+    }
+    return res;
+}
+
+/*
+ * Helper: Read all tables into t. Only GUIDs with something other than
+ * the defaults (guest level, no override, ban or mute) get an entry.
+ */
+static bool loadTable(AdminCacheTable *t) {
+    if (!DB_IsConnected()) return false;
+
+    PGconn *conn = DB_GetConnection();
+    if (!conn) return false;
+
+    time_t now = time(NULL);
+    PGresult *res;
+
+    /* Levels: a player without a level row is a guest */
+    res = queryTuples(conn,
+        "SELECT p.guid, l.level "
+        "FROM admin_players p "
+        "JOIN admin_levels l ON p.level_id = l.id "
+        "WHERE l.level <> 0");
+    if (!res) return false;
+    for (int i = 0; i < PQntuples(res); i++) {
+        AdminCacheEntry *e = getEntry(t, PQgetvalue(res, i, 0));
+        if (e) e->level = atoi(PQgetvalue(res, i, 1));
+    }
+    PQclear(res);
+
+    /* Per-player overrides, keyed by registry index */
+    res = queryTuples(conn,
+        "SELECT p.guid, c.name, pp.granted "
+        "FROM admin_player_permissions pp "
+        "JOIN admin_players p ON pp.player_id = p.id "
+        "JOIN admin_commands c ON pp.command_id = c.id");
+    if (!res) return false;
+    for (int i = 0; i < PQntuples(res); i++) {
+        int cmd = Admin_CommandIndex(PQgetvalue(res, i, 1));
+        if (cmd < 0 || cmd >= ADMIN_CACHE_MAX_COMMANDS) continue;
+
+        AdminCacheEntry *e = getEntry(t, PQgetvalue(res, i, 0));
+        if (!e) continue;
+
+        uint64_t bit = (uint64_t)1 << cmd;
+        e->overrideMask |= bit;
+        if (PQgetvalue(res, i, 2)[0] == 't') {
+            e->grantMask |= bit;
+        } else {
+            e->grantMask &= ~bit;
+        }
+        t->overrides++;
+    }
+    PQclear(res);
+
+    /* Active bans, newest first: the first row of a GUID is the one reported */
+    res = queryTuples(conn,
+        "SELECT p.guid, COALESCE(b.reason, ''), "
+        "CEIL(EXTRACT(EPOCH FROM (b.expires_at - NOW())))::bigint "
+        "FROM admin_bans b "
+        "JOIN admin_players p ON b.player_id = p.id "
+        "WHERE b.active = true "
+        "AND (b.expires_at IS NULL OR b.expires_at > NOW()) "
+        "ORDER BY b.issued_at DESC");
+    if (!res) return false;
+    for (int i = 0; i < PQntuples(res); i++) {
+        AdminCacheEntry *e = getEntry(t, PQgetvalue(res, i, 0));
+        if (!e || e->banned) continue;
+
+        e->banned = true;
+        e->banExpires = expiryField(res, i, 2, now);
+        strncpy(e->banReason, PQgetvalue(res, i, 1), ADMIN_CACHE_REASON_LEN - 1);
+        noteExpiry(t, e->banExpires);
+        t->bans++;
+    }
+    PQclear(res);
+
+    /* Active mutes: the one that lasts longest decides */
+    res = queryTuples(conn,
+        "SELECT p.guid, "
+        "CEIL(EXTRACT(EPOCH FROM (m.expires_at - NOW())))::bigint "
+        "FROM admin_mutes m "
+        "JOIN admin_players p ON m.player_id = p.id "
+        "WHERE m.active = true "
+        "AND (m.expires_at IS NULL OR m.expires_at > NOW())");
+    if (!res) return false;
+    for (int i = 0; i < PQntuples(res); i++) {
+        AdminCacheEntry *e = getEntry(t, PQgetvalue(res, i, 0));
+        if (!e) continue;
+
+        time_t expires = expiryField(res, i, 1, now);
+        if (!e->muted) {
+            e->muted = true;
+            e->muteExpires = expires;
+            t->mutes++;
+        } else if (e->muteExpires && (!expires || expires > e->muteExpires)) {
+            e->muteExpires = expires;
+        }
+    }
+    PQclear(res);
+
+    /* Mutes can only be noted once the longest one per GUID is known */
+    for (int i = 0; i < ADMIN_CACHE_HASH_BUCKETS; i++) {
+        for (AdminCacheEntry *e = t->buckets[i]; e; e = e->hashNext) {
+            if (e->muted) noteExpiry(t, e->muteExpires);
+        }
+    }
+
+    return true;
+}
+
+static uint32_t elapsedUs(const struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (uint32_t)((end.tv_sec - start->tv_sec) * 1000000 +
+                      (end.tv_nsec - start->tv_nsec) / 1000);
+}
+
+
+/*
+ * Public API
+ */
+
+void AdminCache_Init(void) {
+    AdminCache_Shutdown();
+
+    g_admin.listener = DB_OpenListener(ADMIN_CACHE_CHANNEL);
+    g_admin.lastListenAttempt = time(NULL);
+
+    if (AdminCache_Reload()) {
+        printf("[ADMIN] Cache loaded: %d players, %d overrides, %d bans, %d mutes (%u us)%s\n",
+               g_admin.table.players, g_admin.table.overrides,
+               g_admin.table.bans, g_admin.table.mutes, g_admin.stats.lastReloadUs,
+               g_admin.listener ? "" : ", not listening for changes");
+    } else {
+        printf("[ADMIN] Cache not loaded, retrying every %d s\n", ADMIN_CACHE_RETRY_SEC);
+    }
+}
+
+void AdminCache_Shutdown(void) {
+    if (g_admin.listener) {
+        PQfinish(g_admin.listener);
+    }
+    freeTable(&g_admin.table);
+    memset(&g_admin, 0, sizeof(g_admin));
+}
+
+bool AdminCache_Reload(void) {
+    AdminCacheTable fresh;
+    struct timespec start;
+
+    memset(&fresh, 0, sizeof(fresh));
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    g_admin.lastAttempt = time(NULL);
+    if (!loadTable(&fresh)) {
+        freeTable(&fresh);
+        g_admin.lastFailed = true;
+        return false;
+    }
+
+    freeTable(&g_admin.table);
+    g_admin.table = fresh;
+    g_admin.dirty = false;
+    g_admin.lastFailed = false;
+    g_admin.lastReload = g_admin.lastAttempt;
+
+    g_admin.stats.reloads++;
+    g_admin.stats.lastReloadUs = elapsedUs(&start);
+    g_admin.stats.loaded = true;
+    return true;
+}
+
+void AdminCache_Poll(void) {
+    time_t now = time(NULL);
+
+    /* (Re)open the listener; changes made while it was down are unknown */
+    if (!g_admin.listener && now - g_admin.lastListenAttempt >= ADMIN_CACHE_RETRY_SEC) {
+        g_admin.lastListenAttempt = now;
+        if (DB_IsConnected()) {
+            g_admin.listener = DB_OpenListener(ADMIN_CACHE_CHANNEL);
+            if (g_admin.listener) {
+                g_admin.dirty = true;
+            }
+        }
+    }
+
+    if (g_admin.listener) {
+        if (!PQconsumeInput(g_admin.listener) || PQstatus(g_admin.listener) != CONNECTION_OK) {
+            printf("[ADMIN] Cache listener lost: %s", PQerrorMessage(g_admin.listener));
+            PQfinish(g_admin.listener);
+            g_admin.listener = NULL;
+            g_admin.dirty = true;
+        } else {
+            PGnotify *n;
+            while ((n = PQnotifies(g_admin.listener)) != NULL) {
+                g_admin.stats.notifications++;
+                g_admin.dirty = true;
+                PQfreemem(n);
+            }
+        }
+    }
+
+    if (g_admin.table.nextExpiry && now >= g_admin.table.nextExpiry) {
+        g_admin.dirty = true;
+    }
+    if (now - g_admin.lastReload >= ADMIN_CACHE_RELOAD_SEC) {
+        g_admin.dirty = true;
+    }
+
+    if (!g_admin.dirty) return;
+    if (g_admin.lastFailed && now - g_admin.lastAttempt < ADMIN_CACHE_RETRY_SEC) return;
+
+    AdminCache_Reload();
+}
+
+int AdminCache_GetLevel(const char *guid) {
+    g_admin.stats.lookups++;
+    const AdminCacheEntry *e = findEntry(&g_admin.table, guid);
+    return e ? e->level : ADMIN_LEVEL_GUEST;
+}
+
+bool AdminCache_GetOverride(const char *guid, int cmdIndex, bool *outGranted) {
+    if (cmdIndex < 0 || cmdIndex >= ADMIN_CACHE_MAX_COMMANDS) return false;
+
+    g_admin.stats.lookups++;
+    const AdminCacheEntry *e = findEntry(&g_admin.table, guid);
+    uint64_t bit = (uint64_t)1 << cmdIndex;
+    if (!e || !(e->overrideMask & bit)) return false;
+
+    if (outGranted) *outGranted = (e->grantMask & bit) != 0;
+    return true;
+}
+
+bool AdminCache_IsBanned(const char *guid, char *outReason, time_t *outExpires) {
+    g_admin.stats.lookups++;
+    const AdminCacheEntry *e = findEntry(&g_admin.table, guid);
+    if (!e || !e->banned) return false;
+    if (e->banExpires && time(NULL) >= e->banExpires) return false;
+
+    if (outReason) {
+        strncpy(outReason, e->banReason, ADMIN_CACHE_REASON_LEN - 1);
+        outReason[ADMIN_CACHE_REASON_LEN - 1] = '\0';
+    }
+    if (outExpires) *outExpires = e->banExpires;
+    return true;
+}
+
+bool AdminCache_IsMuted(const char *guid) {
+    g_admin.stats.lookups++;
+    const AdminCacheEntry *e = findEntry(&g_admin.table, guid);
+    if (!e || !e->muted) return false;
+    return !e->muteExpires || time(NULL) < e->muteExpires;
+}
+
+void AdminCache_SetLevel(const char *guid, int level) {
+    AdminCacheEntry *e = getEntry(&g_admin.table, guid);
+    if (e) e->level = level;
+}
+
+void AdminCache_ClearBan(const char *guid) {
+    AdminCacheEntry *e = findEntry(&g_admin.table, guid);
+    if (e) e->banned = false;
+}
+
+void AdminCache_GetStats(AdminCacheStats *out) {
+    if (!out) return;
+    *out = g_admin.stats;
+    out->players = g_admin.table.players;
+    out->bans = g_admin.table.bans;
+    out->mutes = g_admin.table.mutes;
+    out->overrides = g_admin.table.overrides;
+    out->listening = g_admin.listener != NULL;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file admin_cache.h
+ * @brief In-memory admin levels, permission overrides, bans and mutes
+ *
+ * Permission checks used to cost two PostgreSQL round trips per !command,
+ * and every connect ran a ban query. The admin tables are small, so the
+ * interesting rows (non-guest levels, per-player overrides, active bans and
+ * mutes) are loaded into a GUID hash table and every check is a lookup.
+ *
+ * The tables are also edited from the web panel. Triggers installed by
+ * sql/admin_schema.sql NOTIFY the ADMIN_CACHE_CHANNEL channel, which is
+ * polled from the worker tick over a dedicated LISTEN connection. A full
+ * reload also happens every ADMIN_CACHE_RELOAD_SEC in case notifications
+ * are missed (listener down, triggers not installed), and when the earliest
+ * loaded ban or mute expires.
+ *
+ * Like the rest of the admin module, this is not re-entrant; callers run
+ * under the worker pool's service lock.
+ */
+
+#ifndef ETMAN_ADMIN_CACHE_H
+#define ETMAN_ADMIN_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+/*
+ * Limits
+ */
+#define ADMIN_CACHE_HASH_BUCKETS    256
+#define ADMIN_CACHE_MAX_COMMANDS    64      /* Override masks are 64 bits wide */
+#define ADMIN_CACHE_REASON_LEN      256
+#define ADMIN_CACHE_RELOAD_SEC      300     /* Safety net for missed notifications */
+#define ADMIN_CACHE_RETRY_SEC       10      /* Reload / listener retry while the DB is down */
+#define ADMIN_CACHE_CHANNEL         "admin_changed"
+
+/*
+ * Cache statistics
+ */
+typedef struct {
+    uint64_t lookups;
+    uint64_t reloads;
+    uint64_t notifications;
+    uint32_t lastReloadUs;
+    int      players;                   /* GUIDs with a level, override, ban or mute */
+    int      bans;
+    int      mutes;
+    int      overrides;
+    bool     loaded;
+    bool     listening;
+} AdminCacheStats;
+
+/**
+ * Load the tables and start listening for changes.
+ * A failed load leaves the cache empty and is retried from AdminCache_Poll().
+ */
+void AdminCache_Init(void);
+
+/**
+ * Drop the tables and close the listener.
+ */
+void AdminCache_Shutdown(void);
+
+/**
+ * Handle pending notifications and scheduled reloads. Never blocks unless
+ * a reload is due. Called from the worker tick.
+ */
+void AdminCache_Poll(void);
+
+/**
+ * Reload everything now.
+ * @return false if the database could not be read (old tables are kept)
+ */
+bool AdminCache_Reload(void);
+
+/**
+ * Admin level of a player.
+ * @return ADMIN_LEVEL_GUEST for unknown GUIDs
+ */
+int AdminCache_GetLevel(const char *guid);
+
+/**
+ * Per-player override for a command.
+ * @param cmdIndex Index into the admin command registry
+ * @param outGranted Receives the override
+ * @return true if the player has an override for the command
+ */
+bool AdminCache_GetOverride(const char *guid, int cmdIndex, bool *outGranted);
+
+/**
+ * Active ban of a player.
+ * @param outReason Buffer of ADMIN_CACHE_REASON_LEN bytes (can be NULL)
+ * @param outExpires Expiry time, 0 for permanent (can be NULL)
+ * @return true if banned
+ */
+bool AdminCache_IsBanned(const char *guid, char *outReason, time_t *outExpires);
+
+/**
+ * Active mute of a player.
+ * @return true if muted
+ */
+bool AdminCache_IsMuted(const char *guid);
+
+/**
+ * Apply a level change made by this process right away, before the
+ * notification round trip.
+ */
+void AdminCache_SetLevel(const char *guid, int level);
+
+/**
+ * Drop a player's ban after this process lifted it.
+ */
+void AdminCache_ClearBan(const char *guid);
+
+/**
+ * Copy current statistics.
+ */
+void AdminCache_GetStats(AdminCacheStats *out);
+
+#endif /* ETMAN_ADMIN_CACHE_H */
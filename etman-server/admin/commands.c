@@ -6,6 +6,7 @@
  */
 
 #include "admin.h"
+#include "admin_cache.h"
 #include "../db_manager.h"
 
 #include <stdio.h>
@@ -168,78 +169,9 @@ static int LoadMapList(char maps[][64], int maxMaps) {
     return mapCount;
 }
 
-/*
- * Helper: Query current map from game server via rcon
- * Sends "rcon <password> currentmap" and parses response
- */
-static int QueryCurrentMap(char *outMap, int maxLen) {
-    int sock;
-    struct sockaddr_in serverAddr;
-    char request[128];
-    char response[512];
-    int len;
-    struct timeval tv;
-
-    /* Create UDP socket */
-    sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-    if (sock < 0) {
-        return 0;
-    }
-
-    /* Set timeout */
-    tv.tv_sec = 1;
-    tv.tv_usec = 0;
-    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-
-    /* Server address */
-    memset(&serverAddr, 0, sizeof(serverAddr));
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_port = htons(27960);
-    serverAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
-
-    /* Build rcon request: \xff\xff\xff\xffrcon <password> currentmap */
-    snprintf(request, sizeof(request), "\xff\xff\xff\xff" "rcon emma01 currentmap");
-
-    /* Send request */
-    if (sendto(sock, request, strlen(request), 0,
-               (struct sockaddr *)&serverAddr, sizeof(serverAddr)) < 0) {
-        close(sock);
-        return 0;
-    }
-
-    /* Receive response */
-    len = recv(sock, response, sizeof(response) - 1, 0);
-    close(sock);
-
-    if (len <= 0) {
-        return 0;
-    }
-    response[len] = '\0';
-
-    /* Response format: \xff\xff\xff\xffprint\n<mapname>\n */
-    char *p = response;
-    /* Skip header */
-    if (len > 4 && memcmp(p, "\xff\xff\xff\xff", 4) == 0) {
-        p += 4;
-    }
-    /* Skip "print\n" */
-    if (strncmp(p, "print\n", 6) == 0) {
-        p += 6;
-    }
-
-    /* Copy map name, trim whitespace */
-    int mapLen = 0;
-    while (*p && *p != '\n' && *p != '\r' && mapLen < maxLen - 1) {
-        outMap[mapLen++] = *p++;
-    }
-    outMap[mapLen] = '\0';
-
-    return mapLen > 0 ? 1 : 0;
-}
-
 /*
  * !nextmap - Show next map in rotation
- * Queries current map via rcon, finds next in maplist.txt
+ * Current map comes from the game state mirror, next from maplist.txt
  */
 void Cmd_NextMap(int slot, AdminPlayer *caller, const char *args) {
     (void)caller;
@@ -253,12 +185,12 @@ void Cmd_NextMap(int slot, AdminPlayer *caller, const char *args) {
         return;
     }
 
-    /* Query current map from game server */
-    char currentMap[64] = "";
-    if (!QueryCurrentMap(currentMap, sizeof(currentMap))) {
-        Admin_SendResponse(slot, "^1Error: Could not query current map from server");
+    const AdminGameState *state = Admin_GetGameState();
+    if (!state->mapname[0]) {
+        Admin_SendResponse(slot, "^1Error: Current map not known yet, try again in a few seconds");
         return;
     }
+    const char *currentMap = state->mapname;
 
     /* Find current map in rotation */
     int currentIndex = -1;
@@ -630,6 +562,7 @@ void Cmd_Unban(int slot, AdminPlayer *caller, const char *args) {
     if (PQresultStatus(res) == PGRES_COMMAND_OK) {
         int affected = atoi(PQcmdTuples(res));
         if (affected > 0) {
+            AdminCache_ClearBan(guid);
             Admin_SendResponse(slot, "^2Unbanned GUID ^7%s", guid);
         } else {
             Admin_SendResponse(slot, "^1No active ban found for GUID ^7%s", guid);
@@ -828,6 +761,7 @@ void Cmd_SetLevel(int slot, AdminPlayer *caller, const char *args) {
 
     if (PQresultStatus(res) == PGRES_COMMAND_OK) {
         targetPlayer->level = level;
+        AdminCache_SetLevel(targetPlayer->guid, level);
         const char *levelNames[] = { "Guest", "Regular", "VIP", "Admin", "Senior Admin", "Owner" };
         Admin_SendResponse(255, "^3%s ^7set level of ^3%s ^7to ^2%d ^7(^3%s^7)",
             caller->name, targetPlayer->name, level, levelNames[level]);
@@ -1142,72 +1076,24 @@ void Cmd_PutBots(int slot, AdminPlayer *caller, const char *args) {
 }
 
 /*
- * Helper: Query server status to get elapsed time
- * Returns elapsed seconds, or -1 on error
- */
-static int QueryElapsedTime(void) {
-    int sock;
-    struct sockaddr_in serverAddr;
-    char response[2048];
-    int len;
-    struct timeval tv;
-
-    sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-    if (sock < 0) return -1;
-
-    tv.tv_sec = 1;
-    tv.tv_usec = 0;
-    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-
-    memset(&serverAddr, 0, sizeof(serverAddr));
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_port = htons(27960);
-    serverAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
-
-    /* Query server status */
-    const char *request = "\xff\xff\xff\xff" "getstatus";
-    if (sendto(sock, request, strlen(request), 0,
-               (struct sockaddr *)&serverAddr, sizeof(serverAddr)) < 0) {
-        close(sock);
-        return -1;
-    }
-
-    len = recv(sock, response, sizeof(response) - 1, 0);
-    close(sock);
-
-    if (len <= 0) return -1;
-    response[len] = '\0';
-
-    /* Look for g_levelStartTime in response */
-    char *p = strstr(response, "g_levelStartTime\\");
-    if (p) {
-        p += 17; /* Skip "g_levelStartTime\" */
-        int startTime = atoi(p);
-
-        /* Also need current server time - look for leveltime or similar */
-        /* Actually getstatus doesn't give us current time directly */
-    }
-
-    /* Fallback: we can't get elapsed time from getstatus easily
-     * Let's just return -1 and handle it in the command */
-    return -1;
-}
-
-/*
- * !timeleft <mm:ss> - Set remaining time on the map
- * Sets timelimit so that remaining time equals specified value
- *
- * Since we can't easily query elapsed time, we use a workaround:
- * We query the server for current timelimit and time remaining via rcon status,
- * but that's complex. For simplicity, we'll just set timelimit to a low value
- * which will cause the map to end approximately when specified.
- *
- * Better approach: Add a C command "settimeleft" that does the calculation server-side.
+ * !timeleft [mm:ss] - Show or set remaining time on the map
+ * Without arguments the remaining time is worked out from the game state
+ * mirror. Setting it goes through the server-side "settimeleft" command.
  */
 void Cmd_TimeLeft(int slot, AdminPlayer *caller, const char *args) {
     if (!args || !args[0]) {
-        Admin_SendResponse(slot, "^1Usage: ^3!timeleft <mm:ss>");
-        Admin_SendResponse(slot, "^7Example: ^3!timeleft 0:30 ^7(30 sec remaining)");
+        const AdminGameState *state = Admin_GetGameState();
+        int elapsed = Admin_GetElapsedMs();
+
+        if (elapsed < 0) {
+            Admin_SendResponse(slot, "^1Map time not known yet, try again in a few seconds");
+        } else if (!state->timelimitMs) {
+            Admin_SendResponse(slot, "^3%s ^7has no time limit", state->mapname);
+        } else {
+            int left = (int)state->timelimitMs > elapsed ? ((int)state->timelimitMs - elapsed) / 1000 : 0;
+            Admin_SendResponse(slot, "^3Time left on %s: ^7%d:%02d", state->mapname, left / 60, left % 60);
+        }
+        Admin_SendResponse(slot, "^7Usage: ^3!timeleft <mm:ss> ^7to change it (e.g. ^3!timeleft 0:30^7)");
         return;
     }
 
@@ -0,0 +1,83 @@
+/**
+ * @file game_state.c
+ * @brief Decoding of the PKT_GAME_STATE records pushed by qagame
+ */
+
+#include "game_state.h"
+
+#include <string.h>
+
+/* Packet header: type, sequence */
+#define GAME_STATE_HEADER_LEN   3
+
+static uint32_t gameStateLong(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/* Copy a length-prefixed string, cut to fit */
+static void gameStateString(char *out, size_t outSize, const uint8_t *p, int len) {
+    int n = len < (int)outSize - 1 ? len : (int)outSize - 1;
+
+    memcpy(out, p, n);
+    out[n] = '\0';
+}
+
+uint16_t GameState_Sequence(const uint8_t *data) {
+    return (uint16_t)((data[1] << 8) | data[2]);
+}
+
+int GameState_NextRecord(const uint8_t *data, int len, int *pos, GameStateRecord *rec) {
+    if (*pos < GAME_STATE_HEADER_LEN) {
+        *pos = GAME_STATE_HEADER_LEN;
+    }
+    if (*pos >= len) {
+        return 0;
+    }
+
+    const uint8_t *p = data + *pos;
+    int left = len - *pos;
+
+    memset(rec, 0, sizeof(*rec));
+    rec->type = p[0];
+
+    switch (rec->type) {
+        case GAME_STATE_REC_MAP:
+            if (left < GAME_STATE_MAP_LEN(0) || left < GAME_STATE_MAP_LEN(p[1])) return -1;
+            gameStateString(rec->mapname, sizeof(rec->mapname), p + 2, p[1]);
+            *pos += GAME_STATE_MAP_LEN(p[1]);
+            return 1;
+
+        case GAME_STATE_REC_LEVEL:
+            if (left < GAME_STATE_LEVEL_LEN) return -1;
+            rec->elapsedMs = gameStateLong(p + 1);
+            rec->timelimitMs = gameStateLong(p + 5);
+            rec->gamestate = p[9];
+            rec->round = p[10];
+            *pos += GAME_STATE_LEVEL_LEN;
+            return 1;
+
+        case GAME_STATE_REC_PLAYER:
+            if (left < GAME_STATE_LEFT_LEN) return -1;
+            rec->slot = p[1];
+            rec->connected = p[2] != 0;
+            if (!rec->connected) {
+                *pos += GAME_STATE_LEFT_LEN;
+                return 1;
+            }
+
+            if (left < GAME_STATE_PLAYER_LEN(0)) return -1;
+            {
+                int nameLen = p[GAME_STATE_PLAYER_LEN(0) - 1];
+
+                if (left < GAME_STATE_PLAYER_LEN(nameLen)) return -1;
+                rec->team = p[3];
+                gameStateString(rec->guid, sizeof(rec->guid), p + 4, ADMIN_GUID_LEN);
+                gameStateString(rec->name, sizeof(rec->name), p + GAME_STATE_PLAYER_LEN(0), nameLen);
+                *pos += GAME_STATE_PLAYER_LEN(nameLen);
+            }
+            return 1;
+
+        default:
+            return -1;
+    }
+}
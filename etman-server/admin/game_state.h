@@ -0,0 +1,54 @@
+/**
+ * @file game_state.h
+ * @brief Decoding of the PKT_GAME_STATE records pushed by qagame
+ *
+ * Kept apart from admin.c, which applies the records, so that the wire
+ * format can be checked without a database or a game server.
+ */
+
+#ifndef ETMAN_GAME_STATE_H
+#define ETMAN_GAME_STATE_H
+
+#include "admin.h"
+
+/*
+ * One decoded record. Only the fields of its type are set.
+ */
+typedef struct {
+    uint8_t  type;                          /* GAME_STATE_REC_* */
+
+    /* GAME_STATE_REC_MAP */
+    char     mapname[64];
+
+    /* GAME_STATE_REC_LEVEL */
+    uint32_t elapsedMs;
+    uint32_t timelimitMs;
+    uint8_t  gamestate;
+    uint8_t  round;
+
+    /* GAME_STATE_REC_PLAYER */
+    uint8_t  slot;
+    bool     connected;
+    uint8_t  team;
+    char     guid[ADMIN_GUID_LEN + 1];
+    char     name[ADMIN_MAX_NAME_LEN + 1];
+} GameStateRecord;
+
+/**
+ * Sequence number of a PKT_GAME_STATE packet.
+ * @param data Packet including the type byte, at least 3 bytes
+ */
+uint16_t GameState_Sequence(const uint8_t *data);
+
+/**
+ * Decode the next record of a PKT_GAME_STATE packet.
+ * Over-long map names and player names are cut to fit the record.
+ * @param data Packet including the type byte
+ * @param len Packet length
+ * @param pos Read position, start with 0; moved past the record
+ * @param rec Decoded record
+ * @return 1 for a record, 0 at the end of the packet, -1 if the rest is malformed
+ */
+int GameState_NextRecord(const uint8_t *data, int len, int *pos, GameStateRecord *rec);
+
+#endif /* ETMAN_GAME_STATE_H */
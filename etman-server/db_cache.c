@@ -0,0 +1,202 @@
+/**
+ * @file db_cache.c
+ * @brief Read-through cache for hot db_manager queries
+ */
+
+#include "db_cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * One cached result
+ */
+typedef struct DBCacheEntry_s {
+    char                    guid[33];
+    DBCacheKind             kind;
+    char                    key[DB_CACHE_KEY_LEN];
+    uint32_t                hash;
+    bool                    result;
+    time_t                  storedAt;
+    size_t                  size;
+    void                   *data;
+
+    struct DBCacheEntry_s  *hashNext;
+    struct DBCacheEntry_s  *lruPrev;        /* Towards most recently used */
+    struct DBCacheEntry_s  *lruNext;
+} DBCacheEntry;
+
+/*
+ * Module state
+ */
+static struct {
+    DBCacheEntry   *buckets[DB_CACHE_HASH_BUCKETS];
+    DBCacheEntry   *lruHead;                /* Most recently used */
+    DBCacheEntry   *lruTail;                /* Eviction candidate */
+    DBCacheStats    stats;
+} g_cache;
+
+
+/*
+ * Helper: FNV-1a over (guid, kind, key)
+ */
+static uint32_t hashKey(const char *guid, DBCacheKind kind, const char *key) {
+    uint32_t h = 2166136261u;
+    for (const char *p = guid; *p; p++) {
+        h = (h ^ (uint8_t)*p) * 16777619u;
+    }
+    h = (h ^ (uint8_t)kind) * 16777619u;
+    for (const char *p = key; *p; p++) {
+        h = (h ^ (uint8_t)*p) * 16777619u;
+    }
+    return h;
+}
+
+static void lruUnlink(DBCacheEntry *e) {
+    if (e->lruPrev) e->lruPrev->lruNext = e->lruNext;
+    else g_cache.lruHead = e->lruNext;
+    if (e->lruNext) e->lruNext->lruPrev = e->lruPrev;
+    else g_cache.lruTail = e->lruPrev;
+    e->lruPrev = e->lruNext = NULL;
+}
+
+static void lruPushFront(DBCacheEntry *e) {
+    e->lruPrev = NULL;
+    e->lruNext = g_cache.lruHead;
+    if (g_cache.lruHead) g_cache.lruHead->lruPrev = e;
+    g_cache.lruHead = e;
+    if (!g_cache.lruTail) g_cache.lruTail = e;
+}
+
+static DBCacheEntry *findEntry(const char *guid, DBCacheKind kind, const char *key,
+                               uint32_t hash) {
+    DBCacheEntry *e = g_cache.buckets[hash % DB_CACHE_HASH_BUCKETS];
+    for (; e; e = e->hashNext) {
+        if (e->hash == hash && e->kind == kind &&
+            strcmp(e->guid, guid) == 0 && strcmp(e->key, key) == 0) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Helper: Unlink and free an entry
+ */
+static void removeEntry(DBCacheEntry *e) {
+    DBCacheEntry **link = &g_cache.buckets[e->hash % DB_CACHE_HASH_BUCKETS];
+    while (*link && *link != e) {
+        link = &(*link)->hashNext;
+    }
+    if (*link) {
+        *link = e->hashNext;
+    }
+    lruUnlink(e);
+
+    g_cache.stats.entries--;
+    g_cache.stats.bytes -= sizeof(*e) + e->size;
+    free(e->data);
+    free(e);
+}
+
+
+bool DBCache_Lookup(const char *guid, DBCacheKind kind, const char *key,
+                    void *outData, size_t size, bool *outResult) {
+    if (!guid) guid = "";
+    if (!key) key = "";
+
+    uint32_t hash = hashKey(guid, kind, key);
+    DBCacheEntry *e = findEntry(guid, kind, key, hash);
+
+    if (e && time(NULL) - e->storedAt >= DB_CACHE_TTL_SEC) {
+        removeEntry(e);
+        g_cache.stats.expirations++;
+        e = NULL;
+    }
+
+    if (!e || e->size != size) {
+        g_cache.stats.misses++;
+        return false;
+    }
+
+    memcpy(outData, e->data, size);
+    *outResult = e->result;
+
+    lruUnlink(e);
+    lruPushFront(e);
+    g_cache.stats.hits++;
+    return true;
+}
+
+void DBCache_Store(const char *guid, DBCacheKind kind, const char *key,
+                   const void *data, size_t size, bool result) {
+    if (!guid) guid = "";
+    if (!key) key = "";
+    if (strlen(guid) >= sizeof(((DBCacheEntry *)0)->guid) ||
+        strlen(key) >= DB_CACHE_KEY_LEN) {
+        return;     /* Not cacheable, just skip */
+    }
+
+    uint32_t hash = hashKey(guid, kind, key);
+    DBCacheEntry *old = findEntry(guid, kind, key, hash);
+    if (old) {
+        removeEntry(old);
+    }
+
+    while (g_cache.stats.entries >= DB_CACHE_MAX_ENTRIES && g_cache.lruTail) {
+        removeEntry(g_cache.lruTail);
+        g_cache.stats.evictions++;
+    }
+
+    DBCacheEntry *e = calloc(1, sizeof(*e));
+    void *copy = malloc(size ? size : 1);
+    if (!e || !copy) {
+        free(e);
+        free(copy);
+        return;
+    }
+
+    memcpy(copy, data, size);
+    snprintf(e->guid, sizeof(e->guid), "%s", guid);
+    snprintf(e->key, sizeof(e->key), "%s", key);
+    e->kind = kind;
+    e->hash = hash;
+    e->result = result;
+    e->storedAt = time(NULL);
+    e->size = size;
+    e->data = copy;
+
+    DBCacheEntry **bucket = &g_cache.buckets[hash % DB_CACHE_HASH_BUCKETS];
+    e->hashNext = *bucket;
+    *bucket = e;
+    lruPushFront(e);
+
+    g_cache.stats.entries++;
+    g_cache.stats.bytes += sizeof(*e) + size;
+}
+
+void DBCache_InvalidateGuid(const char *guid) {
+    if (!guid) guid = "";
+
+    DBCacheEntry *e = g_cache.lruHead;
+    while (e) {
+        DBCacheEntry *next = e->lruNext;
+        if (e->guid[0] == '\0' || strcmp(e->guid, guid) == 0) {
+            removeEntry(e);
+            g_cache.stats.invalidations++;
+        }
+        e = next;
+    }
+}
+
+void DBCache_Clear(void) {
+    while (g_cache.lruHead) {
+        removeEntry(g_cache.lruHead);
+    }
+}
+
+void DBCache_GetStats(DBCacheStats *out) {
+    *out = g_cache.stats;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file db_cache.h
+ * @brief Read-through cache for hot db_manager queries
+ *
+ * Menu navigation and chat quick commands used to cost one PostgreSQL
+ * round trip per keypress / chat line. Results of the hot read paths are
+ * kept per player GUID and dropped explicitly by the db_manager write
+ * functions that change them (sounds, playlists, shares).
+ *
+ * Menus, quick command aliases and prefixes are also edited from the web
+ * panel, which the voice server never sees, so every entry additionally
+ * expires after DB_CACHE_TTL_SEC.
+ *
+ * Like the rest of db_manager, this module is not re-entrant; callers run
+ * under the worker pool's service lock.
+ */
+
+#ifndef DB_CACHE_H
+#define DB_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Limits
+ */
+#define DB_CACHE_MAX_ENTRIES    1024
+#define DB_CACHE_HASH_BUCKETS   256
+#define DB_CACHE_KEY_LEN        96
+#define DB_CACHE_TTL_SEC        60      /* Bounds staleness from web panel edits */
+
+/*
+ * Cached query kinds
+ */
+typedef enum {
+    DB_CACHE_USER_MENUS = 0,            /* DB_GetUserMenus */
+    DB_CACHE_MENU_PAGE,                 /* DB_GetMenuPage */
+    DB_CACHE_QUICK_PREFIX,              /* DB_GetQuickCmdPrefix */
+    DB_CACHE_QUICK_COMMAND,             /* DB_LookupQuickCommand */
+    DB_CACHE_FIND_SOUND                 /* DB_FindSoundByAlias */
+} DBCacheKind;
+
+/*
+ * Cache statistics
+ */
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t invalidations;             /* Entries dropped by writes */
+    uint64_t expirations;               /* Entries dropped by TTL */
+    uint64_t evictions;                 /* Entries dropped by LRU */
+    int      entries;
+    size_t   bytes;
+} DBCacheStats;
+
+/**
+ * Look up a cached query result.
+ * @param guid Player GUID ("" for results shared by all players)
+ * @param kind Query kind
+ * @param key Query arguments beyond the GUID ("" if none)
+ * @param outData Receives the cached output struct / buffer
+ * @param size Size of outData; must match the stored size
+ * @param outResult Receives the query's cached return value
+ * @return true on hit
+ */
+bool DBCache_Lookup(const char *guid, DBCacheKind kind, const char *key,
+                    void *outData, size_t size, bool *outResult);
+
+/**
+ * Store a query result (positive or negative).
+ * Replaces an existing entry with the same GUID, kind and key.
+ */
+void DBCache_Store(const char *guid, DBCacheKind kind, const char *key,
+                   const void *data, size_t size, bool result);
+
+/**
+ * Drop every entry of a player, plus all shared ("") entries.
+ * Called by write functions that change what the player sees.
+ */
+void DBCache_InvalidateGuid(const char *guid);
+
+/**
+ * Drop all entries.
+ */
+void DBCache_Clear(void);
+
+/**
+ * Copy current statistics.
+ */
+void DBCache_GetStats(DBCacheStats *out);
+
+#endif /* DB_CACHE_H */
@@ -7,22 +7,424 @@
 
 #include "db_manager.h"
 #include "sound_manager.h"
+#include "db_cache.h"
+#include "sound_index.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 #include <libpq-fe.h>
 
 /*
  * Module state
  */
+/*
+ * One connection
+ *
+ * Jobs run one at a time under the worker pool's service lock, so a second
+ * connection would never carry a query. A lost connection is reopened by
+ * DB_Reconnect(), at most once per DB_RECONNECT_INTERVAL_SEC.
+ */
+#define DB_RECONNECT_INTERVAL_SEC   5
+
+/*
+ * Hot queries, prepared on every (re)connect so PostgreSQL parses and plans
+ * them once per connection instead of once per call.
+ */
+typedef struct {
+    const char *name;
+    int         nParams;
+    const char *sql;
+} DBStatement;
+
+typedef enum {
+    STMT_SOUND_BY_ALIAS = 0,
+    STMT_FIND_SOUND_BY_ALIAS,
+    STMT_FIND_PUBLIC_SOUND_BY_ALIAS,
+    STMT_PLAYLIST_POSITION,
+    STMT_SET_PLAYLIST_POSITION,
+    STMT_PLAYLIST_SOUND_AT,
+    STMT_PUBLIC_PLAYLIST_SOUND_AT,
+    STMT_USER_MENUS,
+    STMT_MENU_ITEM_SOUND,
+    STMT_MENU_ROOT_SERVER,
+    STMT_MENU_ROOT_PERSONAL,
+    STMT_PLAYLIST_SNAPSHOT_SERVER,
+    STMT_PLAYLIST_SNAPSHOT_PERSONAL,
+    STMT_MENU_PLAYLIST_SERVER,
+    STMT_MENU_PLAYLIST_PERSONAL,
+    STMT_MENU_ITEMS_SERVER,
+    STMT_MENU_ITEMS_PERSONAL,
+    STMT_MENU_NAME_SERVER,
+    STMT_MENU_NAME_PERSONAL,
+    STMT_SOUND_BY_ID_USER,
+    STMT_SOUND_BY_ID_PUBLIC,
+    STMT_QUICK_PREFIX,
+    STMT_QUICK_COMMAND,
+    STMT_INDEX_PUBLIC,
+    STMT_INDEX_USERS,
+    STMT_COUNT
+} DBStmtId;
+
 static struct {
     PGconn     *conn;
     DBStatus    status;
     char        lastError[256];
     char        connString[512];
+    bool        queryFailed;    /* Set by checkResult(); keeps errors out of the cache */
+
+    uint32_t    prepared;       /* Bit per DBStmtId prepared on conn */
+    bool        wasConnected;   /* Only retry connections that worked once */
+    time_t      lastReconnect;
 } g_db;
 
+static const DBStatement g_statements[STMT_COUNT] = {
+    [STMT_SOUND_BY_ALIAS] = { "sound_by_alias", 2,
+        "SELECT us.id, us.guid, us.sound_file_id, us.alias, us.visibility, "
+        "us.created_at, us.updated_at, sf.file_path, sf.file_size, sf.duration_seconds "
+        "FROM user_sounds us "
+        "JOIN sound_files sf ON sf.id = us.sound_file_id "
+        "WHERE us.guid = $1 AND us.alias = $2" },
+    [STMT_FIND_SOUND_BY_ALIAS] = { "find_sound_by_alias", 2,
+        "SELECT file_path FROM ("
+        "  SELECT sf.file_path, 1 as priority "
+        "  FROM user_sounds us "
+        "  JOIN sound_files sf ON sf.id = us.sound_file_id "
+        "  WHERE us.guid = $1 AND us.alias = $2 "
+        "  UNION ALL "
+        "  SELECT sf.file_path, 2 as priority "
+        "  FROM sound_playlist_items pi "
+        "  JOIN sound_playlists p ON p.id = pi.playlist_id "
+        "  JOIN user_sounds us ON us.id = pi.user_sound_id "
+        "  JOIN sound_files sf ON sf.id = us.sound_file_id "
+        "  WHERE p.guid = $1 AND us.alias = $2 "
+        ") sub "
+        "ORDER BY priority ASC "
+        "LIMIT 1" },
+    [STMT_FIND_PUBLIC_SOUND_BY_ALIAS] = { "find_public_sound_by_alias", 1,
+        "SELECT file_path FROM ("
+        "  SELECT sf.file_path, 1 as priority "
+        "  FROM sound_files sf "
+        "  WHERE sf.is_public = true "
+        "    AND (sf.original_name = $1 OR sf.original_name = $1 || '.mp3') "
+        "  UNION ALL "
+        "  SELECT sf.file_path, 2 as priority "
+        "  FROM user_sounds us "
+        "  JOIN sound_files sf ON sf.id = us.sound_file_id "
+        "  WHERE us.visibility = 'public' AND us.alias = $1 "
+        "  UNION ALL "
+        "  SELECT sf.file_path, 3 as priority "
+        "  FROM sound_playlist_items pi "
+        "  JOIN sound_playlists p ON p.id = pi.playlist_id "
+        "  JOIN user_sounds us ON us.id = pi.user_sound_id "
+        "  JOIN sound_files sf ON sf.id = us.sound_file_id "
+        "  WHERE p.is_public = true AND us.alias = $1 "
+        ") sub "
+        "ORDER BY priority ASC "
+        "LIMIT 1" },
+    [STMT_PLAYLIST_POSITION] = { "playlist_position", 2,
+        "SELECT current_position FROM sound_playlists WHERE guid = $1 AND name = $2" },
+    [STMT_SET_PLAYLIST_POSITION] = { "set_playlist_position", 3,
+        "UPDATE sound_playlists SET current_position = $1, updated_at = NOW() "
+        "WHERE guid = $2 AND name = $3" },
+    [STMT_PLAYLIST_SOUND_AT] = { "playlist_sound_at", 3,
+        "SELECT pi.id, pi.playlist_id, pi.user_sound_id, pi.order_number, pi.added_at, "
+        "us.alias, sf.file_path, sf.duration_seconds "
+        "FROM sound_playlist_items pi "
+        "JOIN sound_playlists p ON p.id = pi.playlist_id "
+        "JOIN user_sounds us ON us.id = pi.user_sound_id "
+        "JOIN sound_files sf ON sf.id = us.sound_file_id "
+        "WHERE p.guid = $1 AND p.name = $2 AND pi.order_number = $3" },
+    [STMT_PUBLIC_PLAYLIST_SOUND_AT] = { "public_playlist_sound_at", 2,
+        "SELECT pi.id, pi.playlist_id, pi.user_sound_id, pi.order_number, pi.added_at, "
+        "us.alias, sf.file_path, sf.duration_seconds "
+        "FROM sound_playlist_items pi "
+        "JOIN sound_playlists p ON p.id = pi.playlist_id "
+        "JOIN user_sounds us ON us.id = pi.user_sound_id "
+        "JOIN sound_files sf ON sf.id = us.sound_file_id "
+        "WHERE p.is_public = true AND p.name = $1 AND pi.order_number = $2" },
+    [STMT_USER_MENUS] = { "user_menus", 1,
+        "SELECT menu_position, menu_name, is_playlist, item_position, item_name, sound_alias FROM ("
+        "  /* Manual sound items (item_type='sound') */"
+        "  SELECT m.menu_position, m.menu_name, false as is_playlist, "
+        "         mi.item_position, COALESCE(mi.display_name, us.alias) as item_name, us.alias as sound_alias "
+        "  FROM user_sound_menus m "
+        "  JOIN user_sound_menu_items mi ON mi.menu_id = m.id "
+        "  JOIN user_sounds us ON us.id = mi.sound_id "
+        "  WHERE m.user_guid = $1 AND mi.item_type = 'sound' "
+        "  UNION ALL "
+        "  /* Playlist-backed menus (menu.playlist_id set) */"
+        "  SELECT m.menu_position, m.menu_name, true as is_playlist, "
+        "         pi.order_number as item_position, us.alias as item_name, us.alias as sound_alias "
+        "  FROM user_sound_menus m "
+        "  JOIN sound_playlists p ON p.id = m.playlist_id "
+        "  JOIN sound_playlist_items pi ON pi.playlist_id = p.id "
+        "  JOIN user_sounds us ON us.id = pi.user_sound_id "
+        "  WHERE m.user_guid = $1 AND m.playlist_id IS NOT NULL "
+        "  UNION ALL "
+        "  /* Playlist items within menu (item_type='playlist') - expand playlist sounds */"
+        "  SELECT m.menu_position, m.menu_name, true as is_playlist, "
+        "         pi.order_number as item_position, us.alias as item_name, us.alias as sound_alias "
+        "  FROM user_sound_menus m "
+        "  JOIN user_sound_menu_items mi ON mi.menu_id = m.id "
+        "  JOIN sound_playlist_items pi ON pi.playlist_id = mi.playlist_id "
+        "  JOIN user_sounds us ON us.id = pi.user_sound_id "
+        "  WHERE m.user_guid = $1 AND mi.item_type = 'playlist' "
+        "  UNION ALL "
+        "  /* Menus with no items (empty) */"
+        "  SELECT m.menu_position, m.menu_name, false as is_playlist, "
+        "         NULL::int as item_position, NULL as item_name, NULL as sound_alias "
+        "  FROM user_sound_menus m "
+        "  LEFT JOIN user_sound_menu_items mi ON mi.menu_id = m.id "
+        "  LEFT JOIN sound_playlist_items pi ON pi.playlist_id = m.playlist_id "
+        "  WHERE m.user_guid = $1 AND mi.id IS NULL AND pi.id IS NULL "
+        ") combined "
+        "ORDER BY menu_position, item_position NULLS LAST" },
+    [STMT_MENU_ITEM_SOUND] = { "menu_item_sound", 3,
+        "SELECT file_path FROM ("
+        "  /* Manual sound items (item_type='sound') */"
+        "  SELECT sf.file_path, mi.item_position "
+        "  FROM user_sound_menu_items mi "
+        "  JOIN user_sound_menus m ON m.id = mi.menu_id "
+        "  JOIN user_sounds us ON us.id = mi.sound_id "
+        "  JOIN sound_files sf ON sf.id = us.sound_file_id "
+        "  WHERE m.user_guid = $1 AND m.menu_position = $2 AND mi.item_type = 'sound' "
+        "  UNION ALL "
+        "  /* Playlist-backed menus (menu.playlist_id set) */"
+        "  SELECT sf.file_path, pi.order_number as item_position "
+        "  FROM user_sound_menus m "
+        "  JOIN sound_playlist_items pi ON pi.playlist_id = m.playlist_id "
+        "  JOIN user_sounds us ON us.id = pi.user_sound_id "
+        "  JOIN sound_files sf ON sf.id = us.sound_file_id "
+        "  WHERE m.user_guid = $1 AND m.menu_position = $2 AND m.playlist_id IS NOT NULL "
+        "  UNION ALL "
+        "  /* Playlist items within menu (item_type='playlist') */"
+        "  SELECT sf.file_path, pi.order_number as item_position "
+        "  FROM user_sound_menu_items mi "
+        "  JOIN user_sound_menus m ON m.id = mi.menu_id "
+        "  JOIN sound_playlist_items pi ON pi.playlist_id = mi.playlist_id "
+        "  JOIN user_sounds us ON us.id = pi.user_sound_id "
+        "  JOIN sound_files sf ON sf.id = us.sound_file_id "
+        "  WHERE m.user_guid = $1 AND m.menu_position = $2 AND mi.item_type = 'playlist' "
+        ") combined WHERE item_position = $3" },
+    [STMT_MENU_ROOT_SERVER] = { "menu_root_server", 2,
+        "SELECT "
+        "  i.item_position, "
+        "  i.item_type, "
+        "  COALESCE(i.display_name, us.alias, m.menu_name, p.name) as display_name, "
+        "  us.alias as sound_alias, "
+        "  i.nested_menu_id, "
+        "  i.playlist_id, "
+        "  (SELECT COUNT(*) FROM user_sound_menu_items WHERE menu_id IS NULL AND is_server_default = true) as total_count "
+        "FROM user_sound_menu_items i "
+        "LEFT JOIN user_sounds us ON i.sound_id = us.id "
+        "LEFT JOIN user_sound_menus m ON i.nested_menu_id = m.id "
+        "LEFT JOIN sound_playlists p ON i.playlist_id = p.id "
+        "WHERE i.menu_id IS NULL AND i.is_server_default = true "
+        "ORDER BY i.item_position "
+        "LIMIT $1 OFFSET $2" },
+    [STMT_MENU_ROOT_PERSONAL] = { "menu_root_personal", 3,
+        "SELECT "
+        "  i.item_position, "
+        "  i.item_type, "
+        "  COALESCE(i.display_name, us.alias, m.menu_name, p.name) as display_name, "
+        "  us.alias as sound_alias, "
+        "  i.nested_menu_id, "
+        "  i.playlist_id, "
+        "  (SELECT COUNT(*) FROM user_sound_menu_items WHERE menu_id IS NULL AND user_guid = $1 AND (is_server_default = false OR is_server_default IS NULL)) as total_count "
+        "FROM user_sound_menu_items i "
+        "LEFT JOIN user_sounds us ON i.sound_id = us.id "
+        "LEFT JOIN user_sound_menus m ON i.nested_menu_id = m.id "
+        "LEFT JOIN sound_playlists p ON i.playlist_id = p.id "
+        "WHERE i.menu_id IS NULL AND i.user_guid = $1 AND (i.is_server_default = false OR i.is_server_default IS NULL) "
+        "ORDER BY i.item_position "
+        "LIMIT $2 OFFSET $3" },
+    [STMT_PLAYLIST_SNAPSHOT_SERVER] = { "playlist_snapshot_server", 1,
+        "SELECT "
+        "  playlist_snapshot->'originalPlaylistName' as playlist_name, "
+        "  elem->>'position' as position, "
+        "  elem->>'originalAlias' as original_alias, "
+        "  elem->>'displayName' as display_name, "
+        "  elem->>'filePath' as file_path, "
+        "  jsonb_array_length(playlist_snapshot->'items') as total_items "
+        "FROM user_sound_menu_items, "
+        "     jsonb_array_elements(playlist_snapshot->'items') as elem "
+        "WHERE playlist_id = $1 "
+        "  AND is_server_default = true "
+        "  AND playlist_snapshot IS NOT NULL "
+        "ORDER BY (elem->>'position')::int "
+        "LIMIT 9" },
+    [STMT_PLAYLIST_SNAPSHOT_PERSONAL] = { "playlist_snapshot_personal", 2,
+        "SELECT "
+        "  playlist_snapshot->'originalPlaylistName' as playlist_name, "
+        "  elem->>'position' as position, "
+        "  elem->>'originalAlias' as original_alias, "
+        "  elem->>'displayName' as display_name, "
+        "  elem->>'filePath' as file_path, "
+        "  jsonb_array_length(playlist_snapshot->'items') as total_items "
+        "FROM user_sound_menu_items, "
+        "     jsonb_array_elements(playlist_snapshot->'items') as elem "
+        "WHERE user_guid = $1 "
+        "  AND playlist_id = $2 "
+        "  AND (is_server_default = false OR is_server_default IS NULL) "
+        "  AND playlist_snapshot IS NOT NULL "
+        "ORDER BY (elem->>'position')::int "
+        "LIMIT 9" },
+    [STMT_MENU_PLAYLIST_SERVER] = { "menu_playlist_server", 3,
+        "SELECT pi.order_number, us.alias, us.id, p.name, "
+        "       (SELECT COUNT(*) FROM sound_playlist_items WHERE playlist_id = $1) as total_items "
+        "FROM sound_playlist_items pi "
+        "JOIN user_sounds us ON us.id = pi.user_sound_id "
+        "JOIN sound_playlists p ON p.id = pi.playlist_id "
+        "WHERE p.id = $1 "
+        "ORDER BY pi.order_number "
+        "LIMIT $2 OFFSET $3" },
+    [STMT_MENU_PLAYLIST_PERSONAL] = { "menu_playlist_personal", 4,
+        "SELECT pi.order_number, us.alias, us.id, p.name, "
+        "       (SELECT COUNT(*) FROM sound_playlist_items WHERE playlist_id = $2) as total_items "
+        "FROM sound_playlist_items pi "
+        "JOIN user_sounds us ON us.id = pi.user_sound_id "
+        "JOIN sound_playlists p ON p.id = pi.playlist_id "
+        "WHERE p.guid = $1 AND p.id = $2 "
+        "ORDER BY pi.order_number "
+        "LIMIT $3 OFFSET $4" },
+    [STMT_MENU_ITEMS_SERVER] = { "menu_items_server", 3,
+        "SELECT item_position, item_type, display_name, sound_alias, nested_menu_id, menu_name, total_items FROM ("
+        "  /* Sound items (item_type='sound') */"
+        "  SELECT mi.item_position, 'sound'::text as item_type, "
+        "         COALESCE(mi.display_name, us.alias) as display_name, "
+        "         us.alias as sound_alias, NULL::int as nested_menu_id, "
+        "         m.menu_name, "
+        "         (SELECT COUNT(*) FROM user_sound_menu_items WHERE menu_id = m.id) as total_items "
+        "  FROM user_sound_menus m "
+        "  JOIN user_sound_menu_items mi ON mi.menu_id = m.id "
+        "  JOIN user_sounds us ON us.id = mi.sound_id "
+        "  WHERE m.id = $1 AND m.is_server_default = true AND mi.item_type = 'sound' "
+        "  UNION ALL "
+        "  /* Nested menu items (item_type='menu') */"
+        "  SELECT mi.item_position, 'menu'::text as item_type, "
+        "         COALESCE(mi.display_name, nm.menu_name) as display_name, "
+        "         NULL as sound_alias, mi.nested_menu_id, "
+        "         m.menu_name, "
+        "         (SELECT COUNT(*) FROM user_sound_menu_items WHERE menu_id = m.id) as total_items "
+        "  FROM user_sound_menus m "
+        "  JOIN user_sound_menu_items mi ON mi.menu_id = m.id "
+        "  JOIN user_sound_menus nm ON nm.id = mi.nested_menu_id "
+        "  WHERE m.id = $1 AND m.is_server_default = true AND mi.item_type = 'menu' "
+        "  UNION ALL "
+        "  /* Playlist items (item_type='playlist') - show as navigable item with negative playlist ID */"
+        "  SELECT mi.item_position, 'playlist'::text as item_type, "
+        "         COALESCE(mi.display_name, p.name) as display_name, "
+        "         NULL as sound_alias, -mi.playlist_id as nested_menu_id, "
+        "         m.menu_name, "
+        "         (SELECT COUNT(*) FROM user_sound_menu_items WHERE menu_id = m.id) as total_items "
+        "  FROM user_sound_menus m "
+        "  JOIN user_sound_menu_items mi ON mi.menu_id = m.id "
+        "  JOIN sound_playlists p ON p.id = mi.playlist_id "
+        "  WHERE m.id = $1 AND m.is_server_default = true AND mi.item_type = 'playlist' "
+        "  UNION ALL "
+        "  /* Playlist-backed menu (menu.playlist_id set, entire menu is a playlist) */"
+        "  SELECT pi.order_number as item_position, 'sound'::text as item_type, "
+        "         us.alias as display_name, us.alias as sound_alias, NULL::int as nested_menu_id, "
+        "         m.menu_name, "
+        "         (SELECT COUNT(*) FROM sound_playlist_items WHERE playlist_id = m.playlist_id) as total_items "
+        "  FROM user_sound_menus m "
+        "  JOIN sound_playlist_items pi ON pi.playlist_id = m.playlist_id "
+        "  JOIN user_sounds us ON us.id = pi.user_sound_id "
+        "  WHERE m.id = $1 AND m.is_server_default = true AND m.playlist_id IS NOT NULL "
+        ") combined ORDER BY item_position LIMIT $2 OFFSET $3" },
+    [STMT_MENU_ITEMS_PERSONAL] = { "menu_items_personal", 4,
+        "SELECT item_position, item_type, display_name, sound_alias, nested_menu_id, menu_name, total_items FROM ("
+        "  /* Sound items (item_type='sound') */"
+        "  SELECT mi.item_position, 'sound'::text as item_type, "
+        "         COALESCE(mi.display_name, us.alias) as display_name, "
+        "         us.alias as sound_alias, NULL::int as nested_menu_id, "
+        "         m.menu_name, "
+        "         (SELECT COUNT(*) FROM user_sound_menu_items WHERE menu_id = m.id) as total_items "
+        "  FROM user_sound_menus m "
+        "  JOIN user_sound_menu_items mi ON mi.menu_id = m.id "
+        "  JOIN user_sounds us ON us.id = mi.sound_id "
+        "  WHERE m.user_guid = $1 AND m.id = $2 AND m.is_server_default = false AND mi.item_type = 'sound' "
+        "  UNION ALL "
+        "  /* Nested menu items (item_type='menu') */"
+        "  SELECT mi.item_position, 'menu'::text as item_type, "
+        "         COALESCE(mi.display_name, nm.menu_name) as display_name, "
+        "         NULL as sound_alias, mi.nested_menu_id, "
+        "         m.menu_name, "
+        "         (SELECT COUNT(*) FROM user_sound_menu_items WHERE menu_id = m.id) as total_items "
+        "  FROM user_sound_menus m "
+        "  JOIN user_sound_menu_items mi ON mi.menu_id = m.id "
+        "  JOIN user_sound_menus nm ON nm.id = mi.nested_menu_id "
+        "  WHERE m.user_guid = $1 AND m.id = $2 AND m.is_server_default = false AND mi.item_type = 'menu' "
+        "  UNION ALL "
+        "  /* Playlist items (item_type='playlist') - show as navigable item with negative playlist ID */"
+        "  SELECT mi.item_position, 'playlist'::text as item_type, "
+        "         COALESCE(mi.display_name, p.name) as display_name, "
+        "         NULL as sound_alias, -mi.playlist_id as nested_menu_id, "
+        "         m.menu_name, "
+        "         (SELECT COUNT(*) FROM user_sound_menu_items WHERE menu_id = m.id) as total_items "
+        "  FROM user_sound_menus m "
+        "  JOIN user_sound_menu_items mi ON mi.menu_id = m.id "
+        "  JOIN sound_playlists p ON p.id = mi.playlist_id "
+        "  WHERE m.user_guid = $1 AND m.id = $2 AND m.is_server_default = false AND mi.item_type = 'playlist' "
+        "  UNION ALL "
+        "  /* Playlist-backed menu (menu.playlist_id set, entire menu is a playlist) */"
+        "  SELECT pi.order_number as item_position, 'sound'::text as item_type, "
+        "         us.alias as display_name, us.alias as sound_alias, NULL::int as nested_menu_id, "
+        "         m.menu_name, "
+        "         (SELECT COUNT(*) FROM sound_playlist_items WHERE playlist_id = m.playlist_id) as total_items "
+        "  FROM user_sound_menus m "
+        "  JOIN sound_playlist_items pi ON pi.playlist_id = m.playlist_id "
+        "  JOIN user_sounds us ON us.id = pi.user_sound_id "
+        "  WHERE m.user_guid = $1 AND m.id = $2 AND m.is_server_default = false AND m.playlist_id IS NOT NULL "
+        ") combined ORDER BY item_position LIMIT $3 OFFSET $4" },
+    [STMT_MENU_NAME_SERVER] = { "menu_name_server", 1,
+        "SELECT menu_name FROM user_sound_menus WHERE id = $1 AND is_server_default = true" },
+    [STMT_MENU_NAME_PERSONAL] = { "menu_name_personal", 2,
+        "SELECT menu_name FROM user_sound_menus WHERE user_guid = $1 AND id = $2 AND is_server_default = false" },
+    [STMT_SOUND_BY_ID_USER] = { "sound_by_id_user", 2,
+        "SELECT sf.file_path, us.alias "
+        "FROM user_sounds us "
+        "JOIN sound_files sf ON sf.id = us.sound_file_id "
+        "WHERE us.guid = $1 AND us.id = $2" },
+    [STMT_SOUND_BY_ID_PUBLIC] = { "sound_by_id_public", 1,
+        "SELECT file_path, original_name "
+        "FROM sound_files "
+        "WHERE id = $1 AND is_public = true" },
+    [STMT_QUICK_PREFIX] = { "quick_prefix", 1,
+        "SELECT quick_cmd_prefix FROM player_settings WHERE guid = $1" },
+    [STMT_QUICK_COMMAND] = { "quick_command", 2,
+        "SELECT "
+        "  COALESCE(sf1.file_path, sf2.file_path) AS file_path, "
+        "  COALESCE(sf1.id, sf2.id) AS sound_file_id, "
+        "  qca.chat_text "
+        "FROM quick_command_aliases qca "
+        "LEFT JOIN user_sounds us ON qca.user_sound_id = us.id "
+        "LEFT JOIN sound_files sf1 ON us.sound_file_id = sf1.id "
+        "LEFT JOIN sound_files sf2 ON qca.sound_file_id = sf2.id "
+        "WHERE qca.guid = $1 AND LOWER(qca.alias) = LOWER($2)" },
+    [STMT_INDEX_PUBLIC] = { "index_public", 1,
+        "WITH pub AS ("
+        "  SELECT sf.id, sf.file_path, sf.original_name FROM sound_files sf "
+        "  WHERE (sf.is_public = true OR EXISTS ("
+        "      SELECT 1 FROM user_sounds us "
+        "      JOIN sound_playlist_items spi ON spi.user_sound_id = us.id "
+        "      JOIN sound_playlists sp ON sp.id = spi.playlist_id "
+        "      WHERE us.sound_file_id = sf.id AND sp.is_public = true)) "
+        "    AND ($1::int IS NULL OR sf.id = $1::int)"
+        ") "
+        "SELECT pub.id, pub.file_path, REPLACE(pub.original_name, '.mp3', '') FROM pub "
+        "UNION "
+        "SELECT pub.id, pub.file_path, us.alias FROM pub "
+        "JOIN user_sounds us ON us.sound_file_id = pub.id" },
+    [STMT_INDEX_USERS] = { "index_users", 1,
+        "SELECT us.guid, sf.id, sf.file_path, us.alias FROM user_sounds us "
+        "JOIN sound_files sf ON sf.id = us.sound_file_id "
+        "WHERE $1::text IS NULL OR us.guid = $1 "
+        "ORDER BY us.guid" },
+};
+
 /*
  * Helper: Set error message
  */
@@ -49,6 +451,7 @@ static void setErrorFromPG(void) {
 static bool checkResult(PGresult *res, ExecStatusType expected) {
     if (!res) {
         setErrorFromPG();
+        g_db.queryFailed = true;
         return false;
     }
 
@@ -61,6 +464,7 @@ static bool checkResult(PGresult *res, ExecStatusType expected) {
             setError(PQresStatus(status));
         }
         PQclear(res);
+        g_db.queryFailed = true;
         return false;
     }
 
@@ -123,6 +527,244 @@ static bool getBoolField(PGresult *res, int row, int col) {
     return val[0] == 't' || val[0] == 'T' || val[0] == '1';
 }
 
+/*
+ * Helper: Start a query whose result may be cached
+ */
+static void beginCachedQuery(void) {
+    g_db.queryFailed = false;
+}
+
+/*
+ * Helper: Only real answers are cached, never connection or SQL errors
+ */
+static bool resultCacheable(void) {
+    return !g_db.queryFailed && DB_IsConnected();
+}
+
+/*
+ * Helper: Prepare every statement on the connection.
+ * A statement that fails to prepare (e.g. schema not migrated yet) is left
+ * out of the mask and runs unprepared instead.
+ */
+static void prepareStatements(void) {
+    g_db.prepared = 0;
+    for (int i = 0; i < STMT_COUNT; i++) {
+        const DBStatement *stmt = &g_statements[i];
+        PGresult *res = PQprepare(g_db.conn, stmt->name, stmt->sql, stmt->nParams, NULL);
+        if (res && PQresultStatus(res) == PGRES_COMMAND_OK) {
+            g_db.prepared |= 1u << i;
+        } else {
+            fprintf(stderr, "DB: Failed to prepare '%s': %s", stmt->name,
+                    res ? PQresultErrorMessage(res) : PQerrorMessage(g_db.conn));
+        }
+        PQclear(res);
+    }
+}
+
+/*
+ * Helper: (Re)open the connection and prepare its statements.
+ * PQreset() starts a new server session, which drops prepared statements.
+ */
+static bool connectConn(void) {
+    if (g_db.conn) {
+        PQreset(g_db.conn);
+    } else {
+        g_db.conn = PQconnectdb(g_db.connString);
+    }
+
+    g_db.prepared = 0;
+    if (PQstatus(g_db.conn) != CONNECTION_OK) {
+        return false;
+    }
+
+    prepareStatements();
+    return true;
+}
+
+/*
+ * Helper: Execute a statement from g_statements
+ */
+static PGresult *execStatement(DBStmtId id, const char *const *params) {
+    const DBStatement *stmt = &g_statements[id];
+
+    if (g_db.prepared & (1u << id)) {
+        return PQexecPrepared(g_db.conn, stmt->name, stmt->nParams, params,
+                              NULL, NULL, 0);
+    }
+    return PQexecParams(g_db.conn, stmt->sql, stmt->nParams, NULL, params,
+                        NULL, NULL, 0);
+}
+
+/*
+ * Independent statement for execPipeline()
+ */
+typedef struct {
+    DBStmtId            id;
+    const char *const  *params;
+} DBPipelineQuery;
+
+/*
+ * Helper: Run independent statements in one round trip (libpq pipeline mode).
+ * Fills results[i] for every query; check each with checkResult() as usual.
+ * Falls back to one round trip per statement when pipelining is unavailable.
+ */
+static void execPipeline(const DBPipelineQuery *queries, int count, PGresult **results) {
+    int sent = 0;
+
+#ifdef LIBPQ_HAS_PIPELINING
+    uint32_t prepared = g_db.prepared;
+    bool usable = true;
+
+    for (int i = 0; i < count; i++) {
+        if (!(prepared & (1u << queries[i].id))) usable = false;
+    }
+
+    if (usable && PQenterPipelineMode(g_db.conn)) {
+        for (; sent < count; sent++) {
+            const DBStatement *stmt = &g_statements[queries[sent].id];
+            if (!PQsendQueryPrepared(g_db.conn, stmt->name, stmt->nParams,
+                                     queries[sent].params, NULL, NULL, 0)) {
+                break;
+            }
+        }
+        PQpipelineSync(g_db.conn);
+
+        /* Each query's result is followed by NULL, then the sync marker */
+        PGresult *res;
+        for (int i = 0; i < sent; i++) {
+            results[i] = PQgetResult(g_db.conn);
+            while (results[i] && (res = PQgetResult(g_db.conn)) != NULL) {
+                PQclear(res);
+            }
+        }
+        while ((res = PQgetResult(g_db.conn)) != NULL) {
+            ExecStatusType status = PQresultStatus(res);
+            PQclear(res);
+            if (status == PGRES_PIPELINE_SYNC) break;
+        }
+        PQexitPipelineMode(g_db.conn);
+
+        for (int i = sent; i < count; i++) {
+            results[i] = NULL;
+        }
+        return;
+    }
+#endif
+
+    for (; sent < count; sent++) {
+        results[sent] = execStatement(queries[sent].id, queries[sent].params);
+    }
+}
+
+/*
+ * Helper: Pick the first pipelined result that has a row.
+ * Every other result is cleared; the caller clears the returned one.
+ */
+static PGresult *firstResultWithRows(PGresult **results, int count) {
+    PGresult *found = NULL;
+    for (int i = 0; i < count; i++) {
+        /* checkResult clears res on failure */
+        if (!checkResult(results[i], PGRES_TUPLES_OK)) continue;
+        if (!found && PQntuples(results[i]) > 0) {
+            found = results[i];
+        } else {
+            PQclear(results[i]);
+        }
+    }
+    return found;
+}
+
+
+/*
+ * Fuzzy search index (see sound_index.h)
+ */
+
+/*
+ * Helper: Load public sound names into the index.
+ * @param soundFileId Only reload this file's names, or 0 for all
+ */
+static bool loadPublicIndex(int soundFileId) {
+    char idStr[16];
+    snprintf(idStr, sizeof(idStr), "%d", soundFileId);
+    const char *params[1] = { soundFileId ? idStr : NULL };
+
+    PGresult *res = execStatement(STMT_INDEX_PUBLIC, params);
+    if (!checkResult(res, PGRES_TUPLES_OK)) {
+        SoundIndex_Invalidate("");
+        return false;
+    }
+
+    if (soundFileId) {
+        SoundIndex_RemoveFile("", soundFileId);
+    } else {
+        SoundIndex_BeginOwner("");
+    }
+
+    int rows = PQntuples(res);
+    for (int i = 0; i < rows; i++) {
+        SoundIndex_Add("", getField(res, i, 2), getField(res, i, 1), getIntField(res, i, 0));
+    }
+    PQclear(res);
+    return true;
+}
+
+/*
+ * Helper: Load player aliases into the index.
+ * @param guid Only reload this player, or NULL for everyone
+ */
+static bool loadUserIndex(const char *guid) {
+    const char *params[1] = { guid };
+
+    PGresult *res = execStatement(STMT_INDEX_USERS, params);
+    if (!checkResult(res, PGRES_TUPLES_OK)) {
+        return false;
+    }
+
+    /* A player without sounds is still loaded, as "no aliases" */
+    if (guid) {
+        SoundIndex_BeginOwner(guid);
+    }
+
+    int rows = PQntuples(res);
+    for (int i = 0; i < rows; i++) {
+        const char *owner = getField(res, i, 0);
+        if (!guid && (i == 0 || strcmp(owner, PQgetvalue(res, i - 1, 0)) != 0)) {
+            SoundIndex_BeginOwner(owner);
+        }
+        SoundIndex_Add(owner, getField(res, i, 3), getField(res, i, 2), getIntField(res, i, 1));
+    }
+    PQclear(res);
+    return true;
+}
+
+static bool loadIndexOwner(const char *owner) {
+    if (!DB_IsConnected()) return false;
+    return owner[0] ? loadUserIndex(owner) : loadPublicIndex(0);
+}
+
+/*
+ * Helper: Fuzzy search one owner ("" = public) without a database round
+ * trip, reloading the owner first if a write invalidated it.
+ */
+static bool searchSoundIndex(const char *owner, const char *alias,
+                             char *outFilePath, int outLen, int *outSoundFileId) {
+    int age = SoundIndex_OwnerAge(owner);
+    if (age < 0) {
+        loadIndexOwner(owner);
+    }
+
+    if (SoundIndex_Find(owner, alias, outFilePath, outLen, outSoundFileId)) {
+        return true;
+    }
+
+    /* Sounds uploaded through the web panel never pass through here;
+     * pick them up on a miss, at most once per SOUND_INDEX_RECHECK_SEC */
+    if (age >= SOUND_INDEX_RECHECK_SEC && loadIndexOwner(owner)) {
+        return SoundIndex_Find(owner, alias, outFilePath, outLen, outSoundFileId);
+    }
+    return false;
+}
+
 
 /*
  * Database connection API
@@ -148,8 +790,7 @@ bool DB_Init(const char *connString) {
     g_db.status = DB_STATUS_CONNECTING;
 
     /* Connect to PostgreSQL */
-    g_db.conn = PQconnectdb(g_db.connString);
-    if (PQstatus(g_db.conn) != CONNECTION_OK) {
+    if (!connectConn()) {
         setErrorFromPG();
         g_db.status = DB_STATUS_ERROR;
         fprintf(stderr, "DB_Init: Connection failed: %s\n", g_db.lastError);
@@ -159,23 +800,47 @@ bool DB_Init(const char *connString) {
     }
 
     g_db.status = DB_STATUS_CONNECTED;
-    printf("DB_Init: Connected to PostgreSQL\n");
+    g_db.wasConnected = true;
+    printf("DB_Init: Connected to PostgreSQL (%d statements prepared)\n",
+           __builtin_popcount(g_db.prepared));
+
+    /* Fuzzy search index */
+    SoundIndex_Clear();
+    if (loadPublicIndex(0) && loadUserIndex(NULL)) {
+        SoundIndexStats stats;
+        SoundIndex_GetStats(&stats);
+        printf("DB_Init: Indexed %d sound names for %d owners\n",
+               stats.entries, stats.owners);
+    } else {
+        fprintf(stderr, "DB_Init: Sound index load failed: %s\n", g_db.lastError);
+    }
 
     return true;
 }
 
 void DB_Shutdown(void) {
+    DBCache_Clear();
+    SoundIndex_Clear();
     if (g_db.conn) {
         PQfinish(g_db.conn);
         g_db.conn = NULL;
     }
+    g_db.prepared = 0;
+    g_db.wasConnected = false;
     g_db.status = DB_STATUS_DISCONNECTED;
     printf("DB_Shutdown: Disconnected from PostgreSQL\n");
 }
 
 bool DB_IsConnected(void) {
-    if (!g_db.conn) return false;
-    return PQstatus(g_db.conn) == CONNECTION_OK;
+    if (g_db.conn && PQstatus(g_db.conn) == CONNECTION_OK) return true;
+    if (!g_db.wasConnected) return false;
+
+    /* Lost the connection: reconnect, but don't stall every call on
+     * connect timeouts while the server is down */
+    time_t now = time(NULL);
+    if (now - g_db.lastReconnect < DB_RECONNECT_INTERVAL_SEC) return false;
+    g_db.lastReconnect = now;
+    return DB_Reconnect();
 }
 
 DBStatus DB_GetStatus(void) {
@@ -187,17 +852,18 @@ const char* DB_GetLastError(void) {
 }
 
 bool DB_Reconnect(void) {
-    if (g_db.conn) {
-        PQreset(g_db.conn);
-        if (PQstatus(g_db.conn) == CONNECTION_OK) {
-            g_db.status = DB_STATUS_CONNECTED;
-            return true;
-        }
+    if (!g_db.connString[0]) return false;
+
+    if (!connectConn()) {
+        setErrorFromPG();
+        g_db.status = DB_STATUS_ERROR;
+        fprintf(stderr, "DB_Reconnect: Reconnect failed: %s\n", g_db.lastError);
+        return false;
     }
 
-    /* Full reconnect */
-    DB_Shutdown();
-    return DB_Init(g_db.connString);
+    g_db.status = DB_STATUS_CONNECTED;
+    g_db.wasConnected = true;
+    return true;
 }
 
 PGconn* DB_GetConnection(void) {
@@ -205,6 +871,40 @@ PGconn* DB_GetConnection(void) {
     return g_db.conn;
 }
 
+PGconn* DB_OpenListener(const char *channel) {
+    if (!g_db.connString[0] || !channel) return NULL;
+
+    PGconn *conn = PQconnectdb(g_db.connString);
+    if (PQstatus(conn) != CONNECTION_OK) {
+        fprintf(stderr, "DB_OpenListener: Connection failed: %s", PQerrorMessage(conn));
+        PQfinish(conn);
+        return NULL;
+    }
+
+    char *ident = PQescapeIdentifier(conn, channel, strlen(channel));
+    if (!ident) {
+        PQfinish(conn);
+        return NULL;
+    }
+
+    char query[128];
+    snprintf(query, sizeof(query), "LISTEN %s", ident);
+    PQfreemem(ident);
+
+    PGresult *res = PQexec(conn, query);
+    bool ok = PQresultStatus(res) == PGRES_COMMAND_OK;
+    if (!ok) {
+        fprintf(stderr, "DB_OpenListener: %s", PQresultErrorMessage(res));
+    }
+    PQclear(res);
+
+    if (!ok || PQsetnonblocking(conn, 1) != 0) {
+        PQfinish(conn);
+        return NULL;
+    }
+    return conn;
+}
+
 
 /*
  * Sound file operations
@@ -219,6 +919,8 @@ bool DB_AddSound(const char *guid, const char *alias,
         return false;
     }
 
+    DBCache_InvalidateGuid(guid);
+
     /* Use a transaction for atomicity */
     PGresult *res = PQexec(g_db.conn, "BEGIN");
     if (!checkResult(res, PGRES_COMMAND_OK)) {
@@ -278,6 +980,8 @@ bool DB_AddSound(const char *guid, const char *alias,
     }
     PQclear(res);
 
+    SoundIndex_Add(guid, alias, filePath, soundFileId);
+
     printf("DB_AddSound: Added sound '%s' for GUID %s (file_id=%d)\n",
            alias, guid, soundFileId);
     return true;
@@ -290,13 +994,7 @@ bool DB_GetSoundByAlias(const char *guid, const char *alias, DBUserSound *outSou
     }
 
     const char *params[2] = { guid, alias };
-    PGresult *res = PQexecParams(g_db.conn,
-        "SELECT us.id, us.guid, us.sound_file_id, us.alias, us.visibility, "
-        "us.created_at, us.updated_at, sf.file_path, sf.file_size, sf.duration_seconds "
-        "FROM user_sounds us "
-        "JOIN sound_files sf ON sf.id = us.sound_file_id "
-        "WHERE us.guid = $1 AND us.alias = $2",
-        2, NULL, params, NULL, NULL, 0);
+    PGresult *res = execStatement(STMT_SOUND_BY_ALIAS, params);
 
     if (!checkResult(res, PGRES_TUPLES_OK)) {
         return false;
@@ -398,6 +1096,8 @@ bool DB_DeleteSound(const char *guid, const char *alias, char *outFilePath) {
         return false;
     }
 
+    DBCache_InvalidateGuid(guid);
+
     if (outFilePath) {
         outFilePath[0] = '\0';
     }
@@ -493,6 +1193,10 @@ bool DB_DeleteSound(const char *guid, const char *alias, char *outFilePath) {
     }
     PQclear(res);
 
+    /* The file may have been public under this alias */
+    SoundIndex_Remove(guid, alias);
+    loadPublicIndex(soundFileId);
+
     printf("DB_DeleteSound: Deleted '%s' for GUID %s%s\n",
            alias, guid, shouldDeleteFile ? " (file will be removed)" : "");
     return true;
@@ -504,6 +1208,8 @@ bool DB_RenameSound(const char *guid, const char *oldAlias, const char *newAlias
         return false;
     }
 
+    DBCache_InvalidateGuid(guid);
+
     /* Check if new alias already exists */
     const char *checkParams[2] = { guid, newAlias };
     PGresult *res = PQexecParams(g_db.conn,
@@ -540,6 +1246,9 @@ bool DB_RenameSound(const char *guid, const char *oldAlias, const char *newAlias
         return false;
     }
 
+    SoundIndex_Rename(guid, oldAlias, newAlias);
+    SoundIndex_Invalidate("");      /* Public aliases of the file */
+
     printf("DB_RenameSound: Renamed '%s' to '%s' for GUID %s\n", oldAlias, newAlias, guid);
     return true;
 }
@@ -550,6 +1259,8 @@ bool DB_SetVisibility(const char *guid, const char *alias, const char *visibilit
         return false;
     }
 
+    DBCache_InvalidateGuid(guid);
+
     /* Validate visibility value */
     if (strcmp(visibility, "private") != 0 &&
         strcmp(visibility, "shared") != 0 &&
@@ -621,6 +1332,8 @@ bool DB_SetVisibility(const char *guid, const char *alias, const char *visibilit
     }
     PQclear(res);
 
+    loadPublicIndex(soundFileId);
+
     printf("DB_SetVisibility: Set '%s' to %s for GUID %s\n", alias, visibility, guid);
     return true;
 }
@@ -724,7 +1437,7 @@ bool DB_GetPublicSoundByName(const char *name, char *outFilePath, int outLen) {
     return true;
 }
 
-bool DB_FindSoundByAlias(const char *guid, const char *alias, char *outFilePath, int outLen) {
+static bool queryFindSoundByAlias(const char *guid, const char *alias, char *outFilePath, int outLen) {
     if (!DB_IsConnected()) {
         setError("Not connected to database");
         return false;
@@ -739,23 +1452,7 @@ bool DB_FindSoundByAlias(const char *guid, const char *alias, char *outFilePath,
      *
      * Use UNION to combine both sources and return first match.
      */
-    PGresult *res = PQexecParams(g_db.conn,
-        "SELECT file_path FROM ("
-        "  SELECT sf.file_path, 1 as priority "
-        "  FROM user_sounds us "
-        "  JOIN sound_files sf ON sf.id = us.sound_file_id "
-        "  WHERE us.guid = $1 AND us.alias = $2 "
-        "  UNION ALL "
-        "  SELECT sf.file_path, 2 as priority "
-        "  FROM sound_playlist_items pi "
-        "  JOIN sound_playlists p ON p.id = pi.playlist_id "
-        "  JOIN user_sounds us ON us.id = pi.user_sound_id "
-        "  JOIN sound_files sf ON sf.id = us.sound_file_id "
-        "  WHERE p.guid = $1 AND us.alias = $2 "
-        ") sub "
-        "ORDER BY priority ASC "
-        "LIMIT 1",
-        2, NULL, params, NULL, NULL, 0);
+    PGresult *res = execStatement(STMT_FIND_SOUND_BY_ALIAS, params);
 
     if (!checkResult(res, PGRES_TUPLES_OK)) {
         return false;
@@ -773,6 +1470,31 @@ bool DB_FindSoundByAlias(const char *guid, const char *alias, char *outFilePath,
     return true;
 }
 
+bool DB_FindSoundByAlias(const char *guid, const char *alias, char *outFilePath, int outLen) {
+    char path[512];
+    bool found;
+
+    if (DBCache_Lookup(guid, DB_CACHE_FIND_SOUND, alias, path, sizeof(path), &found)) {
+        if (found) {
+            safeStrCopy(outFilePath, path, outLen);
+        } else {
+            setError("Sound not found in local library or playlists");
+        }
+        return found;
+    }
+
+    beginCachedQuery();
+    path[0] = '\0';
+    found = queryFindSoundByAlias(guid, alias, path, sizeof(path));
+    if (resultCacheable()) {
+        DBCache_Store(guid, DB_CACHE_FIND_SOUND, alias, path, sizeof(path), found);
+    }
+    if (found) {
+        safeStrCopy(outFilePath, path, outLen);
+    }
+    return found;
+}
+
 bool DB_FindPublicSoundByAlias(const char *alias, char *outFilePath, int outLen) {
     if (!DB_IsConnected()) {
         setError("Not connected to database");
@@ -788,28 +1510,7 @@ bool DB_FindPublicSoundByAlias(const char *alias, char *outFilePath, int outLen)
      *
      * Use UNION to combine both sources and return first match.
      */
-    PGresult *res = PQexecParams(g_db.conn,
-        "SELECT file_path FROM ("
-        "  SELECT sf.file_path, 1 as priority "
-        "  FROM sound_files sf "
-        "  WHERE sf.is_public = true "
-        "    AND (sf.original_name = $1 OR sf.original_name = $1 || '.mp3') "
-        "  UNION ALL "
-        "  SELECT sf.file_path, 2 as priority "
-        "  FROM user_sounds us "
-        "  JOIN sound_files sf ON sf.id = us.sound_file_id "
-        "  WHERE us.visibility = 'public' AND us.alias = $1 "
-        "  UNION ALL "
-        "  SELECT sf.file_path, 3 as priority "
-        "  FROM sound_playlist_items pi "
-        "  JOIN sound_playlists p ON p.id = pi.playlist_id "
-        "  JOIN user_sounds us ON us.id = pi.user_sound_id "
-        "  JOIN sound_files sf ON sf.id = us.sound_file_id "
-        "  WHERE p.is_public = true AND us.alias = $1 "
-        ") sub "
-        "ORDER BY priority ASC "
-        "LIMIT 1",
-        1, NULL, params, NULL, NULL, 0);
+    PGresult *res = execStatement(STMT_FIND_PUBLIC_SOUND_BY_ALIAS, params);
 
     if (!checkResult(res, PGRES_TUPLES_OK)) {
         return false;
@@ -833,6 +1534,8 @@ bool DB_AddFromPublic(const char *guid, int soundFileId, const char *alias) {
         return false;
     }
 
+    DBCache_InvalidateGuid(guid);
+
     /* Transaction */
     PGresult *res = PQexec(g_db.conn, "BEGIN");
     if (!checkResult(res, PGRES_COMMAND_OK)) {
@@ -875,6 +1578,8 @@ bool DB_AddFromPublic(const char *guid, int soundFileId, const char *alias) {
     }
     PQclear(res);
 
+    SoundIndex_Invalidate(guid);
+
     printf("DB_AddFromPublic: Added file_id=%d as '%s' for GUID %s\n",
            soundFileId, alias, guid);
     return true;
@@ -892,6 +1597,8 @@ bool DB_CreatePlaylist(const char *guid, const char *name,
         return false;
     }
 
+    DBCache_InvalidateGuid(guid);
+
     const char *params[3] = { guid, name, description ? description : "" };
     PGresult *res = PQexecParams(g_db.conn,
         "INSERT INTO sound_playlists (guid, name, description, is_public, current_position) "
@@ -917,6 +1624,8 @@ bool DB_DeletePlaylist(const char *guid, const char *name) {
         return false;
     }
 
+    DBCache_InvalidateGuid(guid);
+
     const char *params[2] = { guid, name };
     PGresult *res = PQexecParams(g_db.conn,
         "DELETE FROM sound_playlists WHERE guid = $1 AND name = $2",
@@ -934,6 +1643,8 @@ bool DB_DeletePlaylist(const char *guid, const char *name) {
         return false;
     }
 
+    SoundIndex_Invalidate("");      /* Public playlists make sounds public */
+
     printf("DB_DeletePlaylist: Deleted '%s' for GUID %s\n", name, guid);
     return true;
 }
@@ -1037,6 +1748,8 @@ bool DB_AddToPlaylist(const char *guid, const char *playlistName,
         return false;
     }
 
+    DBCache_InvalidateGuid(guid);
+
     /* Get playlist ID and user_sound ID */
     const char *params[3] = { guid, playlistName, soundAlias };
     PGresult *res = PQexecParams(g_db.conn,
@@ -1078,6 +1791,8 @@ bool DB_AddToPlaylist(const char *guid, const char *playlistName,
     }
     PQclear(res);
 
+    SoundIndex_Invalidate("");      /* Public playlists make sounds public */
+
     printf("DB_AddToPlaylist: Added '%s' to playlist '%s' at position %d\n",
            soundAlias, playlistName, orderNumber);
     return true;
@@ -1090,6 +1805,8 @@ bool DB_RemoveFromPlaylist(const char *guid, const char *playlistName,
         return false;
     }
 
+    DBCache_InvalidateGuid(guid);
+
     const char *params[3] = { guid, playlistName, soundAlias };
     PGresult *res = PQexecParams(g_db.conn,
         "DELETE FROM sound_playlist_items pi "
@@ -1110,6 +1827,8 @@ bool DB_RemoveFromPlaylist(const char *guid, const char *playlistName,
         return false;
     }
 
+    SoundIndex_Invalidate("");      /* Public playlists make sounds public */
+
     printf("DB_RemoveFromPlaylist: Removed '%s' from playlist '%s'\n",
            soundAlias, playlistName);
     return true;
@@ -1122,6 +1841,8 @@ bool DB_ReorderPlaylist(const char *guid, const char *playlistName,
         return false;
     }
 
+    DBCache_InvalidateGuid(guid);
+
     /* Get playlist ID */
     const char *params[2] = { guid, playlistName };
     PGresult *res = PQexecParams(g_db.conn,
@@ -1188,9 +1909,7 @@ int DB_GetPlaylistPosition(const char *guid, const char *playlistName) {
     }
 
     const char *params[2] = { guid, playlistName };
-    PGresult *res = PQexecParams(g_db.conn,
-        "SELECT current_position FROM sound_playlists WHERE guid = $1 AND name = $2",
-        2, NULL, params, NULL, NULL, 0);
+    PGresult *res = execStatement(STMT_PLAYLIST_POSITION, params);
 
     if (!checkResult(res, PGRES_TUPLES_OK)) {
         return -1;
@@ -1217,10 +1936,7 @@ bool DB_SetPlaylistPosition(const char *guid, const char *playlistName, int posi
     snprintf(positionStr, sizeof(positionStr), "%d", position);
 
     const char *params[3] = { positionStr, guid, playlistName };
-    PGresult *res = PQexecParams(g_db.conn,
-        "UPDATE sound_playlists SET current_position = $1, updated_at = NOW() "
-        "WHERE guid = $2 AND name = $3",
-        3, NULL, params, NULL, NULL, 0);
+    PGresult *res = execStatement(STMT_SET_PLAYLIST_POSITION, params);
 
     if (!checkResult(res, PGRES_COMMAND_OK)) {
         return false;
@@ -1250,15 +1966,7 @@ bool DB_GetPlaylistSoundAtPosition(const char *guid, const char *playlistName,
     snprintf(positionStr, sizeof(positionStr), "%d", targetPosition);
 
     const char *params[3] = { guid, playlistName, positionStr };
-    PGresult *res = PQexecParams(g_db.conn,
-        "SELECT pi.id, pi.playlist_id, pi.user_sound_id, pi.order_number, pi.added_at, "
-        "us.alias, sf.file_path, sf.duration_seconds "
-        "FROM sound_playlist_items pi "
-        "JOIN sound_playlists p ON p.id = pi.playlist_id "
-        "JOIN user_sounds us ON us.id = pi.user_sound_id "
-        "JOIN sound_files sf ON sf.id = us.sound_file_id "
-        "WHERE p.guid = $1 AND p.name = $2 AND pi.order_number = $3",
-        3, NULL, params, NULL, NULL, 0);
+    PGresult *res = execStatement(STMT_PLAYLIST_SOUND_AT, params);
 
     if (!checkResult(res, PGRES_TUPLES_OK)) {
         return false;
@@ -1383,15 +2091,7 @@ bool DB_GetPublicPlaylistSoundAtPosition(const char *playlistName, int position,
     snprintf(positionStr, sizeof(positionStr), "%d", position);
 
     const char *params[2] = { playlistName, positionStr };
-    PGresult *res = PQexecParams(g_db.conn,
-        "SELECT pi.id, pi.playlist_id, pi.user_sound_id, pi.order_number, pi.added_at, "
-        "us.alias, sf.file_path, sf.duration_seconds "
-        "FROM sound_playlist_items pi "
-        "JOIN sound_playlists p ON p.id = pi.playlist_id "
-        "JOIN user_sounds us ON us.id = pi.user_sound_id "
-        "JOIN sound_files sf ON sf.id = us.sound_file_id "
-        "WHERE p.is_public = true AND p.name = $1 AND pi.order_number = $2",
-        2, NULL, params, NULL, NULL, 0);
+    PGresult *res = execStatement(STMT_PUBLIC_PLAYLIST_SOUND_AT, params);
 
     if (!checkResult(res, PGRES_TUPLES_OK)) {
         return false;
@@ -1422,6 +2122,8 @@ bool DB_SetPlaylistVisibility(const char *guid, const char *playlistName, bool i
         return false;
     }
 
+    DBCache_InvalidateGuid(guid);
+
     const char *params[3] = { isPublic ? "true" : "false", guid, playlistName };
     PGresult *res = PQexecParams(g_db.conn,
         "UPDATE sound_playlists SET is_public = $1, updated_at = NOW() "
@@ -1440,6 +2142,7 @@ bool DB_SetPlaylistVisibility(const char *guid, const char *playlistName, bool i
         return false;
     }
 
+    SoundIndex_Invalidate("");      /* Public playlists make sounds public */
     return true;
 }
 
@@ -1592,6 +2295,8 @@ bool DB_AcceptShare(const char *toGuid, const char *fromGuid,
         return false;
     }
 
+    DBCache_InvalidateGuid(toGuid);
+
     /* Transaction */
     PGresult *res = PQexec(g_db.conn, "BEGIN");
     if (!checkResult(res, PGRES_COMMAND_OK)) {
@@ -1656,6 +2361,8 @@ bool DB_AcceptShare(const char *toGuid, const char *fromGuid,
     }
     PQclear(res);
 
+    SoundIndex_Invalidate(toGuid);
+
     printf("DB_AcceptShare: %s accepted share from %s (file_id=%d)\n",
            toGuid, fromGuid, soundFileId);
     return true;
@@ -1818,12 +2525,78 @@ bool DB_ExecuteRaw(const char *query) {
     return success;
 }
 
+/*
+ * Helper: Monotonic time in seconds
+ */
+static double benchNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void benchReport(const char *mode, int queries, double elapsed) {
+    printf("DB_RunBenchmark: %-10s %6d queries in %8.1f ms = %8.0f queries/sec\n",
+           mode, queries, elapsed * 1000.0, elapsed > 0 ? queries / elapsed : 0.0);
+}
+
+void DB_RunBenchmark(int iterations) {
+    if (!DB_IsConnected()) {
+        printf("DB_RunBenchmark: Not connected to database\n");
+        return;
+    }
+    if (iterations < 1) iterations = 1;
+
+    /* Lookups that miss, so every mode does the same index work */
+    const char *guid = "00000000000000000000000000000000";
+    const char *userParams[2] = { guid, "0" };
+    const char *publicParams[1] = { "0" };
+    const char *aliasParams[2] = { guid, "etman_bench" };
+    const DBPipelineQuery queries[4] = {
+        { STMT_SOUND_BY_ID_USER, userParams },
+        { STMT_SOUND_BY_ID_PUBLIC, publicParams },
+        { STMT_SOUND_BY_ALIAS, aliasParams },
+        { STMT_FIND_SOUND_BY_ALIAS, aliasParams }
+    };
+    PGresult *results[4];
+    int total = iterations * 4;
+
+    /* Unprepared: SQL text parsed and planned on every call */
+    double start = benchNow();
+    for (int n = 0; n < iterations; n++) {
+        for (int i = 0; i < 4; i++) {
+            const DBStatement *stmt = &g_statements[queries[i].id];
+            PQclear(PQexecParams(g_db.conn, stmt->sql, stmt->nParams, NULL,
+                                 queries[i].params, NULL, NULL, 0));
+        }
+    }
+    benchReport("unprepared", total, benchNow() - start);
+
+    /* Prepared: one round trip per query */
+    start = benchNow();
+    for (int n = 0; n < iterations; n++) {
+        for (int i = 0; i < 4; i++) {
+            PQclear(execStatement(queries[i].id, queries[i].params));
+        }
+    }
+    benchReport("prepared", total, benchNow() - start);
+
+    /* Pipelined: one round trip per 4 queries */
+    start = benchNow();
+    for (int n = 0; n < iterations; n++) {
+        execPipeline(queries, 4, results);
+        for (int i = 0; i < 4; i++) {
+            PQclear(results[i]);
+        }
+    }
+    benchReport("pipelined", total, benchNow() - start);
+}
+
 
 /*
  * Dynamic sound menu operations
  */
 
-bool DB_GetUserMenus(const char *guid, DBMenuResult *outResult) {
+static bool queryUserMenus(const char *guid, DBMenuResult *outResult) {
     if (!outResult) return false;
     memset(outResult, 0, sizeof(*outResult));
 
@@ -1838,44 +2611,7 @@ bool DB_GetUserMenus(const char *guid, DBMenuResult *outResult) {
      * 3. Playlist items within menus (item_type='playlist' in menu_items)
      */
     const char *params[1] = { guid };
-    PGresult *res = PQexecParams(g_db.conn,
-        "SELECT menu_position, menu_name, is_playlist, item_position, item_name, sound_alias FROM ("
-        "  /* Manual sound items (item_type='sound') */"
-        "  SELECT m.menu_position, m.menu_name, false as is_playlist, "
-        "         mi.item_position, COALESCE(mi.display_name, us.alias) as item_name, us.alias as sound_alias "
-        "  FROM user_sound_menus m "
-        "  JOIN user_sound_menu_items mi ON mi.menu_id = m.id "
-        "  JOIN user_sounds us ON us.id = mi.sound_id "
-        "  WHERE m.user_guid = $1 AND mi.item_type = 'sound' "
-        "  UNION ALL "
-        "  /* Playlist-backed menus (menu.playlist_id set) */"
-        "  SELECT m.menu_position, m.menu_name, true as is_playlist, "
-        "         pi.order_number as item_position, us.alias as item_name, us.alias as sound_alias "
-        "  FROM user_sound_menus m "
-        "  JOIN sound_playlists p ON p.id = m.playlist_id "
-        "  JOIN sound_playlist_items pi ON pi.playlist_id = p.id "
-        "  JOIN user_sounds us ON us.id = pi.user_sound_id "
-        "  WHERE m.user_guid = $1 AND m.playlist_id IS NOT NULL "
-        "  UNION ALL "
-        "  /* Playlist items within menu (item_type='playlist') - expand playlist sounds */"
-        "  SELECT m.menu_position, m.menu_name, true as is_playlist, "
-        "         pi.order_number as item_position, us.alias as item_name, us.alias as sound_alias "
-        "  FROM user_sound_menus m "
-        "  JOIN user_sound_menu_items mi ON mi.menu_id = m.id "
-        "  JOIN sound_playlist_items pi ON pi.playlist_id = mi.playlist_id "
-        "  JOIN user_sounds us ON us.id = pi.user_sound_id "
-        "  WHERE m.user_guid = $1 AND mi.item_type = 'playlist' "
-        "  UNION ALL "
-        "  /* Menus with no items (empty) */"
-        "  SELECT m.menu_position, m.menu_name, false as is_playlist, "
-        "         NULL::int as item_position, NULL as item_name, NULL as sound_alias "
-        "  FROM user_sound_menus m "
-        "  LEFT JOIN user_sound_menu_items mi ON mi.menu_id = m.id "
-        "  LEFT JOIN sound_playlist_items pi ON pi.playlist_id = m.playlist_id "
-        "  WHERE m.user_guid = $1 AND mi.id IS NULL AND pi.id IS NULL "
-        ") combined "
-        "ORDER BY menu_position, item_position NULLS LAST",
-        1, NULL, params, NULL, NULL, 0);
+    PGresult *res = execStatement(STMT_USER_MENUS, params);
 
     if (!checkResult(res, PGRES_TUPLES_OK)) {
         return false;
@@ -1916,6 +2652,22 @@ bool DB_GetUserMenus(const char *guid, DBMenuResult *outResult) {
     return true;
 }
 
+bool DB_GetUserMenus(const char *guid, DBMenuResult *outResult) {
+    bool ok;
+
+    if (!outResult) return false;
+    if (DBCache_Lookup(guid, DB_CACHE_USER_MENUS, "", outResult, sizeof(*outResult), &ok)) {
+        return ok;
+    }
+
+    beginCachedQuery();
+    ok = queryUserMenus(guid, outResult);
+    if (resultCacheable()) {
+        DBCache_Store(guid, DB_CACHE_USER_MENUS, "", outResult, sizeof(*outResult), ok);
+    }
+    return ok;
+}
+
 bool DB_GetMenuItemSound(const char *guid, int menuPos, int itemPos,
                          char *outFilePath, int outLen) {
     if (outFilePath && outLen > 0) outFilePath[0] = '\0';
@@ -1930,34 +2682,7 @@ bool DB_GetMenuItemSound(const char *guid, int menuPos, int itemPos,
     snprintf(itemPosStr, sizeof(itemPosStr), "%d", itemPos);
 
     const char *params[3] = { guid, menuPosStr, itemPosStr };
-    PGresult *res = PQexecParams(g_db.conn,
-        "SELECT file_path FROM ("
-        "  /* Manual sound items (item_type='sound') */"
-        "  SELECT sf.file_path, mi.item_position "
-        "  FROM user_sound_menu_items mi "
-        "  JOIN user_sound_menus m ON m.id = mi.menu_id "
-        "  JOIN user_sounds us ON us.id = mi.sound_id "
-        "  JOIN sound_files sf ON sf.id = us.sound_file_id "
-        "  WHERE m.user_guid = $1 AND m.menu_position = $2 AND mi.item_type = 'sound' "
-        "  UNION ALL "
-        "  /* Playlist-backed menus (menu.playlist_id set) */"
-        "  SELECT sf.file_path, pi.order_number as item_position "
-        "  FROM user_sound_menus m "
-        "  JOIN sound_playlist_items pi ON pi.playlist_id = m.playlist_id "
-        "  JOIN user_sounds us ON us.id = pi.user_sound_id "
-        "  JOIN sound_files sf ON sf.id = us.sound_file_id "
-        "  WHERE m.user_guid = $1 AND m.menu_position = $2 AND m.playlist_id IS NOT NULL "
-        "  UNION ALL "
-        "  /* Playlist items within menu (item_type='playlist') */"
-        "  SELECT sf.file_path, pi.order_number as item_position "
-        "  FROM user_sound_menu_items mi "
-        "  JOIN user_sound_menus m ON m.id = mi.menu_id "
-        "  JOIN sound_playlist_items pi ON pi.playlist_id = mi.playlist_id "
-        "  JOIN user_sounds us ON us.id = pi.user_sound_id "
-        "  JOIN sound_files sf ON sf.id = us.sound_file_id "
-        "  WHERE m.user_guid = $1 AND m.menu_position = $2 AND mi.item_type = 'playlist' "
-        ") combined WHERE item_position = $3",
-        3, NULL, params, NULL, NULL, 0);
+    PGresult *res = execStatement(STMT_MENU_ITEM_SOUND, params);
 
     if (!checkResult(res, PGRES_TUPLES_OK)) {
         return false;
@@ -1982,7 +2707,7 @@ bool DB_GetMenuItemSound(const char *guid, int menuPos, int itemPos,
  * isServerMenu=true returns server default menus (all players see the same)
  * isServerMenu=false returns player's personal menus
  */
-bool DB_GetMenuPage(const char *guid, int menuId, int pageOffset, bool isServerMenu, DBMenuPageResult *outResult) {
+static bool queryMenuPage(const char *guid, int menuId, int pageOffset, bool isServerMenu, DBMenuPageResult *outResult) {
     if (!outResult) return false;
     memset(outResult, 0, sizeof(*outResult));
     outResult->found = false;
@@ -2007,43 +2732,11 @@ bool DB_GetMenuPage(const char *guid, int menuId, int pageOffset, bool isServerM
         if (isServerMenu) {
             /* Server root items - all players see the same items */
             const char *params[2] = { limitStr, offsetStr };
-            res = PQexecParams(g_db.conn,
-                "SELECT "
-                "  i.item_position, "
-                "  i.item_type, "
-                "  COALESCE(i.display_name, us.alias, m.menu_name, p.name) as display_name, "
-                "  us.alias as sound_alias, "
-                "  i.nested_menu_id, "
-                "  i.playlist_id, "
-                "  (SELECT COUNT(*) FROM user_sound_menu_items WHERE menu_id IS NULL AND is_server_default = true) as total_count "
-                "FROM user_sound_menu_items i "
-                "LEFT JOIN user_sounds us ON i.sound_id = us.id "
-                "LEFT JOIN user_sound_menus m ON i.nested_menu_id = m.id "
-                "LEFT JOIN sound_playlists p ON i.playlist_id = p.id "
-                "WHERE i.menu_id IS NULL AND i.is_server_default = true "
-                "ORDER BY i.item_position "
-                "LIMIT $1 OFFSET $2",
-                2, NULL, params, NULL, NULL, 0);
+            res = execStatement(STMT_MENU_ROOT_SERVER, params);
         } else {
             /* Personal root items - specific to the player */
             const char *params[3] = { guid, limitStr, offsetStr };
-            res = PQexecParams(g_db.conn,
-                "SELECT "
-                "  i.item_position, "
-                "  i.item_type, "
-                "  COALESCE(i.display_name, us.alias, m.menu_name, p.name) as display_name, "
-                "  us.alias as sound_alias, "
-                "  i.nested_menu_id, "
-                "  i.playlist_id, "
-                "  (SELECT COUNT(*) FROM user_sound_menu_items WHERE menu_id IS NULL AND user_guid = $1 AND (is_server_default = false OR is_server_default IS NULL)) as total_count "
-                "FROM user_sound_menu_items i "
-                "LEFT JOIN user_sounds us ON i.sound_id = us.id "
-                "LEFT JOIN user_sound_menus m ON i.nested_menu_id = m.id "
-                "LEFT JOIN sound_playlists p ON i.playlist_id = p.id "
-                "WHERE i.menu_id IS NULL AND i.user_guid = $1 AND (i.is_server_default = false OR i.is_server_default IS NULL) "
-                "ORDER BY i.item_position "
-                "LIMIT $2 OFFSET $3",
-                3, NULL, params, NULL, NULL, 0);
+            res = execStatement(STMT_MENU_ROOT_PERSONAL, params);
         }
 
         if (!checkResult(res, PGRES_TUPLES_OK)) {
@@ -2126,41 +2819,10 @@ bool DB_GetMenuPage(const char *guid, int menuId, int pageOffset, bool isServerM
 
         if (isServerMenu) {
             const char *snapParams[1] = { playlistIdStr };
-            snapshotRes = PQexecParams(g_db.conn,
-                "SELECT "
-                "  playlist_snapshot->'originalPlaylistName' as playlist_name, "
-                "  elem->>'position' as position, "
-                "  elem->>'originalAlias' as original_alias, "
-                "  elem->>'displayName' as display_name, "
-                "  elem->>'filePath' as file_path, "
-                "  jsonb_array_length(playlist_snapshot->'items') as total_items "
-                "FROM user_sound_menu_items, "
-                "     jsonb_array_elements(playlist_snapshot->'items') as elem "
-                "WHERE playlist_id = $1 "
-                "  AND is_server_default = true "
-                "  AND playlist_snapshot IS NOT NULL "
-                "ORDER BY (elem->>'position')::int "
-                "LIMIT 9",
-                1, NULL, snapParams, NULL, NULL, 0);
+            snapshotRes = execStatement(STMT_PLAYLIST_SNAPSHOT_SERVER, snapParams);
         } else {
             const char *snapParams[2] = { guid, playlistIdStr };
-            snapshotRes = PQexecParams(g_db.conn,
-                "SELECT "
-                "  playlist_snapshot->'originalPlaylistName' as playlist_name, "
-                "  elem->>'position' as position, "
-                "  elem->>'originalAlias' as original_alias, "
-                "  elem->>'displayName' as display_name, "
-                "  elem->>'filePath' as file_path, "
-                "  jsonb_array_length(playlist_snapshot->'items') as total_items "
-                "FROM user_sound_menu_items, "
-                "     jsonb_array_elements(playlist_snapshot->'items') as elem "
-                "WHERE user_guid = $1 "
-                "  AND playlist_id = $2 "
-                "  AND (is_server_default = false OR is_server_default IS NULL) "
-                "  AND playlist_snapshot IS NOT NULL "
-                "ORDER BY (elem->>'position')::int "
-                "LIMIT 9",
-                2, NULL, snapParams, NULL, NULL, 0);
+            snapshotRes = execStatement(STMT_PLAYLIST_SNAPSHOT_PERSONAL, snapParams);
         }
 
         int snapshotRows = 0;
@@ -2186,29 +2848,11 @@ bool DB_GetMenuPage(const char *guid, int menuId, int pageOffset, bool isServerM
         if (isServerMenu) {
             /* Server playlist - no guid filter, playlist must be public or linked to server */
             const char *params[3] = { playlistIdStr, limitStr, offsetStr };
-            res = PQexecParams(g_db.conn,
-                "SELECT pi.order_number, us.alias, us.id, p.name, "
-                "       (SELECT COUNT(*) FROM sound_playlist_items WHERE playlist_id = $1) as total_items "
-                "FROM sound_playlist_items pi "
-                "JOIN user_sounds us ON us.id = pi.user_sound_id "
-                "JOIN sound_playlists p ON p.id = pi.playlist_id "
-                "WHERE p.id = $1 "
-                "ORDER BY pi.order_number "
-                "LIMIT $2 OFFSET $3",
-                3, NULL, params, NULL, NULL, 0);
+            res = execStatement(STMT_MENU_PLAYLIST_SERVER, params);
         } else {
             /* Personal playlist - filter by guid */
             const char *params[4] = { guid, playlistIdStr, limitStr, offsetStr };
-            res = PQexecParams(g_db.conn,
-                "SELECT pi.order_number, us.alias, us.id, p.name, "
-                "       (SELECT COUNT(*) FROM sound_playlist_items WHERE playlist_id = $2) as total_items "
-                "FROM sound_playlist_items pi "
-                "JOIN user_sounds us ON us.id = pi.user_sound_id "
-                "JOIN sound_playlists p ON p.id = pi.playlist_id "
-                "WHERE p.guid = $1 AND p.id = $2 "
-                "ORDER BY pi.order_number "
-                "LIMIT $3 OFFSET $4",
-                4, NULL, params, NULL, NULL, 0);
+            res = execStatement(STMT_MENU_PLAYLIST_PERSONAL, params);
         }
 
         if (!checkResult(res, PGRES_TUPLES_OK)) {
@@ -2297,101 +2941,11 @@ bool DB_GetMenuPage(const char *guid, int menuId, int pageOffset, bool isServerM
         if (isServerMenu) {
             /* Server menu - query by ID only, check is_server_default */
             const char *params[3] = { menuIdStr, limitStr, offsetStr };
-            res = PQexecParams(g_db.conn,
-                "SELECT item_position, item_type, display_name, sound_alias, nested_menu_id, menu_name, total_items FROM ("
-                "  /* Sound items (item_type='sound') */"
-                "  SELECT mi.item_position, 'sound'::text as item_type, "
-                "         COALESCE(mi.display_name, us.alias) as display_name, "
-                "         us.alias as sound_alias, NULL::int as nested_menu_id, "
-                "         m.menu_name, "
-                "         (SELECT COUNT(*) FROM user_sound_menu_items WHERE menu_id = m.id) as total_items "
-                "  FROM user_sound_menus m "
-                "  JOIN user_sound_menu_items mi ON mi.menu_id = m.id "
-                "  JOIN user_sounds us ON us.id = mi.sound_id "
-                "  WHERE m.id = $1 AND m.is_server_default = true AND mi.item_type = 'sound' "
-                "  UNION ALL "
-                "  /* Nested menu items (item_type='menu') */"
-                "  SELECT mi.item_position, 'menu'::text as item_type, "
-                "         COALESCE(mi.display_name, nm.menu_name) as display_name, "
-                "         NULL as sound_alias, mi.nested_menu_id, "
-                "         m.menu_name, "
-                "         (SELECT COUNT(*) FROM user_sound_menu_items WHERE menu_id = m.id) as total_items "
-                "  FROM user_sound_menus m "
-                "  JOIN user_sound_menu_items mi ON mi.menu_id = m.id "
-                "  JOIN user_sound_menus nm ON nm.id = mi.nested_menu_id "
-                "  WHERE m.id = $1 AND m.is_server_default = true AND mi.item_type = 'menu' "
-                "  UNION ALL "
-                "  /* Playlist items (item_type='playlist') - show as navigable item with negative playlist ID */"
-                "  SELECT mi.item_position, 'playlist'::text as item_type, "
-                "         COALESCE(mi.display_name, p.name) as display_name, "
-                "         NULL as sound_alias, -mi.playlist_id as nested_menu_id, "
-                "         m.menu_name, "
-                "         (SELECT COUNT(*) FROM user_sound_menu_items WHERE menu_id = m.id) as total_items "
-                "  FROM user_sound_menus m "
-                "  JOIN user_sound_menu_items mi ON mi.menu_id = m.id "
-                "  JOIN sound_playlists p ON p.id = mi.playlist_id "
-                "  WHERE m.id = $1 AND m.is_server_default = true AND mi.item_type = 'playlist' "
-                "  UNION ALL "
-                "  /* Playlist-backed menu (menu.playlist_id set, entire menu is a playlist) */"
-                "  SELECT pi.order_number as item_position, 'sound'::text as item_type, "
-                "         us.alias as display_name, us.alias as sound_alias, NULL::int as nested_menu_id, "
-                "         m.menu_name, "
-                "         (SELECT COUNT(*) FROM sound_playlist_items WHERE playlist_id = m.playlist_id) as total_items "
-                "  FROM user_sound_menus m "
-                "  JOIN sound_playlist_items pi ON pi.playlist_id = m.playlist_id "
-                "  JOIN user_sounds us ON us.id = pi.user_sound_id "
-                "  WHERE m.id = $1 AND m.is_server_default = true AND m.playlist_id IS NOT NULL "
-                ") combined ORDER BY item_position LIMIT $2 OFFSET $3",
-                3, NULL, params, NULL, NULL, 0);
+            res = execStatement(STMT_MENU_ITEMS_SERVER, params);
         } else {
             /* Personal menu - query by user_guid and ID */
             const char *params[4] = { guid, menuIdStr, limitStr, offsetStr };
-            res = PQexecParams(g_db.conn,
-                "SELECT item_position, item_type, display_name, sound_alias, nested_menu_id, menu_name, total_items FROM ("
-                "  /* Sound items (item_type='sound') */"
-                "  SELECT mi.item_position, 'sound'::text as item_type, "
-                "         COALESCE(mi.display_name, us.alias) as display_name, "
-                "         us.alias as sound_alias, NULL::int as nested_menu_id, "
-                "         m.menu_name, "
-                "         (SELECT COUNT(*) FROM user_sound_menu_items WHERE menu_id = m.id) as total_items "
-                "  FROM user_sound_menus m "
-                "  JOIN user_sound_menu_items mi ON mi.menu_id = m.id "
-                "  JOIN user_sounds us ON us.id = mi.sound_id "
-                "  WHERE m.user_guid = $1 AND m.id = $2 AND m.is_server_default = false AND mi.item_type = 'sound' "
-                "  UNION ALL "
-                "  /* Nested menu items (item_type='menu') */"
-                "  SELECT mi.item_position, 'menu'::text as item_type, "
-                "         COALESCE(mi.display_name, nm.menu_name) as display_name, "
-                "         NULL as sound_alias, mi.nested_menu_id, "
-                "         m.menu_name, "
-                "         (SELECT COUNT(*) FROM user_sound_menu_items WHERE menu_id = m.id) as total_items "
-                "  FROM user_sound_menus m "
-                "  JOIN user_sound_menu_items mi ON mi.menu_id = m.id "
-                "  JOIN user_sound_menus nm ON nm.id = mi.nested_menu_id "
-                "  WHERE m.user_guid = $1 AND m.id = $2 AND m.is_server_default = false AND mi.item_type = 'menu' "
-                "  UNION ALL "
-                "  /* Playlist items (item_type='playlist') - show as navigable item with negative playlist ID */"
-                "  SELECT mi.item_position, 'playlist'::text as item_type, "
-                "         COALESCE(mi.display_name, p.name) as display_name, "
-                "         NULL as sound_alias, -mi.playlist_id as nested_menu_id, "
-                "         m.menu_name, "
-                "         (SELECT COUNT(*) FROM user_sound_menu_items WHERE menu_id = m.id) as total_items "
-                "  FROM user_sound_menus m "
-                "  JOIN user_sound_menu_items mi ON mi.menu_id = m.id "
-                "  JOIN sound_playlists p ON p.id = mi.playlist_id "
-                "  WHERE m.user_guid = $1 AND m.id = $2 AND m.is_server_default = false AND mi.item_type = 'playlist' "
-                "  UNION ALL "
-                "  /* Playlist-backed menu (menu.playlist_id set, entire menu is a playlist) */"
-                "  SELECT pi.order_number as item_position, 'sound'::text as item_type, "
-                "         us.alias as display_name, us.alias as sound_alias, NULL::int as nested_menu_id, "
-                "         m.menu_name, "
-                "         (SELECT COUNT(*) FROM sound_playlist_items WHERE playlist_id = m.playlist_id) as total_items "
-                "  FROM user_sound_menus m "
-                "  JOIN sound_playlist_items pi ON pi.playlist_id = m.playlist_id "
-                "  JOIN user_sounds us ON us.id = pi.user_sound_id "
-                "  WHERE m.user_guid = $1 AND m.id = $2 AND m.is_server_default = false AND m.playlist_id IS NOT NULL "
-                ") combined ORDER BY item_position LIMIT $3 OFFSET $4",
-                4, NULL, params, NULL, NULL, 0);
+            res = execStatement(STMT_MENU_ITEMS_PERSONAL, params);
         }
 
         if (!checkResult(res, PGRES_TUPLES_OK)) {
@@ -2405,15 +2959,11 @@ bool DB_GetMenuPage(const char *guid, int menuId, int pageOffset, bool isServerM
             if (isServerMenu) {
                 /* Server menu - just check by ID */
                 const char *checkParams[1] = { menuIdStr };
-                res = PQexecParams(g_db.conn,
-                    "SELECT menu_name FROM user_sound_menus WHERE id = $1 AND is_server_default = true",
-                    1, NULL, checkParams, NULL, NULL, 0);
+                res = execStatement(STMT_MENU_NAME_SERVER, checkParams);
             } else {
                 /* Personal menu - check by user_guid and ID */
                 const char *checkParams[2] = { guid, menuIdStr };
-                res = PQexecParams(g_db.conn,
-                    "SELECT menu_name FROM user_sound_menus WHERE user_guid = $1 AND id = $2 AND is_server_default = false",
-                    2, NULL, checkParams, NULL, NULL, 0);
+                res = execStatement(STMT_MENU_NAME_PERSONAL, checkParams);
             }
             if (checkResult(res, PGRES_TUPLES_OK) && PQntuples(res) > 0) {
                 outResult->found = true;
@@ -2464,6 +3014,26 @@ bool DB_GetMenuPage(const char *guid, int menuId, int pageOffset, bool isServerM
     return outResult->found;
 }
 
+bool DB_GetMenuPage(const char *guid, int menuId, int pageOffset, bool isServerMenu, DBMenuPageResult *outResult) {
+    /* Server menus are the same for everyone: share one entry */
+    const char *owner = isServerMenu ? "" : guid;
+    char key[32];
+    bool found;
+
+    if (!outResult) return false;
+    snprintf(key, sizeof(key), "%d:%d", menuId, pageOffset);
+    if (DBCache_Lookup(owner, DB_CACHE_MENU_PAGE, key, outResult, sizeof(*outResult), &found)) {
+        return found;
+    }
+
+    beginCachedQuery();
+    found = queryMenuPage(guid, menuId, pageOffset, isServerMenu, outResult);
+    if (resultCacheable()) {
+        DBCache_Store(owner, DB_CACHE_MENU_PAGE, key, outResult, sizeof(*outResult), found);
+    }
+    return found;
+}
+
 /**
  * Get sound file path by database ID (user_sounds.id or sound_files.id for public).
  */
@@ -2481,36 +3051,19 @@ bool DB_GetSoundById(const char *guid, int soundId, char *outFilePath, int outLe
     char soundIdStr[16];
     snprintf(soundIdStr, sizeof(soundIdStr), "%d", soundId);
 
-    /* First try: user's personal library by user_sounds.id */
+    /* User's personal library by user_sounds.id, then public sound by
+     * sound_files.id; both lookups go out in one round trip */
     const char *params[2] = { guid, soundIdStr };
-    PGresult *res = PQexecParams(g_db.conn,
-        "SELECT sf.file_path, us.alias "
-        "FROM user_sounds us "
-        "JOIN sound_files sf ON sf.id = us.sound_file_id "
-        "WHERE us.guid = $1 AND us.id = $2",
-        2, NULL, params, NULL, NULL, 0);
-
-    if (checkResult(res, PGRES_TUPLES_OK) && PQntuples(res) > 0) {
-        strncpy(outFilePath, PQgetvalue(res, 0, 0), outLen - 1);
-        outFilePath[outLen - 1] = '\0';
-        if (outName && nameLen > 0) {
-            strncpy(outName, PQgetvalue(res, 0, 1), nameLen - 1);
-            outName[nameLen - 1] = '\0';
-        }
-        PQclear(res);
-        return true;
-    }
-    PQclear(res);
-
-    /* Second try: public sound by sound_files.id */
     const char *publicParams[1] = { soundIdStr };
-    res = PQexecParams(g_db.conn,
-        "SELECT file_path, original_name "
-        "FROM sound_files "
-        "WHERE id = $1 AND is_public = true",
-        1, NULL, publicParams, NULL, NULL, 0);
+    const DBPipelineQuery queries[2] = {
+        { STMT_SOUND_BY_ID_USER, params },
+        { STMT_SOUND_BY_ID_PUBLIC, publicParams }
+    };
+    PGresult *results[2];
+    execPipeline(queries, 2, results);
 
-    if (checkResult(res, PGRES_TUPLES_OK) && PQntuples(res) > 0) {
+    PGresult *res = firstResultWithRows(results, 2);
+    if (res) {
         strncpy(outFilePath, PQgetvalue(res, 0, 0), outLen - 1);
         outFilePath[outLen - 1] = '\0';
         if (outName && nameLen > 0) {
@@ -2520,7 +3073,6 @@ bool DB_GetSoundById(const char *guid, int soundId, char *outFilePath, int outLe
         PQclear(res);
         return true;
     }
-    PQclear(res);
 
     setError("Sound not found");
     return false;
@@ -2535,7 +3087,7 @@ bool DB_GetSoundById(const char *guid, int soundId, char *outFilePath, int outLe
  * Get player's quick command prefix.
  * Returns true if a custom prefix was found, false if using default "@".
  */
-bool DB_GetQuickCmdPrefix(const char *guid, char *outPrefix) {
+static bool queryQuickCmdPrefix(const char *guid, char *outPrefix) {
     if (!outPrefix) return false;
 
     /* Default prefix */
@@ -2549,9 +3101,7 @@ bool DB_GetQuickCmdPrefix(const char *guid, char *outPrefix) {
     }
 
     const char *params[1] = { guid };
-    PGresult *res = PQexecParams(g_db.conn,
-        "SELECT quick_cmd_prefix FROM player_settings WHERE guid = $1",
-        1, NULL, params, NULL, NULL, 0);
+    PGresult *res = execStatement(STMT_QUICK_PREFIX, params);
 
     if (!checkResult(res, PGRES_TUPLES_OK)) {
         return false;
@@ -2572,12 +3122,34 @@ bool DB_GetQuickCmdPrefix(const char *guid, char *outPrefix) {
     return true;
 }
 
+bool DB_GetQuickCmdPrefix(const char *guid, char *outPrefix) {
+    char prefix[5];
+    bool found;
+
+    if (!outPrefix) return false;
+    if (!guid || !guid[0]) {
+        strcpy(outPrefix, "@");
+        return false;
+    }
+
+    if (!DBCache_Lookup(guid, DB_CACHE_QUICK_PREFIX, "", prefix, sizeof(prefix), &found)) {
+        beginCachedQuery();
+        found = queryQuickCmdPrefix(guid, prefix);
+        if (resultCacheable()) {
+            DBCache_Store(guid, DB_CACHE_QUICK_PREFIX, "", prefix, sizeof(prefix), found);
+        }
+    }
+
+    memcpy(outPrefix, prefix, sizeof(prefix));
+    return found;
+}
+
 /**
  * Look up a quick command alias for a player.
  * Checks quick_command_aliases table first, then falls back to public sounds.
  */
-bool DB_LookupQuickCommand(const char *guid, const char *alias,
-                           DBQuickCmdResult *outResult) {
+static bool queryQuickCommand(const char *guid, const char *alias,
+                              DBQuickCmdResult *outResult) {
     if (!outResult) return false;
     memset(outResult, 0, sizeof(*outResult));
 
@@ -2593,17 +3165,7 @@ bool DB_LookupQuickCommand(const char *guid, const char *alias,
 
     /* Step 1: Check player's quick_command_aliases table */
     const char *params[2] = { guid, alias };
-    PGresult *res = PQexecParams(g_db.conn,
-        "SELECT "
-        "  COALESCE(sf1.file_path, sf2.file_path) AS file_path, "
-        "  COALESCE(sf1.id, sf2.id) AS sound_file_id, "
-        "  qca.chat_text "
-        "FROM quick_command_aliases qca "
-        "LEFT JOIN user_sounds us ON qca.user_sound_id = us.id "
-        "LEFT JOIN sound_files sf1 ON us.sound_file_id = sf1.id "
-        "LEFT JOIN sound_files sf2 ON qca.sound_file_id = sf2.id "
-        "WHERE qca.guid = $1 AND LOWER(qca.alias) = LOWER($2)",
-        2, NULL, params, NULL, NULL, 0);
+    PGresult *res = execStatement(STMT_QUICK_COMMAND, params);
 
     if (!checkResult(res, PGRES_TUPLES_OK)) {
         return false;
@@ -2632,9 +3194,43 @@ bool DB_LookupQuickCommand(const char *guid, const char *alias,
     return false;
 }
 
+bool DB_LookupQuickCommand(const char *guid, const char *alias,
+                           DBQuickCmdResult *outResult) {
+    char key[DB_CACHE_KEY_LEN];
+    bool found;
+
+    if (!outResult) return false;
+    if (!guid || !guid[0] || !alias || !alias[0]) {
+        memset(outResult, 0, sizeof(*outResult));
+        setError("Invalid GUID or alias");
+        return false;
+    }
+
+    /* Aliases match case-insensitively */
+    int i;
+    for (i = 0; alias[i] && i < (int)sizeof(key) - 1; i++) {
+        key[i] = (char)tolower((unsigned char)alias[i]);
+    }
+    key[i] = '\0';
+    if (alias[i]) {
+        return queryQuickCommand(guid, alias, outResult);   /* Too long to key */
+    }
+
+    if (DBCache_Lookup(guid, DB_CACHE_QUICK_COMMAND, key, outResult, sizeof(*outResult), &found)) {
+        return found;
+    }
+
+    beginCachedQuery();
+    found = queryQuickCommand(guid, alias, outResult);
+    if (resultCacheable()) {
+        DBCache_Store(guid, DB_CACHE_QUICK_COMMAND, key, outResult, sizeof(*outResult), found);
+    }
+    return found;
+}
+
 /**
  * Fuzzy search for public sounds by alias.
- * First tries exact match on original_name, then prefix match.
+ * Exact match on alias or original name first, then prefix, then word start.
  * Note: Public fallback does NOT include chat text.
  */
 bool DB_FuzzySearchPublicSound(const char *alias, char *outFilePath, int outLen,
@@ -2648,11 +3244,6 @@ bool DB_FuzzySearchPublicSound(const char *alias, char *outFilePath, int outLen,
         return false;
     }
 
-    if (!DB_IsConnected()) {
-        setError("Not connected to database");
-        return false;
-    }
-
     /*
      * A sound is considered "public" if:
      * 1. sound_files.is_public = true, OR
@@ -2662,59 +3253,9 @@ bool DB_FuzzySearchPublicSound(const char *alias, char *outFilePath, int outLen,
      * - user_sounds.alias (the alias the owner gave it)
      * - sound_files.original_name (the original filename)
      */
-
-    /* Step 1: Exact match on alias or original_name (case-insensitive) */
-    const char *params[1] = { alias };
-    PGresult *res = PQexecParams(g_db.conn,
-        "SELECT DISTINCT sf.file_path, sf.id FROM sound_files sf "
-        "LEFT JOIN user_sounds us ON us.sound_file_id = sf.id "
-        "LEFT JOIN sound_playlist_items spi ON spi.user_sound_id = us.id "
-        "LEFT JOIN sound_playlists sp ON spi.playlist_id = sp.id "
-        "WHERE (sf.is_public = true OR sp.is_public = true) "
-        "  AND (LOWER(REPLACE(sf.original_name, '.mp3', '')) = LOWER($1) "
-        "       OR LOWER(us.alias) = LOWER($1)) "
-        "LIMIT 1",
-        1, NULL, params, NULL, NULL, 0);
-
-    if (checkResult(res, PGRES_TUPLES_OK) && PQntuples(res) > 0) {
-        strncpy(outFilePath, PQgetvalue(res, 0, 0), outLen - 1);
-        outFilePath[outLen - 1] = '\0';
-        if (outSoundFileId) {
-            *outSoundFileId = atoi(PQgetvalue(res, 0, 1));
-        }
-        PQclear(res);
-        return true;
-    }
-    PQclear(res);
-
-    /* Step 2: Prefix/fuzzy match on alias or original_name (find shortest match) */
-    char likePattern[64];
-    snprintf(likePattern, sizeof(likePattern), "%s%%", alias);
-    const char *fuzzyParams[1] = { likePattern };
-
-    res = PQexecParams(g_db.conn,
-        "SELECT DISTINCT sf.file_path, sf.id, "
-        "  LEAST(LENGTH(COALESCE(us.alias, '')), LENGTH(sf.original_name)) as match_len "
-        "FROM sound_files sf "
-        "LEFT JOIN user_sounds us ON us.sound_file_id = sf.id "
-        "LEFT JOIN sound_playlist_items spi ON spi.user_sound_id = us.id "
-        "LEFT JOIN sound_playlists sp ON spi.playlist_id = sp.id "
-        "WHERE (sf.is_public = true OR sp.is_public = true) "
-        "  AND (LOWER(sf.original_name) LIKE LOWER($1) "
-        "       OR LOWER(us.alias) LIKE LOWER($1)) "
-        "ORDER BY match_len ASC LIMIT 1",
-        1, NULL, fuzzyParams, NULL, NULL, 0);
-
-    if (checkResult(res, PGRES_TUPLES_OK) && PQntuples(res) > 0) {
-        strncpy(outFilePath, PQgetvalue(res, 0, 0), outLen - 1);
-        outFilePath[outLen - 1] = '\0';
-        if (outSoundFileId) {
-            *outSoundFileId = atoi(PQgetvalue(res, 0, 1));
-        }
-        PQclear(res);
+    if (searchSoundIndex("", alias, outFilePath, outLen, outSoundFileId)) {
         return true;
     }
-    PQclear(res);
 
     setError("Public sound not found");
     return false;
@@ -2722,7 +3263,7 @@ bool DB_FuzzySearchPublicSound(const char *alias, char *outFilePath, int outLen,
 
 /**
  * Fuzzy search for a player's own sounds by alias.
- * First tries exact match, then prefix match on user_sounds.alias.
+ * Exact match first, then prefix, then word start.
  */
 bool DB_FuzzySearchUserSound(const char *guid, const char *alias,
                              char *outFilePath, int outLen, int *outSoundFileId) {
@@ -2735,61 +3276,9 @@ bool DB_FuzzySearchUserSound(const char *guid, const char *alias,
         return false;
     }
 
-    if (!DB_IsConnected()) {
-        setError("Not connected to database");
-        return false;
-    }
-
-    /* Step 1: Exact match on user's sounds by alias (case-insensitive) */
-    const char *params[2] = { guid, alias };
-    PGresult *res = PQexecParams(g_db.conn,
-        "SELECT sf.file_path, sf.id FROM user_sounds us "
-        "JOIN sound_files sf ON us.sound_file_id = sf.id "
-        "WHERE us.guid = $1 AND LOWER(us.alias) = LOWER($2) "
-        "LIMIT 1",
-        2, NULL, params, NULL, NULL, 0);
-
-    /* Note: checkResult clears res on failure, so only clear on success path */
-    if (checkResult(res, PGRES_TUPLES_OK)) {
-        if (PQntuples(res) > 0) {
-            strncpy(outFilePath, PQgetvalue(res, 0, 0), outLen - 1);
-            outFilePath[outLen - 1] = '\0';
-            if (outSoundFileId) {
-                *outSoundFileId = atoi(PQgetvalue(res, 0, 1));
-            }
-            PQclear(res);
-            return true;
-        }
-        PQclear(res);
-    }
-    /* If checkResult failed, res was already cleared by checkResult */
-
-    /* Step 2: Prefix match on user's sounds (find shortest match) */
-    char likePattern[64];
-    snprintf(likePattern, sizeof(likePattern), "%s%%", alias);
-    const char *fuzzyParams[2] = { guid, likePattern };
-
-    res = PQexecParams(g_db.conn,
-        "SELECT sf.file_path, sf.id FROM user_sounds us "
-        "JOIN sound_files sf ON us.sound_file_id = sf.id "
-        "WHERE us.guid = $1 AND LOWER(us.alias) LIKE LOWER($2) "
-        "ORDER BY LENGTH(us.alias) ASC LIMIT 1",
-        2, NULL, fuzzyParams, NULL, NULL, 0);
-
-    /* Note: checkResult clears res on failure, so only clear on success path */
-    if (checkResult(res, PGRES_TUPLES_OK)) {
-        if (PQntuples(res) > 0) {
-            strncpy(outFilePath, PQgetvalue(res, 0, 0), outLen - 1);
-            outFilePath[outLen - 1] = '\0';
-            if (outSoundFileId) {
-                *outSoundFileId = atoi(PQgetvalue(res, 0, 1));
-            }
-            PQclear(res);
-            return true;
-        }
-        PQclear(res);
+    if (searchSoundIndex(guid, alias, outFilePath, outLen, outSoundFileId)) {
+        return true;
     }
-    /* If checkResult failed, res was already cleared by checkResult */
 
     setError("User sound not found");
     return false;
@@ -209,6 +209,15 @@ bool DB_Reconnect(void);
  */
 struct pg_conn* DB_GetConnection(void);
 
+/**
+ * Open a separate connection that LISTENs on a notification channel.
+ * It is separate from the query connection; the caller polls it with PQconsumeInput() /
+ * PQnotifies() on its socket and closes it with PQfinish().
+ * @param channel Channel name (an SQL identifier)
+ * @return PGconn pointer, or NULL if it could not connect or listen
+ */
+struct pg_conn* DB_OpenListener(const char *channel);
+
 
 /*
  * Sound file operations
@@ -580,6 +589,14 @@ void DB_EscapeString(const char *str, char *outEscaped, int outLen);
  */
 bool DB_ExecuteRaw(const char *query);
 
+/**
+ * Measure lookup throughput: unprepared vs prepared vs pipelined.
+ * Runs the sound-by-id and alias lookups against the
+ * connected database and prints queries/sec for each mode.
+ * @param iterations Lookup rounds per mode (4 queries each)
+ */
+void DB_RunBenchmark(int iterations);
+
 
 /*
  * Dynamic sound menu structures and operations (Phase 9: Hierarchical)
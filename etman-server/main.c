@@ -4,6 +4,13 @@
  * UDP server that routes voice packets between game clients.
  * Supports team channels (forward only to same team) and all channel.
  *
+ * Threading:
+ *   The main thread is the I/O thread. It waits in epoll on the voice socket
+ *   and relays audio, auth, team and ping packets inline. Sound and admin
+ *   commands (which may block on PostgreSQL or disk) are queued to the worker
+ *   pool; their replies come back through the pool's response queue and are
+ *   sent from the I/O thread.
+ *
  * Protocol:
  *   Client -> Server: VoicePacket with clientId, team, channel, opus data
  *   Server -> Client: RelayPacket with fromClient, opus data
@@ -15,7 +22,9 @@
  *        Default: port 27961, game_server 27960
  */
 
-#define _GNU_SOURCE  /* For strcasestr */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  /* For strcasestr, recvmmsg, sendmmsg */
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -25,33 +34,39 @@
 #include <time.h>
 
 #include "sound_manager.h"
+#include "worker_pool.h"
+#include "opus_cache.h"
+#include "sound_mixer.h"
+#include "db_manager.h"
+#include "db_cache.h"
+#include "sound_index.h"
 #include "admin/admin.h"
-
-#ifdef _WIN32
-    #include <winsock2.h>
-    #include <ws2tcpip.h>
-    #pragma comment(lib, "ws2_32.lib")
-    typedef int socklen_t;
-    #define SOCKET_ERROR_CODE WSAGetLastError()
-#else
-    #include <unistd.h>
-    #include <sys/socket.h>
-    #include <sys/time.h>
-    #include <netinet/in.h>
-    #include <arpa/inet.h>
-    #include <errno.h>
-    #define SOCKET int
-    #define INVALID_SOCKET -1
-    #define SOCKET_ERROR -1
-    #define closesocket close
-    #define SOCKET_ERROR_CODE errno
-#endif
+#include "admin/admin_cache.h"
+
+/* Linux only: the I/O thread is built on epoll, recvmmsg and sendmmsg */
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <errno.h>
+
+#define SOCKET int
+#define INVALID_SOCKET -1
+#define SOCKET_ERROR -1
+#define closesocket close
+#define SOCKET_ERROR_CODE errno
 
 #define DEFAULT_PORT        27961
 #define DEFAULT_GAME_PORT   27960
 #define MAX_PACKET_SIZE     512
 #define MAX_CLIENTS         64
 #define CLIENT_TIMEOUT_SEC  30
+#define MAX_RECV_PER_WAKE   64    /* Datagrams per recvmmsg() batch */
+#define CLIENT_ADDR_HASH_SIZE 128 /* Open-addressed (ip, port) table, >= 2 * MAX_CLIENTS */
 
 /*
  * Voice Channels (must match cgame)
@@ -77,6 +92,7 @@
 #define TEAM_AXIS           1
 #define TEAM_ALLIES         2
 #define TEAM_SPECTATOR      3
+#define TEAM_MASK_COUNT     4     /* Teams tracked in g_teamMasks */
 
 /*
  * Incoming Voice Packet Header (from client)
@@ -159,8 +175,24 @@ static volatile bool g_running = true;
 static SOCKET g_socket = INVALID_SOCKET;
 static ClientInfo g_clients[MAX_CLIENTS];
 static int g_numClients = 0;
+
+/*
+ * Lookup indexes over g_clients (same lock). Slot table and address hash
+ * are rebuilt when entries are added, removed or change address; team
+ * masks are updated in place by setClientTeam(). Bit n = ET client slot n.
+ */
+static ClientInfo *g_clientSlots[MAX_CLIENTS];
+static int8_t g_addrHash[CLIENT_ADDR_HASH_SIZE];    /* Index into g_clients, -1 = empty */
+static uint64_t g_clientMask = 0;
+static uint64_t g_teamMasks[TEAM_MASK_COUNT];
 static int g_gameServerPort = DEFAULT_GAME_PORT;
 
+/*
+ * g_clients is written by the I/O thread and read by workers (GUID / name
+ * lookups for sound commands). Held briefly around every table access.
+ */
+static pthread_mutex_t g_clientsLock = PTHREAD_MUTEX_INITIALIZER;
+
 /**
  * Get the server socket for admin module.
  * Used by admin.c to send response/action packets.
@@ -173,11 +205,26 @@ int getAdminSocket(void) {
 static uint64_t g_totalPacketsReceived = 0;
 static uint64_t g_totalPacketsRouted = 0;
 static uint64_t g_totalBytesReceived = 0;
+static uint64_t g_ioCpuNs = 0;          /* I/O thread CPU time spent on packets */
+static uint64_t g_sendBatches = 0;      /* sendmmsg() calls */
+static uint64_t g_relayDropped = 0;     /* Datagrams the kernel refused */
 
-/* Sound playback timing and state */
+/*
+ * Outgoing fan-out batch (I/O thread only)
+ * Every message points at the same iovec, so a relay packet is built once
+ * and handed to the kernel for all recipients in one sendmmsg() call.
+ */
+typedef struct {
+    struct iovec        iov;
+    struct mmsghdr      msgs[MAX_CLIENTS];
+    struct sockaddr_in  addrs[MAX_CLIENTS];
+    ClientInfo          *recipients[MAX_CLIENTS];
+    int                 count;
+} RelayBatch;
+
+/* Sound playback timing and state (sequences are per mixer bus) */
 static uint64_t g_lastSoundPacketTime = 0;
 static int g_soundPacketCount = 0;
-static uint32_t g_soundSeq = 0;
 #define SOUND_PACKET_INTERVAL_MS 20  /* 20ms between Opus packets */
 
 /*
@@ -187,7 +234,6 @@ static uint32_t g_soundSeq = 0;
 void resetSoundPlaybackTiming(void) {
     g_lastSoundPacketTime = 0;
     g_soundPacketCount = 0;
-    g_soundSeq = 0;
 }
 
 /* Get current time in milliseconds */
@@ -197,6 +243,74 @@ static uint64_t getTimeMs(void) {
     return (uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
 }
 
+/* CPU time used by the calling thread, in nanoseconds */
+static uint64_t getThreadCpuNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * Start a fan-out batch for one relay packet
+ */
+static void relayBatchBegin(RelayBatch *batch, const uint8_t *packet, int len) {
+    batch->iov.iov_base = (void *)packet;
+    batch->iov.iov_len = len;
+    batch->count = 0;
+}
+
+/*
+ * Add a recipient to the batch (g_clientsLock held)
+ */
+static void relayBatchAdd(RelayBatch *batch, ClientInfo *recipient) {
+    int i = batch->count++;
+    struct msghdr *hdr = &batch->msgs[i].msg_hdr;
+
+    batch->addrs[i] = recipient->addr;
+    batch->recipients[i] = recipient;
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->msg_name = &batch->addrs[i];
+    hdr->msg_namelen = sizeof(batch->addrs[i]);
+    hdr->msg_iov = &batch->iov;
+    hdr->msg_iovlen = 1;
+}
+
+/*
+ * Send the whole batch with sendmmsg() (g_clientsLock held)
+ * sendmmsg() stops at the first datagram that fails and reports the error
+ * on the next call, so after a short count the following call starts at
+ * exactly that recipient. Its datagram is retried if the call was
+ * interrupted, otherwise dropped and counted in g_relayDropped.
+ * @return Number of datagrams sent
+ */
+static int relayBatchFlush(RelayBatch *batch) {
+    int sentTotal = 0;
+    int next = 0;
+
+    while (next < batch->count) {
+        int sent = sendmmsg(g_socket, &batch->msgs[next], batch->count - next, 0);
+        g_sendBatches++;
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            /* msgs[next] is the datagram that failed */
+            g_relayDropped++;
+            next++;
+            continue;
+        }
+        for (int i = next; i < next + sent; i++) {
+            batch->recipients[i]->packetsSent++;
+        }
+        sentTotal += sent;
+        next += sent;
+    }
+
+    g_totalPacketsRouted += sentTotal;
+    batch->count = 0;
+    return sentTotal;
+}
+
 /*
  * Signal handler
  */
@@ -207,71 +321,80 @@ static void signalHandler(int sig) {
 }
 
 /*
- * Query game server for player GUIDs via getstatus
- * This is needed because clients on the same machine share cl_guid
- * Returns the GUID for a specific client slot, or empty string if not found
+ * Hash an (ip, port) pair into g_addrHash
  */
-static bool queryGameServerGuid(uint32_t clientSlot, char *outGuid, int outLen) {
-    if (outGuid && outLen > 0) outGuid[0] = '\0';
+static unsigned int hashClientAddr(const struct sockaddr_in *addr) {
+    uint32_t h = addr->sin_addr.s_addr ^ ((uint32_t)addr->sin_port << 16);
+    h *= 2654435761u;
+    return (h >> 16) & (CLIENT_ADDR_HASH_SIZE - 1);
+}
 
-    /* Create UDP socket for query */
-    SOCKET querySocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-    if (querySocket == INVALID_SOCKET) {
-        return false;
-    }
+/*
+ * Rebuild the slot table, address hash and team masks from g_clients
+ */
+static void rebuildClientIndex(void) {
+    memset(g_clientSlots, 0, sizeof(g_clientSlots));
+    memset(g_addrHash, -1, sizeof(g_addrHash));
+    memset(g_teamMasks, 0, sizeof(g_teamMasks));
+    g_clientMask = 0;
 
-    /* Set timeout */
-    struct timeval tv = { .tv_sec = 1, .tv_usec = 0 };
-    setsockopt(querySocket, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    for (int i = 0; i < g_numClients; i++) {
+        ClientInfo *c = &g_clients[i];
+        uint64_t bit = 1ULL << c->clientId;
 
-    /* Query game server at localhost:gameport */
-    struct sockaddr_in serverAddr = {0};
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
-    serverAddr.sin_port = htons(g_gameServerPort);
-
-    /* Send getstatus query */
-    const char *query = "\xff\xff\xff\xffgetstatus";
-    if (sendto(querySocket, query, strlen(query), 0,
-               (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
-        close(querySocket);
-        return false;
+        g_clientSlots[c->clientId] = c;
+        g_clientMask |= bit;
+        if (c->team < TEAM_MASK_COUNT) {
+            g_teamMasks[c->team] |= bit;
+        }
+
+        unsigned int h = hashClientAddr(&c->addr);
+        while (g_addrHash[h] >= 0) {
+            h = (h + 1) & (CLIENT_ADDR_HASH_SIZE - 1);
+        }
+        g_addrHash[h] = (int8_t)i;
     }
+}
 
-    /* Receive response */
-    char response[4096];
-    int received = recv(querySocket, response, sizeof(response) - 1, 0);
-    close(querySocket);
+/*
+ * Change a client's team and keep the team masks in sync
+ */
+static void setClientTeam(ClientInfo *client, uint8_t team) {
+    uint64_t bit = 1ULL << client->clientId;
 
-    if (received <= 0) {
-        return false;
+    if (client->team < TEAM_MASK_COUNT) {
+        g_teamMasks[client->team] &= ~bit;
+    }
+    client->team = team;
+    if (team < TEAM_MASK_COUNT) {
+        g_teamMasks[team] |= bit;
+    }
+}
+
+/*
+ * Change a client's address and re-index it if it actually moved
+ */
+static void setClientAddr(ClientInfo *client, const struct sockaddr_in *addr) {
+    if (client->addr.sin_addr.s_addr != addr->sin_addr.s_addr ||
+        client->addr.sin_port != addr->sin_port) {
+        client->addr = *addr;
+        rebuildClientIndex();
     }
-    response[received] = '\0';
-
-    /* Parse response - format is:
-     * \xff\xff\xff\xffstatusResponse\n
-     * key\value\key\value...\n
-     * score ping "name"\n
-     * score ping "name"\n
-     * ...
-     *
-     * But GUIDs are in server cvars, not easily accessible.
-     * Actually we need to use rcon or a different approach.
-     */
-
-    /* For now, return false - this needs rcon or Lua integration */
-    return false;
 }
 
 /*
  * Find client by address
  */
 static ClientInfo* findClientByAddr(struct sockaddr_in *addr) {
-    for (int i = 0; i < g_numClients; i++) {
-        if (g_clients[i].addr.sin_addr.s_addr == addr->sin_addr.s_addr &&
-            g_clients[i].addr.sin_port == addr->sin_port) {
-            return &g_clients[i];
+    unsigned int h = hashClientAddr(addr);
+
+    while (g_addrHash[h] >= 0) {
+        ClientInfo *c = &g_clients[g_addrHash[h]];
+        if (c->addr.sin_addr.s_addr == addr->sin_addr.s_addr &&
+            c->addr.sin_port == addr->sin_port) {
+            return c;
         }
+        h = (h + 1) & (CLIENT_ADDR_HASH_SIZE - 1);
     }
     return NULL;
 }
@@ -280,12 +403,10 @@ static ClientInfo* findClientByAddr(struct sockaddr_in *addr) {
  * Find client by ET client ID
  */
 static ClientInfo* findClientById(uint32_t clientId) {
-    for (int i = 0; i < g_numClients; i++) {
-        if (g_clients[i].clientId == clientId) {
-            return &g_clients[i];
-        }
+    if (clientId >= MAX_CLIENTS) {
+        return NULL;
     }
-    return NULL;
+    return g_clientSlots[clientId];
 }
 
 /*
@@ -334,12 +455,15 @@ static ClientInfo* findClientByNameFuzzy(const char *name, char *outError, int o
 bool getGuidByPlayerName(const char *name, char *outGuid, int outLen,
                          char *outActualName, int nameLen,
                          char *outError, int errLen) {
+    pthread_mutex_lock(&g_clientsLock);
     ClientInfo *client = findClientByNameFuzzy(name, outError, errLen);
     if (!client) {
+        pthread_mutex_unlock(&g_clientsLock);
         return false;
     }
 
     if (!client->guid[0]) {
+        pthread_mutex_unlock(&g_clientsLock);
         if (outError) snprintf(outError, errLen, "Player '%s' has no GUID registered", name);
         return false;
     }
@@ -353,6 +477,7 @@ bool getGuidByPlayerName(const char *name, char *outGuid, int outLen,
         outActualName[nameLen - 1] = '\0';
     }
 
+    pthread_mutex_unlock(&g_clientsLock);
     return true;
 }
 
@@ -360,14 +485,17 @@ bool getGuidByPlayerName(const char *name, char *outGuid, int outLen,
  * Get player name by client ID (for share requests)
  */
 bool getPlayerNameByClientId(uint32_t clientId, char *outName, int outLen) {
+    pthread_mutex_lock(&g_clientsLock);
     ClientInfo *client = findClientById(clientId);
     if (!client || !client->playerName[0]) {
+        pthread_mutex_unlock(&g_clientsLock);
         if (outName && outLen > 0) outName[0] = '\0';
         return false;
     }
 
     strncpy(outName, client->playerName, outLen - 1);
     outName[outLen - 1] = '\0';
+    pthread_mutex_unlock(&g_clientsLock);
     return true;
 }
 
@@ -376,14 +504,17 @@ bool getPlayerNameByClientId(uint32_t clientId, char *outName, int outLen) {
  * This is needed because clients on the same machine share cl_guid
  */
 bool getGuidByClientId(uint32_t clientId, char *outGuid, int outLen) {
+    pthread_mutex_lock(&g_clientsLock);
     ClientInfo *client = findClientById(clientId);
     if (!client || !client->guid[0]) {
+        pthread_mutex_unlock(&g_clientsLock);
         if (outGuid && outLen > 0) outGuid[0] = '\0';
         return false;
     }
 
     strncpy(outGuid, client->guid, outLen - 1);
     outGuid[outLen - 1] = '\0';
+    pthread_mutex_unlock(&g_clientsLock);
     return true;
 }
 
@@ -397,12 +528,13 @@ static ClientInfo* findOrCreateClient(struct sockaddr_in *addr, uint32_t clientI
     ClientInfo *existing = findClientById(clientId);
     if (existing) {
         /* Update address (client may have reconnected from different port) */
-        existing->addr = *addr;
+        setClientAddr(existing, addr);
         existing->lastSeen = now;
         return existing;
     }
 
     /* Clean up stale clients */
+    int numBefore = g_numClients;
     for (int i = 0; i < g_numClients; i++) {
         if (now - g_clients[i].lastSeen > CLIENT_TIMEOUT_SEC) {
             printf("Client %u timed out (was %s:%d)\n",
@@ -416,6 +548,9 @@ static ClientInfo* findOrCreateClient(struct sockaddr_in *addr, uint32_t clientI
             i--;
         }
     }
+    if (g_numClients != numBefore) {
+        rebuildClientIndex();
+    }
 
     /* Add new client */
     if (g_numClients < MAX_CLIENTS) {
@@ -426,6 +561,7 @@ static ClientInfo* findOrCreateClient(struct sockaddr_in *addr, uint32_t clientI
         client->lastSeen = now;
         client->team = TEAM_FREE;  /* Will be updated by auth or voice packet */
         client->authenticated = false;
+        rebuildClientIndex();
 
         printf("New client %u connected from %s:%d\n",
                clientId,
@@ -444,9 +580,11 @@ static ClientInfo* findOrCreateClient(struct sockaddr_in *addr, uint32_t clientI
  */
 static void routeVoicePacket(ClientInfo *sender, uint8_t *packet, int packetLen,
                              uint8_t channel, uint32_t sequence, uint16_t opusLen) {
+    static RelayBatch batch;
     uint8_t relayBuffer[MAX_PACKET_SIZE];
     RelayPacketHeader *relay = (RelayPacketHeader *)relayBuffer;
     int relayLen;
+    time_t now = time(NULL);
 
     /* Build relay packet */
     relay->type = VOICE_PKT_AUDIO;
@@ -461,52 +599,47 @@ static void routeVoicePacket(ClientInfo *sender, uint8_t *packet, int packetLen,
            opusLen);
 
     relayLen = sizeof(RelayPacketHeader) + opusLen;
+    relayBatchBegin(&batch, relayBuffer, relayLen);
+
+    /* Pick recipients by channel */
+    uint64_t recipients = 0;
+    switch (channel) {
+        case VOICE_CHAN_ALL:
+        case VOICE_CHAN_SOUND:
+            /* Send to everyone (except spectators) */
+            recipients = g_clientMask & ~g_teamMasks[TEAM_SPECTATOR];
+            break;
 
-    /* Route based on channel */
-    for (int i = 0; i < g_numClients; i++) {
-        ClientInfo *recipient = &g_clients[i];
-
-        /* Don't send back to sender */
-        if (recipient->clientId == sender->clientId) {
-            continue;
-        }
+        case VOICE_CHAN_TEAM:
+            /* Send only to same team */
+            if (sender->team != TEAM_FREE && sender->team != TEAM_SPECTATOR &&
+                sender->team < TEAM_MASK_COUNT) {
+                recipients = g_teamMasks[sender->team];
+            }
+            break;
 
-        /* Skip stale clients */
-        if (time(NULL) - recipient->lastSeen > CLIENT_TIMEOUT_SEC) {
-            continue;
-        }
+        default:
+            break;
+    }
 
-        bool shouldSend = false;
+    /* Don't send back to sender */
+    recipients &= ~(1ULL << sender->clientId);
 
-        switch (channel) {
-            case VOICE_CHAN_ALL:
-            case VOICE_CHAN_SOUND:
-                /* Send to everyone (except spectators) */
-                shouldSend = (recipient->team != TEAM_SPECTATOR);
-                break;
+    while (recipients) {
+        int slot = __builtin_ctzll(recipients);
+        recipients &= recipients - 1;
 
-            case VOICE_CHAN_TEAM:
-                /* Send only to same team */
-                shouldSend = (recipient->team == sender->team &&
-                             sender->team != TEAM_FREE &&
-                             sender->team != TEAM_SPECTATOR);
-                break;
+        ClientInfo *recipient = g_clientSlots[slot];
 
-            default:
-                break;
+        /* Skip stale clients */
+        if (now - recipient->lastSeen > CLIENT_TIMEOUT_SEC) {
+            continue;
         }
 
-        if (shouldSend) {
-            int sent = sendto(g_socket, (char *)relayBuffer, relayLen, 0,
-                             (struct sockaddr *)&recipient->addr,
-                             sizeof(recipient->addr));
-
-            if (sent > 0) {
-                recipient->packetsSent++;
-                g_totalPacketsRouted++;
-            }
-        }
+        relayBatchAdd(&batch, recipient);
     }
+
+    relayBatchFlush(&batch);
 }
 
 /* Debug helper to print routing decision */
@@ -560,7 +693,7 @@ static void handleAuthPacket(struct sockaddr_in *addr, uint8_t *buffer, int rece
 
     ClientInfo *client = findOrCreateClient(addr, clientId);
     if (client) {
-        client->team = auth->team;
+        setClientTeam(client, auth->team);
         client->authenticated = true;
 
         /* Store GUID and player name for sharing (Phase 2.1) */
@@ -594,7 +727,7 @@ static void handleTeamUpdate(struct sockaddr_in *addr, uint8_t *buffer, int rece
     ClientInfo *client = findClientById(clientId);
     if (client) {
         uint8_t oldTeam = client->team;
-        client->team = update->team;
+        setClientTeam(client, update->team);
         if (oldTeam != update->team) {
             printf("Client %u changed team: %d -> %d\n",
                    clientId, oldTeam, update->team);
@@ -686,14 +819,6 @@ static void handleAudioPacket(struct sockaddr_in *addr, uint8_t *buffer, int rec
  * Initialize server socket
  */
 static bool initServer(int port) {
-#ifdef _WIN32
-    WSADATA wsaData;
-    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
-        fprintf(stderr, "WSAStartup failed\n");
-        return false;
-    }
-#endif
-
     g_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
     if (g_socket == INVALID_SOCKET) {
         fprintf(stderr, "Failed to create socket: %d\n", SOCKET_ERROR_CODE);
@@ -702,22 +827,16 @@ static bool initServer(int port) {
 
     /* Allow address reuse */
     int opt = 1;
-#ifdef _WIN32
-    setsockopt(g_socket, SOL_SOCKET, SO_REUSEADDR, (char*)&opt, sizeof(opt));
-#else
     setsockopt(g_socket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-#endif
 
     /* Set receive timeout */
-#ifdef _WIN32
-    DWORD timeout = 100;
-    setsockopt(g_socket, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout, sizeof(timeout));
-#else
     struct timeval tv;
     tv.tv_sec = 0;
     tv.tv_usec = 100000;  /* 100ms */
     setsockopt(g_socket, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-#endif
+
+    /* Non-blocking: the I/O thread drains the socket until EAGAIN */
+    fcntl(g_socket, F_SETFL, fcntl(g_socket, F_GETFL, 0) | O_NONBLOCK);
 
     /* Bind to port */
     struct sockaddr_in serverAddr;
@@ -746,9 +865,16 @@ static void cleanupServer(void) {
         closesocket(g_socket);
         g_socket = INVALID_SOCKET;
     }
-#ifdef _WIN32
-    WSACleanup();
-#endif
+}
+
+/*
+ * Relayed packets per millisecond of I/O thread CPU time
+ */
+static double getRelayThroughput(void) {
+    if (g_ioCpuNs == 0) {
+        return 0.0;
+    }
+    return (double)g_totalPacketsRouted / ((double)g_ioCpuNs / 1e6);
 }
 
 /*
@@ -760,8 +886,82 @@ static void printStats(void) {
     printf("Total received:    %lu packets (%lu bytes)\n",
            (unsigned long)g_totalPacketsReceived,
            (unsigned long)g_totalBytesReceived);
-    printf("Total routed:      %lu packets\n",
-           (unsigned long)g_totalPacketsRouted);
+    printf("Total routed:      %lu packets (%lu dropped by the kernel)\n",
+           (unsigned long)g_totalPacketsRouted,
+           (unsigned long)g_relayDropped);
+    printf("Relay throughput:  %.1f packets per CPU-ms (%lu sendmmsg calls, %.1f ms CPU)\n",
+           getRelayThroughput(),
+           (unsigned long)g_sendBatches,
+           (double)g_ioCpuNs / 1e6);
+
+    WorkerPoolStats ws;
+    WorkerPool_GetStats(&ws);
+    printf("Worker jobs:       %lu done, %lu dropped (peak queue %d, slowest %u us)\n",
+           (unsigned long)ws.jobsCompleted,
+           (unsigned long)ws.jobsDropped,
+           ws.jobQueuePeak,
+           ws.maxJobUs);
+    printf("Worker responses:  %lu sent, %lu dropped (queue full), %lu dropped (too long)\n",
+           (unsigned long)ws.respPosted,
+           (unsigned long)ws.respDropped,
+           (unsigned long)ws.respOversized);
+
+    OpusCacheStats cs;
+    OpusCache_GetStats(&cs);
+    printf("Opus cache:        %lu memory hits, %lu disk hits, %lu misses, %lu built (%d clips, %.1f MB)\n",
+           (unsigned long)cs.memHits,
+           (unsigned long)cs.diskHits,
+           (unsigned long)cs.misses,
+           (unsigned long)cs.builds,
+           cs.clipsInMemory,
+           (double)cs.bytesInMemory / (1024.0 * 1024.0));
+
+    DBCacheStats dbs;
+    DBCache_GetStats(&dbs);
+    printf("DB cache:          %lu hits, %lu misses (%.0f%% hit), %lu invalidated, %lu expired, %lu evicted (%d entries, %.1f KB)\n",
+           (unsigned long)dbs.hits,
+           (unsigned long)dbs.misses,
+           (dbs.hits + dbs.misses) ? 100.0 * dbs.hits / (dbs.hits + dbs.misses) : 0.0,
+           (unsigned long)dbs.invalidations,
+           (unsigned long)dbs.expirations,
+           (unsigned long)dbs.evictions,
+           dbs.entries,
+           (double)dbs.bytes / 1024.0);
+
+    AdminCacheStats as;
+    AdminCache_GetStats(&as);
+    printf("Admin cache:       %lu lookups, %lu reloads (%lu notifications, last %u us), %d players, %d overrides, %d bans, %d mutes%s\n",
+           (unsigned long)as.lookups,
+           (unsigned long)as.reloads,
+           (unsigned long)as.notifications,
+           as.lastReloadUs,
+           as.players,
+           as.overrides,
+           as.bans,
+           as.mutes,
+           as.listening ? "" : " (not listening)");
+
+    SoundIndexStats sis;
+    SoundIndex_GetStats(&sis);
+    printf("Sound index:       %lu lookups, %lu found, %lu reloads (%d names, %d owners, %d trigrams, %.1f KB)\n",
+           (unsigned long)sis.lookups,
+           (unsigned long)sis.hits,
+           (unsigned long)sis.reloads,
+           sis.entries,
+           sis.owners,
+           sis.trigrams,
+           (double)sis.bytes / 1024.0);
+
+    MixerStats ms;
+    SoundMixer_GetStats(&ms);
+    printf("Sound mixer:       %lu voices (%lu replaced, %lu stolen, %lu rejected, peak %d), %lu encoded / %lu passthrough frames\n",
+           (unsigned long)ms.voicesStarted,
+           (unsigned long)ms.voicesReplaced,
+           (unsigned long)ms.voicesStolen,
+           (unsigned long)ms.voicesRejected,
+           ms.peakVoices,
+           (unsigned long)ms.framesEncoded,
+           (unsigned long)ms.framesPassthrough);
 
     if (g_numClients > 0) {
         printf("\nConnected clients:\n");
@@ -790,23 +990,25 @@ static void printStats(void) {
  * This handles NAT port changes
  */
 void updateClientAddress(uint32_t clientId, struct sockaddr_in *addr) {
+    pthread_mutex_lock(&g_clientsLock);
     ClientInfo *client = findClientById(clientId);
     if (client) {
         /* Only update if port changed */
         if (client->addr.sin_port != addr->sin_port) {
-            client->addr = *addr;
+            setClientAddr(client, addr);
         }
         client->lastSeen = time(NULL);
     }
+    pthread_mutex_unlock(&g_clientsLock);
 }
 
 /*
  * Send response packet to a specific client
- * Called by sound_manager.c
+ * Called by sound_manager.c (on a worker thread)
  */
-/* Global variable to store current packet source address */
-static struct sockaddr_in g_currentPacketAddr;
-static int g_hasCurrentPacketAddr = 0;
+/* Source address of the packet the calling worker is handling */
+static __thread struct sockaddr_in g_currentPacketAddr;
+static __thread int g_hasCurrentPacketAddr = 0;
 
 /* Qagame address for quick command responses (separate from voice client routing) */
 static struct sockaddr_in g_qagameQuickAddr;
@@ -831,21 +1033,6 @@ void setQagameQuickAddress(struct sockaddr_in *addr) {
 }
 
 void sendResponseToClient(uint32_t clientId, uint8_t respType, const char *message) {
-    struct sockaddr_in *targetAddr = NULL;
-
-    /* ALWAYS use the current packet address if available - this handles NAT correctly */
-    if (g_hasCurrentPacketAddr) {
-        targetAddr = &g_currentPacketAddr;
-    } else {
-        ClientInfo *client = findClientById(clientId);
-        if (client) {
-            targetAddr = &client->addr;
-        } else {
-            printf("[SOUND] WARNING: Cannot send response to client %u - not found and no packet address!\n", clientId);
-            return;
-        }
-    }
-
     uint8_t packet[512];
     int msgLen = strlen(message);
     if (msgLen > 500) msgLen = 500;
@@ -856,13 +1043,21 @@ void sendResponseToClient(uint32_t clientId, uint8_t respType, const char *messa
 
     int packetLen = 1 + msgLen + 1;
 
-    int sent = sendto(g_socket, (char *)packet, packetLen, 0,
-           (struct sockaddr *)targetAddr, sizeof(*targetAddr));
+    /* ALWAYS use the current packet address if available - this handles NAT correctly.
+     * Otherwise the I/O thread resolves the client's address when it sends. */
+    if (g_hasCurrentPacketAddr) {
+        WorkerPool_PostResponse(WORKER_RESP_TO_ADDR, clientId, &g_currentPacketAddr,
+                                packet, packetLen);
 
-    char ipStr[INET_ADDRSTRLEN];
-    inet_ntop(AF_INET, &targetAddr->sin_addr, ipStr, sizeof(ipStr));
-    printf("[SOUND] Response to client %u at %s:%d: type=0x%02x msg=%s (sent=%d bytes)\n",
-           clientId, ipStr, ntohs(targetAddr->sin_port), respType, message, sent);
+        char ipStr[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &g_currentPacketAddr.sin_addr, ipStr, sizeof(ipStr));
+        printf("[SOUND] Response to client %u at %s:%d: type=0x%02x msg=%s\n",
+               clientId, ipStr, ntohs(g_currentPacketAddr.sin_port), respType, message);
+    } else {
+        WorkerPool_PostResponse(WORKER_RESP_TO_CLIENT, clientId, NULL, packet, packetLen);
+        printf("[SOUND] Response to client %u: type=0x%02x msg=%s\n",
+               clientId, respType, message);
+    }
 }
 
 /*
@@ -870,11 +1065,6 @@ void sendResponseToClient(uint32_t clientId, uint8_t respType, const char *messa
  * Called by sound_manager.c for menu data
  */
 void sendBinaryToClient(uint32_t clientId, uint8_t respType, const uint8_t *data, int dataLen) {
-    ClientInfo *client = findClientById(clientId);
-    if (!client) {
-        return;
-    }
-
     uint8_t packet[2048];
     if (dataLen > 2046) dataLen = 2046;
 
@@ -883,8 +1073,7 @@ void sendBinaryToClient(uint32_t clientId, uint8_t respType, const uint8_t *data
 
     int packetLen = 1 + dataLen;
 
-    sendto(g_socket, (char *)packet, packetLen, 0,
-           (struct sockaddr *)&client->addr, sizeof(client->addr));
+    WorkerPool_PostResponse(WORKER_RESP_TO_CLIENT, clientId, NULL, packet, packetLen);
 
     printf("[SOUND] Binary response to client %u: type=0x%02x len=%d\n", clientId, respType, dataLen);
 }
@@ -907,24 +1096,29 @@ void sendBinaryToQagame(uint8_t respType, const uint8_t *data, int dataLen) {
 
     int packetLen = 1 + dataLen;
 
-    int sent = sendto(g_socket, (char *)packet, packetLen, 0,
-           (struct sockaddr *)&g_qagameQuickAddr, sizeof(g_qagameQuickAddr));
+    WorkerPool_PostResponse(WORKER_RESP_TO_ADDR, 0, &g_qagameQuickAddr, packet, packetLen);
 
     char ipStr[INET_ADDRSTRLEN];
     inet_ntop(AF_INET, &g_qagameQuickAddr.sin_addr, ipStr, sizeof(ipStr));
-    printf("[SOUND] Quick response to qagame at %s:%d: type=0x%02x len=%d (sent=%d)\n",
-           ipStr, ntohs(g_qagameQuickAddr.sin_port), respType, dataLen, sent);
+    printf("[SOUND] Quick response to qagame at %s:%d: type=0x%02x len=%d\n",
+           ipStr, ntohs(g_qagameQuickAddr.sin_port), respType, dataLen);
 }
 
 /*
- * Broadcast Opus audio packet to all connected clients
- * Called by sound_manager.c for sound playback
+ * Broadcast Opus audio packet to connected clients
+ * Used for mixed sound playback. The relay packet is built here and fanned
+ * out by the I/O thread (see relayBroadcast).
+ * team is the mixer bus audience: TEAM_AXIS / TEAM_ALLIES, or 0 for everyone.
  */
-void broadcastOpusPacket(uint8_t fromClient, uint8_t channel,
-                         uint32_t sequence, const uint8_t *opus, int opusLen) {
+static void broadcastOpusPacket(uint8_t fromClient, uint8_t team, uint8_t channel,
+                                uint32_t sequence, const uint8_t *opus, int opusLen) {
     uint8_t relayBuffer[MAX_PACKET_SIZE];
     RelayPacketHeader *relay = (RelayPacketHeader *)relayBuffer;
 
+    if (opusLen > MAX_PACKET_SIZE - (int)sizeof(RelayPacketHeader)) {
+        return;
+    }
+
     relay->type = VOICE_PKT_AUDIO;
     relay->fromClient = fromClient;
     relay->channel = channel;
@@ -934,39 +1128,93 @@ void broadcastOpusPacket(uint8_t fromClient, uint8_t channel,
     memcpy(relayBuffer + sizeof(RelayPacketHeader), opus, opusLen);
     int relayLen = sizeof(RelayPacketHeader) + opusLen;
 
+    WorkerPool_PostBroadcast(team, fromClient, relayBuffer, relayLen);
+}
+
+/*
+ * Fan a relay packet out to all connected clients (I/O thread)
+ */
+static void relayBroadcast(uint8_t team, const uint8_t *relayBuffer, int relayLen) {
+    static RelayBatch batch;
+    const RelayPacketHeader *relay = (const RelayPacketHeader *)relayBuffer;
+    uint32_t sequence = ntohl(relay->sequence);
+
     /* Send to all connected clients (including spectators for custom sounds) */
     time_t now = time(NULL);
     int sentCount = 0;
-    for (int i = 0; i < g_numClients; i++) {
-        ClientInfo *recipient = &g_clients[i];
+    relayBatchBegin(&batch, relayBuffer, relayLen);
+    pthread_mutex_lock(&g_clientsLock);
+
+    /* Note: We DO include spectators for custom sound playback
+     * (they can hear them too, makes spectating more fun) */
+    uint64_t recipients = g_clientMask;
+    if (team != TEAM_FREE) {
+        recipients = (team < TEAM_MASK_COUNT) ? g_teamMasks[team] : 0;
+    }
+
+    while (recipients) {
+        int slot = __builtin_ctzll(recipients);
+        recipients &= recipients - 1;
+
+        ClientInfo *recipient = g_clientSlots[slot];
 
         /* Skip stale clients */
         if (now - recipient->lastSeen > CLIENT_TIMEOUT_SEC) {
             continue;
         }
 
-        /* Note: We DO include spectators for custom sound playback
-         * (they can hear them too, makes spectating more fun) */
-
-        int sent = sendto(g_socket, (char *)relayBuffer, relayLen, 0,
-                         (struct sockaddr *)&recipient->addr,
-                         sizeof(recipient->addr));
-
-        if (sent > 0) {
-            recipient->packetsSent++;
-            g_totalPacketsRouted++;
-            sentCount++;
-        }
+        relayBatchAdd(&batch, recipient);
     }
+    sentCount = relayBatchFlush(&batch);
+    pthread_mutex_unlock(&g_clientsLock);
 
     /* Log first packet of each playback for debugging */
     static uint32_t lastLoggedSeq = 0xFFFFFFFF;
     if (sequence == 0 || sequence - lastLoggedSeq > 50) {
-        printf("[SOUND] Broadcast seq=%u len=%d to %d clients\n", sequence, opusLen, sentCount);
+        printf("[SOUND] Broadcast team=%d seq=%u len=%d to %d clients\n",
+               team, sequence, relayLen - (int)sizeof(RelayPacketHeader), sentCount);
         lastLoggedSeq = sequence;
     }
 }
 
+/*
+ * Send one queued worker response (I/O thread)
+ */
+static void handleWorkerResponse(const WorkerResponse *resp) {
+    struct sockaddr_in target;
+
+    switch (resp->kind) {
+        case WORKER_RESP_TO_ADDR:
+            target = resp->addr;
+            break;
+
+        case WORKER_RESP_TO_CLIENT: {
+            pthread_mutex_lock(&g_clientsLock);
+            ClientInfo *client = findClientById(resp->clientId);
+            if (client) {
+                target = client->addr;
+            }
+            pthread_mutex_unlock(&g_clientsLock);
+            if (!client) {
+                printf("[SOUND] WARNING: Cannot send response to client %u - not found and no packet address!\n",
+                       resp->clientId);
+                return;
+            }
+            break;
+        }
+
+        case WORKER_RESP_BROADCAST:
+            relayBroadcast(resp->team, resp->data, resp->len);
+            return;
+
+        default:
+            return;
+    }
+
+    sendto(g_socket, (const char *)resp->data, resp->len, 0,
+           (struct sockaddr *)&target, sizeof(target));
+}
+
 /*
  * Process sound playback - streams Opus packets at correct interval
  * Sends multiple packets if we've fallen behind to maintain smooth playback
@@ -980,11 +1228,11 @@ static void processSoundPlayback(void) {
 
     /* Initialize timing on first packet of new sound */
     if (g_lastSoundPacketTime == 0) {
-        printf("SoundMgr: Starting playback stream at time %lu (seq=%u, count=%d)\n",
-               (unsigned long)nowMs, g_soundSeq, g_soundPacketCount);
+        printf("SoundMgr: Starting playback stream at time %lu (count=%d)\n",
+               (unsigned long)nowMs, g_soundPacketCount);
         g_lastSoundPacketTime = nowMs;
-        /* Note: g_soundPacketCount and g_soundSeq are reset in resetSoundPlaybackTiming()
-         * which is called when a new sound starts. This ensures clean state. */
+        /* Note: g_soundPacketCount is reset in resetSoundPlaybackTiming()
+         * which is called when the first voice starts. */
     }
 
     /* Calculate how many packets we should have sent by now */
@@ -1002,12 +1250,16 @@ static void processSoundPlayback(void) {
 
     /* Send the packets we owe */
     for (int i = 0; i < packetsToSend; i++) {
-        uint8_t opusBuffer[512];
-        int opusLen = 0;
-
-        if (SoundMgr_GetNextOpusPacket(opusBuffer, &opusLen)) {
-            uint8_t initiatorId = (uint8_t)SoundMgr_GetPlaybackClientId();
-            broadcastOpusPacket(initiatorId, VOICE_CHAN_SOUND, g_soundSeq++, opusBuffer, opusLen);
+        MixerPacket packets[MIXER_MAX_BUSES];
+        int numPackets = SoundMgr_MixFrame(packets, MIXER_MAX_BUSES);
+
+        if (numPackets > 0) {
+            /* One packet per audience, all sounds already mixed in */
+            for (int p = 0; p < numPackets; p++) {
+                broadcastOpusPacket(packets[p].fromClient, packets[p].team,
+                                    VOICE_CHAN_SOUND, packets[p].sequence,
+                                    packets[p].data, packets[p].len);
+            }
             g_soundPacketCount++;
 
             /* Debug: log occasionally */
@@ -1038,10 +1290,10 @@ static bool isSoundCommand(uint8_t type) {
 }
 
 /*
- * Check if packet is an admin command (0x40-0x44 range)
+ * Check if packet is an admin command (0x40-0x45 range)
  */
 static bool isAdminCommand(uint8_t type) {
-    return (type >= PKT_ADMIN_CMD && type <= PKT_PLAYER_UPDATE);
+    return (type >= PKT_ADMIN_CMD && type <= PKT_GAME_STATE);
 }
 
 /*
@@ -1108,6 +1360,11 @@ static void handleAdminPacket(struct sockaddr_in *addr, uint8_t *buffer, int rec
             break;
         }
 
+        case PKT_GAME_STATE:
+            /* Map, level times and roster changes */
+            Admin_HandleGameState(buffer, received);
+            break;
+
         default:
             printf("[ADMIN] Unknown admin packet type: 0x%02x\n", type);
             break;
@@ -1115,110 +1372,218 @@ static void handleAdminPacket(struct sockaddr_in *addr, uint8_t *buffer, int rec
 }
 
 /*
- * Main server loop
+ * Run one queued sound/admin command (worker thread)
+ */
+static void processWorkerJob(const WorkerJob *job) {
+    struct sockaddr_in addr = job->addr;
+    uint8_t buffer[WORKER_JOB_MAX_DATA];
+
+    /* Replies default to the client's registered address unless the
+     * handler sets the packet source via setCurrentPacketAddress() */
+    g_hasCurrentPacketAddr = 0;
+
+    memcpy(buffer, job->data, job->len);
+
+    switch (job->kind) {
+        case WORKER_JOB_ADMIN:
+            handleAdminPacket(&addr, buffer, job->len);
+            break;
+
+        case WORKER_JOB_SOUND:
+            SoundMgr_HandlePacket(job->clientId, &addr, buffer, job->len);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*
+ * Periodic sound and admin work (worker 0, every WORKER_TICK_MS)
+ */
+static void processWorkerTick(void) {
+    /* Process sound manager operations */
+    SoundMgr_Frame();
+
+    /* Process active sound playback */
+    processSoundPlayback();
+
+    /* Pick up admin table changes from the web panel */
+    AdminCache_Poll();
+}
+
+/*
+ * Hand a slow command to the worker pool (I/O thread)
+ */
+static void queueWorkerJob(uint8_t kind, uint32_t clientId,
+                           struct sockaddr_in *addr, uint8_t *buffer, int received) {
+    WorkerJob job;
+
+    job.kind = kind;
+    job.clientId = clientId;
+    job.addr = *addr;
+    job.len = received;
+    memcpy(job.data, buffer, received);
+
+    /* Admin packets (commands, roster and game state) are applied in the
+     * order qagame sent them; sound commands may run on any worker */
+    bool queued = (kind == WORKER_JOB_ADMIN) ? WorkerPool_SubmitOrdered(&job) : WorkerPool_Submit(&job);
+    if (!queued) {
+        printf("Warning: Worker queue full, dropping packet type 0x%02x from %s:%d\n",
+               buffer[0], inet_ntoa(addr->sin_addr), ntohs(addr->sin_port));
+    }
+}
+
+/*
+ * Dispatch one received datagram (I/O thread)
+ */
+static void handlePacket(struct sockaddr_in *clientAddr, uint8_t *buffer, int received) {
+    g_totalPacketsReceived++;
+    g_totalBytesReceived += received;
+
+    uint8_t type = buffer[0];
+
+    switch (type) {
+        case VOICE_PKT_AUDIO:
+            pthread_mutex_lock(&g_clientsLock);
+            handleAudioPacket(clientAddr, buffer, received);
+            pthread_mutex_unlock(&g_clientsLock);
+            break;
+
+        case VOICE_PKT_AUTH:
+            pthread_mutex_lock(&g_clientsLock);
+            handleAuthPacket(clientAddr, buffer, received);
+            pthread_mutex_unlock(&g_clientsLock);
+            break;
+
+        case VOICE_PKT_TEAM_UPDATE:
+            pthread_mutex_lock(&g_clientsLock);
+            handleTeamUpdate(clientAddr, buffer, received);
+            pthread_mutex_unlock(&g_clientsLock);
+            break;
+
+        case VOICE_PKT_PING:
+            /* Keepalive ping - update client lastSeen */
+            if (received >= 2) {
+                uint8_t clientId = buffer[1];
+                pthread_mutex_lock(&g_clientsLock);
+                ClientInfo *client = findClientById(clientId);
+                if (client) {
+                    client->lastSeen = time(NULL);
+                }
+                pthread_mutex_unlock(&g_clientsLock);
+            }
+            break;
+
+        case VOICE_PKT_DEBUG:
+            /* Debug message from client - disabled in production */
+            break;
+
+        default:
+            /* Check for admin commands first (0x40-0x44) */
+            if (isAdminCommand(type)) {
+                queueWorkerJob(WORKER_JOB_ADMIN, 0, clientAddr, buffer, received);
+            }
+            /* Check for sound commands (0x10-0x27, 0x30) */
+            else if (isSoundCommand(type)) {
+                /* Extract client ID from packet - after type byte */
+                uint32_t clientId = 0;
+                if (received >= 5) {
+                    memcpy(&clientId, buffer + 1, 4);
+                    clientId = ntohl(clientId);
+                }
+                /* Dispatch to sound manager */
+                queueWorkerJob(WORKER_JOB_SOUND, clientId, clientAddr, buffer, received);
+            }
+            break;
+    }
+}
+
+/*
+ * Main server loop (I/O thread)
  */
 static void serverLoop(void) {
-    uint8_t buffer[MAX_PACKET_SIZE];
-    struct sockaddr_in clientAddr;
-    socklen_t clientLen;
+    static uint8_t buffers[MAX_RECV_PER_WAKE][MAX_PACKET_SIZE];
+    static struct sockaddr_in addrs[MAX_RECV_PER_WAKE];
+    static struct iovec iovs[MAX_RECV_PER_WAKE];
+    static struct mmsghdr msgs[MAX_RECV_PER_WAKE];
     time_t lastStatTime = time(NULL);
-    fd_set readfds;
-    struct timeval tv;
+    struct epoll_event ev, events[4];
+
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) {
+        fprintf(stderr, "epoll_create1 failed: %d\n", SOCKET_ERROR_CODE);
+        return;
+    }
+
+    ev.events = EPOLLIN;
+    ev.data.fd = g_socket;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, g_socket, &ev);
+
+    int respFd = WorkerPool_GetResponseFd();
+    ev.events = EPOLLIN;
+    ev.data.fd = respFd;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, respFd, &ev);
+
+    for (int i = 0; i < MAX_RECV_PER_WAKE; i++) {
+        iovs[i].iov_base = buffers[i];
+        iovs[i].iov_len = MAX_PACKET_SIZE;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &addrs[i];
+    }
 
     printf("\nVoice server running. Press Ctrl+C to stop.\n");
     printf("Routing modes: TEAM (same team only), ALL (everyone)\n\n");
 
     while (g_running) {
-        /* Use select with 10ms timeout to allow sound playback processing */
-        FD_ZERO(&readfds);
-        FD_SET(g_socket, &readfds);
-        tv.tv_sec = 0;
-        tv.tv_usec = 10000;  /* 10ms timeout */
-
-        int selectResult = select(g_socket + 1, &readfds, NULL, NULL, &tv);
-
-        int received = 0;
-        if (selectResult > 0 && FD_ISSET(g_socket, &readfds)) {
-            clientLen = sizeof(clientAddr);
-            received = recvfrom(g_socket, (char*)buffer, sizeof(buffer), 0,
-                                (struct sockaddr*)&clientAddr, &clientLen);
-        }
+        /* Sound pacing runs on the worker pool, so only wake for I/O */
+        int numEvents = epoll_wait(epfd, events, 4, 100);
+
+        uint64_t cpuStart = getThreadCpuNs();
+
+        for (int e = 0; e < numEvents; e++) {
+            if (events[e].data.fd == respFd) {
+                WorkerPool_DrainResponses(handleWorkerResponse);
+                continue;
+            }
 
-        if (received > 0) {
-            g_totalPacketsReceived++;
-            g_totalBytesReceived += received;
-
-            /* Dispatch based on packet type */
-            if (received >= 1) {
-                uint8_t type = buffer[0];
-
-                switch (type) {
-                    case VOICE_PKT_AUDIO:
-                        handleAudioPacket(&clientAddr, buffer, received);
-                        break;
-
-                    case VOICE_PKT_AUTH:
-                        handleAuthPacket(&clientAddr, buffer, received);
-                        break;
-
-                    case VOICE_PKT_TEAM_UPDATE:
-                        handleTeamUpdate(&clientAddr, buffer, received);
-                        break;
-
-                    case VOICE_PKT_PING:
-                        /* Keepalive ping - update client lastSeen */
-                        if (received >= 2) {
-                            uint8_t clientId = buffer[1];
-                            for (int i = 0; i < g_numClients; i++) {
-                                if (g_clients[i].clientId == clientId) {
-                                    g_clients[i].lastSeen = time(NULL);
-                                    break;
-                                }
-                            }
-                        }
-                        break;
-
-                    case VOICE_PKT_DEBUG:
-                        /* Debug message from client - disabled in production */
-                        break;
-
-                    default:
-                        /* Check for admin commands first (0x40-0x44) */
-                        if (isAdminCommand(type)) {
-                            handleAdminPacket(&clientAddr, buffer, received);
-                        }
-                        /* Check for sound commands (0x10-0x27, 0x30) */
-                        else if (isSoundCommand(type)) {
-                            /* Extract client ID from packet - after type byte */
-                            uint32_t clientId = 0;
-                            if (received >= 5) {
-                                memcpy(&clientId, buffer + 1, 4);
-                                clientId = ntohl(clientId);
-                            }
-                            /* Dispatch to sound manager */
-                            SoundMgr_HandlePacket(clientId, &clientAddr, buffer, received);
-                        }
-                        break;
+            /* Pull up to a batch of datagrams in one syscall (non-blocking;
+             * epoll is level-triggered, so anything left wakes us again) */
+            for (int i = 0; i < MAX_RECV_PER_WAKE; i++) {
+                msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+            }
+            int got = recvmmsg(g_socket, msgs, MAX_RECV_PER_WAKE, MSG_DONTWAIT, NULL);
+            for (int i = 0; i < got; i++) {
+                if (msgs[i].msg_len > 0) {
+                    handlePacket(&addrs[i], buffers[i], (int)msgs[i].msg_len);
                 }
             }
         }
 
-        /* Process sound manager operations */
-        SoundMgr_Frame();
-
-        /* Process active sound playback */
-        processSoundPlayback();
+        if (numEvents > 0) {
+            g_ioCpuNs += getThreadCpuNs() - cpuStart;
+        }
 
         /* Print stats every 30 seconds */
         time_t now = time(NULL);
         if (now - lastStatTime >= 30) {
-            printf("--- Clients: %d, Received: %lu, Routed: %lu ---\n",
+            WorkerPoolStats ws;
+            WorkerPool_GetStats(&ws);
+            printf("--- Clients: %d, Received: %lu, Routed: %lu (%.1f pkts/CPU-ms), Jobs: %lu (queued %d, dropped %lu, slowest %u ms) ---\n",
                    g_numClients,
                    (unsigned long)g_totalPacketsReceived,
-                   (unsigned long)g_totalPacketsRouted);
+                   (unsigned long)g_totalPacketsRouted,
+                   getRelayThroughput(),
+                   (unsigned long)ws.jobsCompleted,
+                   ws.jobQueueDepth,
+                   (unsigned long)ws.jobsDropped,
+                   ws.maxJobUs / 1000);
             lastStatTime = now;
         }
     }
+
+    close(epfd);
 }
 
 /*
@@ -1227,6 +1592,7 @@ static void serverLoop(void) {
 static void printUsage(const char *progName) {
     printf("ET:Legacy Voice Routing Server\n");
     printf("Usage: %s [port] [game_server_port]\n", progName);
+    printf("       %s --db-bench [iterations]\n", progName);
     printf("  Default voice port: %d\n", DEFAULT_PORT);
     printf("  Default game port:  %d\n", DEFAULT_GAME_PORT);
     printf("\nThe voice server runs alongside the ET:Legacy game server.\n");
@@ -1245,6 +1611,16 @@ int main(int argc, char *argv[]) {
             printUsage(argv[0]);
             return 0;
         }
+        if (strcmp(argv[1], "--db-bench") == 0) {
+            /* Compare query modes against DATABASE_URL, then exit */
+            if (!DB_Init(NULL)) {
+                fprintf(stderr, "Database unavailable: %s\n", DB_GetLastError());
+                return 1;
+            }
+            DB_RunBenchmark(argc >= 3 ? atoi(argv[2]) : 1000);
+            DB_Shutdown();
+            return 0;
+        }
         port = atoi(argv[1]);
         if (port <= 0 || port > 65535) {
             fprintf(stderr, "Invalid port number: %s\n", argv[1]);
@@ -1262,9 +1638,7 @@ int main(int argc, char *argv[]) {
 
     /* Setup signal handler */
     signal(SIGINT, signalHandler);
-#ifndef _WIN32
     signal(SIGTERM, signalHandler);
-#endif
 
     /* Initialize server */
     if (!initServer(port)) {
@@ -1274,6 +1648,7 @@ int main(int argc, char *argv[]) {
 
     /* Initialize client tracking */
     memset(g_clients, 0, sizeof(g_clients));
+    rebuildClientIndex();
 
     /* Initialize sound manager */
     if (!SoundMgr_Init("./sounds")) {
@@ -1287,9 +1662,26 @@ int main(int argc, char *argv[]) {
         /* Non-fatal - basic features still work */
     }
 
+    /* Start worker pool for sound/admin commands */
+    int numWorkers = WORKER_DEFAULT_THREADS;
+    const char *workersEnv = getenv("ETMAN_WORKERS");
+    if (workersEnv && workersEnv[0]) {
+        numWorkers = atoi(workersEnv);
+    }
+    if (!WorkerPool_Init(numWorkers, processWorkerJob, processWorkerTick)) {
+        fprintf(stderr, "Failed to start worker pool\n");
+        Admin_Shutdown();
+        SoundMgr_Shutdown();
+        cleanupServer();
+        return 1;
+    }
+
     /* Run server */
     serverLoop();
 
+    /* Stop workers before tearing down the subsystems they use */
+    WorkerPool_Shutdown();
+
     /* Shutdown admin system */
     Admin_Shutdown();
 
@@ -0,0 +1,507 @@
+/**
+ * @file opus_cache.c
+ * @brief Pre-encoded Opus packet cache for custom sound playback
+ */
+
+#include "opus_cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#define PATH_SEP '/'
+
+/*
+ * On-disk entry: header, uint16 packet lengths, packet bytes
+ */
+#define OPUS_CACHE_MAGIC        "ETOC"
+#define OPUS_CACHE_VERSION      1
+
+typedef struct {
+    char     magic[4];
+    uint32_t version;
+    uint32_t bitrate;
+    uint32_t numPackets;
+    uint32_t dataSize;
+    uint64_t key;
+} OpusCacheFileHeader;
+
+/*
+ * Builder: growable packet stream
+ */
+struct OpusClipBuilder_s {
+    uint64_t  key;
+    int       numPackets;
+    int       maxPackets;
+    uint32_t *offsets;
+    uint8_t  *data;
+    size_t    dataSize;
+    size_t    dataCapacity;
+};
+
+/*
+ * File -> key memo entry
+ */
+typedef struct {
+    uint64_t pathHash;
+    int64_t  size;
+    int64_t  mtime;
+    uint64_t key;
+} KeyMemo;
+
+/*
+ * Module state
+ */
+static struct {
+    bool        initialized;
+    char        cacheDir[512];
+    int         bitrate;
+
+    OpusClip   *buckets[OPUS_CACHE_HASH_BUCKETS];
+    OpusClip   *lruHead;            /* Most recently used */
+    OpusClip   *lruTail;            /* Eviction candidate */
+
+    KeyMemo     keyMemo[OPUS_CACHE_KEY_SLOTS];
+
+    OpusCacheStats stats;
+} g_cache;
+
+/* FNV-1a 64-bit */
+#define FNV64_OFFSET    0xcbf29ce484222325ULL
+#define FNV64_PRIME     0x100000001b3ULL
+
+static uint64_t fnv1a64(uint64_t hash, const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= FNV64_PRIME;
+    }
+    return hash;
+}
+
+static void getEntryPath(uint64_t key, char *outPath, int outLen) {
+    snprintf(outPath, outLen, "%s%c%016llx.opc",
+             g_cache.cacheDir, PATH_SEP, (unsigned long long)key);
+}
+
+/*
+ * LRU list helpers
+ */
+static void lruUnlink(OpusClip *clip) {
+    if (clip->lruPrev) clip->lruPrev->lruNext = clip->lruNext;
+    else g_cache.lruHead = clip->lruNext;
+    if (clip->lruNext) clip->lruNext->lruPrev = clip->lruPrev;
+    else g_cache.lruTail = clip->lruPrev;
+    clip->lruPrev = clip->lruNext = NULL;
+}
+
+static void lruPushFront(OpusClip *clip) {
+    clip->lruPrev = NULL;
+    clip->lruNext = g_cache.lruHead;
+    if (g_cache.lruHead) g_cache.lruHead->lruPrev = clip;
+    g_cache.lruHead = clip;
+    if (!g_cache.lruTail) g_cache.lruTail = clip;
+}
+
+static void freeClip(OpusClip *clip) {
+    free(clip->offsets);
+    free(clip->data);
+    free(clip);
+}
+
+/*
+ * Remove a clip from the hash and LRU and free it
+ */
+static void evictClip(OpusClip *clip) {
+    OpusClip **link = &g_cache.buckets[clip->key % OPUS_CACHE_HASH_BUCKETS];
+    while (*link && *link != clip) {
+        link = &(*link)->hashNext;
+    }
+    if (*link) {
+        *link = clip->hashNext;
+    }
+    lruUnlink(clip);
+
+    g_cache.stats.clipsInMemory--;
+    g_cache.stats.bytesInMemory -= clip->memSize;
+    g_cache.stats.evictions++;
+    freeClip(clip);
+}
+
+/*
+ * Evict unreferenced clips from the cold end until under budget
+ */
+static void enforceBudget(void) {
+    OpusClip *clip = g_cache.lruTail;
+    while (clip && g_cache.stats.bytesInMemory > OPUS_CACHE_MEM_BUDGET) {
+        OpusClip *prev = clip->lruPrev;
+        if (clip->refCount == 0) {
+            evictClip(clip);
+        }
+        clip = prev;
+    }
+}
+
+static void insertClip(OpusClip *clip) {
+    int bucket = clip->key % OPUS_CACHE_HASH_BUCKETS;
+    clip->hashNext = g_cache.buckets[bucket];
+    g_cache.buckets[bucket] = clip;
+    lruPushFront(clip);
+
+    g_cache.stats.clipsInMemory++;
+    g_cache.stats.bytesInMemory += clip->memSize;
+    enforceBudget();
+}
+
+static OpusClip *findClip(uint64_t key) {
+    OpusClip *clip = g_cache.buckets[key % OPUS_CACHE_HASH_BUCKETS];
+    while (clip && clip->key != key) {
+        clip = clip->hashNext;
+    }
+    return clip;
+}
+
+/*
+ * Initialize the cache
+ */
+bool OpusCache_Init(const char *baseDir, int bitrate) {
+    if (g_cache.initialized) {
+        return true;
+    }
+
+    memset(&g_cache, 0, sizeof(g_cache));
+    g_cache.bitrate = bitrate;
+    snprintf(g_cache.cacheDir, sizeof(g_cache.cacheDir), "%s%c%s",
+             baseDir, PATH_SEP, OPUS_CACHE_DIR_NAME);
+
+    struct stat st;
+    if (stat(g_cache.cacheDir, &st) != 0 && mkdir(g_cache.cacheDir, 0755) != 0) {
+        fprintf(stderr, "OpusCache: Failed to create %s: %s\n",
+                g_cache.cacheDir, strerror(errno));
+        return false;
+    }
+
+    g_cache.initialized = true;
+    printf("OpusCache: Initialized at %s (%d MB memory budget)\n",
+           g_cache.cacheDir, OPUS_CACHE_MEM_BUDGET / (1024 * 1024));
+    return true;
+}
+
+/*
+ * Free all in-memory clips
+ */
+void OpusCache_Shutdown(void) {
+    if (!g_cache.initialized) {
+        return;
+    }
+
+    OpusClip *clip = g_cache.lruHead;
+    while (clip) {
+        OpusClip *next = clip->lruNext;
+        freeClip(clip);
+        clip = next;
+    }
+
+    /* Hit/miss totals survive for the final stats report */
+    OpusCacheStats stats = g_cache.stats;
+    memset(&g_cache, 0, sizeof(g_cache));
+    g_cache.stats = stats;
+    g_cache.stats.clipsInMemory = 0;
+    g_cache.stats.bytesInMemory = 0;
+}
+
+/*
+ * Content key for a sound file (memoized by path/size/mtime)
+ */
+bool OpusCache_KeyForFile(const char *filepath, uint64_t *outKey) {
+    struct stat st;
+    if (stat(filepath, &st) != 0) {
+        return false;
+    }
+
+    uint64_t pathHash = fnv1a64(FNV64_OFFSET, (const uint8_t *)filepath, strlen(filepath));
+    KeyMemo *memo = &g_cache.keyMemo[pathHash % OPUS_CACHE_KEY_SLOTS];
+    if (memo->pathHash == pathHash && memo->size == (int64_t)st.st_size &&
+        memo->mtime == (int64_t)st.st_mtime) {
+        *outKey = memo->key;
+        return true;
+    }
+
+    FILE *f = fopen(filepath, "rb");
+    if (!f) {
+        return false;
+    }
+
+    uint8_t chunk[65536];
+    uint64_t hash = FNV64_OFFSET;
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        hash = fnv1a64(hash, chunk, n);
+    }
+    fclose(f);
+
+    memo->pathHash = pathHash;
+    memo->size = (int64_t)st.st_size;
+    memo->mtime = (int64_t)st.st_mtime;
+    memo->key = hash;
+
+    *outKey = hash;
+    return true;
+}
+
+/*
+ * Load a clip from its disk entry
+ */
+static OpusClip *loadFromDisk(uint64_t key) {
+    char path[640];
+    getEntryPath(key, path, sizeof(path));
+
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return NULL;
+    }
+
+    OpusCacheFileHeader hdr;
+    if (fread(&hdr, sizeof(hdr), 1, f) != 1 ||
+        memcmp(hdr.magic, OPUS_CACHE_MAGIC, 4) != 0 ||
+        hdr.version != OPUS_CACHE_VERSION ||
+        hdr.bitrate != (uint32_t)g_cache.bitrate ||
+        hdr.key != key ||
+        hdr.numPackets == 0 ||
+        hdr.numPackets > OPUS_CACHE_MAX_PACKETS ||
+        hdr.dataSize > hdr.numPackets * (uint32_t)OPUS_CACHE_MAX_PACKET) {
+        fclose(f);
+        return NULL;
+    }
+
+    OpusClip *clip = (OpusClip *)calloc(1, sizeof(OpusClip));
+    uint16_t *lengths = (uint16_t *)malloc(hdr.numPackets * sizeof(uint16_t));
+    if (clip) {
+        clip->offsets = (uint32_t *)malloc((hdr.numPackets + 1) * sizeof(uint32_t));
+        clip->data = (uint8_t *)malloc(hdr.dataSize ? hdr.dataSize : 1);
+    }
+    if (!clip || !lengths || !clip->offsets || !clip->data ||
+        fread(lengths, sizeof(uint16_t), hdr.numPackets, f) != hdr.numPackets ||
+        fread(clip->data, 1, hdr.dataSize, f) != hdr.dataSize) {
+        fclose(f);
+        free(lengths);
+        if (clip) freeClip(clip);
+        return NULL;
+    }
+    fclose(f);
+
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < hdr.numPackets; i++) {
+        clip->offsets[i] = offset;
+        offset += lengths[i];
+    }
+    clip->offsets[hdr.numPackets] = offset;
+    free(lengths);
+
+    if (offset != hdr.dataSize) {
+        freeClip(clip);
+        return NULL;
+    }
+
+    clip->key = key;
+    clip->numPackets = (int)hdr.numPackets;
+    clip->memSize = sizeof(OpusClip) + (hdr.numPackets + 1) * sizeof(uint32_t) + hdr.dataSize;
+    return clip;
+}
+
+/*
+ * Look up a clip in memory, then on disk
+ */
+OpusClip *OpusCache_Acquire(uint64_t key) {
+    if (!g_cache.initialized) {
+        return NULL;
+    }
+
+    OpusClip *clip = findClip(key);
+    if (clip) {
+        lruUnlink(clip);
+        lruPushFront(clip);
+        clip->refCount++;
+        g_cache.stats.memHits++;
+        return clip;
+    }
+
+    clip = loadFromDisk(key);
+    if (!clip) {
+        g_cache.stats.misses++;
+        return NULL;
+    }
+
+    clip->refCount = 1;
+    insertClip(clip);
+    g_cache.stats.diskHits++;
+    return clip;
+}
+
+void OpusCache_Release(OpusClip *clip) {
+    if (!clip) {
+        return;
+    }
+    if (clip->refCount > 0) {
+        clip->refCount--;
+    }
+    if (clip->refCount == 0) {
+        enforceBudget();
+    }
+}
+
+/*
+ * Builder
+ */
+OpusClipBuilder *OpusCache_BeginBuild(uint64_t key) {
+    if (!g_cache.initialized) {
+        return NULL;
+    }
+
+    OpusClipBuilder *builder = (OpusClipBuilder *)calloc(1, sizeof(OpusClipBuilder));
+    if (!builder) {
+        return NULL;
+    }
+    builder->key = key;
+    return builder;
+}
+
+void OpusCache_SetBuildKey(OpusClipBuilder *builder, uint64_t key) {
+    if (builder) {
+        builder->key = key;
+    }
+}
+
+bool OpusCache_BuildAppend(OpusClipBuilder *builder, const uint8_t *packet, int len) {
+    if (!builder || len <= 0 || len > OPUS_CACHE_MAX_PACKET) {
+        return false;
+    }
+
+    if (builder->numPackets + 1 >= builder->maxPackets) {
+        int newMax = builder->maxPackets ? builder->maxPackets * 2 : 256;
+        uint32_t *offsets = (uint32_t *)realloc(builder->offsets, newMax * sizeof(uint32_t));
+        if (!offsets) {
+            return false;
+        }
+        builder->offsets = offsets;
+        builder->maxPackets = newMax;
+    }
+
+    if (builder->dataSize + len > builder->dataCapacity) {
+        size_t newCap = builder->dataCapacity ? builder->dataCapacity * 2 : 64 * 1024;
+        while (newCap < builder->dataSize + len) newCap *= 2;
+        uint8_t *data = (uint8_t *)realloc(builder->data, newCap);
+        if (!data) {
+            return false;
+        }
+        builder->data = data;
+        builder->dataCapacity = newCap;
+    }
+
+    builder->offsets[builder->numPackets++] = (uint32_t)builder->dataSize;
+    memcpy(builder->data + builder->dataSize, packet, len);
+    builder->dataSize += len;
+    return true;
+}
+
+/*
+ * Write a clip's disk entry (temp file + rename so readers never see a
+ * partial entry)
+ */
+static bool writeToDisk(const OpusClip *clip) {
+    char path[640], tmpPath[660];
+    getEntryPath(clip->key, path, sizeof(path));
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+
+    FILE *f = fopen(tmpPath, "wb");
+    if (!f) {
+        return false;
+    }
+
+    OpusCacheFileHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, OPUS_CACHE_MAGIC, 4);
+    hdr.version = OPUS_CACHE_VERSION;
+    hdr.bitrate = (uint32_t)g_cache.bitrate;
+    hdr.numPackets = (uint32_t)clip->numPackets;
+    hdr.dataSize = clip->offsets[clip->numPackets];
+    hdr.key = clip->key;
+
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+    for (int i = 0; ok && i < clip->numPackets; i++) {
+        uint16_t len = (uint16_t)(clip->offsets[i + 1] - clip->offsets[i]);
+        ok = fwrite(&len, sizeof(len), 1, f) == 1;
+    }
+    if (ok && hdr.dataSize > 0) {
+        ok = fwrite(clip->data, 1, hdr.dataSize, f) == hdr.dataSize;
+    }
+    if (fclose(f) != 0) {
+        ok = false;
+    }
+
+    if (!ok || rename(tmpPath, path) != 0) {
+        remove(tmpPath);
+        return false;
+    }
+    return true;
+}
+
+OpusClip *OpusCache_FinishBuild(OpusClipBuilder *builder, bool keepRef) {
+    if (!builder) {
+        return NULL;
+    }
+    if (builder->numPackets == 0) {
+        OpusCache_AbortBuild(builder);
+        return NULL;
+    }
+
+    /* Another build for the same key may have finished first */
+    OpusClip *clip = findClip(builder->key);
+    if (clip) {
+        OpusCache_AbortBuild(builder);
+        if (keepRef) clip->refCount++;
+        return clip;
+    }
+
+    clip = (OpusClip *)calloc(1, sizeof(OpusClip));
+    if (!clip) {
+        OpusCache_AbortBuild(builder);
+        return NULL;
+    }
+
+    builder->offsets[builder->numPackets] = (uint32_t)builder->dataSize;
+    clip->key = builder->key;
+    clip->numPackets = builder->numPackets;
+    clip->offsets = builder->offsets;
+    clip->data = builder->data;
+    clip->memSize = sizeof(OpusClip) + (builder->numPackets + 1) * sizeof(uint32_t) +
+                    builder->dataSize;
+    clip->refCount = keepRef ? 1 : 0;
+    free(builder);
+
+    if (!writeToDisk(clip)) {
+        printf("OpusCache: Failed to write entry %016llx\n", (unsigned long long)clip->key);
+    }
+
+    g_cache.stats.builds++;
+    printf("OpusCache: Stored %016llx (%d packets, %u bytes)\n",
+           (unsigned long long)clip->key, clip->numPackets,
+           clip->offsets[clip->numPackets]);
+
+    insertClip(clip);
+    return clip;
+}
+
+void OpusCache_AbortBuild(OpusClipBuilder *builder) {
+    if (!builder) {
+        return;
+    }
+    free(builder->offsets);
+    free(builder->data);
+    free(builder);
+}
+
+void OpusCache_GetStats(OpusCacheStats *out) {
+    *out = g_cache.stats;
+}
@@ -0,0 +1,139 @@
+/**
+ * @file opus_cache.h
+ * @brief Pre-encoded Opus packet cache for custom sound playback
+ *
+ * Decoding an MP3 and re-encoding it to Opus on every play is wasted work
+ * for clips that are played hundreds of times a night. Clips are keyed by
+ * a 64-bit content hash of the source file and stored as ready-made 20ms
+ * Opus packet streams:
+ * - on disk in <baseDir>/opus_cache/<key>.opc (survives restarts)
+ * - in memory in a size-bounded LRU of hot clips
+ *
+ * Entries are produced on first play (the packets are recorded while the
+ * clip streams) or while a URL download is being received.
+ */
+
+#ifndef OPUS_CACHE_H
+#define OPUS_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Limits
+ */
+#define OPUS_CACHE_DIR_NAME         "opus_cache"
+#define OPUS_CACHE_MEM_BUDGET       (32 * 1024 * 1024)  /* In-memory LRU budget */
+#define OPUS_CACHE_MAX_PACKET       512                 /* Matches encoder output buffer */
+#define OPUS_CACHE_MAX_PACKETS      (10 * 60 * 50)      /* 10 minutes of 20ms frames */
+#define OPUS_CACHE_KEY_SLOTS        1024                /* File -> key memo table */
+#define OPUS_CACHE_HASH_BUCKETS     256                 /* Key -> in-memory clip */
+
+/*
+ * A complete, immutable packet stream.
+ * Packet i is data[offsets[i] .. offsets[i + 1]).
+ */
+typedef struct OpusClip_s {
+    uint64_t            key;
+    int                 numPackets;
+    uint32_t           *offsets;        /* numPackets + 1 entries */
+    uint8_t            *data;
+    size_t              memSize;        /* Accounted against the LRU budget */
+    int                 refCount;
+
+    struct OpusClip_s  *lruPrev;
+    struct OpusClip_s  *lruNext;
+    struct OpusClip_s  *hashNext;
+} OpusClip;
+
+/*
+ * Incremental builder (packets appended in playback order)
+ */
+typedef struct OpusClipBuilder_s OpusClipBuilder;
+
+/*
+ * Cache statistics
+ */
+typedef struct {
+    uint64_t memHits;
+    uint64_t diskHits;
+    uint64_t misses;
+    uint64_t builds;
+    uint64_t evictions;
+    int      clipsInMemory;
+    size_t   bytesInMemory;
+} OpusCacheStats;
+
+/**
+ * Initialize the cache.
+ * @param baseDir Sound storage directory; the cache lives in a subdirectory
+ * @param bitrate Encoder bitrate; entries built with another bitrate are ignored
+ * @return true on success
+ */
+bool OpusCache_Init(const char *baseDir, int bitrate);
+
+/**
+ * Free all in-memory clips. Disk entries are kept.
+ */
+void OpusCache_Shutdown(void);
+
+/**
+ * Get the content key for a sound file.
+ * The hash is memoized by path, size and mtime so repeat plays don't re-read
+ * the file.
+ * @param filepath Full path to the source file
+ * @param outKey Receives the key
+ * @return false if the file can't be read
+ */
+bool OpusCache_KeyForFile(const char *filepath, uint64_t *outKey);
+
+/**
+ * Look up a clip in memory, then on disk.
+ * The returned clip stays valid until OpusCache_Release().
+ * @return Clip with an extra reference, or NULL on miss
+ */
+OpusClip *OpusCache_Acquire(uint64_t key);
+
+/**
+ * Drop a reference taken by OpusCache_Acquire() or OpusCache_FinishBuild().
+ */
+void OpusCache_Release(OpusClip *clip);
+
+/**
+ * Start recording a packet stream for a key.
+ * @return Builder, or NULL on allocation failure
+ */
+OpusClipBuilder *OpusCache_BeginBuild(uint64_t key);
+
+/**
+ * Set the key of a build started before the content hash was known
+ * (URL downloads encode while the file is still arriving).
+ */
+void OpusCache_SetBuildKey(OpusClipBuilder *builder, uint64_t key);
+
+/**
+ * Append one encoded packet.
+ * @return false if the packet is too large or memory ran out
+ */
+bool OpusCache_BuildAppend(OpusClipBuilder *builder, const uint8_t *packet, int len);
+
+/**
+ * Finish a build: write the disk entry and insert the clip into the LRU.
+ * Frees the builder.
+ * @param keepRef If true, return the clip with a reference held
+ * @return The clip (referenced only if keepRef), or NULL on failure
+ */
+OpusClip *OpusCache_FinishBuild(OpusClipBuilder *builder, bool keepRef);
+
+/**
+ * Discard an unfinished build (e.g. playback was interrupted).
+ */
+void OpusCache_AbortBuild(OpusClipBuilder *builder);
+
+/**
+ * Copy current statistics.
+ */
+void OpusCache_GetStats(OpusCacheStats *out);
+
+#endif /* OPUS_CACHE_H */
@@ -0,0 +1,148 @@
+/**
+ * @file resampler.c
+ * @brief Streaming polyphase sample rate converter (mono, 16-bit)
+ */
+
+#include "resampler.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef M_PI
+    #define M_PI 3.14159265358979323846
+#endif
+
+#define RESAMPLER_ROLLOFF   0.95    /* Cutoff as a fraction of the lower Nyquist */
+
+/*
+ * Converter state
+ *
+ * Conceptually the input is upsampled by L (zeros in between), low-pass
+ * filtered and decimated by M. Only the taps that hit real samples are
+ * evaluated: output time t = k * L + phase uses taps phase, phase + L, ...
+ * against input k, k - 1, ...
+ */
+struct Resampler_s {
+    int     up;                 /* L */
+    int     down;               /* M */
+    int     phase;              /* Position of the next output within the current input */
+    int     skip;               /* Outputs left to drop (filter delay) */
+    int     histPos;
+    float  *taps;               /* [phase][tap] */
+    float   hist[RESAMPLER_TAPS_PER_PHASE * 2];     /* Mirrored ring, newest first */
+};
+
+
+static int gcd(int a, int b) {
+    while (b) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/*
+ * Helper: Blackman-windowed sinc prototype, stored phase-major
+ */
+static void designFilter(Resampler *rs) {
+    int taps = RESAMPLER_TAPS_PER_PHASE;
+    int len = rs->up * taps;
+    double cutoff = 0.5 * RESAMPLER_ROLLOFF / (rs->up > rs->down ? rs->up : rs->down);
+    double center = len * 0.5;     /* Whole-sample delay of taps / 2 inputs */
+
+    for (int n = 0; n < len; n++) {
+        double x = n - center;
+        double sinc = (x == 0.0) ? 2.0 * cutoff :
+                      sin(2.0 * M_PI * cutoff * x) / (M_PI * x);
+        double w = 0.42 - 0.5 * cos(2.0 * M_PI * n / len) +
+                   0.08 * cos(4.0 * M_PI * n / len);
+
+        /* Gain L makes up for the zeros the upsampling inserted */
+        rs->taps[(n % rs->up) * taps + n / rs->up] = (float)(sinc * w * rs->up);
+    }
+}
+
+Resampler *Resampler_Create(int inRate, int outRate) {
+    if (inRate <= 0 || outRate <= 0) {
+        return NULL;
+    }
+
+    int g = gcd(inRate, outRate);
+    int up = outRate / g;
+    int down = inRate / g;
+    if (up > RESAMPLER_MAX_PHASES) {
+        return NULL;
+    }
+
+    Resampler *rs = (Resampler *)calloc(1, sizeof(Resampler));
+    if (!rs) {
+        return NULL;
+    }
+    rs->taps = (float *)malloc((size_t)up * RESAMPLER_TAPS_PER_PHASE * sizeof(float));
+    if (!rs->taps) {
+        free(rs);
+        return NULL;
+    }
+
+    rs->up = up;
+    rs->down = down;
+    rs->skip = (up * RESAMPLER_TAPS_PER_PHASE / 2) / down;
+    designFilter(rs);
+    return rs;
+}
+
+void Resampler_Destroy(Resampler *rs) {
+    if (!rs) {
+        return;
+    }
+    free(rs->taps);
+    free(rs);
+}
+
+int Resampler_MaxOutput(const Resampler *rs, int inCount) {
+    return (int)((int64_t)inCount * rs->up / rs->down) + 2;
+}
+
+int Resampler_Process(Resampler *rs, const int16_t *in, int inCount,
+                      int16_t *out, int outCap) {
+    const int taps = RESAMPLER_TAPS_PER_PHASE;
+    int produced = 0;
+
+    for (int i = 0; i < inCount; i++) {
+        /* Newest sample first; the mirror keeps the window contiguous */
+        rs->histPos = (rs->histPos + taps - 1) % taps;
+        rs->hist[rs->histPos] = rs->hist[rs->histPos + taps] = (float)in[i];
+        const float *window = &rs->hist[rs->histPos];
+
+        while (rs->phase < rs->up) {
+            const float *h = &rs->taps[rs->phase * taps];
+            float acc = 0.0f;
+            for (int j = 0; j < taps; j++) {
+                acc += h[j] * window[j];
+            }
+            rs->phase += rs->down;
+
+            if (rs->skip > 0) {
+                rs->skip--;
+                continue;
+            }
+            if (produced >= outCap) {
+                continue;
+            }
+
+            if (acc > 32767.0f) acc = 32767.0f;
+            if (acc < -32768.0f) acc = -32768.0f;
+            out[produced++] = (int16_t)lrintf(acc);
+        }
+        rs->phase -= rs->up;
+    }
+
+    return produced;
+}
+
+int Resampler_Flush(Resampler *rs, int16_t *out, int outCap) {
+    static const int16_t silence[RESAMPLER_TAPS_PER_PHASE / 2];
+    return Resampler_Process(rs, silence, RESAMPLER_TAPS_PER_PHASE / 2, out, outCap);
+}
@@ -0,0 +1,65 @@
+/**
+ * @file resampler.h
+ * @brief Streaming polyphase sample rate converter (mono, 16-bit)
+ *
+ * Uploaded clips arrive at whatever rate the MP3/WAV was made with, while
+ * Opus runs at 48kHz. Linear interpolation aliases audibly on 22/44.1kHz
+ * music, so conversion uses a windowed-sinc FIR split into L phases for a
+ * rational ratio L/M (e.g. 44100 -> 48000 is 160/147).
+ *
+ * The converter keeps its own history, so input can be fed in arbitrary
+ * chunks (one decoded MP3 frame at a time) and the output is the same as
+ * converting the whole clip at once. Each instance is used by one thread.
+ */
+
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <stdint.h>
+
+/*
+ * Limits
+ */
+#define RESAMPLER_TAPS_PER_PHASE    32
+#define RESAMPLER_MAX_PHASES        1024    /* 11025 -> 48000 needs 640 */
+
+typedef struct Resampler_s Resampler;
+
+/**
+ * Create a converter.
+ * @param inRate Input sample rate in Hz
+ * @param outRate Output sample rate in Hz
+ * @return Converter, or NULL if the ratio needs more than
+ *         RESAMPLER_MAX_PHASES phases or memory ran out
+ */
+Resampler *Resampler_Create(int inRate, int outRate);
+
+/**
+ * Free a converter.
+ */
+void Resampler_Destroy(Resampler *rs);
+
+/**
+ * Upper bound on the output produced for inCount input samples.
+ */
+int Resampler_MaxOutput(const Resampler *rs, int inCount);
+
+/**
+ * Convert a chunk of input.
+ * @param in Input samples
+ * @param inCount Number of input samples
+ * @param out Output buffer
+ * @param outCap Size of out; must be at least Resampler_MaxOutput(inCount)
+ * @return Number of output samples written
+ */
+int Resampler_Process(Resampler *rs, const int16_t *in, int inCount,
+                      int16_t *out, int outCap);
+
+/**
+ * Drain the filter delay at end of stream (feeds silence).
+ * @param out Output buffer, at least Resampler_MaxOutput(RESAMPLER_TAPS_PER_PHASE)
+ * @return Number of output samples written
+ */
+int Resampler_Flush(Resampler *rs, int16_t *out, int outCap);
+
+#endif /* RESAMPLER_H */
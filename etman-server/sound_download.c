@@ -0,0 +1,589 @@
+/**
+ * @file sound_download.c
+ * @brief In-process URL download and Opus transcode worker for SoundMgr
+ */
+
+#include "sound_download.h"
+#include "resampler.h"
+#include "worker_pool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <curl/curl.h>
+#include <opus/opus.h>
+
+/* Declarations only; the implementation lives in sound_manager.c */
+#include "../src/libs/minimp3/minimp3.h"
+
+/*
+ * Queue slot (state DOWNLOAD_IDLE = free)
+ */
+typedef struct {
+    DownloadRequest     req;
+    char                filepath[1024];
+    OpusClipBuilder    *builder;
+    uint32_t            seq;            /* Queue order */
+} DownloadJob;
+
+/*
+ * One running transfer (worker thread only)
+ */
+typedef struct {
+    DownloadJob        *job;
+    FILE               *file;
+    long                received;
+    char                error[128];
+    int                 lastProgress;
+
+    /* Streaming decode */
+    bool                sniffed;        /* Magic bytes checked */
+    uint32_t            skip;           /* ID3v2 tag bytes still to drop */
+    mp3dec_t            mp3;
+    uint8_t            *mp3Buf;         /* SOUND_DOWNLOAD_MP3_BUFFER bytes */
+    int                 mp3Len;
+    int                 decodedFrames;
+
+    /* Transcode */
+    Resampler          *rs;
+    int                 rsRate;
+    int16_t            *rsOut;
+    int                 rsOutCap;
+    OpusEncoder        *encoder;
+    int16_t             frame[OPUS_FRAME_SIZE];
+    int                 frameLen;
+    int                 encodedSamples;
+    bool                encodeDone;     /* Duration limit reached or no cache */
+} Transfer;
+
+/*
+ * Module state
+ */
+static struct {
+    bool                initialized;
+    volatile bool       running;
+    pthread_t           thread;
+
+    pthread_mutex_t     lock;
+    pthread_cond_t      cond;
+    DownloadJob         jobs[SOUND_DOWNLOAD_QUEUE_SIZE];
+    uint32_t            nextSeq;
+} g_dl;
+
+
+/*
+ * Helper: Send a VOICE_RESP_PROGRESS packet.
+ * Safe from this thread: the I/O thread resolves the client's address.
+ */
+static void postProgress(const DownloadJob *job, int percent) {
+    uint8_t packet[8];
+    int len = snprintf((char *)packet + 1, sizeof(packet) - 1, "%d", percent);
+    packet[0] = VOICE_RESP_PROGRESS;
+    WorkerPool_PostResponse(WORKER_RESP_TO_CLIENT, job->req.clientId, NULL,
+                            packet, 1 + len + 1);
+}
+
+/*
+ * Helper: Encode one full frame into the cache builder
+ */
+static void encodeFrame(Transfer *t) {
+    uint8_t packet[OPUS_CACHE_MAX_PACKET];
+
+    if (t->frameLen < OPUS_FRAME_SIZE) {
+        memset(t->frame + t->frameLen, 0, (OPUS_FRAME_SIZE - t->frameLen) * sizeof(int16_t));
+    }
+
+    int encoded = opus_encode(t->encoder, t->frame, OPUS_FRAME_SIZE, packet, sizeof(packet));
+    if (encoded < 0 || !OpusCache_BuildAppend(t->job->builder, packet, encoded)) {
+        /* The sound is still usable, playback will encode it instead */
+        OpusCache_AbortBuild(t->job->builder);
+        t->job->builder = NULL;
+        t->encodeDone = true;
+    }
+
+    t->encodedSamples += t->frameLen;
+    t->frameLen = 0;
+    if (t->encodedSamples >= SOUND_MAX_DURATION_SEC * OPUS_SAMPLE_RATE) {
+        t->encodeDone = true;
+    }
+}
+
+/*
+ * Helper: Queue 48kHz mono samples for encoding
+ */
+static void pushPcm(Transfer *t, const int16_t *pcm, int count) {
+    while (count > 0 && !t->encodeDone) {
+        int n = OPUS_FRAME_SIZE - t->frameLen;
+        if (n > count) n = count;
+
+        memcpy(t->frame + t->frameLen, pcm, n * sizeof(int16_t));
+        t->frameLen += n;
+        pcm += n;
+        count -= n;
+
+        if (t->frameLen == OPUS_FRAME_SIZE) {
+            encodeFrame(t);
+        }
+    }
+}
+
+/*
+ * Helper: Downmix and resample one decoded MP3 frame
+ */
+static bool handleFrame(Transfer *t, int16_t *pcm, int samples,
+                        const mp3dec_frame_info_t *info) {
+    if (info->channels == 2) {
+        for (int i = 0; i < samples; i++) {
+            pcm[i] = (pcm[i * 2] + pcm[i * 2 + 1]) / 2;
+        }
+    }
+
+    if (info->hz == OPUS_SAMPLE_RATE) {
+        pushPcm(t, pcm, samples);
+        return true;
+    }
+
+    /* A stream that changes rate midway is treated as having the first rate */
+    if (!t->rs) {
+        t->rs = Resampler_Create(info->hz, OPUS_SAMPLE_RATE);
+        t->rsOutCap = t->rs ? Resampler_MaxOutput(t->rs, MINIMP3_MAX_SAMPLES_PER_FRAME) : 0;
+        t->rsOut = t->rs ? (int16_t *)malloc(t->rsOutCap * sizeof(int16_t)) : NULL;
+        if (!t->rsOut) {
+            snprintf(t->error, sizeof(t->error), "Unsupported sample rate (%d Hz)", info->hz);
+            return false;
+        }
+        t->rsRate = info->hz;
+    }
+    if (info->hz != t->rsRate) {
+        return true;
+    }
+
+    int n = Resampler_Process(t->rs, pcm, samples, t->rsOut, t->rsOutCap);
+    pushPcm(t, t->rsOut, n);
+    return true;
+}
+
+/*
+ * Helper: Decode complete frames from the input buffer.
+ * Until the end of the stream a frame is only decoded with half a buffer
+ * of lookahead, so minimp3 can verify the sync word against later frames.
+ */
+static bool decodeBuffered(Transfer *t, bool final) {
+    int16_t pcm[MINIMP3_MAX_SAMPLES_PER_FRAME];
+    int offset = 0;
+
+    while (!t->encodeDone && t->mp3Len - offset > 0 &&
+           (final || t->mp3Len - offset >= SOUND_DOWNLOAD_MP3_BUFFER / 2)) {
+        mp3dec_frame_info_t info;
+        int samples = mp3dec_decode_frame(&t->mp3, t->mp3Buf + offset,
+                                          t->mp3Len - offset, pcm, &info);
+        if (info.frame_bytes <= 0) {
+            /* No frame in the buffered data; it is junk unless more may follow */
+            if (final || t->mp3Len == SOUND_DOWNLOAD_MP3_BUFFER) {
+                offset = t->mp3Len;
+            }
+            break;
+        }
+        offset += info.frame_bytes;
+
+        if (samples > 0) {
+            t->decodedFrames++;
+            if (!handleFrame(t, pcm, samples, &info)) {
+                return false;
+            }
+        }
+    }
+
+    if (t->encodeDone) {
+        offset = t->mp3Len;
+    }
+    if (offset > 0) {
+        memmove(t->mp3Buf, t->mp3Buf + offset, t->mp3Len - offset);
+        t->mp3Len -= offset;
+    }
+    return true;
+}
+
+/*
+ * Helper: Feed received bytes to the decoder
+ */
+static bool feedDecoder(Transfer *t, const uint8_t *data, size_t len) {
+    while (len > 0) {
+        if (t->skip > 0) {
+            size_t n = len < t->skip ? len : t->skip;
+            t->skip -= (uint32_t)n;
+            data += n;
+            len -= n;
+            continue;
+        }
+
+        size_t n = SOUND_DOWNLOAD_MP3_BUFFER - t->mp3Len;
+        if (n > len) n = len;
+        memcpy(t->mp3Buf + t->mp3Len, data, n);
+        t->mp3Len += (int)n;
+        data += n;
+        len -= n;
+
+        /* Check the magic bytes and step over an ID3v2 tag (cover art can
+         * be larger than the whole input buffer) */
+        if (!t->sniffed && t->mp3Len >= 10) {
+            const uint8_t *h = t->mp3Buf;
+            t->sniffed = true;
+
+            if (h[0] == 'I' && h[1] == 'D' && h[2] == '3') {
+                uint32_t tagSize = ((uint32_t)(h[6] & 0x7F) << 21) | ((h[7] & 0x7F) << 14) |
+                                   ((h[8] & 0x7F) << 7) | (h[9] & 0x7F);
+                tagSize += 10;
+                if (h[5] & 0x10) {
+                    tagSize += 10;      /* Footer */
+                }
+
+                uint32_t drop = tagSize < (uint32_t)t->mp3Len ? tagSize : (uint32_t)t->mp3Len;
+                memmove(t->mp3Buf, t->mp3Buf + drop, t->mp3Len - drop);
+                t->mp3Len -= (int)drop;
+                t->skip = tagSize - drop;
+            } else if (!(h[0] == 0xFF && (h[1] & 0xE0) == 0xE0)) {
+                snprintf(t->error, sizeof(t->error), "Not a valid MP3 file");
+                return false;
+            }
+        }
+
+        if (!t->sniffed) {
+            continue;
+        }
+        if (t->encodeDone) {
+            t->mp3Len = 0;      /* Only the file is still needed */
+        } else if (!decodeBuffered(t, false)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * libcurl: body data
+ */
+static size_t onWrite(char *ptr, size_t size, size_t nmemb, void *userdata) {
+    Transfer *t = (Transfer *)userdata;
+    size_t len = size * nmemb;
+
+    t->received += (long)len;
+    if (t->received > SOUND_MAX_FILESIZE) {
+        snprintf(t->error, sizeof(t->error), "File too large (max %dMB)",
+                 SOUND_MAX_FILESIZE / (1024 * 1024));
+        return 0;
+    }
+
+    if (fwrite(ptr, 1, len, t->file) != len) {
+        snprintf(t->error, sizeof(t->error), "Could not save file");
+        return 0;
+    }
+
+    if (!feedDecoder(t, (const uint8_t *)ptr, len)) {
+        return 0;
+    }
+    return len;
+}
+
+/*
+ * libcurl: transfer progress (also polled while the connection is idle)
+ */
+static int onProgress(void *userdata, curl_off_t dltotal, curl_off_t dlnow,
+                      curl_off_t ultotal, curl_off_t ulnow) {
+    Transfer *t = (Transfer *)userdata;
+    (void)ultotal;
+    (void)ulnow;
+
+    if (!g_dl.running) {
+        snprintf(t->error, sizeof(t->error), "Server shutting down");
+        return 1;
+    }
+
+    if (dltotal > 0) {
+        int percent = (int)(dlnow * 100 / dltotal);
+        if (percent < 100 && percent >= t->lastProgress + SOUND_DOWNLOAD_PROGRESS_STEP) {
+            t->lastProgress = percent - percent % SOUND_DOWNLOAD_PROGRESS_STEP;
+            t->job->req.progress = t->lastProgress;
+            postProgress(t->job, t->lastProgress);
+        }
+    }
+    return 0;
+}
+
+/*
+ * Helper: User-facing message for a libcurl error
+ */
+static void describeCurlError(CURLcode res, char *out, size_t outLen) {
+    switch (res) {
+        case CURLE_HTTP_RETURNED_ERROR:  snprintf(out, outLen, "URL not found (404) or server error"); break;
+        case CURLE_OPERATION_TIMEDOUT:   snprintf(out, outLen, "Download timed out (2 min limit)"); break;
+        case CURLE_FILESIZE_EXCEEDED:    snprintf(out, outLen, "File too large (max %dMB)",
+                                                  SOUND_MAX_FILESIZE / (1024 * 1024)); break;
+        case CURLE_COULDNT_RESOLVE_HOST: snprintf(out, outLen, "Could not resolve host"); break;
+        case CURLE_COULDNT_CONNECT:      snprintf(out, outLen, "Could not connect to server"); break;
+        case CURLE_SSL_CONNECT_ERROR:    snprintf(out, outLen, "SSL/TLS connection error"); break;
+        case CURLE_RECV_ERROR:           snprintf(out, outLen, "Network error during download"); break;
+        default: snprintf(out, outLen, "Download failed (curl error %d)", (int)res); break;
+    }
+}
+
+/*
+ * Helper: Download, decode and encode one job.
+ * @return true on success; on failure job->req.errorMsg is set
+ */
+static bool runJob(DownloadJob *job) {
+    Transfer t;
+    memset(&t, 0, sizeof(t));
+    t.job = job;
+    mp3dec_init(&t.mp3);
+
+    /* "x": never clobber a sound that appeared since the request was queued */
+    t.file = fopen(job->filepath, "wbx");
+    if (!t.file) {
+        snprintf(job->req.errorMsg, sizeof(job->req.errorMsg),
+                 "A sound with that name already exists");
+        return false;
+    }
+
+    t.mp3Buf = (uint8_t *)malloc(SOUND_DOWNLOAD_MP3_BUFFER);
+    t.encoder = SoundMixer_CreateEncoder();
+    job->builder = (t.mp3Buf && t.encoder) ? OpusCache_BeginBuild(0) : NULL;
+    t.encodeDone = (job->builder == NULL);
+
+    CURLcode res = CURLE_FAILED_INIT;
+    CURL *curl = t.mp3Buf ? curl_easy_init() : NULL;
+    if (curl) {
+        curl_easy_setopt(curl, CURLOPT_URL, job->req.url);
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 5L);
+        curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)SOUND_DOWNLOAD_TIMEOUT);
+        curl_easy_setopt(curl, CURLOPT_MAXFILESIZE, (long)SOUND_MAX_FILESIZE);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, onWrite);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &t);
+        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, onProgress);
+        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &t);
+        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+
+        res = curl_easy_perform(curl);
+        curl_easy_cleanup(curl);
+    }
+
+    bool ok = (res == CURLE_OK);
+
+    /* Files under 10 bytes never reached the magic check */
+    if (ok && !t.sniffed &&
+        !(t.mp3Len >= 2 && t.mp3Buf[0] == 0xFF && (t.mp3Buf[1] & 0xE0) == 0xE0)) {
+        snprintf(t.error, sizeof(t.error), "Not a valid MP3 file");
+        ok = false;
+    }
+
+    /* Drain the decoder, the resampler delay and the last partial frame */
+    if (ok && !t.encodeDone) {
+        ok = decodeBuffered(&t, true);
+        if (ok && t.decodedFrames == 0) {
+            snprintf(t.error, sizeof(t.error), "Not a valid MP3 file");
+            ok = false;
+        }
+        if (ok && t.rs) {
+            int n = Resampler_Flush(t.rs, t.rsOut, t.rsOutCap);
+            pushPcm(&t, t.rsOut, n);
+        }
+        if (ok && t.frameLen > 0 && !t.encodeDone) {
+            encodeFrame(&t);
+        }
+    }
+
+    if (!ok) {
+        if (t.error[0]) {
+            snprintf(job->req.errorMsg, sizeof(job->req.errorMsg), "%s", t.error);
+        } else {
+            describeCurlError(res, job->req.errorMsg, sizeof(job->req.errorMsg));
+        }
+    }
+
+    if (fclose(t.file) != 0 && ok) {
+        snprintf(job->req.errorMsg, sizeof(job->req.errorMsg), "Could not save file");
+        ok = false;
+    }
+    if (!ok) {
+        remove(job->filepath);
+        OpusCache_AbortBuild(job->builder);
+        job->builder = NULL;
+    }
+
+    if (t.encoder) {
+        opus_encoder_destroy(t.encoder);
+    }
+    Resampler_Destroy(t.rs);
+    free(t.rsOut);
+    free(t.mp3Buf);
+    return ok;
+}
+
+/*
+ * Worker thread: run queued jobs in order
+ */
+static void *downloadThread(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&g_dl.lock);
+    while (g_dl.running) {
+        DownloadJob *job = NULL;
+        for (int i = 0; i < SOUND_DOWNLOAD_QUEUE_SIZE; i++) {
+            DownloadJob *j = &g_dl.jobs[i];
+            if (j->req.state == DOWNLOAD_PENDING && (!job || (int32_t)(j->seq - job->seq) < 0)) {
+                job = j;
+            }
+        }
+        if (!job) {
+            pthread_cond_wait(&g_dl.cond, &g_dl.lock);
+            continue;
+        }
+
+        /* The slot is ours until it is marked finished */
+        job->req.state = DOWNLOAD_IN_PROGRESS;
+        pthread_mutex_unlock(&g_dl.lock);
+
+        printf("SoundDownload: Fetching %s for %s/%s\n",
+               job->req.url, job->req.guid, job->req.name);
+        bool ok = runJob(job);
+
+        pthread_mutex_lock(&g_dl.lock);
+        job->req.state = ok ? DOWNLOAD_COMPLETE : DOWNLOAD_FAILED;
+        if (ok) {
+            job->req.progress = 100;
+        }
+    }
+    pthread_mutex_unlock(&g_dl.lock);
+    return NULL;
+}
+
+
+bool SoundDownload_Init(void) {
+    if (g_dl.initialized) {
+        return true;
+    }
+
+    memset(&g_dl, 0, sizeof(g_dl));
+    if (curl_global_init(CURL_GLOBAL_DEFAULT) != CURLE_OK) {
+        fprintf(stderr, "SoundDownload: libcurl initialization failed\n");
+        return false;
+    }
+
+    pthread_mutex_init(&g_dl.lock, NULL);
+    pthread_cond_init(&g_dl.cond, NULL);
+    g_dl.running = true;
+
+    if (pthread_create(&g_dl.thread, NULL, downloadThread, NULL) != 0) {
+        fprintf(stderr, "SoundDownload: Failed to start worker thread\n");
+        g_dl.running = false;
+        pthread_cond_destroy(&g_dl.cond);
+        pthread_mutex_destroy(&g_dl.lock);
+        curl_global_cleanup();
+        return false;
+    }
+
+    g_dl.initialized = true;
+    printf("SoundDownload: Worker started (queue %d)\n", SOUND_DOWNLOAD_QUEUE_SIZE);
+    return true;
+}
+
+void SoundDownload_Shutdown(void) {
+    if (!g_dl.initialized) {
+        return;
+    }
+
+    /* The progress callback aborts a running transfer within a second */
+    pthread_mutex_lock(&g_dl.lock);
+    g_dl.running = false;
+    pthread_cond_broadcast(&g_dl.cond);
+    pthread_mutex_unlock(&g_dl.lock);
+    pthread_join(g_dl.thread, NULL);
+
+    for (int i = 0; i < SOUND_DOWNLOAD_QUEUE_SIZE; i++) {
+        DownloadJob *job = &g_dl.jobs[i];
+        if (job->req.state == DOWNLOAD_IDLE) {
+            continue;
+        }
+        if (job->req.state != DOWNLOAD_COMPLETE) {
+            remove(job->filepath);
+        }
+        OpusCache_AbortBuild(job->builder);
+    }
+
+    pthread_cond_destroy(&g_dl.cond);
+    pthread_mutex_destroy(&g_dl.lock);
+    curl_global_cleanup();
+    memset(&g_dl, 0, sizeof(g_dl));
+    printf("SoundDownload: Shutdown complete\n");
+}
+
+bool SoundDownload_Queue(const DownloadRequest *request, const char *filepath) {
+    if (!g_dl.initialized) {
+        return false;
+    }
+
+    pthread_mutex_lock(&g_dl.lock);
+    DownloadJob *job = NULL;
+    for (int i = 0; i < SOUND_DOWNLOAD_QUEUE_SIZE; i++) {
+        if (g_dl.jobs[i].req.state == DOWNLOAD_IDLE) {
+            job = &g_dl.jobs[i];
+            break;
+        }
+    }
+
+    if (job) {
+        memset(job, 0, sizeof(*job));
+        job->req = *request;
+        job->req.state = DOWNLOAD_PENDING;
+        job->req.progress = 0;
+        job->req.errorMsg[0] = '\0';
+        snprintf(job->filepath, sizeof(job->filepath), "%s", filepath);
+        job->seq = g_dl.nextSeq++;
+        pthread_cond_signal(&g_dl.cond);
+    }
+    pthread_mutex_unlock(&g_dl.lock);
+
+    return job != NULL;
+}
+
+int SoundDownload_NumPending(void) {
+    if (!g_dl.initialized) {
+        return 0;
+    }
+
+    int count = 0;
+    pthread_mutex_lock(&g_dl.lock);
+    for (int i = 0; i < SOUND_DOWNLOAD_QUEUE_SIZE; i++) {
+        if (g_dl.jobs[i].req.state != DOWNLOAD_IDLE) {
+            count++;
+        }
+    }
+    pthread_mutex_unlock(&g_dl.lock);
+    return count;
+}
+
+bool SoundDownload_Poll(SoundDownloadResult *out) {
+    if (!g_dl.initialized) {
+        return false;
+    }
+
+    bool found = false;
+    pthread_mutex_lock(&g_dl.lock);
+    for (int i = 0; i < SOUND_DOWNLOAD_QUEUE_SIZE; i++) {
+        DownloadJob *job = &g_dl.jobs[i];
+        if (job->req.state == DOWNLOAD_COMPLETE || job->req.state == DOWNLOAD_FAILED) {
+            out->request = job->req;
+            snprintf(out->filepath, sizeof(out->filepath), "%s", job->filepath);
+            out->builder = job->builder;
+            memset(job, 0, sizeof(*job));
+            found = true;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_dl.lock);
+    return found;
+}
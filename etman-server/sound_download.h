@@ -0,0 +1,78 @@
+/**
+ * @file sound_download.h
+ * @brief In-process URL download and Opus transcode worker for SoundMgr
+ *
+ * "/etman add <url> <name>" used to fork a child per download that ran the
+ * curl binary, reported errors through side files and then decoded the
+ * whole MP3 again to build the Opus cache entry.
+ *
+ * Now a single worker thread takes jobs from a bounded queue and does it
+ * all in one pass with libcurl: every received chunk is written to the
+ * sound file and fed to a streaming MP3 decoder (bounded input buffer),
+ * the PCM goes through the polyphase resampler and the Opus encoder, and
+ * the packets are appended to an Opus cache builder. Only the first
+ * SOUND_MAX_DURATION_SEC seconds are encoded, as for playback.
+ *
+ * Download progress goes straight to the client as VOICE_RESP_PROGRESS
+ * packets. Finished jobs are collected by SoundMgr_Frame() (service lock
+ * held), which publishes the cache entry and sends the final response.
+ */
+
+#ifndef SOUND_DOWNLOAD_H
+#define SOUND_DOWNLOAD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sound_manager.h"
+#include "opus_cache.h"
+
+/*
+ * Limits
+ */
+#define SOUND_DOWNLOAD_QUEUE_SIZE       4           /* Queued + running jobs */
+#define SOUND_DOWNLOAD_MP3_BUFFER       (32 * 1024) /* Undecoded input kept in memory */
+#define SOUND_DOWNLOAD_PROGRESS_STEP    10          /* Percent between progress packets */
+
+/*
+ * A finished job
+ */
+typedef struct {
+    DownloadRequest     request;        /* state is DOWNLOAD_COMPLETE or DOWNLOAD_FAILED */
+    char                filepath[1024];
+    OpusClipBuilder    *builder;        /* Encoded packets (key not set), may be NULL */
+} SoundDownloadResult;
+
+/**
+ * Start the worker thread.
+ * @return true on success
+ */
+bool SoundDownload_Init(void);
+
+/**
+ * Stop the worker. The running transfer is aborted, queued and unclaimed
+ * jobs are dropped and their partial files removed.
+ */
+void SoundDownload_Shutdown(void);
+
+/**
+ * Queue a download. Never blocks.
+ * @param request Who asked, what and from where (copied)
+ * @param filepath Destination file (must not exist yet)
+ * @return false if the queue is full or the worker isn't running
+ */
+bool SoundDownload_Queue(const DownloadRequest *request, const char *filepath);
+
+/**
+ * Number of jobs queued, running or finished but not yet collected.
+ */
+int SoundDownload_NumPending(void);
+
+/**
+ * Take one finished job.
+ * On success the caller owns out->builder.
+ * @return false if none is ready
+ */
+bool SoundDownload_Poll(SoundDownloadResult *out);
+
+#endif /* SOUND_DOWNLOAD_H */
@@ -0,0 +1,416 @@
+/**
+ * @file sound_index.c
+ * @brief In-memory trigram index for fuzzy sound name search
+ */
+
+#include "sound_index.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+
+#define INDEX_OWNER_BUCKETS     256
+#define INDEX_TRIGRAM_BUCKETS   4096
+
+/*
+ * Growable list of entry ids
+ */
+typedef struct {
+    int    *ids;
+    int     count;
+    int     cap;
+} IdList;
+
+typedef struct IndexOwner_s {
+    char                    guid[33];       /* "" = public sounds */
+    time_t                  loadedAt;
+    bool                    stale;
+    IdList                  entries;
+    struct IndexOwner_s    *next;
+} IndexOwner;
+
+typedef struct {
+    char        name[SOUND_INDEX_NAME_LEN]; /* Lowercased */
+    int         nameLen;
+    char       *filePath;
+    int         soundFileId;
+    IndexOwner *owner;                      /* NULL when the slot is free */
+} IndexEntry;
+
+/*
+ * Entries containing one trigram
+ */
+typedef struct Posting_s {
+    uint32_t            trigram;
+    IdList              ids;
+    struct Posting_s   *next;
+} Posting;
+
+/*
+ * Module state
+ */
+static struct {
+    IndexEntry *entries;
+    int         entryCount;                 /* Slots in use or freed */
+    int         entryCap;
+    IdList      freeIds;
+
+    IndexOwner *owners[INDEX_OWNER_BUCKETS];
+    Posting    *postings[INDEX_TRIGRAM_BUCKETS];
+    SoundIndexStats stats;
+} g_index;
+
+
+static bool idListAdd(IdList *list, int id) {
+    if (list->count == list->cap) {
+        int newCap = list->cap ? list->cap * 2 : 8;
+        int *ids = realloc(list->ids, newCap * sizeof(*ids));
+        if (!ids) return false;
+        list->ids = ids;
+        list->cap = newCap;
+    }
+    list->ids[list->count++] = id;
+    return true;
+}
+
+static void idListRemove(IdList *list, int id) {
+    for (int i = 0; i < list->count; i++) {
+        if (list->ids[i] == id) {
+            list->ids[i] = list->ids[--list->count];
+            return;
+        }
+    }
+}
+
+/*
+ * Helper: Lowercase a name into a SOUND_INDEX_NAME_LEN buffer
+ * @return Length, or -1 if empty or too long
+ */
+static int lowerName(char *dest, const char *src) {
+    int len = 0;
+    if (!src) return -1;
+    for (; src[len]; len++) {
+        if (len >= SOUND_INDEX_NAME_LEN - 1) return -1;
+        dest[len] = (char)tolower((unsigned char)src[len]);
+    }
+    dest[len] = '\0';
+    return len > 0 ? len : -1;
+}
+
+static uint32_t trigramAt(const char *s) {
+    return ((uint32_t)(uint8_t)s[0] << 16) | ((uint32_t)(uint8_t)s[1] << 8) | (uint8_t)s[2];
+}
+
+static Posting *findPosting(uint32_t trigram, bool create) {
+    Posting **bucket = &g_index.postings[(trigram * 2654435761u) >> 20];
+    for (Posting *p = *bucket; p; p = p->next) {
+        if (p->trigram == trigram) return p;
+    }
+    if (!create) return NULL;
+
+    Posting *p = calloc(1, sizeof(*p));
+    if (!p) return NULL;
+    p->trigram = trigram;
+    p->next = *bucket;
+    *bucket = p;
+    g_index.stats.trigrams++;
+    return p;
+}
+
+static void dropPostingId(uint32_t trigram, int id) {
+    Posting **link = &g_index.postings[(trigram * 2654435761u) >> 20];
+    for (; *link; link = &(*link)->next) {
+        Posting *p = *link;
+        if (p->trigram != trigram) continue;
+
+        idListRemove(&p->ids, id);
+        if (p->ids.count == 0) {
+            *link = p->next;
+            free(p->ids.ids);
+            free(p);
+            g_index.stats.trigrams--;
+        }
+        return;
+    }
+}
+
+static IndexOwner *findOwner(const char *guid, bool create) {
+    uint32_t h = 2166136261u;
+    for (const char *p = guid; *p; p++) {
+        h = (h ^ (uint8_t)*p) * 16777619u;
+    }
+
+    IndexOwner **bucket = &g_index.owners[h % INDEX_OWNER_BUCKETS];
+    for (IndexOwner *o = *bucket; o; o = o->next) {
+        if (strcmp(o->guid, guid) == 0) return o;
+    }
+    if (!create || strlen(guid) >= sizeof(((IndexOwner *)0)->guid)) return NULL;
+
+    IndexOwner *o = calloc(1, sizeof(*o));
+    if (!o) return NULL;
+    snprintf(o->guid, sizeof(o->guid), "%s", guid);
+    o->stale = true;
+    o->next = *bucket;
+    *bucket = o;
+    g_index.stats.owners++;
+    return o;
+}
+
+static void removeEntry(int id) {
+    IndexEntry *e = &g_index.entries[id];
+
+    for (int i = 0; i + 3 <= e->nameLen; i++) {
+        dropPostingId(trigramAt(e->name + i), id);
+    }
+    idListRemove(&e->owner->entries, id);
+
+    free(e->filePath);
+    e->filePath = NULL;
+    e->owner = NULL;
+    idListAdd(&g_index.freeIds, id);    /* On failure the slot is just not reused */
+    g_index.stats.entries--;
+}
+
+/*
+ * Helper: Rank how well a name matches a query (lower is better)
+ * @return Score, or -1 if the name doesn't match
+ */
+static int matchScore(const IndexEntry *e, const char *query, int queryLen) {
+    if (e->nameLen < queryLen) return -1;
+
+    if (strncmp(e->name, query, queryLen) == 0) {
+        return e->nameLen - queryLen;               /* 0 = exact */
+    }
+
+    /* Start of a later word */
+    for (const char *p = strstr(e->name + 1, query); p; p = strstr(p + 1, query)) {
+        if (!isalnum((unsigned char)p[-1])) {
+            return SOUND_INDEX_NAME_LEN + e->nameLen - queryLen;
+        }
+    }
+    return -1;
+}
+
+
+void SoundIndex_Clear(void) {
+    for (int i = 0; i < g_index.entryCount; i++) {
+        free(g_index.entries[i].filePath);
+    }
+    free(g_index.entries);
+    free(g_index.freeIds.ids);
+
+    for (int i = 0; i < INDEX_OWNER_BUCKETS; i++) {
+        IndexOwner *o = g_index.owners[i];
+        while (o) {
+            IndexOwner *next = o->next;
+            free(o->entries.ids);
+            free(o);
+            o = next;
+        }
+    }
+    for (int i = 0; i < INDEX_TRIGRAM_BUCKETS; i++) {
+        Posting *p = g_index.postings[i];
+        while (p) {
+            Posting *next = p->next;
+            free(p->ids.ids);
+            free(p);
+            p = next;
+        }
+    }
+
+    SoundIndexStats stats = g_index.stats;
+    memset(&g_index, 0, sizeof(g_index));
+    g_index.stats.lookups = stats.lookups;
+    g_index.stats.hits = stats.hits;
+    g_index.stats.reloads = stats.reloads;
+}
+
+void SoundIndex_BeginOwner(const char *owner) {
+    IndexOwner *o = findOwner(owner ? owner : "", true);
+    if (!o) return;
+
+    while (o->entries.count > 0) {
+        removeEntry(o->entries.ids[o->entries.count - 1]);
+    }
+    o->loadedAt = time(NULL);
+    o->stale = false;
+    g_index.stats.reloads++;
+}
+
+bool SoundIndex_Add(const char *owner, const char *name, const char *filePath,
+                    int soundFileId) {
+    char lower[SOUND_INDEX_NAME_LEN];
+    int len = lowerName(lower, name);
+    if (len < 0 || !filePath) return false;
+
+    IndexOwner *o = findOwner(owner ? owner : "", true);
+    if (!o) return false;
+
+    int id;
+    if (g_index.freeIds.count > 0) {
+        id = g_index.freeIds.ids[--g_index.freeIds.count];
+    } else {
+        if (g_index.entryCount == g_index.entryCap) {
+            int newCap = g_index.entryCap ? g_index.entryCap * 2 : 256;
+            IndexEntry *entries = realloc(g_index.entries, newCap * sizeof(*entries));
+            if (!entries) return false;
+            g_index.entries = entries;
+            g_index.entryCap = newCap;
+        }
+        id = g_index.entryCount++;
+    }
+
+    IndexEntry *e = &g_index.entries[id];
+    memset(e, 0, sizeof(*e));
+    memcpy(e->name, lower, len + 1);
+    e->nameLen = len;
+    e->soundFileId = soundFileId;
+    e->filePath = strdup(filePath);
+    e->owner = o;
+    g_index.stats.entries++;
+
+    bool ok = e->filePath && idListAdd(&o->entries, id);
+    for (int i = 0; ok && i + 3 <= len; i++) {
+        Posting *p = findPosting(trigramAt(lower + i), true);
+        ok = p && idListAdd(&p->ids, id);
+    }
+    if (!ok) {
+        removeEntry(id);        /* Unlinks whatever was linked */
+        return false;
+    }
+    return true;
+}
+
+void SoundIndex_Rename(const char *owner, const char *oldName, const char *newName) {
+    char lower[SOUND_INDEX_NAME_LEN], newLower[SOUND_INDEX_NAME_LEN];
+    IndexOwner *o = findOwner(owner ? owner : "", false);
+    if (!o || lowerName(lower, oldName) < 0) return;
+    if (lowerName(newLower, newName) >= 0 && strcmp(lower, newLower) == 0) {
+        return;     /* Case-only rename, names are stored lowercased */
+    }
+
+    /* Re-adding reorders the owner's list, so restart after each rename */
+    bool renamed;
+    do {
+        renamed = false;
+        for (int i = 0; i < o->entries.count; i++) {
+            int id = o->entries.ids[i];
+            IndexEntry *e = &g_index.entries[id];
+            if (strcmp(e->name, lower) != 0) continue;
+
+            char *path = e->filePath;
+            int soundFileId = e->soundFileId;
+            e->filePath = NULL;
+            removeEntry(id);
+            SoundIndex_Add(o->guid, newName, path, soundFileId);
+            free(path);
+            renamed = true;
+            break;
+        }
+    } while (renamed);
+}
+
+void SoundIndex_Remove(const char *owner, const char *name) {
+    char lower[SOUND_INDEX_NAME_LEN];
+    IndexOwner *o = findOwner(owner ? owner : "", false);
+    if (!o || lowerName(lower, name) < 0) return;
+
+    for (int i = o->entries.count - 1; i >= 0; i--) {
+        int id = o->entries.ids[i];
+        if (strcmp(g_index.entries[id].name, lower) == 0) {
+            removeEntry(id);    /* Swaps in an already checked id */
+        }
+    }
+}
+
+void SoundIndex_RemoveFile(const char *owner, int soundFileId) {
+    IndexOwner *o = findOwner(owner ? owner : "", false);
+    if (!o) return;
+
+    for (int i = o->entries.count - 1; i >= 0; i--) {
+        int id = o->entries.ids[i];
+        if (g_index.entries[id].soundFileId == soundFileId) {
+            removeEntry(id);
+        }
+    }
+}
+
+void SoundIndex_Invalidate(const char *owner) {
+    IndexOwner *o = findOwner(owner ? owner : "", false);
+    if (o) {
+        o->stale = true;
+    }
+}
+
+int SoundIndex_OwnerAge(const char *owner) {
+    IndexOwner *o = findOwner(owner ? owner : "", false);
+    if (!o || o->stale) return -1;
+    return (int)(time(NULL) - o->loadedAt);
+}
+
+bool SoundIndex_Find(const char *owner, const char *query, char *outFilePath,
+                     int outLen, int *outSoundFileId) {
+    char lower[SOUND_INDEX_NAME_LEN];
+    g_index.stats.lookups++;
+
+    int len = lowerName(lower, query);
+    IndexOwner *o = findOwner(owner ? owner : "", false);
+    if (len < 0 || !o) return false;
+
+    /* Candidates: the owner's names, or the rarest trigram's names */
+    const IdList *candidates = &o->entries;
+    for (int i = 0; i + 3 <= len; i++) {
+        Posting *p = findPosting(trigramAt(lower + i), false);
+        if (!p) return false;
+        if (p->ids.count < candidates->count) {
+            candidates = &p->ids;
+        }
+    }
+
+    const IndexEntry *best = NULL;
+    int bestScore = -1;
+    for (int i = 0; i < candidates->count; i++) {
+        const IndexEntry *e = &g_index.entries[candidates->ids[i]];
+        if (e->owner != o) continue;
+
+        int score = matchScore(e, lower, len);
+        if (score < 0) continue;
+        if (!best || score < bestScore ||
+            (score == bestScore && strcmp(e->name, best->name) < 0)) {
+            best = e;
+            bestScore = score;
+        }
+    }
+
+    if (!best) return false;
+
+    snprintf(outFilePath, outLen, "%s", best->filePath);
+    if (outSoundFileId) *outSoundFileId = best->soundFileId;
+    g_index.stats.hits++;
+    return true;
+}
+
+void SoundIndex_GetStats(SoundIndexStats *out) {
+    *out = g_index.stats;
+
+    size_t bytes = g_index.entryCap * sizeof(IndexEntry) +
+                   g_index.freeIds.cap * sizeof(int);
+    for (int i = 0; i < g_index.entryCount; i++) {
+        if (g_index.entries[i].filePath) {
+            bytes += strlen(g_index.entries[i].filePath) + 1;
+        }
+    }
+    for (int i = 0; i < INDEX_OWNER_BUCKETS; i++) {
+        for (IndexOwner *o = g_index.owners[i]; o; o = o->next) {
+            bytes += sizeof(*o) + o->entries.cap * sizeof(int);
+        }
+    }
+    for (int i = 0; i < INDEX_TRIGRAM_BUCKETS; i++) {
+        for (Posting *p = g_index.postings[i]; p; p = p->next) {
+            bytes += sizeof(*p) + p->ids.cap * sizeof(int);
+        }
+    }
+    out->bytes = bytes;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file sound_index.h
+ * @brief In-memory trigram index for fuzzy sound name search
+ *
+ * Quick commands that are not an exact alias fall back to a fuzzy search
+ * over the player's own aliases and then over every public sound name.
+ * Doing that in SQL meant LIKE scans over a four-way join on each miss.
+ *
+ * Names are kept per owner (player GUID, or "" for the public library) and
+ * lowercased. Queries of three or more characters only look at names that
+ * contain the query's rarest trigram; shorter ones scan the owner's names.
+ *
+ * Ranking: exact name, then prefix, then a match at the start of a later
+ * word ("boom" finds "big_boom"); ties go to the shorter name.
+ *
+ * db_manager loads the index and keeps it current. Like the rest of
+ * db_manager, this module is not re-entrant; callers run under the worker
+ * pool's service lock.
+ */
+
+#ifndef SOUND_INDEX_H
+#define SOUND_INDEX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Limits
+ */
+#define SOUND_INDEX_NAME_LEN        64
+#define SOUND_INDEX_RECHECK_SEC     60      /* Min age before a miss reloads an owner */
+
+/*
+ * Index statistics
+ */
+typedef struct {
+    uint64_t lookups;
+    uint64_t hits;
+    uint64_t reloads;                       /* SoundIndex_BeginOwner() calls */
+    int      entries;
+    int      owners;
+    int      trigrams;
+    size_t   bytes;
+} SoundIndexStats;
+
+/**
+ * Drop all names and owners.
+ */
+void SoundIndex_Clear(void);
+
+/**
+ * Start (re)loading an owner: drops its names and marks it fresh.
+ * @param owner Player GUID, or "" for public sounds
+ */
+void SoundIndex_BeginOwner(const char *owner);
+
+/**
+ * Add a name.
+ * @param owner Player GUID, or "" for public sounds
+ * @param name Alias or original name (matched case-insensitively)
+ * @param filePath File to play
+ * @param soundFileId sound_files.id
+ * @return false if out of memory or the name is empty / too long
+ */
+bool SoundIndex_Add(const char *owner, const char *name, const char *filePath,
+                    int soundFileId);
+
+/**
+ * Rename every entry of an owner called oldName.
+ */
+void SoundIndex_Rename(const char *owner, const char *oldName, const char *newName);
+
+/**
+ * Remove every entry of an owner called name.
+ */
+void SoundIndex_Remove(const char *owner, const char *name);
+
+/**
+ * Remove every entry of an owner that plays a sound file.
+ */
+void SoundIndex_RemoveFile(const char *owner, int soundFileId);
+
+/**
+ * Mark an owner stale so the next search reloads it.
+ */
+void SoundIndex_Invalidate(const char *owner);
+
+/**
+ * Seconds since an owner was loaded.
+ * @return Age, or -1 if never loaded or invalidated
+ */
+int SoundIndex_OwnerAge(const char *owner);
+
+/**
+ * Find the best match for a query.
+ * @param owner Player GUID, or "" for public sounds
+ * @param query Name typed by the player
+ * @param outFilePath Receives the file path
+ * @param outLen Size of outFilePath
+ * @param outSoundFileId Receives sound_files.id (may be NULL)
+ * @return true if found
+ */
+bool SoundIndex_Find(const char *owner, const char *query, char *outFilePath,
+                     int outLen, int *outSoundFileId);
+
+/**
+ * Copy current statistics.
+ */
+void SoundIndex_GetStats(SoundIndexStats *out);
+
+#endif /* SOUND_INDEX_H */
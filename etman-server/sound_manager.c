@@ -5,6 +5,10 @@
 
 #include "sound_manager.h"
 #include "db_manager.h"
+#include "opus_cache.h"
+#include "sound_mixer.h"
+#include "sound_download.h"
+#include "resampler.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -16,20 +20,12 @@
 #include <time.h>
 #include <uuid/uuid.h>
 
-#ifdef _WIN32
-    #include <winsock2.h>
-    #include <windows.h>
-    #include <direct.h>
-    #define mkdir(path, mode) _mkdir(path)
-    #define PATH_SEP '\\'
-#else
-    #include <unistd.h>
-    #include <sys/wait.h>
-    #include <sys/socket.h>
-    #include <netinet/in.h>
-    #include <arpa/inet.h>
-    #define PATH_SEP '/'
-#endif
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define PATH_SEP '/'
 
 /* Include minimp3 for MP3 decoding */
 #define MINIMP3_IMPLEMENTATION
@@ -43,11 +39,6 @@
  */
 #define SOUNDS_DIR_NAME     "sounds"
 #define PENDING_DIR_NAME    "pending_shares"
-#define OPUS_SAMPLE_RATE    48000
-#define OPUS_CHANNELS       1
-#define OPUS_FRAME_MS       20
-#define OPUS_FRAME_SIZE     (OPUS_SAMPLE_RATE * OPUS_FRAME_MS / 1000)  /* 960 */
-#define OPUS_BITRATE        64000  /* 64kbps for much better music quality */
 #define MAX_PENDING_DOWNLOADS   4
 #define MAX_PENDING_SHARES      64
 
@@ -75,13 +66,6 @@ static struct {
     bool            initialized;
     char            baseDir[256];
 
-    /* Active playback */
-    SoundPlayback   playback;
-
-    /* Pending downloads */
-    DownloadRequest downloads[MAX_PENDING_DOWNLOADS];
-    int             numDownloads;
-
     /* Pending shares */
     PendingShare    shares[MAX_PENDING_SHARES];
     int             numShares;
@@ -126,8 +110,12 @@ static void updateCooldown(const char *guid);
 static bool checkPlayRateLimit(const char *guid, int *outCooldownRemaining);
 static bool updatePlayRateLimit(const char *guid);
 static bool decodeMP3(const char *filepath, int16_t **outPcm, int *outSamples);
-static bool SoundMgr_PlaySoundByPath(uint32_t clientId, const char *guid,
-                                     const char *name, const char *filepath);
+static bool SoundMgr_PlaySoundByPath(uint32_t clientId, const char *name,
+                                     const char *filepath, int priority);
+static bool startPlayback(uint32_t clientId, const char *name,
+                          const char *filepath, int priority);
+static bool loadPlaybackSource(const char *filepath, MixerSource *out);
+static void releasePlaybackSource(MixerSource *src);
 extern void sendResponseToClient(uint32_t clientId, uint8_t respType,
                                  const char *message);
 extern void updateClientAddress(uint32_t clientId, struct sockaddr_in *addr);
@@ -137,8 +125,6 @@ extern void sendBinaryToClient(uint32_t clientId, uint8_t respType,
 /* For quick command responses to qagame (not voice clients) */
 extern void setQagameQuickAddress(struct sockaddr_in *addr);
 extern void sendBinaryToQagame(uint8_t respType, const uint8_t *data, int dataLen);
-extern void broadcastOpusPacket(uint8_t fromClient, uint8_t channel,
-                                uint32_t sequence, const uint8_t *opus, int opusLen);
 extern void resetSoundPlaybackTiming(void);
 
 /*
@@ -256,20 +242,20 @@ bool SoundMgr_Init(const char *baseDir) {
     /* Initialize MP3 decoder */
     mp3dec_init(&g_soundMgr.mp3Decoder);
 
-    /* Create Opus encoder for playback */
-    int opusErr;
-    g_soundMgr.playback.opusEncoder = opus_encoder_create(
-        OPUS_SAMPLE_RATE, OPUS_CHANNELS, OPUS_APPLICATION_AUDIO, &opusErr);
-    if (opusErr != OPUS_OK) {
-        fprintf(stderr, "SoundMgr: Failed to create Opus encoder: %s\n",
-                opus_strerror(opusErr));
+    /* Create the playback mixer (one Opus encoder per audience) */
+    if (!SoundMixer_Init()) {
         return false;
     }
 
-    opus_encoder_ctl((OpusEncoder*)g_soundMgr.playback.opusEncoder,
-                     OPUS_SET_BITRATE(OPUS_BITRATE));
-    opus_encoder_ctl((OpusEncoder*)g_soundMgr.playback.opusEncoder,
-                     OPUS_SET_COMPLEXITY(5));
+    /* Pre-encoded packet cache (non-fatal - playback falls back to encoding) */
+    if (!OpusCache_Init(g_soundMgr.baseDir, OPUS_BITRATE)) {
+        fprintf(stderr, "SoundMgr: Opus cache disabled\n");
+    }
+
+    /* URL download worker (non-fatal - only /etman add needs it) */
+    if (!SoundDownload_Init()) {
+        fprintf(stderr, "SoundMgr: URL downloads disabled\n");
+    }
 
     g_soundMgr.initialized = true;
     printf("SoundMgr: Initialized, storage at %s\n", g_soundMgr.baseDir);
@@ -302,11 +288,9 @@ void SoundMgr_Shutdown(void) {
     }
 
     SoundMgr_StopSound();
-
-    if (g_soundMgr.playback.opusEncoder) {
-        opus_encoder_destroy((OpusEncoder*)g_soundMgr.playback.opusEncoder);
-        g_soundMgr.playback.opusEncoder = NULL;
-    }
+    SoundDownload_Shutdown();
+    SoundMixer_Shutdown();
+    OpusCache_Shutdown();
 
     /* Shutdown database connection */
     if (g_soundMgr.dbMode) {
@@ -325,62 +309,29 @@ void SoundMgr_Frame(void) {
         return;
     }
 
-    /* Check download worker processes */
-#ifndef _WIN32
-    for (int i = 0; i < g_soundMgr.numDownloads; i++) {
-        DownloadRequest *dl = &g_soundMgr.downloads[i];
-        if (dl->state == DOWNLOAD_IN_PROGRESS && dl->workerPid > 0) {
-            int status;
-            pid_t result = waitpid(dl->workerPid, &status, WNOHANG);
-            if (result > 0) {
-                /* Worker finished */
-                if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
-                    dl->state = DOWNLOAD_COMPLETE;
-                    sendResponseToClient(dl->clientId, VOICE_RESP_SUCCESS,
-                        "Sound downloaded successfully!");
-                    printf("SoundMgr: Download complete for %s/%s\n",
-                           dl->guid, dl->name);
-                } else {
-                    dl->state = DOWNLOAD_FAILED;
-                    /* Read error message from error file if it exists */
-                    char errMsg[256] = "Download failed";
-                    if (dl->errorMsg[0]) {
-                        FILE *errFile = fopen(dl->errorMsg, "r");
-                        if (errFile) {
-                            if (fgets(errMsg, sizeof(errMsg), errFile)) {
-                                /* Remove newline if present */
-                                char *nl = strchr(errMsg, '\n');
-                                if (nl) *nl = '\0';
-                            }
-                            fclose(errFile);
-                            remove(dl->errorMsg);  /* Clean up error file */
-                        }
-                    }
-                    sendResponseToClient(dl->clientId, VOICE_RESP_ERROR, errMsg);
-                    printf("SoundMgr: Download failed for %s/%s: %s\n",
-                           dl->guid, dl->name, errMsg);
-                }
-                dl->workerPid = 0;
-
-                /* Remove from queue */
-                memmove(&g_soundMgr.downloads[i],
-                        &g_soundMgr.downloads[i + 1],
-                        (g_soundMgr.numDownloads - i - 1) * sizeof(DownloadRequest));
-                g_soundMgr.numDownloads--;
-                i--;
-            } else if (result == 0) {
-                /* Still running - check timeout */
-                if (time(NULL) - dl->startTime > SOUND_DOWNLOAD_TIMEOUT) {
-                    kill(dl->workerPid, SIGTERM);
-                    dl->state = DOWNLOAD_FAILED;
-                    snprintf(dl->errorMsg, sizeof(dl->errorMsg), "Download timed out");
-                    sendResponseToClient(dl->clientId, VOICE_RESP_ERROR,
-                        "Download timed out (2 min limit)");
-                }
+    /* Publish finished downloads */
+    SoundDownloadResult result;
+    while (SoundDownload_Poll(&result)) {
+        DownloadRequest *dl = &result.request;
+        if (dl->state == DOWNLOAD_COMPLETE) {
+            /* The content key needs the whole file, so it is set last */
+            uint64_t key;
+            if (result.builder && OpusCache_KeyForFile(result.filepath, &key)) {
+                OpusCache_SetBuildKey(result.builder, key);
+                OpusCache_FinishBuild(result.builder, false);
+            } else {
+                OpusCache_AbortBuild(result.builder);
             }
+            sendResponseToClient(dl->clientId, VOICE_RESP_SUCCESS,
+                "Sound downloaded successfully!");
+            printf("SoundMgr: Download complete for %s/%s\n",
+                   dl->guid, dl->name);
+        } else {
+            sendResponseToClient(dl->clientId, VOICE_RESP_ERROR, dl->errorMsg);
+            printf("SoundMgr: Download failed for %s/%s: %s\n",
+                   dl->guid, dl->name, dl->errorMsg);
         }
     }
-#endif
 
     /* Clean up expired share requests (5 minute timeout) */
     time_t now = time(NULL);
@@ -559,11 +510,12 @@ void SoundMgr_HandlePacket(uint32_t clientId, struct sockaddr_in *clientAddr,
                 return;
             }
 
-            /* Interrupt mode: if a sound is playing, stop it and play the new one */
-            if (g_soundMgr.playback.state == PLAYBACK_PLAYING ||
-                g_soundMgr.playback.state == PLAYBACK_LOADING) {
-                printf("SoundMgr: Interrupting current sound to play '%s'\n", name);
-                SoundMgr_StopSound();
+            /* Sounds are mixed; only refuse when every voice is busy with
+             * something more important (own previous sound is replaced) */
+            if (!SoundMixer_CanStart(clientId, MIXER_PRIORITY_PLAYER)) {
+                sendResponseToClient(clientId, VOICE_RESP_ERROR,
+                    "Too many sounds playing. Wait or use /etman stopsnd");
+                return;
             }
 
             if (!SoundMgr_PlaySound(clientId, guid, name)) {
@@ -655,9 +607,10 @@ void SoundMgr_HandlePacket(uint32_t clientId, struct sockaddr_in *clientAddr,
         }
 
         case VOICE_CMD_SOUND_STOP: {
-            /* Check state directly - don't use IsPlaying() which has extra conditions */
-            if (g_soundMgr.playback.state == PLAYBACK_PLAYING ||
-                g_soundMgr.playback.state == PLAYBACK_LOADING) {
+            /* Stop the requester's own sound, or everything if they have none */
+            if (SoundMixer_StopClient(clientId)) {
+                sendResponseToClient(clientId, VOICE_RESP_SUCCESS, "Sound stopped");
+            } else if (SoundMixer_IsActive()) {
                 SoundMgr_StopSound();
                 sendResponseToClient(clientId, VOICE_RESP_SUCCESS, "Sound stopped");
             } else {
@@ -1095,16 +1048,11 @@ void SoundMgr_HandlePacket(uint32_t clientId, struct sockaddr_in *clientAddr,
                 }
             }
 
-            /* Check playback state */
-            if (g_soundMgr.playback.state == PLAYBACK_PLAYING ||
-                g_soundMgr.playback.state == PLAYBACK_LOADING) {
-                if (g_soundMgr.playback.pcmPosition >= g_soundMgr.playback.pcmSamples) {
-                    SoundMgr_StopSound();
-                } else {
-                    sendResponseToClient(clientId, VOICE_RESP_ERROR,
-                        "A sound is already playing. Wait or use /etman stopsnd");
-                    return;
-                }
+            /* Check for a free voice */
+            if (!SoundMixer_CanStart(clientId, MIXER_PRIORITY_PLAYER)) {
+                sendResponseToClient(clientId, VOICE_RESP_ERROR,
+                    "Too many sounds playing. Wait or use /etman stopsnd");
+                return;
             }
 
             /* Get sound at position - try user's playlist first, then public */
@@ -1142,7 +1090,8 @@ void SoundMgr_HandlePacket(uint32_t clientId, struct sockaddr_in *clientAddr,
             }
 
             /* Play the sound using the file path from DB */
-            if (!SoundMgr_PlaySoundByPath(clientId, guid, item.alias, item.filePath)) {
+            if (!SoundMgr_PlaySoundByPath(clientId, item.alias, item.filePath,
+                                          MIXER_PRIORITY_PLAYER)) {
                 sendResponseToClient(clientId, VOICE_RESP_ERROR,
                     "Failed to play sound from playlist");
                 return;
@@ -1532,7 +1481,8 @@ void SoundMgr_HandlePacket(uint32_t clientId, struct sockaddr_in *clientAddr,
                 }
 
                 /* Play the sound using the file path from the item */
-                if (!SoundMgr_PlaySoundByPath(clientId, NULL, item.alias, item.filePath)) {
+                if (!SoundMgr_PlaySoundByPath(clientId, item.alias, item.filePath,
+                                              MIXER_PRIORITY_PLAYER)) {
                     sendResponseToClient(clientId, VOICE_RESP_ERROR, "Failed to play sound");
                     return;
                 }
@@ -1649,7 +1599,8 @@ void SoundMgr_HandlePacket(uint32_t clientId, struct sockaddr_in *clientAddr,
             }
 
             /* Play the sound file using existing function */
-            if (SoundMgr_PlaySoundByPath(clientId, guid, "menu", filePath)) {
+            if (SoundMgr_PlaySoundByPath(clientId, "menu", filePath,
+                                         MIXER_PRIORITY_PLAYER)) {
                 char msg[128];
                 snprintf(msg, sizeof(msg), "Playing menu %d item %d", menuPos, itemPos);
                 sendResponseToClient(clientId, VOICE_RESP_SUCCESS, msg);
@@ -1784,7 +1735,8 @@ void SoundMgr_HandlePacket(uint32_t clientId, struct sockaddr_in *clientAddr,
 
             printf("[PLAYID] Playing sound #%d (%s) for client %u\n", soundId, soundName, clientId);
 
-            if (SoundMgr_PlaySoundByPath(clientId, guid, soundName, filePath)) {
+            if (SoundMgr_PlaySoundByPath(clientId, soundName, filePath,
+                                         MIXER_PRIORITY_PLAYER)) {
                 char msg[128];
                 snprintf(msg, sizeof(msg), "Playing #%d: %s", soundId, soundName);
                 sendResponseToClient(clientId, VOICE_RESP_SUCCESS, msg);
@@ -1905,7 +1857,8 @@ void SoundMgr_HandlePacket(uint32_t clientId, struct sockaddr_in *clientAddr,
             /* Step 7: Send response */
             if (hasResult) {
                 /* Play the sound */
-                SoundMgr_PlaySoundByPath(slot, guid, alias, filePath);
+                SoundMgr_PlaySoundByPath(slot, alias, filePath,
+                                         MIXER_PRIORITY_QUICK);
 
                 /* Build QUICK_FOUND response: <slot><soundFileId:4><chatTextLen><chatText> */
                 uint8_t resp[256];
@@ -2135,7 +2088,7 @@ bool SoundMgr_QueueDownload(uint32_t clientId, const char *guid,
     }
 
     /* Check if download queue is full */
-    if (g_soundMgr.numDownloads >= MAX_PENDING_DOWNLOADS) {
+    if (SoundDownload_NumPending() >= SOUND_DOWNLOAD_QUEUE_SIZE) {
         return false;
     }
 
@@ -2157,109 +2110,20 @@ bool SoundMgr_QueueDownload(uint32_t clientId, const char *guid,
         return false;
     }
 
-    /* Create download request */
-    DownloadRequest *dl = &g_soundMgr.downloads[g_soundMgr.numDownloads];
-    memset(dl, 0, sizeof(*dl));
-    dl->state = DOWNLOAD_PENDING;
-    dl->clientId = clientId;
-    strncpy(dl->guid, guid, SOUND_GUID_LEN);
-    strncpy(dl->name, name, SOUND_MAX_NAME_LEN);
-    strncpy(dl->url, url, sizeof(dl->url) - 1);
-    dl->startTime = time(NULL);
-
-    g_soundMgr.numDownloads++;
-    updateCooldown(guid);
+    /* Hand it to the download worker */
+    DownloadRequest dl;
+    memset(&dl, 0, sizeof(dl));
+    dl.state = DOWNLOAD_PENDING;
+    dl.clientId = clientId;
+    strncpy(dl.guid, guid, SOUND_GUID_LEN);
+    strncpy(dl.name, name, SOUND_MAX_NAME_LEN);
+    strncpy(dl.url, url, sizeof(dl.url) - 1);
+    dl.startTime = time(NULL);
 
-    /* Fork worker process to handle download */
-#ifndef _WIN32
-    /* Create error file path for child to write error messages */
-    char errorFile[1024];
-    snprintf(errorFile, sizeof(errorFile), "%s.error", filepath);
-
-    pid_t pid = fork();
-    if (pid == 0) {
-        /* Child process - do the download */
-        /* Use curl to download, capture stderr for error details */
-        char curlErr[512];
-        snprintf(curlErr, sizeof(curlErr), "%s.curlerr", filepath);
-
-        char cmd[2048];
-        snprintf(cmd, sizeof(cmd),
-            "curl -fsSL --max-filesize %d --max-time %d -o \"%s\" \"%s\" 2>\"%s\"",
-            SOUND_MAX_FILESIZE, SOUND_DOWNLOAD_TIMEOUT, filepath, url, curlErr);
-        int result = system(cmd);
-        int curlExit = WEXITSTATUS(result);
-
-        /* Write specific error message based on curl exit code */
-        if (curlExit != 0) {
-            FILE *errFile = fopen(errorFile, "w");
-            if (errFile) {
-                switch (curlExit) {
-                    case 22: fprintf(errFile, "URL not found (404) or server error"); break;
-                    case 28: fprintf(errFile, "Download timed out (2 min limit)"); break;
-                    case 63: fprintf(errFile, "File too large (max 2MB)"); break;
-                    case 6:  fprintf(errFile, "Could not resolve host"); break;
-                    case 7:  fprintf(errFile, "Could not connect to server"); break;
-                    case 35: fprintf(errFile, "SSL/TLS connection error"); break;
-                    case 56: fprintf(errFile, "Network error during download"); break;
-                    default: fprintf(errFile, "Download failed (curl error %d)", curlExit); break;
-                }
-                fclose(errFile);
-            }
-            remove(curlErr);
-            _exit(curlExit);
-        }
-
-        remove(curlErr);
-
-        /* Validate downloaded file is MP3 */
-        FILE *f = fopen(filepath, "rb");
-        if (f) {
-            uint8_t header[3];
-            if (fread(header, 1, 3, f) == 3) {
-                /* Check MP3 magic bytes (ID3 or sync word) */
-                bool isMP3 = (header[0] == 'I' && header[1] == 'D' && header[2] == '3') ||
-                             (header[0] == 0xFF && (header[1] & 0xE0) == 0xE0);
-                if (!isMP3) {
-                    fclose(f);
-                    remove(filepath);
-                    FILE *errFile = fopen(errorFile, "w");
-                    if (errFile) {
-                        fprintf(errFile, "Not a valid MP3 file");
-                        fclose(errFile);
-                    }
-                    _exit(100);
-                }
-            }
-            fclose(f);
-        }
-
-        _exit(0);
-    } else if (pid > 0) {
-        dl->workerPid = pid;
-        dl->state = DOWNLOAD_IN_PROGRESS;
-        /* Store error file path for later reading */
-        snprintf(dl->errorMsg, sizeof(dl->errorMsg), "%s", errorFile);
-    } else {
-        /* Fork failed */
-        g_soundMgr.numDownloads--;
-        return false;
-    }
-#else
-    /* Windows: synchronous download (TODO: thread) */
-    char cmd[2048];
-    snprintf(cmd, sizeof(cmd),
-        "curl -fsSL --max-filesize %d --max-time %d -o \"%s\" \"%s\"",
-        SOUND_MAX_FILESIZE, SOUND_DOWNLOAD_TIMEOUT, filepath, url);
-    int result = system(cmd);
-    if (result == 0) {
-        dl->state = DOWNLOAD_COMPLETE;
-    } else {
-        dl->state = DOWNLOAD_FAILED;
-        g_soundMgr.numDownloads--;
+    if (!SoundDownload_Queue(&dl, filepath)) {
         return false;
     }
-#endif
+    updateCooldown(guid);
 
     printf("SoundMgr: Queued download for %s/%s from %s\n", guid, name, url);
     return true;
@@ -2269,12 +2133,6 @@ bool SoundMgr_QueueDownload(uint32_t clientId, const char *guid,
  * Play a sound
  */
 bool SoundMgr_PlaySound(uint32_t clientId, const char *guid, const char *name) {
-    /* State check is now done by caller - but double-check anyway */
-    if (g_soundMgr.playback.state == PLAYBACK_PLAYING) {
-        printf("SoundMgr: PlaySound called while state=PLAYING (should not happen)\n");
-        return false;
-    }
-
     char filepath[1024];
 
     /* In database mode, lookup file_path from database (handles shared sounds) */
@@ -2320,63 +2178,15 @@ bool SoundMgr_PlaySound(uint32_t clientId, const char *guid, const char *name) {
 
     printf("SoundMgr: PlaySound file exists, size=%ld\n", (long)st.st_size);
 
-    /* Decode MP3 to PCM */
-    int16_t *pcmData = NULL;
-    int pcmSamples = 0;
-    if (!decodeMP3(filepath, &pcmData, &pcmSamples)) {
-        printf("SoundMgr: PlaySound failed - decodeMP3 failed\n");
-        return false;
-    }
-
-    /* Check duration limit */
-    int durationSec = pcmSamples / OPUS_SAMPLE_RATE;
-    if (durationSec > SOUND_MAX_DURATION_SEC) {
-        /* Truncate to max duration */
-        pcmSamples = SOUND_MAX_DURATION_SEC * OPUS_SAMPLE_RATE;
-        printf("SoundMgr: Truncated sound to %d seconds\n", SOUND_MAX_DURATION_SEC);
-    }
-
-    /* Setup playback */
-    if (g_soundMgr.playback.pcmBuffer) {
-        free(g_soundMgr.playback.pcmBuffer);
-        g_soundMgr.playback.pcmBuffer = NULL;
-    }
-
-    /* Reset Opus encoder state to avoid garbled audio at start of new sounds.
-     * The encoder carries state from previous encoding which corrupts the
-     * first few frames of a new stream. */
-    if (g_soundMgr.playback.opusEncoder) {
-        opus_encoder_ctl((OpusEncoder*)g_soundMgr.playback.opusEncoder, OPUS_RESET_STATE);
-    }
-
-    /* Reset playback timing so sequence starts at 0 */
-    resetSoundPlaybackTiming();
-
-    g_soundMgr.playback.pcmBuffer = pcmData;
-    g_soundMgr.playback.pcmSamples = pcmSamples;
-    g_soundMgr.playback.pcmPosition = 0;
-    g_soundMgr.playback.clientId = clientId;
-    g_soundMgr.playback.sequence = 0;
-    g_soundMgr.playback.state = PLAYBACK_PLAYING;
-    strncpy(g_soundMgr.playback.guid, guid, SOUND_GUID_LEN);
-    strncpy(g_soundMgr.playback.name, name, SOUND_MAX_NAME_LEN);
-
-    printf("SoundMgr: Playing %s/%s (%d samples, %.1f sec)\n",
-           guid, name, pcmSamples, (float)pcmSamples / OPUS_SAMPLE_RATE);
-
-    return true;
+    printf("SoundMgr: Playing %s/%s\n", guid, name);
+    return startPlayback(clientId, name, filepath, MIXER_PRIORITY_PLAYER);
 }
 
 /*
  * Play sound by direct file path (for DB mode)
  */
-static bool SoundMgr_PlaySoundByPath(uint32_t clientId, const char *guid,
-                                     const char *name, const char *filepath) {
-    /* If already playing, stop current sound and start new one */
-    if (g_soundMgr.playback.state == PLAYBACK_PLAYING) {
-        SoundMgr_StopSound();
-    }
-
+static bool SoundMgr_PlaySoundByPath(uint32_t clientId, const char *name,
+                                     const char *filepath, int priority) {
     /* Build full path from base directory + relative filepath */
     char fullPath[1024];
     snprintf(fullPath, sizeof(fullPath), "%s%c%s",
@@ -2388,137 +2198,28 @@ static bool SoundMgr_PlaySoundByPath(uint32_t clientId, const char *guid,
         return false;
     }
 
-    /* Decode MP3 to PCM */
-    int16_t *pcmData = NULL;
-    int pcmSamples = 0;
-    if (!decodeMP3(fullPath, &pcmData, &pcmSamples)) {
-        return false;
-    }
-
-    /* Check duration limit */
-    int durationSec = pcmSamples / OPUS_SAMPLE_RATE;
-    if (durationSec > SOUND_MAX_DURATION_SEC) {
-        pcmSamples = SOUND_MAX_DURATION_SEC * OPUS_SAMPLE_RATE;
-        printf("SoundMgr: Truncated sound to %d seconds\n", SOUND_MAX_DURATION_SEC);
-    }
-
-    /* Setup playback */
-    if (g_soundMgr.playback.pcmBuffer) {
-        free(g_soundMgr.playback.pcmBuffer);
-        g_soundMgr.playback.pcmBuffer = NULL;
-    }
-
-    /* Reset Opus encoder state to avoid garbled audio at start of new sounds.
-     * The encoder carries state from previous encoding which corrupts the
-     * first few frames of a new stream. */
-    if (g_soundMgr.playback.opusEncoder) {
-        opus_encoder_ctl((OpusEncoder*)g_soundMgr.playback.opusEncoder, OPUS_RESET_STATE);
-    }
-
-    /* Reset playback timing so sequence starts at 0 */
-    resetSoundPlaybackTiming();
-
-    g_soundMgr.playback.pcmBuffer = pcmData;
-    g_soundMgr.playback.pcmSamples = pcmSamples;
-    g_soundMgr.playback.pcmPosition = 0;
-    g_soundMgr.playback.clientId = clientId;
-    g_soundMgr.playback.sequence = 0;
-    g_soundMgr.playback.state = PLAYBACK_PLAYING;
-    if (guid) {
-        strncpy(g_soundMgr.playback.guid, guid, SOUND_GUID_LEN);
-    } else {
-        g_soundMgr.playback.guid[0] = '\0';
-    }
-    strncpy(g_soundMgr.playback.name, name, SOUND_MAX_NAME_LEN);
-
-    printf("SoundMgr: Playing (by path) %s (%d samples, %.1f sec)\n",
-           name, pcmSamples, (float)pcmSamples / OPUS_SAMPLE_RATE);
-
-    return true;
+    return startPlayback(clientId, name, fullPath, priority);
 }
 
 /*
  * Stop playback
  */
 void SoundMgr_StopSound(void) {
-    if (g_soundMgr.playback.pcmBuffer) {
-        free(g_soundMgr.playback.pcmBuffer);
-        g_soundMgr.playback.pcmBuffer = NULL;
-    }
-    g_soundMgr.playback.state = PLAYBACK_IDLE;
-    g_soundMgr.playback.pcmPosition = 0;
+    SoundMixer_StopAll();
 }
 
 /*
  * Check if playing
  */
 bool SoundMgr_IsPlaying(void) {
-    if (g_soundMgr.playback.state != PLAYBACK_PLAYING) {
-        return false;
-    }
-
-    /* If we've reached the end of the samples, mark as idle.
-     * Don't free buffer here - it will be freed when next sound starts
-     * or when StopSound is called. This avoids double-free race conditions. */
-    if (g_soundMgr.playback.pcmPosition >= g_soundMgr.playback.pcmSamples) {
-        g_soundMgr.playback.state = PLAYBACK_IDLE;
-        return false;
-    }
-
-    return true;
+    return SoundMixer_IsActive();
 }
 
 /*
- * Get the client ID of who initiated playback
+ * Mix the next frame of every playing sound
  */
-uint32_t SoundMgr_GetPlaybackClientId(void) {
-    if (g_soundMgr.playback.state == PLAYBACK_PLAYING) {
-        return g_soundMgr.playback.clientId;
-    }
-    return 255;  /* No playback active */
-}
-
-/*
- * Get next Opus packet
- */
-bool SoundMgr_GetNextOpusPacket(uint8_t *outBuffer, int *outLen) {
-    if (!SoundMgr_IsPlaying()) {
-        return false;
-    }
-
-    int remaining = g_soundMgr.playback.pcmSamples - g_soundMgr.playback.pcmPosition;
-    if (remaining <= 0) {
-        g_soundMgr.playback.state = PLAYBACK_IDLE;
-        return false;
-    }
-
-    int16_t frame[OPUS_FRAME_SIZE];
-    int samplesToEncode = (remaining >= OPUS_FRAME_SIZE) ? OPUS_FRAME_SIZE : remaining;
-
-    /* Copy samples, zero-pad if needed */
-    memcpy(frame, g_soundMgr.playback.pcmBuffer + g_soundMgr.playback.pcmPosition,
-           samplesToEncode * sizeof(int16_t));
-    if (samplesToEncode < OPUS_FRAME_SIZE) {
-        memset(frame + samplesToEncode, 0,
-               (OPUS_FRAME_SIZE - samplesToEncode) * sizeof(int16_t));
-    }
-
-    g_soundMgr.playback.pcmPosition += samplesToEncode;
-
-    /* Encode to Opus */
-    int encoded = opus_encode((OpusEncoder*)g_soundMgr.playback.opusEncoder,
-                              frame, OPUS_FRAME_SIZE, outBuffer, 512);
-    if (encoded < 0) {
-        printf("SoundMgr: Opus encode error: %s\n", opus_strerror(encoded));
-        /* Reset state on error so we don't get stuck */
-        g_soundMgr.playback.state = PLAYBACK_IDLE;
-        return false;
-    }
-
-    *outLen = encoded;
-    g_soundMgr.playback.sequence++;
-
-    return true;
+int SoundMgr_MixFrame(MixerPacket *out, int maxOut) {
+    return SoundMixer_MixFrame(out, maxOut);
 }
 
 /*
@@ -2806,6 +2507,33 @@ static int16_t* resampleLinear(const int16_t *src, int srcSamples, int srcRate,
     return dst;
 }
 
+/*
+ * Helper: Resample PCM to 48kHz with the polyphase filter.
+ * Falls back to linear interpolation for ratios the filter can't handle.
+ * Returns newly allocated buffer (caller must free) and output sample count
+ */
+static int16_t* resampleTo48k(const int16_t *src, int srcSamples, int srcRate,
+                              int *outSamples) {
+    Resampler *rs = Resampler_Create(srcRate, OPUS_SAMPLE_RATE);
+    if (!rs) {
+        return resampleLinear(src, srcSamples, srcRate, OPUS_SAMPLE_RATE, outSamples);
+    }
+
+    int cap = Resampler_MaxOutput(rs, srcSamples + RESAMPLER_TAPS_PER_PHASE);
+    int16_t *dst = (int16_t*)malloc(cap * sizeof(int16_t));
+    if (!dst) {
+        Resampler_Destroy(rs);
+        return NULL;
+    }
+
+    int count = Resampler_Process(rs, src, srcSamples, dst, cap);
+    count += Resampler_Flush(rs, dst + count, cap - count);
+    Resampler_Destroy(rs);
+
+    *outSamples = count;
+    return dst;
+}
+
 /*
  * Helper: Decode MP3 to PCM (48kHz mono)
  * Handles any input sample rate by resampling to 48kHz
@@ -2968,7 +2696,7 @@ static bool decodeWAV(const char *filepath, int16_t **outPcm, int *outSamples) {
 
     if ((int)sampleRate != OPUS_SAMPLE_RATE) {
         printf("SoundMgr: WAV - Resampling from %d Hz to %d Hz\n", sampleRate, OPUS_SAMPLE_RATE);
-        finalBuffer = resampleLinear(monoData, monoSamples, sampleRate, OPUS_SAMPLE_RATE, &finalSamples);
+        finalBuffer = resampleTo48k(monoData, monoSamples, sampleRate, &finalSamples);
         free(monoData);
         if (!finalBuffer) {
             return false;
@@ -3093,8 +2821,8 @@ static bool decodeMP3(const char *filepath, int16_t **outPcm, int *outSamples) {
         printf("SoundMgr: Resampling from %d Hz to %d Hz (%d samples)\n",
                detectedRate, OPUS_SAMPLE_RATE, nativeSamples);
 
-        finalBuffer = resampleLinear(nativeBuffer, nativeSamples, detectedRate,
-                                     OPUS_SAMPLE_RATE, &finalSamples);
+        finalBuffer = resampleTo48k(nativeBuffer, nativeSamples, detectedRate,
+                                    &finalSamples);
         free(nativeBuffer);
 
         if (!finalBuffer) {
@@ -3123,6 +2851,100 @@ static bool decodeMP3(const char *filepath, int16_t **outPcm, int *outSamples) {
     return true;
 }
 
+/*
+ * Helper: Free a source that never made it into the mixer
+ */
+static void releasePlaybackSource(MixerSource *src) {
+    if (src->pcm) {
+        free(src->pcm);
+        src->pcm = NULL;
+    }
+    if (src->clip) {
+        OpusCache_Release(src->clip);
+        src->clip = NULL;
+    }
+    if (src->builder) {
+        OpusCache_AbortBuild(src->builder);
+        src->builder = NULL;
+    }
+}
+
+/*
+ * Helper: Load a sound file for the mixer.
+ * Uses pre-encoded packets on a cache hit. On a miss the file is decoded
+ * to PCM and the packets are recorded while it plays.
+ */
+static bool loadPlaybackSource(const char *filepath, MixerSource *out) {
+    uint64_t key = 0;
+    bool haveKey = OpusCache_KeyForFile(filepath, &key);
+
+    memset(out, 0, sizeof(*out));
+
+    if (haveKey) {
+        OpusClip *clip = OpusCache_Acquire(key);
+        if (clip) {
+            out->clip = clip;
+            printf("SoundMgr: Opus cache hit %016llx (%d packets)\n",
+                   (unsigned long long)key, clip->numPackets);
+            return true;
+        }
+    }
+
+    /* Decode MP3 to PCM */
+    int16_t *pcmData = NULL;
+    int pcmSamples = 0;
+    if (!decodeMP3(filepath, &pcmData, &pcmSamples)) {
+        return false;
+    }
+
+    /* Check duration limit */
+    if (pcmSamples > SOUND_MAX_DURATION_SEC * OPUS_SAMPLE_RATE) {
+        pcmSamples = SOUND_MAX_DURATION_SEC * OPUS_SAMPLE_RATE;
+        printf("SoundMgr: Truncated sound to %d seconds\n", SOUND_MAX_DURATION_SEC);
+    }
+
+    out->pcm = pcmData;
+    out->pcmSamples = pcmSamples;
+    if (haveKey) {
+        out->builder = OpusCache_BeginBuild(key);
+    }
+    return true;
+}
+
+/*
+ * Helper: Load a file and hand it to the mixer as a new voice
+ */
+static bool startPlayback(uint32_t clientId, const char *name,
+                          const char *filepath, int priority) {
+    /* Don't decode anything the mixer would refuse */
+    if (!SoundMixer_CanStart(clientId, priority)) {
+        printf("SoundMgr: No free voice for '%s' (client %u)\n", name, clientId);
+        return false;
+    }
+
+    MixerSource src;
+    if (!loadPlaybackSource(filepath, &src)) {
+        printf("SoundMgr: Failed to load %s\n", filepath);
+        return false;
+    }
+
+    int samples = src.clip ? src.clip->numPackets * OPUS_FRAME_SIZE : src.pcmSamples;
+    bool wasIdle = !SoundMixer_IsActive();
+
+    if (!SoundMixer_StartVoice(clientId, name, MIXER_BUS_ALL, priority, &src)) {
+        releasePlaybackSource(&src);
+        return false;
+    }
+
+    /* Restart packet pacing when the first voice begins */
+    if (wasIdle) {
+        resetSoundPlaybackTiming();
+    }
+
+    printf("SoundMgr: Voice started for client %u: %s (%d samples, %.1f sec)\n",
+           clientId, name, samples, (float)samples / OPUS_SAMPLE_RATE);
+    return true;
+}
 
 /*
  * Database mode functions (Phase 2)
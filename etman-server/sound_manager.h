@@ -5,7 +5,7 @@
  * Manages custom sounds stored per-player UUID. Supports:
  * - Sound file CRUD operations (add, list, delete, rename)
  * - URL download with validation
- * - MP3 decoding and Opus encoding for playback
+ * - MP3 decoding and mixed Opus playback (see sound_mixer.h)
  * - Sound sharing between players
  */
 
@@ -18,11 +18,9 @@
 #include <time.h>
 #include <sys/types.h>
 
-#ifdef _WIN32
-    #include <winsock2.h>
-#else
-    #include <netinet/in.h>
-#endif
+#include <netinet/in.h>
+
+#include "sound_mixer.h"
 
 /*
  * Sound Command Packet Types (client -> server)
@@ -106,16 +104,6 @@
 #define SOUND_PLAY_BURST_LIMIT  5           /* Max sounds in burst before cooldown */
 #define SOUND_PLAY_COOLDOWN_SEC 5           /* Cooldown after burst limit reached */
 
-/*
- * Sound playback state
- */
-typedef enum {
-    PLAYBACK_IDLE = 0,
-    PLAYBACK_LOADING,
-    PLAYBACK_PLAYING,
-    PLAYBACK_ERROR
-} SoundPlaybackState;
-
 /*
  * Download request state
  */
@@ -139,7 +127,6 @@ typedef struct {
     time_t        startTime;
     char          errorMsg[128];
     int           progress;         /* 0-100 */
-    pid_t         workerPid;        /* Worker process PID */
 } DownloadRequest;
 
 /*
@@ -164,26 +151,6 @@ typedef struct {
     uint32_t toClientId;
 } PendingShare;
 
-/*
- * Sound playback context (for streaming to clients)
- */
-typedef struct {
-    SoundPlaybackState state;
-    char    guid[SOUND_GUID_LEN + 1];
-    char    name[SOUND_MAX_NAME_LEN + 1];
-    uint32_t clientId;              /* Who initiated playback */
-
-    /* Decoded PCM audio (48kHz mono) */
-    int16_t *pcmBuffer;
-    int      pcmSamples;
-    int      pcmPosition;
-
-    /* Opus encoding state */
-    void    *opusEncoder;
-    uint32_t sequence;
-} SoundPlayback;
-
-
 /*
  * API Functions
  */
@@ -264,6 +231,8 @@ bool SoundMgr_QueueDownload(uint32_t clientId, const char *guid,
 
 /**
  * Play a sound to all connected clients.
+ * Mixed with any other sounds already playing; replaces this client's
+ * previous sound if it is still running.
  * @param clientId Client slot ID that initiated playback
  * @param guid Player GUID (sound owner)
  * @param name Sound name
@@ -272,29 +241,24 @@ bool SoundMgr_QueueDownload(uint32_t clientId, const char *guid,
 bool SoundMgr_PlaySound(uint32_t clientId, const char *guid, const char *name);
 
 /**
- * Stop the currently playing sound.
+ * Stop all playing sounds.
  */
 void SoundMgr_StopSound(void);
 
 /**
- * Check if a sound is currently playing.
+ * Check if any sound is currently playing.
  * @return true if playing
  */
 bool SoundMgr_IsPlaying(void);
 
 /**
- * Get the client ID of who initiated the current sound playback.
- * @return client ID, or 255 if no sound is playing
- */
-uint32_t SoundMgr_GetPlaybackClientId(void);
-
-/**
- * Get the next Opus audio packet for transmission.
- * @param outBuffer Buffer for Opus data (max 512 bytes)
- * @param outLen Length of encoded data
- * @return true if data was encoded
+ * Mix and encode the next 20ms of all playing sounds.
+ * Produces one Opus packet per audience (everyone / Axis / Allies).
+ * @param out Packet array (MIXER_MAX_BUSES entries)
+ * @param maxOut Capacity of out
+ * @return Number of packets produced, 0 when idle
  */
-bool SoundMgr_GetNextOpusPacket(uint8_t *outBuffer, int *outLen);
+int SoundMgr_MixFrame(MixerPacket *out, int maxOut);
 
 /**
  * Queue a share request.
@@ -0,0 +1,518 @@
+/**
+ * @file sound_mixer.c
+ * @brief Multi-voice mixer for custom sound playback
+ */
+
+#include "sound_mixer.h"
+#include "opus_cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <opus/opus.h>
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
+/*
+ * One playing sound
+ */
+typedef struct {
+    bool                active;
+    uint32_t            clientId;
+    char                name[64];
+    int                 bus;
+    int                 priority;
+    uint64_t            startOrder;         /* For oldest-first stealing */
+
+    /* Source (pcm or clip) */
+    int16_t            *pcm;
+    int                 pcmSamples;
+    int                 pcmPosition;
+    OpusClip           *clip;
+    int                 clipPacket;
+    OpusDecoder        *decoder;            /* Created when a clip must be mixed */
+    OpusClipBuilder    *builder;            /* Recording while sole voice on its bus */
+
+    /* Ducking (Q15) */
+    int                 gain;
+    int                 targetGain;
+} MixerVoice;
+
+/*
+ * One audience with its own encoder and packet sequence
+ */
+typedef struct {
+    OpusEncoder        *encoder;
+    bool                passthrough;        /* Last frame was a cached packet */
+    uint8_t             owner;
+    uint32_t            sequence;
+} MixerBus;
+
+/*
+ * Module state
+ */
+static struct {
+    bool            initialized;
+    MixerVoice      voices[MIXER_MAX_VOICES];
+    MixerBus        buses[MIXER_MAX_BUSES];
+    uint64_t        startCounter;
+    MixerStats      stats;
+} g_mixer;
+
+
+/*
+ * Helper: Free a voice's source and mark it idle
+ */
+static void releaseVoice(MixerVoice *v) {
+    if (v->pcm) {
+        free(v->pcm);
+        v->pcm = NULL;
+    }
+    if (v->clip) {
+        OpusCache_Release(v->clip);
+        v->clip = NULL;
+    }
+    if (v->decoder) {
+        opus_decoder_destroy(v->decoder);
+        v->decoder = NULL;
+    }
+    if (v->builder) {
+        OpusCache_AbortBuild(v->builder);
+        v->builder = NULL;
+    }
+    if (v->active) {
+        v->active = false;
+        g_mixer.stats.activeVoices--;
+    }
+}
+
+static bool voiceFinished(const MixerVoice *v) {
+    if (v->clip) {
+        return v->clipPacket >= v->clip->numPackets;
+    }
+    return v->pcmPosition >= v->pcmSamples;
+}
+
+/*
+ * Helper: Produce the voice's next 960 samples (advances the voice).
+ * Cached clips are decoded with a per-voice decoder.
+ */
+static bool readVoiceFrame(MixerVoice *v, int16_t *frame) {
+    if (v->clip) {
+        if (!v->decoder) {
+            int err;
+            v->decoder = opus_decoder_create(OPUS_SAMPLE_RATE, OPUS_CHANNELS, &err);
+            if (err != OPUS_OK) {
+                v->decoder = NULL;
+                return false;
+            }
+        }
+        int idx = v->clipPacket++;
+        const uint8_t *pkt = v->clip->data + v->clip->offsets[idx];
+        int len = (int)(v->clip->offsets[idx + 1] - v->clip->offsets[idx]);
+        int decoded = opus_decode(v->decoder, pkt, len, frame, OPUS_FRAME_SIZE, 0);
+        if (decoded < 0) {
+            return false;
+        }
+        if (decoded < OPUS_FRAME_SIZE) {
+            memset(frame + decoded, 0, (OPUS_FRAME_SIZE - decoded) * sizeof(int16_t));
+        }
+        return true;
+    }
+
+    int count = v->pcmSamples - v->pcmPosition;
+    if (count > OPUS_FRAME_SIZE) count = OPUS_FRAME_SIZE;
+    memcpy(frame, v->pcm + v->pcmPosition, count * sizeof(int16_t));
+    if (count < OPUS_FRAME_SIZE) {
+        memset(frame + count, 0, (OPUS_FRAME_SIZE - count) * sizeof(int16_t));
+    }
+    v->pcmPosition += count;
+    return true;
+}
+
+/*
+ * Helper: acc = saturate(acc + src * gain), gain in Q15
+ */
+static void mixAddSaturate(int16_t *acc, const int16_t *src, int gain, int count) {
+    int i = 0;
+
+#if defined(__SSE2__)
+    if (gain >= MIXER_GAIN_UNITY) {
+        for (; i + 8 <= count; i += 8) {
+            __m128i a = _mm_loadu_si128((const __m128i *)(acc + i));
+            __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+            _mm_storeu_si128((__m128i *)(acc + i), _mm_adds_epi16(a, s));
+        }
+    } else {
+        /* mulhi gives (s * g) >> 16; doubling restores Q15 scaling */
+        __m128i g = _mm_set1_epi16((int16_t)gain);
+        for (; i + 8 <= count; i += 8) {
+            __m128i a = _mm_loadu_si128((const __m128i *)(acc + i));
+            __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+            s = _mm_mulhi_epi16(s, g);
+            s = _mm_adds_epi16(s, s);
+            _mm_storeu_si128((__m128i *)(acc + i), _mm_adds_epi16(a, s));
+        }
+    }
+#endif
+
+    for (; i < count; i++) {
+        int32_t s = (gain >= MIXER_GAIN_UNITY) ? src[i] : ((int32_t)src[i] * gain) >> 15;
+        int32_t sum = acc[i] + s;
+        if (sum > 32767) sum = 32767;
+        if (sum < -32768) sum = -32768;
+        acc[i] = (int16_t)sum;
+    }
+}
+
+/*
+ * Helper: Move gains one step towards their ducking targets
+ */
+static void updateGains(void) {
+    int topPriority[MIXER_MAX_BUSES];
+    for (int b = 0; b < MIXER_MAX_BUSES; b++) {
+        topPriority[b] = -1;
+    }
+    for (int i = 0; i < MIXER_MAX_VOICES; i++) {
+        MixerVoice *v = &g_mixer.voices[i];
+        if (v->active && v->priority > topPriority[v->bus]) {
+            topPriority[v->bus] = v->priority;
+        }
+    }
+
+    for (int i = 0; i < MIXER_MAX_VOICES; i++) {
+        MixerVoice *v = &g_mixer.voices[i];
+        if (!v->active) {
+            continue;
+        }
+        v->targetGain = (v->priority < topPriority[v->bus]) ?
+                        MIXER_GAIN_DUCKED : MIXER_GAIN_UNITY;
+        if (v->gain < v->targetGain) {
+            v->gain += MIXER_GAIN_STEP;
+            if (v->gain > v->targetGain) v->gain = v->targetGain;
+        } else if (v->gain > v->targetGain) {
+            v->gain -= MIXER_GAIN_STEP;
+            if (v->gain < v->targetGain) v->gain = v->targetGain;
+        }
+    }
+}
+
+/*
+ * Helper: Pick a voice slot for a new sound.
+ * Order: the client's own voice, a free slot, then the oldest voice with
+ * the lowest priority not above the new one.
+ */
+static MixerVoice *allocVoice(uint32_t clientId, int priority) {
+    MixerVoice *freeSlot = NULL;
+    MixerVoice *victim = NULL;
+
+    for (int i = 0; i < MIXER_MAX_VOICES; i++) {
+        MixerVoice *v = &g_mixer.voices[i];
+        if (!v->active) {
+            if (!freeSlot) freeSlot = v;
+            continue;
+        }
+        if (v->clientId == clientId) {
+            g_mixer.stats.voicesReplaced++;
+            return v;
+        }
+        if (v->priority <= priority &&
+            (!victim || v->priority < victim->priority ||
+             (v->priority == victim->priority && v->startOrder < victim->startOrder))) {
+            victim = v;
+        }
+    }
+
+    if (freeSlot) {
+        return freeSlot;
+    }
+    if (victim) {
+        printf("SoundMixer: Stealing voice '%s' (client %u) for client %u\n",
+               victim->name, victim->clientId, clientId);
+        g_mixer.stats.voicesStolen++;
+    }
+    return victim;
+}
+
+
+/*
+ * Create the bus encoders
+ */
+bool SoundMixer_Init(void) {
+    if (g_mixer.initialized) {
+        return true;
+    }
+
+    memset(&g_mixer, 0, sizeof(g_mixer));
+
+    for (int b = 0; b < MIXER_MAX_BUSES; b++) {
+        g_mixer.buses[b].encoder = SoundMixer_CreateEncoder();
+        if (!g_mixer.buses[b].encoder) {
+            for (int j = 0; j < b; j++) {
+                opus_encoder_destroy(g_mixer.buses[j].encoder);
+                g_mixer.buses[j].encoder = NULL;
+            }
+            return false;
+        }
+    }
+
+    g_mixer.initialized = true;
+    printf("SoundMixer: Initialized (%d voices, %d buses%s)\n",
+           MIXER_MAX_VOICES, MIXER_MAX_BUSES,
+#if defined(__SSE2__)
+           ", SSE2"
+#else
+           ""
+#endif
+           );
+    return true;
+}
+
+/*
+ * Stop all voices and destroy the encoders
+ */
+void SoundMixer_Shutdown(void) {
+    if (!g_mixer.initialized) {
+        return;
+    }
+
+    SoundMixer_StopAll();
+    for (int b = 0; b < MIXER_MAX_BUSES; b++) {
+        if (g_mixer.buses[b].encoder) {
+            opus_encoder_destroy(g_mixer.buses[b].encoder);
+            g_mixer.buses[b].encoder = NULL;
+        }
+    }
+    /* Keep stats for the final report */
+    g_mixer.initialized = false;
+}
+
+/*
+ * Create an Opus encoder with the playback settings
+ */
+OpusEncoder *SoundMixer_CreateEncoder(void) {
+    int opusErr;
+    OpusEncoder *encoder = opus_encoder_create(
+        OPUS_SAMPLE_RATE, OPUS_CHANNELS, OPUS_APPLICATION_AUDIO, &opusErr);
+    if (opusErr != OPUS_OK) {
+        fprintf(stderr, "SoundMixer: Failed to create Opus encoder: %s\n",
+                opus_strerror(opusErr));
+        return NULL;
+    }
+
+    opus_encoder_ctl(encoder, OPUS_SET_BITRATE(OPUS_BITRATE));
+    opus_encoder_ctl(encoder, OPUS_SET_COMPLEXITY(5));
+    return encoder;
+}
+
+/*
+ * Check if a voice could be started (same rules as allocVoice)
+ */
+bool SoundMixer_CanStart(uint32_t clientId, int priority) {
+    for (int i = 0; i < MIXER_MAX_VOICES; i++) {
+        const MixerVoice *v = &g_mixer.voices[i];
+        if (!v->active || v->clientId == clientId || v->priority <= priority) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Start a voice
+ */
+bool SoundMixer_StartVoice(uint32_t clientId, const char *name, int bus,
+                           int priority, MixerSource *src) {
+    if (!g_mixer.initialized || bus < 0 || bus >= MIXER_MAX_BUSES) {
+        return false;
+    }
+
+    MixerVoice *v = allocVoice(clientId, priority);
+    if (!v) {
+        g_mixer.stats.voicesRejected++;
+        return false;
+    }
+    releaseVoice(v);
+
+    MixerBus *b = &g_mixer.buses[bus];
+    bool busWasIdle = true;
+    for (int i = 0; busWasIdle && i < MIXER_MAX_VOICES; i++) {
+        if (g_mixer.voices[i].active && g_mixer.voices[i].bus == bus) {
+            busWasIdle = false;
+        }
+    }
+
+    if (busWasIdle) {
+        /* Fresh stream: new sequence and clean encoder state, otherwise
+         * the first frames of the new sound come out garbled */
+        opus_encoder_ctl(b->encoder, OPUS_RESET_STATE);
+        b->passthrough = false;
+        b->owner = (uint8_t)clientId;
+        b->sequence = 0;
+    }
+
+    memset(v, 0, sizeof(*v));
+    v->active = true;
+    v->clientId = clientId;
+    snprintf(v->name, sizeof(v->name), "%s", name ? name : "");
+    v->bus = bus;
+    v->priority = priority;
+    v->startOrder = ++g_mixer.startCounter;
+    v->pcm = src->pcm;
+    v->pcmSamples = src->pcmSamples;
+    v->clip = src->clip;
+    v->gain = MIXER_GAIN_UNITY;
+    v->targetGain = MIXER_GAIN_UNITY;
+
+    /* Recorded packets are only valid if this voice owns a fresh encoder */
+    v->builder = src->builder;
+    if (v->builder && !busWasIdle) {
+        OpusCache_AbortBuild(v->builder);
+        v->builder = NULL;
+    }
+
+    g_mixer.stats.voicesStarted++;
+    g_mixer.stats.activeVoices++;
+    if (g_mixer.stats.activeVoices > g_mixer.stats.peakVoices) {
+        g_mixer.stats.peakVoices = g_mixer.stats.activeVoices;
+    }
+    return true;
+}
+
+/*
+ * Stop the voice started by a client
+ */
+bool SoundMixer_StopClient(uint32_t clientId) {
+    bool found = false;
+    for (int i = 0; i < MIXER_MAX_VOICES; i++) {
+        MixerVoice *v = &g_mixer.voices[i];
+        if (v->active && v->clientId == clientId) {
+            releaseVoice(v);
+            found = true;
+        }
+    }
+    return found;
+}
+
+/*
+ * Stop all voices
+ */
+void SoundMixer_StopAll(void) {
+    for (int i = 0; i < MIXER_MAX_VOICES; i++) {
+        releaseVoice(&g_mixer.voices[i]);
+    }
+}
+
+bool SoundMixer_IsActive(void) {
+    return g_mixer.stats.activeVoices > 0;
+}
+
+/*
+ * Mix and encode the next 20ms for every active bus
+ */
+int SoundMixer_MixFrame(MixerPacket *out, int maxOut) {
+    if (!g_mixer.initialized || g_mixer.stats.activeVoices == 0) {
+        return 0;
+    }
+
+    updateGains();
+
+    int numOut = 0;
+    for (int b = 0; b < MIXER_MAX_BUSES && numOut < maxOut; b++) {
+        MixerBus *bus = &g_mixer.buses[b];
+        MixerVoice *busVoices[MIXER_MAX_VOICES];
+        int numVoices = 0;
+
+        for (int i = 0; i < MIXER_MAX_VOICES; i++) {
+            MixerVoice *v = &g_mixer.voices[i];
+            if (v->active && v->bus == b) {
+                if (voiceFinished(v)) {
+                    releaseVoice(v);
+                    continue;
+                }
+                busVoices[numVoices++] = v;
+            }
+        }
+
+        if (numVoices == 0) {
+            continue;
+        }
+
+        MixerPacket *pkt = &out[numOut];
+        pkt->fromClient = bus->owner;
+        pkt->team = (uint8_t)b;
+        pkt->sequence = bus->sequence;
+        pkt->len = 0;
+
+        MixerVoice *solo = (numVoices == 1) ? busVoices[0] : NULL;
+
+        if (solo && solo->clip && !solo->decoder && solo->gain >= MIXER_GAIN_UNITY) {
+            /* Single cached clip: forward the stored packet as-is */
+            int idx = solo->clipPacket++;
+            int len = (int)(solo->clip->offsets[idx + 1] - solo->clip->offsets[idx]);
+            if (len > OPUS_MAX_PACKET) len = OPUS_MAX_PACKET;
+            memcpy(pkt->data, solo->clip->data + solo->clip->offsets[idx], len);
+            pkt->len = len;
+            bus->passthrough = true;
+            g_mixer.stats.framesPassthrough++;
+        } else {
+            int16_t acc[OPUS_FRAME_SIZE];
+            int16_t frame[OPUS_FRAME_SIZE];
+
+            if (bus->passthrough) {
+                /* Encoder history doesn't match what listeners just heard */
+                opus_encoder_ctl(bus->encoder, OPUS_RESET_STATE);
+                bus->passthrough = false;
+            }
+
+            memset(acc, 0, sizeof(acc));
+            for (int i = 0; i < numVoices; i++) {
+                MixerVoice *v = busVoices[i];
+                if (!readVoiceFrame(v, frame)) {
+                    printf("SoundMixer: Failed to read '%s', stopping voice\n", v->name);
+                    releaseVoice(v);
+                    continue;
+                }
+                mixAddSaturate(acc, frame, v->gain, OPUS_FRAME_SIZE);
+            }
+
+            int encoded = opus_encode(bus->encoder, acc, OPUS_FRAME_SIZE,
+                                      pkt->data, OPUS_MAX_PACKET);
+            if (encoded < 0) {
+                printf("SoundMixer: Opus encode error on bus %d: %s\n",
+                       b, opus_strerror(encoded));
+                continue;
+            }
+            pkt->len = encoded;
+            g_mixer.stats.framesEncoded++;
+
+            /* Record the first voice's packets while it plays alone */
+            for (int i = 0; i < numVoices; i++) {
+                MixerVoice *v = busVoices[i];
+                if (!v->builder) {
+                    continue;
+                }
+                if (numVoices > 1 || v->gain < MIXER_GAIN_UNITY ||
+                    !OpusCache_BuildAppend(v->builder, pkt->data, encoded)) {
+                    OpusCache_AbortBuild(v->builder);
+                    v->builder = NULL;
+                } else if (voiceFinished(v)) {
+                    OpusCache_FinishBuild(v->builder, false);
+                    v->builder = NULL;
+                }
+            }
+        }
+
+        bus->sequence++;
+        numOut++;
+    }
+
+    return numOut;
+}
+
+void SoundMixer_GetStats(MixerStats *out) {
+    *out = g_mixer.stats;
+}
@@ -0,0 +1,162 @@
+/**
+ * @file sound_mixer.h
+ * @brief Multi-voice mixer for custom sound playback
+ *
+ * Several sounds can play at once. Each sound is a voice with its own
+ * position, priority and gain. Voices are grouped into buses by audience
+ * (everyone, Axis, Allies); every bus mixes its voices into one int16 frame
+ * and runs one shared Opus encode per 20ms, so overlapping sounds never
+ * need one encoder per voice.
+ *
+ * Lower-priority voices are ducked while a higher-priority voice is active
+ * on the same bus. A client owns at most one voice: a new sound from the
+ * same client replaces its previous one instead of cutting off everyone.
+ *
+ * A bus with a single cached clip at unity gain streams the stored packets
+ * unchanged (no decode, no encode).
+ */
+
+#ifndef SOUND_MIXER_H
+#define SOUND_MIXER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Output format (all buses)
+ */
+#define OPUS_SAMPLE_RATE        48000
+#define OPUS_CHANNELS           1
+#define OPUS_FRAME_MS           20
+#define OPUS_FRAME_SIZE         (OPUS_SAMPLE_RATE * OPUS_FRAME_MS / 1000)  /* 960 */
+#define OPUS_BITRATE            64000  /* 64kbps for much better music quality */
+#define OPUS_MAX_PACKET         512
+
+/*
+ * Limits
+ */
+#define MIXER_MAX_VOICES        8
+
+/*
+ * Buses (index matches the ET team value of the audience)
+ */
+#define MIXER_BUS_ALL           0       /* Everyone, including spectators */
+#define MIXER_BUS_AXIS          1
+#define MIXER_BUS_ALLIES        2
+#define MIXER_MAX_BUSES         3
+
+/*
+ * Voice priorities (by request source)
+ */
+#define MIXER_PRIORITY_QUICK    0       /* Chat-triggered quick commands */
+#define MIXER_PRIORITY_PLAYER   1       /* Explicit play / menu / playlist */
+#define MIXER_PRIORITY_SERVER   2       /* Server or admin announcements */
+
+/*
+ * Gains (Q15, unity = 32768)
+ */
+#define MIXER_GAIN_UNITY        32768
+#define MIXER_GAIN_DUCKED       11626   /* ~ -9 dB */
+#define MIXER_GAIN_STEP         6554    /* Per-frame ramp (~100ms full swing) */
+
+/*
+ * Audio a voice plays from. Exactly one of pcm / clip is set.
+ */
+typedef struct {
+    int16_t                  *pcm;          /* 48kHz mono, owned by the mixer */
+    int                       pcmSamples;
+    struct OpusClip_s        *clip;         /* Referenced, released by the mixer */
+    struct OpusClipBuilder_s *builder;      /* Optional cache recording for pcm */
+} MixerSource;
+
+/*
+ * One encoded frame for a bus
+ */
+typedef struct {
+    uint8_t  fromClient;                    /* Bus owner (first voice's client) */
+    uint8_t  team;                          /* MIXER_BUS_* audience */
+    uint32_t sequence;                      /* Per-bus, restarts at 0 */
+    int      len;
+    uint8_t  data[OPUS_MAX_PACKET];
+} MixerPacket;
+
+/*
+ * Mixer statistics
+ */
+typedef struct {
+    uint64_t voicesStarted;
+    uint64_t voicesReplaced;                /* Same client started another sound */
+    uint64_t voicesStolen;                  /* Evicted for a higher-priority voice */
+    uint64_t voicesRejected;                /* No voice available */
+    uint64_t framesEncoded;
+    uint64_t framesPassthrough;
+    int      activeVoices;
+    int      peakVoices;
+} MixerStats;
+
+/**
+ * Create the bus encoders.
+ * @return true on success
+ */
+bool SoundMixer_Init(void);
+
+/**
+ * Stop all voices and destroy the encoders.
+ */
+void SoundMixer_Shutdown(void);
+
+/**
+ * Create an Opus encoder with the playback settings.
+ * Cached packet streams must come from this exact configuration.
+ * @return Encoder (caller destroys), or NULL
+ */
+struct OpusEncoder *SoundMixer_CreateEncoder(void);
+
+/**
+ * Check if a voice could be started without touching any state.
+ * Lets callers reject a request before decoding the file.
+ */
+bool SoundMixer_CanStart(uint32_t clientId, int priority);
+
+/**
+ * Start a voice. On success the mixer owns the source.
+ * @param clientId Client that requested the sound (replaces its previous voice)
+ * @param name Sound name (for logging)
+ * @param bus MIXER_BUS_*
+ * @param priority MIXER_PRIORITY_*
+ * @param src Audio to play
+ * @return true if started; on false the caller still owns src
+ */
+bool SoundMixer_StartVoice(uint32_t clientId, const char *name, int bus,
+                           int priority, MixerSource *src);
+
+/**
+ * Stop the voice started by a client.
+ * @return true if the client had a voice
+ */
+bool SoundMixer_StopClient(uint32_t clientId);
+
+/**
+ * Stop all voices.
+ */
+void SoundMixer_StopAll(void);
+
+/**
+ * Check if any voice is playing.
+ */
+bool SoundMixer_IsActive(void);
+
+/**
+ * Mix and encode the next 20ms for every active bus.
+ * @param out Receives one packet per active bus
+ * @param maxOut Capacity of out (MIXER_MAX_BUSES is always enough)
+ * @return Number of packets written, 0 when nothing is playing
+ */
+int SoundMixer_MixFrame(MixerPacket *out, int maxOut);
+
+/**
+ * Copy current statistics.
+ */
+void SoundMixer_GetStats(MixerStats *out);
+
+#endif /* SOUND_MIXER_H */
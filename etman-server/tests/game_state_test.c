@@ -0,0 +1,226 @@
+/**
+ * @file game_state_test.c
+ * @brief Round trip of PKT_GAME_STATE records
+ *
+ * Packets are written the way ETMan_SendState() in qagame writes them and
+ * read back with GameState_NextRecord(). Every record has to come back
+ * unchanged and use up exactly the bytes that were reserved for it.
+ */
+
+#include "admin/game_state.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static int g_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        g_failures++; \
+    } \
+} while (0)
+
+/*
+ * Packet writer, same layout and record sizes as g_etman.c
+ */
+typedef struct {
+    uint8_t data[512];
+    int     len;
+} TestPacket;
+
+static void packetStart(TestPacket *pkt, uint16_t seq) {
+    pkt->data[0] = PKT_GAME_STATE;
+    pkt->data[1] = (uint8_t)(seq >> 8);
+    pkt->data[2] = (uint8_t)seq;
+    pkt->len = 3;
+}
+
+static uint8_t *packetRecord(TestPacket *pkt, int len) {
+    pkt->len += len;
+    return &pkt->data[pkt->len - len];
+}
+
+static uint8_t *putLong(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+    return p + 4;
+}
+
+static void writeMap(TestPacket *pkt, const char *mapname) {
+    int len = (int)strlen(mapname);
+    uint8_t *p = packetRecord(pkt, GAME_STATE_MAP_LEN(len));
+
+    *p++ = GAME_STATE_REC_MAP;
+    *p++ = (uint8_t)len;
+    memcpy(p, mapname, len);
+}
+
+static void writeLevel(TestPacket *pkt, uint32_t elapsedMs, uint32_t timelimitMs, uint8_t gamestate, uint8_t round) {
+    uint8_t *p = packetRecord(pkt, GAME_STATE_LEVEL_LEN);
+
+    *p++ = GAME_STATE_REC_LEVEL;
+    p = putLong(p, elapsedMs);
+    p = putLong(p, timelimitMs);
+    *p++ = gamestate;
+    *p = round;
+}
+
+static void writeLeft(TestPacket *pkt, uint8_t slot) {
+    uint8_t *p = packetRecord(pkt, GAME_STATE_LEFT_LEN);
+
+    *p++ = GAME_STATE_REC_PLAYER;
+    *p++ = slot;
+    *p = 0;
+}
+
+static void writePlayer(TestPacket *pkt, uint8_t slot, uint8_t team, const char *guid, const char *name) {
+    int len = (int)strlen(name);
+    uint8_t *p = packetRecord(pkt, GAME_STATE_PLAYER_LEN(len));
+
+    *p++ = GAME_STATE_REC_PLAYER;
+    *p++ = slot;
+    *p++ = 1;
+    *p++ = team;
+    memset(p, 0, ADMIN_GUID_LEN);
+    memcpy(p, guid, strlen(guid));
+    p += ADMIN_GUID_LEN;
+    *p++ = (uint8_t)len;
+    memcpy(p, name, len);
+}
+
+static const char *GUID_A = "0123456789ABCDEF0123456789ABCDEF";
+static const char *GUID_B = "BOT_7";
+
+/* Every record type in one packet, decoded in order and to the last byte */
+static void testRoundTrip(void) {
+    TestPacket pkt;
+    GameStateRecord rec;
+    int pos = 0;
+
+    packetStart(&pkt, 0x1234);
+    writeMap(&pkt, "supply");
+    writeLevel(&pkt, 123456, 1800000, GAME_STATE_PLAYING, 1);
+    writePlayer(&pkt, 3, 1, GUID_A, "^1Andy^7");
+    writeLeft(&pkt, 4);
+    writePlayer(&pkt, 63, 2, GUID_B, "");
+    writePlayer(&pkt, 5, 3, GUID_A, "spectator");
+
+    CHECK(GameState_Sequence(pkt.data) == 0x1234);
+
+    CHECK(GameState_NextRecord(pkt.data, pkt.len, &pos, &rec) == 1);
+    CHECK(rec.type == GAME_STATE_REC_MAP);
+    CHECK(strcmp(rec.mapname, "supply") == 0);
+
+    CHECK(GameState_NextRecord(pkt.data, pkt.len, &pos, &rec) == 1);
+    CHECK(rec.type == GAME_STATE_REC_LEVEL);
+    CHECK(rec.elapsedMs == 123456);
+    CHECK(rec.timelimitMs == 1800000);
+    CHECK(rec.gamestate == GAME_STATE_PLAYING);
+    CHECK(rec.round == 1);
+
+    CHECK(GameState_NextRecord(pkt.data, pkt.len, &pos, &rec) == 1);
+    CHECK(rec.type == GAME_STATE_REC_PLAYER);
+    CHECK(rec.slot == 3 && rec.connected && rec.team == 1);
+    CHECK(strcmp(rec.guid, GUID_A) == 0);
+    CHECK(strcmp(rec.name, "^1Andy^7") == 0);
+
+    CHECK(GameState_NextRecord(pkt.data, pkt.len, &pos, &rec) == 1);
+    CHECK(rec.type == GAME_STATE_REC_PLAYER);
+    CHECK(rec.slot == 4 && !rec.connected);
+
+    CHECK(GameState_NextRecord(pkt.data, pkt.len, &pos, &rec) == 1);
+    CHECK(rec.slot == 63 && rec.connected && rec.team == 2);
+    CHECK(strcmp(rec.guid, GUID_B) == 0);
+    CHECK(rec.name[0] == '\0');
+
+    CHECK(GameState_NextRecord(pkt.data, pkt.len, &pos, &rec) == 1);
+    CHECK(rec.slot == 5 && rec.team == 3);
+    CHECK(strcmp(rec.name, "spectator") == 0);
+
+    CHECK(GameState_NextRecord(pkt.data, pkt.len, &pos, &rec) == 0);
+    CHECK(pos == pkt.len);
+}
+
+/* A packet cut anywhere inside a record is rejected, never over-read */
+static void testTruncated(void) {
+    TestPacket pkt;
+    GameStateRecord rec;
+
+    packetStart(&pkt, 1);
+    writePlayer(&pkt, 1, 1, GUID_A, "player");
+
+    for (int len = 4; len < pkt.len; len++) {
+        int pos = 0;
+        CHECK(GameState_NextRecord(pkt.data, len, &pos, &rec) == -1);
+    }
+
+    packetStart(&pkt, 1);
+    writeLevel(&pkt, 1, 2, 3, 4);
+    for (int len = 4; len < pkt.len; len++) {
+        int pos = 0;
+        CHECK(GameState_NextRecord(pkt.data, len, &pos, &rec) == -1);
+    }
+
+    packetStart(&pkt, 1);
+    writeMap(&pkt, "goldrush");
+    for (int len = 4; len < pkt.len; len++) {
+        int pos = 0;
+        CHECK(GameState_NextRecord(pkt.data, len, &pos, &rec) == -1);
+    }
+}
+
+/* A stray byte after a record is reported instead of being read as a record */
+static void testTrailingGarbage(void) {
+    TestPacket pkt;
+    GameStateRecord rec;
+    int pos = 0;
+
+    packetStart(&pkt, 1);
+    writePlayer(&pkt, 1, 1, GUID_A, "player");
+    pkt.data[pkt.len++] = 0;
+
+    CHECK(GameState_NextRecord(pkt.data, pkt.len, &pos, &rec) == 1);
+    CHECK(GameState_NextRecord(pkt.data, pkt.len, &pos, &rec) == -1);
+    CHECK(pos == pkt.len - 1);
+}
+
+/* Over-long strings are cut to the record's buffers */
+static void testLongStrings(void) {
+    TestPacket pkt;
+    GameStateRecord rec;
+    char mapname[200], name[200];
+    int pos = 0;
+
+    memset(mapname, 'm', sizeof(mapname) - 1);
+    mapname[sizeof(mapname) - 1] = '\0';
+    memset(name, 'n', sizeof(name) - 1);
+    name[sizeof(name) - 1] = '\0';
+
+    packetStart(&pkt, 1);
+    writeMap(&pkt, mapname);
+    writePlayer(&pkt, 2, 1, GUID_A, name);
+
+    CHECK(GameState_NextRecord(pkt.data, pkt.len, &pos, &rec) == 1);
+    CHECK(strlen(rec.mapname) == sizeof(rec.mapname) - 1);
+    CHECK(GameState_NextRecord(pkt.data, pkt.len, &pos, &rec) == 1);
+    CHECK(strlen(rec.name) == ADMIN_MAX_NAME_LEN);
+    CHECK(strcmp(rec.guid, GUID_A) == 0);
+    CHECK(GameState_NextRecord(pkt.data, pkt.len, &pos, &rec) == 0);
+}
+
+int main(void) {
+    testRoundTrip();
+    testTruncated();
+    testTrailingGarbage();
+    testLongStrings();
+
+    if (g_failures) {
+        printf("%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    printf("game state records: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,395 @@
+/**
+ * @file worker_pool.c
+ * @brief Worker threads for slow ETMan commands (DB, sounds, admin)
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "worker_pool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+/*
+ * Module state
+ */
+static struct {
+    bool            initialized;
+    volatile bool   running;
+
+    pthread_t       threads[WORKER_MAX_THREADS];
+    int             numThreads;
+
+    WorkerJobFunc   jobFunc;
+    WorkerTickFunc  tickFunc;
+
+    /* Request queue (I/O thread -> workers) */
+    pthread_mutex_t jobLock;
+    pthread_cond_t  jobCond;
+    WorkerJob       jobs[WORKER_JOB_QUEUE_SIZE];
+    int             jobHead;
+    int             jobCount;
+
+    /* Ordered jobs, run by worker 0 only (jobLock protected) */
+    WorkerJob       orderedJobs[WORKER_JOB_QUEUE_SIZE];
+    int             orderedHead;
+    int             orderedCount;
+
+    /* Response queue (workers -> I/O thread) */
+    pthread_mutex_t respLock;
+    WorkerResponse  resps[WORKER_RESP_QUEUE_SIZE];
+    int             respHead;
+    int             respCount;
+    int             respFd;
+
+    /* Sound manager, admin module and DB connection are single-threaded */
+    pthread_mutex_t serviceLock;
+
+    /* Statistics (jobLock / respLock protected) */
+    WorkerPoolStats stats;
+} g_pool;
+
+static __thread bool t_isWorker = false;
+
+/* Monotonic clock in microseconds */
+static uint64_t monoTimeUs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/*
+ * Worker thread main loop
+ */
+static void *workerThread(void *arg) {
+    int index = (int)(intptr_t)arg;
+    uint64_t nextTick = monoTimeUs() + WORKER_TICK_MS * 1000;
+    bool ticks = (index == 0 && g_pool.tickFunc != NULL);
+    bool ordered = (index == 0);
+
+    t_isWorker = true;
+
+    while (g_pool.running) {
+        WorkerJob job;
+        bool haveJob = false;
+
+        pthread_mutex_lock(&g_pool.jobLock);
+        while (g_pool.running && g_pool.jobCount == 0 && !(ordered && g_pool.orderedCount > 0)) {
+            if (ticks) {
+                if (monoTimeUs() >= nextTick) {
+                    break;
+                }
+                struct timespec deadline;
+                clock_gettime(CLOCK_REALTIME, &deadline);
+                deadline.tv_nsec += WORKER_TICK_MS * 1000000L;
+                if (deadline.tv_nsec >= 1000000000L) {
+                    deadline.tv_sec++;
+                    deadline.tv_nsec -= 1000000000L;
+                }
+                pthread_cond_timedwait(&g_pool.jobCond, &g_pool.jobLock, &deadline);
+            } else {
+                pthread_cond_wait(&g_pool.jobCond, &g_pool.jobLock);
+            }
+        }
+        if (ordered && g_pool.orderedCount > 0) {
+            job = g_pool.orderedJobs[g_pool.orderedHead];
+            g_pool.orderedHead = (g_pool.orderedHead + 1) % WORKER_JOB_QUEUE_SIZE;
+            g_pool.orderedCount--;
+            haveJob = true;
+        } else if (g_pool.jobCount > 0) {
+            job = g_pool.jobs[g_pool.jobHead];
+            g_pool.jobHead = (g_pool.jobHead + 1) % WORKER_JOB_QUEUE_SIZE;
+            g_pool.jobCount--;
+            haveJob = true;
+        }
+        pthread_mutex_unlock(&g_pool.jobLock);
+
+        if (!g_pool.running) {
+            break;
+        }
+
+        if (haveJob) {
+            uint64_t start = monoTimeUs();
+
+            pthread_mutex_lock(&g_pool.serviceLock);
+            g_pool.jobFunc(&job);
+            pthread_mutex_unlock(&g_pool.serviceLock);
+
+            uint32_t elapsed = (uint32_t)(monoTimeUs() - start);
+            pthread_mutex_lock(&g_pool.jobLock);
+            g_pool.stats.jobsCompleted++;
+            if (elapsed > g_pool.stats.maxJobUs) {
+                g_pool.stats.maxJobUs = elapsed;
+            }
+            pthread_mutex_unlock(&g_pool.jobLock);
+        }
+
+        if (ticks && monoTimeUs() >= nextTick) {
+            pthread_mutex_lock(&g_pool.serviceLock);
+            g_pool.tickFunc();
+            pthread_mutex_unlock(&g_pool.serviceLock);
+
+            nextTick += WORKER_TICK_MS * 1000;
+            uint64_t now = monoTimeUs();
+            if (nextTick < now) {
+                nextTick = now + WORKER_TICK_MS * 1000;  /* Fell behind, don't spin */
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Start the worker threads
+ */
+bool WorkerPool_Init(int numThreads, WorkerJobFunc jobFunc, WorkerTickFunc tickFunc) {
+    if (g_pool.initialized) {
+        return true;
+    }
+    if (!jobFunc) {
+        return false;
+    }
+
+    if (numThreads < 1) numThreads = 1;
+    if (numThreads > WORKER_MAX_THREADS) numThreads = WORKER_MAX_THREADS;
+
+    memset(&g_pool, 0, sizeof(g_pool));
+    g_pool.jobFunc = jobFunc;
+    g_pool.tickFunc = tickFunc;
+
+    g_pool.respFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (g_pool.respFd < 0) {
+        fprintf(stderr, "WorkerPool: eventfd failed: %s\n", strerror(errno));
+        return false;
+    }
+
+    pthread_mutex_init(&g_pool.jobLock, NULL);
+    pthread_cond_init(&g_pool.jobCond, NULL);
+    pthread_mutex_init(&g_pool.respLock, NULL);
+    pthread_mutex_init(&g_pool.serviceLock, NULL);
+
+    g_pool.running = true;
+    for (int i = 0; i < numThreads; i++) {
+        if (pthread_create(&g_pool.threads[i], NULL, workerThread, (void *)(intptr_t)i) != 0) {
+            fprintf(stderr, "WorkerPool: Failed to start worker %d\n", i);
+            break;
+        }
+        g_pool.numThreads++;
+    }
+
+    if (g_pool.numThreads == 0) {
+        g_pool.running = false;
+        close(g_pool.respFd);
+        return false;
+    }
+
+    g_pool.stats.numThreads = g_pool.numThreads;
+    g_pool.initialized = true;
+    printf("WorkerPool: Started %d worker thread%s\n",
+           g_pool.numThreads, g_pool.numThreads == 1 ? "" : "s");
+    return true;
+}
+
+/*
+ * Stop and join all workers
+ */
+void WorkerPool_Shutdown(void) {
+    if (!g_pool.initialized) {
+        return;
+    }
+
+    pthread_mutex_lock(&g_pool.jobLock);
+    g_pool.running = false;
+    pthread_cond_broadcast(&g_pool.jobCond);
+    pthread_mutex_unlock(&g_pool.jobLock);
+
+    for (int i = 0; i < g_pool.numThreads; i++) {
+        pthread_join(g_pool.threads[i], NULL);
+    }
+
+    close(g_pool.respFd);
+    pthread_mutex_destroy(&g_pool.jobLock);
+    pthread_cond_destroy(&g_pool.jobCond);
+    pthread_mutex_destroy(&g_pool.respLock);
+    pthread_mutex_destroy(&g_pool.serviceLock);
+
+    g_pool.initialized = false;
+    printf("WorkerPool: Shutdown complete\n");
+}
+
+/*
+ * Queue a job on the shared or the ordered queue (I/O thread)
+ */
+static bool submitJob(const WorkerJob *job, bool ordered) {
+    if (!g_pool.initialized) {
+        return false;
+    }
+
+    WorkerJob *queue = ordered ? g_pool.orderedJobs : g_pool.jobs;
+    int *head = ordered ? &g_pool.orderedHead : &g_pool.jobHead;
+    int *count = ordered ? &g_pool.orderedCount : &g_pool.jobCount;
+
+    pthread_mutex_lock(&g_pool.jobLock);
+    if (*count >= WORKER_JOB_QUEUE_SIZE) {
+        g_pool.stats.jobsDropped++;
+        pthread_mutex_unlock(&g_pool.jobLock);
+        return false;
+    }
+
+    queue[(*head + *count) % WORKER_JOB_QUEUE_SIZE] = *job;
+    (*count)++;
+    g_pool.stats.jobsSubmitted++;
+    if (g_pool.jobCount + g_pool.orderedCount > g_pool.stats.jobQueuePeak) {
+        g_pool.stats.jobQueuePeak = g_pool.jobCount + g_pool.orderedCount;
+    }
+    if (ordered) {
+        /* A signal could wake a worker that doesn't take ordered jobs */
+        pthread_cond_broadcast(&g_pool.jobCond);
+    } else {
+        pthread_cond_signal(&g_pool.jobCond);
+    }
+    pthread_mutex_unlock(&g_pool.jobLock);
+    return true;
+}
+
+bool WorkerPool_Submit(const WorkerJob *job) {
+    return submitJob(job, false);
+}
+
+bool WorkerPool_SubmitOrdered(const WorkerJob *job) {
+    return submitJob(job, true);
+}
+
+/*
+ * Queue an outgoing datagram (worker)
+ */
+static bool postResponse(uint8_t kind, uint32_t clientId, uint8_t team,
+                         const struct sockaddr_in *addr,
+                         const uint8_t *data, int len) {
+    if (!g_pool.initialized || len < 0) {
+        return false;
+    }
+
+    pthread_mutex_lock(&g_pool.respLock);
+    if (len > WORKER_RESP_MAX_DATA) {
+        /* A cut datagram would only be misparsed by the client */
+        g_pool.stats.respOversized++;
+        pthread_mutex_unlock(&g_pool.respLock);
+        fprintf(stderr, "WorkerPool: dropped %d byte response (kind %u, client %u), limit is %d\n",
+                len, kind, clientId, WORKER_RESP_MAX_DATA);
+        return false;
+    }
+    if (g_pool.respCount >= WORKER_RESP_QUEUE_SIZE) {
+        g_pool.stats.respDropped++;
+        pthread_mutex_unlock(&g_pool.respLock);
+        return false;
+    }
+
+    int slot = (g_pool.respHead + g_pool.respCount) % WORKER_RESP_QUEUE_SIZE;
+    WorkerResponse *resp = &g_pool.resps[slot];
+    resp->kind = kind;
+    resp->clientId = clientId;
+    resp->team = team;
+    if (addr) {
+        resp->addr = *addr;
+    } else {
+        memset(&resp->addr, 0, sizeof(resp->addr));
+    }
+    resp->len = len;
+    memcpy(resp->data, data, len);
+    g_pool.respCount++;
+    g_pool.stats.respPosted++;
+    pthread_mutex_unlock(&g_pool.respLock);
+
+    uint64_t one = 1;
+    if (write(g_pool.respFd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        fprintf(stderr, "WorkerPool: eventfd write failed: %s\n", strerror(errno));
+    }
+    return true;
+}
+
+bool WorkerPool_PostResponse(uint8_t kind, uint32_t clientId,
+                             const struct sockaddr_in *addr,
+                             const uint8_t *data, int len) {
+    return postResponse(kind, clientId, 0, addr, data, len);
+}
+
+bool WorkerPool_PostBroadcast(uint8_t team, uint32_t clientId,
+                              const uint8_t *data, int len) {
+    return postResponse(WORKER_RESP_BROADCAST, clientId, team, NULL, data, len);
+}
+
+int WorkerPool_GetResponseFd(void) {
+    return g_pool.initialized ? g_pool.respFd : -1;
+}
+
+/*
+ * Drain pending responses (I/O thread)
+ */
+int WorkerPool_DrainResponses(WorkerRespFunc respFunc) {
+    if (!g_pool.initialized) {
+        return 0;
+    }
+
+    uint64_t counter;
+    if (read(g_pool.respFd, &counter, sizeof(counter)) < 0 && errno != EAGAIN) {
+        fprintf(stderr, "WorkerPool: eventfd read failed: %s\n", strerror(errno));
+    }
+
+    int handled = 0;
+    for (;;) {
+        WorkerResponse resp;
+
+        pthread_mutex_lock(&g_pool.respLock);
+        if (g_pool.respCount == 0) {
+            pthread_mutex_unlock(&g_pool.respLock);
+            break;
+        }
+        /* Copy only the used part of the payload */
+        WorkerResponse *src = &g_pool.resps[g_pool.respHead];
+        resp.kind = src->kind;
+        resp.clientId = src->clientId;
+        resp.team = src->team;
+        resp.addr = src->addr;
+        resp.len = src->len;
+        memcpy(resp.data, src->data, src->len);
+        g_pool.respHead = (g_pool.respHead + 1) % WORKER_RESP_QUEUE_SIZE;
+        g_pool.respCount--;
+        pthread_mutex_unlock(&g_pool.respLock);
+
+        respFunc(&resp);
+        handled++;
+    }
+    return handled;
+}
+
+bool WorkerPool_IsWorkerThread(void) {
+    return t_isWorker;
+}
+
+void WorkerPool_GetStats(WorkerPoolStats *out) {
+    if (!g_pool.initialized) {
+        /* Totals survive WorkerPool_Shutdown() for the final report */
+        *out = g_pool.stats;
+        return;
+    }
+
+    pthread_mutex_lock(&g_pool.jobLock);
+    *out = g_pool.stats;
+    out->jobQueueDepth = g_pool.jobCount + g_pool.orderedCount;
+    pthread_mutex_unlock(&g_pool.jobLock);
+
+    pthread_mutex_lock(&g_pool.respLock);
+    out->respPosted = g_pool.stats.respPosted;
+    out->respDropped = g_pool.stats.respDropped;
+    out->respOversized = g_pool.stats.respOversized;
+    pthread_mutex_unlock(&g_pool.respLock);
+}
@@ -0,0 +1,161 @@
+/**
+ * @file worker_pool.h
+ * @brief Worker threads for slow ETMan commands (DB, sounds, admin)
+ *
+ * The voice I/O thread only relays audio. Everything that may block on
+ * PostgreSQL or disk is copied into a job and handed to the worker pool
+ * through a bounded request queue. Workers never touch the socket directly:
+ * outgoing datagrams go back through a response queue that the I/O thread
+ * drains when the pool's eventfd becomes readable.
+ */
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <netinet/in.h>
+
+/*
+ * Limits
+ */
+#define WORKER_MAX_THREADS          8
+#define WORKER_DEFAULT_THREADS      1       /* Override with ETMAN_WORKERS */
+#define WORKER_JOB_QUEUE_SIZE       256
+#define WORKER_RESP_QUEUE_SIZE      512
+#define WORKER_JOB_MAX_DATA         512     /* Matches voice MAX_PACKET_SIZE */
+#define WORKER_RESP_MAX_DATA        2048
+#define WORKER_TICK_MS              10      /* Sound frame / playback pacing */
+
+/*
+ * Job kinds (I/O thread -> workers)
+ */
+#define WORKER_JOB_SOUND            1       /* SoundMgr_HandlePacket */
+#define WORKER_JOB_ADMIN            2       /* Admin packet from qagame */
+
+/*
+ * Response kinds (workers -> I/O thread)
+ */
+#define WORKER_RESP_TO_ADDR         1       /* Send to resp.addr */
+#define WORKER_RESP_TO_CLIENT       2       /* Resolve resp.clientId on I/O thread */
+#define WORKER_RESP_BROADCAST       3       /* Fan out to every live client */
+
+/*
+ * Request queue entry
+ */
+typedef struct {
+    uint8_t             kind;
+    uint32_t            clientId;
+    struct sockaddr_in  addr;
+    int                 len;
+    uint8_t             data[WORKER_JOB_MAX_DATA];
+} WorkerJob;
+
+/*
+ * Response queue entry
+ */
+typedef struct {
+    uint8_t             kind;
+    uint32_t            clientId;
+    uint8_t             team;           /* BROADCAST audience, 0 = everyone */
+    struct sockaddr_in  addr;
+    int                 len;
+    uint8_t             data[WORKER_RESP_MAX_DATA];
+} WorkerResponse;
+
+/*
+ * Pool statistics
+ */
+typedef struct {
+    int      numThreads;
+    uint64_t jobsSubmitted;
+    uint64_t jobsCompleted;
+    uint64_t jobsDropped;           /* Request queue full */
+    uint64_t respPosted;
+    uint64_t respDropped;           /* Response queue full */
+    uint64_t respOversized;         /* Longer than WORKER_RESP_MAX_DATA */
+    int      jobQueueDepth;
+    int      jobQueuePeak;
+    uint32_t maxJobUs;              /* Slowest job since start */
+} WorkerPoolStats;
+
+typedef void (*WorkerJobFunc)(const WorkerJob *job);
+typedef void (*WorkerTickFunc)(void);
+typedef void (*WorkerRespFunc)(const WorkerResponse *resp);
+
+/**
+ * Start the worker threads.
+ * Jobs and ticks run under the service lock, because the sound manager,
+ * admin module and database connection are not re-entrant.
+ * @param numThreads Number of workers (clamped to 1..WORKER_MAX_THREADS)
+ * @param jobFunc Called on a worker for every submitted job
+ * @param tickFunc Called every WORKER_TICK_MS on worker 0 (may be NULL)
+ * @return true on success
+ */
+bool WorkerPool_Init(int numThreads, WorkerJobFunc jobFunc, WorkerTickFunc tickFunc);
+
+/**
+ * Stop and join all workers. Pending jobs are discarded.
+ */
+void WorkerPool_Shutdown(void);
+
+/**
+ * Queue a job from the I/O thread. Never blocks.
+ * @param job Job to copy into the request queue
+ * @return false if the queue is full (job dropped)
+ */
+bool WorkerPool_Submit(const WorkerJob *job);
+
+/**
+ * Queue a job that must run after the ordered jobs submitted before it.
+ * Ordered jobs all run on worker 0, one at a time, in submission order.
+ * With several workers, jobs from WorkerPool_Submit() can finish in any order.
+ * Never blocks.
+ * @param job Job to copy into the ordered queue
+ * @return false if the queue is full (job dropped)
+ */
+bool WorkerPool_SubmitOrdered(const WorkerJob *job);
+
+/**
+ * Queue an outgoing datagram from a worker. Never blocks.
+ * Wakes the I/O thread through the response eventfd.
+ * Datagrams longer than WORKER_RESP_MAX_DATA are dropped and logged.
+ * @return false if the queue is full or the datagram too long (response dropped)
+ */
+bool WorkerPool_PostResponse(uint8_t kind, uint32_t clientId,
+                             const struct sockaddr_in *addr,
+                             const uint8_t *data, int len);
+
+/**
+ * Queue a broadcast limited to one team from a worker.
+ * @param team Team number of the recipients, 0 for everyone
+ * @return false if the queue is full or the datagram too long (response dropped)
+ */
+bool WorkerPool_PostBroadcast(uint8_t team, uint32_t clientId,
+                              const uint8_t *data, int len);
+
+/**
+ * File descriptor that becomes readable when responses are pending.
+ * Register it with the I/O thread's epoll set.
+ */
+int WorkerPool_GetResponseFd(void);
+
+/**
+ * Drain all pending responses on the I/O thread.
+ * @param respFunc Called once per response, in posting order
+ * @return Number of responses handled
+ */
+int WorkerPool_DrainResponses(WorkerRespFunc respFunc);
+
+/**
+ * Check if the calling thread is one of the pool workers.
+ */
+bool WorkerPool_IsWorkerThread(void);
+
+/**
+ * Copy current statistics.
+ */
+void WorkerPool_GetStats(WorkerPoolStats *out);
+
+#endif /* WORKER_POOL_H */
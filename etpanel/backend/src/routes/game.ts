@@ -73,6 +73,43 @@ const chatSchema = z.object({
   timestamp: z.number(),
 });
 
+// Events accepted by /batch, keyed by the name of their single-event route
+const batchEvents: Record<string, { schema: z.ZodTypeAny; handle: (data: any) => Promise<void> }> = {
+  'player-connect': { schema: playerConnectSchema, handle: handlePlayerConnect },
+  'player-disconnect': { schema: playerDisconnectSchema, handle: handlePlayerDisconnect },
+  'kill': { schema: killSchema, handle: handleKill },
+  'death': { schema: deathSchema, handle: handleDeath },
+  'chat': { schema: chatSchema, handle: handleChat },
+};
+
+const batchSchema = z.array(z.unknown());
+
+const batchEntrySchema = z.object({
+  type: z.string(),
+  data: z.unknown(),
+});
+
+// Spool lines written before /batch existed are flat events with an
+// "event_type" such as "player_connect" (see the old etpanel-relay.sh)
+const legacyEntrySchema = z.object({
+  event_type: z.string(),
+}).passthrough();
+
+function normalizeBatchEntry(entry: unknown): { type: string; data: unknown } | null {
+  const current = batchEntrySchema.safeParse(entry);
+  if (current.success) {
+    return { type: current.data.type, data: current.data.data };
+  }
+
+  const legacy = legacyEntrySchema.safeParse(entry);
+  if (legacy.success) {
+    const { event_type, ...data } = legacy.data;
+    return { type: event_type.replace(/_/g, '-'), data };
+  }
+
+  return null;
+}
+
 // Verify API key from game server
 function verifyApiKey(request: FastifyRequest): boolean {
   const apiKey = request.headers['x-api-key'];
@@ -153,4 +190,56 @@ export const gameRoutes: FastifyPluginAsync = async (fastify) => {
     fastify.log.info({ data: request.body }, 'Round ended');
     return { success: true };
   });
+
+  // Batched events from the game server sender thread, in the order they happened.
+  // Every entry is handled on its own: a bad or failing event is logged and counted,
+  // and the batch is still answered with 200. The game server drops batches that get
+  // a 4xx and posts them again after a 5xx, which would repeat the handled events.
+  fastify.post('/batch', async (request, reply) => {
+    const body = batchSchema.safeParse(request.body);
+    if (!body.success) {
+      fastify.log.warn({ errors: body.error.errors }, 'Invalid event batch');
+      return reply.status(400).send({ error: 'Invalid event data' });
+    }
+
+    let accepted = 0;
+    let failed = 0;
+    for (const item of body.data) {
+      const event = normalizeBatchEntry(item);
+      if (!event) {
+        fastify.log.warn({ entry: item }, 'Invalid entry in batch');
+        failed++;
+        continue;
+      }
+
+      const entry = batchEvents[event.type];
+      if (!entry) {
+        if (event.type === 'round-end' || event.type === 'map-end') {
+          fastify.log.info({ data: event.data }, `Game event: ${event.type}`);
+          accepted++;
+        } else {
+          fastify.log.warn({ type: event.type }, 'Unknown event type in batch');
+          failed++;
+        }
+        continue;
+      }
+
+      const data = entry.schema.safeParse(event.data);
+      if (!data.success) {
+        fastify.log.warn({ errors: data.error.errors, type: event.type, data: event.data }, 'Invalid event in batch');
+        failed++;
+        continue;
+      }
+
+      try {
+        await entry.handle(data.data);
+        accepted++;
+      } catch (err) {
+        fastify.log.error({ err, type: event.type, data: event.data }, 'Failed to handle event in batch');
+        failed++;
+      }
+    }
+
+    return { success: true, accepted, failed };
+  });
 };
@@ -0,0 +1,83 @@
+--[[
+    gentity field access micro-benchmark
+
+    Compares four ways of reading the same client fields:
+    1. et.gentity_get_linear(): the old lookup, a linear scan of the field
+       tables by name on every call
+    2. et.gentity_get() with the field name on every call (hashed lookup)
+    3. et.gentity_get() with handles from et.gentity_field()
+    4. et.gentity_getmulti() for all clients in one call
+
+    Usage (rcon/server console):
+    - lua_gentitybench [iterations]
+]]--
+
+local M = {}
+
+local FIELDS = { "inuse", "pers.connected", "pers.netname", "sess.sessionTeam", "health", "r.currentOrigin" }
+
+local function benchByName(get, maxclients, iterations)
+    local start = et.trap_Milliseconds()
+    for _ = 1, iterations do
+        for i = 0, maxclients - 1 do
+            for f = 1, #FIELDS do
+                get(i, FIELDS[f])
+            end
+        end
+    end
+    return et.trap_Milliseconds() - start
+end
+
+local function benchByHandle(maxclients, iterations)
+    local get = et.gentity_get
+    local handles = {}
+    for f = 1, #FIELDS do
+        handles[f] = et.gentity_field(FIELDS[f])
+    end
+
+    local start = et.trap_Milliseconds()
+    for _ = 1, iterations do
+        for i = 0, maxclients - 1 do
+            for f = 1, #handles do
+                get(i, handles[f])
+            end
+        end
+    end
+    return et.trap_Milliseconds() - start
+end
+
+local function benchMulti(iterations)
+    local handles = {}
+    for f = 1, #FIELDS do
+        handles[f] = et.gentity_field(FIELDS[f])
+    end
+
+    local start = et.trap_Milliseconds()
+    for _ = 1, iterations do
+        et.gentity_getmulti(nil, handles)
+    end
+    return et.trap_Milliseconds() - start
+end
+
+function M.run(iterations)
+    iterations = iterations or 1000
+    local maxclients = tonumber(et.trap_Cvar_Get("sv_maxclients")) or 64
+    local reads = iterations * maxclients * #FIELDS
+
+    et.G_Print(string.format("^3gentity bench: ^7%d iterations x %d clients x %d fields\n",
+        iterations, maxclients, #FIELDS))
+
+    local results = {
+        { "linear scan", benchByName(et.gentity_get_linear, maxclients, iterations) },
+        { "hashed name", benchByName(et.gentity_get, maxclients, iterations) },
+        { "handles", benchByHandle(maxclients, iterations) },
+        { "getmulti", benchMulti(iterations) },
+    }
+
+    for _, r in ipairs(results) do
+        et.G_Print(string.format("  %-12s %6d ms  (%.1f ns/read)\n",
+            r[1], r[2], r[2] * 1000000 / math.max(reads, 1)))
+    end
+end
+
+return M
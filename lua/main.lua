@@ -200,36 +200,36 @@ local function stripColors(str)
     return (str:gsub("%^[0-9a-zA-Z]", ""))
 end
 
--- Get count of human players currently on server
-local function getHumanPlayerCount()
-    local count = 0
+-- Client fields read by the player helpers below, resolved once
+local PLAYER_FIELDS = { et.gentity_field("pers.connected"), et.gentity_field("pers.netname") }
+
+-- Names of connected human players, excluding excludeClientNum (optional)
+-- et.gentity_getmulti() only returns entities that are in use
+local function getHumanPlayerNames(excludeClientNum)
+    local names = {}
+    local players = et.gentity_getmulti(nil, PLAYER_FIELDS)
     for i = 0, tonumber(et.trap_Cvar_Get("sv_maxclients")) - 1 do
-        if et.gentity_get(i, "inuse") == 1 then
-            local pers_connected = et.gentity_get(i, "pers.connected")
-            if pers_connected == 2 then  -- CON_CONNECTED
-                local name = et.gentity_get(i, "pers.netname") or ""
-                if not name:find("%[BOT%]") then
-                    count = count + 1
-                end
+        local fields = players[i]
+        if fields and i ~= excludeClientNum and fields["pers.connected"] == 2 then  -- CON_CONNECTED
+            local name = fields["pers.netname"] or ""
+            if not name:find("%[BOT%]") then
+                table.insert(names, name)
             end
         end
     end
-    return count
+    return names
+end
+
+-- Get count of human players currently on server
+local function getHumanPlayerCount()
+    return #getHumanPlayerNames()
 end
 
 -- Get list of other human players (excluding the one who just joined)
 local function getOtherHumanPlayers(excludeClientNum)
     local players = {}
-    for i = 0, tonumber(et.trap_Cvar_Get("sv_maxclients")) - 1 do
-        if i ~= excludeClientNum and et.gentity_get(i, "inuse") == 1 then
-            local pers_connected = et.gentity_get(i, "pers.connected")
-            if pers_connected == 2 then  -- CON_CONNECTED
-                local name = et.gentity_get(i, "pers.netname") or ""
-                if not name:find("%[BOT%]") then
-                    table.insert(players, stripColors(name))
-                end
-            end
-        end
+    for _, name in ipairs(getHumanPlayerNames(excludeClientNum)) do
+        table.insert(players, stripColors(name))
     end
     return players
 end
@@ -816,6 +816,17 @@ function et_ConsoleCommand()
         return 1  -- We handled it
     end
 
+    -- Benchmark gentity field access: lua_gentitybench [iterations]
+    if cmd == "lua_gentitybench" then
+        local success, err = pcall(function()
+            dofile("legacy/lua/gentity_bench.lua").run(tonumber(et.trap_Argv(1)))
+        end)
+        if not success then
+            et.G_Print("^1[ERROR] ^7gentity bench failed: " .. tostring(err) .. "\n")
+        end
+        return 1
+    end
+
     if cmd == "lua_reload" then
         log("^3Reloading Lua scripts on next map...")
         return 1
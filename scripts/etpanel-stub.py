@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+#
+# ETPanel stub server - test the game server's event sender without the panel
+#
+# Answers POST <path>/game/batch like the panel backend does, over keep-alive
+# HTTP/1.1, and prints every event it gets. It accepts the {"type","data"}
+# entries of the sender thread and the flat "event_type" lines of old spool
+# files. Outages can be simulated to test spooling, replay and backoff.
+#
+# Usage:
+#   ./etpanel-stub.py                       # Listen on 127.0.0.1:3100
+#   ./etpanel-stub.py --port 3200           # Other port
+#   ./etpanel-stub.py --key <api key>       # Answer 401 to other keys
+#   ./etpanel-stub.py --fail 503            # Answer every post with 503
+#   ./etpanel-stub.py --fail 503 --every 3  # Answer every 3rd post with 503
+#   ./etpanel-stub.py --fail drop           # Close the connection without an answer
+#   ./etpanel-stub.py --log events.log      # Also append the events to a file
+#
+# Then on the game server:
+#   set etpanel_api_url "http://127.0.0.1:3100/api"
+#   etpanelstats
+#
+# Stop with Ctrl+C, the totals are printed on exit.
+#
+
+import argparse
+import http.server
+import json
+import threading
+
+EVENT_TYPES = ('player-connect', 'player-disconnect', 'kill', 'death', 'chat', 'round-end', 'map-end')
+
+stats = {'posts': 0, 'failed_posts': 0, 'accepted': 0, 'failed': 0, 'legacy': 0}
+stats_lock = threading.Lock()
+
+
+def normalize(entry):
+    """Returns (type, data, legacy) like normalizeBatchEntry in routes/game.ts, None if invalid"""
+    if not isinstance(entry, dict):
+        return None
+    if isinstance(entry.get('type'), str) and 'data' in entry:
+        return entry['type'], entry['data'], False
+    if isinstance(entry.get('event_type'), str):
+        data = dict(entry)
+        del data['event_type']
+        return entry['event_type'].replace('_', '-'), data, True
+    return None
+
+
+class StubHandler(http.server.BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+
+    def reply(self, status, body):
+        out = json.dumps(body).encode()
+        self.send_response(status)
+        self.send_header('Content-Type', 'application/json')
+        self.send_header('Content-Length', str(len(out)))
+        self.end_headers()
+        self.wfile.write(out)
+
+    def do_POST(self):
+        length = int(self.headers.get('Content-Length') or 0)
+        raw = self.rfile.read(length)
+
+        with stats_lock:
+            stats['posts'] += 1
+            post = stats['posts']
+
+        if not self.path.endswith('/game/batch'):
+            self.reply(404, {'error': 'Not found'})
+            return
+
+        if args.key is not None and self.headers.get('X-API-Key') != args.key:
+            self.reply(401, {'error': 'Invalid API key'})
+            return
+
+        if args.fail and post % args.every == 0:
+            with stats_lock:
+                stats['failed_posts'] += 1
+            print('post %d: simulated failure (%s)' % (post, args.fail), flush=True)
+            if args.fail == 'drop':
+                self.close_connection = True
+                self.connection.close()
+            else:
+                self.reply(int(args.fail), {'error': 'Simulated failure'})
+            return
+
+        try:
+            body = json.loads(raw)
+        except ValueError:
+            body = None
+        if not isinstance(body, list):
+            self.reply(400, {'error': 'Invalid event data'})
+            return
+
+        accepted = failed = 0
+        for entry in body:
+            event = normalize(entry)
+            if not event or event[0] not in EVENT_TYPES:
+                print('post %d: invalid entry %s' % (post, json.dumps(entry)), flush=True)
+                failed += 1
+                continue
+
+            kind, data, legacy = event
+            print('post %d: %s%s %s' % (post, kind, ' (legacy)' if legacy else '', json.dumps(data)), flush=True)
+            if args.log:
+                with stats_lock, open(args.log, 'a') as f:
+                    f.write(json.dumps({'type': kind, 'data': data}) + '\n')
+            accepted += 1
+            if legacy:
+                with stats_lock:
+                    stats['legacy'] += 1
+
+        with stats_lock:
+            stats['accepted'] += accepted
+            stats['failed'] += failed
+        self.reply(200, {'success': True, 'accepted': accepted, 'failed': failed})
+
+    def log_message(self, format, *params):
+        pass
+
+
+parser = argparse.ArgumentParser(description='ETPanel stub server')
+parser.add_argument('--host', default='127.0.0.1')
+parser.add_argument('--port', type=int, default=3100)
+parser.add_argument('--key', help='expected X-API-Key')
+parser.add_argument('--fail', help='HTTP status to answer posts with, or "drop"')
+parser.add_argument('--every', type=int, default=1, help='only fail every Nth post')
+parser.add_argument('--log', help='append the accepted events to this file')
+args = parser.parse_args()
+
+if args.fail and args.fail != 'drop' and not args.fail.isdigit():
+    parser.error('--fail takes an HTTP status or "drop"')
+if args.every < 1:
+    parser.error('--every must be at least 1')
+
+server = http.server.ThreadingHTTPServer((args.host, args.port), StubHandler)
+print('ETPanel stub listening on http://%s:%d/api' % (args.host, args.port), flush=True)
+try:
+    server.serve_forever()
+except KeyboardInterrupt:
+    pass
+print('\n%(posts)d posts (%(failed_posts)d failed), %(accepted)d events accepted '
+      '(%(legacy)d legacy), %(failed)d invalid' % stats)
@@ -0,0 +1,366 @@
+#!/usr/bin/env python3
+#
+# Synthetic test map - run server side tests without the game's pk3 files
+#
+# Writes a Q3/ET (IBSP 47) map with the collision data a dedicated server
+# needs: axis aligned brushes in a kd-tree of nodes and leafs, brush
+# submodels for doors, explosives and static props, spawn points and items.
+# There are no drawable surfaces, lightmaps or vis data (everything is one
+# cluster), so clients can't render it, but the server can load it and run
+# traces, snapshots, movers and Lua on it.
+#
+# Usage:
+#   ./make-test-map.py maps/testmap.bsp                  # Write the .bsp
+#   ./make-test-map.py testmap.pk3                       # Pack it as maps/testmap.bsp
+#   ./make-test-map.py --seed 7 --rubble 4000 big.pk3    # Denser map
+#
+# Then, with the pk3 in the mod folder:
+#   etlded +map testmap
+#   tracetest 200000 4
+#
+# etlded also wants etmain/pak0.pk3 to exist. For a server without the game
+# data, any zip works there (the map pk3 itself, for instance). The server
+# side player models come from pak0 too: --player-models reads the .char and
+# .anim files of the mod pk3 and packs stand-in .mdm/.mdx files (a three bone
+# skeleton that never moves) at the paths they name.
+#
+#   ./make-test-map.py --player-models legacy/legacy_v2.83.pk3 testmap.pk3
+#
+
+import argparse
+import os
+import random
+import re
+import struct
+import zipfile
+
+BSP_IDENT = b'IBSP'
+BSP_VERSION = 47
+HEADER_LUMPS = 17
+
+(LUMP_ENTITIES, LUMP_SHADERS, LUMP_PLANES, LUMP_NODES, LUMP_LEAFS, LUMP_LEAFSURFACES,
+ LUMP_LEAFBRUSHES, LUMP_MODELS, LUMP_BRUSHES, LUMP_BRUSHSIDES, LUMP_DRAWVERTS,
+ LUMP_DRAWINDEXES, LUMP_FOGS, LUMP_SURFACES, LUMP_LIGHTMAPS, LUMP_LIGHTGRID,
+ LUMP_VISIBILITY) = range(HEADER_LUMPS)
+
+CONTENTS_SOLID = 1
+CONTENTS_PLAYERCLIP = 0x10000
+
+LEAF_BRUSHES = 6        # stop splitting below this many brushes
+MAX_DEPTH = 28
+
+
+class Map:
+    def __init__(self):
+        self.shaders = []       # (name, surfaceFlags, contentFlags)
+        self.planes = []        # (normal, dist), in +/- pairs
+        self.plane_index = {}
+        self.brushes = []       # (mins, maxs, shader)
+        self.world_brushes = 0
+        self.models = []        # (mins, maxs, firstBrush, numBrushes)
+        self.entities = []      # dicts, worldspawn first
+        self.nodes = []
+        self.leafs = []
+        self.leaf_brushes = []
+
+    def shader(self, name, contents):
+        self.shaders.append((name, 0, contents))
+        return len(self.shaders) - 1
+
+    def plane(self, axis, dist):
+        """Index of the plane facing +axis at dist; index ^ 1 faces the other way"""
+        key = (axis, dist)
+        if key not in self.plane_index:
+            normal = [0.0, 0.0, 0.0]
+            normal[axis] = 1.0
+            self.plane_index[key] = len(self.planes)
+            self.planes.append((tuple(normal), float(dist)))
+            normal[axis] = -1.0
+            self.planes.append((tuple(normal), -float(dist)))
+        return self.plane_index[key]
+
+    def brush(self, mins, maxs, shader=0):
+        mins = [int(v) for v in mins]
+        maxs = [int(v) for v in maxs]
+        if any(maxs[i] <= mins[i] for i in range(3)):
+            return
+        self.brushes.append((mins, maxs, shader))
+
+    def build_tree(self, mins, maxs):
+        """kd-tree over the world brushes, node 0 is the root"""
+        self.build_node(list(range(self.world_brushes)), list(mins), list(maxs), 0)
+
+    def build_node(self, ids, mins, maxs, depth):
+        split = None
+        if len(ids) > LEAF_BRUSHES and depth < MAX_DEPTH:
+            axis = max(range(3), key=lambda i: maxs[i] - mins[i])
+            centers = sorted((self.brushes[b][0][axis] + self.brushes[b][1][axis]) // 2 for b in ids)
+            dist = centers[len(centers) // 2]
+            if mins[axis] < dist < maxs[axis]:
+                front = [b for b in ids if self.brushes[b][1][axis] > dist]
+                back = [b for b in ids if self.brushes[b][0][axis] < dist]
+                if len(front) < len(ids) or len(back) < len(ids):
+                    split = (axis, dist, front, back)
+
+        if split is None:
+            self.leafs.append((mins, maxs, len(self.leaf_brushes), len(ids)))
+            self.leaf_brushes.extend(ids)
+            return -len(self.leafs)
+
+        axis, dist, front, back = split
+        num = len(self.nodes)
+        self.nodes.append(None)
+
+        front_mins, back_maxs = list(mins), list(maxs)
+        front_mins[axis] = dist
+        back_maxs[axis] = dist
+        children = (self.build_node(front, front_mins, maxs, depth + 1),
+                    self.build_node(back, mins, back_maxs, depth + 1))
+        self.nodes[num] = (self.plane(axis, dist), children, mins, maxs)
+        return num
+
+    def entity_string(self):
+        out = []
+        for ent in self.entities:
+            out.append('{\n')
+            for key, value in ent.items():
+                out.append('"%s" "%s"\n' % (key, value))
+            out.append('}\n')
+        return ''.join(out).encode() + b'\0'
+
+    def write(self):
+        lumps = [b''] * HEADER_LUMPS
+
+        lumps[LUMP_ENTITIES] = self.entity_string()
+        lumps[LUMP_SHADERS] = b''.join(struct.pack('<64sii', n.encode(), s, c) for n, s, c in self.shaders)
+        lumps[LUMP_PLANES] = b''.join(struct.pack('<4f', *n, d) for n, d in self.planes)
+        lumps[LUMP_NODES] = b''.join(struct.pack('<3i3i3i', p, c[0], c[1], *mn, *mx)
+                                     for p, c, mn, mx in self.nodes)
+        lumps[LUMP_LEAFS] = b''.join(struct.pack('<2i3i3i4i', 0, 0, *mn, *mx, 0, 0, first, count)
+                                     for mn, mx, first, count in self.leafs)
+        lumps[LUMP_LEAFBRUSHES] = struct.pack('<%di' % len(self.leaf_brushes), *self.leaf_brushes)
+        lumps[LUMP_MODELS] = b''.join(struct.pack('<6f4i', *mn, *mx, 0, 0, first, count)
+                                      for mn, mx, first, count in self.models)
+
+        sides = []
+        brushes = []
+        for mins, maxs, shader in self.brushes:
+            brushes.append(struct.pack('<3i', len(sides), 6, shader))
+            # CM_BoundBrush() expects -x, +x, -y, +y, -z, +z
+            for axis in range(3):
+                sides.append(struct.pack('<2i', self.plane(axis, mins[axis]) ^ 1, shader))
+                sides.append(struct.pack('<2i', self.plane(axis, maxs[axis]), shader))
+        lumps[LUMP_BRUSHES] = b''.join(brushes)
+        lumps[LUMP_BRUSHSIDES] = b''.join(sides)
+        # planes may have been added by the brush sides
+        lumps[LUMP_PLANES] = b''.join(struct.pack('<4f', *n, d) for n, d in self.planes)
+
+        out = bytearray(struct.pack('<4si', BSP_IDENT, BSP_VERSION) + b'\0' * (8 * HEADER_LUMPS))
+        for i, data in enumerate(lumps):
+            while len(out) % 4:
+                out.append(0)
+            struct.pack_into('<2i', out, 8 + 8 * i, len(out), len(data))
+            out.extend(data)
+        return bytes(out)
+
+
+def origin(v):
+    return '%d %d %d' % tuple(v)
+
+
+def generate(args):
+    rnd = random.Random(args.seed)
+    m = Map()
+    caulk = m.shader('textures/common/caulk', CONTENTS_SOLID)
+    clip = m.shader('textures/common/clipweapmetal', CONTENTS_PLAYERCLIP)
+
+    half = args.size // 2
+    height = args.height
+    wall = 32
+    world_mins = (-half - wall, -half - wall, -wall)
+    world_maxs = (half + wall, half + wall, height + wall)
+
+    # hull
+    m.brush((-half - wall, -half - wall, -wall), (half + wall, half + wall, 0), caulk)
+    m.brush((-half - wall, -half - wall, height), (half + wall, half + wall, height + wall), caulk)
+    m.brush((-half - wall, -half - wall, 0), (-half, half + wall, height), caulk)
+    m.brush((half, -half - wall, 0), (half + wall, half + wall, height), caulk)
+    m.brush((-half, -half - wall, 0), (half, -half, height), caulk)
+    m.brush((-half, half, 0), (half, half + wall, height), caulk)
+
+    # buildings, walls and bridges on a grid, the middle of each cell stays free
+    cell = args.size // args.grid
+    free = []
+    for gx in range(args.grid):
+        for gy in range(args.grid):
+            x0 = -half + gx * cell
+            y0 = -half + gy * cell
+            kind = rnd.random()
+            if kind < 0.35:
+                w = rnd.randrange(cell // 4, cell // 2)
+                d = rnd.randrange(cell // 4, cell // 2)
+                h = rnd.randrange(96, height * 3 // 4)
+                m.brush((x0 + 16, y0 + 16, 0), (x0 + 16 + w, y0 + 16 + d, h), caulk)
+                # a floor on top with a parapet
+                m.brush((x0 + 16, y0 + 16, h), (x0 + 16 + w, y0 + 32, h + 48), caulk)
+            elif kind < 0.6:
+                if rnd.random() < 0.5:
+                    m.brush((x0, y0 + cell // 2 - 8, 0), (x0 + cell * 3 // 4, y0 + cell // 2 + 8, rnd.randrange(128, 384)), caulk)
+                else:
+                    m.brush((x0 + cell // 2 - 8, y0, 0), (x0 + cell // 2 + 8, y0 + cell * 3 // 4, rnd.randrange(128, 384)), caulk)
+            elif kind < 0.7:
+                z = rnd.randrange(160, 320)
+                m.brush((x0, y0 + cell // 2 - 64, z), (x0 + cell, y0 + cell // 2 + 64, z + 16), caulk)
+                m.brush((x0 + cell // 2 - 16, y0 + cell // 2 - 16, 0), (x0 + cell // 2 + 16, y0 + cell // 2 + 16, z), caulk)
+            free.append((x0 + cell * 3 // 4, y0 + cell * 3 // 4))
+
+    # rubble and crates
+    for _ in range(args.rubble):
+        x = rnd.randrange(-half + 64, half - 64)
+        y = rnd.randrange(-half + 64, half - 64)
+        s = rnd.randrange(8, 64)
+        h = rnd.randrange(8, 96)
+        m.brush((x - s, y - s, 0), (x + s, y + s, h), caulk if rnd.random() < 0.9 else clip)
+
+    m.world_brushes = len(m.brushes)
+    m.models.append((world_mins, world_maxs, 0, m.world_brushes))
+    m.build_tree(world_mins, world_maxs)
+
+    m.entities.append({'classname': 'worldspawn', 'message': 'synthetic test map', 'spawnflags': '0'})
+    m.entities.append({'classname': 'info_player_intermission', 'origin': origin((0, 0, height - 64))})
+    m.entities.append({'classname': 'script_multiplayer', 'scriptname': 'game_manager', 'origin': origin((0, 0, 64))})
+
+    spots = rnd.sample(free, min(len(free), 2 * args.spawns + args.doors + args.props))
+    for team, cls in ((0, 'team_CTF_redspawn'), (1, 'team_CTF_bluespawn')):
+        for i in range(args.spawns):
+            x, y = spots.pop()
+            m.entities.append({'classname': cls, 'origin': origin((x, y, 40)), 'angle': str(rnd.randrange(0, 360))})
+        m.entities.append({'classname': 'info_player_deathmatch', 'origin': origin((x, y + 48, 40))})
+
+    def submodel(classname, mins, maxs, **keys):
+        first = len(m.brushes)
+        m.brush(mins, maxs, caulk)
+        m.models.append((mins, maxs, first, 1))
+        ent = {'classname': classname, 'model': '*%d' % (len(m.models) - 1)}
+        ent.update(keys)
+        m.entities.append(ent)
+
+    # doors that open when a player comes close, lifts that go up and down
+    for i in range(args.doors):
+        x, y = spots.pop()
+        if i % 2:
+            submodel('func_door', (x - 64, y - 8, 0), (x + 64, y + 8, 128), angle='-1', speed='200', wait='2', lip='8')
+        else:
+            submodel('func_door', (x - 48, y - 48, 0), (x + 48, y + 48, 16), angle='-1', speed='100', wait='3', lip='0')
+
+    for i in range(args.props):
+        x, y = spots.pop()
+        s = rnd.randrange(16, 48)
+        if i % 2:
+            submodel('func_explosive', (x - s, y - s, 0), (x + s, y + s, 2 * s), health='100', type='wood')
+        else:
+            submodel('func_static', (x - s, y - s, 0), (x + s, y + s, 2 * s))
+
+    items = ('item_health', 'item_health_large', 'weapon_magicammo')
+    for i in range(args.items):
+        x = rnd.randrange(-half + 64, half - 64)
+        y = rnd.randrange(-half + 64, half - 64)
+        m.entities.append({'classname': items[i % len(items)], 'origin': origin((x, y, height // 2))})
+
+    return m
+
+
+# Stand-in skeleton: bone name, parent; tags name, bone
+STUB_BONES = (('tag_root', -1), ('tag_torso', 0), ('tag_neck', 1))
+STUB_TAGS = (('tag_head', 2), ('tag_footleft', 0), ('tag_footright', 0))
+
+
+def stub_mdm(path):
+    tags = b''
+    for name, bone in STUB_TAGS:
+        tag = struct.pack('<64s9f I 3f III', name.encode(), 1, 0, 0, 0, 1, 0, 0, 0, 1, bone, 0, 0, 0, 0, 0, 0)
+        tags += tag[:-4] + struct.pack('<I', len(tag))
+    hdr_size = 4 + 4 + 64 + 4 * 7
+    hdr = struct.pack('<4sI64sffIIIII', b'MDMW', 3, path.encode()[:63], 0, 1, 0, hdr_size, len(STUB_TAGS),
+                      hdr_size, hdr_size + len(tags))
+    return hdr + tags
+
+
+def stub_mdx(path, frames):
+    hdr_size = 4 + 4 + 64 + 4 * 6
+    bones = b''.join(struct.pack('<64siffI', name.encode(), parent, 1 if i else 0, 0 if parent < 0 else 16, 0)
+                     for i, (name, parent) in enumerate(STUB_BONES))
+    frame = struct.pack('<3f3f3ff3f', -16, -16, -24, 16, 16, 48, 0, 0, 0, 48, 0, 0, 0)
+    frame += struct.pack('<6h', 0, 0, 0, 0, 0, 0) * len(STUB_BONES)
+    frame_offset = hdr_size + len(bones)
+    hdr = struct.pack('<4sI64sIIIIII', b'MDXW', 2, path.encode()[:63], frames, len(STUB_BONES), frame_offset,
+                      hdr_size, 1, frame_offset + frames * len(frame))
+    return hdr + bones + frame * frames
+
+
+def player_models(mod_pk3):
+    """Stand-in .mdm and .mdx files for every model the mod's characters use."""
+    meshes, anims, files = set(), {}, {}
+    with zipfile.ZipFile(mod_pk3) as pk3:
+        for info in pk3.infolist():
+            if info.filename.endswith('.char'):
+                text = pk3.read(info).decode('latin-1')
+                meshes.update(re.findall(r'"([^"]+\.mdm)"', text))
+                for group in re.findall(r'animationgroup\s+"([^"]+)"', text):
+                    anims.setdefault(group, None)
+        for group in anims:
+            animfile, text = None, pk3.read(group).decode('latin-1')
+            for line in text.splitlines():
+                line = line.split('//')[0].split()
+                if len(line) >= 2 and line[0] == 'animfile':
+                    animfile = line[1].strip('"')
+                    files.setdefault(animfile, 1)
+                elif animfile and len(line) >= 3 and line[1].isdigit() and line[2].isdigit():
+                    files[animfile] = max(files[animfile], int(line[1]) + int(line[2]))
+    models = {path: stub_mdm(path) for path in meshes}
+    models.update({path: stub_mdx(path, frames) for path, frames in files.items()})
+    return models
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Write a synthetic test map')
+    parser.add_argument('output', help='.bsp file, or .pk3 to pack it as maps/<name>.bsp')
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--size', type=int, default=8192, help='width and length of the map')
+    parser.add_argument('--height', type=int, default=1024)
+    parser.add_argument('--grid', type=int, default=16, help='cells per side for buildings and walls')
+    parser.add_argument('--rubble', type=int, default=1500, help='small world brushes')
+    parser.add_argument('--spawns', type=int, default=8, help='spawn points per team')
+    parser.add_argument('--doors', type=int, default=24)
+    parser.add_argument('--props', type=int, default=120, help='func_static and func_explosive submodels')
+    parser.add_argument('--items', type=int, default=300)
+    parser.add_argument('--player-models', metavar='MOD_PK3',
+                        help='pack stand-in player models for the characters of this mod pk3')
+    args = parser.parse_args()
+
+    if args.grid < 1 or args.size < args.grid * 64:
+        parser.error('--size must leave at least 64 units per grid cell')
+
+    m = generate(args)
+    data = m.write()
+
+    name = os.path.splitext(os.path.basename(args.output))[0]
+    if args.output.endswith('.pk3'):
+        with zipfile.ZipFile(args.output, 'w', zipfile.ZIP_DEFLATED) as pk3:
+            pk3.writestr('maps/%s.bsp' % name, data)
+            if args.player_models:
+                for path, model in sorted(player_models(args.player_models).items()):
+                    pk3.writestr(path, model)
+    else:
+        if args.player_models:
+            parser.error('--player-models needs a .pk3 output')
+        with open(args.output, 'wb') as f:
+            f.write(data)
+
+    print('%s: %d brushes (%d world), %d submodels, %d nodes, %d leafs, %d entities' % (
+        args.output, len(m.brushes), m.world_brushes, len(m.models) - 1, len(m.nodes), len(m.leafs),
+        len(m.entities)))
+
+
+if __name__ == '__main__':
+    main()
@@ -314,6 +314,49 @@ BEGIN
 END;
 $$ LANGUAGE plpgsql;
 
+-- Change notifications for etman-server's in-memory admin tables
+-- (LISTEN admin_changed). Only changes that affect levels, overrides,
+-- bans or mutes notify; last_seen updates on every connect do not.
+CREATE OR REPLACE FUNCTION admin_notify_change()
+RETURNS TRIGGER AS $$
+BEGIN
+    IF TG_TABLE_NAME = 'admin_players' AND TG_OP = 'INSERT' THEN
+        -- New players start as guests, which the server assumes anyway
+        IF NEW.level_id IS NULL OR NEW.level_id = (SELECT id FROM admin_levels WHERE level = 0) THEN
+            RETURN NULL;
+        END IF;
+    END IF;
+
+    PERFORM pg_notify('admin_changed', TG_TABLE_NAME);
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS admin_levels_notify ON admin_levels;
+CREATE TRIGGER admin_levels_notify
+    AFTER INSERT OR UPDATE OR DELETE ON admin_levels
+    FOR EACH STATEMENT EXECUTE FUNCTION admin_notify_change();
+
+DROP TRIGGER IF EXISTS admin_players_notify ON admin_players;
+CREATE TRIGGER admin_players_notify
+    AFTER INSERT OR DELETE OR UPDATE OF level_id, guid ON admin_players
+    FOR EACH ROW EXECUTE FUNCTION admin_notify_change();
+
+DROP TRIGGER IF EXISTS admin_player_permissions_notify ON admin_player_permissions;
+CREATE TRIGGER admin_player_permissions_notify
+    AFTER INSERT OR UPDATE OR DELETE ON admin_player_permissions
+    FOR EACH STATEMENT EXECUTE FUNCTION admin_notify_change();
+
+DROP TRIGGER IF EXISTS admin_bans_notify ON admin_bans;
+CREATE TRIGGER admin_bans_notify
+    AFTER INSERT OR UPDATE OR DELETE ON admin_bans
+    FOR EACH STATEMENT EXECUTE FUNCTION admin_notify_change();
+
+DROP TRIGGER IF EXISTS admin_mutes_notify ON admin_mutes;
+CREATE TRIGGER admin_mutes_notify
+    AFTER INSERT OR UPDATE OR DELETE ON admin_mutes
+    FOR EACH STATEMENT EXECUTE FUNCTION admin_notify_change();
+
 -- Grant access to etpanel user
 GRANT ALL ON ALL TABLES IN SCHEMA public TO etpanel;
 GRANT ALL ON ALL SEQUENCES IN SCHEMA public TO etpanel;
@@ -55,6 +55,13 @@ if(BUILD_SERVER_MOD)
 	add_library(qagame MODULE ${QAGAME_SRC})
 	target_link_libraries(qagame qagame_libraries mod_libraries)
 
+	# ETPanel sender thread, persistence thread in g_db.c
+	find_package(Threads REQUIRED)
+	target_link_libraries(qagame Threads::Threads)
+	if(WIN32)
+		target_link_libraries(qagame ws2_32)
+	endif()
+
 	if(FEATURE_LUASQL AND FEATURE_DBMS)
 		target_compile_definitions(qagame PRIVATE FEATURE_DBMS FEATURE_LUASQL)
 
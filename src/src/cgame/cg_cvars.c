@@ -59,6 +59,7 @@ vmCvar_t voice_inputGain;
 vmCvar_t voice_showTalking;
 vmCvar_t voice_showMeter;
 vmCvar_t voice_serverPort;
+vmCvar_t voice_jitterBuffer;
 #endif
 vmCvar_t cg_drawStatus;
 vmCvar_t cg_animSpeed;
@@ -645,6 +646,7 @@ static cvarTable_t cvarTable[] =
 	{ &voice_showTalking,                     "voice_showTalking",                     "1",           0,                            0 },
 	{ &voice_showMeter,                       "voice_showMeter",                       "1",           0,                            0 },
 	{ &voice_serverPort,                      "voice_serverPort",                      "1",           0,                            0 },
+	{ &voice_jitterBuffer,                    "voice_jitterBuffer",                    "0",           0,                            0 },  // 0 = auto, N = fixed N x 20ms
 #endif
 };
 
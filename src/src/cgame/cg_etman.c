@@ -1587,7 +1587,8 @@ void ETMan_HandleResponse(const uint8_t *data, int dataLen)
 		break;
 
 	case VOICE_RESP_PROGRESS:
-		/* Download progress update - could show in HUD */
+		/* Download progress update, sent every few percent */
+		CG_Printf("^3ETMan: Downloading... %s%%\n", message);
 		break;
 
 	case VOICE_RESP_SHARE_REQ:
@@ -51,11 +51,35 @@
 #define VOICE_MAX_PACKET      512
 
 /*
- * Jitter buffer for smooth playback
- * 10 frames = 200ms buffer, helps smooth out network variance
+ * Adaptive jitter buffer
+ *
+ * Packets are kept undecoded in a ring indexed by sequence number and are
+ * decoded by the output callback when their frame is due, so reordered
+ * packets still play in order. A missing frame is rebuilt from the next
+ * packet's in-band FEC data if that has arrived, otherwise Opus packet
+ * loss concealment fills it.
+ *
+ * The playout delay (frames held before a stream starts playing) follows a
+ * percentile of the recent arrival jitter, plus a margin that grows when
+ * packets arrive too late and decays again while they don't.
+ * voice_jitterBuffer 0 = auto-tune (default), N = fixed N frames.
  */
-#define VOICE_JITTER_FRAMES   10
-#define VOICE_JITTER_MIN_START 5  /* Wait for 5 frames (100ms) before starting playback */
+#define VOICE_JITTER_SLOTS        32    /* Packets held per speaker (power of two) */
+#define VOICE_JITTER_MIN_DELAY    1     /* Frames */
+#define VOICE_JITTER_MAX_DELAY    12    /* 240ms */
+#define VOICE_JITTER_START_DELAY  3     /* Until enough arrivals were measured */
+#define VOICE_JITTER_HISTORY      64    /* Arrival jitter samples per speaker */
+#define VOICE_JITTER_PERCENTILE   95
+#define VOICE_JITTER_MAX_BOOST    4     /* Extra frames after late packets */
+#define VOICE_JITTER_BOOST_DECAY  5000  /* ms without late packets per frame of boost removed */
+#define VOICE_JITTER_MAX_MISSING  5     /* Concealed frames in a row before playback stops */
+#define VOICE_JITTER_SLACK        2     /* Frames above target before catching up */
+#define VOICE_JITTER_DTX_BYTES    2     /* Packets this small are silence, safe to skip */
+#define VOICE_FEC_LOSS_PERC       10    /* Loss the encoder's in-band FEC is tuned for */
+
+#define VOICE_SLOT_EMPTY          0
+#define VOICE_SLOT_WRITING        1
+#define VOICE_SLOT_READY          2
 
 /*
  * Network packet types
@@ -117,20 +141,64 @@ typedef struct
 } voiceRelayHeader_t;
 #pragma pack(pop)
 
+/*
+ * Jitter buffer slot (one received packet)
+ */
+typedef struct
+{
+	volatile uint32_t sequence;
+	volatile int      state;     // VOICE_SLOT_*
+	int               len;
+	uint8_t           data[VOICE_MAX_PACKET];
+} voiceJitterSlot_t;
+
 /*
  * Per-client decoder and jitter buffer
+ *
+ * The network side (main thread) only fills slots and publishes the stream
+ * and target delay; the output callback (audio thread) owns the decoder and
+ * the playout position. Shared fields are volatile, as for the TX limiter.
  */
 typedef struct
 {
 	OpusDecoder *decoder;
-	int16_t      jitterBuffer[VOICE_JITTER_FRAMES][VOICE_FRAME_SIZE * VOICE_CHANNELS_OUT];
-	int          jitterWrite;
-	int          jitterRead;
-	int          jitterCount;
+	voiceJitterSlot_t slots[VOICE_JITTER_SLOTS];
+
+	// Written by the network side
+	volatile int      streamId;        // Bumped when a new stream starts
+	volatile uint32_t firstSequence;
+	volatile uint32_t highSequence;    // Newest sequence received in this stream
+	volatile int      targetDelay;     // Playout delay in frames
 	uint32_t     lastSequence;
 	int          lastPacketTime;
 	qboolean     active;
-	qboolean     buffering;  /* qtrue until we have enough frames to start playback */
+
+	// Arrival jitter measurement (network side)
+	int          streamStartMs;
+	int          minTransit;
+	int          jitterHistory[VOICE_JITTER_HISTORY];
+	int          jitterCount;
+	int          jitterIndex;
+	int          jitterMs;             // Current percentile, for voicestatus
+	int          lateBoost;
+	int          lastLateMs;
+
+	// Owned by the output callback
+	int               playStreamId;
+	qboolean          playing;
+	volatile uint32_t playSequence;    // Next frame to play (read for late detection)
+	int               waitFrames;
+	int               missingRun;
+
+	// Statistics
+	volatile int statReceived;
+	volatile int statLate;             // Arrived after their frame was played
+	volatile int statDuplicate;
+	volatile int statPlayed;
+	volatile int statRecovered;        // Rebuilt from FEC
+	volatile int statConcealed;        // Filled by PLC
+	volatile int statUnderruns;        // Buffer ran dry mid-stream
+	volatile int statDropped;          // Skipped to shrink the delay
 } voiceClientDecoder_t;
 
 /*
@@ -520,6 +588,9 @@ static qboolean Voice_InitOpus(void)
 	opus_encoder_ctl(voice.encoder, OPUS_SET_COMPLEXITY(5));
 	opus_encoder_ctl(voice.encoder, OPUS_SET_SIGNAL(OPUS_SIGNAL_VOICE));
 	opus_encoder_ctl(voice.encoder, OPUS_SET_DTX(1));
+	// Each packet also carries a low-bitrate copy of the previous frame
+	opus_encoder_ctl(voice.encoder, OPUS_SET_INBAND_FEC(1));
+	opus_encoder_ctl(voice.encoder, OPUS_SET_PACKET_LOSS_PERC(VOICE_FEC_LOSS_PERC));
 
 	CG_Printf("Voice: Opus encoder initialized (%d kbps)\n", VOICE_OPUS_BITRATE / 1000);
 	return qtrue;
@@ -531,6 +602,7 @@ static qboolean Voice_InitOpus(void)
 static qboolean Voice_CreateDecoder(int clientNum)
 {
 	int error;
+	OpusDecoder *decoder;
 	voiceClientDecoder_t *dec;
 
 	if (clientNum < 0 || clientNum >= MAX_CLIENTS)
@@ -545,7 +617,7 @@ static qboolean Voice_CreateDecoder(int clientNum)
 		return qtrue;  // Already exists
 	}
 
-	dec->decoder = opus_decoder_create(VOICE_SAMPLE_RATE, VOICE_CHANNELS_OUT, &error);
+	decoder = opus_decoder_create(VOICE_SAMPLE_RATE, VOICE_CHANNELS_OUT, &error);
 	if (error != OPUS_OK)
 	{
 		CG_Printf("^1Voice: Failed to create decoder for client %d: %s\n",
@@ -553,12 +625,10 @@ static qboolean Voice_CreateDecoder(int clientNum)
 		return qfalse;
 	}
 
-	dec->jitterWrite = 0;
-	dec->jitterRead = 0;
-	dec->jitterCount = 0;
-	dec->lastSequence = 0;
-	dec->active = qfalse;
-	dec->buffering = qtrue;  /* Start in buffering mode */
+	// The output callback picks the client up once the decoder is set
+	Com_Memset(dec, 0, sizeof(*dec));
+	dec->targetDelay = VOICE_JITTER_START_DELAY;
+	dec->decoder = decoder;
 
 	return qtrue;
 }
@@ -605,6 +675,303 @@ static void Voice_ShutdownOpus(void)
 	}
 }
 
+/*
+ * Jitter buffer: recompute a speaker's playout delay (network side)
+ */
+static void Voice_JitterUpdateTarget(voiceClientDecoder_t *dec, int now)
+{
+	int sorted[VOICE_JITTER_HISTORY];
+	int i, j, v, target;
+
+	// Insertion sort; the history is small and only active speakers update
+	for (i = 0; i < dec->jitterCount; i++)
+	{
+		v = dec->jitterHistory[i];
+		for (j = i; j > 0 && sorted[j - 1] > v; j--)
+		{
+			sorted[j] = sorted[j - 1];
+		}
+		sorted[j] = v;
+	}
+	if (dec->jitterCount > 0)
+	{
+		dec->jitterMs = sorted[(dec->jitterCount - 1) * VOICE_JITTER_PERCENTILE / 100];
+	}
+
+	if (voice_jitterBuffer.integer > 0)
+	{
+		target = voice_jitterBuffer.integer;
+	}
+	else
+	{
+		if (dec->lateBoost > 0 && now - dec->lastLateMs > VOICE_JITTER_BOOST_DECAY)
+		{
+			dec->lateBoost--;
+			dec->lastLateMs = now;
+		}
+
+		if (dec->jitterCount < VOICE_JITTER_HISTORY / 4)
+		{
+			target = VOICE_JITTER_START_DELAY;
+		}
+		else
+		{
+			target = (dec->jitterMs + VOICE_FRAME_MS - 1) / VOICE_FRAME_MS;
+		}
+		target += dec->lateBoost;
+	}
+
+	if (target < VOICE_JITTER_MIN_DELAY)
+	{
+		target = VOICE_JITTER_MIN_DELAY;
+	}
+	if (target > VOICE_JITTER_MAX_DELAY)
+	{
+		target = VOICE_JITTER_MAX_DELAY;
+	}
+	dec->targetDelay = target;
+}
+
+/*
+ * Jitter buffer: start a new stream (network side)
+ * Old packets are dropped; the output callback resets the decoder when it
+ * sees the new stream id.
+ */
+static void Voice_JitterReset(voiceClientDecoder_t *dec, uint32_t seq, int now)
+{
+	int i;
+
+	for (i = 0; i < VOICE_JITTER_SLOTS; i++)
+	{
+		dec->slots[i].state = VOICE_SLOT_EMPTY;
+	}
+
+	dec->firstSequence = seq;
+	dec->highSequence = seq;
+	dec->streamStartMs = now;
+	dec->minTransit = 0;
+	dec->streamId++;
+}
+
+/*
+ * Jitter buffer: store a received packet (network side)
+ */
+static void Voice_JitterPut(voiceClientDecoder_t *dec, uint32_t seq,
+                            const uint8_t *data, int len, int now)
+{
+	voiceJitterSlot_t *slot = &dec->slots[seq & (VOICE_JITTER_SLOTS - 1)];
+	int transit;
+
+	dec->statReceived++;
+
+	// Its frame was already played (concealed): the delay is too short
+	if (dec->playStreamId == dec->streamId && (int32_t)(seq - dec->playSequence) < 0)
+	{
+		dec->statLate++;
+		if (dec->lateBoost < VOICE_JITTER_MAX_BOOST)
+		{
+			dec->lateBoost++;
+		}
+		dec->lastLateMs = now;
+		Voice_JitterUpdateTarget(dec, now);
+		return;
+	}
+
+	if (slot->state == VOICE_SLOT_READY && slot->sequence == seq)
+	{
+		dec->statDuplicate++;
+		return;
+	}
+
+	slot->state = VOICE_SLOT_WRITING;
+	slot->sequence = seq;
+	slot->len = len;
+	Com_Memcpy(slot->data, data, len);
+	slot->state = VOICE_SLOT_READY;
+
+	if ((int32_t)(seq - dec->highSequence) > 0)
+	{
+		dec->highSequence = seq;
+	}
+
+	// Arrival jitter: how much later than the earliest packet of the stream
+	transit = now - dec->streamStartMs - (int)(seq - dec->firstSequence) * VOICE_FRAME_MS;
+	if (transit < dec->minTransit)
+	{
+		dec->minTransit = transit;
+	}
+	dec->jitterHistory[dec->jitterIndex] = transit - dec->minTransit;
+	dec->jitterIndex = (dec->jitterIndex + 1) % VOICE_JITTER_HISTORY;
+	if (dec->jitterCount < VOICE_JITTER_HISTORY)
+	{
+		dec->jitterCount++;
+	}
+
+	Voice_JitterUpdateTarget(dec, now);
+}
+
+/*
+ * Jitter buffer: copy a packet out of its slot (output callback)
+ */
+static qboolean Voice_JitterTake(voiceClientDecoder_t *dec, uint32_t seq,
+                                 uint8_t *data, int *len)
+{
+	voiceJitterSlot_t *slot = &dec->slots[seq & (VOICE_JITTER_SLOTS - 1)];
+
+	if (slot->state != VOICE_SLOT_READY || slot->sequence != seq)
+	{
+		return qfalse;
+	}
+
+	*len = slot->len;
+	Com_Memcpy(data, slot->data, *len);
+
+	// The network side may have reused the slot while we copied
+	return slot->state == VOICE_SLOT_READY && slot->sequence == seq;
+}
+
+/*
+ * Jitter buffer: oldest queued sequence at or after the playout position
+ */
+static qboolean Voice_JitterFindNext(voiceClientDecoder_t *dec, uint32_t *outSeq)
+{
+	int32_t  best = -1, ahead;
+	uint32_t seq;
+	int      i;
+
+	for (i = 0; i < VOICE_JITTER_SLOTS; i++)
+	{
+		if (dec->slots[i].state != VOICE_SLOT_READY)
+		{
+			continue;
+		}
+		seq   = dec->slots[i].sequence;
+		ahead = (int32_t)(seq - dec->playSequence);
+		if (ahead >= 0 && (best < 0 || ahead < best))
+		{
+			best    = ahead;
+			*outSeq = seq;
+		}
+	}
+	return best >= 0;
+}
+
+/*
+ * Jitter buffer: pad a decoded frame (output callback)
+ */
+static qboolean Voice_JitterFinishFrame(voiceClientDecoder_t *dec, int16_t *pcm, int samples)
+{
+	if (samples <= 0)
+	{
+		return qfalse;
+	}
+	if (samples < VOICE_FRAME_SIZE)
+	{
+		Com_Memset(pcm + samples * VOICE_CHANNELS_OUT, 0,
+		           (VOICE_FRAME_SIZE - samples) * VOICE_CHANNELS_OUT * sizeof(int16_t));
+	}
+	dec->statPlayed++;
+	return qtrue;
+}
+
+/*
+ * Jitter buffer: produce the next 20ms frame of a speaker (output callback)
+ * Returns qfalse while buffering or when there is nothing to play.
+ */
+static qboolean Voice_JitterPlayout(voiceClientDecoder_t *dec, int16_t *pcm)
+{
+	uint8_t  data[VOICE_MAX_PACKET];
+	int      len, samples, depth;
+	uint32_t seq, next;
+
+	if (dec->playStreamId != dec->streamId)
+	{
+		// New stream: forget the old one, including the decoder's history.
+		// Nothing before its first packet belongs to it.
+		dec->playSequence = dec->firstSequence;
+		dec->playStreamId = dec->streamId;
+		dec->playing = qfalse;
+		dec->waitFrames = 0;
+		dec->missingRun = 0;
+		opus_decoder_ctl(dec->decoder, OPUS_RESET_STATE);
+	}
+
+	if (!dec->playing)
+	{
+		if (!Voice_JitterFindNext(dec, &seq))
+		{
+			dec->waitFrames = 0;
+			return qfalse;
+		}
+
+		// Hold the stream back by the playout delay
+		if (dec->waitFrames++ < dec->targetDelay)
+		{
+			return qfalse;
+		}
+
+		dec->playing = qtrue;
+		dec->playSequence = seq;
+	}
+
+	// More queued than needed (target shrank or a burst arrived): skip
+	// silence, or anything once the backlog gets long
+	depth = (int)(dec->highSequence - dec->playSequence) + 1;
+	if (depth > dec->targetDelay + VOICE_JITTER_SLACK &&
+	    Voice_JitterTake(dec, dec->playSequence, data, &len) &&
+	    (len <= VOICE_JITTER_DTX_BYTES || depth > VOICE_JITTER_MAX_DELAY + VOICE_JITTER_SLACK))
+	{
+		dec->playSequence++;
+		dec->statDropped++;
+	}
+
+	seq = dec->playSequence;
+	if (Voice_JitterTake(dec, seq, data, &len))
+	{
+		samples = opus_decode(dec->decoder, data, len, pcm, VOICE_FRAME_SIZE, 0);
+	}
+	else if (Voice_JitterTake(dec, seq + 1, data, &len))
+	{
+		// Lost, but the next packet carries a low-bitrate copy of it
+		samples = opus_decode(dec->decoder, data, len, pcm, VOICE_FRAME_SIZE, 1);
+		dec->statRecovered++;
+	}
+	else if (Voice_JitterFindNext(dec, &next))
+	{
+		// Hole in the stream
+		samples = opus_decode(dec->decoder, NULL, 0, pcm, VOICE_FRAME_SIZE, 0);
+		dec->statConcealed++;
+	}
+	else
+	{
+		// Buffer ran dry: conceal briefly, then wait for the next talk spurt
+		if (dec->missingRun >= VOICE_JITTER_MAX_MISSING)
+		{
+			// End of the talk spurt, the next one is not an underrun
+			dec->statConcealed += dec->missingRun;
+			dec->missingRun = 0;
+			dec->playing = qfalse;
+			dec->waitFrames = 0;
+			return qfalse;
+		}
+		samples = opus_decode(dec->decoder, NULL, 0, pcm, VOICE_FRAME_SIZE, 0);
+		dec->missingRun++;
+		dec->playSequence = seq + 1;
+		return Voice_JitterFinishFrame(dec, pcm, samples);
+	}
+
+	// Audio resumed after running dry, so that was an underrun, not the end
+	if (dec->missingRun > 0)
+	{
+		dec->statUnderruns++;
+		dec->statConcealed += dec->missingRun;
+		dec->missingRun = 0;
+	}
+
+	dec->playSequence = seq + 1;
+	return Voice_JitterFinishFrame(dec, pcm, samples);
+}
+
 /*
  * PortAudio input callback (microphone capture)
  */
@@ -747,6 +1114,7 @@ static int Voice_OutputCallback(const void *input, void *output,
 {
 	int16_t *out = (int16_t *)output;
 	int32_t mixBuffer[VOICE_FRAME_SIZE * VOICE_CHANNELS_OUT];
+	int16_t pcm[VOICE_FRAME_SIZE * VOICE_CHANNELS_OUT];
 	int i, j, numSources = 0;
 	voiceClientDecoder_t *dec;
 
@@ -773,32 +1141,16 @@ static int Voice_OutputCallback(const void *input, void *output,
 		}
 
 		dec = &voice.clients[i];
-		if (!dec->active || dec->jitterCount <= 0)
+		if (!dec->decoder || !Voice_JitterPlayout(dec, pcm))
 		{
 			continue;
 		}
 
-		/* Wait for buffer to fill before starting playback */
-		if (dec->buffering)
-		{
-			if (dec->jitterCount >= VOICE_JITTER_MIN_START)
-			{
-				dec->buffering = qfalse;  /* Buffer filled, start playing */
-			}
-			else
-			{
-				continue;  /* Still buffering, don't play yet */
-			}
-		}
-
 		// Add to mix buffer
 		for (j = 0; j < (int)(frameCount * VOICE_CHANNELS_OUT); j++)
 		{
-			mixBuffer[j] += dec->jitterBuffer[dec->jitterRead][j];
+			mixBuffer[j] += pcm[j];
 		}
-
-		dec->jitterRead = (dec->jitterRead + 1) % VOICE_JITTER_FRAMES;
-		dec->jitterCount--;
 		numSources++;
 	}
 
@@ -841,7 +1193,8 @@ static void Voice_ProcessIncoming(void)
 	voiceClientDecoder_t *dec;
 	int clientNum;
 	uint16_t opusLen;
-	int decodedSamples;
+	uint32_t seq;
+	int now;
 
 	if (voice.socket == VOICE_INVALID_SOCKET || !voice_enable.integer)
 	{
@@ -915,14 +1268,16 @@ static void Voice_ProcessIncoming(void)
 			continue;
 		}
 
-		/* If this is first packet of a new stream, reset buffering state.
+		/* If this is first packet of a new stream, reset the jitter buffer.
 		 * Detect new stream by:
 		 *   1. Not active (timed out)
 		 *   2. Gap of 200ms+ since last packet
-		 *   3. Sequence number reset (new sound started - seq goes back to 0 or small value)
-		 * Must do this BEFORE decoding so we decode into the correct slot. */
+		 *   3. Sequence number reset (new sound started - seq goes back to 0 or small value),
+		 *      i.e. behind the start of the current stream or further back than the buffer
+		 * Without the reset, old frames from the previous sound would play first. */
+		seq = ntohl(relay->sequence);
+		now = trap_Milliseconds();
 		{
-			uint32_t seq = ntohl(relay->sequence);
 			qboolean isNewStream = qfalse;
 
 			if (!dec->active)
@@ -933,60 +1288,37 @@ static void Voice_ProcessIncoming(void)
 			{
 				isNewStream = qtrue;
 			}
-			else if (seq < dec->lastSequence && dec->lastSequence - seq > 100)
+			else if ((int32_t)(seq - dec->firstSequence) < 0 ||
+			         (int32_t)(dec->lastSequence - seq) > VOICE_JITTER_SLOTS)
 			{
-				/* Sequence wrapped back (e.g., new sound started at seq 0 while
-				 * we were at seq 500). A difference > 100 indicates reset, not
-				 * just out-of-order packets. */
+				/* Sequence went back (e.g., new sound started at seq 0 while
+				 * we were at seq 500). Out-of-order packets of this stream are
+				 * never older than its first packet, and anything further back
+				 * than the buffer holds could not be played anyway. */
 				isNewStream = qtrue;
 			}
 
 			if (isNewStream)
 			{
-				/* Clear the entire jitter buffer to remove old audio data.
-				 * Without this, old frames from previous sound would play first. */
-				Com_Memset(dec->jitterBuffer, 0, sizeof(dec->jitterBuffer));
-
-				dec->jitterWrite = 0;
-				dec->jitterRead = 0;
-				dec->jitterCount = 0;
-				dec->buffering = qtrue;
-				dec->lastSequence = 0;
-
-				/* Reset Opus decoder state to clear any stale internal buffers.
-				 * This prevents garbled audio at the start of new streams. */
-				if (dec->decoder)
-				{
-					opus_decoder_ctl(dec->decoder, OPUS_RESET_STATE);
-				}
+				Voice_JitterReset(dec, seq, now);
 			}
 
 			dec->lastSequence = seq;
 		}
 
-		// Decode Opus to PCM (opus data starts after relay header)
-		decodedSamples = opus_decode(dec->decoder,
-		                             buffer + sizeof(voiceRelayHeader_t),
-		                             opusLen,
-		                             dec->jitterBuffer[dec->jitterWrite],
-		                             VOICE_FRAME_SIZE,
-		                             0);
+		// Queue the Opus data (after the relay header); the output callback decodes it
+		Voice_JitterPut(dec, seq, buffer + sizeof(voiceRelayHeader_t), opusLen, now);
 
-		if (decodedSamples > 0 && dec->jitterCount < VOICE_JITTER_FRAMES)
+		dec->active = qtrue;
+		dec->lastPacketTime = cg.time;
+
+		// Update client info for HUD
+		voice.clientInfo[clientNum].talking = qtrue;
+		voice.clientInfo[clientNum].lastPacketTime = cg.time;
+		voice.clientInfo[clientNum].channel = (voiceChannel_t)relay->channel;
+		if (!voice.clientInfo[clientNum].talkingTime)
 		{
-			dec->jitterWrite = (dec->jitterWrite + 1) % VOICE_JITTER_FRAMES;
-			dec->jitterCount++;
-			dec->active = qtrue;
-			dec->lastPacketTime = cg.time;
-
-			// Update client info for HUD
-			voice.clientInfo[clientNum].talking = qtrue;
-			voice.clientInfo[clientNum].lastPacketTime = cg.time;
-			voice.clientInfo[clientNum].channel = (voiceChannel_t)relay->channel;
-			if (!voice.clientInfo[clientNum].talkingTime)
-			{
-				voice.clientInfo[clientNum].talkingTime = cg.time;
-			}
+			voice.clientInfo[clientNum].talkingTime = cg.time;
 		}
 	}
 }
@@ -1515,6 +1847,34 @@ void Voice_Cmd_VoiceStatus_f(void)
 	CG_Printf("  Packets sent: %d\n", voice.packetsSent);
 	CG_Printf("  Packets received: %d\n", voice.packetsReceived);
 
+	if (voice_jitterBuffer.integer > 0)
+	{
+		CG_Printf("  Jitter buffer: fixed %d ms\n", voice_jitterBuffer.integer * VOICE_FRAME_MS);
+	}
+	else
+	{
+		CG_Printf("  Jitter buffer: auto (%dth percentile)\n", VOICE_JITTER_PERCENTILE);
+	}
+	for (i = 0; i < MAX_CLIENTS; i++)
+	{
+		voiceClientDecoder_t *dec = &voice.clients[i];
+		int                  lost, played;
+
+		if (!dec->decoder || !dec->statReceived)
+		{
+			continue;
+		}
+
+		lost   = dec->statRecovered + dec->statConcealed;
+		played = dec->statPlayed;
+		CG_Printf("    - %s^7: delay %d ms, jitter %d ms, loss %.1f%% (fec %d, plc %d), late %d, underruns %d, skipped %d\n",
+		          cgs.clientinfo[i].infoValid ? cgs.clientinfo[i].name : va("client %d", i),
+		          dec->targetDelay * VOICE_FRAME_MS, dec->jitterMs,
+		          played > 0 ? 100.0f * lost / played : 0.0f,
+		          dec->statRecovered, dec->statConcealed, dec->statLate,
+		          dec->statUnderruns, dec->statDropped);
+	}
+
 	CG_Printf("  Currently talking:\n");
 	for (i = 0; i < MAX_CLIENTS; i++)
 	{
@@ -169,6 +169,7 @@ extern vmCvar_t voice_inputGain;    // Microphone gain (0.0-2.0)
 extern vmCvar_t voice_showTalking;  // Show who's talking HUD (0/1)
 extern vmCvar_t voice_showMeter;    // Show input level meter (0/1)
 extern vmCvar_t voice_serverPort;   // Voice server port offset (default: 1)
+extern vmCvar_t voice_jitterBuffer; // Playout delay in 20ms frames (0 = auto)
 
 /*
  * HUD drawing (called from cg_draw.c)
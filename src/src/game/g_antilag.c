@@ -118,6 +118,203 @@ static qboolean G_AntilagSafe(gentity_t *ent)
 	return qtrue;
 }
 
+/**
+ * @brief How far head and leg boxes built by G_BuildHead() / G_BuildLeg()
+ * can stick out of the client's bounding box
+ */
+#define ANTILAG_PART_MARGIN 48.f
+
+/**
+ * @brief Allowed difference between the culled and the full trace end position (g_antilagCull 2)
+ */
+#define ANTILAG_VERIFY_EPSILON 1.f
+
+/**
+ * @brief Shot of the historical trace in progress.
+ *
+ * Rewinding a client relinks it into the world, and so does building its
+ * head and leg boxes. Doing that for every connected client on every bullet
+ * adds up at high fire rates, so with g_antilagCull only the clients whose
+ * boxes since the shot time touch the shot are rewound and get body parts.
+ */
+static struct
+{
+	qboolean active;
+	gentity_t *shooter;
+	int time;
+	vec3_t start, end;
+	vec3_t mins, maxs;              ///< trace box
+	qboolean candidate[MAX_CLIENTS];
+
+	int checked;                    ///< shots compared with g_antilagCull 2
+	int mismatches;
+} antilagRay;
+
+/**
+ * @brief Bounds of everywhere a client's hit boxes were between "time" and now
+ * @param[in] ent client entity
+ * @param[in] time shot time
+ * @param[out] absmin
+ * @param[out] absmax
+ */
+static void G_AntilagSweptBounds(gentity_t *ent, int time, vec3_t absmin, vec3_t absmax)
+{
+	vec3_t mins, maxs;
+	int    i;
+
+	// where the client is now, in case it can't be rewound
+	VectorAdd(ent->r.currentOrigin, ent->r.mins, absmin);
+	VectorAdd(ent->r.currentOrigin, ent->r.maxs, absmax);
+
+	if (G_AntilagSafe(ent))
+	{
+		// walk back until the marker G_AdjustSingleClientPosition() lerps from
+		i = ent->client->topMarker;
+		do
+		{
+			clientMarker_t *marker = &ent->client->clientMarkers[i];
+
+			VectorAdd(marker->origin, marker->mins, mins);
+			VectorAdd(marker->origin, marker->maxs, maxs);
+			AddPointToBounds(mins, absmin, absmax);
+			AddPointToBounds(maxs, absmin, absmax);
+
+			if (marker->time <= time)
+			{
+				break;
+			}
+
+			i--;
+			if (i < 0)
+			{
+				i = MAX_CLIENT_MARKERS - 1;
+			}
+		}
+		while (i != ent->client->topMarker);
+	}
+
+	for (i = 0; i < 3; i++)
+	{
+		absmin[i] -= ANTILAG_PART_MARGIN;
+		absmax[i] += ANTILAG_PART_MARGIN;
+	}
+}
+
+/**
+ * @brief Check if the shot box can touch the given bounds
+ * @param[in] absmin
+ * @param[in] absmax
+ * @return qtrue if the bounds may be hit
+ */
+static qboolean G_AntilagRayTouches(const vec3_t absmin, const vec3_t absmax)
+{
+	float enter = 0.f, leave = 1.f;
+	int   i;
+
+	// slab test of the segment against the bounds grown by the trace box
+	for (i = 0; i < 3; i++)
+	{
+		float lo    = absmin[i] - antilagRay.maxs[i];
+		float hi    = absmax[i] - antilagRay.mins[i];
+		float delta = antilagRay.end[i] - antilagRay.start[i];
+
+		if (delta == 0.f)
+		{
+			if (antilagRay.start[i] < lo || antilagRay.start[i] > hi)
+			{
+				return qfalse;
+			}
+		}
+		else
+		{
+			float t1 = (lo - antilagRay.start[i]) / delta;
+			float t2 = (hi - antilagRay.start[i]) / delta;
+
+			if (t1 > t2)
+			{
+				float tmp = t1;
+
+				t1 = t2;
+				t2 = tmp;
+			}
+			if (t1 > enter)
+			{
+				enter = t1;
+			}
+			if (t2 < leave)
+			{
+				leave = t2;
+			}
+			if (enter > leave)
+			{
+				return qfalse;
+			}
+		}
+	}
+
+	return qtrue;
+}
+
+/**
+ * @brief Start culling historical traces to the clients near a shot
+ * @param[in] ent shooter
+ * @param[in] start
+ * @param[in] mins
+ * @param[in] maxs
+ * @param[in] end
+ */
+static void G_AntilagSetRay(gentity_t *ent, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end)
+{
+	vec3_t    absmin, absmax;
+	gentity_t *list;
+	int       i;
+
+	if (!g_antilagCull.integer)
+	{
+		return;
+	}
+
+	antilagRay.active  = qtrue;
+	antilagRay.shooter = ent;
+	antilagRay.time    = ent->client->pers.cmd.serverTime > level.time ? level.time : ent->client->pers.cmd.serverTime;
+	VectorCopy(start, antilagRay.start);
+	VectorCopy(end, antilagRay.end);
+	if (mins)
+	{
+		VectorCopy(mins, antilagRay.mins);
+	}
+	else
+	{
+		VectorClear(antilagRay.mins);
+	}
+	if (maxs)
+	{
+		VectorCopy(maxs, antilagRay.maxs);
+	}
+	else
+	{
+		VectorClear(antilagRay.maxs);
+	}
+
+	for (i = 0; i < level.numConnectedClients; i++)
+	{
+		list = g_entities + level.sortedClients[i];
+
+		G_AntilagSweptBounds(list, antilagRay.time, absmin, absmax);
+		antilagRay.candidate[level.sortedClients[i]] = G_AntilagRayTouches(absmin, absmax);
+	}
+}
+
+/**
+ * @brief Check if a client takes part in the current historical trace
+ * @param[in] ent client entity
+ * @return qfalse if the client is culled away from the shot
+ */
+static qboolean G_AntilagConsidered(gentity_t *ent)
+{
+	return !antilagRay.active || antilagRay.candidate[ent - g_entities];
+}
+
 /**
  * @brief Store client entity's position and other related data which is required to shift time (B2TF)
  * @param[in,out] ent target client entity
@@ -571,8 +768,8 @@ static void G_AdjustClientPositions(gentity_t *skip, int time, qboolean backward
 	{
 		list = g_entities + level.sortedClients[i];
 
-		// dont adjust the firing client entity
-		if (list == skip)
+		// dont adjust the firing client entity, nor clients nowhere near the shot
+		if (list == skip || !G_AntilagConsidered(list))
 		{
 			continue;
 		}
@@ -684,7 +881,8 @@ static void G_AttachBodyParts(gentity_t *ent)
 		    (list != ent) &&
 		    list->r.linked &&
 		    !(list->client->ps.pm_flags & PMF_LIMBO) &&
-		    (list->client->ps.pm_type == PM_NORMAL || list->client->ps.pm_type == PM_DEAD)
+		    (list->client->ps.pm_type == PM_NORMAL || list->client->ps.pm_type == PM_DEAD) &&
+		    G_AntilagConsidered(list)
 		    )
 		{
 			list->client->tempHead = G_BuildHead(list, &refent, qtrue);
@@ -766,11 +964,15 @@ void G_HistoricalTrace(gentity_t *ent, trace_t *results, const vec3_t start, con
 		return;
 	}
 
+	G_AntilagSetRay(ent, start, mins, maxs, end);
+
 	G_AdjustClientPositions(ent, ent->client->pers.cmd.serverTime, qtrue);
 
 	G_Trace(ent, results, start, mins, maxs, end, passEntityNum, contentmask);
 
 	G_AdjustClientPositions(ent, 0, qfalse);
+
+	antilagRay.active = qfalse;
 }
 
 /**
@@ -787,6 +989,25 @@ void G_HistoricalTraceBegin(gentity_t *ent)
 	G_AdjustClientPositions(ent, ent->client->pers.cmd.serverTime, qtrue);
 }
 
+/**
+ * @brief G_HistoricalTraceBegin for traces along a single line
+ * @details Only the clients that can be on the line are rewound, see antilagRay.
+ * Traces until G_HistoricalTraceEnd() must stay on the line.
+ * @param[in] ent
+ * @param[in] start
+ * @param[in] end
+ */
+void G_HistoricalTraceBeginRay(gentity_t *ent, const vec3_t start, const vec3_t end)
+{
+	// don't do this with antilag off, or for bots
+	if (!g_antilag.integer || ent->r.svFlags & SVF_BOT)
+	{
+		return;
+	}
+	G_AntilagSetRay(ent, start, NULL, NULL, end);
+	G_AdjustClientPositions(ent, ent->client->pers.cmd.serverTime, qtrue);
+}
+
 /**
  * @brief G_HistoricalTraceEnd
  * @param[in] ent
@@ -799,6 +1020,7 @@ void G_HistoricalTraceEnd(gentity_t *ent)
 		return;
 	}
 	G_AdjustClientPositions(ent, 0, qfalse);
+	antilagRay.active = qfalse;
 }
 
 static float maxsBackup[MAX_CLIENTS] = { 0 };
@@ -820,7 +1042,8 @@ void G_AdjustClientHeight(gentity_t *ent)
 		    (client != ent) &&
 		    client->r.linked &&
 		    !(client->client->ps.pm_flags & PMF_LIMBO) &&
-		    (client->client->ps.pm_type == PM_NORMAL || client->client->ps.pm_type == PM_DEAD)
+		    (client->client->ps.pm_type == PM_NORMAL || client->client->ps.pm_type == PM_DEAD) &&
+		    G_AntilagConsidered(client)
 		    )
 		{
 			maxsBackup[level.sortedClients[i]] = client->r.maxs[2];
@@ -863,6 +1086,57 @@ void G_ResetClientHeight(void)
 	}
 }
 
+/**
+ * @brief Repeat a culled trace with every client rewound and report differences (g_antilagCull 2)
+ * @param[in] ent
+ * @param[in] culled result of the culled trace
+ * @param[in] start
+ * @param[in] mins
+ * @param[in] maxs
+ * @param[in] end
+ * @param[in] passEntityNum
+ * @param[in] contentmask
+ */
+static void G_AntilagVerify(gentity_t *ent, const trace_t *culled, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask)
+{
+	trace_t   full;
+	gentity_t *list;
+	int       i;
+
+	antilagRay.active = qfalse;
+
+	for (i = 0; i < level.numConnectedClients; i++)
+	{
+		list = g_entities + level.sortedClients[i];
+		if (list != antilagRay.shooter && !antilagRay.candidate[level.sortedClients[i]])
+		{
+			G_AdjustSingleClientPosition(list, antilagRay.time);
+		}
+	}
+
+	G_Trace(ent, &full, start, mins, maxs, end, passEntityNum, contentmask);
+
+	for (i = 0; i < level.numConnectedClients; i++)
+	{
+		list = g_entities + level.sortedClients[i];
+		if (list != antilagRay.shooter && !antilagRay.candidate[level.sortedClients[i]])
+		{
+			G_ReAdjustSingleClientPosition(list);
+		}
+	}
+
+	antilagRay.active = qtrue;
+	antilagRay.checked++;
+
+	if (full.entityNum != culled->entityNum || Distance(full.endpos, culled->endpos) > ANTILAG_VERIFY_EPSILON)
+	{
+		antilagRay.mismatches++;
+		G_Printf("antilag: culled trace hit %i at %s, full trace hit %i at %s (%i of %i shots differ)\n",
+		         culled->entityNum, vtos(culled->endpos), full.entityNum, vtos(full.endpos),
+		         antilagRay.mismatches, antilagRay.checked);
+	}
+}
+
 /**
  * @brief Run a trace without fixups (historical fixups will be done externally)
  * @param[in] ent
@@ -891,6 +1165,11 @@ void G_Trace(gentity_t *ent, trace_t *results, const vec3_t start, const vec3_t
 	POSITION_READJUST
 
 	G_DettachBodyParts();
+
+	if (antilagRay.active && g_antilagCull.integer > 1)
+	{
+		G_AntilagVerify(ent, results, start, mins, maxs, end, passEntityNum, contentmask);
+	}
 }
 
 /**
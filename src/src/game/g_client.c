@@ -2482,6 +2482,7 @@ char *ClientConnect(int clientNum, qboolean firstTime, qboolean isBot)
 
 	G_UpdateCharacter(client);
 
+	// the loads are prefetched, the client gets its data and rank a few frames later
 #ifdef FEATURE_RATING
 	if (g_skillRating.integer)
 	{
@@ -2494,22 +2495,12 @@ char *ClientConnect(int clientNum, qboolean firstTime, qboolean isBot)
 	if (g_prestige.integer && g_gametype.integer != GT_WOLF_CAMPAIGN && g_gametype.integer != GT_WOLF_STOPWATCH && g_gametype.integer != GT_WOLF_LMS)
 	{
 		G_GetClientPrestige(client);
-
-		for (i = 0; i < SK_NUM_SKILLS; i++)
-		{
-			G_SetPlayerSkill(client, i);
-		}
 	}
 #endif
 
 	if (firstTime && g_xpSaver.integer && g_gametype.integer == GT_WOLF_CAMPAIGN)
 	{
 		G_XPSaver_Load(client);
-
-		for (i = 0; i < SK_NUM_SKILLS; i++)
-		{
-			G_SetPlayerSkill(client, i);
-		}
 	}
 
 	ClientUserinfoChanged(clientNum);
@@ -2588,6 +2579,11 @@ void ClientBegin(int clientNum)
 	}
 #endif
 
+#ifdef FEATURE_DBMS
+	// xp, prestige and rating loaded on connect
+	G_DB_FlushClient(clientNum);
+#endif
+
 	if (ent->r.linked)
 	{
 		trap_UnlinkEntity(ent);
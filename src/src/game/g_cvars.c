@@ -70,6 +70,7 @@ vmCvar_t g_debugMove;
 vmCvar_t g_debugDamage;
 vmCvar_t g_debugAlloc;
 vmCvar_t g_debugBullets;
+vmCvar_t g_debugEntityIndex;
 vmCvar_t g_motd;
 #ifdef ALLOW_GSYNC
 vmCvar_t g_synchronousClients;
@@ -133,6 +134,7 @@ vmCvar_t g_soldierChargeTime;
 vmCvar_t g_covertopsChargeTime;
 
 vmCvar_t g_antilag;
+vmCvar_t g_antilagCull;
 
 vmCvar_t g_spectatorInactivity;
 vmCvar_t match_latejoin;
@@ -462,6 +464,7 @@ cvarTable_t gameCvarTable[] =
 	{ &g_debugDamage,                     "g_debugDamage",                     "0",                          CVAR_CHEAT,                                      0, qfalse, qfalse },
 	{ &g_debugAlloc,                      "g_debugAlloc",                      "0",                          0,                                               0, qfalse, qfalse },
 	{ &g_debugBullets,                    "g_debugBullets",                    "0",                          0,                                               0, qfalse, qfalse },
+	{ &g_debugEntityIndex,                "g_debugEntityIndex",                "0",                          0,                                               0, qfalse, qfalse },
 	{ &g_motd,                            "g_motd",                            "",                           CVAR_ARCHIVE,                                    0, qfalse, qfalse },
 
 	{ &voteFlags,                         "voteFlags",                         "0",                          CVAR_TEMP | CVAR_ROM | CVAR_SERVERINFO,          0, qfalse, qfalse },
@@ -488,6 +491,7 @@ cvarTable_t gameCvarTable[] =
 	{ &g_scriptName,                      "g_scriptName",                      "",                           CVAR_CHEAT,                                      0, qfalse, qfalse },
 
 	{ &g_antilag,                         "g_antilag",                         "1",                          CVAR_SERVERINFO | CVAR_ARCHIVE,                  0, qfalse, qfalse },
+	{ &g_antilagCull,                     "g_antilagCull",                     "1",                          CVAR_ARCHIVE,                                    0, qfalse, qfalse },
 
 	{ NULL,                               "P",                                 "",                           CVAR_SERVERINFO_NOUPDATE,                        0, qfalse, qfalse },
 
@@ -73,6 +73,7 @@ extern vmCvar_t g_debugMove;
 extern vmCvar_t g_debugAlloc;
 extern vmCvar_t g_debugDamage;
 extern vmCvar_t g_debugBullets;
+extern vmCvar_t g_debugEntityIndex;
 #ifdef ALLOW_GSYNC
 extern vmCvar_t g_synchronousClients;
 #endif // ALLOW_GSYNC
@@ -154,6 +155,7 @@ extern vmCvar_t g_gamestate;
 extern vmCvar_t g_swapteams;
 
 extern vmCvar_t g_antilag;
+extern vmCvar_t g_antilagCull;
 
 extern vmCvar_t refereePassword;
 extern vmCvar_t shoutcastPassword;
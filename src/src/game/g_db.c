@@ -19,13 +19,343 @@
  */
 /**
  * @file g_db.c
- * @brief Database initialization functions
+ * @brief Database initialization functions and the persistence thread
+ *
+ * XP saver, prestige and skill rating reads and writes are queued as jobs
+ * and run in order by a single persistence thread on cached prepared
+ * statements. Their results are handed back to the game in G_DB_RunFrame().
+ *
+ * Whoever runs jobs owns level.database.db. The game thread may only use the
+ * connection itself right after G_DB_Flush(), before it queues the next job.
+ * Jobs must not call any trap or print; errors are reported once they finish.
  */
 
 #ifdef FEATURE_DBMS
 #include "g_local.h"
 #include <sqlite3.h>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+#define DB_MAX_STATEMENTS   32
+#define DB_HISTOGRAM_BUCKETS 12
+
+/**
+ * @struct dbSlot_t
+ * @brief A queued job and its timestamps
+ */
+typedef struct
+{
+	dbJob_t job;
+	int64_t queued;                     ///< microseconds
+	int64_t started;
+	int64_t finished;
+	char error[128];                    ///< sqlite error if the job failed
+} dbSlot_t;
+
+/**
+ * @struct dbOpStats_t
+ * @brief Latency of one kind of job, queued to done
+ */
+typedef struct
+{
+	int count;
+	int failed;
+	int64_t totalRun;                   ///< time spent running the job
+	int64_t totalLatency;               ///< time from queueing to done
+	int64_t maxLatency;
+	int histogram[DB_HISTOGRAM_BUCKETS];
+} dbOpStats_t;
+
+/**
+ * @struct dbQueue_t
+ * @brief Job ring shared by the game and the persistence thread
+ *
+ * Slots [tail, next) are done and wait for their finish callback,
+ * [next, published) are being run and [published, head) are held back
+ * until the current batch ends.
+ */
+typedef struct
+{
+#ifdef _WIN32
+	HANDLE thread;
+	CRITICAL_SECTION lock;
+	CONDITION_VARIABLE wake;            ///< jobs were published or the thread has to quit
+	CONDITION_VARIABLE done;            ///< a job is done
+#else
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t wake;
+	pthread_cond_t done;
+#endif
+	qboolean running;                   ///< thread is up, otherwise jobs run in place
+	qboolean quit;
+
+	dbSlot_t slots[DB_MAX_JOBS];
+	unsigned int head;                  ///< game thread
+	unsigned int published;             ///< game thread, under lock
+	unsigned int next;                  ///< persistence thread, under lock
+	unsigned int tail;                  ///< game thread
+	int batch;                          ///< G_DB_BeginBatch() nesting
+	unsigned int maxPending;
+
+	const char *statementSql[DB_MAX_STATEMENTS];
+	sqlite3_stmt *statements[DB_MAX_STATEMENTS];
+	int numStatements;
+
+	dbOpStats_t stats[DB_OP_MAX];
+} dbQueue_t;
+
+static dbQueue_t db_queue;
+
+static const char *dbOpNames[DB_OP_MAX] =
+{
+	"xp load",
+	"xp store",
+	"prestige load",
+	"prestige store",
+	"rating load",
+	"rating store",
+	"begin",
+	"commit",
+	"flush wait",
+};
+
+/// upper bounds of the latency histogram buckets in microseconds, the last one is open
+static const int dbHistogramBounds[DB_HISTOGRAM_BUCKETS - 1] =
+{
+	50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000
+};
+
+#ifdef _WIN32
+#define G_DB_Lock()         EnterCriticalSection(&db_queue.lock)
+#define G_DB_Unlock()       LeaveCriticalSection(&db_queue.lock)
+#define G_DB_Wait(cond)     SleepConditionVariableCS(&db_queue.cond, &db_queue.lock, INFINITE)
+#define G_DB_Signal(cond)   WakeAllConditionVariable(&db_queue.cond)
+#else
+#define G_DB_Lock()         pthread_mutex_lock(&db_queue.lock)
+#define G_DB_Unlock()       pthread_mutex_unlock(&db_queue.lock)
+#define G_DB_Wait(cond)     pthread_cond_wait(&db_queue.cond, &db_queue.lock)
+#define G_DB_Signal(cond)   pthread_cond_broadcast(&db_queue.cond)
+#endif
+
+/**
+ * @brief Monotonic clock for the latency stats
+ * @return microseconds
+ */
+static int64_t G_DB_Microseconds(void)
+{
+#ifdef _WIN32
+	static LARGE_INTEGER frequency;
+	LARGE_INTEGER        now;
+
+	if (!frequency.QuadPart)
+	{
+		QueryPerformanceFrequency(&frequency);
+	}
+	QueryPerformanceCounter(&now);
+
+	return (int64_t)(now.QuadPart * 1000000 / frequency.QuadPart);
+#else
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+#endif
+}
+
+/**
+ * @brief Add a sample to the stats of an operation
+ * @param[in] op
+ * @param[in] run Time spent running
+ * @param[in] latency Time from queueing to done
+ * @param[in] failed
+ *
+ * @note Called with the lock held while the thread is running
+ */
+static void G_DB_AddStats(dbOp_t op, int64_t run, int64_t latency, qboolean failed)
+{
+	dbOpStats_t *stats = &db_queue.stats[op];
+	int         i;
+
+	for (i = 0; i < DB_HISTOGRAM_BUCKETS - 1 && latency >= dbHistogramBounds[i]; i++)
+	{
+	}
+
+	stats->count++;
+	stats->histogram[i]++;
+	stats->totalRun     += run;
+	stats->totalLatency += latency;
+
+	if (latency > stats->maxLatency)
+	{
+		stats->maxLatency = latency;
+	}
+	if (failed)
+	{
+		stats->failed++;
+	}
+}
+
+/**
+ * @brief Run a job on the calling thread and fill in its result
+ * @param[in,out] slot
+ */
+static void G_DB_RunSlot(dbSlot_t *slot)
+{
+	int i;
+
+	slot->started    = G_DB_Microseconds();
+	slot->job.status = slot->job.run ? slot->job.run(&slot->job) : 0;
+	slot->error[0]   = '\0';
+
+	if (slot->job.status)
+	{
+		Q_strncpyz(slot->error, sqlite3_errmsg(level.database.db), sizeof(slot->error));
+	}
+
+	// don't keep read transactions open between jobs
+	for (i = 0; i < db_queue.numStatements; i++)
+	{
+		sqlite3_reset(db_queue.statements[i]);
+	}
+
+	slot->finished = G_DB_Microseconds();
+}
+
+/**
+ * @brief Persistence thread main loop
+ */
+static void G_DB_Thread(void)
+{
+	G_DB_Lock();
+	while (1)
+	{
+		dbSlot_t *slot;
+
+		if (db_queue.next == db_queue.published)
+		{
+			if (db_queue.quit)
+			{
+				break;
+			}
+			G_DB_Wait(wake);
+			continue;
+		}
+
+		slot = &db_queue.slots[db_queue.next % DB_MAX_JOBS];
+
+		G_DB_Unlock();
+		G_DB_RunSlot(slot);
+		G_DB_Lock();
+
+		G_DB_AddStats(slot->job.op, slot->finished - slot->started, slot->finished - slot->queued, slot->job.status != 0);
+		db_queue.next++;
+		G_DB_Signal(done);
+	}
+	G_DB_Unlock();
+}
+
+#ifdef _WIN32
+/**
+ * @brief G_DB_ThreadProc
+ * @param dummy - unused
+ * @return
+ */
+static DWORD WINAPI G_DB_ThreadProc(LPVOID dummy)
+{
+	G_DB_Thread();
+	return 0;
+}
+#else
+/**
+ * @brief G_DB_ThreadProc
+ * @param dummy - unused
+ * @return
+ */
+static void *G_DB_ThreadProc(void *dummy)
+{
+	G_DB_Thread();
+	return NULL;
+}
+#endif
+
+/**
+ * @brief Start the persistence thread
+ *
+ * If it can't be started, jobs run in place on the game thread.
+ */
+static void G_DB_StartThread(void)
+{
+	Com_Memset(&db_queue, 0, sizeof(db_queue));
+
+#ifdef _WIN32
+	InitializeCriticalSection(&db_queue.lock);
+	InitializeConditionVariable(&db_queue.wake);
+	InitializeConditionVariable(&db_queue.done);
+
+	db_queue.thread  = CreateThread(NULL, 0, G_DB_ThreadProc, NULL, 0, NULL);
+	db_queue.running = (db_queue.thread != NULL);
+#else
+	pthread_mutex_init(&db_queue.lock, NULL);
+	pthread_cond_init(&db_queue.wake, NULL);
+	pthread_cond_init(&db_queue.done, NULL);
+
+	db_queue.running = (pthread_create(&db_queue.thread, NULL, G_DB_ThreadProc, NULL) == 0);
+#endif
+
+	if (!db_queue.running)
+	{
+		G_Printf("^3WARNING: database thread could not be started, running queries in place\n");
+	}
+}
+
+/**
+ * @brief Run all queued jobs, stop the persistence thread and drop the statements
+ */
+static void G_DB_StopThread(void)
+{
+	int i;
+
+	if (db_queue.running)
+	{
+		G_DB_Lock();
+		db_queue.published = db_queue.head;
+		db_queue.quit      = qtrue;
+		G_DB_Signal(wake);
+		G_DB_Unlock();
+
+#ifdef _WIN32
+		WaitForSingleObject(db_queue.thread, INFINITE);
+		CloseHandle(db_queue.thread);
+#else
+		pthread_join(db_queue.thread, NULL);
+#endif
+		db_queue.running = qfalse;
+	}
+
+	G_DB_RunFrame();
+
+#ifdef _WIN32
+	DeleteCriticalSection(&db_queue.lock);
+#else
+	pthread_cond_destroy(&db_queue.done);
+	pthread_cond_destroy(&db_queue.wake);
+	pthread_mutex_destroy(&db_queue.lock);
+#endif
+
+	for (i = 0; i < db_queue.numStatements; i++)
+	{
+		sqlite3_finalize(db_queue.statements[i]);
+	}
+	db_queue.numStatements = 0;
+}
+
 /**
  * @brief G_DB_Init
  * @return 0 if database is successfully initialized, 1 otherwise.
@@ -156,6 +486,8 @@ int G_DB_Init()
 	// initialize db - keep it open until deinit
 	level.database.initialized = 1;
 
+	G_DB_StartThread();
+
 	return 0;
 }
 
@@ -173,6 +505,9 @@ int G_DB_DeInit()
 		return 1;
 	}
 
+	// write out whatever is still queued
+	G_DB_StopThread();
+
 	// close db
 	result = sqlite3_close(level.database.db);
 	if (result != SQLITE_OK)
@@ -187,4 +522,421 @@ int G_DB_DeInit()
 
 	return 0;
 }
+
+/**
+ * @brief Get a cached prepared statement, reset and with cleared bindings
+ * @param[in] sql Statement text, cached by address so it has to be a literal
+ * @return NULL if it fails to compile
+ *
+ * @note Only for the owner of the connection, see the file description
+ */
+sqlite3_stmt *G_DB_Statement(const char *sql)
+{
+	sqlite3_stmt *stmt;
+	int          i;
+
+	for (i = 0; i < db_queue.numStatements; i++)
+	{
+		if (db_queue.statementSql[i] == sql)
+		{
+			sqlite3_reset(db_queue.statements[i]);
+			sqlite3_clear_bindings(db_queue.statements[i]);
+			return db_queue.statements[i];
+		}
+	}
+
+	if (sqlite3_prepare_v2(level.database.db, sql, -1, &stmt, NULL) != SQLITE_OK)
+	{
+		return NULL;
+	}
+
+	// cache is full, should not happen with the fixed set of queries
+	if (db_queue.numStatements == DB_MAX_STATEMENTS)
+	{
+		sqlite3_finalize(db_queue.statements[DB_MAX_STATEMENTS - 1]);
+		db_queue.numStatements--;
+	}
+
+	db_queue.statementSql[db_queue.numStatements] = sql;
+	db_queue.statements[db_queue.numStatements]   = stmt;
+	db_queue.numStatements++;
+
+	return stmt;
+}
+
+/**
+ * @brief Hand the jobs queued so far to the persistence thread
+ * @note Called with the lock held
+ */
+static void G_DB_Publish(void)
+{
+	if (db_queue.published != db_queue.head)
+	{
+		db_queue.published = db_queue.head;
+		G_DB_Signal(wake);
+	}
+}
+
+/**
+ * @brief Wait for the persistence thread to finish the published jobs
+ * @note Called with the lock held
+ */
+static void G_DB_WaitPublished(void)
+{
+	int64_t start;
+
+	if (db_queue.next == db_queue.published)
+	{
+		return;
+	}
+
+	start = G_DB_Microseconds();
+	while (db_queue.next != db_queue.published)
+	{
+		G_DB_Wait(done);
+	}
+	G_DB_AddStats(DB_OP_FLUSH, 0, G_DB_Microseconds() - start, qfalse);
+}
+
+/**
+ * @brief Queue a job
+ * @param[in] job Copied, the job data must not point to game memory
+ *
+ * Inside a batch the job waits for G_DB_EndBatch(), otherwise the
+ * persistence thread picks it up right away. Blocks only if the queue is full.
+ */
+void G_DB_Queue(const dbJob_t *job)
+{
+	dbSlot_t *slot;
+
+	if (!level.database.initialized)
+	{
+		return;
+	}
+
+	if (!db_queue.running)
+	{
+		slot         = &db_queue.slots[db_queue.head % DB_MAX_JOBS];
+		slot->job    = *job;
+		slot->queued = G_DB_Microseconds();
+		G_DB_RunSlot(slot);
+		G_DB_AddStats(job->op, slot->finished - slot->started, slot->finished - slot->queued, slot->job.status != 0);
+		db_queue.head++;
+		db_queue.published = db_queue.next = db_queue.head;
+		G_DB_RunFrame();
+		return;
+	}
+
+	if (db_queue.head - db_queue.tail == DB_MAX_JOBS)
+	{
+		G_DB_Lock();
+		G_DB_Publish();
+		G_DB_WaitPublished();
+		G_DB_Unlock();
+		G_DB_RunFrame();
+	}
+
+	slot         = &db_queue.slots[db_queue.head % DB_MAX_JOBS];
+	slot->job    = *job;
+	slot->queued = G_DB_Microseconds();
+
+	G_DB_Lock();
+	db_queue.head++;
+	if (db_queue.head - db_queue.next > db_queue.maxPending)
+	{
+		db_queue.maxPending = db_queue.head - db_queue.next;
+	}
+	if (!db_queue.batch)
+	{
+		G_DB_Publish();
+	}
+	G_DB_Unlock();
+}
+
+/**
+ * @brief Execute a statement without results
+ * @param[in] sql
+ * @return 0 if successful, 1 otherwise.
+ */
+static int G_DB_RunExec(const char *sql)
+{
+	sqlite3_stmt *sqlstmt = G_DB_Statement(sql);
+
+	if (!sqlstmt || sqlite3_step(sqlstmt) != SQLITE_DONE)
+	{
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief G_DB_RunBegin
+ * @param job - unused
+ * @return
+ */
+static int G_DB_RunBegin(dbJob_t *job)
+{
+	return G_DB_RunExec("BEGIN;");
+}
+
+/**
+ * @brief G_DB_RunCommit
+ * @param job - unused
+ * @return
+ */
+static int G_DB_RunCommit(dbJob_t *job)
+{
+	return G_DB_RunExec("COMMIT;");
+}
+
+/**
+ * @brief Start collecting jobs into one transaction
+ *
+ * The jobs are held back until the matching G_DB_EndBatch(), so the game
+ * thread can queue them while it still reads from the database.
+ */
+void G_DB_BeginBatch(void)
+{
+	if (!level.database.initialized)
+	{
+		return;
+	}
+
+	if (!db_queue.batch)
+	{
+		dbJob_t job;
+
+		Com_Memset(&job, 0, sizeof(job));
+		job.op        = DB_OP_BEGIN;
+		job.run       = G_DB_RunBegin;
+		job.clientNum = -1;
+
+		db_queue.batch++;
+		G_DB_Queue(&job);
+		return;
+	}
+
+	db_queue.batch++;
+}
+
+/**
+ * @brief Commit the jobs queued since G_DB_BeginBatch()
+ */
+void G_DB_EndBatch(void)
+{
+	dbJob_t job;
+
+	if (!level.database.initialized || !db_queue.batch)
+	{
+		return;
+	}
+
+	if (--db_queue.batch)
+	{
+		return;
+	}
+
+	Com_Memset(&job, 0, sizeof(job));
+	job.op        = DB_OP_COMMIT;
+	job.run       = G_DB_RunCommit;
+	job.clientNum = -1;
+
+	G_DB_Queue(&job);
+}
+
+/**
+ * @brief Wait until every queued job has run and finish them
+ *
+ * Afterwards the game thread may use level.database.db directly.
+ * Inside a batch the jobs queued so far are committed first, so the
+ * connection is never handed over in the middle of a transaction, and a
+ * new transaction is started for the rest of the batch.
+ */
+void G_DB_Flush(void)
+{
+	int batch;
+
+	if (!level.database.initialized || !db_queue.running)
+	{
+		return;
+	}
+
+	batch = db_queue.batch;
+	if (batch)
+	{
+		db_queue.batch = 1;
+		G_DB_EndBatch();
+	}
+
+	G_DB_Lock();
+	G_DB_Publish();
+	G_DB_WaitPublished();
+	G_DB_Unlock();
+
+	G_DB_RunFrame();
+
+	if (batch)
+	{
+		G_DB_BeginBatch();
+		db_queue.batch = batch;
+	}
+}
+
+/**
+ * @brief Make sure the loads queued for a client have been applied
+ * @param[in] clientNum
+ *
+ * Loads are queued on connect and are long done by the time the client
+ * enters the game, this only waits if the disk is very slow.
+ */
+void G_DB_FlushClient(int clientNum)
+{
+	unsigned int i;
+
+	if (!level.database.initialized)
+	{
+		return;
+	}
+
+	for (i = db_queue.tail; i != db_queue.head; i++)
+	{
+		if (db_queue.slots[i % DB_MAX_JOBS].job.clientNum == clientNum)
+		{
+			G_DB_Flush();
+			return;
+		}
+	}
+}
+
+/**
+ * @brief Return the client a finished job belongs to if it is still the same player
+ * @param[in] job
+ * @return NULL if the client has left or the slot was taken by someone else
+ */
+gclient_t *G_DB_JobClient(const dbJob_t *job)
+{
+	char      userinfo[MAX_INFO_STRING];
+	gclient_t *cl;
+
+	if (job->clientNum < 0 || job->clientNum >= level.maxclients)
+	{
+		return NULL;
+	}
+
+	cl = level.clients + job->clientNum;
+	if (cl->pers.connected == CON_DISCONNECTED)
+	{
+		return NULL;
+	}
+
+	trap_GetUserinfo(job->clientNum, userinfo, sizeof(userinfo));
+	if (Q_stricmp(Info_ValueForKey(userinfo, "cl_guid"), job->guid))
+	{
+		return NULL;
+	}
+
+	return cl;
+}
+
+/**
+ * @brief Finish the jobs the persistence thread is done with
+ *
+ * Reports errors and runs the finish callbacks on the game thread.
+ */
+void G_DB_RunFrame(void)
+{
+	unsigned int end;
+
+	if (db_queue.running)
+	{
+		G_DB_Lock();
+		end = db_queue.next;
+		G_DB_Unlock();
+	}
+	else
+	{
+		end = db_queue.next;
+	}
+
+	while (db_queue.tail != end)
+	{
+		dbSlot_t *slot = &db_queue.slots[db_queue.tail % DB_MAX_JOBS];
+
+		db_queue.tail++;
+
+		if (slot->job.status)
+		{
+			G_Printf("^3G_DB: %s failed: %s\n", dbOpNames[slot->job.op], slot->error);
+		}
+
+		if (slot->job.finish)
+		{
+			slot->job.finish(&slot->job);
+		}
+	}
+}
+
+/**
+ * @brief Print the persistence stats and reset them
+ */
+void G_DB_Stats_f(void)
+{
+	char line[MAX_STRING_CHARS];
+	int  i, j;
+
+	if (!level.database.initialized)
+	{
+		G_Printf("Database is not initialized\n");
+		return;
+	}
+
+	G_Printf("Database jobs: %s, %u pending, %u max pending\n",
+	         db_queue.running ? "persistence thread" : "in place",
+	         db_queue.head - db_queue.next, db_queue.maxPending);
+
+	Q_strncpyz(line, "                 count  fail   avg run   avg lat   max lat |", sizeof(line));
+	for (j = 0; j < DB_HISTOGRAM_BUCKETS - 1; j++)
+	{
+		Q_strcat(line, sizeof(line), dbHistogramBounds[j] < 1000 ? va(" <%3ius", dbHistogramBounds[j]) : va(" <%3gms", dbHistogramBounds[j] / 1000.0));
+	}
+	Q_strcat(line, sizeof(line), "  more\n");
+	G_Printf("%s", line);
+
+	if (db_queue.running)
+	{
+		G_DB_Lock();
+	}
+
+	for (i = 0; i < DB_OP_MAX; i++)
+	{
+		dbOpStats_t *stats = &db_queue.stats[i];
+
+		if (!stats->count)
+		{
+			continue;
+		}
+
+		Com_sprintf(line, sizeof(line), "%-15s %6i %5i %7.2fms %7.2fms %7.2fms |",
+		            dbOpNames[i], stats->count, stats->failed,
+		            stats->totalRun / (1000.0 * stats->count),
+		            stats->totalLatency / (1000.0 * stats->count),
+		            stats->maxLatency / 1000.0);
+
+		for (j = 0; j < DB_HISTOGRAM_BUCKETS; j++)
+		{
+			Q_strcat(line, sizeof(line), va(" %6i", stats->histogram[j]));
+		}
+		Q_strcat(line, sizeof(line), "\n");
+		G_Printf("%s", line);
+	}
+
+	Com_Memset(db_queue.stats, 0, sizeof(db_queue.stats));
+	db_queue.maxPending = 0;
+
+	if (db_queue.running)
+	{
+		G_DB_Unlock();
+	}
+}
 #endif
@@ -0,0 +1,330 @@
+/*
+ * ET: Legacy
+ * Copyright (C) 2012-2024 ET:Legacy team <mail@etlegacy.com>
+ *
+ * This file is part of ET: Legacy - http://www.etlegacy.com
+ *
+ * ET: Legacy is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ET: Legacy is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ET: Legacy. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file g_entindex.c
+ * @brief Hash indexes of entities by classname, targetname and scriptName
+ *
+ * G_Find() and G_FindByTargetname() used to compare the name of every entity
+ * in g_entities. Entities are now also chained in hash buckets by name, each
+ * chain sorted by entity number, so a search only visits entities whose name
+ * hashes alike and still returns them in the same order as the linear scan.
+ *
+ * The name fields are plain pointers assigned all over the game code, so the
+ * index remembers the pointer it indexed for every entity. Spawned entities
+ * are queued and indexed on the next search, once their spawn function has
+ * named them. G_FreeEntity() and the renaming helpers update the index right
+ * away, and G_EntityIndexSync() compares all pointers once per frame to pick
+ * up anything else. g_debugEntityIndex 1 checks every search against the
+ * linear scan.
+ */
+
+#include "g_local.h"
+
+#define ENTITY_INDEX_BUCKETS 512    ///< power of two
+
+/**
+ * @brief One name index
+ */
+typedef struct
+{
+	size_t fieldofs;
+	int head[ENTITY_INDEX_BUCKETS];
+	int prev[MAX_GENTITIES];
+	int next[MAX_GENTITIES];
+	int bucket[MAX_GENTITIES];             ///< -1 when the entity is not in this index
+	const char *value[MAX_GENTITIES];      ///< name the entity was indexed with
+} entityIndex_t;
+
+#define ENTITY_INDEX_NUM 3
+
+static entityIndex_t entityIndexes[ENTITY_INDEX_NUM] =
+{
+	{ FOFS(classname)  },
+	{ FOFS(targetname) },
+	{ FOFS(scriptName) },
+};
+
+// entities spawned since the last search
+static int      entityIndexDirty[MAX_GENTITIES];
+static int      entityIndexDirtyCount;
+static qboolean entityIndexIsDirty[MAX_GENTITIES];
+
+/**
+ * @brief Hash bucket of a name
+ * @param[in] name
+ * @return
+ */
+static int G_EntityIndexBucket(const char *name)
+{
+	// BG_StringHashValue ignores case like Q_stricmp does
+	return (int)((unsigned long)BG_StringHashValue(name) & (ENTITY_INDEX_BUCKETS - 1));
+}
+
+/**
+ * @brief Current name of an entity in an index
+ * @param[in] idx
+ * @param[in] ent
+ * @return NULL for free entities and entities without a name
+ */
+static const char *G_EntityIndexValue(const entityIndex_t *idx, gentity_t *ent)
+{
+	if (!ent->inuse)
+	{
+		return NULL;
+	}
+	return *(char **)((byte *)ent + idx->fieldofs);
+}
+
+/**
+ * @brief Take an entity out of an index
+ * @param[in,out] idx
+ * @param[in] num
+ */
+static void G_EntityIndexUnlink(entityIndex_t *idx, int num)
+{
+	if (idx->bucket[num] < 0)
+	{
+		return;
+	}
+
+	if (idx->prev[num] >= 0)
+	{
+		idx->next[idx->prev[num]] = idx->next[num];
+	}
+	else
+	{
+		idx->head[idx->bucket[num]] = idx->next[num];
+	}
+	if (idx->next[num] >= 0)
+	{
+		idx->prev[idx->next[num]] = idx->prev[num];
+	}
+
+	idx->bucket[num] = -1;
+	idx->value[num]  = NULL;
+}
+
+/**
+ * @brief Put an entity into an index, keeping the chain sorted by entity number
+ * @param[in,out] idx
+ * @param[in] num
+ * @param[in] value
+ */
+static void G_EntityIndexLink(entityIndex_t *idx, int num, const char *value)
+{
+	int bucket = G_EntityIndexBucket(value);
+	int prev   = -1;
+	int next   = idx->head[bucket];
+
+	while (next >= 0 && next < num)
+	{
+		prev = next;
+		next = idx->next[next];
+	}
+
+	idx->prev[num] = prev;
+	idx->next[num] = next;
+	if (prev >= 0)
+	{
+		idx->next[prev] = num;
+	}
+	else
+	{
+		idx->head[bucket] = num;
+	}
+	if (next >= 0)
+	{
+		idx->prev[next] = num;
+	}
+
+	idx->bucket[num] = bucket;
+	idx->value[num]  = value;
+}
+
+/**
+ * @brief Bring an entity's index entries up to date with its name fields
+ * @param[in] ent
+ */
+void G_EntityIndexRefresh(gentity_t *ent)
+{
+	int num = ent - g_entities;
+	int i;
+
+	for (i = 0; i < ENTITY_INDEX_NUM; i++)
+	{
+		entityIndex_t *idx   = &entityIndexes[i];
+		const char    *value = G_EntityIndexValue(idx, ent);
+
+		if (value == idx->value[num] && (value != NULL) == (idx->bucket[num] >= 0))
+		{
+			continue;
+		}
+
+		G_EntityIndexUnlink(idx, num);
+		if (value)
+		{
+			G_EntityIndexLink(idx, num, value);
+		}
+	}
+}
+
+/**
+ * @brief Queue a newly spawned entity, it gets indexed on the next search
+ * @param[in] ent
+ */
+void G_EntityIndexSpawned(gentity_t *ent)
+{
+	int num = ent - g_entities;
+
+	if (entityIndexIsDirty[num])
+	{
+		return;
+	}
+
+	entityIndexIsDirty[num]                   = qtrue;
+	entityIndexDirty[entityIndexDirtyCount++] = num;
+}
+
+/**
+ * @brief Index all queued entities
+ */
+static void G_EntityIndexFlush(void)
+{
+	int i;
+
+	for (i = 0; i < entityIndexDirtyCount; i++)
+	{
+		entityIndexIsDirty[entityIndexDirty[i]] = qfalse;
+		G_EntityIndexRefresh(&g_entities[entityIndexDirty[i]]);
+	}
+	entityIndexDirtyCount = 0;
+}
+
+/**
+ * @brief Empty all indexes, called when g_entities is cleared for a new level
+ */
+void G_EntityIndexReset(void)
+{
+	int i;
+
+	for (i = 0; i < ENTITY_INDEX_NUM; i++)
+	{
+		Com_Memset(entityIndexes[i].head, -1, sizeof(entityIndexes[i].head));
+		Com_Memset(entityIndexes[i].bucket, -1, sizeof(entityIndexes[i].bucket));
+		Com_Memset(entityIndexes[i].value, 0, sizeof(entityIndexes[i].value));
+	}
+
+	Com_Memset(entityIndexIsDirty, 0, sizeof(entityIndexIsDirty));
+	entityIndexDirtyCount = 0;
+}
+
+/**
+ * @brief Pick up name changes the index was not told about, called once per frame
+ */
+void G_EntityIndexSync(void)
+{
+	int i;
+
+	G_EntityIndexFlush();
+
+	for (i = 0; i < level.num_entities; i++)
+	{
+		G_EntityIndexRefresh(&g_entities[i]);
+	}
+}
+
+/**
+ * @brief Index searched by G_Find() for a field
+ * @param[in] fieldofs
+ * @return NULL if the field is not indexed
+ */
+static entityIndex_t *G_EntityIndexForField(size_t fieldofs)
+{
+	int i;
+
+	for (i = 0; i < ENTITY_INDEX_NUM; i++)
+	{
+		if (entityIndexes[i].fieldofs == fieldofs)
+		{
+			return &entityIndexes[i];
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief Check if G_EntityIndexFind() can search a field
+ * @param[in] fieldofs
+ * @return
+ */
+qboolean G_EntityIndexed(size_t fieldofs)
+{
+	return G_EntityIndexForField(fieldofs) != NULL;
+}
+
+/**
+ * @brief Indexed G_Find()
+ * @param[in] from entity to continue after, NULL to start from the beginning
+ * @param[in] fieldofs FOFS(classname), FOFS(targetname) or FOFS(scriptName)
+ * @param[in] match
+ * @return Next entity with the name, NULL if there is none
+ */
+gentity_t *G_EntityIndexFind(gentity_t *from, size_t fieldofs, const char *match)
+{
+	entityIndex_t *idx = G_EntityIndexForField(fieldofs);
+	int           after, bucket, num;
+
+	if (!idx)
+	{
+		return NULL;
+	}
+
+	G_EntityIndexFlush();
+
+	after  = from ? (int)(from - g_entities) : -1;
+	bucket = G_EntityIndexBucket(match);
+
+	// a G_Find() loop continues after the entity it got last time, which is
+	// still in the chain unless it was renamed or freed meanwhile
+	num = (after >= 0 && idx->bucket[after] == bucket) ? idx->next[after] : idx->head[bucket];
+
+	for ( ; num >= 0; num = idx->next[num])
+	{
+		const char *value;
+
+		if (num <= after)
+		{
+			continue;
+		}
+		if (num >= level.num_entities)
+		{
+			break;
+		}
+
+		// compare the live name, the entity may have been renamed since it was indexed
+		value = G_EntityIndexValue(idx, &g_entities[num]);
+		if (value && !Q_stricmp(value, match))
+		{
+			return &g_entities[num];
+		}
+	}
+
+	return NULL;
+}
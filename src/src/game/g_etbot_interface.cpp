@@ -32,6 +32,7 @@
 
 #include <sstream>
 #include <iomanip>
+#include <chrono>
 
 extern "C"
 {
@@ -1328,23 +1329,31 @@ static void ReTransmitWeapons(const gentity_t *bot)
 #define MAX_SMOKE_RADIUS_TIME 10000.0f
 #define UNAFFECTED_BY_SMOKE_DIST Square(100)
 
-gentity_t *Bot_EntInvisibleBySmokeBomb(vec3_t start, vec3_t end)
+struct BotSmokeVolume
 {
-	// if the target is close enough, vision is not affected by smoke bomb
-	if (DistanceSquared(start, end) < UNAFFECTED_BY_SMOKE_DIST)
+	gentity_t *ent;
+	vec3_t center;
+	float radiusSq;
+};
+
+static BotSmokeVolume s_SmokeVolumes[MAX_SMOKEGREN_CACHE];
+static int            s_NumSmokeVolumes  = 0;
+static int            s_SmokeVolumesTime = -1;
+
+// the smoke cache only changes between frames, so the volumes that
+// can block vision are gathered once per frame for all traces
+static void Bot_GatherSmokeVolumes()
+{
+	if (s_SmokeVolumesTime == level.time)
 	{
-		//pfnPrintMessage("within unaffected dist");
-		return 0;
+		return;
 	}
+	s_SmokeVolumesTime = level.time;
+	s_NumSmokeVolumes  = 0;
 
-	gentity_t *ent = NULL;
-	vec3_t smokeCenter;
-	float smokeRadius;
-
-	//while (ent = G_FindSmokeBomb( ent ))
 	for (int i = 0; i < MAX_SMOKEGREN_CACHE; ++i)
 	{
-		ent = g_SmokeGrenadeCache[i];
+		gentity_t *ent = g_SmokeGrenadeCache[i];
 		if (!ent)
 		{
 			continue;
@@ -1357,33 +1366,133 @@ gentity_t *Bot_EntInvisibleBySmokeBomb(vec3_t start, vec3_t end)
 			// and CG_RenderSmokeGrenadeSmoke
 			continue;
 		}
-		// check the distance
-		VectorCopy(ent->s.pos.trBase, smokeCenter);
-		// raise the center to better match the position of the smoke, see
-		// CG_SpawnSmokeSprite().
-		smokeCenter[2] += 32;
+
 		// smoke sprite has a maximum radius of 640/2. and it takes a while for it to
 		// reach that size, so adjust the radius accordingly.
-		smokeRadius = MAX_SMOKE_RADIUS * ((level.time - ent->grenadeExplodeTime) / MAX_SMOKE_RADIUS_TIME);
+		float smokeRadius = MAX_SMOKE_RADIUS * ((level.time - ent->grenadeExplodeTime) / MAX_SMOKE_RADIUS_TIME);
 		if (smokeRadius > MAX_SMOKE_RADIUS)
 		{
 			smokeRadius = MAX_SMOKE_RADIUS;
 		}
-		// if distance from line is short enough, vision is blocked by smoke
+		if (smokeRadius <= 0.f)
+		{
+			continue;
+		}
+
+		BotSmokeVolume &volume = s_SmokeVolumes[s_NumSmokeVolumes++];
+		volume.ent = ent;
+		// raise the center to better match the position of the smoke, see
+		// CG_SpawnSmokeSprite().
+		VectorCopy(ent->s.pos.trBase, volume.center);
+		volume.center[2] += 32;
+		volume.radiusSq   = smokeRadius * smokeRadius;
+	}
+}
+
+// every ray the bots ask for, including the ones answered by the PVS or
+// smoke checks without a trace, see Bot_Interface_TraceStats_f
+struct BotTraceStats
+{
+	int frameTime;          ///< level.time of the frame being counted
+	int frameRays;
+	long long frameUsec;
+
+	int frames;             ///< frames with at least one bot trace
+	int rays;
+	int outOfPVS;
+	int smokeBlocked;
+	int maxFrameRays;
+	long long usec;
+	long long maxFrameUsec;
+};
+
+static BotTraceStats s_BotTraceStats = { -1 };
+
+static void Bot_TraceStatsEndFrame()
+{
+	BotTraceStats &stats = s_BotTraceStats;
+
+	if (stats.frameRays)
+	{
+		stats.frames++;
+		stats.maxFrameRays = MAX(stats.maxFrameRays, stats.frameRays);
+		stats.maxFrameUsec = MAX(stats.maxFrameUsec, stats.frameUsec);
+	}
+	stats.frameTime = level.time;
+	stats.frameRays = 0;
+	stats.frameUsec = 0;
+}
+
+// counts one bot ray and the time spent on it, from construction to destruction
+class BotTraceTimer
+{
+public:
+	BotTraceTimer() : m_Start(std::chrono::steady_clock::now())
+	{
+	}
+
+	~BotTraceTimer()
+	{
+		BotTraceStats   &stats = s_BotTraceStats;
+		const long long usec   = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_Start).count();
 
-		if (DistanceFromLineSquared(smokeCenter, start, end) < (smokeRadius * smokeRadius))
+		if (stats.frameTime != level.time)
 		{
-			//// if smoke is farther, we're less sensitive to being hidden.
+			Bot_TraceStatsEndFrame();
+		}
+		stats.rays++;
+		stats.frameRays++;
+		stats.usec      += usec;
+		stats.frameUsec += usec;
+	}
+
+private:
+	std::chrono::steady_clock::time_point m_Start;
+};
+
+void Bot_Interface_TraceStats_f(void)
+{
+	BotTraceStats &stats = s_BotTraceStats;
+
+	Bot_TraceStatsEndFrame();
+
+	if (!stats.frames)
+	{
+		G_Printf("No bot traces since the last report.\n");
+		return;
+	}
+
+	G_Printf("Bot traces over %i frames:\n", stats.frames);
+	G_Printf("  rays         %i (%.1f per frame, max %i)\n", stats.rays, stats.rays / (float)stats.frames, stats.maxFrameRays);
+	G_Printf("  out of PVS   %i\n", stats.outOfPVS);
+	G_Printf("  smoke        %i\n", stats.smokeBlocked);
+	G_Printf("  time         %lld usec (%.1f per frame, max %lld, %.2f per ray)\n", stats.usec, stats.usec / (double)stats.frames,
+	         stats.maxFrameUsec, stats.usec / (double)stats.rays);
+
+	Com_Memset(&stats, 0, sizeof(stats));
+	stats.frameTime = level.time;
+}
+
+gentity_t *Bot_EntInvisibleBySmokeBomb(vec3_t start, vec3_t end)
+{
+	// if the target is close enough, vision is not affected by smoke bomb
+	if (DistanceSquared(start, end) < UNAFFECTED_BY_SMOKE_DIST)
+	{
+		//pfnPrintMessage("within unaffected dist");
+		return 0;
+	}
 
-			//const float DistToEnd = VectorDistanceSquared(start,end);
-			//const float DistToSmoke = VectorDistanceSquared(start,smokeCenter);
+	Bot_GatherSmokeVolumes();
 
+	for (int i = 0; i < s_NumSmokeVolumes; ++i)
+	{
+		// if distance from line is short enough, vision is blocked by smoke
+		if (DistanceFromLineSquared(s_SmokeVolumes[i].center, start, end) < s_SmokeVolumes[i].radiusSq)
+		{
 			//g_InterfaceFunctions->DebugLine(smokeCenter, end,obColor(0,255,0),0.2f);
 			//pfnPrintMessage("hid by smoke");
-			return ent;
+			return s_SmokeVolumes[i].ent;
 		}
-		//pfnAddTempDisplayLine(smokeCenter, start, fColorRed);
-		//g_InterfaceFunctions->DebugLine(smokeCenter, end,obColor(255,0,0),0.2f);
 	}
 
 	return 0;
@@ -2568,109 +2677,143 @@ public:
 		return trap_InPVS(_pos, _target) ? True : False;
 	}
 
-	obResult TraceLine(obTraceResult &_result, const float _start[3], const float _end[3],
-	                   const AABB *_pBBox, int _mask, int _user, obBool _bUsePVS) override
+	static int TraceMaskBotToGame(int _mask)
 	{
-		qboolean bInPVS = _bUsePVS ? trap_InPVS(_start, _end) : qtrue;
-		if (bInPVS)
+		int iMask = 0;
+
+		// Set up the collision masks
+		if (_mask & TR_MASK_ALL)
 		{
-			int iMask = 0;
+			return MASK_ALL;
+		}
 
-			// Set up the collision masks
-			if (_mask & TR_MASK_ALL)
-			{
-				iMask = MASK_ALL;
-			}
-			else
-			{
-				if (_mask & TR_MASK_SOLID)
-				{
-					iMask |= MASK_SOLID;
-				}
-				if (_mask & TR_MASK_PLAYER)
-				{
-					iMask |= MASK_PLAYERSOLID;
-				}
-				if (_mask & TR_MASK_SHOT)
-				{
-					iMask |= MASK_SHOT;
-				}
-				if (_mask & TR_MASK_OPAQUE)
-				{
-					iMask |= MASK_OPAQUE;
-				}
-				if (_mask & TR_MASK_WATER)
-				{
-					iMask |= MASK_WATER;
-				}
-				if (_mask & TR_MASK_PLAYERCLIP)
-				{
-					iMask |= CONTENTS_PLAYERCLIP;
-				}
-				if (_mask & (TR_MASK_FLOODFILL | TR_MASK_FLOODFILLENT))
-				{
-					iMask |= CONTENTS_PLAYERCLIP | CONTENTS_SOLID;
-				}
+		if (_mask & TR_MASK_SOLID)
+		{
+			iMask |= MASK_SOLID;
+		}
+		if (_mask & TR_MASK_PLAYER)
+		{
+			iMask |= MASK_PLAYERSOLID;
+		}
+		if (_mask & TR_MASK_SHOT)
+		{
+			iMask |= MASK_SHOT;
+		}
+		if (_mask & TR_MASK_OPAQUE)
+		{
+			iMask |= MASK_OPAQUE;
+		}
+		if (_mask & TR_MASK_WATER)
+		{
+			iMask |= MASK_WATER;
+		}
+		if (_mask & TR_MASK_PLAYERCLIP)
+		{
+			iMask |= CONTENTS_PLAYERCLIP;
+		}
+		if (_mask & (TR_MASK_FLOODFILL | TR_MASK_FLOODFILLENT))
+		{
+			iMask |= CONTENTS_PLAYERCLIP | CONTENTS_SOLID;
+		}
+		return iMask;
+	}
 
-				if (_mask & TR_MASK_SMOKEBOMB)
-				{
-					gentity_t *pSmokeBlocker = Bot_EntInvisibleBySmokeBomb((float *)_start, (float *)_end);
-					if (pSmokeBlocker)
-					{
-						_result.m_Fraction = 0.0f;
-						_result.m_HitEntity = HandleFromEntity(pSmokeBlocker);
-						return Success;
-					}
-				}
-			}
+	static void TraceResultGameToBot(obTraceResult &_result, const trace_t &tr)
+	{
+		if ((tr.entityNum != ENTITYNUM_WORLD) && (tr.entityNum != ENTITYNUM_NONE))
+		{
+			_result.m_HitEntity = HandleFromEntity(&g_entities[tr.entityNum]);
+		}
+		else
+		{
+			_result.m_HitEntity.Reset();
+		}
 
-			trace_t tr;
+		//_result.m_iUser1 = tr.surfaceFlags;
 
-			if (_mask & TR_MASK_FLOODFILL)
-			{
-				trap_TraceNoEnts(&tr, _start,
-				                 _pBBox ? _pBBox->m_Mins : NULL,
-				                 _pBBox ? _pBBox->m_Maxs : NULL,
-				                 _end, _user, iMask);
-			}
-			else
-			{
-				trap_Trace(&tr, _start,
-				           _pBBox ? _pBBox->m_Mins : NULL,
-				           _pBBox ? _pBBox->m_Maxs : NULL,
-				           _end, _user, iMask);
-			}
+		// Fill in the bot traceflag.
+		_result.m_Fraction = tr.fraction;
+		_result.m_StartSolid = tr.startsolid;
+		_result.m_Endpos[0] = tr.endpos[0];
+		_result.m_Endpos[1] = tr.endpos[1];
+		_result.m_Endpos[2] = tr.endpos[2];
+		_result.m_Normal[0] = tr.plane.normal[0];
+		_result.m_Normal[1] = tr.plane.normal[1];
+		_result.m_Normal[2] = tr.plane.normal[2];
+		_result.m_Contents = obUtilBotContentsFromGameContents(tr.contents);
+		_result.m_Surface = obUtilBotSurfaceFromGameSurface(tr.surfaceFlags);
+	}
 
-			if ((tr.entityNum != ENTITYNUM_WORLD) && (tr.entityNum != ENTITYNUM_NONE))
-			{
-				_result.m_HitEntity = HandleFromEntity(&g_entities[tr.entityNum]);
-			}
-			else
-			{
-				_result.m_HitEntity.Reset();
-			}
+	// fills in the result of a smoke-masked ray that a smoke bomb blocks
+	static bool TraceSmokeBlocked(obTraceResult &_result, obResult &_status, const float _start[3], const float _end[3],
+	                              int _mask, obBool _bUsePVS)
+	{
+		if (!(_mask & TR_MASK_SMOKEBOMB) || (_mask & TR_MASK_ALL))
+		{
+			return false;
+		}
 
-			//_result.m_iUser1 = tr.surfaceFlags;
+		gentity_t *pSmokeBlocker = Bot_EntInvisibleBySmokeBomb((float *)_start, (float *)_end);
+		if (!pSmokeBlocker)
+		{
+			return false;
+		}
 
-			// Fill in the bot traceflag.
-			_result.m_Fraction = tr.fraction;
-			_result.m_StartSolid = tr.startsolid;
-			_result.m_Endpos[0] = tr.endpos[0];
-			_result.m_Endpos[1] = tr.endpos[1];
-			_result.m_Endpos[2] = tr.endpos[2];
-			_result.m_Normal[0] = tr.plane.normal[0];
-			_result.m_Normal[1] = tr.plane.normal[1];
-			_result.m_Normal[2] = tr.plane.normal[2];
-			_result.m_Contents = obUtilBotContentsFromGameContents(tr.contents);
-			_result.m_Surface = obUtilBotSurfaceFromGameSurface(tr.surfaceFlags);
+		if (_bUsePVS && !trap_InPVS(_start, _end))
+		{
+			_result.m_Fraction = 0.0f;
+			_result.m_HitEntity.Reset();
+			_status = OutOfPVS;
 		}
 		else
+		{
+			_result.m_Fraction = 0.0f;
+			_result.m_HitEntity = HandleFromEntity(pSmokeBlocker);
+			_status = Success;
+		}
+		return true;
+	}
+
+	obResult TraceLine(obTraceResult &_result, const float _start[3], const float _end[3],
+	                   const AABB *_pBBox, int _mask, int _user, obBool _bUsePVS) override
+	{
+		BotTraceTimer timer;
+		obResult      status;
+
+		if (TraceSmokeBlocked(_result, status, _start, _end, _mask, _bUsePVS))
+		{
+			s_BotTraceStats.smokeBlocked++;
+			return status;
+		}
+
+		if (_bUsePVS && !trap_InPVS(_start, _end))
 		{
 			// Not in PVS
 			_result.m_Fraction = 0.0f;
 			_result.m_HitEntity.Reset();
+			s_BotTraceStats.outOfPVS++;
+			return OutOfPVS;
 		}
-		return bInPVS ? Success : OutOfPVS;
+
+		trace_t tr;
+
+		if (_mask & TR_MASK_FLOODFILL)
+		{
+			trap_TraceNoEnts(&tr, _start,
+			                 _pBBox ? _pBBox->m_Mins : NULL,
+			                 _pBBox ? _pBBox->m_Maxs : NULL,
+			                 _end, _user, TraceMaskBotToGame(_mask));
+		}
+		else
+		{
+			trap_Trace(&tr, _start,
+			           _pBBox ? _pBBox->m_Mins : NULL,
+			           _pBBox ? _pBBox->m_Maxs : NULL,
+			           _end, _user, TraceMaskBotToGame(_mask));
+		}
+
+		TraceResultGameToBot(_result, tr);
+		return Success;
 	}
 
 	int GetPointContents(const float _pos[3]) override
@@ -4716,7 +4859,10 @@ public:
 			{
 				trace_t tr;
 				vec3_t end = { pMsg->m_Position[0], pMsg->m_Position[1], (pMsg->m_Position[2] + 4096) };
-				trap_Trace(&tr, pMsg->m_Position, nullptr, nullptr, end, -1, MASK_SOLID);
+				{
+					BotTraceTimer timer;
+					trap_Trace(&tr, pMsg->m_Position, nullptr, nullptr, end, -1, MASK_SOLID);
+				}
 
 				if ((tr.fraction < 1.0) && !(tr.surfaceFlags & SURF_NOIMPACT))
 				{
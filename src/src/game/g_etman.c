@@ -35,6 +35,39 @@ static qboolean etman_pending_quick[MAX_CLIENTS];
 static char     etman_pending_chat[MAX_CLIENTS][MAX_SAY_TEXT];
 static int      etman_pending_mode[MAX_CLIENTS];
 
+/*
+ * Game state channel
+ *
+ * etman-server used to ask for the map and times with blocking rcon /
+ * getstatus queries. Instead the state is pushed from here: a record goes
+ * out whenever its value changes, and everything is resent every
+ * GAME_STATE_HEARTBEAT_MS or when etman-server asks (it lost a packet or
+ * was restarted). The last sent values are kept to find the changes.
+ */
+typedef struct
+{
+	qboolean connected;
+	int team;
+	char guid[ADMIN_GUID_LEN + 1];
+	char name[MAX_NETNAME];
+} etmanSlotState_t;
+
+static struct
+{
+	char mapname[MAX_QPATH];
+	int timelimitMs;
+	int gamestate;
+	int round;
+	etmanSlotState_t slots[MAX_CLIENTS];
+
+	qboolean forceFull;
+	int nextHeartbeat;                  ///< level.time of the next full resend
+	uint16_t seq;
+
+	uint8_t packet[GAME_STATE_MAX_PACKET];
+	int len;
+} etman_state;
+
 /*
  * Packet structures (must match etman-server/admin/admin.h)
  */
@@ -115,6 +148,10 @@ void G_ETMan_Init(void)
 	etman_server_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
 	etman_server_addr.sin_port = htons(port);
 
+	// everything is new to etman-server after a map change
+	memset(&etman_state, 0, sizeof(etman_state));
+	etman_state.forceFull = qtrue;
+
 	etman_initialized = qtrue;
 	G_Printf("[ETMan] Admin commands enabled - connecting to localhost:%d\n", port);
 #else
@@ -325,6 +362,144 @@ static void ETMan_HandleAction(AdminActionPacket *action)
 	}
 }
 
+/**
+ * @brief Send the pending game state packet, if it holds any records
+ */
+static void ETMan_StateFlush(void)
+{
+	if (etman_state.len > 3)
+	{
+		ETMan_SendPacket(etman_state.packet, etman_state.len);
+	}
+	etman_state.len = 0;
+}
+
+/**
+ * @brief Make room for a record, starting a new packet when needed
+ * @return Write position in the packet
+ */
+static uint8_t *ETMan_StateRecord(int len)
+{
+	if (etman_state.len && etman_state.len + len > GAME_STATE_MAX_PACKET)
+	{
+		ETMan_StateFlush();
+	}
+	if (!etman_state.len)
+	{
+		etman_state.packet[0] = PKT_GAME_STATE;
+		etman_state.packet[1] = (uint8_t)(etman_state.seq >> 8);
+		etman_state.packet[2] = (uint8_t)etman_state.seq;
+		etman_state.seq++;
+		etman_state.len = 3;
+	}
+
+	etman_state.len += len;
+	return &etman_state.packet[etman_state.len - len];
+}
+
+/**
+ * @brief Store a 32-bit value in network byte order
+ */
+static uint8_t *ETMan_StatePutLong(uint8_t *p, int value)
+{
+	uint32_t v = (uint32_t)value;
+
+	p[0] = (uint8_t)(v >> 24);
+	p[1] = (uint8_t)(v >> 16);
+	p[2] = (uint8_t)(v >> 8);
+	p[3] = (uint8_t)v;
+	return p + 4;
+}
+
+/**
+ * @brief Push what changed in the map, level times and roster to etman-server
+ */
+static void ETMan_SendState(void)
+{
+	char     mapname[MAX_QPATH];
+	qboolean full;
+	int      timelimitMs;
+	int      i, len;
+	uint8_t  *p;
+
+	full = etman_state.forceFull || level.time >= etman_state.nextHeartbeat;
+	if (full)
+	{
+		etman_state.forceFull     = qfalse;
+		etman_state.nextHeartbeat = level.time + GAME_STATE_HEARTBEAT_MS;
+	}
+
+	trap_Cvar_VariableStringBuffer("mapname", mapname, sizeof(mapname));
+	if (full || strcmp(mapname, etman_state.mapname))
+	{
+		Q_strncpyz(etman_state.mapname, mapname, sizeof(etman_state.mapname));
+		len    = strlen(mapname);
+		p      = ETMan_StateRecord(GAME_STATE_MAP_LEN(len));
+		*p++   = GAME_STATE_REC_MAP;
+		*p++   = (uint8_t)len;
+		memcpy(p, mapname, len);
+	}
+
+	// elapsed time keeps running on the other side, only changes of pace are sent
+	timelimitMs = (int)(g_timelimit.value * 60000.f);
+	if (full || timelimitMs != etman_state.timelimitMs || g_gamestate.integer != etman_state.gamestate
+	    || g_currentRound.integer != etman_state.round)
+	{
+		etman_state.timelimitMs = timelimitMs;
+		etman_state.gamestate   = g_gamestate.integer;
+		etman_state.round       = g_currentRound.integer;
+
+		p    = ETMan_StateRecord(GAME_STATE_LEVEL_LEN);
+		*p++ = GAME_STATE_REC_LEVEL;
+		p    = ETMan_StatePutLong(p, level.timeCurrent - level.startTime);
+		p    = ETMan_StatePutLong(p, timelimitMs);
+		*p++ = (uint8_t)g_gamestate.integer;
+		*p   = (uint8_t)g_currentRound.integer;
+	}
+
+	for (i = 0; i < level.maxclients; i++)
+	{
+		gclient_t        *cl   = &level.clients[i];
+		etmanSlotState_t *last = &etman_state.slots[i];
+		qboolean         connected = cl->pers.connected == CON_CONNECTED;
+
+		if (!full && connected == last->connected
+		    && (!connected || (cl->sess.sessionTeam == last->team && !strcmp(cl->pers.cl_guid, last->guid)
+		                       && !strcmp(cl->pers.netname, last->name))))
+		{
+			continue;
+		}
+
+		last->connected = connected;
+		if (!connected)
+		{
+			p    = ETMan_StateRecord(GAME_STATE_LEFT_LEN);
+			*p++ = GAME_STATE_REC_PLAYER;
+			*p++ = (uint8_t)i;
+			*p   = 0;
+			continue;
+		}
+
+		last->team = cl->sess.sessionTeam;
+		Q_strncpyz(last->guid, cl->pers.cl_guid, sizeof(last->guid));
+		Q_strncpyz(last->name, cl->pers.netname, sizeof(last->name));
+
+		len  = strlen(last->name);
+		p    = ETMan_StateRecord(GAME_STATE_PLAYER_LEN(len));
+		*p++ = GAME_STATE_REC_PLAYER;
+		*p++ = (uint8_t)i;
+		*p++ = 1;
+		*p++ = (uint8_t)last->team;
+		memset(p, 0, ADMIN_GUID_LEN);
+		memcpy(p, last->guid, strlen(last->guid));
+		p   += ADMIN_GUID_LEN;
+		*p++ = (uint8_t)len;
+		memcpy(p, last->name, len);
+	}
+
+	ETMan_StateFlush();
+}
+
 /**
  * @brief Frame processing - check for responses from etman-server
  */
@@ -375,6 +550,10 @@ void G_ETMan_Frame(void)
 			}
 			break;
 
+		case PKT_GAME_STATE_REQUEST:
+			etman_state.forceFull = qtrue;
+			break;
+
 		case VOICE_RESP_QUICK_FOUND:
 		{
 			/* Quick command was found - play sound and optionally send chat text
@@ -450,6 +629,8 @@ void G_ETMan_Frame(void)
 			break;
 		}
 	}
+
+	ETMan_SendState();
 #endif
 }
 
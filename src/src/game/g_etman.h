@@ -19,6 +19,26 @@
 #define PKT_ADMIN_ACTION        0x42  /* Action for qagame to execute */
 #define PKT_PLAYER_LIST         0x43  /* Full player list sync */
 #define PKT_PLAYER_UPDATE       0x44  /* Single player connect/disconnect */
+#define PKT_GAME_STATE          0x45  /* Game state delta: <seq:2> then records */
+#define PKT_GAME_STATE_REQUEST  0x46  /* etman-server -> qagame: resend everything */
+
+/*
+ * Game state records (must match etman-server/admin/admin.h)
+ * Multi-byte values are in network byte order. A record always carries
+ * the complete value, so any packet can be applied on its own.
+ */
+#define GAME_STATE_REC_MAP      1     /* <len:1><mapname:len> */
+#define GAME_STATE_REC_LEVEL    2     /* <elapsedMs:4><timelimitMs:4><gamestate:1><round:1> */
+#define GAME_STATE_REC_PLAYER   3     /* <slot:1><connected:1>[<team:1><guid:32><nameLen:1><name:nameLen>] */
+
+/* Record sizes including the record type byte */
+#define GAME_STATE_MAP_LEN(nameLen)     (2 + (nameLen))
+#define GAME_STATE_LEVEL_LEN            11
+#define GAME_STATE_LEFT_LEN             3
+#define GAME_STATE_PLAYER_LEN(nameLen)  (4 + ADMIN_GUID_LEN + 1 + (nameLen))
+
+#define GAME_STATE_MAX_PACKET   512   /* etman-server receive buffer */
+#define GAME_STATE_HEARTBEAT_MS 5000  /* Full state at least this often */
 
 /*
  * Admin Action Types (etman-server -> qagame)
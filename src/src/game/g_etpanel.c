@@ -3,27 +3,1043 @@
  * Copyright (C) 2024 ETMan
  *
  * Non-blocking HTTP stats reporting to ETPanel API.
- * Uses fork() + curl for fire-and-forget HTTP POST.
+ *
+ * Events are formatted on the game thread and pushed into a bounded
+ * single-producer/single-consumer ring. A sender thread drains the ring and
+ * posts the events as one JSON array to <etpanel_api_url>/game/batch over a
+ * persistent keep-alive HTTP/1.1 connection, every etpanel_batch_ms or as
+ * soon as etpanel_batch_size events are waiting.
+ *
+ * When the panel can't be reached the events are appended to a spool file
+ * (one {"type":..,"data":..} object per line) and posted again, oldest first,
+ * once the panel is back. This replaces the separate relay script; lines it
+ * left behind are replayed as they are and the panel still reads them.
+ *
+ * The game thread never blocks: when the ring is filling up kill, death and
+ * chat events are shed first so connects, disconnects and round results
+ * still get through, and a full ring drops. See "etpanelstats".
+ *
+ * scripts/etpanel-stub.py stands in for the panel to test all of this locally.
  */
 
 #include "g_etpanel.h"
 
-#ifndef _WIN32
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#else
+#include <pthread.h>
 #include <unistd.h>
-#include <sys/wait.h>
-#include <signal.h>
-#include <time.h>
+#include <errno.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #endif
+#include <time.h>
 
 // CVARs - use same names as existing Lua config for compatibility
 vmCvar_t etpanel_enabled;
 vmCvar_t etpanel_api_url;
 vmCvar_t etpanel_api_key;
 vmCvar_t etpanel_debug;
+vmCvar_t etpanel_batch_size;
+vmCvar_t etpanel_batch_ms;
+vmCvar_t etpanel_spool;
+
+#define ETPANEL_QUEUE_SIZE      256             ///< events in the ring, power of two
+#define ETPANEL_QUEUE_SHED      (ETPANEL_QUEUE_SIZE * 3 / 4) ///< sheddable events are dropped above this
+#define ETPANEL_EVENT_SIZE      2048            ///< largest formatted event (kill/death)
+#define ETPANEL_TYPE_SIZE       32
+#define ETPANEL_MAX_BATCH       64
+#define ETPANEL_LINE_SIZE       (ETPANEL_EVENT_SIZE + ETPANEL_TYPE_SIZE + 32) ///< one batch entry / spool line
+#define ETPANEL_SPOOL_MAX       (8 * 1024 * 1024)
+#define ETPANEL_IO_TIMEOUT      3000            ///< connect, send and receive timeout in msec
+#define ETPANEL_RETRY_MIN       1000            ///< first reconnect delay after a failure
+#define ETPANEL_RETRY_MAX       30000
+
+/**
+ * @struct etpanelEvent_t
+ * @brief A queued event
+ */
+typedef struct
+{
+	char type[ETPANEL_TYPE_SIZE];               ///< route name, e.g. "kill"
+	char json[ETPANEL_EVENT_SIZE];
+} etpanelEvent_t;
+
+/**
+ * @struct etpanelConfig_t
+ * @brief What the sender thread needs from the cvars
+ */
+typedef struct
+{
+	qboolean valid;                             ///< a plain http:// url was parsed
+	char host[256];
+	char port[8];
+	char path[256];                             ///< base path without trailing slash, e.g. "/api"
+	char apiKey[128];
+	char spool[MAX_OSPATH];
+	int batchSize;
+	int batchMsec;
+} etpanelConfig_t;
+
+#ifdef _WIN32
+typedef SOCKET etpanelSocket_t;
+#define ETPANEL_INVALID_SOCKET  INVALID_SOCKET
+#define ETPanel_CloseSocket(s)  closesocket(s)
+#else
+typedef int etpanelSocket_t;
+#define ETPANEL_INVALID_SOCKET  -1
+#define ETPanel_CloseSocket(s)  close(s)
+#endif
+
+/**
+ * @struct etpanelSender_t
+ * @brief
+ */
+typedef struct
+{
+	etpanelEvent_t events[ETPANEL_QUEUE_SIZE];
+	unsigned int head;                          ///< written by the game thread only
+	unsigned int tail;                          ///< written by the sender thread only
+
+#ifdef _WIN32
+	HANDLE thread;
+	CRITICAL_SECTION lock;
+	CONDITION_VARIABLE wake;                    ///< a batch is full, the config changed or we are shutting down
+#else
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t wake;
+#endif
+	qboolean running;
+
+	// guarded by lock
+	qboolean quit;
+	etpanelConfig_t config;
+	int configSeq;
+	qboolean online;
+	char error[256];                            ///< last failure, reported by G_ETPanel_RunFrame
+	int errorSeq;
+
+	// game thread stats
+	unsigned int queued;
+	unsigned int shed;
+	unsigned int dropped;
+	unsigned int maxPending;
+
+	// sender thread stats, guarded by lock
+	unsigned int posts;
+	unsigned int failedPosts;
+	unsigned int sent;
+	unsigned int rejected;                      ///< events in batches the panel answered with 4xx
+	unsigned int spooled;
+	unsigned int replayed;
+	unsigned int spoolDropped;
+	unsigned int connects;
+
+	// sender thread only
+	etpanelSocket_t socket;
+	qboolean spoolPending;
+	int retryTime;
+	int retryDelay;
+	char body[ETPANEL_MAX_BATCH * ETPANEL_LINE_SIZE + 2];
+	char line[ETPANEL_LINE_SIZE];
+} etpanelSender_t;
+
+static etpanelSender_t etpanel_sender;
+
+static int etpanel_configModCount;
+static int etpanel_errorSeq;
+
+#ifdef _WIN32
+#define ETPanel_Lock()              EnterCriticalSection(&etpanel_sender.lock)
+#define ETPanel_Unlock()            LeaveCriticalSection(&etpanel_sender.lock)
+#define ETPanel_Wait(cond, msec)    SleepConditionVariableCS(&etpanel_sender.cond, &etpanel_sender.lock, msec)
+#define ETPanel_Signal(cond)        WakeAllConditionVariable(&etpanel_sender.cond)
+#define ETPanel_LoadAcquire(p)      ((unsigned int)InterlockedCompareExchange((volatile LONG *)(p), 0, 0))
+#define ETPanel_StoreRelease(p, v)  InterlockedExchange((volatile LONG *)(p), (LONG)(v))
+#else
+#define ETPanel_Lock()              pthread_mutex_lock(&etpanel_sender.lock)
+#define ETPanel_Unlock()            pthread_mutex_unlock(&etpanel_sender.lock)
+#define ETPanel_Wait(cond, msec)    ETPanel_TimedWait(&etpanel_sender.cond, msec)
+#define ETPanel_Signal(cond)        pthread_cond_broadcast(&etpanel_sender.cond)
+#define ETPanel_LoadAcquire(p)      __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define ETPanel_StoreRelease(p, v)  __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#endif
 
 // Track connect times for playtime calculation
 static int playerConnectTime[MAX_CLIENTS];
 
+/**
+ * @brief Monotonic clock for the sender thread
+ * @return milliseconds
+ */
+static int ETPanel_Milliseconds(void)
+{
+#ifdef _WIN32
+	return (int)GetTickCount();
+#else
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (int)(now.tv_sec * 1000 + now.tv_nsec / 1000000);
+#endif
+}
+
+#ifndef _WIN32
+/**
+ * @brief Wait on a condition with the lock held, for at most msec
+ * @param[in] cond
+ * @param[in] msec
+ */
+static void ETPanel_TimedWait(pthread_cond_t *cond, int msec)
+{
+	struct timespec until;
+
+	clock_gettime(CLOCK_REALTIME, &until);
+	until.tv_sec  += msec / 1000;
+	until.tv_nsec += (msec % 1000) * 1000000L;
+	if (until.tv_nsec >= 1000000000L)
+	{
+		until.tv_sec++;
+		until.tv_nsec -= 1000000000L;
+	}
+
+	pthread_cond_timedwait(cond, &etpanel_sender.lock, &until);
+}
+#endif
+
+/**
+ * @brief Record a change of the connection state for G_ETPanel_RunFrame
+ * @param[in] online
+ * @param[in] error Why we went offline, NULL when coming back
+ */
+static void ETPanel_SetOnline(qboolean online, const char *error)
+{
+	ETPanel_Lock();
+	if (etpanel_sender.online != online || (error && Q_stricmp(etpanel_sender.error, error)))
+	{
+		etpanel_sender.online = online;
+		Q_strncpyz(etpanel_sender.error, error ? error : "", sizeof(etpanel_sender.error));
+		etpanel_sender.errorSeq++;
+	}
+	ETPanel_Unlock();
+}
+
+/**
+ * @brief Close the keep-alive connection
+ */
+static void ETPanel_Disconnect(void)
+{
+	if (etpanel_sender.socket != ETPANEL_INVALID_SOCKET)
+	{
+		ETPanel_CloseSocket(etpanel_sender.socket);
+		etpanel_sender.socket = ETPANEL_INVALID_SOCKET;
+	}
+}
+
+/**
+ * @brief Apply the send and receive timeouts to a socket
+ *
+ * On Linux the send timeout also bounds connect().
+ *
+ * @param[in] sock
+ */
+static void ETPanel_SetTimeouts(etpanelSocket_t sock)
+{
+	int one = 1;
+#ifdef _WIN32
+	DWORD timeout = ETPANEL_IO_TIMEOUT;
+#else
+	struct timeval timeout;
+
+	timeout.tv_sec  = ETPANEL_IO_TIMEOUT / 1000;
+	timeout.tv_usec = (ETPANEL_IO_TIMEOUT % 1000) * 1000;
+#endif
+
+	setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, (const char *)&timeout, sizeof(timeout));
+	setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char *)&timeout, sizeof(timeout));
+	setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (const char *)&one, sizeof(one));
+#ifdef SO_NOSIGPIPE
+	setsockopt(sock, SOL_SOCKET, SO_NOSIGPIPE, (const char *)&one, sizeof(one));
+#endif
+}
+
+/**
+ * @brief Open the keep-alive connection to the panel
+ * @param[in] config
+ * @param[out] error Why it failed
+ * @param[in] errorSize
+ * @return
+ */
+static qboolean ETPanel_Connect(const etpanelConfig_t *config, char *error, int errorSize)
+{
+	struct addrinfo hints, *result, *ai;
+	int             ret;
+
+	Com_Memset(&hints, 0, sizeof(hints));
+	hints.ai_family   = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+
+	ret = getaddrinfo(config->host, config->port, &hints, &result);
+	if (ret != 0)
+	{
+		Com_sprintf(error, errorSize, "can't resolve %s (%s)", config->host, gai_strerror(ret));
+		return qfalse;
+	}
+
+	for (ai = result; ai; ai = ai->ai_next)
+	{
+		etpanelSocket_t sock = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+
+		if (sock == ETPANEL_INVALID_SOCKET)
+		{
+			continue;
+		}
+
+		ETPanel_SetTimeouts(sock);
+
+		if (connect(sock, ai->ai_addr, (int)ai->ai_addrlen) == 0)
+		{
+			etpanel_sender.socket = sock;
+			break;
+		}
+		ETPanel_CloseSocket(sock);
+	}
+	freeaddrinfo(result);
+
+	if (etpanel_sender.socket == ETPANEL_INVALID_SOCKET)
+	{
+		Com_sprintf(error, errorSize, "can't connect to %s:%s", config->host, config->port);
+		return qfalse;
+	}
+
+	ETPanel_Lock();
+	etpanel_sender.connects++;
+	ETPanel_Unlock();
+
+	return qtrue;
+}
+
+/**
+ * @brief Send all of a buffer
+ * @param[in] data
+ * @param[in] size
+ * @return
+ */
+static qboolean ETPanel_SendAll(const char *data, int size)
+{
+#ifdef MSG_NOSIGNAL
+	const int flags = MSG_NOSIGNAL;
+#else
+	const int flags = 0;
+#endif
+
+	while (size > 0)
+	{
+		int sent = (int)send(etpanel_sender.socket, data, size, flags);
+
+		if (sent <= 0)
+		{
+			return qfalse;
+		}
+		data += sent;
+		size -= sent;
+	}
+
+	return qtrue;
+}
+
+/**
+ * @brief Read a response and leave the connection ready for the next request
+ *
+ * The body is discarded. Without a Content-Length we can't tell where the
+ * body ends, so the connection is dropped after the headers.
+ *
+ * @return The HTTP status, 0 if the connection failed
+ */
+static int ETPanel_ReadResponse(void)
+{
+	char       buffer[4096];
+	int        length = 0, received, status, headerSize, contentLength;
+	const char *end, *header;
+	qboolean   keepAlive;
+
+	for (;;)
+	{
+		if (length >= (int)sizeof(buffer) - 1)
+		{
+			return 0;   // headers too large
+		}
+
+		received = (int)recv(etpanel_sender.socket, buffer + length, sizeof(buffer) - 1 - length, 0);
+		if (received <= 0)
+		{
+			return 0;
+		}
+		length        += received;
+		buffer[length] = '\0';
+
+		end = strstr(buffer, "\r\n\r\n");
+		if (end)
+		{
+			break;
+		}
+	}
+
+	if (Q_stricmpn(buffer, "HTTP/1.", 7) || sscanf(buffer + 8, "%d", &status) != 1)
+	{
+		return 0;
+	}
+
+	headerSize    = (int)(end - buffer) + 4;
+	contentLength = -1;
+	keepAlive     = !Q_strncmp(buffer, "HTTP/1.1", 8);
+
+	header = Q_stristr(buffer, "\r\ncontent-length:");
+	if (header && header < end)
+	{
+		contentLength = atoi(header + 17);
+	}
+	header = Q_stristr(buffer, "\r\nconnection:");
+	if (header && header < end)
+	{
+		keepAlive = !Q_stricmpn(header + 14 + strspn(header + 14, " "), "keep-alive", 10);
+	}
+
+	if (contentLength < 0 || !keepAlive)
+	{
+		ETPanel_Disconnect();
+		return status;
+	}
+
+	// skip what is left of the body
+	contentLength -= length - headerSize;
+	while (contentLength > 0)
+	{
+		received = (int)recv(etpanel_sender.socket, buffer, contentLength < (int)sizeof(buffer) ? contentLength : (int)sizeof(buffer), 0);
+		if (received <= 0)
+		{
+			ETPanel_Disconnect();
+			break;
+		}
+		contentLength -= received;
+	}
+
+	return status;
+}
+
+/**
+ * @brief POST a JSON array to <url>/game/batch
+ *
+ * A kept-alive connection that turns out to be closed by the panel is
+ * reopened once.
+ *
+ * @param[in] config
+ * @param[in] body
+ * @param[in] size
+ * @return The HTTP status, 0 if the panel couldn't be reached
+ */
+static int ETPanel_Post(const etpanelConfig_t *config, const char *body, int size)
+{
+	char     header[1024];
+	char     error[512];
+	int      headerSize, status, attempt;
+	qboolean reused;
+
+	headerSize = Com_sprintf(header, sizeof(header),
+	                         "POST %s/game/batch HTTP/1.1\r\n"
+	                         "Host: %s:%s\r\n"
+	                         "Content-Type: application/json\r\n"
+	                         "%s%s%s"
+	                         "Content-Length: %d\r\n"
+	                         "Connection: keep-alive\r\n"
+	                         "\r\n",
+	                         config->path, config->host, config->port,
+	                         config->apiKey[0] ? "X-API-Key: " : "", config->apiKey, config->apiKey[0] ? "\r\n" : "",
+	                         size);
+
+	for (attempt = 0; attempt < 2; attempt++)
+	{
+		reused = etpanel_sender.socket != ETPANEL_INVALID_SOCKET;
+		if (!reused && !ETPanel_Connect(config, error, sizeof(error)))
+		{
+			ETPanel_SetOnline(qfalse, error);
+			return 0;
+		}
+
+		if (ETPanel_SendAll(header, headerSize) && ETPanel_SendAll(body, size))
+		{
+			status = ETPanel_ReadResponse();
+			if (status)
+			{
+				return status;
+			}
+		}
+
+		ETPanel_Disconnect();
+		if (!reused)
+		{
+			break;
+		}
+	}
+
+	Com_sprintf(error, sizeof(error), "no response from %s:%s", config->host, config->port);
+	ETPanel_SetOnline(qfalse, error);
+	return 0;
+}
+
+/**
+ * @brief Format an event as a batch entry / spool line
+ * @param[in] event
+ * @param[out] out
+ * @param[in] outSize
+ * @return Length of the entry
+ */
+static int ETPanel_FormatEntry(const etpanelEvent_t *event, char *out, int outSize)
+{
+	return Com_sprintf(out, outSize, "{\"type\":\"%s\",\"data\":%s}", event->type, event->json);
+}
+
+/**
+ * @brief Append events to the spool file
+ * @param[in] config
+ * @param[in] first Ring index of the first event
+ * @param[in] count
+ */
+static void ETPanel_SpoolEvents(const etpanelConfig_t *config, unsigned int first, int count)
+{
+	FILE *f;
+	long size;
+	int  i, written = 0;
+
+	f = fopen(config->spool, "ab");
+	if (f)
+	{
+		fseek(f, 0, SEEK_END);
+		size = ftell(f);
+
+		for (i = 0; i < count && size < ETPANEL_SPOOL_MAX; i++)
+		{
+			int length = ETPanel_FormatEntry(&etpanel_sender.events[(first + i) & (ETPANEL_QUEUE_SIZE - 1)], etpanel_sender.line, sizeof(etpanel_sender.line));
+
+			if (fprintf(f, "%s\n", etpanel_sender.line) < 0)
+			{
+				break;
+			}
+			size += length + 1;
+			written++;
+		}
+		fclose(f);
+	}
+
+	if (written)
+	{
+		etpanel_sender.spoolPending = qtrue;
+	}
+
+	ETPanel_Lock();
+	etpanel_sender.spooled      += written;
+	etpanel_sender.spoolDropped += count - written;
+	ETPanel_Unlock();
+}
+
+/**
+ * @brief Post a batch and account for the result
+ * @param[in] config
+ * @param[in] size Length of etpanel_sender.body
+ * @param[in] count Events in the batch
+ * @return qfalse if the panel couldn't be reached and the events should be kept
+ */
+static qboolean ETPanel_PostBatch(const etpanelConfig_t *config, int size, int count)
+{
+	char error[64];
+	int  status = ETPanel_Post(config, etpanel_sender.body, size);
+
+	ETPanel_Lock();
+	etpanel_sender.posts++;
+	if (status >= 200 && status < 300)
+	{
+		etpanel_sender.sent += count;
+	}
+	else if (status >= 400 && status < 500)
+	{
+		// the panel won't take these no matter how often we try
+		etpanel_sender.rejected += count;
+		Com_sprintf(etpanel_sender.error, sizeof(etpanel_sender.error), "panel rejected a batch of %d events (HTTP %d)", count, status);
+		etpanel_sender.errorSeq++;
+	}
+	else
+	{
+		etpanel_sender.failedPosts++;
+	}
+	ETPanel_Unlock();
+
+	if (status == 0 || status >= 500)
+	{
+		ETPanel_Disconnect();
+		etpanel_sender.retryTime  = ETPanel_Milliseconds() + etpanel_sender.retryDelay;
+		etpanel_sender.retryDelay = MIN(etpanel_sender.retryDelay * 2, ETPANEL_RETRY_MAX);
+		if (status)
+		{
+			Com_sprintf(error, sizeof(error), "panel answered HTTP %d", status);
+			ETPanel_SetOnline(qfalse, error);
+		}
+		return qfalse;
+	}
+
+	etpanel_sender.retryDelay = ETPANEL_RETRY_MIN;
+	ETPanel_SetOnline(qtrue, NULL);
+	return qtrue;
+}
+
+/**
+ * @brief Post the spool file, oldest events first
+ *
+ * Whatever couldn't be posted stays in the spool.
+ *
+ * @param[in] config
+ * @return qfalse if the panel couldn't be reached
+ */
+static qboolean ETPanel_ReplaySpool(const etpanelConfig_t *config)
+{
+	char     tempPath[MAX_OSPATH + 4];
+	FILE     *f, *rest = NULL;
+	long     batchStart = 0;
+	int      size, count;
+	qboolean ok = qtrue;
+
+	f = fopen(config->spool, "rb");
+	if (!f)
+	{
+		etpanel_sender.spoolPending = qfalse;
+		return qtrue;
+	}
+
+	size = 0;
+	count = 0;
+	etpanel_sender.body[size++] = '[';
+
+	while (fgets(etpanel_sender.line, sizeof(etpanel_sender.line), f))
+	{
+		int length = (int)strlen(etpanel_sender.line);
+
+		if (!length || etpanel_sender.line[length - 1] != '\n')
+		{
+			// too long for the line buffer, or the last write was cut off:
+			// a part of it would make the panel reject the whole batch
+			while (length == (int)sizeof(etpanel_sender.line) - 1 && etpanel_sender.line[length - 1] != '\n'
+			       && fgets(etpanel_sender.line, sizeof(etpanel_sender.line), f))
+			{
+				length = (int)strlen(etpanel_sender.line);
+			}
+			ETPanel_Lock();
+			etpanel_sender.spoolDropped++;
+			ETPanel_Unlock();
+			continue;
+		}
+		etpanel_sender.line[--length] = '\0';
+
+		if (length < 2 || etpanel_sender.line[0] != '{')
+		{
+			continue;   // blank
+		}
+
+		if (count)
+		{
+			etpanel_sender.body[size++] = ',';
+		}
+		Com_Memcpy(etpanel_sender.body + size, etpanel_sender.line, length);
+		size += length;
+		count++;
+
+		if (count == config->batchSize)
+		{
+			etpanel_sender.body[size++] = ']';
+			if (!ETPanel_PostBatch(config, size, count))
+			{
+				ok = qfalse;
+				break;
+			}
+			ETPanel_Lock();
+			etpanel_sender.replayed += count;
+			ETPanel_Unlock();
+
+			batchStart = ftell(f);
+			size       = 1;
+			count      = 0;
+		}
+	}
+
+	if (ok && count)
+	{
+		etpanel_sender.body[size++] = ']';
+		ok = ETPanel_PostBatch(config, size, count);
+		if (ok)
+		{
+			ETPanel_Lock();
+			etpanel_sender.replayed += count;
+			ETPanel_Unlock();
+		}
+	}
+
+	if (ok)
+	{
+		fclose(f);
+		remove(config->spool);
+		etpanel_sender.spoolPending = qfalse;
+		return qtrue;
+	}
+
+	// keep the events of the failed batch and everything after it
+	Com_sprintf(tempPath, sizeof(tempPath), "%s.tmp", config->spool);
+	if (batchStart > 0)
+	{
+		rest = fopen(tempPath, "wb");
+	}
+	if (rest)
+	{
+		size_t length;
+
+		fseek(f, batchStart, SEEK_SET);
+		while ((length = fread(etpanel_sender.body, 1, sizeof(etpanel_sender.body), f)) > 0)
+		{
+			fwrite(etpanel_sender.body, 1, length, rest);
+		}
+		fclose(rest);
+		fclose(f);
+		remove(config->spool);
+		rename(tempPath, config->spool);
+	}
+	else
+	{
+		fclose(f);
+	}
+
+	return qfalse;
+}
+
+/**
+ * @brief Send up to one batch of queued events, or spool them
+ * @param[in] config
+ * @param[in] pending Events in the ring
+ */
+static void ETPanel_Flush(const etpanelConfig_t *config, unsigned int pending)
+{
+	unsigned int tail  = etpanel_sender.tail;
+	int          count = MIN((int)pending, config->batchSize);
+	int          size, i;
+	qboolean     sent = qfalse;
+
+	if (config->valid && ETPanel_Milliseconds() - etpanel_sender.retryTime >= 0)
+	{
+		// keep the order, what was spooled goes first
+		if (!etpanel_sender.spoolPending || ETPanel_ReplaySpool(config))
+		{
+			size = 0;
+			etpanel_sender.body[size++] = '[';
+			for (i = 0; i < count; i++)
+			{
+				if (i)
+				{
+					etpanel_sender.body[size++] = ',';
+				}
+				size += ETPanel_FormatEntry(&etpanel_sender.events[(tail + i) & (ETPANEL_QUEUE_SIZE - 1)], etpanel_sender.body + size, ETPANEL_LINE_SIZE);
+			}
+			etpanel_sender.body[size++] = ']';
+
+			sent = ETPanel_PostBatch(config, size, count);
+		}
+	}
+
+	if (!sent)
+	{
+		ETPanel_SpoolEvents(config, tail, count);
+	}
+
+	// the slots can be reused only now
+	ETPanel_StoreRelease(&etpanel_sender.tail, tail + count);
+}
+
+/**
+ * @brief Sender thread main loop
+ */
+static void ETPanel_SenderThread(void)
+{
+	etpanelConfig_t config;
+	int             configSeq = -1;
+	int             lastFlush = ETPanel_Milliseconds();
+	unsigned int    pending;
+	qboolean        quit;
+
+	Com_Memset(&config, 0, sizeof(config));
+
+	for (;;)
+	{
+		ETPanel_Lock();
+		pending = ETPanel_LoadAcquire(&etpanel_sender.head) - etpanel_sender.tail;
+		if (!etpanel_sender.quit && configSeq == etpanel_sender.configSeq && (int)pending < config.batchSize)
+		{
+			ETPanel_Wait(wake, MAX(config.batchMsec - (ETPanel_Milliseconds() - lastFlush), 1));
+		}
+		quit = etpanel_sender.quit;
+		if (configSeq != etpanel_sender.configSeq)
+		{
+			configSeq = etpanel_sender.configSeq;
+			config    = etpanel_sender.config;
+			ETPanel_Disconnect();
+			etpanel_sender.retryTime    = ETPanel_Milliseconds();
+			etpanel_sender.retryDelay   = ETPANEL_RETRY_MIN;
+			etpanel_sender.spoolPending = qtrue;  // check once for a spool left by an earlier run
+		}
+		ETPanel_Unlock();
+
+		pending = ETPanel_LoadAcquire(&etpanel_sender.head) - etpanel_sender.tail;
+		if (!pending)
+		{
+			if (quit)
+			{
+				break;
+			}
+			if (etpanel_sender.spoolPending && config.valid && ETPanel_Milliseconds() - etpanel_sender.retryTime >= 0)
+			{
+				ETPanel_ReplaySpool(&config);
+			}
+			lastFlush = ETPanel_Milliseconds();
+			continue;
+		}
+
+		if (!quit && (int)pending < config.batchSize && ETPanel_Milliseconds() - lastFlush < config.batchMsec)
+		{
+			continue;
+		}
+
+		ETPanel_Flush(&config, pending);
+		lastFlush = ETPanel_Milliseconds();
+	}
+
+	ETPanel_Disconnect();
+}
+
+#ifdef _WIN32
+/**
+ * @brief ETPanel_SenderThreadProc
+ * @param dummy - unused
+ * @return
+ */
+static DWORD WINAPI ETPanel_SenderThreadProc(LPVOID dummy)
+{
+	WSADATA wsaData;
+
+	// the engine has winsock up already, this only holds a reference
+	if (WSAStartup(MAKEWORD(2, 2), &wsaData) == 0)
+	{
+		ETPanel_SenderThread();
+		WSACleanup();
+	}
+	return 0;
+}
+#else
+/**
+ * @brief ETPanel_SenderThreadProc
+ * @param dummy - unused
+ * @return
+ */
+static void *ETPanel_SenderThreadProc(void *dummy)
+{
+	ETPanel_SenderThread();
+	return NULL;
+}
+#endif
+
+/**
+ * @brief Build the sender config from the cvars and hand it to the thread
+ */
+static void ETPanel_UpdateConfig(void)
+{
+	etpanelConfig_t config;
+	char            homepath[MAX_OSPATH];
+	char            gamepath[MAX_QPATH];
+	const char      *url = etpanel_api_url.string;
+	const char      *hostEnd, *portStart;
+	int             hostLength;
+
+	Com_Memset(&config, 0, sizeof(config));
+
+	config.batchSize = etpanel_batch_size.integer;
+	config.batchSize = config.batchSize < 1 ? 1 : MIN(config.batchSize, ETPANEL_MAX_BATCH);
+	config.batchMsec = etpanel_batch_ms.integer;
+	config.batchMsec = config.batchMsec < 10 ? 10 : MIN(config.batchMsec, 60000);
+	Q_strncpyz(config.apiKey, etpanel_api_key.string, sizeof(config.apiKey));
+
+	trap_Cvar_VariableStringBuffer("fs_homepath", homepath, sizeof(homepath));
+	trap_Cvar_VariableStringBuffer("fs_game", gamepath, sizeof(gamepath));
+	Com_sprintf(config.spool, sizeof(config.spool), "%s/%s/%s", homepath, gamepath[0] ? gamepath : MODNAME, etpanel_spool.string);
+
+	if (!Q_stricmpn(url, "http://", 7))
+	{
+		url      += 7;
+		hostEnd   = url + strcspn(url, "/");
+		portStart = memchr(url, ':', hostEnd - url);
+
+		hostLength = (int)((portStart ? portStart : hostEnd) - url);
+		if (hostLength > 0 && hostLength < (int)sizeof(config.host))
+		{
+			Q_strncpyz(config.host, url, hostLength + 1);
+			if (portStart)
+			{
+				Q_strncpyz(config.port, portStart + 1, MIN((int)(hostEnd - portStart), (int)sizeof(config.port)));
+			}
+			else
+			{
+				Q_strncpyz(config.port, "80", sizeof(config.port));
+			}
+			Q_strncpyz(config.path, hostEnd, sizeof(config.path));
+			while (config.path[0] && config.path[strlen(config.path) - 1] == '/')
+			{
+				config.path[strlen(config.path) - 1] = '\0';
+			}
+			config.valid = qtrue;
+		}
+	}
+
+	if (!config.valid)
+	{
+		G_Printf("[ETPanel] Can't post to '%s', only plain http:// urls are supported - events go to %s\n", etpanel_api_url.string, config.spool);
+	}
+
+	if (etpanel_sender.running)
+	{
+		ETPanel_Lock();
+		etpanel_sender.config = config;
+		etpanel_sender.configSeq++;
+		ETPanel_Signal(wake);
+		ETPanel_Unlock();
+	}
+	else
+	{
+		etpanel_sender.config = config;
+		etpanel_sender.configSeq++;
+	}
+}
+
+/**
+ * @brief Sum of the modification counts of the cvars that make up the config
+ * @return
+ */
+static int ETPanel_ConfigModificationCount(void)
+{
+	return etpanel_api_url.modificationCount + etpanel_api_key.modificationCount + etpanel_batch_size.modificationCount
+	       + etpanel_batch_ms.modificationCount + etpanel_spool.modificationCount;
+}
+
+/**
+ * @brief Start the sender thread
+ */
+static void ETPanel_StartSender(void)
+{
+	etpanel_sender.socket = ETPANEL_INVALID_SOCKET;
+
+#ifdef _WIN32
+	InitializeCriticalSection(&etpanel_sender.lock);
+	InitializeConditionVariable(&etpanel_sender.wake);
+
+	etpanel_sender.thread = CreateThread(NULL, 0, ETPanel_SenderThreadProc, NULL, 0, NULL);
+	etpanel_sender.running = etpanel_sender.thread != NULL;
+	if (!etpanel_sender.running)
+	{
+		DeleteCriticalSection(&etpanel_sender.lock);
+	}
+#else
+	pthread_mutex_init(&etpanel_sender.lock, NULL);
+	pthread_cond_init(&etpanel_sender.wake, NULL);
+
+	etpanel_sender.running = pthread_create(&etpanel_sender.thread, NULL, ETPanel_SenderThreadProc, NULL) == 0;
+	if (!etpanel_sender.running)
+	{
+		pthread_cond_destroy(&etpanel_sender.wake);
+		pthread_mutex_destroy(&etpanel_sender.lock);
+	}
+#endif
+
+	if (!etpanel_sender.running)
+	{
+		G_Printf(S_COLOR_YELLOW "[ETPanel] WARNING: can't start the sender thread, stats reporting is off\n");
+	}
+}
+
+/**
+ * @brief Queue an event for the sender thread
+ *
+ * Never blocks. Above ETPANEL_QUEUE_SHED pending events sheddable ones are
+ * dropped, a full ring drops everything.
+ *
+ * @param[in] type Route name, e.g. "kill"
+ * @param[in] json The JSON payload to send
+ * @param[in] sheddable qtrue for high volume events that may go first under load
+ */
+static void ETPanel_SendEvent(const char *type, const char *json, qboolean sheddable)
+{
+	etpanelEvent_t *event;
+	unsigned int   head, pending;
+
+	if (!etpanel_enabled.integer)
+	{
+		return;
+	}
+
+	if (etpanel_debug.integer)
+	{
+		G_Printf("[ETPanel] %s: %s\n", type, json);
+	}
+
+	if (!etpanel_sender.running)
+	{
+		etpanel_sender.dropped++;
+		return;
+	}
+
+	head    = etpanel_sender.head;
+	pending = head - ETPanel_LoadAcquire(&etpanel_sender.tail);
+
+	if (pending >= ETPANEL_QUEUE_SIZE)
+	{
+		etpanel_sender.dropped++;
+		return;
+	}
+	if (sheddable && pending >= ETPANEL_QUEUE_SHED)
+	{
+		etpanel_sender.shed++;
+		return;
+	}
+
+	event = &etpanel_sender.events[head & (ETPANEL_QUEUE_SIZE - 1)];
+	Q_strncpyz(event->type, type, sizeof(event->type));
+	Q_strncpyz(event->json, json, sizeof(event->json));
+
+	ETPanel_StoreRelease(&etpanel_sender.head, head + 1);
+
+	etpanel_sender.queued++;
+	pending++;
+	if (pending > etpanel_sender.maxPending)
+	{
+		etpanel_sender.maxPending = pending;
+	}
+
+	// a full batch shouldn't wait for the timer
+	if ((int)pending == etpanel_sender.config.batchSize)
+	{
+		ETPanel_Lock();
+		ETPanel_Signal(wake);
+		ETPanel_Unlock();
+	}
+}
+
 /**
  * @brief Initialize the ETPanel system
  */
@@ -33,9 +1049,12 @@ void G_ETPanel_Init(void)
 
 	// Register CVARs - use same names as existing config
 	trap_Cvar_Register(&etpanel_enabled, "etpanel_enabled", "1", CVAR_ARCHIVE);
-	trap_Cvar_Register(&etpanel_api_url, "etpanel_api_url", "http://localhost:3000/api/stats", CVAR_ARCHIVE);
+	trap_Cvar_Register(&etpanel_api_url, "etpanel_api_url", "http://localhost:3000/api", CVAR_ARCHIVE);
 	trap_Cvar_Register(&etpanel_api_key, "etpanel_api_key", "", CVAR_ARCHIVE);
 	trap_Cvar_Register(&etpanel_debug, "etpanel_debug", "0", CVAR_ARCHIVE);
+	trap_Cvar_Register(&etpanel_batch_size, "etpanel_batch_size", "32", CVAR_ARCHIVE);
+	trap_Cvar_Register(&etpanel_batch_ms, "etpanel_batch_ms", "500", CVAR_ARCHIVE);
+	trap_Cvar_Register(&etpanel_spool, "etpanel_spool", "etpanel_events.json", CVAR_ARCHIVE);
 
 	// Clear connect times
 	for (i = 0; i < MAX_CLIENTS; i++)
@@ -43,6 +1062,8 @@ void G_ETPanel_Init(void)
 		playerConnectTime[i] = 0;
 	}
 
+	G_ETPanel_Shutdown();
+
 	if (etpanel_enabled.integer)
 	{
 		G_Printf("[ETPanel] Stats reporting enabled - URL: %s\n", etpanel_api_url.string);
@@ -51,6 +1072,126 @@ void G_ETPanel_Init(void)
 	{
 		G_Printf("[ETPanel] Stats reporting disabled\n");
 	}
+
+	// the thread also runs while disabled so a spool left by an earlier run still goes out
+	ETPanel_UpdateConfig();
+	etpanel_configModCount = ETPanel_ConfigModificationCount();
+	ETPanel_StartSender();
+}
+
+/**
+ * @brief Stop the sender thread
+ *
+ * What is still queued is posted, or spooled if the panel is down.
+ */
+void G_ETPanel_Shutdown(void)
+{
+	if (!etpanel_sender.running)
+	{
+		return;
+	}
+
+	ETPanel_Lock();
+	etpanel_sender.quit = qtrue;
+	ETPanel_Signal(wake);
+	ETPanel_Unlock();
+
+#ifdef _WIN32
+	WaitForSingleObject(etpanel_sender.thread, INFINITE);
+	CloseHandle(etpanel_sender.thread);
+	DeleteCriticalSection(&etpanel_sender.lock);
+#else
+	pthread_join(etpanel_sender.thread, NULL);
+	pthread_cond_destroy(&etpanel_sender.wake);
+	pthread_mutex_destroy(&etpanel_sender.lock);
+#endif
+
+	Com_Memset(&etpanel_sender, 0, sizeof(etpanel_sender));
+	etpanel_errorSeq = 0;
+}
+
+/**
+ * @brief Pick up cvar changes and report connection changes of the sender
+ */
+void G_ETPanel_RunFrame(void)
+{
+	char     error[256];
+	qboolean online;
+	int      errorSeq;
+
+	if (!etpanel_sender.running)
+	{
+		return;
+	}
+
+	trap_Cvar_Update(&etpanel_enabled);
+	trap_Cvar_Update(&etpanel_api_url);
+	trap_Cvar_Update(&etpanel_api_key);
+	trap_Cvar_Update(&etpanel_debug);
+	trap_Cvar_Update(&etpanel_batch_size);
+	trap_Cvar_Update(&etpanel_batch_ms);
+	trap_Cvar_Update(&etpanel_spool);
+
+	if (etpanel_configModCount != ETPanel_ConfigModificationCount())
+	{
+		etpanel_configModCount = ETPanel_ConfigModificationCount();
+		ETPanel_UpdateConfig();
+	}
+
+	ETPanel_Lock();
+	errorSeq = etpanel_sender.errorSeq;
+	online   = etpanel_sender.online;
+	Q_strncpyz(error, etpanel_sender.error, sizeof(error));
+	ETPanel_Unlock();
+
+	if (errorSeq == etpanel_errorSeq)
+	{
+		return;
+	}
+	etpanel_errorSeq = errorSeq;
+
+	if (online && error[0])
+	{
+		G_Printf(S_COLOR_YELLOW "[ETPanel] %s\n", error);
+	}
+	else if (online)
+	{
+		G_Printf("[ETPanel] Connected to %s\n", etpanel_api_url.string);
+	}
+	else
+	{
+		G_Printf(S_COLOR_YELLOW "[ETPanel] %s - spooling events to %s\n", error, etpanel_spool.string);
+	}
+}
+
+/**
+ * @brief Print the sender stats
+ */
+void G_ETPanel_Stats_f(void)
+{
+	unsigned int pending;
+
+	if (!etpanel_sender.running)
+	{
+		G_Printf("ETPanel sender is not running\n");
+		return;
+	}
+
+	pending = etpanel_sender.head - ETPanel_LoadAcquire(&etpanel_sender.tail);
+
+	G_Printf("ETPanel sender: %s\n", etpanel_api_url.string);
+	G_Printf("  queue:  %u queued, %u pending, %u max pending (of %i), %u shed, %u dropped\n",
+	         etpanel_sender.queued, pending, etpanel_sender.maxPending, ETPANEL_QUEUE_SIZE,
+	         etpanel_sender.shed, etpanel_sender.dropped);
+
+	ETPanel_Lock();
+	G_Printf("  panel:  %s, %u connects, %u posts, %u failed, %u events sent, %u rejected\n",
+	         etpanel_sender.online ? "online" : "offline", etpanel_sender.connects,
+	         etpanel_sender.posts, etpanel_sender.failedPosts, etpanel_sender.sent, etpanel_sender.rejected);
+	G_Printf("  spool:  %u spooled, %u replayed, %u dropped (%s)\n",
+	         etpanel_sender.spooled, etpanel_sender.replayed, etpanel_sender.spoolDropped,
+	         etpanel_sender.config.spool);
+	ETPanel_Unlock();
 }
 
 /**
@@ -305,86 +1446,6 @@ static void ETPanel_EscapeJsonWithColors(const char *in, char *out, int outSize)
 	out[j] = '\0';
 }
 
-/**
- * @brief Send stats event via non-blocking HTTP POST (fork + curl)
- * @param[in] endpoint The API endpoint path (e.g., "game/kill")
- * @param[in] json The JSON payload to send
- */
-static void ETPanel_SendEvent(const char *endpoint, const char *json)
-{
-#ifndef _WIN32
-	pid_t pid;
-	char  fullUrl[512];
-
-	if (!etpanel_enabled.integer)
-	{
-		return;
-	}
-
-	// Build full URL: base_url + "/" + endpoint
-	Com_sprintf(fullUrl, sizeof(fullUrl), "%s/%s", etpanel_api_url.string, endpoint);
-
-	if (etpanel_debug.integer)
-	{
-		G_Printf("[ETPanel] POST %s: %s\n", fullUrl, json);
-	}
-
-	// Reap any zombie child processes
-	while (waitpid(-1, NULL, WNOHANG) > 0)
-		;
-
-	pid = fork();
-	if (pid == 0)
-	{
-		// Child process - do the HTTP POST and exit
-		char authHeader[256];
-		char contentType[] = "Content-Type: application/json";
-
-		// Build auth header if API key is set
-		if (etpanel_api_key.string[0])
-		{
-			Com_sprintf(authHeader, sizeof(authHeader), "X-API-Key: %s", etpanel_api_key.string);
-			execl("/usr/bin/curl", "curl",
-			      "-s",                    // Silent
-			      "-X", "POST",            // POST method
-			      "-H", contentType,       // Content-Type header
-			      "-H", authHeader,        // API key header
-			      "-d", json,              // POST data
-			      "--connect-timeout", "2", // 2 second connect timeout
-			      "--max-time", "5",       // 5 second max time
-			      fullUrl,                 // Full URL with endpoint
-			      (char *)NULL);
-		}
-		else
-		{
-			execl("/usr/bin/curl", "curl",
-			      "-s",
-			      "-X", "POST",
-			      "-H", contentType,
-			      "-d", json,
-			      "--connect-timeout", "2",
-			      "--max-time", "5",
-			      fullUrl,
-			      (char *)NULL);
-		}
-
-		// If execl fails, exit
-		_exit(1);
-	}
-	else if (pid < 0)
-	{
-		G_Printf("[ETPanel] Warning: fork() failed\n");
-	}
-	// Parent continues immediately - non-blocking
-#else
-	// Windows: not implemented (would need CreateProcess or similar)
-	if (etpanel_debug.integer)
-	{
-		G_Printf("[ETPanel] Windows not supported, event: %s\n", json);
-	}
-#endif
-}
-
 /**
  * @brief Get current Unix timestamp in seconds
  */
@@ -429,7 +1490,7 @@ void G_ETPanel_PlayerConnect(int clientNum, qboolean firstTime, qboolean isBot)
 	            guidEsc,
 	            ETPanel_GetTimestamp());
 
-	ETPanel_SendEvent("game/player-connect", json);
+	ETPanel_SendEvent("player-connect", json, qfalse);
 }
 
 /**
@@ -481,7 +1542,7 @@ void G_ETPanel_PlayerDisconnect(int clientNum)
 	            playtime,
 	            ETPanel_GetTimestamp());
 
-	ETPanel_SendEvent("game/player-disconnect", json);
+	ETPanel_SendEvent("player-disconnect", json, qfalse);
 }
 
 /**
@@ -564,7 +1625,7 @@ void G_ETPanel_Kill(int victim, int killer, int meansOfDeath)
 			            weapon,
 			            level.rawmapname,
 			            timestamp);
-			ETPanel_SendEvent("game/death", json);
+			ETPanel_SendEvent("death", json, qtrue);
 		}
 		return;
 	}
@@ -589,7 +1650,7 @@ void G_ETPanel_Kill(int victim, int killer, int meansOfDeath)
 		            weapon,
 		            level.rawmapname,
 		            timestamp);
-		ETPanel_SendEvent("game/kill", json);
+		ETPanel_SendEvent("kill", json, qtrue);
 	}
 
 	// Report death event for human victim
@@ -613,7 +1674,7 @@ void G_ETPanel_Kill(int victim, int killer, int meansOfDeath)
 		            isTeamKill ? "teamkill" : (killerIsBot ? "bot" : "human"),
 		            level.rawmapname,
 		            timestamp);
-		ETPanel_SendEvent("game/death", json);
+		ETPanel_SendEvent("death", json, qtrue);
 	}
 }
 
@@ -636,7 +1697,7 @@ void G_ETPanel_RoundEnd(int winner)
 	            level.rawmapname,
 	            ETPanel_GetTimestamp());
 
-	ETPanel_SendEvent("game/round-end", json);
+	ETPanel_SendEvent("round-end", json, qfalse);
 }
 
 /**
@@ -656,7 +1717,7 @@ void G_ETPanel_MapEnd(void)
 	            level.rawmapname,
 	            ETPanel_GetTimestamp());
 
-	ETPanel_SendEvent("game/map-end", json);
+	ETPanel_SendEvent("map-end", json, qfalse);
 }
 
 /**
@@ -694,5 +1755,5 @@ void G_ETPanel_Chat(int clientNum, int mode, const char *message)
 	            mode > 0 ? "true" : "false",
 	            ETPanel_GetTimestamp());
 
-	ETPanel_SendEvent("game/chat", json);
+	ETPanel_SendEvent("chat", json, qtrue);
 }
@@ -3,7 +3,7 @@
  * Copyright (C) 2024 ETMan
  *
  * Non-blocking HTTP stats reporting to ETPanel API.
- * Uses fork() + curl for fire-and-forget HTTP POST.
+ * Events are batched and posted by a sender thread, see g_etpanel.c.
  */
 
 #ifndef G_ETPANEL_H
@@ -16,10 +16,22 @@ extern vmCvar_t etpanel_enabled;
 extern vmCvar_t etpanel_api_url;
 extern vmCvar_t etpanel_api_key;
 extern vmCvar_t etpanel_debug;
+extern vmCvar_t etpanel_batch_size;
+extern vmCvar_t etpanel_batch_ms;
+extern vmCvar_t etpanel_spool;
 
 // Initialize ETPanel system (call from G_InitGame)
 void G_ETPanel_Init(void);
 
+// Post or spool what is still queued and stop the sender (call from G_ShutdownGame)
+void G_ETPanel_Shutdown(void);
+
+// Cvar changes and sender status messages (call from G_RunFrame)
+void G_ETPanel_RunFrame(void);
+
+// "etpanelstats" server command
+void G_ETPanel_Stats_f(void);
+
 // Player events
 void G_ETPanel_PlayerConnect(int clientNum, qboolean firstTime, qboolean isBot);
 void G_ETPanel_PlayerDisconnect(int clientNum);
@@ -1629,6 +1629,16 @@ void G_Sound(gentity_t *ent, int soundIndex);
 void G_AnimScriptSound(int soundIndex, vec3_t org, int client);
 void G_FreeEntity(gentity_t *ent);
 int G_EntitiesFree(void);
+void G_ResetEntityAllocator(void);
+void G_EntityStats_f(void);
+
+// g_entindex.c
+void G_EntityIndexReset(void);
+void G_EntityIndexSpawned(gentity_t *ent);
+void G_EntityIndexRefresh(gentity_t *ent);
+void G_EntityIndexSync(void);
+qboolean G_EntityIndexed(size_t fieldofs);
+gentity_t *G_EntityIndexFind(gentity_t *from, size_t fieldofs, const char *match);
 void G_ClientSound(gentity_t *ent, int soundIndex);
 
 void G_TouchTriggers(gentity_t *ent);
@@ -2171,6 +2181,7 @@ qboolean G_ReAdjustSingleClientPosition(gentity_t *ent);
 void G_ResetMarkers(gentity_t *ent);
 void G_HistoricalTrace(gentity_t *ent, trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask);
 void G_HistoricalTraceBegin(gentity_t *ent);
+void G_HistoricalTraceBeginRay(gentity_t *ent, const vec3_t start, const vec3_t end);
 void G_HistoricalTraceEnd(gentity_t *ent);
 void G_Trace(gentity_t *ent, trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask);
 void G_PredictPmove(gentity_t *ent, float frametime);
@@ -2386,8 +2397,55 @@ void G_spawnPrintf(int print_type, int print_time, gentity_t *owner);
 void G_statsPrint(gentity_t *ent, int nType);
 
 #ifdef FEATURE_DBMS
+// g_db.c
+#define DB_MAX_JOBS 256                 ///< queued jobs and finished ones not collected yet
+
+/**
+ * @enum dbOp_t
+ * @brief Kinds of persistence jobs, for the stats
+ */
+typedef enum
+{
+	DB_OP_XP_LOAD,
+	DB_OP_XP_STORE,
+	DB_OP_PRESTIGE_LOAD,
+	DB_OP_PRESTIGE_STORE,
+	DB_OP_RATING_LOAD,
+	DB_OP_RATING_STORE,
+	DB_OP_BEGIN,
+	DB_OP_COMMIT,
+	DB_OP_FLUSH,                        ///< game thread waiting for the queue
+	DB_OP_MAX
+} dbOp_t;
+
+typedef struct dbJob_s dbJob_t;
+
+/**
+ * @struct dbJob_s
+ * @brief A database read or write run by the persistence thread
+ */
+struct dbJob_s
+{
+	dbOp_t op;
+	int (*run)(dbJob_t *job);           ///< persistence thread, returns 0 if successful
+	void (*finish)(dbJob_t *job);       ///< game thread, may be NULL
+	int clientNum;                      ///< -1 if the job is not about a client
+	char guid[MAX_GUID_LENGTH + 1];
+	int status;                         ///< result of run
+	int64_t data[16];                   ///< payload of the queueing module
+};
+
 int G_DB_Init(void);
 int G_DB_DeInit(void);
+sqlite3_stmt *G_DB_Statement(const char *sql);
+void G_DB_Queue(const dbJob_t *job);
+void G_DB_BeginBatch(void);
+void G_DB_EndBatch(void);
+void G_DB_Flush(void);
+void G_DB_FlushClient(int clientNum);
+gclient_t *G_DB_JobClient(const dbJob_t *job);
+void G_DB_RunFrame(void);
+void G_DB_Stats_f(void);
 #endif
 
 #ifdef FEATURE_RATING
@@ -2436,8 +2494,6 @@ typedef struct prData_s
 int G_PrestigeDBCheck(char *db_path, int db_mode);
 void G_GetClientPrestige(gclient_t *cl);
 void G_SetClientPrestige(gclient_t *cl, qboolean streakUp);
-int G_ReadPrestige(prData_t *pr_data);
-int G_WritePrestige(prData_t *pr_data);
 #endif
 
 int G_XPSaver_CheckDB(char *db_path, int db_mode);
@@ -1526,8 +1526,123 @@ static const gentity_field_t gentity_fields[] =
 	{ NULL },
 };
 
-// gentity fields helper functions
-static gentity_field_t *_etH_gentity_getfield(gentity_t *ent, char *fieldname)
+// gentity field names, hashed case-insensitively on first use
+// a handle returned by et.gentity_field() is the slot index + 1
+#define GENTITY_FIELD_HASH_SIZE  1024   // power of two, well above twice the number of names
+#define GENTITY_MULTI_MAX_FIELDS 32     // fields per et.gentity_getmulti() call
+
+typedef struct
+{
+	const char *name;                           ///< NULL for empty slots
+	const gentity_field_t *clientField;         ///< used for entities with a client
+	const gentity_field_t *entityField;
+} gentity_fieldname_t;
+
+static gentity_fieldname_t gentity_fieldnames[GENTITY_FIELD_HASH_SIZE];
+static qboolean            gentity_fieldnames_built = qfalse;
+
+static unsigned int _etH_gentity_hashname(const char *name)
+{
+	unsigned int hash = 2166136261u;
+
+	for ( ; *name; name++)
+	{
+		hash = (hash ^ (unsigned char)tolower(*name)) * 16777619u;
+	}
+
+	return hash;
+}
+
+// returns the slot of fieldname, or the empty slot to store it in
+static gentity_fieldname_t *_etH_gentity_fieldslot(const char *fieldname)
+{
+	unsigned int i = _etH_gentity_hashname(fieldname) & (GENTITY_FIELD_HASH_SIZE - 1);
+
+	while (gentity_fieldnames[i].name && Q_stricmp(gentity_fieldnames[i].name, fieldname))
+	{
+		i = (i + 1) & (GENTITY_FIELD_HASH_SIZE - 1);
+	}
+
+	return &gentity_fieldnames[i];
+}
+
+static void _etH_gentity_buildfieldnames(void)
+{
+	gentity_fieldname_t *slot;
+	int                 i;
+
+	// first entry wins, as the linear scan did
+	for (i = 0; gclient_fields[i].name; i++)
+	{
+		slot = _etH_gentity_fieldslot(gclient_fields[i].name);
+		if (!slot->name)
+		{
+			slot->name        = gclient_fields[i].name;
+			slot->clientField = &gclient_fields[i];
+		}
+	}
+
+	for (i = 0; gentity_fields[i].name; i++)
+	{
+		slot = _etH_gentity_fieldslot(gentity_fields[i].name);
+		if (!slot->name)
+		{
+			slot->name = gentity_fields[i].name;
+		}
+		if (!slot->entityField)
+		{
+			slot->entityField = &gentity_fields[i];
+		}
+	}
+
+	gentity_fieldnames_built = qtrue;
+}
+
+static const gentity_fieldname_t *_etH_gentity_findfieldname(const char *fieldname)
+{
+	const gentity_fieldname_t *slot;
+
+	if (!gentity_fieldnames_built)
+	{
+		_etH_gentity_buildfieldnames();
+	}
+
+	slot = _etH_gentity_fieldslot(fieldname);
+
+	return slot->name ? slot : NULL;
+}
+
+// field name or handle from et.gentity_field() at stack index idx, NULL if invalid
+static const gentity_fieldname_t *_etH_gentity_tofieldname(lua_State *L, int idx)
+{
+	if (lua_type(L, idx) == LUA_TNUMBER)
+	{
+		lua_Integer handle = lua_tointeger(L, idx);
+
+		if (!gentity_fieldnames_built || handle < 1 || handle > GENTITY_FIELD_HASH_SIZE || !gentity_fieldnames[handle - 1].name)
+		{
+			return NULL;
+		}
+
+		return &gentity_fieldnames[handle - 1];
+	}
+
+	return _etH_gentity_findfieldname(luaL_checkstring(L, idx));
+}
+
+// client fields take precedence for entities with a client
+static const gentity_field_t *_etH_gentity_getfield(gentity_t *ent, const gentity_fieldname_t *fieldname)
+{
+	if (ent->client && fieldname->clientField)
+	{
+		return fieldname->clientField;
+	}
+
+	return fieldname->entityField;
+}
+
+// the field lookup before the names were hashed, kept for et.gentity_get_linear()
+static const gentity_field_t *_etH_gentity_scanfield(gentity_t *ent, const char *fieldname)
 {
 	int i;
 
@@ -1538,7 +1653,7 @@ static gentity_field_t *_etH_gentity_getfield(gentity_t *ent, char *fieldname)
 		{
 			if (Q_stricmp(fieldname, gclient_fields[i].name) == 0)
 			{
-				return (gentity_field_t *)&gclient_fields[i];
+				return &gclient_fields[i];
 			}
 		}
 	}
@@ -1547,11 +1662,11 @@ static gentity_field_t *_etH_gentity_getfield(gentity_t *ent, char *fieldname)
 	{
 		if (Q_stricmp(fieldname, gentity_fields[i].name) == 0)
 		{
-			return (gentity_field_t *)&gentity_fields[i];
+			return &gentity_fields[i];
 		}
 	}
 
-	return 0;
+	return NULL;
 }
 
 static void _etH_gentity_getvec3(lua_State *L, vec3_t vec3)
@@ -2043,29 +2158,15 @@ static int _et_G_SetSpawnVar(lua_State *L)
 }
 
 /**
- * Returns a field value associated with an entity.
- *
- * NOTE: `arrayindex` is required when accessing array type fields. Array indexes start at 0.
- *
- * @lua_def_prototype et.gentity_get(entnum, fieldname, arrayindex)
- * @lua_def ---@param entnum number the number of the entity.
- * @lua_def ---@param fieldname string the name of the field to get.
- * @lua_def ---@param arrayindex? number if present, specifies which element of an array entity field to get.
- * @lua_def ---@return nil|string|number|number[] value the returned field value. For NULL entities or clients, **nil** is returned.
+ * @brief Push the value of a field, nil for NULL entities or clients
+ * @param[in] L
+ * @param[in] ent
+ * @param[in] field
+ * @param[in] arrayindex Element of array type fields
  */
-static int _et_gentity_get(lua_State *L)
+static void _etH_gentity_pushfield(lua_State *L, gentity_t *ent, const gentity_field_t *field, int arrayindex)
 {
-	gentity_t       *ent       = g_entities + (int)luaL_checkinteger(L, 1);
-	const char      *fieldname = luaL_checkstring(L, 2);
-	gentity_field_t *field     = _etH_gentity_getfield(ent, (char *)fieldname);
-	uintptr_t       addr;
-
-	// break on invalid gentity field
-	if (!field)
-	{
-		luaL_error(L, "tried to get invalid gentity field \"%s\"", fieldname);
-		return 0;
-	}
+	uintptr_t addr;
 
 	if (field->flags & FIELD_FLAG_GENTITY)
 	{
@@ -2080,7 +2181,7 @@ static int _et_gentity_get(lua_State *L)
 	if (!addr)
 	{
 		lua_pushnil(L);
-		return 1;
+		return;
 	}
 
 	addr += field->mapping;
@@ -2089,7 +2190,7 @@ static int _et_gentity_get(lua_State *L)
 	{
 	case FIELD_INT:
 		lua_pushinteger(L, *(int *)addr);
-		return 1;
+		return;
 	case FIELD_STRING:
 		if (field->flags & FIELD_FLAG_NOPTR)
 		{
@@ -2099,10 +2200,10 @@ static int _et_gentity_get(lua_State *L)
 		{
 			lua_pushstring(L, *(char **)addr);
 		}
-		return 1;
+		return;
 	case FIELD_FLOAT:
 		lua_pushnumber(L, *(float *)addr);
-		return 1;
+		return;
 	case FIELD_ENTITY:
 	{
 		// core: return the entity-number of the entity that the pointer is pointing at.
@@ -2117,25 +2218,209 @@ static int _et_gentity_get(lua_State *L)
 			lua_pushinteger(L, entNum);
 		}
 	}
-		return 1;
+		return;
 	case FIELD_VEC3:
 		_etH_gentity_getvec3(L, *(vec3_t *)addr);
-		return 1;
+		return;
 	case FIELD_INT_ARRAY:
-		lua_pushinteger(L, (*(int *)(addr + (sizeof(int) * (int)luaL_optinteger(L, 3, 0)))));
-		return 1;
+		lua_pushinteger(L, (*(int *)(addr + (sizeof(int) * arrayindex))));
+		return;
 	case FIELD_TRAJECTORY:
 		_etH_gentity_gettrajectory(L, (trajectory_t *)addr);
-		return 1;
+		return;
 	case FIELD_FLOAT_ARRAY:
-		lua_pushnumber(L, (*(float *)(addr + (sizeof(int) * (int)luaL_optinteger(L, 3, 0)))));
-		return 1;
+		lua_pushnumber(L, (*(float *)(addr + (sizeof(int) * arrayindex))));
+		return;
 	case FIELD_WEAPONSTAT:
-		_etH_gentity_getweaponstat(L, (weapon_stat_t *)(addr + (sizeof(weapon_stat_t) * (int)luaL_optinteger(L, 3, 0))));
-		return 1;
+		_etH_gentity_getweaponstat(L, (weapon_stat_t *)(addr + (sizeof(weapon_stat_t) * arrayindex)));
+		return;
+	}
 
+	lua_pushnil(L);
+}
+
+/**
+ * Returns a field value associated with an entity.
+ *
+ * NOTE: `arrayindex` is required when accessing array type fields. Array indexes start at 0.
+ *
+ * @lua_def_prototype et.gentity_get(entnum, fieldname, arrayindex)
+ * @lua_def ---@param entnum number the number of the entity.
+ * @lua_def ---@param fieldname string|integer the name of the field to get, or a handle returned by et.gentity_field().
+ * @lua_def ---@param arrayindex? number if present, specifies which element of an array entity field to get.
+ * @lua_def ---@return nil|string|number|number[] value the returned field value. For NULL entities or clients, **nil** is returned.
+ */
+static int _et_gentity_get(lua_State *L)
+{
+	gentity_t                 *ent       = g_entities + (int)luaL_checkinteger(L, 1);
+	const gentity_fieldname_t *fieldname = _etH_gentity_tofieldname(L, 2);
+	const gentity_field_t     *field     = fieldname ? _etH_gentity_getfield(ent, fieldname) : NULL;
+
+	// break on invalid gentity field
+	if (!field)
+	{
+		luaL_error(L, "tried to get invalid gentity field \"%s\"", lua_tostring(L, 2));
+		return 0;
 	}
-	return 0;
+
+	_etH_gentity_pushfield(L, ent, field, (int)luaL_optinteger(L, 3, 0));
+	return 1;
+}
+
+/**
+ * Same as et.gentity_get() with a field name, but finds the field by scanning
+ * the field tables like et.gentity_get() did before the names were hashed.
+ * Only meant to compare the two lookups, see lua/gentity_bench.lua.
+ *
+ * @lua_def_prototype et.gentity_get_linear(entnum, fieldname, arrayindex)
+ * @lua_def ---@param entnum number the number of the entity.
+ * @lua_def ---@param fieldname string the name of the field to get.
+ * @lua_def ---@param arrayindex? number if present, specifies which element of an array entity field to get.
+ * @lua_def ---@return nil|string|number|number[] value the returned field value. For NULL entities or clients, **nil** is returned.
+ */
+static int _et_gentity_get_linear(lua_State *L)
+{
+	gentity_t             *ent       = g_entities + (int)luaL_checkinteger(L, 1);
+	const char            *fieldname = luaL_checkstring(L, 2);
+	const gentity_field_t *field     = _etH_gentity_scanfield(ent, fieldname);
+
+	// break on invalid gentity field
+	if (!field)
+	{
+		luaL_error(L, "tried to get invalid gentity field \"%s\"", fieldname);
+		return 0;
+	}
+
+	_etH_gentity_pushfield(L, ent, field, (int)luaL_optinteger(L, 3, 0));
+	return 1;
+}
+
+/**
+ * Returns a handle for a gentity field. The handle can be passed to
+ * et.gentity_get(), et.gentity_set() and et.gentity_getmulti() in place of the
+ * field name and stays valid for the lifetime of the server.
+ *
+ * @lua_def_prototype et.gentity_field(fieldname)
+ * @lua_def ---@param fieldname string the name of the field.
+ * @lua_def ---@return integer handle the field handle.
+ */
+static int _et_gentity_field(lua_State *L)
+{
+	const char                *name      = luaL_checkstring(L, 1);
+	const gentity_fieldname_t *fieldname = _etH_gentity_findfieldname(name);
+
+	if (!fieldname)
+	{
+		luaL_error(L, "tried to get invalid gentity field \"%s\"", name);
+		return 0;
+	}
+
+	lua_pushinteger(L, (fieldname - gentity_fieldnames) + 1);
+	return 1;
+}
+
+/**
+ * Returns several fields of several entities in one call.
+ *
+ * The result is indexed by entity number and then by field name, e.g.
+ * `result[0]["pers.netname"]`. Array type fields return their first element.
+ * Entities that are not in use are left out.
+ *
+ * @lua_def_prototype et.gentity_getmulti(entnums, fieldnames)
+ * @lua_def ---@param entnums nil|number|number[] the entities to read, nil for all client slots.
+ * @lua_def ---@param fieldnames (string|integer)[] the field names or handles returned by et.gentity_field().
+ * @lua_def ---@return table values the returned field values.
+ */
+static int _et_gentity_getmulti(lua_State *L)
+{
+	const gentity_fieldname_t *fieldnames[GENTITY_MULTI_MAX_FIELDS];
+	int                       numFields, numEnts, i, j, entnum;
+	qboolean                  list;
+
+	luaL_checktype(L, 2, LUA_TTABLE);
+
+	numFields = (int)lua_rawlen(L, 2);
+	if (numFields > GENTITY_MULTI_MAX_FIELDS)
+	{
+		luaL_error(L, "too many fields in et.gentity_getmulti (max %d)", GENTITY_MULTI_MAX_FIELDS);
+		return 0;
+	}
+
+	for (j = 0; j < numFields; j++)
+	{
+		lua_rawgeti(L, 2, j + 1);
+		fieldnames[j] = _etH_gentity_tofieldname(L, -1);
+		if (!fieldnames[j])
+		{
+			luaL_error(L, "tried to get invalid gentity field \"%s\"", lua_tostring(L, -1));
+			return 0;
+		}
+		lua_pop(L, 1);
+	}
+
+	list = lua_istable(L, 1);
+	if (list)
+	{
+		numEnts = (int)lua_rawlen(L, 1);
+	}
+	else if (lua_isnoneornil(L, 1))
+	{
+		numEnts = level.maxclients;
+	}
+	else
+	{
+		numEnts = 1;
+	}
+
+	lua_createtable(L, 0, numEnts);
+	for (i = 0; i < numEnts; i++)
+	{
+		gentity_t *ent;
+
+		if (list)
+		{
+			lua_rawgeti(L, 1, i + 1);
+			entnum = (int)luaL_checkinteger(L, -1);
+			lua_pop(L, 1);
+		}
+		else if (lua_isnoneornil(L, 1))
+		{
+			entnum = i;
+		}
+		else
+		{
+			entnum = (int)luaL_checkinteger(L, 1);
+		}
+
+		if (entnum < 0 || entnum >= MAX_GENTITIES)
+		{
+			luaL_error(L, "et.gentity_getmulti: entity number %d out of range", entnum);
+			return 0;
+		}
+
+		ent = g_entities + entnum;
+		if (!ent->inuse)
+		{
+			continue;
+		}
+
+		lua_createtable(L, 0, numFields);
+		for (j = 0; j < numFields; j++)
+		{
+			const gentity_field_t *field = _etH_gentity_getfield(ent, fieldnames[j]);
+
+			if (!field)
+			{
+				continue;
+			}
+
+			_etH_gentity_pushfield(L, ent, field, 0);
+			lua_setfield(L, -2, fieldnames[j]->name);
+		}
+		lua_rawseti(L, -2, entnum);
+	}
+
+	return 1;
 }
 
 /**
@@ -2143,29 +2428,29 @@ static int _et_gentity_get(lua_State *L)
  *
  * @lua_def_prototype et.gentity_set(entnum, fieldname, val1, val2)
  * @lua_def ---@param entnum number the entity number that is manipulated.
- * @lua_def ---@param fieldname string the name of the field to manipulate.
+ * @lua_def ---@param fieldname string|integer the name of the field to manipulate, or a handle returned by et.gentity_field().
  * @lua_def ---@param val1 nil|string|number|number[] the value to be set - if 'val2' is set 'val1' becomes the index to be set for the vector-field and 'val2' the value to be set.
  * @lua_def ---@param val2? nil|string|number if set, makes 'val1' the index of the vector-field and 'val2' the value of that index to be set.
  */
 static int _et_gentity_set(lua_State *L)
 {
-	gentity_t       *ent       = g_entities + (int)luaL_checkinteger(L, 1);
-	const char      *fieldname = luaL_checkstring(L, 2);
-	gentity_field_t *field     = _etH_gentity_getfield(ent, (char *)fieldname);
-	uintptr_t       addr;
-	const char      *buffer;
+	gentity_t                 *ent       = g_entities + (int)luaL_checkinteger(L, 1);
+	const gentity_fieldname_t *fieldname = _etH_gentity_tofieldname(L, 2);
+	const gentity_field_t     *field     = fieldname ? _etH_gentity_getfield(ent, fieldname) : NULL;
+	uintptr_t                 addr;
+	const char                *buffer;
 
 	// break on invalid gentity field
 	if (!field)
 	{
-		luaL_error(L, "tried to set invalid gentity field \"%s\"", fieldname);
+		luaL_error(L, "tried to set invalid gentity field \"%s\"", lua_tostring(L, 2));
 		return 0;
 	}
 
 	// break on read-only gentity field
 	if (field->flags & FIELD_FLAG_READONLY)
 	{
-		luaL_error(L, "tried to set read-only gentity field \"%s\"", fieldname);
+		luaL_error(L, "tried to set read-only gentity field \"%s\"", field->name);
 		return 0;
 	}
 
@@ -2200,9 +2485,23 @@ static int _et_gentity_set(lua_State *L)
 		}
 		else
 		{
+			// names searched by G_Find() are indexed by pointer, and the new
+			// name may be allocated where the old one was: take the entity out
+			// of the index before and put it back in afterwards
+			qboolean indexed = (field->flags & FIELD_FLAG_GENTITY) && G_EntityIndexed(field->mapping);
+
 			Com_Dealloc(*(char **)addr);
+			*(char **)addr = NULL;
+			if (indexed)
+			{
+				G_EntityIndexRefresh(ent);
+			}
 			*(char **)addr = Com_Allocate(strlen(buffer) + 1);
 			Q_strncpyz(*(char **)addr, buffer, strlen(buffer));
+			if (indexed)
+			{
+				G_EntityIndexRefresh(ent);
+			}
 		}
 		break;
 	case FIELD_FLOAT:
@@ -2552,7 +2851,10 @@ static const luaL_Reg etlib[] =
 	{ "G_GetSpawnVar",           _et_G_GetSpawnVar           },
 	{ "G_SetSpawnVar",           _et_G_SetSpawnVar           },
 	{ "gentity_get",             _et_gentity_get             },
+	{ "gentity_get_linear",      _et_gentity_get_linear      },
 	{ "gentity_set",             _et_gentity_set             },
+	{ "gentity_field",           _et_gentity_field           },
+	{ "gentity_getmulti",        _et_gentity_getmulti        },
 	{ "G_AddEvent",              _et_G_AddEvent              },
 	// Shaders
 	{ "G_ShaderRemap",           _et_G_ShaderRemap           },
@@ -1008,6 +1008,7 @@ void G_SetTargetName(gentity_t *ent, char *targetname)
 	{
 		ent->targetname     = targetname;
 		ent->targetnamehash = BG_StringHashValue(targetname);
+		G_EntityIndexRefresh(ent);
 	}
 	else
 	{
@@ -1201,6 +1202,7 @@ void G_FindTeams(void)
 					if (Q_stricmp(e2->classname, "func_door_rotating"))
 					{
 						e2->targetname = NULL;
+						G_EntityIndexRefresh(e2);
 					}
 				}
 			}
@@ -1714,6 +1716,8 @@ void G_InitGame(int levelTime, int randomSeed, int restart, int etLegacyServer,
 	// even if they aren't all used, so numbers inside that
 	// range are NEVER anything but clients
 	level.num_entities = MAX_CLIENTS;
+	G_ResetEntityAllocator();
+	G_EntityIndexReset();
 
 	for (i = 0 ; i < MAX_CLIENTS ; i++)
 	{
@@ -1910,6 +1914,9 @@ void G_ShutdownGame(int restart)
 	// Shutdown ETMan admin system
 	G_ETMan_Shutdown();
 
+	// post what is left of the ETPanel events and stop the sender
+	G_ETPanel_Shutdown();
+
 	// Reset panzerfest if active (map change during panzerfest)
 	G_PanzerfestShutdown();
 
@@ -3007,6 +3014,11 @@ void G_LogExit(const char *string)
 
 	G_LogPrintf("Exit: %s\n", string);
 
+#ifdef FEATURE_DBMS
+	// commit the intermission writes in one go
+	G_DB_BeginBatch();
+#endif
+
 #ifdef FEATURE_RATING
 	// record match ratings
 	if (g_skillRating.integer && g_gametype.integer != GT_WOLF_STOPWATCH && g_gametype.integer != GT_WOLF_LMS)
@@ -3060,6 +3072,10 @@ void G_LogExit(const char *string)
 		}
 	}
 
+#ifdef FEATURE_DBMS
+	G_DB_EndBatch();
+#endif
+
 	level.intermissionQueued = level.time;
 
 	// this will keep the clients from playing any voice sounds
@@ -4613,6 +4629,19 @@ void G_RunFrame(int levelTime)
 	// get any cvar changes
 	G_UpdateCvars();
 
+	// pick up entity renames the name indexes were not told about
+	G_EntityIndexSync();
+
+#ifdef FEATURE_DBMS
+	// hand out finished database loads
+	if (level.database.initialized)
+	{
+		G_DB_RunFrame();
+	}
+#endif
+
+	G_ETPanel_RunFrame();
+
 	if (G_DemoRunFrame())
 	{
 		return;
@@ -31,10 +31,25 @@
 
 #define PRCHECK_SQLWRAP_TABLES "SELECT * FROM prestige_users;"
 #define PRCHECK_SQLWRAP_SCHEMA "SELECT guid, prestige, streak, skill0, skill1, skill2, skill3, skill4, skill5, skill6, created, updated FROM prestige_users;"
-#define PRUSERS_SQLWRAP_SELECT "SELECT * FROM prestige_users WHERE guid = '%s';"
+#define PRUSERS_SQLWRAP_SELECT "SELECT * FROM prestige_users WHERE guid = ?;"
 #define PRUSERS_SQLWRAP_INSERT "INSERT INTO prestige_users " \
-							   "(guid, prestige, streak, skill0, skill1, skill2, skill3, skill4, skill5, skill6, created, updated) VALUES ('%s', '%i', '%i', '%i', '%i', '%i', '%i', '%i', '%i', '%i', CURRENT_TIMESTAMP, CURRENT_TIMESTAMP);"
-#define PRUSERS_SQLWRAP_UPDATE "UPDATE prestige_users SET prestige = '%i', streak = '%i', skill0 = '%i', skill1 = '%i', skill2 = '%i', skill3 = '%i', skill4 = '%i', skill5 = '%i', skill6 = '%i', updated = CURRENT_TIMESTAMP WHERE guid = '%s';"
+							   "(prestige, streak, skill0, skill1, skill2, skill3, skill4, skill5, skill6, guid, created, updated) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, CURRENT_TIMESTAMP, CURRENT_TIMESTAMP);"
+#define PRUSERS_SQLWRAP_UPDATE "UPDATE prestige_users SET prestige = ?, streak = ?, skill0 = ?, skill1 = ?, skill2 = ?, skill3 = ?, skill4 = ?, skill5 = ?, skill6 = ?, updated = CURRENT_TIMESTAMP WHERE guid = ?;"
+
+#define PRESTIGE_STREAK_RESET -1        ///< streakChange value that resets the streak
+
+/**
+ * @struct prJob_t
+ * @brief Payload of the prestige jobs
+ */
+typedef struct
+{
+	prData_t data;
+	int streakChange;                   ///< added to the stored streak, or PRESTIGE_STREAK_RESET
+} prJob_t;
+
+static int G_ReadPrestige(prData_t *pr_data);
+static int G_WritePrestige(prData_t *pr_data);
 
 /**
  * @brief Checks if database exists, if tables exist and if schemas are correct
@@ -115,17 +130,62 @@ int G_PrestigeDBCheck(char *db_path, int db_mode)
 	return 0;
 }
 
+/**
+ * @brief Persistence thread part of G_GetClientPrestige
+ * @param[in,out] job
+ * @return 0 if successful, 1 otherwise.
+ */
+static int G_PrestigeRunLoad(dbJob_t *job)
+{
+	prJob_t *pr_job = (prJob_t *)job->data;
+
+	pr_job->data.guid = (const unsigned char *)job->guid;
+
+	return G_ReadPrestige(&pr_job->data);
+}
+
+/**
+ * @brief Assigns the loaded prestige to the client
+ * @param[in] job
+ */
+static void G_PrestigeFinishLoad(dbJob_t *job)
+{
+	prJob_t   *pr_job = (prJob_t *)job->data;
+	gclient_t *cl     = G_DB_JobClient(job);
+	int       i;
+
+	if (!cl || job->status)
+	{
+		return;
+	}
+
+	// assign user data to session
+	cl->sess.prestige     = pr_job->data.prestige;
+	cl->sess.startxptotal = 0;
+
+	for (i = 0; i < SK_NUM_SKILLS; i++)
+	{
+		cl->sess.skillpoints[i]      = pr_job->data.skillpoints[i];
+		cl->sess.startskillpoints[i] = pr_job->data.skillpoints[i];
+		cl->sess.startxptotal       += pr_job->data.skillpoints[i];
+	}
+
+	for (i = 0; i < SK_NUM_SKILLS; i++)
+	{
+		G_SetPlayerSkill(cl, i);
+	}
+}
+
 /**
  * @brief Retrieve prestige for client
- *         Called on ClientConnect
+ *         Called on ClientConnect, the client gets it once the persistence thread has read it
  * @param[in] cl
  */
 void G_GetClientPrestige(gclient_t *cl)
 {
 	char      userinfo[MAX_INFO_STRING];
-	char      *guid;
-	int       clientNum, i;
-	prData_t  pr_data;
+	int       clientNum;
+	dbJob_t   job;
 	gentity_t *ent;
 
 	// disable for these game types
@@ -155,29 +215,50 @@ void G_GetClientPrestige(gclient_t *cl)
 		return;
 	}
 
+	Com_Memset(&job, 0, sizeof(job));
+	job.op        = DB_OP_PRESTIGE_LOAD;
+	job.run       = G_PrestigeRunLoad;
+	job.finish    = G_PrestigeFinishLoad;
+	job.clientNum = clientNum;
+
 	// retrieve guid
 	trap_GetUserinfo(clientNum, userinfo, sizeof(userinfo));
-	guid = Info_ValueForKey(userinfo, "cl_guid");
-
-	// assign guid
-	pr_data.guid = (const unsigned char *)guid;
+	Q_strncpyz(job.guid, Info_ValueForKey(userinfo, "cl_guid"), sizeof(job.guid));
 
 	// retrieve current prestige or assign default values
-	if (G_ReadPrestige(&pr_data))
+	G_DB_Queue(&job);
+}
+
+/**
+ * @brief Persistence thread part of G_SetClientPrestige
+ * @param[in,out] job
+ * @return 0 if successful, 1 otherwise.
+ */
+static int G_PrestigeRunStore(dbJob_t *job)
+{
+	prJob_t  *pr_job = (prJob_t *)job->data;
+	prData_t stored;
+
+	pr_job->data.guid = (const unsigned char *)job->guid;
+	stored.guid       = pr_job->data.guid;
+
+	// retrieve current streak or assign default values
+	if (G_ReadPrestige(&stored))
 	{
-		return;
+		return 1;
 	}
 
-	// assign user data to session
-	cl->sess.prestige     = pr_data.prestige;
-	cl->sess.startxptotal = 0;
-
-	for (i = 0; i < SK_NUM_SKILLS; i++)
+	if (pr_job->streakChange == PRESTIGE_STREAK_RESET)
 	{
-		cl->sess.skillpoints[i]      = pr_data.skillpoints[i];
-		cl->sess.startskillpoints[i] = pr_data.skillpoints[i];
-		cl->sess.startxptotal       += pr_data.skillpoints[i];
+		pr_job->data.streak = 0;
 	}
+	else
+	{
+		pr_job->data.streak = stored.streak + pr_job->streakChange;
+	}
+
+	// save or update prestige
+	return G_WritePrestige(&pr_job->data);
 }
 
 /**
@@ -188,9 +269,9 @@ void G_GetClientPrestige(gclient_t *cl)
 void G_SetClientPrestige(gclient_t *cl, qboolean streakUp)
 {
 	char      userinfo[MAX_INFO_STRING];
-	char      *guid;
 	int       clientNum, i, j, skillMax, cnt = 0;
-	prData_t  pr_data;
+	dbJob_t   job;
+	prJob_t   *pr_job = (prJob_t *)job.data;
 	gentity_t *ent;
 	qboolean  hasMapXPs = qfalse;
 
@@ -227,11 +308,14 @@ void G_SetClientPrestige(gclient_t *cl, qboolean streakUp)
 		return;
 	}
 
+	Com_Memset(&job, 0, sizeof(job));
+	job.op        = DB_OP_PRESTIGE_STORE;
+	job.run       = G_PrestigeRunStore;
+	job.clientNum = clientNum;
+
 	// retrieve guid
 	trap_GetUserinfo(clientNum, userinfo, sizeof(userinfo));
-	guid = Info_ValueForKey(userinfo, "cl_guid");
-
-	pr_data.guid = (const unsigned char *)guid;
+	Q_strncpyz(job.guid, Info_ValueForKey(userinfo, "cl_guid"), sizeof(job.guid));
 
 	// count the number of maxed out skills
 	for (i = 0; i < SK_NUM_SKILLS; i++)
@@ -254,16 +338,10 @@ void G_SetClientPrestige(gclient_t *cl, qboolean streakUp)
 		}
 	}
 
-	// retrieve current streak or assign default values
-	if (G_ReadPrestige(&pr_data))
-	{
-		return;
-	}
-
 	// increase streak if all skills are maxed out
 	if (cnt >= SK_NUM_SKILLS && streakUp)
 	{
-		pr_data.streak += 1;
+		pr_job->streakChange = 1;
 	}
 
 	// prestige button clicked in intermission
@@ -290,15 +368,15 @@ void G_SetClientPrestige(gclient_t *cl, qboolean streakUp)
 		}
 
 		// reset streak
-		pr_data.streak = 0;
+		pr_job->streakChange = PRESTIGE_STREAK_RESET;
 	}
 
 	// assign match data
-	pr_data.prestige = cl->sess.prestige;
+	pr_job->data.prestige = cl->sess.prestige;
 
 	for (i = 0; i < SK_NUM_SKILLS; i++)
 	{
-		pr_data.skillpoints[i] = (int)cl->sess.skillpoints[i];
+		pr_job->data.skillpoints[i] = (int)cl->sess.skillpoints[i];
 
 		// check for new points this map
 		if (!hasMapXPs && (cl->sess.skillpoints[i] - cl->sess.startskillpoints[i]) != 0.f) // Skillpoints can be negative
@@ -313,11 +391,8 @@ void G_SetClientPrestige(gclient_t *cl, qboolean streakUp)
 		return;
 	}
 
-	// save or update prestige
-	if (G_WritePrestige(&pr_data))
-	{
-		return;
-	}
+	// the stored streak is read and updated on the persistence thread
+	G_DB_Queue(&job);
 }
 
 /**
@@ -325,27 +400,15 @@ void G_SetClientPrestige(gclient_t *cl, qboolean streakUp)
  * @param[in] pr_data
  * @return 0 if successful, 1 otherwise.
  */
-int G_ReadPrestige(prData_t *pr_data)
+static int G_ReadPrestige(prData_t *pr_data)
 {
 	int          result, i;
-	char         *err_msg = NULL;
-	char         *sql;
 	sqlite3_stmt *sqlstmt;
 
-	if (!level.database.initialized)
-	{
-		G_Printf("G_ReadPrestige: access to non-initialized database\n");
-		return 1;
-	}
-
-	sql = va(PRUSERS_SQLWRAP_SELECT, pr_data->guid);
+	sqlstmt = G_DB_Statement(PRUSERS_SQLWRAP_SELECT);
 
-	result = sqlite3_prepare(level.database.db, sql, strlen(sql), &sqlstmt, NULL);
-
-	if (result != SQLITE_OK)
+	if (!sqlstmt || sqlite3_bind_text(sqlstmt, 1, (const char *)pr_data->guid, -1, SQLITE_STATIC) != SQLITE_OK)
 	{
-		G_Printf("G_ReadPrestige: sqlite3_prepare failed: %s\n", err_msg);
-		sqlite3_free(err_msg);
 		return 1;
 	}
 
@@ -378,22 +441,10 @@ int G_ReadPrestige(prData_t *pr_data)
 		}
 		else
 		{
-			sqlite3_finalize(sqlstmt);
-
-			G_Printf("G_ReadPrestige: sqlite3_step failed: %s\n", err_msg);
-			sqlite3_free(err_msg);
 			return 1;
 		}
 	}
 
-	result = sqlite3_finalize(sqlstmt);
-
-	if (result != SQLITE_OK)
-	{
-		G_Printf("G_ReadPrestige: sqlite3_finalize failed\n");
-		return 1;
-	}
-
 	return 0;
 }
 
@@ -402,27 +453,15 @@ int G_ReadPrestige(prData_t *pr_data)
  * @param[in] pr_data
  * @return 0 if successful, 1 otherwise.
  */
-int G_WritePrestige(prData_t *pr_data)
+static int G_WritePrestige(prData_t *pr_data)
 {
-	int          result;
-	char         *err_msg = NULL;
-	char         *sql;
+	int          result, i;
 	sqlite3_stmt *sqlstmt;
 
-	if (!level.database.initialized)
-	{
-		G_Printf("G_WritePrestige: access to non-initialized database\n");
-		return 1;
-	}
-
-	sql = va(PRUSERS_SQLWRAP_SELECT, pr_data->guid);
-
-	result = sqlite3_prepare(level.database.db, sql, strlen(sql), &sqlstmt, NULL);
+	sqlstmt = G_DB_Statement(PRUSERS_SQLWRAP_SELECT);
 
-	if (result != SQLITE_OK)
+	if (!sqlstmt || sqlite3_bind_text(sqlstmt, 1, (const char *)pr_data->guid, -1, SQLITE_STATIC) != SQLITE_OK)
 	{
-		G_Printf("G_WritePrestige: sqlite3_prepare failed: %s\n", err_msg);
-		sqlite3_free(err_msg);
 		return 1;
 	}
 
@@ -430,56 +469,36 @@ int G_WritePrestige(prData_t *pr_data)
 
 	if (result == SQLITE_DONE)
 	{
-		sql = va(PRUSERS_SQLWRAP_INSERT,
-		         pr_data->guid,
-		         pr_data->prestige,
-		         pr_data->streak,
-		         pr_data->skillpoints[0],
-		         pr_data->skillpoints[1],
-		         pr_data->skillpoints[2],
-		         pr_data->skillpoints[3],
-		         pr_data->skillpoints[4],
-		         pr_data->skillpoints[5],
-		         pr_data->skillpoints[6]);
-
-		result = sqlite3_exec(level.database.db, sql, NULL, NULL, &err_msg);
-
-		if (result != SQLITE_OK)
-		{
-			G_Printf("G_WritePrestige: sqlite3_exec:INSERT failed: %s\n", err_msg);
-			sqlite3_free(err_msg);
-			return 1;
-		}
+		sqlstmt = G_DB_Statement(PRUSERS_SQLWRAP_INSERT);
+	}
+	else if (result == SQLITE_ROW)
+	{
+		sqlstmt = G_DB_Statement(PRUSERS_SQLWRAP_UPDATE);
 	}
 	else
 	{
-		sql = va(PRUSERS_SQLWRAP_UPDATE,
-		         pr_data->prestige,
-		         pr_data->streak,
-		         (int)pr_data->skillpoints[0],
-		         (int)pr_data->skillpoints[1],
-		         (int)pr_data->skillpoints[2],
-		         (int)pr_data->skillpoints[3],
-		         (int)pr_data->skillpoints[4],
-		         (int)pr_data->skillpoints[5],
-		         (int)pr_data->skillpoints[6],
-		         pr_data->guid);
+		return 1;
+	}
+
+	if (!sqlstmt)
+	{
+		return 1;
+	}
 
-		result = sqlite3_exec(level.database.db, sql, NULL, NULL, &err_msg);
+	sqlite3_bind_int(sqlstmt, 1, pr_data->prestige);
+	sqlite3_bind_int(sqlstmt, 2, pr_data->streak);
 
-		if (result != SQLITE_OK)
-		{
-			G_Printf("G_WritePrestige: sqlite3_exec:UPDATE failed: %s\n", err_msg);
-			sqlite3_free(err_msg);
-			return 1;
-		}
+	for (i = 0; i < SK_NUM_SKILLS; i++)
+	{
+		sqlite3_bind_int(sqlstmt, i + 3, pr_data->skillpoints[i]);
 	}
 
-	result = sqlite3_finalize(sqlstmt);
+	sqlite3_bind_text(sqlstmt, SK_NUM_SKILLS + 3, (const char *)pr_data->guid, -1, SQLITE_STATIC);
 
-	if (result != SQLITE_OK)
+	result = sqlite3_step(sqlstmt);
+
+	if (result != SQLITE_DONE)
 	{
-		G_Printf("G_WritePrestige: sqlite3_finalize failed\n");
 		return 1;
 	}
 
@@ -36,16 +36,16 @@
 							   "SELECT guid, mu, sigma, time_axis, time_allies FROM rating_match; " \
 							   "SELECT mapname, win_axis, win_allies FROM rating_maps;"
 #define SRMATCH_SQLWRAP_DELETE "DELETE FROM rating_match;"
-#define SRMATCH_SQLWRAP_SELECT "SELECT * FROM rating_match WHERE guid = '%s';"
+#define SRMATCH_SQLWRAP_SELECT "SELECT * FROM rating_match WHERE guid = ?;"
 #define SRMATCH_SQLWRAP_INSERT "INSERT INTO rating_match " \
-							   "(guid, mu, sigma, time_axis, time_allies) VALUES ('%s', '%f', '%f', '%i', '%i');"
+							   "(mu, sigma, time_axis, time_allies, guid) VALUES (?, ?, ?, ?, ?);"
 #define SRMATCH_SQLWRAP_UPDATE "UPDATE rating_match " \
-							   "SET mu = '%f', sigma = '%f', time_axis = '%i', time_allies = '%i' WHERE guid = '%s';"
-#define SRUSERS_SQLWRAP_SELECT "SELECT * FROM rating_users WHERE guid = '%s';"
+							   "SET mu = ?, sigma = ?, time_axis = ?, time_allies = ? WHERE guid = ?;"
+#define SRUSERS_SQLWRAP_SELECT "SELECT * FROM rating_users WHERE guid = ?;"
 #define SRUSERS_SQLWRAP_INSERT "INSERT INTO rating_users " \
-							   "(guid, mu, sigma, created, updated) VALUES ('%s', '%f', '%f', CURRENT_TIMESTAMP, CURRENT_TIMESTAMP);"
+							   "(mu, sigma, guid, created, updated) VALUES (?, ?, ?, CURRENT_TIMESTAMP, CURRENT_TIMESTAMP);"
 #define SRUSERS_SQLWRAP_UPDATE "UPDATE rating_users " \
-							   "SET mu = '%f', sigma = '%f', updated = CURRENT_TIMESTAMP WHERE guid = '%s';"
+							   "SET mu = ?, sigma = ?, updated = CURRENT_TIMESTAMP WHERE guid = ?;"
 #define SRMATCH_SQLWRAP_TABLE  "SELECT * FROM rating_match;"
 #define SRMAPS_SQLWRAP_SELECT  "SELECT * FROM rating_maps WHERE mapname = '%s';"
 #define SRMAPS_SQLWRAP_INSERT  "INSERT INTO rating_maps " \
@@ -53,6 +53,20 @@
 #define SRMAPS_SQLWRAP_UPDATE  "UPDATE rating_maps " \
 							   "SET win_axis = win_axis + '%i', win_allies = win_allies + '%i' WHERE mapname = '%s';"
 
+#define SR_JOB_USER      1             ///< use rating_users instead of rating_match
+#define SR_JOB_RESETTIME 2             ///< load: clear the time played
+#define SR_JOB_SETOLD    4             ///< load: start the delta rating from here
+
+/**
+ * @struct srJob_t
+ * @brief Payload of the rating jobs
+ */
+typedef struct
+{
+	srData_t data;
+	int flags;                          ///< SR_JOB_*
+} srJob_t;
+
 // MU      25            - mean
 // SIGMA   MU / 3        - standard deviation
 // BETA    SIGMA / 2     - skill chain length
@@ -155,6 +169,8 @@ int G_SkillRatingPrepareMatchRating(void)
 		return 1;
 	}
 
+	G_DB_Flush();
+
 	result = sqlite3_prepare(level.database.db, SRMATCH_SQLWRAP_DELETE, strlen(SRMATCH_SQLWRAP_DELETE), &sqlstmt, NULL);
 
 	if (result != SQLITE_OK)
@@ -190,36 +206,35 @@ int G_SkillRatingPrepareMatchRating(void)
 }
 
 /**
- * @brief Retrieve rating from the rating_match table
- * @param[in] sr_data
- * @return 0 if successful, 2 if data is not found, 1 otherwise.
+ * @brief Step a cached SELECT ... WHERE guid = ? statement
+ * @param[in] sql
+ * @param[in] guid
+ * @param[out] sqlstmt
+ * @return sqlite3_step result, SQLITE_ERROR if the statement can't be set up
  */
-int G_SkillRatingGetMatchRating(srData_t *sr_data)
+static int G_SkillRatingSelect(const char *sql, const unsigned char *guid, sqlite3_stmt **sqlstmt)
 {
-	int          result;
-	char         *err_msg = NULL;
-	char         *sql;
-	sqlite3_stmt *sqlstmt;
-	qboolean     datafound = qtrue;
+	*sqlstmt = G_DB_Statement(sql);
 
-	if (!level.database.initialized)
+	if (!*sqlstmt || sqlite3_bind_text(*sqlstmt, 1, (const char *)guid, -1, SQLITE_STATIC) != SQLITE_OK)
 	{
-		G_Printf("G_SkillRatingGetMatchRating: access to non-initialized database\n");
-		return 1;
+		return SQLITE_ERROR;
 	}
 
-	sql = va(SRMATCH_SQLWRAP_SELECT, sr_data->guid);
-
-	result = sqlite3_prepare(level.database.db, sql, strlen(sql), &sqlstmt, NULL);
-
-	if (result != SQLITE_OK)
-	{
-		G_Printf("G_SkillRatingGetMatchRating: sqlite3_prepare failed: %s\n", err_msg);
-		sqlite3_free(err_msg);
-		return 1;
-	}
+	return sqlite3_step(*sqlstmt);
+}
 
-	result = sqlite3_step(sqlstmt);
+/**
+ * @brief Retrieve rating from the rating_match table
+ * @param[in] sr_data
+ * @return 0 if successful, 2 if data is not found, 1 otherwise.
+ *
+ * @note Runs on the persistence thread, or on the game thread right after G_DB_Flush()
+ */
+int G_SkillRatingGetMatchRating(srData_t *sr_data)
+{
+	sqlite3_stmt *sqlstmt;
+	int          result = G_SkillRatingSelect(SRMATCH_SQLWRAP_SELECT, sr_data->guid, &sqlstmt);
 
 	if (result == SQLITE_ROW)
 	{
@@ -228,144 +243,73 @@ int G_SkillRatingGetMatchRating(srData_t *sr_data)
 		sr_data->sigma       = sqlite3_column_double(sqlstmt, 2);
 		sr_data->time_axis   = sqlite3_column_int(sqlstmt, 3);
 		sr_data->time_allies = sqlite3_column_int(sqlstmt, 4);
+		return 0;
 	}
-	else
-	{
-		// no entry found (failsafe) or other failure
-		if (result == SQLITE_DONE)
-		{
-			// assign default values (failsafe)
-			sr_data->mu          = MU;
-			sr_data->sigma       = SIGMA;
-			sr_data->time_axis   = 0;
-			sr_data->time_allies = 0;
 
-			datafound = qfalse;
-		}
-		else
-		{
-			sqlite3_finalize(sqlstmt);
-
-			G_Printf("G_SkillRatingGetMatchRating: sqlite3_step failed: %s\n", err_msg);
-			sqlite3_free(err_msg);
-			return 1;
-		}
-	}
-
-	result = sqlite3_finalize(sqlstmt);
-
-	if (result != SQLITE_OK)
-	{
-		G_Printf("G_SkillRatingGetMatchRating: sqlite3_finalize failed\n");
-		return 1;
-	}
-
-	if (!datafound)
+	// no entry found (failsafe) or other failure
+	if (result == SQLITE_DONE)
 	{
+		// assign default values (failsafe)
+		sr_data->mu          = MU;
+		sr_data->sigma       = SIGMA;
+		sr_data->time_axis   = 0;
+		sr_data->time_allies = 0;
 		return 2;
 	}
-	return 0;
+
+	return 1;
 }
 
 /**
  * @brief Sets or updates rating and time played in the rating_match table
  * @param[in] sr_data
  * @return 0 if successful, 1 otherwise.
+ *
+ * @note Runs on the persistence thread, or on the game thread right after G_DB_Flush()
  */
 int G_SkillRatingSetMatchRating(srData_t *sr_data)
 {
-	int          result;
-	char         *err_msg = NULL;
-	char         *sql;
 	sqlite3_stmt *sqlstmt;
+	int          result = G_SkillRatingSelect(SRMATCH_SQLWRAP_SELECT, sr_data->guid, &sqlstmt);
 
-	if (!level.database.initialized)
+	if (result == SQLITE_DONE)
 	{
-		G_Printf("G_SkillRatingSetMatchRating: access to non-initialized database\n");
-		return 1;
+		sqlstmt = G_DB_Statement(SRMATCH_SQLWRAP_INSERT);
 	}
-
-	sql = va(SRMATCH_SQLWRAP_SELECT, sr_data->guid);
-
-	result = sqlite3_prepare(level.database.db, sql, strlen(sql), &sqlstmt, NULL);
-
-	if (result != SQLITE_OK)
+	else if (result == SQLITE_ROW)
 	{
-		G_Printf("G_SkillRatingSetMatchRating: sqlite3_prepare failed: %s\n", err_msg);
-		sqlite3_free(err_msg);
-		return 1;
-	}
-
-	result = sqlite3_step(sqlstmt);
-
-	if (result == SQLITE_DONE)
-	{
-		sql = va(SRMATCH_SQLWRAP_INSERT, sr_data->guid, sr_data->mu, sr_data->sigma, sr_data->time_axis, sr_data->time_allies);
-
-		result = sqlite3_exec(level.database.db, sql, NULL, NULL, &err_msg);
-
-		if (result != SQLITE_OK)
-		{
-			G_Printf("G_SkillRatingSetMatchRating: sqlite3_exec:INSERT failed: %s\n", err_msg);
-			sqlite3_free(err_msg);
-			return 1;
-		}
+		sqlstmt = G_DB_Statement(SRMATCH_SQLWRAP_UPDATE);
 	}
 	else
 	{
-		sql = va(SRMATCH_SQLWRAP_UPDATE, sr_data->mu, sr_data->sigma, sr_data->time_axis, sr_data->time_allies, sr_data->guid);
-
-		result = sqlite3_exec(level.database.db, sql, NULL, NULL, &err_msg);
-
-		if (result != SQLITE_OK)
-		{
-			G_Printf("G_SkillRatingSetMatchRating: sqlite3_exec:UPDATE failed: %s\n", err_msg);
-			sqlite3_free(err_msg);
-			return 1;
-		}
+		return 1;
 	}
 
-	result = sqlite3_finalize(sqlstmt);
-
-	if (result != SQLITE_OK)
+	if (!sqlstmt)
 	{
-		G_Printf("G_SkillRatingSetMatchRating: sqlite3_finalize failed\n");
 		return 1;
 	}
 
-	return 0;
+	sqlite3_bind_double(sqlstmt, 1, sr_data->mu);
+	sqlite3_bind_double(sqlstmt, 2, sr_data->sigma);
+	sqlite3_bind_int(sqlstmt, 3, sr_data->time_axis);
+	sqlite3_bind_int(sqlstmt, 4, sr_data->time_allies);
+	sqlite3_bind_text(sqlstmt, 5, (const char *)sr_data->guid, -1, SQLITE_STATIC);
+
+	return sqlite3_step(sqlstmt) == SQLITE_DONE ? 0 : 1;
 }
 
 /**
  * @brief Retrieve rating from the rating_users table
  * @param[in] sr_data
  * @return 0 if successful, 1 otherwise.
+ *
+ * @note Runs on the persistence thread, or on the game thread right after G_DB_Flush()
  */
 int G_SkillRatingGetUserRating(srData_t *sr_data)
 {
-	int          result;
-	char         *err_msg = NULL;
-	char         *sql;
 	sqlite3_stmt *sqlstmt;
-
-	if (!level.database.initialized)
-	{
-		G_Printf("G_SkillRatingGetUserRating: access to non-initialized database\n");
-		return 1;
-	}
-
-	sql = va(SRUSERS_SQLWRAP_SELECT, sr_data->guid);
-
-	result = sqlite3_prepare(level.database.db, sql, strlen(sql), &sqlstmt, NULL);
-
-	if (result != SQLITE_OK)
-	{
-		G_Printf("G_SkillRatingGetUserRating: sqlite3_prepare failed: %s\n", err_msg);
-		sqlite3_free(err_msg);
-		return 1;
-	}
-
-	result = sqlite3_step(sqlstmt);
+	int          result = G_SkillRatingSelect(SRUSERS_SQLWRAP_SELECT, sr_data->guid, &sqlstmt);
 
 	if (result == SQLITE_ROW)
 	{
@@ -374,119 +318,156 @@ int G_SkillRatingGetUserRating(srData_t *sr_data)
 		sr_data->sigma       = sqlite3_column_double(sqlstmt, 2);
 		sr_data->time_axis   = 0;
 		sr_data->time_allies = 0;
+		return 0;
 	}
-	else
-	{
-		// no entry found or other failure
-		if (result == SQLITE_DONE)
-		{
-			// assign default values
-			sr_data->mu          = MU;
-			sr_data->sigma       = SIGMA;
-			sr_data->time_axis   = 0;
-			sr_data->time_allies = 0;
-		}
-		else
-		{
-			sqlite3_finalize(sqlstmt);
-
-			G_Printf("G_SkillRatingGetUserRating: sqlite3_step failed: %s\n", err_msg);
-			sqlite3_free(err_msg);
-			return 1;
-		}
-	}
-
-	result = sqlite3_finalize(sqlstmt);
 
-	if (result != SQLITE_OK)
+	// no entry found or other failure
+	if (result == SQLITE_DONE)
 	{
-		G_Printf("G_SkillRatingGetUserRating: sqlite3_finalize failed\n");
-		return 1;
+		// assign default values
+		sr_data->mu          = MU;
+		sr_data->sigma       = SIGMA;
+		sr_data->time_axis   = 0;
+		sr_data->time_allies = 0;
+		return 0;
 	}
 
-	return 0;
+	return 1;
 }
 
 /**
  * @brief Sets or updates rating and timestamps in the rating_users table
  * @param[in] sr_data
  * @return 0 if successful, 1 otherwise.
+ *
+ * @note Runs on the persistence thread, or on the game thread right after G_DB_Flush()
  */
 int G_SkillRatingSetUserRating(srData_t *sr_data)
 {
-	int          result;
-	char         *err_msg = NULL;
-	char         *sql;
 	sqlite3_stmt *sqlstmt;
+	int          result = G_SkillRatingSelect(SRUSERS_SQLWRAP_SELECT, sr_data->guid, &sqlstmt);
 
-	if (!level.database.initialized)
+	if (result == SQLITE_DONE)
+	{
+		sqlstmt = G_DB_Statement(SRUSERS_SQLWRAP_INSERT);
+	}
+	else if (result == SQLITE_ROW)
+	{
+		sqlstmt = G_DB_Statement(SRUSERS_SQLWRAP_UPDATE);
+	}
+	else
 	{
-		G_Printf("G_SkillRatingSetUserRating: access to non-initialized database\n");
 		return 1;
 	}
 
-	sql = va(SRUSERS_SQLWRAP_SELECT, sr_data->guid);
+	if (!sqlstmt)
+	{
+		return 1;
+	}
 
-	result = sqlite3_prepare(level.database.db, sql, strlen(sql), &sqlstmt, NULL);
+	sqlite3_bind_double(sqlstmt, 1, sr_data->mu);
+	sqlite3_bind_double(sqlstmt, 2, sr_data->sigma);
+	sqlite3_bind_text(sqlstmt, 3, (const char *)sr_data->guid, -1, SQLITE_STATIC);
 
-	if (result != SQLITE_OK)
+	return sqlite3_step(sqlstmt) == SQLITE_DONE ? 0 : 1;
+}
+
+/**
+ * @brief Persistence thread part of G_SkillRatingGetClientRating
+ * @param[in,out] job
+ * @return 0 if successful, 1 otherwise.
+ */
+static int G_SkillRatingRunLoad(dbJob_t *job)
+{
+	srJob_t *sr_job = (srJob_t *)job->data;
+
+	sr_job->data.guid = (const unsigned char *)job->guid;
+
+	if (sr_job->flags & SR_JOB_USER)
 	{
-		G_Printf("G_SkillRatingSetUserRating: sqlite3_prepare failed: %s\n", err_msg);
-		sqlite3_free(err_msg);
+		// retrieve rating from rating_users table
+		return G_SkillRatingGetUserRating(&sr_job->data);
+	}
+
+	// retrieve rating from rating_match or rating_users table or set default values
+	switch (G_SkillRatingGetMatchRating(&sr_job->data))
+	{
+	case 1:
+		// error occurred
 		return 1;
+	case 2:
+		// data not found in rating_match
+		G_SkillRatingGetUserRating(&sr_job->data);
+		break;
+	case 0:
+	// data found
+	default:
+		break;
 	}
 
-	result = sqlite3_step(sqlstmt);
+	return 0;
+}
 
-	if (result == SQLITE_DONE)
+/**
+ * @brief Assigns the loaded rating to the client and updates the rank
+ * @param[in] job
+ */
+static void G_SkillRatingFinishLoad(dbJob_t *job)
+{
+	srJob_t   *sr_job = (srJob_t *)job->data;
+	gclient_t *cl     = G_DB_JobClient(job);
+
+	if (!cl || job->status)
 	{
-		sql = va(SRUSERS_SQLWRAP_INSERT, sr_data->guid, sr_data->mu, sr_data->sigma);
+		return;
+	}
 
-		result = sqlite3_exec(level.database.db, sql, NULL, NULL, &err_msg);
+	if (sr_job->flags & SR_JOB_USER)
+	{
+		// assign user data to session
+		cl->sess.mu    = sr_job->data.mu;
+		cl->sess.sigma = sr_job->data.sigma;
 
-		if (result != SQLITE_OK)
+		// ensure auto statsdump is correct
+		if (sr_job->flags & SR_JOB_RESETTIME)
 		{
-			G_Printf("G_SkillRatingSetUserRating: sqlite3_exec:INSERT failed: %s\n", err_msg);
-			sqlite3_free(err_msg);
-			return 1;
+			cl->sess.time_axis   = 0;
+			cl->sess.time_allies = 0;
 		}
 	}
 	else
 	{
-		sql = va(SRUSERS_SQLWRAP_UPDATE, sr_data->mu, sr_data->sigma, sr_data->guid);
-
-		result = sqlite3_exec(level.database.db, sql, NULL, NULL, &err_msg);
-
-		if (result != SQLITE_OK)
-		{
-			G_Printf("G_SkillRatingSetUserRating: sqlite3_exec:UPDATE failed: %s\n", err_msg);
-			sqlite3_free(err_msg);
-			return 1;
-		}
+		// assign match data to session
+		cl->sess.mu          = sr_job->data.mu;
+		cl->sess.sigma       = sr_job->data.sigma;
+		cl->sess.time_axis   = sr_job->data.time_axis;
+		cl->sess.time_allies = sr_job->data.time_allies;
 	}
 
-	result = sqlite3_finalize(sqlstmt);
-
-	if (result != SQLITE_OK)
+	// prepare delta rating
+	if (sr_job->flags & SR_JOB_SETOLD)
 	{
-		G_Printf("G_SkillRatingSetUserRating: sqlite3_finalize failed\n");
-		return 1;
+		cl->sess.oldmu    = sr_job->data.mu;
+		cl->sess.oldsigma = sr_job->data.sigma;
 	}
 
-	return 0;
+	// update rank
+	G_CalcRank(cl);
+	ClientUserinfoChanged(job->clientNum);
 }
 
 /**
  * @brief Retrieve rating for client
  *         Called on ClientConnect and on G_UpdateSkillRating
+ *         The client gets it, and its rank, once the persistence thread has read it
  * @param[in] cl
  */
 void G_SkillRatingGetClientRating(gclient_t *cl)
 {
-	char     userinfo[MAX_INFO_STRING];
-	char     *guid;
-	int      clientNum;
-	srData_t sr_data;
+	char    userinfo[MAX_INFO_STRING];
+	int     clientNum;
+	dbJob_t job;
+	srJob_t *sr_job = (srJob_t *)job.data;
 
 	// disable for these game types
 	if (g_gametype.integer == GT_WOLF_STOPWATCH || g_gametype.integer == GT_WOLF_LMS)
@@ -507,68 +488,57 @@ void G_SkillRatingGetClientRating(gclient_t *cl)
 
 	clientNum = cl - level.clients;
 
+	Com_Memset(&job, 0, sizeof(job));
+	job.op        = DB_OP_RATING_LOAD;
+	job.run       = G_SkillRatingRunLoad;
+	job.finish    = G_SkillRatingFinishLoad;
+	job.clientNum = clientNum;
+
 	// retrieve guid
 	trap_GetUserinfo(clientNum, userinfo, sizeof(userinfo));
-	guid = Info_ValueForKey(userinfo, "cl_guid");
-
-	// assign guid
-	sr_data.guid = (const unsigned char *)guid;
+	Q_strncpyz(job.guid, Info_ValueForKey(userinfo, "cl_guid"), sizeof(job.guid));
 
-	// retrieve current rating or assign default values
+	// which rating to use depends on the match state at this point
 	if (level.warmupTime || level.intermissionQueued || level.intermissiontime)
 	{
-		// retrieve rating from rating_users table
-		if (G_SkillRatingGetUserRating(&sr_data))
-		{
-			return;
-		}
-
-		// assign user data to session
-		cl->sess.mu    = sr_data.mu;
-		cl->sess.sigma = sr_data.sigma;
+		sr_job->flags = SR_JOB_USER;
 
-		// ensure auto statsdump is correct
 		if (!level.intermissionQueued && !level.intermissiontime)
 		{
-			cl->sess.time_axis   = 0;
-			cl->sess.time_allies = 0;
+			sr_job->flags |= SR_JOB_RESETTIME;
 		}
-
-		// prepare delta rating
 		if (!level.intermissionQueued)
 		{
-			cl->sess.oldmu    = sr_data.mu;
-			cl->sess.oldsigma = sr_data.sigma;
+			sr_job->flags |= SR_JOB_SETOLD;
 		}
 	}
 	else // playing
 	{
-		// retrieve rating from rating_match or rating_users table or set default values
-		switch (G_SkillRatingGetMatchRating(&sr_data))
-		{
-		case 1:
-			// error occurred
-			return;
-		case 2:
-			// data not found in rating_match
-			G_SkillRatingGetUserRating(&sr_data);
-			break;
-		case 0:
-		// data found
-		default:
-			break;
-		}
+		sr_job->flags = SR_JOB_SETOLD;
+	}
 
-		// assign match data to session
-		cl->sess.mu          = sr_data.mu;
-		cl->sess.sigma       = sr_data.sigma;
-		cl->sess.time_axis   = sr_data.time_axis;
-		cl->sess.time_allies = sr_data.time_allies;
+	G_DB_Queue(&job);
+}
 
-		// prepare delta rating
-		cl->sess.oldmu    = sr_data.mu;
-		cl->sess.oldsigma = sr_data.sigma;
+/**
+ * @brief Persistence thread part of G_SkillRatingSetClientRating
+ * @param[in,out] job
+ * @return 0 if successful, 1 otherwise.
+ */
+static int G_SkillRatingRunStore(dbJob_t *job)
+{
+	srJob_t *sr_job = (srJob_t *)job->data;
+
+	sr_job->data.guid = (const unsigned char *)job->guid;
+
+	if (sr_job->flags & SR_JOB_USER)
+	{
+		// save or update rating in rating_users table
+		return G_SkillRatingSetUserRating(&sr_job->data);
 	}
+
+	// save or update rating in rating_match table
+	return G_SkillRatingSetMatchRating(&sr_job->data);
 }
 
 /**
@@ -578,10 +548,10 @@ void G_SkillRatingGetClientRating(gclient_t *cl)
  */
 void G_SkillRatingSetClientRating(gclient_t *cl)
 {
-	char     userinfo[MAX_INFO_STRING];
-	char     *guid;
-	int      clientNum;
-	srData_t sr_data;
+	char    userinfo[MAX_INFO_STRING];
+	int     clientNum;
+	dbJob_t job;
+	srJob_t *sr_job = (srJob_t *)job.data;
 
 	// disable for these game types
 	if (g_gametype.integer == GT_WOLF_STOPWATCH || g_gametype.integer == GT_WOLF_LMS)
@@ -608,40 +578,36 @@ void G_SkillRatingSetClientRating(gclient_t *cl)
 
 	clientNum = cl - level.clients;
 
+	Com_Memset(&job, 0, sizeof(job));
+	job.op        = DB_OP_RATING_STORE;
+	job.run       = G_SkillRatingRunStore;
+	job.clientNum = clientNum;
+
 	// retrieve guid
 	trap_GetUserinfo(clientNum, userinfo, sizeof(userinfo));
-	guid = Info_ValueForKey(userinfo, "cl_guid");
+	Q_strncpyz(job.guid, Info_ValueForKey(userinfo, "cl_guid"), sizeof(job.guid));
 
 	// assign match data
-	sr_data.guid        = (const unsigned char *)guid;
-	sr_data.mu          = cl->sess.mu;
-	sr_data.sigma       = cl->sess.sigma;
-	sr_data.time_axis   = cl->sess.time_axis;
-	sr_data.time_allies = cl->sess.time_allies;
+	sr_job->data.mu          = cl->sess.mu;
+	sr_job->data.sigma       = cl->sess.sigma;
+	sr_job->data.time_axis   = cl->sess.time_axis;
+	sr_job->data.time_allies = cl->sess.time_allies;
 
 	// save match rating or update new user rating after calculation
 	if (!level.intermissionQueued)
 	{
 		// player has not played at all
-		if (sr_data.time_axis == 0 && sr_data.time_allies == 0)
-		{
-			return;
-		}
-
-		// save or update rating in rating_match table
-		if (G_SkillRatingSetMatchRating(&sr_data))
+		if (sr_job->data.time_axis == 0 && sr_job->data.time_allies == 0)
 		{
 			return;
 		}
 	}
 	else
 	{
-		// save or update rating in rating_users table
-		if (G_SkillRatingSetUserRating(&sr_data))
-		{
-			return;
-		}
+		sr_job->flags = SR_JOB_USER;
 	}
+
+	G_DB_Queue(&job);
 }
 
 /**
@@ -670,6 +636,8 @@ float G_SkillRatingGetMapRating(char *mapname)
 		return 0.5f;
 	}
 
+	G_DB_Flush();
+
 	sql = va(SRMAPS_SQLWRAP_SELECT, mapname);
 
 	result = sqlite3_prepare(level.database.db, sql, strlen(sql), &sqlstmt, NULL);
@@ -750,6 +718,8 @@ void G_SkillRatingSetMapRating(char *mapname, int winner)
 		return;
 	}
 
+	G_DB_Flush();
+
 	sql = va(SRMAPS_SQLWRAP_SELECT, mapname);
 
 	result = sqlite3_prepare(level.database.db, sql, strlen(sql), &sqlstmt, NULL);
@@ -957,7 +927,6 @@ void G_UpdateSkillRating(int winner)
 	int       i, playerTeam, rankFactor;
 	float     c, v, w, t, winningMu, losingMu, muFactor, sigmaFactor;
 	float     oldMu, oldSigma;
-	gclient_t *cl;
 
 	float teamMuX      = 0.f;
 	float teamMuL      = 0.f;
@@ -979,6 +948,8 @@ void G_UpdateSkillRating(int winner)
 		return;
 	}
 
+	G_DB_Flush();
+
 	// map side parameter
 	if (g_skillRating.integer > 1)
 	{
@@ -1080,6 +1051,9 @@ void G_UpdateSkillRating(int winner)
 		return;
 	}
 
+	// write all new ratings in one transaction
+	sqlite3_exec(level.database.db, "BEGIN;", NULL, NULL, NULL);
+
 	while (sqlite3_step(sqlstmt) == SQLITE_ROW)
 	{
 		// assign match data
@@ -1126,7 +1100,8 @@ void G_UpdateSkillRating(int winner)
 		// save or update rating in rating_users table
 		if (G_SkillRatingSetUserRating(&sr_data))
 		{
-			return;
+			G_Printf("G_UpdateSkillRating: saving rating failed: %s\n", sqlite3_errmsg(level.database.db));
+			break;
 		}
 
 		G_LogPrintf("SkillRating: GUID: %s, Delta SR: %+.6f, SR: %.6f (%.6f, %.6f), Old SR: %.6f (%.6f, %.6f), Time X/L: %d/%d\n",
@@ -1138,6 +1113,7 @@ void G_UpdateSkillRating(int winner)
 	}
 
 	result = sqlite3_finalize(sqlstmt);
+	sqlite3_exec(level.database.db, "COMMIT;", NULL, NULL, NULL);
 
 	if (result != SQLITE_OK)
 	{
@@ -1145,16 +1121,10 @@ void G_UpdateSkillRating(int winner)
 		return;
 	}
 
-	// assign updated rating to connected players
+	// assign updated rating and rank to connected players
 	for (i = 0; i < level.numConnectedClients; i++)
 	{
-		cl = level.clients + level.sortedClients[i];
-
-		G_SkillRatingGetClientRating(cl);
-
-		// update rank
-		G_CalcRank(cl);
-		ClientUserinfoChanged(level.sortedClients[i]);
+		G_SkillRatingGetClientRating(level.clients + level.sortedClients[i]);
 	}
 }
 
@@ -1261,6 +1231,9 @@ float G_CalculateWinProbability(int team)
 		sqlite3_stmt *sqlstmt;
 		srData_t     sr_data;
 
+		// match ratings of players who left may still be queued
+		G_DB_Flush();
+
 		result = sqlite3_prepare(level.database.db, SRMATCH_SQLWRAP_TABLE, strlen(SRMATCH_SQLWRAP_TABLE), &sqlstmt, NULL);
 
 		if (result != SQLITE_OK)
@@ -35,6 +35,7 @@
  */
 
 #include "g_local.h"
+#include "g_etpanel.h"
 
 #ifdef FEATURE_OMNIBOT
 #include "g_etbot_interface.h"
@@ -2597,9 +2598,14 @@ static void Svcmd_CancelVote_f(void)
 static consoleCommandTable_t consoleCommandTable[] =
 {
 	{ "entitylist",                 Svcmd_EntityList_f            },
+	{ "entitystats",                G_EntityStats_f               },
 	{ "csinfo",                     Svcmd_CSInfo_f                },
 	{ "forceteam",                  Svcmd_ForceTeam_f             },
 	{ "game_memory",                Svcmd_GameMem_f               },
+#ifdef FEATURE_DBMS
+	{ "dbstats",                    G_DB_Stats_f                  },
+#endif
+	{ "etpanelstats",               G_ETPanel_Stats_f             },
 	{ "addip",                      Svcmd_AddIP_f                 },
 	{ "removeip",                   Svcmd_RemoveIP_f              },
 	{ "listip",                     Svcmd_ListIp_f                },
@@ -2627,6 +2633,7 @@ static consoleCommandTable_t consoleCommandTable[] =
 	{ "clientkick",                 Svcmd_Kick_f                  },    // both similar to keep compatibility
 #ifdef FEATURE_OMNIBOT
 	{ "bot",                        Bot_Interface_ConsoleCommand  },
+	{ "bottracestats",              Bot_Interface_TraceStats_f    },
 #endif
 	{ "cp",                         Svcmd_CP_f                    },
 	{ "reloadConfig",               G_ReloadConfig                },
@@ -307,17 +307,13 @@ void G_TeamCommand(team_t team, const char *cmd)
 }
 
 /**
- * @brief Searches all active entities for the next one that holds
- * the matching string at fieldofs (use the FOFS() macro) in the structure.
- * Searches beginning at the entity after from, or the beginning if NULL
- * NULL will be returned if the end of the list is reached.
- *
- * @param[in,out] from
+ * @brief G_Find without the name indexes, see g_entindex.c
+ * @param[in] from
  * @param[in] fieldofs
  * @param[in] match
  * @return
  */
-gentity_t *G_Find(gentity_t *from, size_t fieldofs, const char *match)
+static gentity_t *G_FindLinear(gentity_t *from, size_t fieldofs, const char *match)
 {
 	char      *s;
 	gentity_t *max = &g_entities[level.num_entities];
@@ -351,6 +347,55 @@ gentity_t *G_Find(gentity_t *from, size_t fieldofs, const char *match)
 	return NULL;
 }
 
+/**
+ * @brief Compare an indexed search with the linear scan (g_debugEntityIndex)
+ * @param[in] from
+ * @param[in] fieldofs
+ * @param[in] match
+ * @param[in] found result of the indexed search
+ */
+static void G_FindCheck(gentity_t *from, size_t fieldofs, const char *match, gentity_t *found)
+{
+	gentity_t *expected = G_FindLinear(from, fieldofs, match);
+
+	if (found != expected)
+	{
+		G_Printf("^1G_Find: index returned %i, linear scan %i for '%s' after %i\n",
+		         found ? (int)(found - g_entities) : -1, expected ? (int)(expected - g_entities) : -1,
+		         match, from ? (int)(from - g_entities) : -1);
+	}
+}
+
+/**
+ * @brief Searches all active entities for the next one that holds
+ * the matching string at fieldofs (use the FOFS() macro) in the structure.
+ * Searches beginning at the entity after from, or the beginning if NULL
+ * NULL will be returned if the end of the list is reached.
+ *
+ * @param[in,out] from
+ * @param[in] fieldofs
+ * @param[in] match
+ * @return
+ */
+gentity_t *G_Find(gentity_t *from, size_t fieldofs, const char *match)
+{
+	gentity_t *ent;
+
+	if (!G_EntityIndexed(fieldofs))
+	{
+		return G_FindLinear(from, fieldofs, match);
+	}
+
+	ent = G_EntityIndexFind(from, fieldofs, match);
+
+	if (g_debugEntityIndex.integer)
+	{
+		G_FindCheck(from, fieldofs, match, ent);
+	}
+
+	return ent;
+}
+
 /**
  * @brief Like G_Find, but searches for integer values.
  * @param[in,out] from
@@ -474,86 +519,27 @@ gentity_t *G_FindVector(gentity_t *from, int fieldofs, const vec3_t match)
  */
 gentity_t *G_FindByTargetname(gentity_t *from, const char *match)
 {
-	gentity_t *max = &g_entities[level.num_entities];
-	int       hash;
-
-	hash = BG_StringHashValue(match);
-
-	if (hash == -1) // if there is no name (not empty string!) BG_StringHashValue returns -1
+	if (BG_StringHashValue(match) == -1) // if there is no name (not empty string!) BG_StringHashValue returns -1
 	{
 		G_Printf("G_FindByTargetname WARNING: invalid match pointer '%s' - run devmap & g_scriptdebug 1 to get more info about\n", match);
 		return NULL;
 	}
 
-	if (!from)
-	{
-		from = g_entities;
-	}
-	else
-	{
-		from++;
-	}
-
-	for ( ; from < max ; from++)
-	{
-		if (!from->inuse)
-		{
-			continue;
-		}
-
-		if (!from->targetname) // there are ents with no targetname set
-		{
-			continue;
-		}
-
-		if (from->targetnamehash == hash && !Q_stricmp(from->targetname, match))
-		{
-			return from;
-		}
-	}
-
-	return NULL;
+	return G_Find(from, FOFS(targetname), match);
 }
 
 /**
  * @brief This version should be used for loops, saves the constant hash building
  * @param[in,out] from
  * @param[in] match
- * @param[in] hash
+ * @param[in] hash unused, searches go through the targetname index now
  * @return
  */
 gentity_t *G_FindByTargetnameFast(gentity_t *from, const char *match, int hash)
 {
-	gentity_t *max = &g_entities[level.num_entities];
-
-	if (!from)
-	{
-		from = g_entities;
-	}
-	else
-	{
-		from++;
-	}
-
-	for ( ; from < max ; from++)
-	{
-		if (!from->inuse)
-		{
-			continue;
-		}
-
-		if (!from->targetname) // there are ents with no targetname set
-		{
-			continue;
-		}
-
-		if (from->targetnamehash == hash && !Q_stricmp(from->targetname, match))
-		{
-			return from;
-		}
-	}
+	(void)hash;
 
-	return NULL;
+	return G_Find(from, FOFS(targetname), match);
 }
 
 #define MAXCHOICES  32
@@ -777,12 +763,263 @@ void G_InitGentity(gentity_t *e)
 	// mark the time
 	e->spawnTime = level.time;
 
+	// indexed by name once the spawn function has set it
+	G_EntityIndexSpawned(e);
+
 #ifdef FEATURE_OMNIBOT
 	// Notify omni-bot
 	Bot_Queue_EntityCreated(e);
 #endif
 }
 
+/*
+ * Entity slot allocator
+ *
+ * G_Spawn() used to scan g_entities for a free slot on every call. Free
+ * slots are now tracked in two bitmaps: every free slot below
+ * level.num_entities, and the subset that may be reused right away.
+ * Slots that still have to relax are queued in the order they were freed.
+ * level.time never goes backwards, so the queue is also sorted by
+ * freetime, and slots can move to the reusable set from its head.
+ *
+ * The lowest reusable slot is still preferred, which keeps
+ * level.num_entities as low as the old scan did.
+ */
+
+#define ENTITY_RELAX_MSEC    1000   ///< minimum time before a freed slot is reused
+#define ENTITY_STARTUP_MSEC  2000   ///< slots freed this early in the level are reused at once
+#define ENTITY_LOW_FREE      64     ///< fewer free slots than this count as a near miss
+#define ENTITY_BITMAP_WORDS  (MAX_GENTITIES / 32)
+#define ENTITY_RELAX_QUEUE   (MAX_GENTITIES * 2)
+
+typedef struct
+{
+	int number;
+	int freetime;
+} entityRelax_t;
+
+static struct
+{
+	unsigned int freeSlots[ENTITY_BITMAP_WORDS];      ///< free slots below level.num_entities
+	unsigned int readySlots[ENTITY_BITMAP_WORDS];     ///< free slots that can be reused now
+	int freeCount;
+
+	entityRelax_t relax[ENTITY_RELAX_QUEUE];
+	int relaxHead, relaxTail;
+
+	// statistics for the "entitystats" command
+	int spawned;
+	int reused;
+	int grown;
+	int forced;                 ///< slots taken before they relaxed, all slots were used
+	int lowFree;                ///< spawns with fewer than ENTITY_LOW_FREE slots left
+	int compactions;            ///< relax queue filled up with entries of forced slots
+	int peakInUse;
+	int minFree;
+	int relaxedReuses;          ///< reuses of slots that had to relax...
+	int totalReuseLatency;      ///< ...and the summed time from free to reuse
+	int maxReuseLatency;
+} g_entityAlloc;
+
+#define ENTITY_BIT_SET(bits, n)   ((bits)[(n) >> 5] |= 1u << ((n) & 31))
+#define ENTITY_BIT_CLEAR(bits, n) ((bits)[(n) >> 5] &= ~(1u << ((n) & 31)))
+
+/**
+ * @brief Lowest slot set in a slot bitmap
+ * @param[in] bits
+ * @return Slot number, -1 if none is set
+ */
+static int G_EntityFirstSlot(const unsigned int *bits)
+{
+	int          i, n;
+	unsigned int word;
+
+	for (i = MAX_CLIENTS / 32; i < ENTITY_BITMAP_WORDS; i++)
+	{
+		if (!bits[i])
+		{
+			continue;
+		}
+
+		word = bits[i];
+		for (n = 0; !(word & 1); n++)
+		{
+			word >>= 1;
+		}
+		return i * 32 + n;
+	}
+
+	return -1;
+}
+
+/**
+ * @brief Check if a slot freed at the given time still has to relax
+ * @param[in] freetime
+ * @return qtrue if the slot should not be reused yet
+ */
+static qboolean G_EntityRelaxing(int freetime)
+{
+	// the first couple seconds of server time can involve a lot of
+	// freeing and allocating, so relax the replacement policy
+	return freetime > level.startTime + ENTITY_STARTUP_MSEC && level.time - freetime < ENTITY_RELAX_MSEC;
+}
+
+/**
+ * @brief Move slots that have relaxed long enough to the reusable set
+ */
+static void G_EntityRelaxSlots(void)
+{
+	while (g_entityAlloc.relaxHead != g_entityAlloc.relaxTail)
+	{
+		entityRelax_t *r = &g_entityAlloc.relax[g_entityAlloc.relaxHead];
+		gentity_t     *e = &g_entities[r->number];
+
+		if (G_EntityRelaxing(r->freetime))
+		{
+			break;
+		}
+
+		// the slot may have been forced into use and freed again since
+		if (!e->inuse && e->freetime == r->freetime)
+		{
+			ENTITY_BIT_SET(g_entityAlloc.readySlots, r->number);
+		}
+
+		g_entityAlloc.relaxHead = (g_entityAlloc.relaxHead + 1) % ENTITY_RELAX_QUEUE;
+	}
+}
+
+/**
+ * @brief Drop relax queue entries of slots that were forced into use since
+ * @details Every slot is queued at most once per free, and only forced slots
+ * leave stale entries behind, so this always makes room.
+ */
+static void G_EntityCompactRelaxQueue(void)
+{
+	int i, out = g_entityAlloc.relaxHead;
+
+	g_entityAlloc.compactions++;
+
+	for (i = g_entityAlloc.relaxHead; i != g_entityAlloc.relaxTail; i = (i + 1) % ENTITY_RELAX_QUEUE)
+	{
+		entityRelax_t *r = &g_entityAlloc.relax[i];
+		gentity_t     *e = &g_entities[r->number];
+
+		if (e->inuse || e->freetime != r->freetime)
+		{
+			continue;
+		}
+
+		g_entityAlloc.relax[out] = *r;
+		out                      = (out + 1) % ENTITY_RELAX_QUEUE;
+	}
+
+	g_entityAlloc.relaxTail = out;
+}
+
+/**
+ * @brief Forget all free slots, called when g_entities is cleared for a new level
+ */
+void G_ResetEntityAllocator(void)
+{
+	Com_Memset(&g_entityAlloc, 0, sizeof(g_entityAlloc));
+	g_entityAlloc.minFree = MAX_GENTITIES;
+}
+
+/**
+ * @brief Track a slot released by G_FreeEntity()
+ * @param[in] e
+ */
+static void G_EntityReleased(gentity_t *e)
+{
+	int num = e - g_entities;
+	int next;
+
+	if (num < MAX_CLIENTS || num >= level.num_entities)
+	{
+		return;
+	}
+
+	if (!(g_entityAlloc.freeSlots[num >> 5] & (1u << (num & 31))))
+	{
+		ENTITY_BIT_SET(g_entityAlloc.freeSlots, num);
+		g_entityAlloc.freeCount++;
+	}
+
+	if (!G_EntityRelaxing(e->freetime))
+	{
+		ENTITY_BIT_SET(g_entityAlloc.readySlots, num);
+		return;
+	}
+
+	ENTITY_BIT_CLEAR(g_entityAlloc.readySlots, num);
+
+	next = (g_entityAlloc.relaxTail + 1) % ENTITY_RELAX_QUEUE;
+	if (next == g_entityAlloc.relaxHead)
+	{
+		G_EntityCompactRelaxQueue();
+		next = (g_entityAlloc.relaxTail + 1) % ENTITY_RELAX_QUEUE;
+	}
+
+	g_entityAlloc.relax[g_entityAlloc.relaxTail].number   = num;
+	g_entityAlloc.relax[g_entityAlloc.relaxTail].freetime = e->freetime;
+	g_entityAlloc.relaxTail                               = next;
+}
+
+/**
+ * @brief Take a free slot out of the allocator and update the statistics
+ * @param[in] num
+ */
+static void G_EntityTaken(int num)
+{
+	gentity_t *e = &g_entities[num];
+	int       inUse, latency;
+
+	ENTITY_BIT_CLEAR(g_entityAlloc.freeSlots, num);
+	ENTITY_BIT_CLEAR(g_entityAlloc.readySlots, num);
+	g_entityAlloc.freeCount--;
+	g_entityAlloc.reused++;
+
+	if (e->freetime > level.startTime + ENTITY_STARTUP_MSEC)
+	{
+		latency = level.time - e->freetime;
+
+		g_entityAlloc.relaxedReuses++;
+		g_entityAlloc.totalReuseLatency += latency;
+		if (latency > g_entityAlloc.maxReuseLatency)
+		{
+			g_entityAlloc.maxReuseLatency = latency;
+		}
+	}
+
+	inUse = level.num_entities - MAX_CLIENTS - g_entityAlloc.freeCount;
+	if (inUse > g_entityAlloc.peakInUse)
+	{
+		g_entityAlloc.peakInUse = inUse;
+	}
+}
+
+/**
+ * @brief Print entity allocation statistics
+ */
+void G_EntityStats_f(void)
+{
+	int inUse = level.num_entities - MAX_CLIENTS - g_entityAlloc.freeCount;
+	int relaxing;
+
+	relaxing = (g_entityAlloc.relaxTail - g_entityAlloc.relaxHead + ENTITY_RELAX_QUEUE) % ENTITY_RELAX_QUEUE;
+
+	G_Printf("Entities: %i in use, %i free below num_entities (%i relax queue entries), num_entities %i of %i\n",
+	         inUse, g_entityAlloc.freeCount, relaxing, level.num_entities, ENTITYNUM_MAX_NORMAL);
+	G_Printf("Peak: %i in use, %i free at least\n", g_entityAlloc.peakInUse, g_entityAlloc.minFree);
+	G_Printf("Spawns: %i, %i reused slots, %i new slots\n", g_entityAlloc.spawned, g_entityAlloc.reused, g_entityAlloc.grown);
+	G_Printf("Reuse latency: %.1fms average, %ims max (%i reuses after relaxing)\n",
+	         g_entityAlloc.relaxedReuses ? g_entityAlloc.totalReuseLatency / (float)g_entityAlloc.relaxedReuses : 0.f,
+	         g_entityAlloc.maxReuseLatency, g_entityAlloc.relaxedReuses);
+	G_Printf("Near misses: %i spawns with less than %i free, %i slots reused before relaxing, %i relax queue compactions\n",
+	         g_entityAlloc.lowFree, ENTITY_LOW_FREE, g_entityAlloc.forced, g_entityAlloc.compactions);
+}
+
 /**
  * @brief Either finds a free entity, or allocates a new one.
  *
@@ -798,50 +1035,62 @@ void G_InitGentity(gentity_t *e)
  */
 gentity_t *G_Spawn(void)
 {
-	int       i = 0, force;
-	gentity_t *e = NULL;
+	int       i, freeCount;
+	gentity_t *e;
 
-	for (force = 0 ; force < 2 ; force++)
+	g_entityAlloc.spawned++;
+
+	freeCount = G_EntitiesFree();
+	if (freeCount < g_entityAlloc.minFree)
 	{
-		// if we go through all entities and can't find one to free,
-		// override the normal minimum times before use
-		e = &g_entities[MAX_CLIENTS];
-		for (i = MAX_CLIENTS ; i < level.num_entities ; i++, e++)
-		{
-			if (e->inuse)
-			{
-				continue;
-			}
+		g_entityAlloc.minFree = freeCount;
+	}
+	if (freeCount < ENTITY_LOW_FREE)
+	{
+		g_entityAlloc.lowFree++;
+	}
 
-			// the first couple seconds of server time can involve a lot of
-			// freeing and allocating, so relax the replacement policy
-			// FIXME: inspect -> add '&& level.startTime != 0' for warmup?
-			if (!force && e->freetime > level.startTime + 2000 && level.time - e->freetime < 1000)
-			{
-				continue;
-			}
+	G_EntityRelaxSlots();
 
-			// reuse this slot
-			G_InitGentity(e);
-			return e;
-		}
-		if (i != ENTITYNUM_MAX_NORMAL)
-		{
-			break;
-		}
+	// reuse the lowest slot that has relaxed
+	i = G_EntityFirstSlot(g_entityAlloc.readySlots);
+	if (i >= 0)
+	{
+		G_EntityTaken(i);
+		e = &g_entities[i];
+		G_InitGentity(e);
+		return e;
 	}
 
-	if (i == ENTITYNUM_MAX_NORMAL)
+	// if all slots are in use and none has relaxed,
+	// override the normal minimum times before use
+	if (level.num_entities == ENTITYNUM_MAX_NORMAL)
 	{
-		for (i = 0; i < MAX_GENTITIES; i++)
+		i = G_EntityFirstSlot(g_entityAlloc.freeSlots);
+		if (i < 0)
 		{
-			G_Printf("%4i: %s\n", i, g_entities[i].classname);
+			for (i = 0; i < MAX_GENTITIES; i++)
+			{
+				G_Printf("%4i: %s\n", i, g_entities[i].classname);
+			}
+			G_Error("G_Spawn: no free entities\n");
 		}
-		G_Error("G_Spawn: no free entities\n");
+
+		g_entityAlloc.forced++;
+		G_EntityTaken(i);
+		e = &g_entities[i];
+		G_InitGentity(e);
+		return e;
 	}
 
 	// open up a new slot
+	e = &g_entities[level.num_entities];
 	level.num_entities++;
+	g_entityAlloc.grown++;
+	if (level.num_entities - MAX_CLIENTS - g_entityAlloc.freeCount > g_entityAlloc.peakInUse)
+	{
+		g_entityAlloc.peakInUse = level.num_entities - MAX_CLIENTS - g_entityAlloc.freeCount;
+	}
 
 	// let the server system know that there are more entities
 	trap_LocateGameData(level.gentities, level.num_entities, sizeof(gentity_t),
@@ -857,19 +1106,7 @@ gentity_t *G_Spawn(void)
  */
 int G_EntitiesFree(void)
 {
-	int       i;
-	gentity_t *e       = &g_entities[MAX_CLIENTS];
-	int       entities = MAX_CLIENTS;
-
-	for (i = MAX_CLIENTS; i < level.num_entities; i++, e++)
-	{
-		if (e->inuse)
-		{
-			entities++;
-		}
-	}
-
-	return MAX_GENTITIES - entities;
+	return MAX_GENTITIES - level.num_entities + g_entityAlloc.freeCount;
 }
 
 /**
@@ -932,6 +1169,9 @@ void G_FreeEntity(gentity_t *ent)
 		ent->freetime  = level.time;
 		ent->inuse     = qfalse;
 	}
+
+	G_EntityReleased(ent);
+	G_EntityIndexRefresh(ent);
 }
 
 /**
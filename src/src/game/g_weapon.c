@@ -3441,7 +3441,7 @@ gentity_t *Bullet_Fire(gentity_t *ent)
 
 	Bullet_Endpos(ent, spread, &end);
 
-	G_HistoricalTraceBegin(ent);
+	G_HistoricalTraceBeginRay(ent, muzzleTrace, end);
 
 	// skip corpses for bullet tracing (=non gibbing weapons)
 	G_TempTraceIgnoreBodies();
@@ -36,11 +36,8 @@
 
 #define bf_write(bf, T, input) *((T *)bf++) = (T)input;
 #define bf_read(bf, T, output) output       = *((T *)bf++);
-#define assert_return(cond, status, msg) \
+#define assert_return(cond, status) \
 		if (!(cond)) { \
-			if (msg) { \
-				G_Printf("^1%s (%i): failed: %s\n", __func__, __LINE__, msg); \
-			} \
 			return status; \
 		}
 
@@ -56,9 +53,9 @@ static int G_XPSaver_Write(xpData_t *xp_data);
 
 #define XPCHECK_SQLWRAP_TABLES "SELECT * FROM xpsave_users;"
 #define XPCHECK_SQLWRAP_SCHEMA "SELECT guid, skills, medals, created, updated FROM xpsave_users;"
-#define XPUSERS_SQLWRAP_SELECT "SELECT * FROM xpsave_users WHERE guid = '%s';"
-#define XPUSERS_SQLWRAP_INSERT "INSERT INTO xpsave_users (guid, skills, medals, created, updated) VALUES ('%s', ?, ?, CURRENT_TIMESTAMP, CURRENT_TIMESTAMP);"
-#define XPUSERS_SQLWRAP_UPDATE "UPDATE xpsave_users SET skills = ?, medals = ?, updated = CURRENT_TIMESTAMP WHERE guid = '%s';"
+#define XPUSERS_SQLWRAP_SELECT "SELECT * FROM xpsave_users WHERE guid = ?;"
+#define XPUSERS_SQLWRAP_INSERT "INSERT INTO xpsave_users (skills, medals, guid, created, updated) VALUES (?, ?, ?, CURRENT_TIMESTAMP, CURRENT_TIMESTAMP);"
+#define XPUSERS_SQLWRAP_UPDATE "UPDATE xpsave_users SET skills = ?, medals = ?, updated = CURRENT_TIMESTAMP WHERE guid = ?;"
 #define XPUSERS_SQLWRAP_DELETE "DELETE FROM xpsave_users"
 
 /**
@@ -140,16 +137,61 @@ int G_XPSaver_CheckDB(char *db_path, int db_mode)
 	return 0;
 }
 
+/**
+ * @brief Persistence thread part of G_XPSaver_Load
+ * @param[in,out] job
+ * @return 0 if successful, 1 otherwise.
+ */
+static int G_XPSaver_RunLoad(dbJob_t *job)
+{
+	xpData_t *xp_data = (xpData_t *)job->data;
+
+	xp_data->guid = (const unsigned char *)job->guid;
+
+	return G_XPSaver_Read(xp_data);
+}
+
+/**
+ * @brief Assigns the loaded xp to the client
+ * @param[in] job
+ */
+static void G_XPSaver_FinishLoad(dbJob_t *job)
+{
+	xpData_t  *xp_data = (xpData_t *)job->data;
+	gclient_t *cl      = G_DB_JobClient(job);
+	int       i;
+
+	if (!cl || job->status)
+	{
+		return;
+	}
+
+	// assign user data to session
+	cl->sess.startxptotal = 0;
+	for (i = 0; i < SK_NUM_SKILLS; i++)
+	{
+		cl->sess.skillpoints[i]      = xp_data->skillpoints[i];
+		cl->sess.startskillpoints[i] = xp_data->skillpoints[i];
+		cl->sess.startxptotal       += xp_data->skillpoints[i];
+		cl->sess.medals[i]          += xp_data->medals[i];
+	}
+
+	for (i = 0; i < SK_NUM_SKILLS; i++)
+	{
+		G_SetPlayerSkill(cl, i);
+	}
+}
+
 /**
  * @brief Retrieves xp for a client
+ *         The client gets it once the persistence thread has read it
  * @param[in] cl
  */
 void G_XPSaver_Load(gclient_t *cl)
 {
 	char      userinfo[MAX_INFO_STRING];
-	char      *guid;
-	int       clientNum, i;
-	xpData_t  xp_data;
+	int       clientNum;
+	dbJob_t   job;
 	gentity_t *ent;
 
 	if (!level.database.initialized)
@@ -173,28 +215,31 @@ void G_XPSaver_Load(gclient_t *cl)
 		return;
 	}
 
+	Com_Memset(&job, 0, sizeof(job));
+	job.op        = DB_OP_XP_LOAD;
+	job.run       = G_XPSaver_RunLoad;
+	job.finish    = G_XPSaver_FinishLoad;
+	job.clientNum = clientNum;
+
 	// retrieve guid
 	trap_GetUserinfo(clientNum, userinfo, sizeof(userinfo));
-	guid = Info_ValueForKey(userinfo, "cl_guid");
+	Q_strncpyz(job.guid, Info_ValueForKey(userinfo, "cl_guid"), sizeof(job.guid));
 
-	// assign guid
-	xp_data.guid = (const unsigned char *)guid;
+	G_DB_Queue(&job);
+}
 
-	// retrieve current xp or assign default values
-	if (G_XPSaver_Read(&xp_data))
-	{
-		return;
-	}
+/**
+ * @brief Persistence thread part of G_XPSaver_Store
+ * @param[in,out] job
+ * @return 0 if successful, 1 otherwise.
+ */
+static int G_XPSaver_RunStore(dbJob_t *job)
+{
+	xpData_t *xp_data = (xpData_t *)job->data;
 
-	// assign user data to session
-	cl->sess.startxptotal = 0;
-	for (i = 0; i < SK_NUM_SKILLS; i++)
-	{
-		cl->sess.skillpoints[i]      = xp_data.skillpoints[i];
-		cl->sess.startskillpoints[i] = xp_data.skillpoints[i];
-		cl->sess.startxptotal       += xp_data.skillpoints[i];
-		cl->sess.medals[i]          += xp_data.medals[i];
-	}
+	xp_data->guid = (const unsigned char *)job->guid;
+
+	return G_XPSaver_Write(xp_data);
 }
 
 /**
@@ -204,9 +249,9 @@ void G_XPSaver_Load(gclient_t *cl)
 void G_XPSaver_Store(gclient_t *cl)
 {
 	char      userinfo[MAX_INFO_STRING];
-	char      *guid;
 	int       clientNum, i;
-	xpData_t  xp_data;
+	dbJob_t   job;
+	xpData_t  *xp_data = (xpData_t *)job.data;
 	gentity_t *ent;
 
 	if (!level.database.initialized)
@@ -236,23 +281,23 @@ void G_XPSaver_Store(gclient_t *cl)
 		return;
 	}
 
+	Com_Memset(&job, 0, sizeof(job));
+	job.op        = DB_OP_XP_STORE;
+	job.run       = G_XPSaver_RunStore;
+	job.clientNum = clientNum;
+
 	// retrieve guid
 	trap_GetUserinfo(clientNum, userinfo, sizeof(userinfo));
-	guid = Info_ValueForKey(userinfo, "cl_guid");
-
-	xp_data.guid = (const unsigned char *)guid;
+	Q_strncpyz(job.guid, Info_ValueForKey(userinfo, "cl_guid"), sizeof(job.guid));
 
 	for (i = 0; i < SK_NUM_SKILLS; i++)
 	{
-		xp_data.skillpoints[i] = (int)cl->sess.skillpoints[i];
-		xp_data.medals[i]      = (int)cl->sess.medals[i];
+		xp_data->skillpoints[i] = (int)cl->sess.skillpoints[i];
+		xp_data->medals[i]      = (int)cl->sess.medals[i];
 	}
 
 	// save or update xp
-	if (G_XPSaver_Write(&xp_data))
-	{
-		return;
-	}
+	G_DB_Queue(&job);
 }
 
 /**
@@ -263,7 +308,6 @@ void G_XPSaver_Store(gclient_t *cl)
 static int G_XPSaver_Read(xpData_t *xp_data)
 {
 	int          result, i;
-	const char   *err;
 	sqlite3_stmt *sqlstmt;
 	const int    *pSkills;
 	const int    *pMedals;
@@ -271,14 +315,11 @@ static int G_XPSaver_Read(xpData_t *xp_data)
 	Com_Memset(xp_data->skillpoints, 0, sizeof(xp_data->skillpoints));
 	Com_Memset(xp_data->medals, 0, sizeof(xp_data->medals));
 
-	if (!level.database.initialized)
-	{
-		G_Printf("G_XPSaver_Read: access to non-initialized database\n");
-		return 1;
-	}
+	sqlstmt = G_DB_Statement(XPUSERS_SQLWRAP_SELECT);
+	assert_return(sqlstmt, 1);
 
-	result = sqlite3_prepare(level.database.db, va(XPUSERS_SQLWRAP_SELECT, xp_data->guid), -1, &sqlstmt, NULL);
-	assert_return(result == SQLITE_OK, 1, sqlite3_errmsg(level.database.db));
+	result = sqlite3_bind_text(sqlstmt, 1, (const char *)xp_data->guid, -1, SQLITE_STATIC);
+	assert_return(result == SQLITE_OK, 1);
 
 	result = sqlite3_step(sqlstmt);
 
@@ -286,10 +327,10 @@ static int G_XPSaver_Read(xpData_t *xp_data)
 	{
 		/* retrieve skills */
 		pSkills = (int *)sqlite3_column_blob(sqlstmt, 1);
-		assert_return(pSkills, 1, sqlite3_errmsg(level.database.db));
+		assert_return(pSkills, 1);
 
 		pMedals = (int *)sqlite3_column_blob(sqlstmt, 2);
-		assert_return(pMedals, 2, sqlite3_errmsg(level.database.db));
+		assert_return(pMedals, 2);
 
 		for (i = 0; i < SK_NUM_SKILLS; i++)
 		{
@@ -300,18 +341,9 @@ static int G_XPSaver_Read(xpData_t *xp_data)
 	// no entry found or other failure
 	else if (result != SQLITE_DONE)
 	{
-		err = sqlite3_errmsg(level.database.db);
-		if (err)
-		{
-			G_Printf("^3%s (%i): failed: %s\n", __func__, __LINE__, err);
-		}
-		sqlite3_finalize(sqlstmt);
 		return 1;
 	}
 
-	result = sqlite3_finalize(sqlstmt);
-	assert_return(result == SQLITE_OK, 1, sqlite3_errmsg(level.database.db));
-
 	return 0;
 }
 
@@ -324,20 +356,16 @@ static int G_XPSaver_Write(xpData_t *xp_data)
 {
 	int          i;
 	int          result;
-	const char   *err;
 	sqlite3_stmt *sqlstmt;
 	int          buffer[SK_NUM_SKILLS * 2];
 	int          *pSkills;
 	int          *pMedals;
 
-	if (!level.database.initialized)
-	{
-		G_Printf("G_XPSaver_Write: access to non-initialized database\n");
-		return 1;
-	}
+	sqlstmt = G_DB_Statement(XPUSERS_SQLWRAP_SELECT);
+	assert_return(sqlstmt, 1);
 
-	result = sqlite3_prepare(level.database.db, va(XPUSERS_SQLWRAP_SELECT, xp_data->guid), -1, &sqlstmt, NULL);
-	assert_return(result == SQLITE_OK, 1, sqlite3_errmsg(level.database.db));
+	result = sqlite3_bind_text(sqlstmt, 1, (const char *)xp_data->guid, -1, SQLITE_STATIC);
+	assert_return(result == SQLITE_OK, 1);
 
 	result = sqlite3_step(sqlstmt);
 
@@ -351,39 +379,29 @@ static int G_XPSaver_Write(xpData_t *xp_data)
 
 	if (result == SQLITE_DONE)
 	{
-		sqlite3_finalize(sqlstmt);
-		sqlstmt = NULL;
-		result  = sqlite3_prepare(level.database.db, va(XPUSERS_SQLWRAP_INSERT, xp_data->guid), -1, &sqlstmt, NULL);
+		sqlstmt = G_DB_Statement(XPUSERS_SQLWRAP_INSERT);
 	}
 	else if (result == SQLITE_ROW)
 	{
-		sqlite3_finalize(sqlstmt);
-		sqlstmt = NULL;
-		result  = sqlite3_prepare(level.database.db, va(XPUSERS_SQLWRAP_UPDATE, xp_data->guid), -1, &sqlstmt, NULL);
+		sqlstmt = G_DB_Statement(XPUSERS_SQLWRAP_UPDATE);
 	}
 	else
 	{
-		err = sqlite3_errmsg(level.database.db);
-		if (err)
-		{
-			G_Printf("^3%s (%i): failed: %s\n", __func__, __LINE__, err);
-		}
-		sqlite3_finalize(sqlstmt);
 		return 1;
 	}
-	assert_return(result == SQLITE_OK, 1, sqlite3_errmsg(level.database.db));
+	assert_return(sqlstmt, 1);
 
 	result = sqlite3_bind_blob(sqlstmt, 1, buffer, sizeof(int) * SK_NUM_SKILLS, SQLITE_STATIC);
-	assert_return(result == SQLITE_OK, 1, sqlite3_errmsg(level.database.db));
+	assert_return(result == SQLITE_OK, 1);
 
 	result = sqlite3_bind_blob(sqlstmt, 2, buffer + SK_NUM_SKILLS, sizeof(int) * SK_NUM_SKILLS, SQLITE_STATIC);
-	assert_return(result == SQLITE_OK, 1, sqlite3_errmsg(level.database.db));
+	assert_return(result == SQLITE_OK, 1);
 
-	result = sqlite3_step(sqlstmt);
-	assert_return(result == SQLITE_DONE, 1, sqlite3_errmsg(level.database.db));
+	result = sqlite3_bind_text(sqlstmt, 3, (const char *)xp_data->guid, -1, SQLITE_STATIC);
+	assert_return(result == SQLITE_OK, 1);
 
-	result = sqlite3_finalize(sqlstmt);
-	assert_return(result == SQLITE_OK, 1, sqlite3_errmsg(level.database.db));
+	result = sqlite3_step(sqlstmt);
+	assert_return(result == SQLITE_DONE, 1);
 
 	return 0;
 }
@@ -403,6 +421,8 @@ int G_XPSaver_Clear()
 		return 1;
 	}
 
+	G_DB_Flush();
+
 	result = sqlite3_exec(level.database.db, XPUSERS_SQLWRAP_DELETE, 0, 0, &err_msg);
 
 	if (result != SQLITE_OK)
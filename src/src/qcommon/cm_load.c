@@ -44,6 +44,7 @@
 #define BOX_PLANES      12
 
 clipMap_t cm;
+int       cm_generation;        ///< bumped whenever the map data changes
 int       c_pointcontents;
 int       c_traces, c_brush_traces, c_patch_traces;
 
@@ -689,6 +690,7 @@ void CM_LoadMap(const char *name, qboolean clientload, unsigned int *checksum)
 	// free old stuff
 	Com_Memset(&cm, 0, sizeof(cm));
 	CM_ClearLevelPatches();
+	cm_generation++;
 
 	if (!name[0])
 	{
@@ -760,6 +762,7 @@ void CM_ClearMap(void)
 {
 	Com_Memset(&cm, 0, sizeof(cm));
 	CM_ClearLevelPatches();
+	cm_generation++;
 }
 
 /**
@@ -867,45 +870,40 @@ int CM_LeafArea(int leafnum)
 //=======================================================================
 
 /**
- * @brief Set up the planes and nodes so that the six floats of a bounding box
- * can just be stored out and get a proper clipping hull structure.
+ * @brief Set up the sides and planes of a box brush, the distances are filled
+ * in by CM_SetBoxHullBounds()
+ * @param[out] brush
+ * @param[out] sides 6 sides
+ * @param[out] planes 12 planes
  */
-void CM_InitBoxHull(void)
+static void CM_SetupBoxHull(cbrush_t *brush, cbrushside_t *sides, cplane_t *planes)
 {
 	byte         i;
 	int          side;
 	cplane_t     *p;
 	cbrushside_t *s;
 
-	box_planes = &cm.planes[cm.numPlanes];
-
-	box_brush           = &cm.brushes[cm.numBrushes];
-	box_brush->numsides = 6;
-	box_brush->sides    = cm.brushsides + cm.numBrushSides;
-	box_brush->contents = CONTENTS_BODY;
-
-	box_model.leaf.numLeafBrushes = 1;
-	//box_model.leaf.firstLeafBrush = cm.numBrushes;
-	box_model.leaf.firstLeafBrush     = cm.numLeafBrushes;
-	cm.leafbrushes[cm.numLeafBrushes] = cm.numBrushes;
+	brush->numsides = 6;
+	brush->sides    = sides;
+	brush->contents = CONTENTS_BODY;
 
 	for (i = 0 ; i < 6 ; i++)
 	{
 		side = i & 1;
 
 		// brush sides
-		s               = &cm.brushsides[cm.numBrushSides + i];
-		s->plane        = cm.planes + (cm.numPlanes + i * 2 + side);
+		s               = &sides[i];
+		s->plane        = planes + (i * 2 + side);
 		s->surfaceFlags = 0;
 
 		// planes
-		p           = &box_planes[i * 2];
+		p           = &planes[i * 2];
 		p->type     = i >> 1;
 		p->signbits = 0;
 		VectorClear(p->normal);
 		p->normal[i >> 1] = 1;
 
-		p           = &box_planes[i * 2 + 1];
+		p           = &planes[i * 2 + 1];
 		p->type     = 3 + (i >> 1);
 		p->signbits = 0;
 		VectorClear(p->normal);
@@ -915,6 +913,49 @@ void CM_InitBoxHull(void)
 	}
 }
 
+/**
+ * @brief Move the planes of a box brush to the given bounds
+ * @param[in,out] brush
+ * @param[in,out] planes
+ * @param[in] mins
+ * @param[in] maxs
+ */
+static void CM_SetBoxHullBounds(cbrush_t *brush, cplane_t *planes, const vec3_t mins, const vec3_t maxs)
+{
+	planes[0].dist  = maxs[0];
+	planes[1].dist  = -maxs[0];
+	planes[2].dist  = mins[0];
+	planes[3].dist  = -mins[0];
+	planes[4].dist  = maxs[1];
+	planes[5].dist  = -maxs[1];
+	planes[6].dist  = mins[1];
+	planes[7].dist  = -mins[1];
+	planes[8].dist  = maxs[2];
+	planes[9].dist  = -maxs[2];
+	planes[10].dist = mins[2];
+	planes[11].dist = -mins[2];
+
+	VectorCopy(mins, brush->bounds[0]);
+	VectorCopy(maxs, brush->bounds[1]);
+}
+
+/**
+ * @brief Set up the planes and nodes so that the six floats of a bounding box
+ * can just be stored out and get a proper clipping hull structure.
+ */
+void CM_InitBoxHull(void)
+{
+	box_planes = &cm.planes[cm.numPlanes];
+	box_brush  = &cm.brushes[cm.numBrushes];
+
+	CM_SetupBoxHull(box_brush, cm.brushsides + cm.numBrushSides, box_planes);
+
+	box_model.leaf.numLeafBrushes = 1;
+	//box_model.leaf.firstLeafBrush = cm.numBrushes;
+	box_model.leaf.firstLeafBrush     = cm.numLeafBrushes;
+	cm.leafbrushes[cm.numLeafBrushes] = cm.numBrushes;
+}
+
 /**
  * @brief To keep everything totally uniform, bounding boxes are turned into small
  * BSP trees instead of being compared directly.
@@ -935,21 +976,7 @@ clipHandle_t CM_TempBoxModel(const vec3_t mins, const vec3_t maxs, qboolean caps
 		return CAPSULE_MODEL_HANDLE;
 	}
 
-	box_planes[0].dist  = maxs[0];
-	box_planes[1].dist  = -maxs[0];
-	box_planes[2].dist  = mins[0];
-	box_planes[3].dist  = -mins[0];
-	box_planes[4].dist  = maxs[1];
-	box_planes[5].dist  = -maxs[1];
-	box_planes[6].dist  = mins[1];
-	box_planes[7].dist  = -mins[1];
-	box_planes[8].dist  = maxs[2];
-	box_planes[9].dist  = -maxs[2];
-	box_planes[10].dist = mins[2];
-	box_planes[11].dist = -mins[2];
-
-	VectorCopy(mins, box_brush->bounds[0]);
-	VectorCopy(maxs, box_brush->bounds[1]);
+	CM_SetBoxHullBounds(box_brush, box_planes, mins, maxs);
 
 	return BOX_MODEL_HANDLE;
 }
@@ -963,6 +990,92 @@ void CM_SetTempBoxModelContents(int contents)
 	box_brush->contents = contents;
 }
 
+/**
+ * @brief Create a trace context for a thread other than the main one
+ *
+ * The context can be kept across map changes, its stamp arrays are resized
+ * on the first trace against a new map.
+ *
+ * @return
+ */
+cmTraceContext_t *CM_CreateTraceContext(void)
+{
+	cmTraceContext_t *ctx;
+
+	ctx = Com_Allocate(sizeof(*ctx));
+	if (!ctx)
+	{
+		Com_Error(ERR_FATAL, "CM_CreateTraceContext: out of memory");
+	}
+	Com_Memset(ctx, 0, sizeof(*ctx));
+
+	ctx->boxBrush = &ctx->boxBrushStore;
+	CM_SetupBoxHull(ctx->boxBrush, ctx->boxSides, ctx->boxPlanes);
+
+	return ctx;
+}
+
+/**
+ * @brief CM_FreeTraceContext
+ * @param[in] ctx
+ */
+void CM_FreeTraceContext(cmTraceContext_t *ctx)
+{
+	if (!ctx || ctx == &cm_mainTraceContext)
+	{
+		return;
+	}
+
+	Com_Dealloc(ctx->brushChecks);
+	Com_Dealloc(ctx->patchChecks);
+	Com_Dealloc(ctx);
+}
+
+/**
+ * @brief CM_TempBoxModel() for a trace context
+ *
+ * The handle is only valid for traces through the same context.
+ *
+ * @param[in,out] ctx NULL for the main thread
+ * @param[in] mins
+ * @param[in] maxs
+ * @param[in] capsule
+ * @return
+ */
+clipHandle_t CM_ContextTempBoxModel(cmTraceContext_t *ctx, const vec3_t mins, const vec3_t maxs, qboolean capsule)
+{
+	if (!ctx || !ctx->boxBrush)
+	{
+		return CM_TempBoxModel(mins, maxs, capsule);
+	}
+
+	// same as CM_TempBoxModel(), capsules leave the box brush alone
+	if (capsule)
+	{
+		return CAPSULE_MODEL_HANDLE;
+	}
+
+	CM_SetBoxHullBounds(ctx->boxBrush, ctx->boxPlanes, mins, maxs);
+
+	return BOX_MODEL_HANDLE;
+}
+
+/**
+ * @brief CM_SetTempBoxModelContents() for a trace context
+ * @param[in,out] ctx NULL for the main thread
+ * @param[in] contents
+ */
+void CM_ContextSetTempBoxModelContents(cmTraceContext_t *ctx, int contents)
+{
+	if (!ctx || !ctx->boxBrush)
+	{
+		CM_SetTempBoxModelContents(contents);
+		return;
+	}
+
+	ctx->boxBrush->contents = contents;
+}
+
 /**
  * @brief CM_ModelBounds
  * @param[in] model
@@ -101,7 +101,6 @@ typedef struct
 	vec3_t bounds[2];
 	int numsides;
 	cbrushside_t *sides;
-	int checkcount;            ///< to avoid repeated testings
 } cbrush_t;
 
 /**
@@ -109,7 +108,6 @@ typedef struct
  */
 typedef struct
 {
-	int checkcount;                    ///< to avoid repeated testings
 	int surfaceFlags;
 	int contents;
 	struct patchCollide_s *pc;
@@ -174,16 +172,38 @@ typedef struct
 	cPatch_t **surfaces;            ///< non-patches will be NULL
 
 	int floodvalid;
-	int checkcount;                         ///< incremented on each trace
 } clipMap_t;
 
+/**
+ * @struct cmTraceContext_s
+ * @brief Scratch state of one tracing thread
+ *
+ * Holds what used to live in the shared map data while tracing: the
+ * multi-check stamps of brushes and patches and the temporary box model.
+ * The stamp arrays are sized lazily for the loaded map.
+ */
+struct cmTraceContext_s
+{
+	int checkcount;                         ///< incremented on each trace
+	int generation;                         ///< cm_generation the stamp arrays belong to
+	int *brushChecks;                       ///< [cm.numBrushes + 1], the last one is the box brush
+	int *patchChecks;                       ///< [cm.numSurfaces]
+
+	cbrush_t *boxBrush;                     ///< NULL uses the box brush stored behind the map brushes
+	cbrush_t boxBrushStore;
+	cbrushside_t boxSides[6];
+	cplane_t boxPlanes[12];
+};
+
 
 /// keep 1/8 unit away to keep the position valid before network snapping
 /// and to avoid various numeric issues
 #define SURFACE_CLIP_EPSILON    (0.125f)
 
-extern clipMap_t cm;
-extern int       c_pointcontents;
+extern clipMap_t        cm;
+extern int              cm_generation;
+extern cmTraceContext_t cm_mainTraceContext;
+extern int              c_pointcontents;
 extern int       c_traces, c_brush_traces, c_patch_traces;
 extern cvar_t    *cm_noAreas;
 extern cvar_t    *cm_noCurves;
@@ -229,6 +249,7 @@ typedef struct
 	float traceDist2;
 	vec3_t dir;
 
+	cmTraceContext_t *ctx;  ///< stamps and box model of the tracing thread
 } traceWork_t;
 
 /**
@@ -254,6 +275,9 @@ void CM_BoxLeafnums_r(leafList_t *ll, int nodenum);
 
 cmodel_t *CM_ClipHandleToModel(clipHandle_t handle);
 
+// cm_trace.c
+cmTraceContext_t *CM_NextCheckCount(cmTraceContext_t *ctx);
+
 // cm_patch.c
 struct patchCollide_s *CM_GeneratePatchCollide(int width, int height, vec3_t *points, qboolean addBevels);
 void CM_TraceThroughPatchCollide(traceWork_t *tw, const struct patchCollide_s *pc);
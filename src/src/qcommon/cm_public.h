@@ -39,6 +39,8 @@
 
 #include "../renderercommon/tr_types.h"
 
+typedef struct cmTraceContext_s cmTraceContext_t;
+
 void CM_LoadMap(const char *name, qboolean clientload, unsigned int *checksum);
 void CM_ClearMap(void);
 
@@ -64,6 +66,20 @@ void CM_TransformedBoxTrace(trace_t *results, const vec3_t start, const vec3_t e
                             clipHandle_t model, int brushmask,
                             const vec3_t origin, const vec3_t angles, qboolean capsule);
 
+// trace contexts let several threads trace the loaded map at the same time,
+// each one with its own context (NULL is the main thread context used above)
+cmTraceContext_t *CM_CreateTraceContext(void);
+void CM_FreeTraceContext(cmTraceContext_t *ctx);
+clipHandle_t CM_ContextTempBoxModel(cmTraceContext_t *ctx, const vec3_t mins, const vec3_t maxs, qboolean capsule);
+void CM_ContextSetTempBoxModelContents(cmTraceContext_t *ctx, int contents);
+void CM_ContextBoxTrace(cmTraceContext_t *ctx, trace_t *results, const vec3_t start, const vec3_t end,
+                        const vec3_t mins, const vec3_t maxs,
+                        clipHandle_t model, int brushmask, qboolean capsule);
+void CM_ContextTransformedBoxTrace(cmTraceContext_t *ctx, trace_t *results, const vec3_t start, const vec3_t end,
+                                   const vec3_t mins, const vec3_t maxs,
+                                   clipHandle_t model, int brushmask,
+                                   const vec3_t origin, const vec3_t angles, qboolean capsule);
+
 byte *CM_ClusterPVS(int cluster);
 
 int CM_PointLeafnum(const vec3_t p);
@@ -126,21 +126,22 @@ void CM_StoreLeafs(leafList_t *ll, int nodenum)
  */
 void CM_StoreBrushes(leafList_t *ll, int nodenum)
 {
-	int      i, k;
-	int      leafnum = -1 - nodenum;
-	int      brushnum;
-	cLeaf_t  *leaf = &cm.leafs[leafnum];
-	cbrush_t *b;
+	int              i, k;
+	int              leafnum = -1 - nodenum;
+	int              brushnum;
+	cLeaf_t          *leaf = &cm.leafs[leafnum];
+	cbrush_t         *b;
+	cmTraceContext_t *ctx = &cm_mainTraceContext;
 
 	for (k = 0 ; k < leaf->numLeafBrushes ; k++)
 	{
 		brushnum = cm.leafbrushes[leaf->firstLeafBrush + k];
 		b        = &cm.brushes[brushnum];
-		if (b->checkcount == cm.checkcount)
+		if (ctx->brushChecks[brushnum] == ctx->checkcount)
 		{
 			continue;   // already checked this brush in another leaf
 		}
-		b->checkcount = cm.checkcount;
+		ctx->brushChecks[brushnum] = ctx->checkcount;
 		for (i = 0 ; i < 3 ; i++)
 		{
 			if (b->bounds[0][i] >= ll->bounds[1][i] || b->bounds[1][i] <= ll->bounds[0][i])
@@ -226,8 +227,6 @@ int CM_BoxLeafnums(const vec3_t mins, const vec3_t maxs, int *list, int listsize
 {
 	leafList_t ll;
 
-	cm.checkcount++;
-
 	VectorCopy(mins, ll.bounds[0]);
 	VectorCopy(maxs, ll.bounds[1]);
 	ll.count      = 0;
@@ -257,7 +256,7 @@ int CM_BoxBrushes(const vec3_t mins, const vec3_t maxs, cbrush_t **list, int lis
 {
 	leafList_t ll;
 
-	cm.checkcount++;
+	CM_NextCheckCount(NULL);
 
 	VectorCopy(mins, ll.bounds[0]);
 	VectorCopy(maxs, ll.bounds[1]);
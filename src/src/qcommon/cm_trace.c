@@ -42,6 +42,70 @@
 
 //#define CAPSULE_DEBUG
 
+/// used by the CM_ calls without a context, main thread only
+cmTraceContext_t cm_mainTraceContext;
+
+/**
+===============================================================================
+TRACE CONTEXTS
+===============================================================================
+*/
+
+/**
+ * @brief Start a new multi-check pass
+ *
+ * Sizes the stamp arrays of the context for the loaded map first if needed.
+ *
+ * @param[in,out] ctx NULL for the main thread
+ * @return The context to use
+ */
+cmTraceContext_t *CM_NextCheckCount(cmTraceContext_t *ctx)
+{
+	if (!ctx)
+	{
+		ctx = &cm_mainTraceContext;
+	}
+
+	if (ctx->generation != cm_generation || !ctx->brushChecks)
+	{
+		Com_Dealloc(ctx->brushChecks);
+		Com_Dealloc(ctx->patchChecks);
+
+		// + 1 for the box brush stored behind the map brushes
+		ctx->brushChecks = Com_Allocate((cm.numBrushes + 1) * sizeof(*ctx->brushChecks));
+		ctx->patchChecks = Com_Allocate((cm.numSurfaces + 1) * sizeof(*ctx->patchChecks));
+		if (!ctx->brushChecks || !ctx->patchChecks)
+		{
+			Com_Error(ERR_FATAL, "CM_NextCheckCount: out of memory");
+		}
+		Com_Memset(ctx->brushChecks, 0, (cm.numBrushes + 1) * sizeof(*ctx->brushChecks));
+		Com_Memset(ctx->patchChecks, 0, (cm.numSurfaces + 1) * sizeof(*ctx->patchChecks));
+
+		ctx->checkcount = 0;
+		ctx->generation = cm_generation;
+	}
+
+	ctx->checkcount++;
+
+	return ctx;
+}
+
+/**
+ * @brief Brush of a leaf, the box brush comes from the trace context
+ * @param[in] tw
+ * @param[in] brushnum
+ * @return
+ */
+static ID_INLINE cbrush_t *CM_TraceBrush(const traceWork_t *tw, int brushnum)
+{
+	if (brushnum == cm.numBrushes && tw->ctx->boxBrush)
+	{
+		return tw->ctx->boxBrush;
+	}
+
+	return &cm.brushes[brushnum];
+}
+
 /**
 ===============================================================================
 BASIC MATH
@@ -237,12 +301,13 @@ void CM_TestInLeaf(traceWork_t *tw, cLeaf_t *leaf)
 	for (k = 0 ; k < leaf->numLeafBrushes ; k++)
 	{
 		brushnum = cm.leafbrushes[leaf->firstLeafBrush + k];
-		b        = &cm.brushes[brushnum];
-		if (b->checkcount == cm.checkcount)
+		if (tw->ctx->brushChecks[brushnum] == tw->ctx->checkcount)
 		{
 			continue;   // already checked this brush in another leaf
 		}
-		b->checkcount = cm.checkcount;
+		tw->ctx->brushChecks[brushnum] = tw->ctx->checkcount;
+
+		b = CM_TraceBrush(tw, brushnum);
 
 		if (!(b->contents & tw->contents))
 		{
@@ -260,19 +325,21 @@ void CM_TestInLeaf(traceWork_t *tw, cLeaf_t *leaf)
 	if (!cm_noCurves->integer)
 	{
 		cPatch_t *patch;
+		int      surfacenum;
 
 		for (k = 0 ; k < leaf->numLeafSurfaces ; k++)
 		{
-			patch = cm.surfaces[cm.leafsurfaces[leaf->firstLeafSurface + k]];
+			surfacenum = cm.leafsurfaces[leaf->firstLeafSurface + k];
+			patch      = cm.surfaces[surfacenum];
 			if (!patch)
 			{
 				continue;
 			}
-			if (patch->checkcount == cm.checkcount)
+			if (tw->ctx->patchChecks[surfacenum] == tw->ctx->checkcount)
 			{
 				continue;   // already checked this brush in another leaf
 			}
-			patch->checkcount = cm.checkcount;
+			tw->ctx->patchChecks[surfacenum] = tw->ctx->checkcount;
 
 			if (!(patch->contents & tw->contents))
 			{
@@ -398,7 +465,7 @@ void CM_TestBoundingBoxInCapsule(traceWork_t *tw, clipHandle_t model)
 	VectorSet(tw->sphere.offset, 0, 0, size[1][2] - tw->sphere.radius);
 
 	// replace the capsule with the bounding box
-	h = CM_TempBoxModel(tw->size[0], tw->size[1], qfalse);
+	h = CM_ContextTempBoxModel(tw->ctx, tw->size[0], tw->size[1], qfalse);
 	// calculate collision
 	cmod = CM_ClipHandleToModel(h);
 	CM_TestInLeaf(tw, &cmod->leaf);
@@ -434,11 +501,9 @@ void CM_PositionTest(traceWork_t *tw)
 	ll.lastLeaf   = 0;
 	ll.overflowed = qfalse;
 
-	cm.checkcount++;
-
 	CM_BoxLeafnums_r(&ll, 0);
 
-	cm.checkcount++;
+	CM_NextCheckCount(tw->ctx);
 
 	// test the contents of the leafs
 	for (i = 0 ; i < ll.count ; i++)
@@ -466,7 +531,10 @@ static void CM_TraceThroughPatch(traceWork_t *tw, cPatch_t *patch)
 {
 	float oldFrac = tw->trace.fraction;
 
-	c_patch_traces++;
+	if (tw->ctx == &cm_mainTraceContext)
+	{
+		c_patch_traces++;
+	}
 
 	CM_TraceThroughPatchCollide(tw, patch->pc);
 
@@ -617,7 +685,10 @@ static void CM_TraceThroughBrush(traceWork_t *tw, cbrush_t *brush)
 		return;
 	}
 
-	c_brush_traces++;
+	if (tw->ctx == &cm_mainTraceContext)
+	{
+		c_brush_traces++;
+	}
 
 	getout   = qfalse;
 	startout = qfalse;
@@ -811,19 +882,21 @@ static void CM_TraceThroughBrush(traceWork_t *tw, cbrush_t *brush)
 static void CM_TraceThroughLeaf(traceWork_t *tw, cLeaf_t *leaf)
 {
 	int      k;
+	int      brushnum;
 	cbrush_t *brush;
 	float    fraction;
 
 	// trace line against all brushes in the leaf
 	for (k = 0 ; k < leaf->numLeafBrushes ; k++)
 	{
-		// brushnum = cm.leafbrushes[leaf->firstLeafBrush + k];
-		brush = &cm.brushes[cm.leafbrushes[leaf->firstLeafBrush + k]];
-		if (brush->checkcount == cm.checkcount)
+		brushnum = cm.leafbrushes[leaf->firstLeafBrush + k];
+		if (tw->ctx->brushChecks[brushnum] == tw->ctx->checkcount)
 		{
 			continue;   // already checked this brush in another leaf
 		}
-		brush->checkcount = cm.checkcount;
+		tw->ctx->brushChecks[brushnum] = tw->ctx->checkcount;
+
+		brush = CM_TraceBrush(tw, brushnum);
 
 		if (!(brush->contents & tw->contents))
 		{
@@ -857,19 +930,21 @@ static void CM_TraceThroughLeaf(traceWork_t *tw, cLeaf_t *leaf)
 	if (!cm_noCurves->integer)
 	{
 		cPatch_t *patch;
+		int      surfacenum;
 
 		for (k = 0 ; k < leaf->numLeafSurfaces ; k++)
 		{
-			patch = cm.surfaces[cm.leafsurfaces[leaf->firstLeafSurface + k]];
+			surfacenum = cm.leafsurfaces[leaf->firstLeafSurface + k];
+			patch      = cm.surfaces[surfacenum];
 			if (!patch)
 			{
 				continue;
 			}
-			if (patch->checkcount == cm.checkcount)
+			if (tw->ctx->patchChecks[surfacenum] == tw->ctx->checkcount)
 			{
 				continue;   // already checked this patch in another leaf
 			}
-			patch->checkcount = cm.checkcount;
+			tw->ctx->patchChecks[surfacenum] = tw->ctx->checkcount;
 
 			if (!(patch->contents & tw->contents))
 			{
@@ -1227,7 +1302,7 @@ static void CM_TraceBoundingBoxThroughCapsule(traceWork_t *tw, clipHandle_t mode
 	VectorSet(tw->sphere.offset, 0, 0, size[1][2] - tw->sphere.radius);
 
 	// replace the capsule with the bounding box
-	h = CM_TempBoxModel(tw->size[0], tw->size[1], qfalse);
+	h = CM_ContextTempBoxModel(tw->ctx, tw->size[0], tw->size[1], qfalse);
 	// calculate collision
 	cmod = CM_ClipHandleToModel(h);
 	CM_TraceThroughLeaf(tw, &cmod->leaf);
@@ -1386,6 +1461,7 @@ static void CM_TraceThroughTree(traceWork_t *tw, int num, float p1f, float p2f,
 
 /**
  * @brief CM_Trace
+ * @param[in,out] ctx NULL for the main thread
  * @param[out] results
  * @param[in] start
  * @param[in] end
@@ -1397,7 +1473,7 @@ static void CM_TraceThroughTree(traceWork_t *tw, int num, float p1f, float p2f,
  * @param[in] capsule
  * @param[in] sphere
  */
-static void CM_Trace(trace_t *results, const vec3_t start, const vec3_t end,
+static void CM_Trace(cmTraceContext_t *ctx, trace_t *results, const vec3_t start, const vec3_t end,
                      const vec3_t mins, const vec3_t maxs,
                      clipHandle_t model, const vec3_t origin, int brushmask, qboolean capsule, sphere_t *sphere)
 {
@@ -1409,10 +1485,6 @@ static void CM_Trace(trace_t *results, const vec3_t start, const vec3_t end,
 
 	cmod = CM_ClipHandleToModel(model);
 
-	cm.checkcount++;        // for multi-check avoidance
-
-	c_traces++;             // for statistics, may be zeroed
-
 	// fill in a default trace
 	Com_Memset(&tw, 0, sizeof(tw));
 	tw.trace.fraction = 1.0f;   // assume it goes the entire distance until shown otherwise
@@ -1425,6 +1497,13 @@ static void CM_Trace(trace_t *results, const vec3_t start, const vec3_t end,
 		return; // map not loaded, shouldn't happen
 	}
 
+	tw.ctx = CM_NextCheckCount(ctx);    // for multi-check avoidance
+
+	if (tw.ctx == &cm_mainTraceContext)
+	{
+		c_traces++;             // for statistics, may be zeroed
+	}
+
 	// allow NULL to be passed in for 0,0,0
 	if (!mins)
 	{
@@ -1672,12 +1751,32 @@ void CM_BoxTrace(trace_t *results, const vec3_t start, const vec3_t end,
                  const vec3_t mins, const vec3_t maxs,
                  clipHandle_t model, int brushmask, qboolean capsule)
 {
-	CM_Trace(results, start, end, mins, maxs, model, vec3_origin, brushmask, capsule, NULL);
+	CM_Trace(NULL, results, start, end, mins, maxs, model, vec3_origin, brushmask, capsule, NULL);
+}
+
+/**
+ * @brief CM_BoxTrace() through a trace context, can run on any thread
+ * @param[in,out] ctx NULL for the main thread
+ * @param[out] results
+ * @param[in] start
+ * @param[in] end
+ * @param[in] mins
+ * @param[in] maxs
+ * @param[in] model
+ * @param[in] brushmask
+ * @param[in] capsule
+ */
+void CM_ContextBoxTrace(cmTraceContext_t *ctx, trace_t *results, const vec3_t start, const vec3_t end,
+                        const vec3_t mins, const vec3_t maxs,
+                        clipHandle_t model, int brushmask, qboolean capsule)
+{
+	CM_Trace(ctx, results, start, end, mins, maxs, model, vec3_origin, brushmask, capsule, NULL);
 }
 
 /**
  * @brief Handles offseting and rotation of the end points for moving and
  * rotating entities
+ * @param[in,out] ctx NULL for the main thread
  * @param[out] results
  * @param[in] start
  * @param[in] end
@@ -1689,10 +1788,10 @@ void CM_BoxTrace(trace_t *results, const vec3_t start, const vec3_t end,
  * @param[in] angles
  * @param[in] capsule
  */
-void CM_TransformedBoxTrace(trace_t *results, const vec3_t start, const vec3_t end,
-                            const vec3_t mins, const vec3_t maxs,
-                            clipHandle_t model, int brushmask,
-                            const vec3_t origin, const vec3_t angles, qboolean capsule)
+void CM_ContextTransformedBoxTrace(cmTraceContext_t *ctx, trace_t *results, const vec3_t start, const vec3_t end,
+                                   const vec3_t mins, const vec3_t maxs,
+                                   clipHandle_t model, int brushmask,
+                                   const vec3_t origin, const vec3_t angles, qboolean capsule)
 {
 	trace_t  trace;
 	vec3_t   start_l, end_l;
@@ -1771,7 +1870,7 @@ void CM_TransformedBoxTrace(trace_t *results, const vec3_t start, const vec3_t e
 	}
 
 	// sweep the box through the model
-	CM_Trace(&trace, start_l, end_l, symetricSize[0], symetricSize[1], model, origin, brushmask, capsule, &sphere);
+	CM_Trace(ctx, &trace, start_l, end_l, symetricSize[0], symetricSize[1], model, origin, brushmask, capsule, &sphere);
 
 	// if the bmodel was rotated and there was a collision
 	if (rotated && trace.fraction != 1.0f)
@@ -1789,3 +1888,24 @@ void CM_TransformedBoxTrace(trace_t *results, const vec3_t start, const vec3_t e
 
 	*results = trace;
 }
+
+/**
+ * @brief CM_TransformedBoxTrace
+ * @param[out] results
+ * @param[in] start
+ * @param[in] end
+ * @param[in] mins
+ * @param[in] maxs
+ * @param[in] model
+ * @param[in] brushmask
+ * @param[in] origin
+ * @param[in] angles
+ * @param[in] capsule
+ */
+void CM_TransformedBoxTrace(trace_t *results, const vec3_t start, const vec3_t end,
+                            const vec3_t mins, const vec3_t maxs,
+                            clipHandle_t model, int brushmask,
+                            const vec3_t origin, const vec3_t angles, qboolean capsule)
+{
+	CM_ContextTransformedBoxTrace(NULL, results, start, end, mins, maxs, model, brushmask, origin, angles, capsule);
+}
@@ -3045,6 +3045,7 @@ void Com_Init(char *commandLine)
 
 	Cmd_AddCommand("quit", Com_Quit_f, "Quits the game.");
 	Cmd_AddCommand("changeVectors", MSG_ReportChangeVectors_f, "Prints out a table from the current statistics for copying to code.");
+	Cmd_AddCommand("huffbench", MSG_HuffmanBench_f, "Times the tree and table Huffman coders on the messages of a demo.");
 	Cmd_AddCommand("writeconfig", Com_WriteConfig_f, "Write the config file to a specific name.");
 	Cmd_AddCommand("update", Com_Update_f, "Updates the game to latest version.");
 	Cmd_AddCommand("download", Com_Download_f, "Downloads a pk3 from the URL set in cvar com_downloadURL.");
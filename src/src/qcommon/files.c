@@ -491,7 +491,7 @@ static fileHandle_t FS_HandleForFile(void)
  * @param[in] f
  * @return
  */
-static FILE *FS_FileForHandle(fileHandle_t f)
+FILE *FS_FileForHandle(fileHandle_t f)
 {
 	if (f < 1 || f >= MAX_FILE_HANDLES)
 	{
@@ -38,7 +38,7 @@
 #include "q_shared.h"
 #include "qcommon.h"
 
-static int bloc = 0;
+static int bloc = 0; ///< bit position of the adaptive Huff_Compress()/Huff_Decompress() coder, main thread only
 
 /**
  * @brief Clears data along the way so we dont have to memset() it ahead of time
@@ -50,16 +50,14 @@ void Huff_putBit(int bit, byte *fout, int *offset)
 {
 	int x, y;
 
-	bloc = *offset;
-	x    = bloc >> 3;
-	y    = bloc & 7;
+	x = *offset >> 3;
+	y = *offset & 7;
 	if (!y)
 	{
 		fout[x] = 0;
 	}
 	fout[x] |= bit << y;
-	bloc++;
-	*offset = bloc;
+	(*offset)++;
 }
 
 /**
@@ -72,10 +70,8 @@ int Huff_getBit(byte *fin, int *offset)
 {
 	int t;
 
-	bloc = *offset;
-	t    = fin[bloc >> 3] >> (bloc & 7) & 0x1;
-	bloc++;
-	*offset = bloc;
+	t = fin[*offset >> 3] >> (*offset & 7) & 0x1;
+	(*offset)++;
 	return t;
 }
 
@@ -84,13 +80,14 @@ int Huff_getBit(byte *fin, int *offset)
  *
  * @param[in] bit
  * @param[out] fout
+ * @param[in,out] pos
  */
-static void add_bit(const char bit, byte *fout)
+static void add_bit(const char bit, byte *fout, int *pos)
 {
 	int x, y;
 
-	y = bloc >> 3;
-	x = bloc++ & 7;
+	y = *pos >> 3;
+	x = (*pos)++ & 7;
 	if (!x)
 	{
 		fout[y] = 0;
@@ -101,14 +98,15 @@ static void add_bit(const char bit, byte *fout)
 /**
  * @brief get_bit
  * @param[in] fin
+ * @param[in,out] pos
  * @return
  */
-static int get_bit(byte *fin)
+static int get_bit(byte *fin, int *pos)
 {
 	int t;
 
-	t = fin[bloc >> 3] >> (bloc & 7) & 0x1;
-	bloc++;
+	t = fin[*pos >> 3] >> (*pos & 7) & 0x1;
+	(*pos)++;
 	return t;
 }
 
@@ -393,7 +391,7 @@ int Huff_Receive(node_t *node, int *ch, byte *fin)
 {
 	while (node && node->symbol == INTERNAL_NODE)
 	{
-		if (get_bit(fin))
+		if (get_bit(fin, &bloc))
 		{
 			node = node->right;
 		}
@@ -420,16 +418,17 @@ int Huff_Receive(node_t *node, int *ch, byte *fin)
  */
 void Huff_offsetReceive(node_t *node, int *ch, byte *fin, int *offset, int maxoffset)
 {
-	bloc = *offset;
+	int pos = *offset;
+
 	while (node && node->symbol == INTERNAL_NODE)
 	{
-		if (bloc >= maxoffset)
+		if (pos >= maxoffset)
 		{
 			*ch     = 0;
 			*offset = maxoffset + 1;
 			return;
 		}
-		if (get_bit(fin))
+		if (get_bit(fin, &pos))
 		{
 			node = node->right;
 		}
@@ -445,7 +444,7 @@ void Huff_offsetReceive(node_t *node, int *ch, byte *fin, int *offset, int maxof
 		//Com_Error(ERR_DROP, "Illegal tree!");
 	}
 	*ch     = node->symbol;
-	*offset = bloc;
+	*offset = pos;
 }
 
 /**
@@ -453,28 +452,29 @@ void Huff_offsetReceive(node_t *node, int *ch, byte *fin, int *offset, int maxof
  * @param[in] node
  * @param[in] child
  * @param[in] fout
+ * @param[in,out] pos
  * @param[in] maxoffset
  */
-static void send(node_t *node, node_t *child, byte *fout, int maxoffset)
+static void send(node_t *node, node_t *child, byte *fout, int *pos, int maxoffset)
 {
 	if (node->parent)
 	{
-		send(node->parent, node, fout, maxoffset);
+		send(node->parent, node, fout, pos, maxoffset);
 	}
 	if (child)
 	{
-		if (bloc >= maxoffset)
+		if (*pos >= maxoffset)
 		{
-			bloc = maxoffset + 1;
+			*pos = maxoffset + 1;
 			return;
 		}
 		if (node->right == child)
 		{
-			add_bit(1, fout);
+			add_bit(1, fout, pos);
 		}
 		else
 		{
-			add_bit(0, fout);
+			add_bit(0, fout, pos);
 		}
 	}
 }
@@ -496,12 +496,12 @@ void Huff_transmit(huff_t *huff, int ch, byte *fout, int maxoffset)
 		Huff_transmit(huff, NYT, fout, maxoffset);
 		for (i = 7; i >= 0; i--)
 		{
-			add_bit((char)((ch >> i) & 0x1), fout);
+			add_bit((char)((ch >> i) & 0x1), fout, &bloc);
 		}
 	}
 	else
 	{
-		send(huff->loc[ch], NULL, fout, maxoffset);
+		send(huff->loc[ch], NULL, fout, &bloc, maxoffset);
 	}
 }
 
@@ -512,12 +512,206 @@ void Huff_transmit(huff_t *huff, int ch, byte *fout, int maxoffset)
  * @param[out] fout
  * @param[in,out] offset
  * @param[in] maxoffset
+ *
+ * @note Only touches the caller's offset, so messages can be written from
+ * several threads at once (the tree is read-only after MSG_initHuffman)
  */
 void Huff_offsetTransmit(huff_t *huff, int ch, byte *fout, int *offset, int maxoffset)
 {
-	bloc = *offset;
-	send(huff->loc[ch], NULL, fout, maxoffset);
-	*offset = bloc;
+	send(huff->loc[ch], NULL, fout, offset, maxoffset);
+}
+
+/**
+ * @brief Write several raw bits at once, first bit lowest, same layout as repeated Huff_putBit()
+ * @param[in] value
+ * @param[in] bits 0 to 32
+ * @param[out] fout
+ * @param[in,out] offset
+ */
+void Huff_putBits(uint32_t value, int bits, byte *fout, int *offset)
+{
+	uint64_t v;
+	byte     *p;
+	int      shift, left;
+
+	if (bits <= 0)
+	{
+		return;
+	}
+
+	shift = *offset & 7;
+	p     = fout + (*offset >> 3);
+	v     = (uint64_t)(bits < 32 ? value & ((1u << bits) - 1) : value) << shift;
+
+	// the first byte may hold earlier bits, the following ones start out clear
+	if (shift)
+	{
+		*p++ |= (byte)v;
+	}
+	else
+	{
+		*p++ = (byte)v;
+	}
+	for (left = shift + bits - 8; left > 0; left -= 8)
+	{
+		v    >>= 8;
+		*p++   = (byte)v;
+	}
+
+	*offset += bits;
+}
+
+/**
+ * @brief Read several raw bits at once, same result as repeated Huff_getBit()
+ * @param[in] fin
+ * @param[in,out] offset
+ * @param[in] bits 0 to 24
+ * @return
+ */
+int Huff_getBits(byte *fin, int *offset, int bits)
+{
+	const byte *p;
+	uint32_t   v = 0;
+	int        shift, bytes, i;
+
+	if (bits <= 0)
+	{
+		return 0;
+	}
+
+	shift = *offset & 7;
+	p     = fin + (*offset >> 3);
+	bytes = (shift + bits + 7) >> 3;
+
+	// only touch the bytes the bits live in, the caller checked those against the buffer
+	for (i = 0; i < bytes; i++)
+	{
+		v |= (uint32_t)p[i] << (i << 3);
+	}
+
+	*offset += bits;
+	return (int)((v >> shift) & ((1u << bits) - 1));
+}
+
+/**
+ * @brief Flatten a tree that won't be updated any more into code and decode tables
+ *
+ * The code of each symbol is packed in the order send() emits it, so the
+ * encoder can write it with a single Huff_putBits(). The decode table maps the
+ * next HUFF_LOOKUP_BITS input bits to the symbol and code length, codes longer
+ * than that are left to the tree walk.
+ *
+ * @param[out] table
+ * @param[in] huff The tree must outlive the table
+ */
+void Huff_BuildTable(huffTable_t *table, huff_t *huff)
+{
+	node_t *node;
+	int    i, j;
+
+	Com_Memset(table, 0, sizeof(*table));
+	table->huff = huff;
+
+	for (i = 0; i <= HMAX; i++)
+	{
+		uint32_t code = 0;
+		int      length;
+
+		if (!huff->loc[i])
+		{
+			continue;
+		}
+
+		// walk up from the leaf, the bit next to the root is sent first
+		for (node = huff->loc[i], length = 0; node->parent; node = node->parent, length++)
+		{
+			if (length == 32)
+			{
+				break;
+			}
+			code = (code << 1) | (node->parent->right == node ? 1 : 0);
+		}
+		if (node->parent)
+		{
+			continue;   // too long for the tables, send() handles it
+		}
+
+		table->code[i]   = code;
+		table->length[i] = (byte)length;
+	}
+
+	for (i = 0; i < (1 << HUFF_LOOKUP_BITS); i++)
+	{
+		node = huff->tree;
+		for (j = 0; j < HUFF_LOOKUP_BITS && node && node->symbol == INTERNAL_NODE; j++)
+		{
+			node = ((i >> j) & 1) ? node->right : node->left;
+		}
+
+		if (node && node->symbol != INTERNAL_NODE && j > 0)
+		{
+			table->lookup[i] = (unsigned short)(node->symbol | (j << 9));
+		}
+	}
+}
+
+/**
+ * @brief Table driven Huff_offsetTransmit(), writes the same bits
+ * @param[in] table
+ * @param[in] ch
+ * @param[out] fout
+ * @param[in,out] offset
+ * @param[in] maxoffset
+ */
+void Huff_tableTransmit(const huffTable_t *table, int ch, byte *fout, int *offset, int maxoffset)
+{
+	int length = table->length[ch];
+
+	// leave the overflow case to the tree so the partial write matches exactly
+	if (!length || *offset + length > maxoffset)
+	{
+		Huff_offsetTransmit(table->huff, ch, fout, offset, maxoffset);
+		return;
+	}
+
+	Huff_putBits(table->code[ch], length, fout, offset);
+}
+
+/**
+ * @brief Table driven Huff_offsetReceive(), reads the same symbol
+ * @param[in] table
+ * @param[out] ch
+ * @param[in] fin
+ * @param[in,out] offset
+ * @param[in] maxoffset
+ */
+void Huff_tableReceive(const huffTable_t *table, int *ch, byte *fin, int *offset, int maxoffset)
+{
+	int pos = *offset;
+
+	if (pos + HUFF_LOOKUP_BITS <= maxoffset)
+	{
+		const byte   *p    = fin + (pos >> 3);
+		int          shift = pos & 7;
+		unsigned int bits  = p[0] | (p[1] << 8);
+		int          entry;
+
+		if (shift + HUFF_LOOKUP_BITS > 16)
+		{
+			bits |= p[2] << 16;
+		}
+
+		entry = table->lookup[(bits >> shift) & ((1 << HUFF_LOOKUP_BITS) - 1)];
+		if (entry)
+		{
+			*ch     = entry & 511;
+			*offset = pos + (entry >> 9);
+			return;
+		}
+	}
+
+	// long code or close to the end of the buffer
+	Huff_offsetReceive(table->huff->tree, ch, fin, offset, maxoffset);
 }
 
 /**
@@ -572,7 +766,7 @@ void Huff_Decompress(msg_t *mbuf, int offset)
 			ch = 0;
 			for (i = 0; i < 8; i++)
 			{
-				ch = (ch << 1) + get_bit(buffer);
+				ch = (ch << 1) + get_bit(buffer, &bloc);
 			}
 		}
 
@@ -584,8 +778,6 @@ void Huff_Decompress(msg_t *mbuf, int offset)
 	Com_Memcpy(mbuf->data + offset, seq, cch);
 }
 
-extern int oldsize;
-
 /**
  * @brief Huff_Compress
  * @param[in,out] mbuf
@@ -43,12 +43,10 @@
 #include "../game/g_public.h"
 
 static huffman_t msgHuff;
+static huffTable_t msgHuffTable;  ///< msgHuff flattened, the trees never change after MSG_initHuffman()
 static qboolean  msgInit = qfalse;
 
 int pcount[256];
-int wastedbits = 0;
-
-static int oldsize = 0;
 
 /*
 ==============================================================================
@@ -193,7 +191,7 @@ bit functions
  */
 void MSG_WriteBits(msg_t *msg, int value, int bits)
 {
-	oldsize += bits;
+	msg->oldsize += bits;
 
 	msg->uncompsize += bits; // net debugging
 
@@ -265,18 +263,15 @@ void MSG_WriteBits(msg_t *msg, int value, int bits)
 				return;
 			}
 
-			for (i = 0; i < nbits; i++)
-			{
-				Huff_putBit((value & 1), msg->data, &msg->bit);
-				value = (value >> 1);
-			}
-			bits = bits - nbits;
+			Huff_putBits(value, nbits, msg->data, &msg->bit);
+			value = (value >> nbits);
+			bits  = bits - nbits;
 		}
 		if (bits)
 		{
 			for (i = 0; i < bits; i += 8)
 			{
-				Huff_offsetTransmit(&msgHuff.compressor, (value & 0xff), msg->data, &msg->bit, msg->maxsize << 3);
+				Huff_tableTransmit(&msgHuffTable, (value & 0xff), msg->data, &msg->bit, msg->maxsize << 3);
 				value = (value >> 8);
 
 				if (msg->bit >= msg->maxsize << 3)
@@ -368,11 +363,8 @@ int MSG_ReadBits(msg_t *msg, int bits)
 				return 0;
 			}
 
-			for (i = 0; i < nbits; i++)
-			{
-				value |= (Huff_getBit(msg->data, &msg->bit) << i);
-			}
-			bits = bits - nbits;
+			value = Huff_getBits(msg->data, &msg->bit, nbits);
+			bits  = bits - nbits;
 		}
 		if (bits)
 		{
@@ -380,7 +372,7 @@ int MSG_ReadBits(msg_t *msg, int bits)
 
 			for (i = 0; i < bits; i += 8)
 			{
-				Huff_offsetReceive(msgHuff.decompressor.tree, &get, msg->data, &msg->bit, msg->cursize << 3);
+				Huff_tableReceive(&msgHuffTable, &get, msg->data, &msg->bit, msg->cursize << 3);
 				value = (unsigned int)value | ((unsigned int)get << (i + nbits));
 
 				if (msg->bit > msg->cursize << 3)
@@ -986,7 +978,7 @@ void MSG_WriteDeltaUsercmdKey(msg_t *msg, int key, usercmd_t *from, usercmd_t *t
 	    from->identClient == to->identClient)
 	{
 		MSG_WriteBits(msg, 0, 1); // no change
-		oldsize += 7;
+		msg->oldsize += 7;
 		return;
 	}
 	key ^= to->serverTime;
@@ -1313,7 +1305,7 @@ void MSG_WriteDeltaEntity(msg_t *msg, entityState_t *from, entityState_t *to, qb
 
 	MSG_WriteByte(msg, lc);     // # of changes
 
-	oldsize += numFields;
+	msg->oldsize += numFields;
 
 	//Com_Printf( "Delta for ent %i: ", to->number );
 
@@ -1326,7 +1318,7 @@ void MSG_WriteDeltaEntity(msg_t *msg, entityState_t *from, entityState_t *to, qb
 		{
 			MSG_WriteBits(msg, 0, 1);   // no change
 
-			wastedbits++;
+			msg->wastedbits++;
 
 			continue;
 		}
@@ -1342,7 +1334,7 @@ void MSG_WriteDeltaEntity(msg_t *msg, entityState_t *from, entityState_t *to, qb
 			if (fullFloat == 0.0f)
 			{
 				MSG_WriteBits(msg, 0, 1);
-				oldsize += FLOAT_INT_BITS;
+				msg->oldsize += FLOAT_INT_BITS;
 			}
 			else
 			{
@@ -1720,7 +1712,7 @@ void MSG_ETTV_WriteDeltaEntityShared(msg_t *msg, entityShared_t *from, entitySha
 
 	MSG_WriteByte(msg, lc);     // # of changes
 
-	oldsize += numFields;
+	msg->oldsize += numFields;
 
 	for (i = 0, field = ettventitySharedFields; i < lc; i++, field++)
 	{
@@ -1744,7 +1736,7 @@ void MSG_ETTV_WriteDeltaEntityShared(msg_t *msg, entityShared_t *from, entitySha
 			if (fullFloat == 0.0f)
 			{
 				MSG_WriteBits(msg, 0, 1);
-				oldsize += FLOAT_INT_BITS;
+				msg->oldsize += FLOAT_INT_BITS;
 			}
 			else
 			{
@@ -1939,7 +1931,7 @@ void MSG_WriteDeltaSharedEntity(msg_t *msg, void *from, void *to, qboolean force
 
 	MSG_WriteByte(msg, lc);     // # of changes
 
-	oldsize += numFields;
+	msg->oldsize += numFields;
 
 	for (i = 0, field = entitySharedFields ; i < lc ; i++, field++)
 	{
@@ -1963,7 +1955,7 @@ void MSG_WriteDeltaSharedEntity(msg_t *msg, void *from, void *to, qboolean force
 			if (fullFloat == 0.0f)
 			{
 				MSG_WriteBits(msg, 0, 1);
-				oldsize += FLOAT_INT_BITS;
+				msg->oldsize += FLOAT_INT_BITS;
 			}
 			else
 			{
@@ -2294,7 +2286,7 @@ void MSG_WriteDeltaPlayerstate(msg_t *msg, struct playerState_s *from, struct pl
 
 	MSG_WriteByte(msg, lc);     // # of changes
 
-	oldsize += numFields - lc;
+	msg->oldsize += numFields - lc;
 
 	for (i = 0, field = playerStateFields ; i < lc ; i++, field++)
 	{
@@ -2303,7 +2295,7 @@ void MSG_WriteDeltaPlayerstate(msg_t *msg, struct playerState_s *from, struct pl
 
 		if (*fromF == *toF)
 		{
-			wastedbits++;
+			msg->wastedbits++;
 
 			MSG_WriteBits(msg, 0, 1);   // no change
 			continue;
@@ -2459,7 +2451,7 @@ void MSG_WriteDeltaPlayerstate(msg_t *msg, struct playerState_s *from, struct pl
 	else
 	{
 		MSG_WriteBits(msg, 0, 1);   // no change to any
-		oldsize += 4;
+		msg->oldsize += 4;
 	}
 
 	// Split this into two groups using shorts so it wouldn't have
@@ -3071,4 +3063,172 @@ void MSG_initHuffman(void)
 			Huff_addRef(&msgHuff.decompressor, (byte)i);  // Do update
 		}
 	}
+
+	// both trees saw the same updates, so one set of tables serves both directions
+	Huff_BuildTable(&msgHuffTable, &msgHuff.decompressor);
+}
+
+/**
+ * @brief Time the tree and table Huffman coders on the messages of a recorded demo
+ *
+ * Every message of a client demo is a snapshot bitstream as it came off the
+ * wire. It is decoded into symbols and encoded again with both coders, and
+ * the results are compared, so this doubles as a check that the tables are
+ * bit-identical to the tree.
+ */
+void MSG_HuffmanBench_f(void)
+{
+	union
+	{
+		byte *b;
+		void *v;
+	} file;
+	static byte out[MAX_MSGLEN * 2], out2[MAX_MSGLEN * 2];
+	int         *msgOfs, *msgLen, *msgSymbols, *symbols, *symbols2;
+	int         fileLen, numMessages, numSymbols, totalBytes, passes, pass, ofs, i, pos, outBits, outBits2;
+	int64_t     t, treeDecode = 0, tableDecode = 0, treeEncode = 0, tableEncode = 0;
+	qboolean    match = qtrue;
+
+	if (Cmd_Argc() < 2)
+	{
+		Com_Printf("usage: huffbench <demofile> [passes]\n");
+		return;
+	}
+
+	passes = Cmd_Argc() > 2 ? Q_atoi(Cmd_Argv(2)) : 10;
+	if (passes < 1)
+	{
+		passes = 1;
+	}
+
+	fileLen = FS_ReadFile(Cmd_Argv(1), &file.v);
+	if (fileLen <= 0 || !file.b)
+	{
+		Com_Printf("huffbench: couldn't read %s\n", Cmd_Argv(1));
+		return;
+	}
+
+	if (!msgInit)
+	{
+		MSG_initHuffman();
+	}
+
+	// index the messages: sequence, length, data, until a length of -1
+	// the symbol arrays take about 64 bytes per demo byte, far too much for the zone
+	msgOfs      = Com_Allocate(sizeof(int) * (fileLen / 8 + 1));
+	msgLen      = Com_Allocate(sizeof(int) * (fileLen / 8 + 1));
+	msgSymbols  = Com_Allocate(sizeof(int) * (fileLen / 8 + 2));
+	symbols     = NULL;
+	symbols2    = NULL;
+	numMessages = 0;
+	if (!msgOfs || !msgLen || !msgSymbols)
+	{
+		Com_Printf("huffbench: out of memory for %s\n", Cmd_Argv(1));
+		goto done;
+	}
+	totalBytes  = 0;
+	for (ofs = 0; ofs + 8 <= fileLen; )
+	{
+		int len = LittleLong(*(int *)(file.b + ofs + 4));
+
+		if (len <= 0 || len > MAX_MSGLEN || ofs + 8 + len > fileLen)
+		{
+			break;
+		}
+		msgOfs[numMessages]   = ofs + 8;
+		msgLen[numMessages++] = len;
+		totalBytes           += len;
+		ofs                  += 8 + len;
+	}
+
+	if (!numMessages)
+	{
+		Com_Printf("huffbench: no messages in %s\n", Cmd_Argv(1));
+		goto done;
+	}
+
+	// at most one symbol per input bit plus the one running past the end
+	symbols  = Com_Allocate(sizeof(int) * ((size_t)totalBytes * 8 + numMessages));
+	symbols2 = Com_Allocate(sizeof(int) * ((size_t)totalBytes * 8 + numMessages));
+	if (!symbols || !symbols2)
+	{
+		Com_Printf("huffbench: out of memory for the %i bytes of messages in %s\n", totalBytes, Cmd_Argv(1));
+		goto done;
+	}
+
+	for (pass = 0; pass < passes; pass++)
+	{
+		int n;
+
+		numSymbols = 0;
+		t          = Sys_Microseconds();
+		for (i = 0; i < numMessages; i++)
+		{
+			msgSymbols[i] = numSymbols;
+			for (pos = 0; pos < msgLen[i] << 3; )
+			{
+				Huff_offsetReceive(msgHuff.decompressor.tree, &symbols[numSymbols++], file.b + msgOfs[i], &pos, msgLen[i] << 3);
+			}
+		}
+		treeDecode           += Sys_Microseconds() - t;
+		msgSymbols[numMessages] = numSymbols;
+
+		n = 0;
+		t = Sys_Microseconds();
+		for (i = 0; i < numMessages; i++)
+		{
+			for (pos = 0; pos < msgLen[i] << 3; )
+			{
+				Huff_tableReceive(&msgHuffTable, &symbols2[n++], file.b + msgOfs[i], &pos, msgLen[i] << 3);
+			}
+		}
+		tableDecode += Sys_Microseconds() - t;
+
+		if (n != numSymbols || memcmp(symbols, symbols2, sizeof(int) * numSymbols))
+		{
+			match = qfalse;
+		}
+
+		// encode message by message, comparing each against the tree's output
+		for (i = 0; i < numMessages; i++)
+		{
+			int j;
+
+			outBits = 0;
+			t       = Sys_Microseconds();
+			for (j = msgSymbols[i]; j < msgSymbols[i + 1]; j++)
+			{
+				Huff_offsetTransmit(&msgHuff.compressor, symbols[j], out, &outBits, sizeof(out) << 3);
+			}
+			treeEncode += Sys_Microseconds() - t;
+
+			outBits2 = 0;
+			t        = Sys_Microseconds();
+			for (j = msgSymbols[i]; j < msgSymbols[i + 1]; j++)
+			{
+				Huff_tableTransmit(&msgHuffTable, symbols[j], out2, &outBits2, sizeof(out2) << 3);
+			}
+			tableEncode += Sys_Microseconds() - t;
+
+			if (outBits != outBits2 || memcmp(out, out2, (outBits + 7) >> 3))
+			{
+				match = qfalse;
+			}
+		}
+	}
+
+	Com_Printf("huffbench: %i messages, %i bytes, %i symbols, %i passes\n", numMessages, totalBytes, numSymbols, passes);
+	Com_Printf("  decode  tree %8.2f ms  table %8.2f ms  (%.2fx)\n", treeDecode / 1000.0, tableDecode / 1000.0,
+	           tableDecode ? (double)treeDecode / tableDecode : 0.0);
+	Com_Printf("  encode  tree %8.2f ms  table %8.2f ms  (%.2fx)\n", treeEncode / 1000.0, tableEncode / 1000.0,
+	           tableEncode ? (double)treeEncode / tableEncode : 0.0);
+	Com_Printf("  output %s\n", match ? "identical" : S_COLOR_RED "DIFFERS");
+
+done:
+	Com_Dealloc(symbols2);
+	Com_Dealloc(symbols);
+	Com_Dealloc(msgSymbols);
+	Com_Dealloc(msgLen);
+	Com_Dealloc(msgOfs);
+	FS_FreeFile(file.v);
 }
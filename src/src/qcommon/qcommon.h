@@ -54,6 +54,8 @@ typedef struct
 	int maxsize;
 	int cursize;
 	int uncompsize;             ///< net debugging
+	int oldsize;                ///< net debugging, bits the written fields take without delta compression
+	int wastedbits;             ///< net debugging, unchanged fields written
 	int readcount;
 	int bit;                    ///< for bitwise reads and writes
 	int strip;                  ///< strip >= 0x80 chars from message, old clients don't like them
@@ -121,6 +123,7 @@ void MSG_WriteDeltaPlayerstate(msg_t *msg, struct playerState_s *from, struct pl
 void MSG_ReadDeltaPlayerstate(msg_t *msg, struct playerState_s *from, struct playerState_s *to);
 
 void MSG_ReportChangeVectors_f(void);
+void MSG_HuffmanBench_f(void);
 
 void MSG_ETTV_WriteDeltaEntityShared(msg_t *msg, entityShared_t *from, entityShared_t *to, qboolean force);
 void MSG_ETTV_ReadDeltaEntityShared(msg_t *msg, entityShared_t *from, entityShared_t *to);
@@ -886,6 +889,9 @@ int FS_Delete(const char *fileName);
 
 int FS_Write(const void *buffer, int len, fileHandle_t h);
 
+// stdio stream of a file opened for writing, for a writer thread that can't go through FS_Write
+FILE *FS_FileForHandle(fileHandle_t f);
+
 int FS_OSStatFile(const char *ospath);
 
 long FS_FileAge(const char *ospath);
@@ -1582,6 +1588,20 @@ typedef struct
 	huff_t decompressor;
 } huffman_t;
 
+#define HUFF_LOOKUP_BITS 11     ///< input bits resolved by one decode table lookup
+
+/**
+ * @struct huffTable_t
+ * @brief Code and decode tables flattened from a tree that no longer changes, see Huff_BuildTable()
+ */
+typedef struct
+{
+	huff_t *huff;                                   ///< tree the tables were built from, for codes the tables don't cover
+	uint32_t code[HMAX + 1];                        ///< code bits in transmit order, first bit lowest
+	byte length[HMAX + 1];                          ///< code length, 0 if the symbol has no code that fits
+	unsigned short lookup[1 << HUFF_LOOKUP_BITS];   ///< symbol | (length << 9) for the next input bits, 0 for longer codes
+} huffTable_t;
+
 void Huff_Compress(msg_t *mbuf, int offset);
 void Huff_Decompress(msg_t *mbuf, int offset);
 void Huff_Init(huffman_t *huff);
@@ -1592,6 +1612,11 @@ void Huff_offsetReceive(node_t *node, int *ch, byte *fin, int *offset, int maxof
 void Huff_offsetTransmit(huff_t *huff, int ch, byte *fout, int *offset, int maxoffset);
 void Huff_putBit(int bit, byte *fout, int *offset);
 int Huff_getBit(byte *fin, int *offset);
+void Huff_putBits(uint32_t value, int bits, byte *fout, int *offset);
+int Huff_getBits(byte *fin, int *offset, int bits);
+void Huff_BuildTable(huffTable_t *table, huff_t *huff);
+void Huff_tableTransmit(const huffTable_t *table, int ch, byte *fout, int *offset, int maxoffset);
+void Huff_tableReceive(const huffTable_t *table, int *ch, byte *fin, int *offset, int maxoffset);
 
 extern huffman_t clientHuffTables;
 
@@ -68,8 +68,7 @@
  */
 typedef struct svEntity_s
 {
-	struct worldSector_s *worldSector;
-	struct svEntity_s *nextEntityInWorldSector;
+	int worldNode;                      ///< leaf in the world tree, 0 if not linked
 
 	entityState_t baseline;             ///< for delta compression of initial sighting
 	entityShared_t baselineShared;
@@ -77,7 +76,6 @@ typedef struct svEntity_s
 	int clusternums[MAX_ENT_CLUSTERS];
 	int lastCluster;                    ///< if all the clusters don't fit in clusternums
 	int areanum, areanum2;
-	int snapshotCounter;                ///< used to prevent double adding from portal views
 	int originCluster;                  ///< calced upon linking, for origin only bmodel vis checks
 } svEntity_t;
 
@@ -104,7 +102,6 @@ typedef struct
 	int checksumFeed;                   ///< the feed key that we use to compute the pure checksum strings
 	/// the serverId associated with the current checksumFeed (always <= serverId)
 	int checksumFeedServerId;
-	int snapshotCounter;                ///< incremented for each snapshot built
 	int timeResidual;                   ///< <= 1000 / sv_frame->value
 	int nextFrameTime;                  ///< when time > nextFrameTime, process world
 	char *configstrings[MAX_CONFIGSTRINGS];
@@ -437,6 +434,16 @@ void SV_DemoStopAll(void);
 void SV_DemoInit(void);
 void SV_DemoSupport(const char *commands);
 
+// sv_demostream.c
+void SV_DemoStreamOpenWrite(fileHandle_t f);
+void SV_DemoStreamWrite(const void *data, int len);
+void SV_DemoStreamEndFrame(void);
+void SV_DemoStreamCloseWrite(void);
+void SV_DemoStreamStats_f(void);
+qboolean SV_DemoStreamOpenRead(fileHandle_t f);
+int SV_DemoStreamRead(void *buffer, int len);
+void SV_DemoStreamCloseRead(void);
+
 // sv_main.c
 void SV_FinalCommand(const char *cmd, qboolean disconnect);   ///< added disconnect flag so map changes can use this function as well
 void QDECL SV_SendServerCommand(client_t *cl, const char *fmt, ...) _attribute((format(printf, 2, 3)));
@@ -524,10 +531,17 @@ void SV_UpdateServerCommandsToClient(client_t *client, msg_t *msg);
 void SV_SendMessageToClient(msg_t *msg, client_t *client, qboolean parseEntities);
 void SV_SendClientMessages(void);
 void SV_SendClientSnapshot(client_t *client);
+void SV_SnapshotVerify_f(void);
 void SV_CheckClientUserinfoTimer(void);
 void SV_SendClientIdle(client_t *client);
 void SV_SnapshotSetClientMask(int clientNum, uint64_t mask);
 
+// sv_jobs.c
+void SV_InitJobs(int numThreads);
+void SV_ShutdownJobs(void);
+int SV_NumJobThreads(void);
+void SV_RunJobs(void (*func)(int index), int numJobs);
+
 #ifdef ETLEGACY_DEBUG
 void SV_PrintNetworkOverhead_f(void);
 void SV_ClearNetworkOverhead_f(void);
@@ -564,6 +578,7 @@ void SV_InitWallhack(void);
 void SV_RestorePos(int cli);
 int SV_CanSee(int player, int other);
 int SV_PositionChanged(int cli);
+void SV_WallhackStats_f(void);
 #endif
 
 //============================================================
@@ -587,6 +602,7 @@ void SV_LinkEntity(sharedEntity_t *gEnt);
 clipHandle_t SV_ClipHandleForEntity(const sharedEntity_t *ent);
 
 void SV_SectorList_f(void);
+void SV_TraceTest_f(void);
 
 int SV_AreaEntities(const vec3_t mins, const vec3_t maxs, int *entityList, int maxcount);
 // fills in a table of entity numbers with entities that have bounding boxes
@@ -599,6 +615,7 @@ int SV_PointContents(const vec3_t p, int passEntityNum);
 // returns the CONTENTS_* value from the world and all entities at the given point.
 
 void SV_Trace(trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, qboolean capsule);
+void SV_ContextTrace(cmTraceContext_t *ctx, trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, qboolean capsule);
 // mins and maxs are relative
 
 // if the entire move stays in a solid volume, trace.allsolid will be set,
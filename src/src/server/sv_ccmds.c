@@ -971,7 +971,12 @@ void SV_AddOperatorCommands(void)
 	Cmd_AddCommand("dumpuser", SV_DumpUser_f, "Dumps user info to disk.");
 	Cmd_AddCommand("map_restart", SV_MapRestart_f, "Restarts given map.");
 	Cmd_AddCommand("fieldinfo", SV_FieldInfo_f, "Prints field info.");
-	Cmd_AddCommand("sectorlist", SV_SectorList_f, "Prints sector list.");
+	Cmd_AddCommand("sectorlist", SV_SectorList_f, "Prints world tree occupancy and query cost.");
+	Cmd_AddCommand("tracetest", SV_TraceTest_f, "Compares threaded traces against serial ones on the loaded map.");
+	Cmd_AddCommand("snapshotverify", SV_SnapshotVerify_f, "Prints how many threaded snapshots sv_snapshotVerify compared.");
+#ifdef FEATURE_ANTICHEAT
+	Cmd_AddCommand("whstats", SV_WallhackStats_f, "Prints the traces the wallhack visibility cache saved.");
+#endif
 	Cmd_AddCommand("gameCompleteStatus", SV_GameCompleteStatus_f, "Sends a game complete status message to all master servers.");
 	Cmd_AddCommand("map", SV_Map_f, "Loads a specific map.", SV_CompleteMapName);
 	Cmd_AddCommand("devmap", SV_Map_f, "Loads a specific map in developer mode.", SV_CompleteMapName);
@@ -1027,6 +1032,11 @@ void SV_RemoveOperatorCommands(void)
 	Cmd_RemoveCommand("dumpuser");
 	Cmd_RemoveCommand("map_restart");
 	Cmd_RemoveCommand("sectorlist");
+	Cmd_RemoveCommand("tracetest");
+	Cmd_RemoveCommand("snapshotverify");
+#ifdef FEATURE_ANTICHEAT
+	Cmd_RemoveCommand("whstats");
+#endif
 	Cmd_RemoveCommand("say");
 #endif
 }
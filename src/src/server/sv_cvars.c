@@ -48,6 +48,8 @@ cvar_t *sv_reconnectlimit;      // minimum seconds between connect messages
 cvar_t *sv_tempbanmessage;
 
 cvar_t *sv_padPackets;          // add nop bytes to messages
+cvar_t *sv_snapshotThreads;     // worker threads building client snapshots, 0 = main thread only
+cvar_t *sv_snapshotVerify;      // encode threaded snapshots again the serial way and compare
 cvar_t *sv_killserver;          // menu system can set to 1 to shut server down
 cvar_t *sv_mapname;
 cvar_t *sv_mapChecksum;
@@ -110,6 +112,8 @@ cvar_t *sv_demoState;
 cvar_t *sv_autoDemo;
 cvar_t *sv_freezeDemo;  // to freeze server-side demos
 cvar_t *sv_demoTolerant;
+cvar_t *sv_demoCompress;    // deflate level of recorded demos, 0 = off
+cvar_t *sv_demoWriteBuffer; // KB queued for the demo writer thread
 
 cvar_t *sv_ipMaxClients;
 
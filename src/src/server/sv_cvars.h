@@ -62,6 +62,8 @@ extern cvar_t *sv_reconnectlimit;
 extern cvar_t *sv_tempbanmessage;
 
 extern cvar_t *sv_padPackets;
+extern cvar_t *sv_snapshotThreads;
+extern cvar_t *sv_snapshotVerify;
 extern cvar_t *sv_killserver;
 extern cvar_t *sv_mapname;
 extern cvar_t *sv_mapChecksum;
@@ -116,6 +118,8 @@ extern cvar_t *sv_demoState;
 extern cvar_t *sv_autoDemo;
 extern cvar_t *sv_freezeDemo;
 extern cvar_t *sv_demoTolerant;
+extern cvar_t *sv_demoCompress;
+extern cvar_t *sv_demoWriteBuffer;
 
 extern cvar_t *sv_ipMaxClients; ///< limit client connection
 
@@ -442,8 +442,8 @@ static void SV_DemoWriteMessage(msg_t *msg)
 	// and that it can proceed to the next message
 	MSG_WriteByte(msg, demo_EOF);
 	len = LittleLong(msg->cursize);
-	(void) FS_Write(&len, 4, sv.demoFile);
-	(void) FS_Write(msg->data, msg->cursize, sv.demoFile);
+	SV_DemoStreamWrite(&len, 4);
+	SV_DemoStreamWrite(msg->data, msg->cursize);
 	MSG_Clear(msg);
 }
 
@@ -861,6 +861,9 @@ void SV_DemoWriteFrame(void)
 
 	// commit data to the demo file
 	SV_DemoWriteMessage(&msg);
+
+	// let the writer thread have this frame
+	SV_DemoStreamEndFrame();
 }
 
 /***********************************************
@@ -1021,6 +1024,7 @@ static void SV_DemoStopPlayback(const char *message)
 	client_t *client;
 	int      i;
 
+	SV_DemoStreamCloseRead();
 	FS_FCloseFile(sv.demoFile);
 
 	Com_Printf("%s (%s)\n", message, sv.demoName);
@@ -1103,7 +1107,7 @@ static void SV_DemoStartPlayback(void)
 	MSG_Init(&msg, buf, sizeof(buf));
 
 	// get the demo header
-	r = FS_Read(&msg.cursize, 4, sv.demoFile);
+	r = SV_DemoStreamRead(&msg.cursize, 4);
 	if (r != 4)
 	{
 		SV_DemoPlaybackError("DEMOERROR: SV_DemoReadFrame: demo is corrupted (not initialized correctly!)");
@@ -1119,7 +1123,7 @@ static void SV_DemoStartPlayback(void)
 		SV_DemoPlaybackError("DEMOERROR: SV_DemoReadFrame: demo message too long");
 	}
 
-	r = FS_Read(msg.data, msg.cursize, sv.demoFile);
+	r = SV_DemoStreamRead(msg.data, msg.cursize);
 	if (r != msg.cursize)
 	{
 		SV_DemoPlaybackError("DEMOERROR: Demo file was truncated.\n");
@@ -1380,7 +1384,8 @@ static void SV_DemoStopRecord(void)
 	MSG_WriteByte(&msg, demo_endDemo);
 	SV_DemoWriteMessage(&msg); // this also writes demo_EOF
 
-	// close the file (else it won't be openable until the server is closed)
+	// wait for the writer, then close the file (else it won't be openable until the server is closed)
+	SV_DemoStreamCloseWrite();
 	FS_FCloseFile(sv.demoFile);
 	// change recording state
 	sv.demoState = DS_NONE;
@@ -1899,7 +1904,7 @@ read_next_demo_event: // used to read next demo event
 		MSG_BeginReading(&msg);
 
 		// get a message
-		r = FS_Read(&msg.cursize, 4, sv.demoFile);
+		r = SV_DemoStreamRead(&msg.cursize, 4);
 
 		if (r != 4)
 		{
@@ -1914,7 +1919,7 @@ read_next_demo_event: // used to read next demo event
 
 		// fetch the demo message (using the length we got) from the demo file sv.demoFile, and store it into msg.data
 		// (will be accessed automatically by MSG_thing() functions), and store in r the length of the data returned (used to check that it's correct)
-		r = FS_Read(msg.data, msg.cursize, sv.demoFile);
+		r = SV_DemoStreamRead(msg.data, msg.cursize);
 
 		// if the returned length of the read demo message is not the same as the length we expected
 		// (the one that was stored just prior to the demo message),
@@ -2138,6 +2143,7 @@ static void SV_Demo_Record_f(void)
 		return;
 	}
 
+	SV_DemoStreamOpenWrite(sv.demoFile);
 	SV_DemoStartRecord();
 }
 
@@ -2178,6 +2184,13 @@ static void SV_Demo_Play_f(void)
 		return;
 	}
 
+	if (!SV_DemoStreamOpenRead(sv.demoFile))
+	{
+		FS_FCloseFile(sv.demoFile);
+		Com_Printf("ERROR: Couldn't decompress %s.\n", sv.demoName);
+		return;
+	}
+
 	SV_DemoStartPlayback();
 }
 
@@ -2350,6 +2363,7 @@ void SV_DemoInit(void)
 	Cmd_AddCommand("demo_autoplay", SV_Demo_AutoPlay_f, va("Plays demos from a folder. (Max %i)", MAX_DEMO_AUTOPLAY));
 	Cmd_AddCommand("demo_stop", SV_Demo_Stop_f, "Stops a demo record.");
 	Cmd_AddCommand("demo_ff", SV_Demo_Fastforward_f, "Fast-forwards a demo record.");
+	Cmd_AddCommand("demo_stats", SV_DemoStreamStats_f, "Prints frame sizes and writer queue stats of the demo being recorded.");
 }
 
 /**
@@ -0,0 +1,621 @@
+/*
+ * ET: Legacy
+ * Copyright (C) 2012-2024 ET:Legacy team <mail@etlegacy.com>
+ *
+ * This file is part of ET: Legacy - http://www.etlegacy.com
+ *
+ * ET: Legacy is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ET: Legacy is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ET: Legacy. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file sv_demostream.c
+ * @brief Byte stream under server-side demo files
+ *
+ * Recording: the main thread copies the framed demo messages into a ring
+ * buffer (sv_demoWriteBuffer KB) and a writer thread puts them on disk, so
+ * a slow disk no longer stalls the server frame. Only a full ring makes the
+ * main thread wait. With sv_demoCompress 1-9 the writer deflates the stream
+ * at that level into a gzip file, which keeps the .svdm extension.
+ *
+ * Playback: a gzip header at the start of the file is recognized and the
+ * stream is inflated on the fly, plain demos are read as they are.
+ *
+ * Either way the bytes of the stream are exactly the ones SV_DemoReadFrame()
+ * always read: a little endian length followed by the message.
+ */
+
+#include "server.h"
+#include "zlib.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#define DEMO_STREAM_CHUNK       0x10000 ///< file read / deflate output size
+#define DEMO_STREAM_MIN_BUFFER  256     ///< KB
+#define DEMO_STREAM_MAX_BUFFER  65536   ///< KB
+
+/**
+ * @struct demoWriter_t
+ * @brief
+ */
+typedef struct
+{
+#ifdef _WIN32
+	HANDLE thread;
+	CRITICAL_SECTION lock;
+	CONDITION_VARIABLE wake;            ///< data was queued or the file is closing
+	CONDITION_VARIABLE drained;         ///< the writer freed ring space
+#else
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t wake;
+	pthread_cond_t drained;
+#endif
+	qboolean threaded;                  ///< qfalse writes on the main thread
+
+	FILE *file;
+	byte *ring;
+	int size;
+
+	// guarded by lock
+	int64_t head;                       ///< bytes queued, only the main thread moves it
+	int64_t tail;                       ///< bytes written, only the writer moves it
+	qboolean quit;
+	qboolean failed;                    ///< a write failed, the rest is discarded
+
+	// writer only
+	qboolean compress;
+	z_stream zs;
+	byte out[DEMO_STREAM_CHUNK];
+
+	// stats, main thread
+	int64_t queuedBytes;
+	int frames;
+	int frameBytes;                     ///< queued since the last end of frame
+	int maxFrameBytes;
+	int64_t maxDepth;
+	int stalls;                         ///< times the main thread waited for ring space
+	int stallMsec;
+
+	// stats, guarded by lock
+	int64_t fileBytes;
+	int writeMsec;
+} demoWriter_t;
+
+/**
+ * @struct demoReader_t
+ * @brief
+ */
+typedef struct
+{
+	fileHandle_t file;
+	qboolean compressed;
+	z_stream zs;
+	byte in[DEMO_STREAM_CHUNK];
+} demoReader_t;
+
+static demoWriter_t sv_demoWriter;
+static demoReader_t sv_demoReader;
+
+#ifdef _WIN32
+#define SV_DemoWriterLock()       EnterCriticalSection(&sv_demoWriter.lock)
+#define SV_DemoWriterUnlock()     LeaveCriticalSection(&sv_demoWriter.lock)
+#define SV_DemoWriterWait(cond)   SleepConditionVariableCS(&sv_demoWriter.cond, &sv_demoWriter.lock, INFINITE)
+#define SV_DemoWriterSignal(cond) WakeAllConditionVariable(&sv_demoWriter.cond)
+#else
+#define SV_DemoWriterLock()       pthread_mutex_lock(&sv_demoWriter.lock)
+#define SV_DemoWriterUnlock()     pthread_mutex_unlock(&sv_demoWriter.lock)
+#define SV_DemoWriterWait(cond)   pthread_cond_wait(&sv_demoWriter.cond, &sv_demoWriter.lock)
+#define SV_DemoWriterSignal(cond) pthread_cond_broadcast(&sv_demoWriter.cond)
+#endif
+
+/***********************************************
+ * WRITING
+ ***********************************************/
+
+/**
+ * @brief Put bytes on disk, deflating them first if asked to
+ *
+ * Runs on the writer thread, or on the main thread without one.
+ *
+ * @param[in] data
+ * @param[in] len
+ * @param[in] finish Flush the deflate stream, data may be NULL
+ * @return qfalse if the file couldn't be written
+ */
+static qboolean SV_DemoWriterOutput(const byte *data, int len, qboolean finish)
+{
+	int written = 0;
+	int start   = Sys_Milliseconds();
+
+	if (!sv_demoWriter.compress)
+	{
+		written = len ? (int)fwrite(data, 1, len, sv_demoWriter.file) : 0;
+		if (finish)
+		{
+			fflush(sv_demoWriter.file);
+		}
+	}
+	else
+	{
+		int ret, have;
+
+		sv_demoWriter.zs.next_in  = (Bytef *)data;
+		sv_demoWriter.zs.avail_in = len;
+		do
+		{
+			sv_demoWriter.zs.next_out  = sv_demoWriter.out;
+			sv_demoWriter.zs.avail_out = sizeof(sv_demoWriter.out);
+
+			ret = deflate(&sv_demoWriter.zs, finish ? Z_FINISH : Z_NO_FLUSH);
+			if (ret == Z_STREAM_ERROR)
+			{
+				return qfalse;
+			}
+
+			have = sizeof(sv_demoWriter.out) - sv_demoWriter.zs.avail_out;
+			if (have && (int)fwrite(sv_demoWriter.out, 1, have, sv_demoWriter.file) != have)
+			{
+				return qfalse;
+			}
+			written += have;
+		}
+		while (sv_demoWriter.zs.avail_out == 0 || (finish && ret != Z_STREAM_END));
+
+		if (finish)
+		{
+			fflush(sv_demoWriter.file);
+		}
+		len = written;
+	}
+
+	if (sv_demoWriter.threaded)
+	{
+		SV_DemoWriterLock();
+	}
+	sv_demoWriter.fileBytes += written;
+	sv_demoWriter.writeMsec += Sys_Milliseconds() - start;
+	if (sv_demoWriter.threaded)
+	{
+		SV_DemoWriterUnlock();
+	}
+
+	return written == len;
+}
+
+/**
+ * @brief SV_DemoWriterThread
+ */
+static void SV_DemoWriterThread(void)
+{
+	int64_t  head, tail;
+	int      offset, len;
+	qboolean ok;
+
+	SV_DemoWriterLock();
+	for (;;)
+	{
+		if (sv_demoWriter.tail == sv_demoWriter.head)
+		{
+			if (sv_demoWriter.quit)
+			{
+				break;
+			}
+			SV_DemoWriterWait(wake);
+			continue;
+		}
+
+		head = sv_demoWriter.head;
+		tail = sv_demoWriter.tail;
+		SV_DemoWriterUnlock();
+
+		// the queued bytes, at most up to the end of the ring
+		offset = (int)(tail % sv_demoWriter.size);
+		len    = (int)MIN(head - tail, (int64_t)(sv_demoWriter.size - offset));
+		ok     = sv_demoWriter.failed || SV_DemoWriterOutput(sv_demoWriter.ring + offset, len, qfalse);
+
+		SV_DemoWriterLock();
+		if (!ok)
+		{
+			sv_demoWriter.failed = qtrue;
+		}
+		sv_demoWriter.tail += len;
+		SV_DemoWriterSignal(drained);
+	}
+	SV_DemoWriterUnlock();
+}
+
+#ifdef _WIN32
+/**
+ * @brief SV_DemoWriterThreadProc
+ * @param dummy - unused
+ * @return
+ */
+static DWORD WINAPI SV_DemoWriterThreadProc(LPVOID dummy)
+{
+	SV_DemoWriterThread();
+	return 0;
+}
+#else
+/**
+ * @brief SV_DemoWriterThreadProc
+ * @param dummy - unused
+ * @return
+ */
+static void *SV_DemoWriterThreadProc(void *dummy)
+{
+	SV_DemoWriterThread();
+	return NULL;
+}
+#endif
+
+/**
+ * @brief Start writing a demo file opened with FS_FOpenFileWrite()
+ *
+ * The handle must stay open until SV_DemoStreamCloseWrite().
+ *
+ * @param[in] f
+ */
+void SV_DemoStreamOpenWrite(fileHandle_t f)
+{
+	int level = sv_demoCompress->integer;
+	int size  = sv_demoWriteBuffer->integer;
+
+	Com_Memset(&sv_demoWriter, 0, sizeof(sv_demoWriter));
+	sv_demoWriter.file = FS_FileForHandle(f);
+
+	if (level > 0)
+	{
+		// windowBits + 16 writes a gzip header, so the file can also be gunzipped
+		if (deflateInit2(&sv_demoWriter.zs, MIN(level, 9), Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK)
+		{
+			sv_demoWriter.compress = qtrue;
+		}
+		else
+		{
+			Com_Printf(S_COLOR_YELLOW "WARNING: DEMO: can't initialize compression, recording uncompressed\n");
+		}
+	}
+
+	size               = size < DEMO_STREAM_MIN_BUFFER ? DEMO_STREAM_MIN_BUFFER : MIN(size, DEMO_STREAM_MAX_BUFFER);
+	sv_demoWriter.size = size * 1024;
+	// up to DEMO_STREAM_MAX_BUFFER, too much for the zone
+	sv_demoWriter.ring = Com_Allocate(sv_demoWriter.size);
+	if (!sv_demoWriter.ring)
+	{
+		Com_Printf(S_COLOR_YELLOW "WARNING: DEMO: can't allocate a %i KB write buffer, writing on the main thread\n", size);
+		return;
+	}
+
+#ifdef _WIN32
+	InitializeCriticalSection(&sv_demoWriter.lock);
+	InitializeConditionVariable(&sv_demoWriter.wake);
+	InitializeConditionVariable(&sv_demoWriter.drained);
+
+	sv_demoWriter.thread   = CreateThread(NULL, 0, SV_DemoWriterThreadProc, NULL, 0, NULL);
+	sv_demoWriter.threaded = sv_demoWriter.thread != NULL;
+	if (!sv_demoWriter.threaded)
+	{
+		DeleteCriticalSection(&sv_demoWriter.lock);
+	}
+#else
+	pthread_mutex_init(&sv_demoWriter.lock, NULL);
+	pthread_cond_init(&sv_demoWriter.wake, NULL);
+	pthread_cond_init(&sv_demoWriter.drained, NULL);
+
+	sv_demoWriter.threaded = pthread_create(&sv_demoWriter.thread, NULL, SV_DemoWriterThreadProc, NULL) == 0;
+	if (!sv_demoWriter.threaded)
+	{
+		pthread_cond_destroy(&sv_demoWriter.drained);
+		pthread_cond_destroy(&sv_demoWriter.wake);
+		pthread_mutex_destroy(&sv_demoWriter.lock);
+	}
+#endif
+
+	if (!sv_demoWriter.threaded)
+	{
+		Com_Printf(S_COLOR_YELLOW "WARNING: DEMO: can't start the writer thread, writing on the main thread\n");
+	}
+}
+
+/**
+ * @brief Queue bytes for the demo file
+ *
+ * Waits only when the ring buffer is full.
+ *
+ * @param[in] data
+ * @param[in] len
+ */
+void SV_DemoStreamWrite(const void *data, int len)
+{
+	const byte *in = (const byte *)data;
+
+	if (!sv_demoWriter.file)
+	{
+		return;
+	}
+
+	sv_demoWriter.frameBytes  += len;
+	sv_demoWriter.queuedBytes += len;
+
+	if (!sv_demoWriter.threaded)
+	{
+		if (!sv_demoWriter.failed && !SV_DemoWriterOutput(in, len, qfalse))
+		{
+			sv_demoWriter.failed = qtrue;
+		}
+		return;
+	}
+
+	while (len > 0)
+	{
+		int64_t head, space;
+		int     offset, chunk;
+
+		SV_DemoWriterLock();
+		head  = sv_demoWriter.head;
+		space = sv_demoWriter.size - (head - sv_demoWriter.tail);
+		if (!space)
+		{
+			int start = Sys_Milliseconds();
+
+			sv_demoWriter.stalls++;
+			SV_DemoWriterSignal(wake); // it may be asleep waiting for the end of the frame
+			while (sv_demoWriter.head - sv_demoWriter.tail == sv_demoWriter.size)
+			{
+				SV_DemoWriterWait(drained);
+			}
+			sv_demoWriter.stallMsec += Sys_Milliseconds() - start;
+			space = sv_demoWriter.size - (head - sv_demoWriter.tail);
+		}
+		SV_DemoWriterUnlock();
+
+		// [head, head + space) belongs to us until head is moved
+		offset = (int)(head % sv_demoWriter.size);
+		chunk  = (int)MIN((int64_t)len, MIN(space, (int64_t)(sv_demoWriter.size - offset)));
+		Com_Memcpy(sv_demoWriter.ring + offset, in, chunk);
+		in  += chunk;
+		len -= chunk;
+
+		SV_DemoWriterLock();
+		sv_demoWriter.head += chunk;
+		if (sv_demoWriter.head - sv_demoWriter.tail > sv_demoWriter.maxDepth)
+		{
+			sv_demoWriter.maxDepth = sv_demoWriter.head - sv_demoWriter.tail;
+		}
+		SV_DemoWriterUnlock();
+	}
+}
+
+/**
+ * @brief Hand the bytes of this server frame to the writer
+ */
+void SV_DemoStreamEndFrame(void)
+{
+	if (!sv_demoWriter.file)
+	{
+		return;
+	}
+
+	sv_demoWriter.frames++;
+	if (sv_demoWriter.frameBytes > sv_demoWriter.maxFrameBytes)
+	{
+		sv_demoWriter.maxFrameBytes = sv_demoWriter.frameBytes;
+	}
+	sv_demoWriter.frameBytes = 0;
+
+	if (sv_demoWriter.threaded)
+	{
+		SV_DemoWriterLock();
+		SV_DemoWriterSignal(wake);
+		SV_DemoWriterUnlock();
+	}
+}
+
+/**
+ * @brief Write out everything that is queued and stop the writer
+ *
+ * The caller closes the file handle afterwards.
+ */
+void SV_DemoStreamCloseWrite(void)
+{
+	if (!sv_demoWriter.file)
+	{
+		return;
+	}
+
+	if (sv_demoWriter.threaded)
+	{
+		SV_DemoWriterLock();
+		sv_demoWriter.quit = qtrue;
+		SV_DemoWriterSignal(wake);
+		SV_DemoWriterUnlock();
+
+#ifdef _WIN32
+		WaitForSingleObject(sv_demoWriter.thread, INFINITE);
+		CloseHandle(sv_demoWriter.thread);
+		DeleteCriticalSection(&sv_demoWriter.lock);
+#else
+		pthread_join(sv_demoWriter.thread, NULL);
+		pthread_cond_destroy(&sv_demoWriter.drained);
+		pthread_cond_destroy(&sv_demoWriter.wake);
+		pthread_mutex_destroy(&sv_demoWriter.lock);
+#endif
+		sv_demoWriter.threaded = qfalse;
+	}
+
+	// the thread is gone, the rest runs on the main thread
+	if (!sv_demoWriter.failed && !SV_DemoWriterOutput(NULL, 0, qtrue))
+	{
+		sv_demoWriter.failed = qtrue;
+	}
+	if (sv_demoWriter.failed)
+	{
+		Com_Printf(S_COLOR_RED "DEMO: ERROR: writing %s failed, the demo is incomplete\n", sv.demoName);
+	}
+
+	if (sv_demoWriter.compress)
+	{
+		deflateEnd(&sv_demoWriter.zs);
+	}
+	Com_Dealloc(sv_demoWriter.ring);
+
+	sv_demoWriter.file = NULL;
+	sv_demoWriter.ring = NULL;
+}
+
+/**
+ * @brief Print the stats of the demo being recorded
+ */
+void SV_DemoStreamStats_f(void)
+{
+	int64_t depth, fileBytes;
+	int     writeMsec;
+
+	if (!sv_demoWriter.file)
+	{
+		Com_Printf("No server-side demo is being recorded.\n");
+		return;
+	}
+
+	if (sv_demoWriter.threaded)
+	{
+		SV_DemoWriterLock();
+	}
+	depth     = sv_demoWriter.head - sv_demoWriter.tail;
+	fileBytes = sv_demoWriter.fileBytes;
+	writeMsec = sv_demoWriter.writeMsec;
+	if (sv_demoWriter.threaded)
+	{
+		SV_DemoWriterUnlock();
+	}
+
+	Com_Printf("=========================\n");
+	Com_Printf("demo:               %s\n", sv.demoName);
+	Com_Printf("writer:             %s, %s\n", sv_demoWriter.threaded ? "thread" : "main thread",
+	           sv_demoWriter.compress ? va("deflate level %i", MIN(sv_demoCompress->integer, 9)) : "uncompressed");
+	Com_Printf("frames:             %i\n", sv_demoWriter.frames);
+	Com_Printf("average frame size: %.2f bytes\n", sv_demoWriter.frames ? (double)sv_demoWriter.queuedBytes / sv_demoWriter.frames : 0.0);
+	Com_Printf("max frame size:     %i bytes\n", sv_demoWriter.maxFrameBytes);
+	Com_Printf("queue depth:        %i KB (max %i KB of %i KB)\n", (int)(depth / 1024), (int)(sv_demoWriter.maxDepth / 1024), sv_demoWriter.size / 1024);
+	Com_Printf("stalls:             %i (%i msec)\n", sv_demoWriter.stalls, sv_demoWriter.stallMsec);
+	Com_Printf("written:            %i KB in %i msec\n", (int)(fileBytes / 1024), writeMsec);
+	if (sv_demoWriter.compress && fileBytes > 0)
+	{
+		Com_Printf("compression:        %.2fx\n", (double)(sv_demoWriter.queuedBytes - depth) / fileBytes);
+	}
+	Com_Printf("=========================\n");
+}
+
+/***********************************************
+ * READING
+ ***********************************************/
+
+/**
+ * @brief Start reading a demo file, compressed or not
+ * @param[in] f
+ * @return qfalse if a compressed demo can't be decoded
+ */
+qboolean SV_DemoStreamOpenRead(fileHandle_t f)
+{
+	int len;
+
+	Com_Memset(&sv_demoReader.zs, 0, sizeof(sv_demoReader.zs));
+	sv_demoReader.file       = f;
+	sv_demoReader.compressed = qfalse;
+
+	// a plain demo starts with the length of the header message, which is far below 0x8b1f
+	len = FS_Read(sv_demoReader.in, 2, f);
+	if (len == 2 && sv_demoReader.in[0] == 0x1f && sv_demoReader.in[1] == 0x8b)
+	{
+		if (inflateInit2(&sv_demoReader.zs, MAX_WBITS + 16) != Z_OK)
+		{
+			return qfalse;
+		}
+		sv_demoReader.compressed = qtrue;
+	}
+
+	// the bytes we peeked at are handed out first
+	sv_demoReader.zs.next_in  = sv_demoReader.in;
+	sv_demoReader.zs.avail_in = MAX(len, 0);
+
+	return qtrue;
+}
+
+/**
+ * @brief Read from the demo file
+ * @param[out] buffer
+ * @param[in] len
+ * @return Bytes read, less than len at the end of the file
+ */
+int SV_DemoStreamRead(void *buffer, int len)
+{
+	int ret, done = 0;
+
+	if (!sv_demoReader.compressed)
+	{
+		if (sv_demoReader.zs.avail_in)
+		{
+			done = MIN(len, (int)sv_demoReader.zs.avail_in);
+			Com_Memcpy(buffer, sv_demoReader.zs.next_in, done);
+			sv_demoReader.zs.next_in  += done;
+			sv_demoReader.zs.avail_in -= done;
+		}
+		return done + (len > done ? FS_Read((byte *)buffer + done, len - done, sv_demoReader.file) : 0);
+	}
+
+	sv_demoReader.zs.next_out  = (Bytef *)buffer;
+	sv_demoReader.zs.avail_out = len;
+
+	while (sv_demoReader.zs.avail_out)
+	{
+		if (!sv_demoReader.zs.avail_in)
+		{
+			int r = FS_Read(sv_demoReader.in, sizeof(sv_demoReader.in), sv_demoReader.file);
+
+			if (r <= 0)
+			{
+				break;
+			}
+			sv_demoReader.zs.next_in  = sv_demoReader.in;
+			sv_demoReader.zs.avail_in = r;
+		}
+
+		ret = inflate(&sv_demoReader.zs, Z_NO_FLUSH);
+		if (ret != Z_OK)
+		{
+			break;  // end of stream or corrupted, the caller sees a short read
+		}
+	}
+
+	return len - (int)sv_demoReader.zs.avail_out;
+}
+
+/**
+ * @brief Stop reading
+ *
+ * The caller closes the file handle.
+ */
+void SV_DemoStreamCloseRead(void)
+{
+	if (sv_demoReader.compressed)
+	{
+		inflateEnd(&sv_demoReader.zs);
+	}
+	Com_Memset(&sv_demoReader.zs, 0, sizeof(sv_demoReader.zs));
+	sv_demoReader.file       = 0;
+	sv_demoReader.compressed = qfalse;
+}
@@ -1221,6 +1221,9 @@ void SV_Init(void)
 
 	sv_lanForceRate = Cvar_Get("sv_lanForceRate", "1", CVAR_ARCHIVE_ND);
 
+	sv_snapshotThreads = Cvar_GetAndDescribe("sv_snapshotThreads", "0", CVAR_ARCHIVE_ND, "Number of worker threads that build and encode client snapshots, 0 builds them on the main thread.");
+	sv_snapshotVerify  = Cvar_GetAndDescribe("sv_snapshotVerify", "0", CVAR_TEMP, "Builds every threaded snapshot again the serial way and logs packets that differ, see snapshotverify.");
+
 	sv_onlyVisibleClients = Cvar_Get("sv_onlyVisibleClients", "0", 0);
 
 	sv_showAverageBPS = Cvar_Get("sv_showAverageBPS", "0", 0); // net debugging
@@ -1273,6 +1276,8 @@ void SV_Init(void)
 	sv_freezeDemo   = Cvar_Get("cl_freezeDemo", "0", CVAR_TEMP); // port from client-side to freeze server-side demos
 	sv_demoTolerant = Cvar_Get("sv_demoTolerant", "0", CVAR_ARCHIVE);
 	sv_demopath     = Cvar_Get("sv_demopath", "", CVAR_ARCHIVE);
+	sv_demoCompress    = Cvar_GetAndDescribe("sv_demoCompress", "0", CVAR_ARCHIVE_ND, "Deflate level 1-9 of recorded server-side demos (gzip inside the .svdm file), 0 records them uncompressed.");
+	sv_demoWriteBuffer = Cvar_GetAndDescribe("sv_demoWriteBuffer", "4096", CVAR_ARCHIVE_ND, "KB of demo data the recording can get ahead of the demo writer thread.");
 
 	// init the botlib here because we need the pre-compiler in the UI
 	SV_BotInitBotLib();
@@ -1384,6 +1389,8 @@ void SV_Shutdown(const char *finalmsg)
 	SV_RemoveOperatorCommands();
 	SV_MasterShutdown();
 	SV_ShutdownGameProgs();
+	SV_ShutdownJobs();
+	sv_snapshotThreads->modified = qtrue; // start the pool again with the next server
 
 	// SV_ShutdownGameProgs calls SV_DemoStopAll();
 
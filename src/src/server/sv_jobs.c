@@ -0,0 +1,300 @@
+/*
+ * ET: Legacy
+ * Copyright (C) 2012-2024 ET:Legacy team <mail@etlegacy.com>
+ *
+ * This file is part of ET: Legacy - http://www.etlegacy.com
+ *
+ * ET: Legacy is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ET: Legacy is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ET: Legacy. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file sv_jobs.c
+ * @brief Small worker pool for data-parallel server work
+ *
+ * SV_RunJobs() hands out the indices of a batch one by one to the worker
+ * threads and to the calling thread, and returns once all of them are done.
+ * The batch function must not call back into the game VM, print or raise
+ * Com_Error(); anything like that has to be left for the main thread.
+ *
+ * The pool is sized by sv_snapshotThreads and rebuilt when it changes.
+ */
+
+#include "server.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#define SV_MAX_JOB_THREADS 16
+
+/**
+ * @struct svJobPool_t
+ * @brief
+ */
+typedef struct
+{
+#ifdef _WIN32
+	HANDLE threads[SV_MAX_JOB_THREADS];
+	CRITICAL_SECTION lock;
+	CONDITION_VARIABLE wake;            ///< a batch was posted or the pool is shutting down
+	CONDITION_VARIABLE done;            ///< the last index of the batch finished
+#else
+	pthread_t threads[SV_MAX_JOB_THREADS];
+	pthread_mutex_t lock;
+	pthread_cond_t wake;
+	pthread_cond_t done;
+#endif
+	qboolean initialized;               ///< lock and condition variables exist
+	int numThreads;
+
+	// current batch, guarded by lock
+	void (*func)(int index);
+	int numJobs;
+	int nextJob;
+	int finishedJobs;
+	int batch;                          ///< bumped for each batch so sleeping workers notice it
+	qboolean quit;
+} svJobPool_t;
+
+static svJobPool_t sv_jobs;
+
+#ifdef _WIN32
+#define SV_JobsLock()       EnterCriticalSection(&sv_jobs.lock)
+#define SV_JobsUnlock()     LeaveCriticalSection(&sv_jobs.lock)
+#define SV_JobsWait(cond)   SleepConditionVariableCS(&sv_jobs.cond, &sv_jobs.lock, INFINITE)
+#define SV_JobsSignal(cond) WakeAllConditionVariable(&sv_jobs.cond)
+#else
+#define SV_JobsLock()       pthread_mutex_lock(&sv_jobs.lock)
+#define SV_JobsUnlock()     pthread_mutex_unlock(&sv_jobs.lock)
+#define SV_JobsWait(cond)   pthread_cond_wait(&sv_jobs.cond, &sv_jobs.lock)
+#define SV_JobsSignal(cond) pthread_cond_broadcast(&sv_jobs.cond)
+#endif
+
+/**
+ * @brief Run indices of the current batch until there are none left
+ *
+ * @note Called and returns with the lock held
+ */
+static void SV_JobsWork(void)
+{
+	while (sv_jobs.nextJob < sv_jobs.numJobs)
+	{
+		int index = sv_jobs.nextJob++;
+
+		SV_JobsUnlock();
+		sv_jobs.func(index);
+		SV_JobsLock();
+
+		if (++sv_jobs.finishedJobs == sv_jobs.numJobs)
+		{
+			SV_JobsSignal(done);
+		}
+	}
+}
+
+/**
+ * @brief SV_JobsThread
+ */
+static void SV_JobsThread(void)
+{
+	int batch = 0;
+
+	SV_JobsLock();
+	while (!sv_jobs.quit)
+	{
+		if (sv_jobs.batch == batch)
+		{
+			SV_JobsWait(wake);
+			continue;
+		}
+
+		batch = sv_jobs.batch;
+		SV_JobsWork();
+	}
+	SV_JobsUnlock();
+}
+
+#ifdef _WIN32
+/**
+ * @brief SV_JobsThreadProc
+ * @param dummy - unused
+ * @return
+ */
+static DWORD WINAPI SV_JobsThreadProc(LPVOID dummy)
+{
+	SV_JobsThread();
+	return 0;
+}
+#else
+/**
+ * @brief SV_JobsThreadProc
+ * @param dummy - unused
+ * @return
+ */
+static void *SV_JobsThreadProc(void *dummy)
+{
+	SV_JobsThread();
+	return NULL;
+}
+#endif
+
+/**
+ * @brief Start the worker threads
+ * @param[in] numThreads Workers besides the main thread, 0 disables the pool
+ */
+void SV_InitJobs(int numThreads)
+{
+	int i;
+
+	SV_ShutdownJobs();
+
+	if (numThreads <= 0)
+	{
+		return;
+	}
+	if (numThreads > SV_MAX_JOB_THREADS)
+	{
+		numThreads = SV_MAX_JOB_THREADS;
+	}
+
+	Com_Memset(&sv_jobs, 0, sizeof(sv_jobs));
+
+#ifdef _WIN32
+	InitializeCriticalSection(&sv_jobs.lock);
+	InitializeConditionVariable(&sv_jobs.wake);
+	InitializeConditionVariable(&sv_jobs.done);
+#else
+	pthread_mutex_init(&sv_jobs.lock, NULL);
+	pthread_cond_init(&sv_jobs.wake, NULL);
+	pthread_cond_init(&sv_jobs.done, NULL);
+#endif
+	sv_jobs.initialized = qtrue;
+
+	for (i = 0; i < numThreads; i++)
+	{
+#ifdef _WIN32
+		sv_jobs.threads[i] = CreateThread(NULL, 0, SV_JobsThreadProc, NULL, 0, NULL);
+		if (sv_jobs.threads[i] == NULL)
+		{
+			break;
+		}
+#else
+		if (pthread_create(&sv_jobs.threads[i], NULL, SV_JobsThreadProc, NULL) != 0)
+		{
+			break;
+		}
+#endif
+	}
+	sv_jobs.numThreads = i;
+
+	if (sv_jobs.numThreads < numThreads)
+	{
+		Com_Printf(S_COLOR_YELLOW "WARNING: only %i of %i server worker threads started\n", sv_jobs.numThreads, numThreads);
+	}
+	Com_DPrintf("Server worker pool: %i threads\n", sv_jobs.numThreads);
+}
+
+/**
+ * @brief Stop the worker threads
+ */
+void SV_ShutdownJobs(void)
+{
+	int i;
+
+	// the lock also exists when no thread could be started
+	if (!sv_jobs.initialized)
+	{
+		return;
+	}
+
+	SV_JobsLock();
+	sv_jobs.quit = qtrue;
+	SV_JobsSignal(wake);
+	SV_JobsUnlock();
+
+	for (i = 0; i < sv_jobs.numThreads; i++)
+	{
+#ifdef _WIN32
+		WaitForSingleObject(sv_jobs.threads[i], INFINITE);
+		CloseHandle(sv_jobs.threads[i]);
+#else
+		pthread_join(sv_jobs.threads[i], NULL);
+#endif
+	}
+
+#ifdef _WIN32
+	DeleteCriticalSection(&sv_jobs.lock);
+#else
+	pthread_cond_destroy(&sv_jobs.done);
+	pthread_cond_destroy(&sv_jobs.wake);
+	pthread_mutex_destroy(&sv_jobs.lock);
+#endif
+
+	Com_Memset(&sv_jobs, 0, sizeof(sv_jobs));
+}
+
+/**
+ * @brief Number of running worker threads
+ * @return 0 if the pool is disabled
+ */
+int SV_NumJobThreads(void)
+{
+	return sv_jobs.numThreads;
+}
+
+/**
+ * @brief Call func(0) ... func(numJobs - 1) on the pool and wait for all of them
+ *
+ * The calling thread takes part. Without workers the indices simply run in order.
+ *
+ * @param[in] func
+ * @param[in] numJobs
+ */
+void SV_RunJobs(void (*func)(int index), int numJobs)
+{
+	int i;
+
+	if (numJobs <= 0)
+	{
+		return;
+	}
+
+	if (!sv_jobs.numThreads || numJobs == 1)
+	{
+		for (i = 0; i < numJobs; i++)
+		{
+			func(i);
+		}
+		return;
+	}
+
+	SV_JobsLock();
+	sv_jobs.func         = func;
+	sv_jobs.numJobs      = numJobs;
+	sv_jobs.nextJob      = 0;
+	sv_jobs.finishedJobs = 0;
+	sv_jobs.batch++;
+	SV_JobsSignal(wake);
+
+	SV_JobsWork();
+
+	while (sv_jobs.finishedJobs < sv_jobs.numJobs)
+	{
+		SV_JobsWait(done);
+	}
+	sv_jobs.func    = NULL;
+	sv_jobs.numJobs = 0;
+	SV_JobsUnlock();
+}
@@ -130,11 +130,14 @@ static void SV_TrackCommandOverhead(const int offset, const msg_t *msg, const ch
 
 /**
  * @brief Writes a delta update of an entityState_t list to the message.
+ * @param[in] client
  * @param[in] from
  * @param[in] to
+ * @param[in] toEntityNums if set, the entities of the new frame are read from the game
+ *            instead of svs.snapshotEntities (they have not been stored there yet)
  * @param[in] msg
  */
-static void SV_EmitPacketEntities(client_t *client, clientSnapshot_t *from, clientSnapshot_t *to, msg_t *msg)
+static void SV_EmitPacketEntities(client_t *client, clientSnapshot_t *from, clientSnapshot_t *to, const int *toEntityNums, msg_t *msg)
 {
 	entityState_t  *oldent = NULL, *newent = NULL;
 	entityShared_t *oldSharedent = NULL, *newSharedent = NULL;
@@ -162,6 +165,14 @@ static void SV_EmitPacketEntities(client_t *client, clientSnapshot_t *from, clie
 		{
 			newnum = 9999;
 		}
+		else if (toEntityNums)
+		{
+			sharedEntity_t *ent = SV_GentityNum(toEntityNums[newindex]);
+
+			newent       = &ent->s;
+			newSharedent = &ent->r;
+			newnum       = newent->number;
+		}
 		else
 		{
 			newent       = &svs.snapshotEntities[(to->first_entity + newindex) % svs.numSnapshotEntities];
@@ -327,18 +338,15 @@ static void SV_ETTV_EmitPlayerstates(client_t *client, msg_t *msg)
 #endif // DEDICATED
 
 /**
- * @brief SV_WriteSnapshotToClient
- * @param[in] client
- * @param[in] msg
+ * @brief Picks the frame the new snapshot is delta compressed against
+ * @param[in,out] client
+ * @param[in] nextSnapshotEntities svs.nextSnapshotEntities once the new snapshot is stored
+ * @param[out] lastframe
+ * @return The old frame, or NULL for a full snapshot
  */
-static void SV_WriteSnapshotToClient(client_t *client, msg_t *msg)
+static clientSnapshot_t *SV_SnapshotDeltaFrame(client_t *client, int nextSnapshotEntities, int *lastframe)
 {
-	clientSnapshot_t *frame, *oldframe;
-	int              lastframe;
-	int              snapFlags;
-
-	// this is the snapshot we are creating
-	frame = &client->frames[client->netchan.outgoingSequence & PACKET_MASK];
+	clientSnapshot_t *oldframe;
 
 	// if we are about to go over MAX_PARSE_ENTITIES send uncompressed snapshot
 	if (client->parseEntitiesNum > MAX_PARSE_ENTITIES - 128)
@@ -352,31 +360,53 @@ static void SV_WriteSnapshotToClient(client_t *client, msg_t *msg)
 	if (client->deltaMessage <= 0 || client->state != CS_ACTIVE)
 	{
 		// client is asking for a retransmit
-		oldframe  = NULL;
-		lastframe = 0;
+		oldframe   = NULL;
+		*lastframe = 0;
 	}
 	else if (client->netchan.outgoingSequence - client->deltaMessage >= (PACKET_BACKUP - 3))
 	{
 		// client hasn't gotten a good message through in a long time
 		Com_DPrintf("%s: Delta request from out of date packet.\n", client->name);
-		oldframe  = NULL;
-		lastframe = 0;
+		oldframe   = NULL;
+		*lastframe = 0;
 	}
 	else
 	{
 		// we have a valid snapshot to delta from
-		oldframe  = &client->frames[client->deltaMessage & PACKET_MASK];
-		lastframe = client->netchan.outgoingSequence - client->deltaMessage;
+		oldframe   = &client->frames[client->deltaMessage & PACKET_MASK];
+		*lastframe = client->netchan.outgoingSequence - client->deltaMessage;
 
 		// the snapshot's entities may still have rolled off the buffer, though
-		if (oldframe->first_entity <= svs.nextSnapshotEntities - svs.numSnapshotEntities)
+		if (oldframe->first_entity <= nextSnapshotEntities - svs.numSnapshotEntities)
 		{
 			Com_DPrintf("%s: Delta request from out of date entities.\n", client->name);
-			oldframe  = NULL;
-			lastframe = 0;
+			oldframe   = NULL;
+			*lastframe = 0;
 		}
 	}
 
+	return oldframe;
+}
+
+/**
+ * @brief Writes the snapshot against a chosen delta frame
+ *
+ * Only reads shared server state, so snapshot jobs run it on worker threads.
+ *
+ * @param[in] client
+ * @param[in] oldframe
+ * @param[in] lastframe
+ * @param[in] toEntityNums see SV_EmitPacketEntities
+ * @param[in,out] msg
+ */
+static void SV_WriteSnapshotFrame(client_t *client, clientSnapshot_t *oldframe, int lastframe, const int *toEntityNums, msg_t *msg)
+{
+	clientSnapshot_t *frame;
+	int              snapFlags;
+
+	// this is the snapshot we are creating
+	frame = &client->frames[client->netchan.outgoingSequence & PACKET_MASK];
+
 	MSG_WriteByte(msg, svc_snapshot);
 
 	// NOTE, MRE: now sent at the start of every message from server to client
@@ -424,7 +454,7 @@ static void SV_WriteSnapshotToClient(client_t *client, msg_t *msg)
 	//}
 
 	// delta encode the entities
-	SV_EmitPacketEntities(client, oldframe, frame, msg);
+	SV_EmitPacketEntities(client, oldframe, frame, toEntityNums, msg);
 
 #ifdef DEDICATED
 	if (client->ettvClient && client->state > CS_ZOMBIE)
@@ -433,8 +463,6 @@ static void SV_WriteSnapshotToClient(client_t *client, msg_t *msg)
 	}
 #endif // DEDICATED
 
-	client->parseEntitiesNum += frame->num_entities;
-
 	// padding for rate debugging
 	if (sv_padPackets->integer)
 	{
@@ -447,6 +475,23 @@ static void SV_WriteSnapshotToClient(client_t *client, msg_t *msg)
 	}
 }
 
+/**
+ * @brief SV_WriteSnapshotToClient
+ * @param[in] client
+ * @param[in] msg
+ */
+static void SV_WriteSnapshotToClient(client_t *client, msg_t *msg)
+{
+	clientSnapshot_t *oldframe;
+	int              lastframe;
+
+	oldframe = SV_SnapshotDeltaFrame(client, svs.nextSnapshotEntities, &lastframe);
+
+	SV_WriteSnapshotFrame(client, oldframe, lastframe, NULL, msg);
+
+	client->parseEntitiesNum += client->frames[client->netchan.outgoingSequence & PACKET_MASK].num_entities;
+}
+
 /**
  * @brief (re)send all server commands the client hasn't acknowledged yet
  * @param[in] client
@@ -485,9 +530,49 @@ Build a client snapshot structure
 typedef struct
 {
 	int numSnapshotEntities;
-	int snapshotEntities[MAX_SNAPSHOT_ENTITIES];
+	int snapshotEntities[MAX_GENTITIES];    ///< every entity is added at most once
 } snapshotEntityNumbers_t;
 
+/**
+ * @struct snapshotBuild_t
+ * @brief State of one snapshot while its entities are collected
+ *
+ * Kept per snapshot instead of in svEntity_t, so that several snapshots
+ * can be built at the same time.
+ */
+typedef struct
+{
+	snapshotEntityNumbers_t entityNumbers;
+	byte added[MAX_GENTITIES / 8];      ///< svEntities already considered, to prevent double adding from portal views
+	qboolean deferCallbacks;            ///< don't call the game, flag the entities for SV_SnapshotRunCallbacks
+	byte callbacks[MAX_GENTITIES / 8];  ///< entities added before the game's snapshot callback has seen them
+} snapshotBuild_t;
+
+/**
+ * @brief SV_SnapshotHasEnt
+ * @param[in] build
+ * @param[in] svEnt
+ * @return qtrue if the entity was already considered for this snapshot
+ */
+static ID_INLINE qboolean SV_SnapshotHasEnt(const snapshotBuild_t *build, const svEntity_t *svEnt)
+{
+	int num = svEnt - sv.svEntities;
+
+	return (build->added[num >> 3] & (1 << (num & 7))) ? qtrue : qfalse;
+}
+
+/**
+ * @brief SV_SnapshotMarkEnt
+ * @param[in,out] build
+ * @param[in] svEnt
+ */
+static ID_INLINE void SV_SnapshotMarkEnt(snapshotBuild_t *build, const svEntity_t *svEnt)
+{
+	int num = svEnt - sv.svEntities;
+
+	build->added[num >> 3] |= 1 << (num & 7);
+}
+
 /**
  * @brief SV_QsortEntityNumbers
  * @param[in] a
@@ -514,39 +599,60 @@ static int QDECL SV_QsortEntityNumbers(const void *a, const void *b)
 	return 1;
 }
 
+/**
+ * @brief Asks the game whether an entity with r.snapshotCallback goes to a client
+ * @param[in] cl
+ * @param[in] clientEnt
+ * @param[in] gEnt
+ * @return
+ */
+static qboolean SV_SnapshotCallback(client_t *cl, sharedEntity_t *clientEnt, sharedEntity_t *gEnt)
+{
+	if (sv.snapshotCallbackExt)
+	{
+		return (qboolean)(VM_Call(gvm, GAME_SNAPSHOT_CALLBACK_EXT, gEnt->s.number, clientEnt->s.number, cl - svs.clients));
+	}
+
+	return (qboolean)(VM_Call(gvm, GAME_SNAPSHOT_CALLBACK, gEnt->s.number, clientEnt->s.number));
+}
+
 /**
  * @brief SV_AddEntToSnapshot
  * @param[in] clientEnt
- * @param[in,out] svEnt
+ * @param[in] svEnt
  * @param[in] gEnt
- * @param[in,out] eNums
+ * @param[in,out] build
  */
-static void SV_AddEntToSnapshot(client_t *cl, sharedEntity_t *clientEnt, svEntity_t *svEnt, sharedEntity_t *gEnt, snapshotEntityNumbers_t *eNums)
+static void SV_AddEntToSnapshot(client_t *cl, sharedEntity_t *clientEnt, svEntity_t *svEnt, sharedEntity_t *gEnt, snapshotBuild_t *build)
 {
+	snapshotEntityNumbers_t *eNums = &build->entityNumbers;
+
 	// if we have already added this entity to this snapshot, don't add again
-	if (svEnt->snapshotCounter == sv.snapshotCounter)
+	if (SV_SnapshotHasEnt(build, svEnt))
 	{
 		return;
 	}
-	svEnt->snapshotCounter = sv.snapshotCounter;
+	SV_SnapshotMarkEnt(build, svEnt);
 
-	// if we are full, silently discard entities
-	if (eNums->numSnapshotEntities == MAX_SNAPSHOT_ENTITIES)
+	// deferred entities are capped by SV_SnapshotRunCallbacks, once the
+	// callbacks have dropped the ones that are not sent
+	if (build->deferCallbacks)
 	{
-		Com_Printf("Warning: MAX_SNAPSHOT_ENTITIES reached. Ignoring ent.\n");
-		return;
+		if (gEnt->r.snapshotCallback)
+		{
+			build->callbacks[gEnt->s.number >> 3] |= 1 << (gEnt->s.number & 7);
+		}
 	}
-
-	if (gEnt->r.snapshotCallback)
+	else
 	{
-		if (sv.snapshotCallbackExt)
+		// if we are full, silently discard entities
+		if (eNums->numSnapshotEntities == MAX_SNAPSHOT_ENTITIES)
 		{
-			if (!(qboolean)(VM_Call(gvm, GAME_SNAPSHOT_CALLBACK_EXT, gEnt->s.number, clientEnt->s.number, cl - svs.clients)))
-			{
-				return;
-			}
+			Com_Printf("Warning: MAX_SNAPSHOT_ENTITIES reached. Ignoring ent.\n");
+			return;
 		}
-		else if (!(qboolean)(VM_Call(gvm, GAME_SNAPSHOT_CALLBACK, gEnt->s.number, clientEnt->s.number)))
+
+		if (gEnt->r.snapshotCallback && !SV_SnapshotCallback(cl, clientEnt, gEnt))
 		{
 			return;
 		}
@@ -556,23 +662,62 @@ static void SV_AddEntToSnapshot(client_t *cl, sharedEntity_t *clientEnt, svEntit
 	eNums->numSnapshotEntities++;
 }
 
+/**
+ * @brief Runs the game's snapshot callbacks a job left for the main thread
+ *
+ * The callbacks are made in the order the entities were added, which is the
+ * order the serial path makes them in. MAX_SNAPSHOT_ENTITIES is applied to
+ * the entities that are kept, as the serial path does.
+ *
+ * @param[in] cl
+ * @param[in] frame
+ * @param[in,out] build
+ */
+static void SV_SnapshotRunCallbacks(client_t *cl, clientSnapshot_t *frame, snapshotBuild_t *build)
+{
+	snapshotEntityNumbers_t *eNums    = &build->entityNumbers;
+	sharedEntity_t          *clientEnt = SV_GentityNum(frame->ps.clientNum);
+	int                     i, num, numKept = 0;
+
+	for (i = 0; i < eNums->numSnapshotEntities; i++)
+	{
+		num = eNums->snapshotEntities[i];
+
+		// if we are full, silently discard entities
+		if (numKept == MAX_SNAPSHOT_ENTITIES)
+		{
+			Com_Printf("Warning: MAX_SNAPSHOT_ENTITIES reached. Ignoring ent.\n");
+			continue;
+		}
+
+		if ((build->callbacks[num >> 3] & (1 << (num & 7))) && !SV_SnapshotCallback(cl, clientEnt, SV_GentityNum(num)))
+		{
+			continue;
+		}
+
+		eNums->snapshotEntities[numKept++] = num;
+	}
+
+	eNums->numSnapshotEntities = numKept;
+}
+
 #ifdef FEATURE_ANTICHEAT
 /**
  * @brief SV_AddEntitiesVisibleFromPoint
  * @param[in] origin
  * @param[in,out] frame
- * @param[in] eNums
+ * @param[in,out] build
  * @param[in] portal
  */
-static void SV_AddEntitiesVisibleFromPoint(client_t *cl, vec3_t origin, clientSnapshot_t *frame, snapshotEntityNumbers_t *eNums, qboolean portal)
+static void SV_AddEntitiesVisibleFromPoint(client_t *cl, vec3_t origin, clientSnapshot_t *frame, snapshotBuild_t *build, qboolean portal)
 #else
 /**
  * @brief SV_AddEntitiesVisibleFromPoint
  * @param[in] origin
  * @param[in,out] frame
- * @param[in] eNums
+ * @param[in,out] build
  */
-static void SV_AddEntitiesVisibleFromPoint(client_t *cl, vec3_t origin, clientSnapshot_t *frame, snapshotEntityNumbers_t *eNums)
+static void SV_AddEntitiesVisibleFromPoint(client_t *cl, vec3_t origin, clientSnapshot_t *frame, snapshotBuild_t *build)
 #endif
 {
 	int            e, i;
@@ -608,9 +753,9 @@ static void SV_AddEntitiesVisibleFromPoint(client_t *cl, vec3_t origin, clientSn
 	if (playerEnt->r.svFlags & SVF_SELF_PORTAL)
 	{
 #ifdef FEATURE_ANTICHEAT
-		SV_AddEntitiesVisibleFromPoint(cl, playerEnt->s.origin2, frame, eNums, qtrue); // FIXME: portal qtrue?!
+		SV_AddEntitiesVisibleFromPoint(cl, playerEnt->s.origin2, frame, build, qtrue); // FIXME: portal qtrue?!
 #else
-		SV_AddEntitiesVisibleFromPoint(cl, playerEnt->s.origin2, frame, eNums);
+		SV_AddEntitiesVisibleFromPoint(cl, playerEnt->s.origin2, frame, build);
 #endif
 	}
 
@@ -656,7 +801,7 @@ static void SV_AddEntitiesVisibleFromPoint(client_t *cl, vec3_t origin, clientSn
 		svEnt = SV_SvEntityForGentity(ent);
 
 		// don't double add an entity through portals
-		if (svEnt->snapshotCounter == sv.snapshotCounter)
+		if (SV_SnapshotHasEnt(build, svEnt))
 		{
 			continue;
 		}
@@ -664,19 +809,19 @@ static void SV_AddEntitiesVisibleFromPoint(client_t *cl, vec3_t origin, clientSn
 		// broadcast entities are always sent
 		if (ent->r.svFlags & SVF_BROADCAST)
 		{
-			SV_AddEntToSnapshot(cl, playerEnt, svEnt, ent, eNums);
+			SV_AddEntToSnapshot(cl, playerEnt, svEnt, ent, build);
 			continue;
 		}
 
 		if (cl->ettvClient || (svcls.isTVGame && ent->s.number < MAX_CLIENTS))
 		{
-			SV_AddEntToSnapshot(cl, playerEnt, svEnt, ent, eNums);
+			SV_AddEntToSnapshot(cl, playerEnt, svEnt, ent, build);
 			continue;
 		}
 
 		if (cl->clientMask && ent->s.number < MAX_CLIENTS && (cl->clientMask & (1ULL << ent->s.number)))
 		{
-			SV_AddEntToSnapshot(cl, playerEnt, svEnt, ent, eNums);
+			SV_AddEntToSnapshot(cl, playerEnt, svEnt, ent, build);
 			continue;
 		}
 
@@ -687,7 +832,7 @@ static void SV_AddEntitiesVisibleFromPoint(client_t *cl, vec3_t origin, clientSn
 		{
 			if (bitvector[svEnt->originCluster >> 3] & (1 << (svEnt->originCluster & 7)))
 			{
-				SV_AddEntToSnapshot(cl, playerEnt, svEnt, ent, eNums);
+				SV_AddEntToSnapshot(cl, playerEnt, svEnt, ent, build);
 			}
 
 			continue;
@@ -755,12 +900,12 @@ static void SV_AddEntitiesVisibleFromPoint(client_t *cl, vec3_t origin, clientSn
 				svEntity_t *master = 0;
 				master = SV_SvEntityForGentity(ment);
 
-				if (master->snapshotCounter == sv.snapshotCounter || !ment->r.linked)
+				if (SV_SnapshotHasEnt(build, master) || !ment->r.linked)
 				{
 					continue;
 				}
 
-				SV_AddEntToSnapshot(cl, playerEnt, master, ment, eNums);
+				SV_AddEntToSnapshot(cl, playerEnt, master, ment, build);
 			}
 
 			continue;   // master needs to be added, but not this dummy ent
@@ -804,14 +949,14 @@ static void SV_AddEntitiesVisibleFromPoint(client_t *cl, vec3_t origin, clientSn
 					continue;
 				}
 
-				if (master->snapshotCounter == sv.snapshotCounter)
+				if (SV_SnapshotHasEnt(build, master))
 				{
 					continue;
 				}
 
 				if (ment->s.otherEntityNum == ent->s.number)
 				{
-					SV_AddEntToSnapshot(cl, playerEnt, master, ment, eNums);
+					SV_AddEntToSnapshot(cl, playerEnt, master, ment, build);
 				}
 			}
 
@@ -836,7 +981,7 @@ static void SV_AddEntitiesVisibleFromPoint(client_t *cl, vec3_t origin, clientSn
 				if (!SV_CanSee(frame->ps.clientNum, e))
 				{
 					SV_RandomizePos(frame->ps.clientNum, e);
-					SV_AddEntToSnapshot(cl, client, svEnt, ent, eNums);
+					SV_AddEntToSnapshot(cl, client, svEnt, ent, build);
 					continue;
 				}
 			}
@@ -844,15 +989,15 @@ static void SV_AddEntitiesVisibleFromPoint(client_t *cl, vec3_t origin, clientSn
 #endif
 
 		// add it
-		SV_AddEntToSnapshot(cl, playerEnt, svEnt, ent, eNums);
+		SV_AddEntToSnapshot(cl, playerEnt, svEnt, ent, build);
 
 		// if its a portal entity, add everything visible from its camera position
 		if (ent->r.svFlags & SVF_PORTAL)
 		{
 #ifdef FEATURE_ANTICHEAT
-			SV_AddEntitiesVisibleFromPoint(cl, ent->s.origin2, frame, eNums, qtrue /*localClient*/);
+			SV_AddEntitiesVisibleFromPoint(cl, ent->s.origin2, frame, build, qtrue /*localClient*/);
 #else
-			SV_AddEntitiesVisibleFromPoint(cl, ent->s.origin2, frame, eNums /*, qtrue, localClient*/);
+			SV_AddEntitiesVisibleFromPoint(cl, ent->s.origin2, frame, build /*, qtrue, localClient*/);
 #endif
 		}
 
@@ -869,30 +1014,27 @@ static void SV_AddEntitiesVisibleFromPoint(client_t *cl, vec3_t origin, clientSn
  *
  * For viewing through other player's eyes, clent can be something other than client->gentity
  *
- * @param[in,out] client
+ * @param[in] client
+ * @param[out] build
+ * @return qfalse if the client gets an empty snapshot
  */
-static void SV_BuildClientSnapshot(client_t *client)
+static qboolean SV_SnapshotCollect(client_t *client, snapshotBuild_t *build)
 {
-	vec3_t                  org;
-	clientSnapshot_t        *frame;
-	snapshotEntityNumbers_t entityNumbers;
-	int                     i;
-	sharedEntity_t          *ent;
-	entityState_t           *state;
-	entityShared_t          *stateShared;
-	svEntity_t              *svEnt;
-	sharedEntity_t          *clent;
-	int                     clientNum;
-	playerState_t           *ps;
-
-	// bump the counter used to prevent double adding
-	sv.snapshotCounter++;
+	vec3_t           org;
+	clientSnapshot_t *frame;
+	int              i;
+	svEntity_t       *svEnt;
+	sharedEntity_t   *clent;
+	int              clientNum;
+	playerState_t    *ps;
 
 	// this is the frame we are creating
 	frame = &client->frames[client->netchan.outgoingSequence & PACKET_MASK];
 
 	// clear everything in this snapshot
-	entityNumbers.numSnapshotEntities = 0;
+	build->entityNumbers.numSnapshotEntities = 0;
+	Com_Memset(build->added, 0, sizeof(build->added));
+	Com_Memset(build->callbacks, 0, sizeof(build->callbacks));
 	Com_Memset(frame->areabits, 0, sizeof(frame->areabits));
 
 	frame->num_entities = 0;
@@ -900,7 +1042,7 @@ static void SV_BuildClientSnapshot(client_t *client)
 	clent = client->gentity;
 	if (!clent || client->state == CS_ZOMBIE)
 	{
-		return;
+		return qfalse;
 	}
 
 	// grab the current playerState_t
@@ -916,7 +1058,7 @@ static void SV_BuildClientSnapshot(client_t *client)
 	}
 	svEnt = &sv.svEntities[clientNum];
 
-	svEnt->snapshotCounter = sv.snapshotCounter;
+	SV_SnapshotMarkEnt(build, svEnt);
 
 	if (clent->r.svFlags & SVF_SELF_PORTAL_EXCLUSIVE)
 	{
@@ -943,21 +1085,11 @@ static void SV_BuildClientSnapshot(client_t *client)
 	// add all the entities directly visible to the eye, which
 	// may include portal entities that merge other viewpoints
 #ifdef FEATURE_ANTICHEAT
-	SV_AddEntitiesVisibleFromPoint(client, org, frame, &entityNumbers, qfalse /*client->netchan.remoteAddress.type == NA_LOOPBACK*/);
+	SV_AddEntitiesVisibleFromPoint(client, org, frame, build, qfalse /*client->netchan.remoteAddress.type == NA_LOOPBACK*/);
 #else
-	SV_AddEntitiesVisibleFromPoint(client, org, frame, &entityNumbers /*, qfalse, client->netchan.remoteAddress.type == NA_LOOPBACK*/);
+	SV_AddEntitiesVisibleFromPoint(client, org, frame, build /*, qfalse, client->netchan.remoteAddress.type == NA_LOOPBACK*/);
 #endif
 
-	// clear the mask for next frame
-	client->clientMask = 0;
-
-	// if there were portals visible, there may be out of order entities
-	// in the list which will need to be resorted for the delta compression
-	// to work correctly.  This also catches the error condition
-	// of an entity being included twice.
-	qsort(entityNumbers.snapshotEntities, entityNumbers.numSnapshotEntities,
-	      sizeof(entityNumbers.snapshotEntities[0]), SV_QsortEntityNumbers);
-
 	// now that all viewpoint's areabits have been OR'd together, invert
 	// all of them to make it a mask vector, which is what the renderer wants
 	for (i = 0 ; i < MAX_MAP_AREA_BYTES / 4 ; i++)
@@ -965,12 +1097,42 @@ static void SV_BuildClientSnapshot(client_t *client)
 		((int *)frame->areabits)[i] = ((int *)frame->areabits)[i] ^ -1;
 	}
 
+	return qtrue;
+}
+
+/**
+ * @brief SV_SnapshotSortEntities
+ * @param[in,out] build
+ */
+static void SV_SnapshotSortEntities(snapshotBuild_t *build)
+{
+	// if there were portals visible, there may be out of order entities
+	// in the list which will need to be resorted for the delta compression
+	// to work correctly.  This also catches the error condition
+	// of an entity being included twice.
+	qsort(build->entityNumbers.snapshotEntities, build->entityNumbers.numSnapshotEntities,
+	      sizeof(build->entityNumbers.snapshotEntities[0]), SV_QsortEntityNumbers);
+}
+
+/**
+ * @brief Copies the entity states of a collected snapshot to svs.snapshotEntities
+ * @param[in] client
+ * @param[in] build
+ */
+static void SV_SnapshotStoreEntities(client_t *client, snapshotBuild_t *build)
+{
+	clientSnapshot_t *frame = &client->frames[client->netchan.outgoingSequence & PACKET_MASK];
+	sharedEntity_t   *ent;
+	entityState_t    *state;
+	entityShared_t   *stateShared;
+	int              i;
+
 	// copy the entity states out
 	frame->num_entities = 0;
 	frame->first_entity = svs.nextSnapshotEntities;
-	for (i = 0 ; i < entityNumbers.numSnapshotEntities ; i++)
+	for (i = 0 ; i < build->entityNumbers.numSnapshotEntities ; i++)
 	{
-		ent    = SV_GentityNum(entityNumbers.snapshotEntities[i]);
+		ent    = SV_GentityNum(build->entityNumbers.snapshotEntities[i]);
 		state  = &svs.snapshotEntities[svs.nextSnapshotEntities % svs.numSnapshotEntities];
 		*state = ent->s;
 
@@ -981,11 +1143,11 @@ static void SV_BuildClientSnapshot(client_t *client)
 		}
 
 #ifdef FEATURE_ANTICHEAT
-		if (sv_wh_active->integer && entityNumbers.snapshotEntities[i] < sv_maxclients->integer)
+		if (sv_wh_active->integer && build->entityNumbers.snapshotEntities[i] < sv_maxclients->integer)
 		{
-			if (SV_PositionChanged(entityNumbers.snapshotEntities[i]))
+			if (SV_PositionChanged(build->entityNumbers.snapshotEntities[i]))
 			{
-				SV_RestorePos(entityNumbers.snapshotEntities[i]);
+				SV_RestorePos(build->entityNumbers.snapshotEntities[i]);
 			}
 		}
 #endif
@@ -1001,6 +1163,28 @@ static void SV_BuildClientSnapshot(client_t *client)
 	}
 }
 
+/**
+ * @brief SV_BuildClientSnapshot
+ * @param[in,out] client
+ */
+static void SV_BuildClientSnapshot(client_t *client)
+{
+	snapshotBuild_t build;
+
+	build.deferCallbacks = qfalse;
+
+	if (!SV_SnapshotCollect(client, &build))
+	{
+		return;
+	}
+
+	// clear the mask for next frame
+	client->clientMask = 0;
+
+	SV_SnapshotSortEntities(&build);
+	SV_SnapshotStoreEntities(client, &build);
+}
+
 #define UDPIP_HEADER_SIZE 28
 #define UDPIP6_HEADER_SIZE 48
 
@@ -1206,6 +1390,425 @@ void SV_SendClientSnapshot(client_t *client)
 	sv.ubpsTotalBytes += msg.uncompsize / 8;    // net debugging
 }
 
+/*
+=============================================================================
+Snapshot jobs
+
+With sv_snapshotThreads set, the clients that are due a message are queued
+instead of served one by one. SV_FlushSnapshotJobs() then runs:
+
+1. collect the visible entities of every snapshot on the worker pool
+2. on the main thread, in client order: the game's snapshot callbacks,
+   sorting, the svs.snapshotEntities range each snapshot will occupy,
+   the reliable commands and the delta frame
+3. delta encode the snapshots on the worker pool, reading the new entity
+   states straight from the game
+4. on the main thread, in client order: store the entity states and
+   transmit
+
+The workers never call the game, print or write shared state, and the
+ring positions are the ones the serial path would have used, so the
+packets are byte-identical to it. If transmitting drops a client, the game
+may change what the remaining clients see, so those go the serial way.
+sv_snapshotVerify builds every snapshot again the serial way in step 4 and
+logs the ones that differ.
+=============================================================================
+*/
+
+extern cvar_t *cl_shownet;
+
+/**
+ * @struct snapshotJob_t
+ * @brief
+ */
+typedef struct
+{
+	client_t *client;
+	qboolean snapshot;                  ///< qfalse for an idle message, which is only sent in step 4
+	qboolean collected;                 ///< SV_SnapshotCollect found a snapshot
+
+	snapshotBuild_t build;
+
+	clientSnapshot_t *oldframe;         ///< delta source, NULL for a full snapshot
+	int lastframe;
+	int nextSnapshotEntities;           ///< svs.nextSnapshotEntities once this snapshot is stored
+
+	msg_t msg;
+	byte msgBuf[MAX_MSGLEN];
+} snapshotJob_t;
+
+static snapshotJob_t sv_snapshotJobs[MAX_CLIENTS];
+static int           sv_numSnapshotJobs;
+
+/**
+ * @brief Checks whether this frame's messages can be built by snapshot jobs
+ *
+ * Also (re)starts the worker pool when sv_snapshotThreads changed.
+ *
+ * @return
+ */
+static qboolean SV_SnapshotJobsEnabled(void)
+{
+	if (sv_snapshotThreads->modified)
+	{
+		sv_snapshotThreads->modified = qfalse;
+		SV_InitJobs(sv_snapshotThreads->integer);
+	}
+
+	if (!SV_NumJobThreads() || !com_dedicated->integer)
+	{
+		return qfalse;
+	}
+
+	// these print or change shared state while a snapshot is written
+	if (cl_shownet && cl_shownet->integer)
+	{
+		return qfalse;
+	}
+
+#ifdef FEATURE_ANTICHEAT
+	if (sv_wh_active->integer)
+	{
+		return qfalse;
+	}
+#endif
+
+#ifdef ETLEGACY_DEBUG
+	if (net_overhead.numSlices)
+	{
+		return qfalse;
+	}
+#endif
+
+	return qtrue;
+}
+
+/**
+ * @brief Step 1 worker
+ * @param[in] index
+ */
+static void SV_SnapshotCollectJob(int index)
+{
+	snapshotJob_t *job = &sv_snapshotJobs[index];
+
+	if (!job->snapshot)
+	{
+		return;
+	}
+
+	job->build.deferCallbacks = qtrue;
+	job->collected            = SV_SnapshotCollect(job->client, &job->build);
+}
+
+/**
+ * @brief Step 3 worker
+ * @param[in] index
+ */
+static void SV_SnapshotEncodeJob(int index)
+{
+	snapshotJob_t *job = &sv_snapshotJobs[index];
+
+	if (!job->snapshot)
+	{
+		return;
+	}
+
+	SV_WriteSnapshotFrame(job->client, job->oldframe, job->lastframe, job->build.entityNumbers.snapshotEntities, &job->msg);
+}
+
+/**
+ * @struct snapshotVerify_t
+ * @brief sv_snapshotVerify counters, see SV_SnapshotVerify_f
+ */
+typedef struct
+{
+	int checked;
+	int mismatched;
+} snapshotVerify_t;
+
+static snapshotVerify_t sv_snapshotVerifyStats;
+static snapshotBuild_t  sv_snapshotVerifyBuild;
+static byte             sv_snapshotVerifyBuf[MAX_MSGLEN];
+
+/**
+ * @brief Compares the bits written to two messages
+ *
+ * cursize counts the byte the next bit goes to, so when the message ends on a
+ * byte boundary its last byte is whatever the buffer held before. Only the
+ * written bits are compared.
+ *
+ * @param[in] a
+ * @param[in] b
+ * @return
+ */
+static qboolean SV_SnapshotBitsEqual(const msg_t *a, const msg_t *b)
+{
+	int bytes = a->bit >> 3;
+	int mask  = (1 << (a->bit & 7)) - 1;
+
+	if (a->bit != b->bit || memcmp(a->data, b->data, bytes))
+	{
+		return qfalse;
+	}
+
+	return ((a->data[bytes] ^ b->data[bytes]) & mask) ? qfalse : qtrue;
+}
+
+/**
+ * @brief Builds a job's snapshot again the serial way and compares the packets
+ *
+ * Runs in step 4 once the entity states are stored, before the message is
+ * sent. The game's snapshot callbacks are called a second time, they only
+ * read the game state.
+ *
+ * @param[in] job
+ */
+static void SV_SnapshotVerify(snapshotJob_t *job)
+{
+	client_t         *client = job->client;
+	clientSnapshot_t *frame  = &client->frames[client->netchan.outgoingSequence & PACKET_MASK];
+	clientSnapshot_t *oldframe;
+	int              numEntities = frame->num_entities;
+	int              firstEntity = frame->first_entity;
+	int              lastframe;
+	qboolean         collected;
+	msg_t            msg;
+
+	// the entity list
+	sv_snapshotVerifyBuild.deferCallbacks = qfalse;
+	collected                             = SV_SnapshotCollect(client, &sv_snapshotVerifyBuild);
+	if (collected)
+	{
+		SV_SnapshotSortEntities(&sv_snapshotVerifyBuild);
+	}
+
+	// SV_SnapshotCollect starts the frame over
+	frame->num_entities = numEntities;
+	frame->first_entity = firstEntity;
+
+	// the packet
+	MSG_Init(&msg, sv_snapshotVerifyBuf, sizeof(sv_snapshotVerifyBuf));
+	msg.allowoverflow = qtrue;
+
+	if (!Com_IsCompatible(&client->agent, 0x1))
+	{
+		MSG_EnableCharStrip(&msg);
+	}
+
+	MSG_WriteLong(&msg, client->lastClientCommand);
+	SV_UpdateServerCommandsToClient(client, &msg);
+
+	oldframe = SV_SnapshotDeltaFrame(client, svs.nextSnapshotEntities, &lastframe);
+	SV_WriteSnapshotFrame(client, oldframe, lastframe, NULL, &msg);
+
+	sv_snapshotVerifyStats.checked++;
+
+	if (collected != job->collected
+	    || (collected && (sv_snapshotVerifyBuild.entityNumbers.numSnapshotEntities != job->build.entityNumbers.numSnapshotEntities
+	                      || memcmp(sv_snapshotVerifyBuild.entityNumbers.snapshotEntities, job->build.entityNumbers.snapshotEntities,
+	                                job->build.entityNumbers.numSnapshotEntities * sizeof(job->build.entityNumbers.snapshotEntities[0])))))
+	{
+		sv_snapshotVerifyStats.mismatched++;
+		Com_Printf("snapshot verify: %s: entity lists differ (serial %i, threaded %i entities)\n", client->name,
+		           collected ? sv_snapshotVerifyBuild.entityNumbers.numSnapshotEntities : -1,
+		           job->collected ? job->build.entityNumbers.numSnapshotEntities : -1);
+	}
+	else if (oldframe != job->oldframe || lastframe != job->lastframe || !SV_SnapshotBitsEqual(&msg, &job->msg))
+	{
+		int i;
+
+		for (i = 0; i < msg.cursize && i < job->msg.cursize && msg.data[i] == job->msg.data[i]; i++)
+		{
+		}
+
+		sv_snapshotVerifyStats.mismatched++;
+		Com_Printf("snapshot verify: %s: packets differ at byte %i (serial %i bits delta %i, threaded %i bits delta %i)\n",
+		           client->name, i, msg.bit, lastframe, job->msg.bit, job->lastframe);
+	}
+}
+
+/**
+ * @brief Prints what sv_snapshotVerify compared and resets the counters
+ */
+void SV_SnapshotVerify_f(void)
+{
+	Com_Printf("snapshot verify: %i packets compared, %i mismatched%s\n",
+	           sv_snapshotVerifyStats.checked, sv_snapshotVerifyStats.mismatched,
+	           sv_snapshotVerify->integer ? "" : " (sv_snapshotVerify is off)");
+
+	Com_Memset(&sv_snapshotVerifyStats, 0, sizeof(sv_snapshotVerifyStats));
+}
+
+/**
+ * @brief Queues a client's message for SV_FlushSnapshotJobs
+ * @param[in] client
+ */
+static void SV_QueueSnapshotJob(client_t *client)
+{
+	snapshotJob_t *job = &sv_snapshotJobs[sv_numSnapshotJobs++];
+
+	job->client    = client;
+	job->collected = qfalse;
+
+	// zombie clients need full snaps so they can still process reliable commands
+	// (eg so they can pick up the disconnect reason)
+	job->snapshot = (client->state >= CS_ACTIVE || client->state == CS_ZOMBIE) ? qtrue : qfalse;
+}
+
+/**
+ * @brief Builds and sends the queued messages
+ */
+static void SV_FlushSnapshotJobs(void)
+{
+	snapshotJob_t    *job;
+	client_t         *client;
+	clientSnapshot_t *frame;
+	sharedEntity_t   *ent;
+	clientState_t    state;
+	int              numJobs = sv_numSnapshotJobs;
+	int              nextSnapshotEntities;
+	qboolean         serial = qfalse;
+	int              i;
+
+	if (!numJobs)
+	{
+		return;
+	}
+	sv_numSnapshotJobs = 0;
+
+	// what the serial path fixes up or errors out on while collecting
+	for (i = 0; i < sv.num_entities; i++)
+	{
+		ent = SV_GentityNum(i);
+
+		if (ent->r.linked && ent->s.number != i)
+		{
+			Com_DPrintf("FIXING ENT->S.NUMBER!!!\n");
+			ent->s.number = i;
+		}
+	}
+
+	for (i = 0; i < numJobs; i++)
+	{
+		client = sv_snapshotJobs[i].client;
+
+		if (sv_snapshotJobs[i].snapshot && client->gentity && client->state != CS_ZOMBIE)
+		{
+			int clientNum = SV_GameClientNum(client - svs.clients)->clientNum;
+
+			if (clientNum < 0 || clientNum >= MAX_GENTITIES)
+			{
+				Com_Error(ERR_DROP, "SV_BuildClientSnapshot: bad gEnt");
+			}
+		}
+	}
+
+	// 1. collect
+	SV_RunJobs(SV_SnapshotCollectJob, numJobs);
+
+	// 2. finish the entity lists and start the messages
+	nextSnapshotEntities = svs.nextSnapshotEntities;
+
+	for (i = 0; i < numJobs; i++)
+	{
+		job    = &sv_snapshotJobs[i];
+		client = job->client;
+
+		if (!job->snapshot)
+		{
+			continue;
+		}
+
+		if (job->collected)
+		{
+			frame = &client->frames[client->netchan.outgoingSequence & PACKET_MASK];
+
+			SV_SnapshotRunCallbacks(client, frame, &job->build);
+			SV_SnapshotSortEntities(&job->build);
+
+			// step 3 encodes against these, SV_SnapshotStoreEntities fills the range in step 4
+			frame->num_entities = job->build.entityNumbers.numSnapshotEntities;
+			frame->first_entity = nextSnapshotEntities;
+
+			nextSnapshotEntities += job->build.entityNumbers.numSnapshotEntities;
+		}
+		job->nextSnapshotEntities = nextSnapshotEntities;
+
+		MSG_Init(&job->msg, job->msgBuf, sizeof(job->msgBuf));
+		job->msg.allowoverflow = qtrue;
+
+		if (!Com_IsCompatible(&client->agent, 0x1))
+		{
+			MSG_EnableCharStrip(&job->msg);
+		}
+
+		// NOTE, MRE: all server->client messages now acknowledge
+		// let the client know which reliable clientCommands we have received
+		MSG_WriteLong(&job->msg, client->lastClientCommand);
+
+		// (re)send any reliable server commands
+		SV_UpdateServerCommandsToClient(client, &job->msg);
+
+		job->oldframe = SV_SnapshotDeltaFrame(client, job->nextSnapshotEntities, &job->lastframe);
+	}
+
+	// 3. encode
+	SV_RunJobs(SV_SnapshotEncodeJob, numJobs);
+
+	// 4. transmit
+	for (i = 0; i < numJobs; i++)
+	{
+		job    = &sv_snapshotJobs[i];
+		client = job->client;
+
+		if (serial)
+		{
+			SV_SendClientSnapshot(client);
+		}
+		else
+		{
+			state = client->state;
+
+			if (!job->snapshot)
+			{
+				SV_SendClientIdle(client);
+			}
+			else
+			{
+				if (job->collected)
+				{
+					// clear the mask for next frame
+					client->clientMask = 0;
+
+					SV_SnapshotStoreEntities(client, &job->build);
+				}
+
+				if (sv_snapshotVerify->integer)
+				{
+					SV_SnapshotVerify(job);
+				}
+
+				frame                     = &client->frames[client->netchan.outgoingSequence & PACKET_MASK];
+				client->parseEntitiesNum += frame->num_entities;
+
+				if (!SV_CheckForMsgOverflow(client, &job->msg))
+				{
+					SV_SendMessageToClient(&job->msg, client, qtrue);
+
+					sv.bpsTotalBytes  += job->msg.cursize;           // net debugging
+					sv.ubpsTotalBytes += job->msg.uncompsize / 8;    // net debugging
+				}
+			}
+
+			// the game has seen a disconnect
+			serial = (client->state != state) ? qtrue : qfalse;
+		}
+
+		client->lastSnapshotTime = svs.time;
+		client->rateDelayed      = qfalse;
+	}
+}
+
 /**
  * @brief SV_SendClientMessages
  */
@@ -1214,6 +1817,7 @@ void SV_SendClientMessages(void)
 	int      i;
 	client_t *c;
 	int      numclients = 0;    // net debugging
+	qboolean useJobs    = SV_SnapshotJobsEnabled();
 
 	sv.bpsTotalBytes  = 0;      // net debugging
 	sv.ubpsTotalBytes = 0;      // net debugging
@@ -1251,6 +1855,8 @@ void SV_SendClientMessages(void)
 			// If the client is downloading via netchan and has not acknowledged a package in 4secs drop it
 			if (c->download && (svs.time - c->downloadAckTime) > 4000)
 			{
+				// the clients before this one are served first, as if in order
+				SV_FlushSnapshotJobs();
 				SV_DropClient(c, "Download failed");
 			}
 			c->lastValidGamestate = svs.time;
@@ -1281,6 +1887,14 @@ void SV_SendClientMessages(void)
 
 		numclients++; // net debugging
 
+		// ettv clients read other clients' state while their snapshot is written
+		if (useJobs && !c->ettvClient)
+		{
+			SV_QueueSnapshotJob(c);
+			continue;
+		}
+		SV_FlushSnapshotJobs();
+
 		// generate and send a new message
 		SV_SendClientSnapshot(c);
 		c->lastSnapshotTime = svs.time;
@@ -1297,6 +1911,8 @@ void SV_SendClientMessages(void)
 		}
 	}
 
+	SV_FlushSnapshotJobs();
+
 	// net debugging
 	if (sv_showAverageBPS->integer && numclients > 0)
 	{
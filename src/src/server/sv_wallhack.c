@@ -40,6 +40,101 @@ static vec3_t delta[8];
 static int bbox_horz;
 static int bbox_vert;
 
+//======================================================================
+// visibility cache
+//======================================================================
+
+#define WH_CACHE_TIME     200     // ms a pair answer may be reused for
+#define WH_CACHE_DIST     4.0f    // units either player may move before the answer is dropped
+#define WH_CACHE_SPEED    20.0f   // change of velocity (units/s) that drops the answer
+#define WH_CACHE_ANGLE    5.0f    // change of view angle (deg) that drops the answer when fov is checked
+#define WH_MAX_LEAFS      64
+#define WH_MAX_CLUSTERS   16
+#define WH_MAX_MOVES      256     // recent mover changes kept to check cached answers against
+
+/**
+ * @struct wh_pair_t
+ * @brief Last answer of SV_CanSee() for one (player, other) pair and
+ * what it was computed from
+ */
+typedef struct
+{
+	int time;                       ///< sv.time of the answer, 0 if empty
+	int visible;
+	int corner;                     ///< corner found visible last, tried first next time
+	int traces;                     ///< traces the answer took
+	int check_fov;
+	int ducked;
+	float leanf;
+	float reach;                    ///< how far off the line between the players the answer depends on
+	vec3_t ppos, opos;
+	vec3_t pvel, ovel;
+	vec3_t angles;
+} wh_pair_t;
+
+/**
+ * @struct wh_client_t
+ * @brief Per frame data of one client, shared by all pairs it is part of
+ */
+typedef struct
+{
+	int time;                       ///< sv.time the data belongs to, 0 if never filled
+	int predicted;                  ///< pred_pos is set
+	int pred_traces;                ///< traces the prediction took
+	vec3_t pred_pos;
+	int num_eye;                    ///< clusters the viewpoint can be in this frame, -1 if unknown
+	int eye[WH_MAX_CLUSTERS];
+	int num_body;                   ///< clusters the checked corners can be in, -1 if unknown
+	int body[WH_MAX_CLUSTERS];
+} wh_client_t;
+
+/**
+ * @struct wh_mover_t
+ * @brief Last seen state of a brush model entity
+ */
+typedef struct
+{
+	int linked;                     ///< linked brush model, the rest is zero otherwise
+	int contents;
+	vec3_t absmin, absmax;
+} wh_mover_t;
+
+/**
+ * @struct wh_move_t
+ * @brief Space a mover left or entered in one frame
+ */
+typedef struct
+{
+	int time;
+	vec3_t mins, maxs;
+} wh_move_t;
+
+/**
+ * @struct wh_stats_t
+ * @brief Counters printed by whstats
+ */
+typedef struct
+{
+	int checks;                     ///< SV_CanSee() calls past the fov test
+	int cached;                     ///< answered from the pair cache
+	int culled;                     ///< answered by the cluster PVS
+	int moved;                      ///< cached answers dropped because a mover changed nearby
+	int traces;                     ///< traces actually run
+	int saved_cache;                ///< traces the cached answers took when computed
+	int saved_pvs;                  ///< corner traces skipped by the PVS test
+	int saved_predict;              ///< prediction traces shared between pairs
+} wh_stats_t;
+
+static wh_pair_t   wh_pairs[MAX_CLIENTS][MAX_CLIENTS];
+static wh_client_t wh_clients[MAX_CLIENTS];
+static wh_stats_t  wh_stats;
+static int         wh_server_id;
+
+static wh_mover_t wh_movers[MAX_GENTITIES];
+static wh_move_t  wh_moves[WH_MAX_MOVES];
+static int        wh_num_moves;                 ///< moves recorded so far, wh_moves is a ring
+static int        wh_movers_time;               ///< sv.time of the last update_movers(), 0 to start over
+
 //======================================================================
 // local functions
 //======================================================================
@@ -143,6 +238,7 @@ static int predict_slide_move(sharedEntity_t *ent, float frametime, trajectory_t
 
 		// see if we can make it there
 		SV_Trace(&trace, origin, ent->r.mins, ent->r.maxs, end, ent->s.number, CONTENTS_SOLID, qfalse);
+		wh_stats.traces++;
 
 		if (trace.allsolid)
 		{
@@ -315,6 +411,7 @@ static void predict_move(sharedEntity_t *ent, float frametime, trajectory_t *tr,
 	// test the player position if they were a stepheight higher
 	SV_Trace(&trace, start_o, ent->r.mins, ent->r.maxs, up, ent->s.number,
 	         CONTENTS_SOLID, qfalse);
+	wh_stats.traces++;
 
 	if (trace.allsolid)     // can't step up
 	{
@@ -334,6 +431,7 @@ static void predict_move(sharedEntity_t *ent, float frametime, trajectory_t *tr,
 	down[2] -= stepSize;
 	SV_Trace(&trace, tr->trBase, ent->r.mins, ent->r.maxs, down, ent->s.number,
 	         CONTENTS_SOLID, qfalse);
+	wh_stats.traces++;
 
 	if (!trace.allsolid)
 	{
@@ -352,10 +450,11 @@ static void predict_move(sharedEntity_t *ent, float frametime, trajectory_t *tr,
  * @param[in] org
  * @param[out] vp
  */
-static void calc_viewpoint(playerState_t *ps, vec3_t org, vec3_t vp)
+static void calc_viewpoint(playerState_t *ps, const vec3_t org, vec3_t vp)
 {
 	VectorCopy(org, vp);
 
+	// lean moves the eye, not the player model at 'org'
 	if (ps->leanf != 0.f)
 	{
 		vec3_t right, v3ViewAngles;
@@ -363,7 +462,7 @@ static void calc_viewpoint(playerState_t *ps, vec3_t org, vec3_t vp)
 		VectorCopy(ps->viewangles, v3ViewAngles);
 		v3ViewAngles[2] += ps->leanf / 2.0f;
 		angles_vectors(v3ViewAngles, NULL, right, NULL);
-		VectorMA(org, ps->leanf, right, org);
+		VectorMA(vp, ps->leanf, right, vp);
 	}
 
 	if (ps->pm_flags & PMF_DUCKED)
@@ -445,11 +544,12 @@ static void copy_trajectory(trajectory_t *src, trajectory_t *dst)
  * @param[in] end
  * @return
  */
-static int is_visible(vec3_t start, vec3_t end)
+static int is_visible(const vec3_t start, const vec3_t end)
 {
 	trace_t trace;
 
 	CM_BoxTrace(&trace, start, end, NULL, NULL, 0, CONTENTS_SOLID, 0);
+	wh_stats.traces++;
 
 	if (trace.contents & CONTENTS_SOLID)
 	{
@@ -494,6 +594,520 @@ static void init_vert_delta(void)
 	}
 }
 
+//======================================================================
+
+#define PREDICT_TIME      0.1f
+#define VOFS              6
+
+/**
+ * @brief Drops all cached answers and per frame data
+ */
+static void reset_cache(void)
+{
+	Com_Memset(wh_pairs, 0, sizeof(wh_pairs));
+	Com_Memset(wh_clients, 0, sizeof(wh_clients));
+	wh_num_moves   = 0;
+	wh_movers_time = 0;
+	wh_server_id   = sv.serverId;
+}
+
+//======================================================================
+
+/**
+ * @brief Records the space of every brush model entity that moved, turned,
+ * changed its contents or was (un)linked since the last frame
+ *
+ * @details Doors, lifts and other movers block the traces of the position
+ * prediction, so an answer computed before one of them changed near the
+ * pair must not be reused. Runs once per frame, before any pair is checked.
+ */
+static void update_movers(void)
+{
+	sharedEntity_t *ent;
+	wh_mover_t     cur, *old;
+	wh_move_t      *move;
+	int            i;
+
+	if (wh_movers_time == sv.time && wh_movers_time)
+	{
+		return;
+	}
+
+	for (i = 0; i < MAX_GENTITIES; i++)
+	{
+		old = &wh_movers[i];
+
+		Com_Memset(&cur, 0, sizeof(cur));
+		if (i < sv.num_entities)
+		{
+			ent = SV_GentityNum(i);
+
+			if (ent->r.bmodel && ent->r.linked && i != ENTITYNUM_WORLD)
+			{
+				cur.linked   = 1;
+				cur.contents = ent->r.contents;
+				VectorCopy(ent->r.absmin, cur.absmin);
+				VectorCopy(ent->r.absmax, cur.absmax);
+			}
+		}
+
+		if (!memcmp(&cur, old, sizeof(cur)))
+		{
+			continue;
+		}
+
+		// everything is new on the first frame, there are no answers yet
+		if (wh_movers_time)
+		{
+			move       = &wh_moves[wh_num_moves++ % WH_MAX_MOVES];
+			move->time = sv.time;
+
+			if (old->linked && cur.linked)
+			{
+				VectorCopy(old->absmin, move->mins);
+				VectorCopy(old->absmax, move->maxs);
+				AddPointToBounds(cur.absmin, move->mins, move->maxs);
+				AddPointToBounds(cur.absmax, move->mins, move->maxs);
+			}
+			else
+			{
+				VectorCopy(old->linked ? old->absmin : cur.absmin, move->mins);
+				VectorCopy(old->linked ? old->absmax : cur.absmax, move->maxs);
+			}
+		}
+
+		*old = cur;
+	}
+
+	wh_movers_time = sv.time ? sv.time : 1;
+}
+
+/**
+ * @brief Checks if the line from 'start' to 'end' comes within 'reach' of a box
+ * @param[in] start
+ * @param[in] end
+ * @param[in] reach
+ * @param[in] mins
+ * @param[in] maxs
+ * @return
+ */
+static int line_near_box(const vec3_t start, const vec3_t end, float reach, const vec3_t mins, const vec3_t maxs)
+{
+	float enter = 0.0f, leave = 1.0f, dir, lo, hi, t0, t1;
+	int   i;
+
+	for (i = 0; i < 3; i++)
+	{
+		dir = end[i] - start[i];
+		lo  = mins[i] - reach - start[i];
+		hi  = maxs[i] + reach - start[i];
+
+		if (dir == 0.0f)
+		{
+			if (lo > 0.0f || hi < 0.0f)
+			{
+				return 0;
+			}
+			continue;
+		}
+
+		t0 = lo / dir;
+		t1 = hi / dir;
+		if (t0 > t1)
+		{
+			float swap = t0;
+
+			t0 = t1;
+			t1 = swap;
+		}
+		enter = MAX(enter, t0);
+		leave = MIN(leave, t1);
+		if (enter > leave)
+		{
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * @brief How far off the line between two players the traces of SV_CanSee()
+ * may go: prediction moves and boxes, viewpoint, checked corners, plus what
+ * pair_valid() lets the players drift while the answer is reused
+ * @param[in] pent
+ * @param[in] oent
+ * @param[in] ps
+ * @return
+ */
+static float pair_reach(sharedEntity_t *pent, sharedEntity_t *oent, playerState_t *ps)
+{
+	float speed = MAX(vec3_length(pent->s.pos.trDelta), vec3_length(oent->s.pos.trDelta)) + WH_CACHE_SPEED;
+	float box   = MAX(RadiusFromBounds(pent->r.mins, pent->r.maxs), RadiusFromBounds(oent->r.mins, oent->r.maxs));
+
+	return speed * PREDICT_TIME + STEPSIZE + Z_ADJUST + box
+	       + DEFAULT_VIEWHEIGHT + Q_fabs(ps->leanf)
+	       + MAX(bbox_horz, bbox_vert) / 2 + VOFS + WH_CACHE_DIST;
+}
+
+/**
+ * @brief Checks if a mover changed near the players since a pair answer was computed
+ * @param[in] pair
+ * @return
+ */
+static int movers_changed(const wh_pair_t *pair)
+{
+	const wh_move_t *move;
+	int             n;
+
+	for (n = 1; n <= wh_num_moves; n++)
+	{
+		// older moves were overwritten, they may have been near
+		if (n > WH_MAX_MOVES)
+		{
+			return 1;
+		}
+
+		move = &wh_moves[(wh_num_moves - n) % WH_MAX_MOVES];
+		if (move->time <= pair->time)
+		{
+			return 0;
+		}
+
+		if (line_near_box(pair->ppos, pair->opos, pair->reach, move->mins, move->maxs))
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+//======================================================================
+
+/**
+ * @brief Collects the clusters of the leafs touching a box
+ * @param[in] mins
+ * @param[in] maxs
+ * @param[out] clusters
+ * @return Number of clusters or -1 if they can't be listed, so nothing may be culled
+ */
+static int box_clusters(const vec3_t mins, const vec3_t maxs, int *clusters)
+{
+	int leafs[WH_MAX_LEAFS];
+	int num_leafs, last_leaf, cluster, num = 0, i, j;
+
+	num_leafs = CM_BoxLeafnums(mins, maxs, leafs, WH_MAX_LEAFS, &last_leaf);
+
+	if (num_leafs >= WH_MAX_LEAFS)
+	{
+		return -1;
+	}
+
+	for (i = 0; i < num_leafs; i++)
+	{
+		cluster = CM_LeafCluster(leafs[i]);
+
+		if (cluster == -1)
+		{
+			continue;
+		}
+
+		for (j = 0; j < num; j++)
+		{
+			if (clusters[j] == cluster)
+			{
+				break;
+			}
+		}
+
+		if (j < num)
+		{
+			continue;
+		}
+
+		if (num == WH_MAX_CLUSTERS)
+		{
+			return -1;
+		}
+
+		clusters[num++] = cluster;
+	}
+
+	// only solid leafs, leave it to the traces
+	return num ? num : -1;
+}
+
+//======================================================================
+
+/**
+ * @brief Returns the data of client 'cli' for this frame, gathering the
+ * clusters its viewpoint and its checked corners can be in first if needed.
+ *
+ * @details The boxes cover everything the player can reach within PREDICT_TIME
+ * (stepping up included), both view heights and leaning to either side, so
+ * they hold for the predicted positions too.
+ *
+ * @param[in] cli
+ * @return
+ */
+static wh_client_t *client_frame(int cli)
+{
+	wh_client_t    *wc = &wh_clients[cli];
+	sharedEntity_t *ent;
+	playerState_t  *ps;
+	vec3_t         mins, maxs;
+	float          move, lean;
+	int            i;
+
+	if (wc->time == sv.time && wc->time)
+	{
+		return wc;
+	}
+
+	ent = SV_GentityNum(cli);
+	ps  = SV_GameClientNum(cli);
+
+	wc->time      = sv.time ? sv.time : 1;
+	wc->predicted = 0;
+
+	move = vec3_length(ent->s.pos.trDelta) * PREDICT_TIME + STEPSIZE + Z_ADJUST + 1.0f;
+	lean = Q_fabs(ps->leanf);
+
+	for (i = 0; i < 3; i++)
+	{
+		mins[i] = ent->s.pos.trBase[i] - move - lean;
+		maxs[i] = ent->s.pos.trBase[i] + move + lean;
+	}
+	mins[2] += CROUCH_VIEWHEIGHT;
+	maxs[2] += DEFAULT_VIEWHEIGHT;
+
+	wc->num_eye = box_clusters(mins, maxs, wc->eye);
+
+	for (i = 0; i < 3; i++)
+	{
+		mins[i] = ent->s.pos.trBase[i] - Q_fabs(delta[0][i]) - move;
+		maxs[i] = ent->s.pos.trBase[i] + Q_fabs(delta[0][i]) + move;
+	}
+	mins[2] += VOFS;
+	maxs[2] += VOFS;
+
+	wc->num_body = box_clusters(mins, maxs, wc->body);
+
+	return wc;
+}
+
+//======================================================================
+
+/**
+ * @brief Cluster PVS test between the viewpoint area of one client and
+ * the corners of another. PVS is symmetric, so the answer holds both ways.
+ *
+ * @param[in] pc
+ * @param[in] oc
+ * @return Zero if no line of sight is possible this frame or the next
+ */
+static int clusters_see(wh_client_t *pc, wh_client_t *oc)
+{
+	byte *pvs;
+	int  i, j;
+
+	if (pc->num_eye < 0 || oc->num_body < 0)
+	{
+		return 1;
+	}
+
+	for (i = 0; i < pc->num_eye; i++)
+	{
+		pvs = CM_ClusterPVS(pc->eye[i]);
+
+		for (j = 0; j < oc->num_body; j++)
+		{
+			if (pvs[oc->body[j] >> 3] & (1 << (oc->body[j] & 7)))
+			{
+				return 1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+//======================================================================
+
+/**
+ * @brief Predicted position of a client, computed once per frame when 'wc'
+ * is given and shared by all pairs
+ *
+ * @param[in] ent
+ * @param[in,out] wc May be NULL
+ * @param[out] result
+ */
+static void client_predict(sharedEntity_t *ent, wh_client_t *wc, vec3_t result)
+{
+	int traces;
+
+	if (!wc)
+	{
+		copy_trajectory(&ent->s.pos, &traject);
+		predict_move(ent, PREDICT_TIME, &traject, result);
+		return;
+	}
+
+	if (wc->predicted)
+	{
+		wh_stats.saved_predict += wc->pred_traces;
+	}
+	else
+	{
+		traces = wh_stats.traces;
+		copy_trajectory(&ent->s.pos, &traject);
+		predict_move(ent, PREDICT_TIME, &traject, wc->pred_pos);
+		wc->pred_traces = wh_stats.traces - traces;
+		wc->predicted   = 1;
+	}
+
+	VectorCopy(wc->pred_pos, result);
+}
+
+//======================================================================
+
+/**
+ * @brief Traces from 'viewpoint' to the corners of the box around 'org',
+ * starting with '*corner'
+ *
+ * @param[in] viewpoint
+ * @param[in] org
+ * @param[in,out] corner The first corner tried, set to the visible one
+ * @return
+ */
+static int trace_corners(const vec3_t viewpoint, const vec3_t org, int *corner)
+{
+	vec3_t tmp;
+	int    i, n;
+
+	for (n = 0; n < 8; n++)
+	{
+		i = (*corner + n) & 7;
+
+		VectorCopy(org, tmp);
+		tmp[0] += delta[i][0];
+		tmp[1] += delta[i][1];
+		tmp[2] += delta[i][2] + VOFS;
+
+		if (is_visible(viewpoint, tmp))
+		{
+			*corner = i;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+//======================================================================
+
+/**
+ * @brief The traced part of SV_CanSee()
+ *
+ * @param[in] player
+ * @param[in] other
+ * @param[in] pc Frame data of 'player', NULL to not share it
+ * @param[in] oc Frame data of 'other', NULL to not share it
+ * @param[in,out] corner
+ * @return
+ */
+static int trace_pair(int player, int other, wh_client_t *pc, wh_client_t *oc, int *corner)
+{
+	sharedEntity_t *pent, *oent;
+	playerState_t  *ps;
+	vec3_t         viewpoint;
+
+	ps   = SV_GameClientNum(player);
+	pent = SV_GentityNum(player);
+	oent = SV_GentityNum(other);
+
+	// check if visible in this frame
+	calc_viewpoint(ps, pent->s.pos.trBase, viewpoint);
+
+	if (trace_corners(viewpoint, oent->s.pos.trBase, corner))
+	{
+		return 1;
+	}
+
+	// predict player positions
+	client_predict(pent, pc, pred_ppos);
+	client_predict(oent, oc, pred_opos);
+
+	// Check again if 'other' is in the maximum fov allowed.
+	// FIXME: We use the original viewangle that may have
+	// changed during the move. This could introduce some
+	// errors.
+	if (sv_wh_check_fov->integer > 0)
+	{
+		if (!player_in_fov(pent->s.apos.trBase, pred_ppos, pred_opos))
+		{
+			return 0;
+		}
+	}
+
+	// check if expected to be visible in the next frame
+	calc_viewpoint(ps, pred_ppos, viewpoint);
+
+	return trace_corners(viewpoint, pred_opos, corner);
+}
+
+//======================================================================
+
+/**
+ * @brief Checks if a cached answer still holds, i.e. it is recent,
+ * neither player moved, changed speed, stance or view enough to matter,
+ * and no mover near them changed.
+ *
+ * @param[in] pair
+ * @param[in] ps
+ * @param[in] pent
+ * @param[in] oent
+ * @return
+ */
+static int pair_valid(wh_pair_t *pair, playerState_t *ps, sharedEntity_t *pent, sharedEntity_t *oent)
+{
+	if (!pair->time || sv.time < pair->time || sv.time - pair->time > WH_CACHE_TIME)
+	{
+		return 0;
+	}
+
+	if (pair->check_fov != (sv_wh_check_fov->integer > 0)
+	    || pair->ducked != (ps->pm_flags & PMF_DUCKED)
+	    || pair->leanf != ps->leanf)
+	{
+		return 0;
+	}
+
+	if (vec3_distance(pair->ppos, pent->s.pos.trBase) > WH_CACHE_DIST
+	    || vec3_distance(pair->opos, oent->s.pos.trBase) > WH_CACHE_DIST
+	    || vec3_distance(pair->pvel, pent->s.pos.trDelta) > WH_CACHE_SPEED
+	    || vec3_distance(pair->ovel, oent->s.pos.trDelta) > WH_CACHE_SPEED)
+	{
+		return 0;
+	}
+
+	if (pair->check_fov
+	    && (Q_fabs(angle_delta(pair->angles[YAW], pent->s.apos.trBase[YAW])) > WH_CACHE_ANGLE
+	        || Q_fabs(angle_delta(pair->angles[PITCH], pent->s.apos.trBase[PITCH])) > WH_CACHE_ANGLE))
+	{
+		return 0;
+	}
+
+	if (movers_changed(pair))
+	{
+		wh_stats.moved++;
+		return 0;
+	}
+
+	return 1;
+}
+
 //======================================================================
 // public functions
 //======================================================================
@@ -505,12 +1119,29 @@ void SV_InitWallhack(void)
 {
 	init_horz_delta();
 	init_vert_delta();
+	reset_cache();
+	Com_Memset(&wh_stats, 0, sizeof(wh_stats));
 }
 
 //======================================================================
 
-#define PREDICT_TIME      0.1f
-#define VOFS              6
+/**
+ * @brief Prints how much work the visibility cache saved and resets the counters
+ */
+void SV_WallhackStats_f(void)
+{
+	int total = wh_stats.traces + wh_stats.saved_cache + wh_stats.saved_pvs + wh_stats.saved_predict;
+
+	Com_Printf("wallhack: %i checks, %i cached, %i out of PVS, %i cached answers dropped for movers\n",
+	           wh_stats.checks, wh_stats.cached, wh_stats.culled, wh_stats.moved);
+	Com_Printf("%i traces run, %i saved (%i by the cache, %i by PVS, %i by shared predictions), %.1f%% saved\n",
+	           wh_stats.traces, total - wh_stats.traces, wh_stats.saved_cache, wh_stats.saved_pvs, wh_stats.saved_predict,
+	           total ? (double)(100.f * (total - wh_stats.traces) / total) : 0.0);
+
+	Com_Memset(&wh_stats, 0, sizeof(wh_stats));
+}
+
+//======================================================================
 
 /**
  * @brief Checks if 'player' can see 'other' or not.
@@ -528,6 +1159,10 @@ void SV_InitWallhack(void)
  * (expected to become visible) or zero (not expected to become visible
  * in the next frame).
  *
+ * The traced answer is kept per pair and reused for later snapshots as long
+ * as pair_valid() holds. Pairs without a cluster PVS connection are rejected
+ * without tracing, and predictions are made once per client and frame.
+ *
  * @param[in] player
  * @param[in] other
  *
@@ -537,20 +1172,29 @@ int SV_CanSee(int player, int other)
 {
 	sharedEntity_t *pent, *oent;
 	playerState_t  *ps;
-	vec3_t         viewpoint, tmp;
-	int            i;
+	wh_pair_t      *pair;
+	int            corner = 0, traces, visible;
 
 	// check if bounding box has been changed
 	if (sv_wh_bbox_horz->integer != bbox_horz)
 	{
 		init_horz_delta();
+		reset_cache();
 	}
 
 	if (sv_wh_bbox_vert->integer != bbox_vert)
 	{
 		init_vert_delta();
+		reset_cache();
+	}
+
+	if (sv.serverId != wh_server_id)
+	{
+		reset_cache();
 	}
 
+	update_movers();
+
 	ps   = SV_GameClientNum(player);
 	pent = SV_GentityNum(player);
 	oent = SV_GentityNum(other);
@@ -564,58 +1208,47 @@ int SV_CanSee(int player, int other)
 		}
 	}
 
-	// check if visible in this frame
-	calc_viewpoint(ps, pent->s.pos.trBase, viewpoint);
+	wh_stats.checks++;
 
-	for (i = 0; i < 8; i++)
+	// a moved away player isn't where its cached data says
+	if (origin_changed[player] || origin_changed[other])
 	{
-		VectorCopy(oent->s.pos.trBase, tmp);
-		tmp[0] += delta[i][0];
-		tmp[1] += delta[i][1];
-		tmp[2] += delta[i][2] + VOFS;
-
-		if (is_visible(viewpoint, tmp))
-		{
-			return 1;
-		}
+		return trace_pair(player, other, NULL, NULL, &corner);
 	}
 
-	// predict player positions
-	copy_trajectory(&pent->s.pos, &traject);
-	predict_move(pent, PREDICT_TIME, &traject, pred_ppos);
-
-	copy_trajectory(&oent->s.pos, &traject);
-	predict_move(oent, PREDICT_TIME, &traject, pred_opos);
+	pair = &wh_pairs[player][other];
 
-	// Check again if 'other' is in the maximum fov allowed.
-	// FIXME: We use the original viewangle that may have
-	// changed during the move. This could introduce some
-	// errors.
-	if (sv_wh_check_fov->integer > 0)
+	if (pair_valid(pair, ps, pent, oent))
 	{
-		if (!player_in_fov(pent->s.apos.trBase, pred_ppos, pred_opos))
-		{
-			return 0;
-		}
+		wh_stats.cached++;
+		wh_stats.saved_cache += pair->traces;
+		return pair->visible;
 	}
 
-	// check if expected to be visible in the next frame
-	calc_viewpoint(ps, pred_ppos, viewpoint);
-
-	for (i = 0; i < 8; i++)
+	if (!clusters_see(client_frame(player), client_frame(other)))
 	{
-		VectorCopy(pred_opos, tmp);
-		tmp[0] += delta[i][0];
-		tmp[1] += delta[i][1];
-		tmp[2] += delta[i][2] + VOFS;
-
-		if (is_visible(viewpoint, tmp))
-		{
-			return 1;
-		}
+		wh_stats.culled++;
+		wh_stats.saved_pvs += 16;
+		return 0;
 	}
 
-	return 0;
+	traces  = wh_stats.traces;
+	visible = trace_pair(player, other, &wh_clients[player], &wh_clients[other], &pair->corner);
+
+	pair->time      = sv.time ? sv.time : 1;
+	pair->visible   = visible;
+	pair->traces    = wh_stats.traces - traces;
+	pair->check_fov = sv_wh_check_fov->integer > 0;
+	pair->ducked    = ps->pm_flags & PMF_DUCKED;
+	pair->leanf     = ps->leanf;
+	pair->reach     = pair_reach(pent, oent, ps);
+	VectorCopy(pent->s.pos.trBase, pair->ppos);
+	VectorCopy(oent->s.pos.trBase, pair->opos);
+	VectorCopy(pent->s.pos.trDelta, pair->pvel);
+	VectorCopy(oent->s.pos.trDelta, pair->ovel);
+	VectorCopy(pent->s.apos.trBase, pair->angles);
+
+	return visible;
 }
 
 //======================================================================
@@ -36,15 +36,12 @@
 #include "server.h"
 
 /**
- * @brief Return a headnode that can be used for testing or clipping to a
- * given entity.
- *
+ * @brief SV_ClipHandleForEntity() with the temp box of a trace context
+ * @param[in,out] ctx NULL for the main thread
  * @param[in] ent
- *
- * @return If the entity is a bsp model, the headnode will
- * be returned, otherwise a custom box tree will be constructed.
+ * @return
  */
-clipHandle_t SV_ClipHandleForEntity(const sharedEntity_t *ent)
+static clipHandle_t SV_ContextClipHandleForEntity(cmTraceContext_t *ctx, const sharedEntity_t *ent)
 {
 	if (ent->r.bmodel)
 	{
@@ -54,11 +51,25 @@ clipHandle_t SV_ClipHandleForEntity(const sharedEntity_t *ent)
 	if (ent->r.svFlags & SVF_CAPSULE)
 	{
 		// create a temp capsule from bounding box sizes
-		return CM_TempBoxModel(ent->r.mins, ent->r.maxs, qtrue);
+		return CM_ContextTempBoxModel(ctx, ent->r.mins, ent->r.maxs, qtrue);
 	}
 
 	// create a temp tree from bounding box sizes
-	return CM_TempBoxModel(ent->r.mins, ent->r.maxs, qfalse);
+	return CM_ContextTempBoxModel(ctx, ent->r.mins, ent->r.maxs, qfalse);
+}
+
+/**
+ * @brief Return a headnode that can be used for testing or clipping to a
+ * given entity.
+ *
+ * @param[in] ent
+ *
+ * @return If the entity is a bsp model, the headnode will
+ * be returned, otherwise a custom box tree will be constructed.
+ */
+clipHandle_t SV_ClipHandleForEntity(const sharedEntity_t *ent)
+{
+	return SV_ContextClipHandleForEntity(NULL, ent);
 }
 
 /*
@@ -66,93 +77,446 @@ clipHandle_t SV_ClipHandleForEntity(const sharedEntity_t *ent)
 ENTITY CHECKING
 
 To avoid linearly searching through lists of entities during environment testing,
-the world is carved up with an evenly spaced, axially aligned bsp tree.  Entities
-are kept in chains either at the final leafs, or at the first node that splits
-them, which prevents having to deal with multiple fragments of a single entity.
+linked entities are kept in a dynamic bounding volume tree. Each leaf holds one
+entity with its box grown by WORLD_BOX_MARGIN, so an entity that moves a little
+stays in its leaf and only leaving the leaf box takes it out of the tree and
+inserts it again. Inserts pick the sibling with the smallest surface area cost
+and rotations on the way up keep the tree balanced.
 ===============================================================================
 */
 
-typedef struct worldSector_s
-{
-	int axis;                         // -1 = leaf node
-	float dist;
-	struct     worldSector_s *children[2];
-	svEntity_t *entities;
-} worldSector_t;
+#ifdef ETL_SSE
+#include <immintrin.h>
+#endif
 
-#define AREA_DEPTH  4
-#define AREA_NODES  64
+#define WORLD_NULL_NODE     0                   ///< never allocated, unlinked entities point here
+#define WORLD_MAX_NODES     (MAX_GENTITIES * 2) ///< MAX_GENTITIES leaves and their parents
+#define WORLD_BOX_MARGIN    8.f                 ///< leaf boxes are this much bigger than the entity
+#define WORLD_STACK_SIZE    128                 ///< the tree is balanced, a few dozen levels at most
 
-worldSector_t sv_worldSectors[AREA_NODES];
-int           sv_numworldSectors;
+/**
+ * @struct worldNode_t
+ * @brief
+ */
+typedef struct
+{
+	vec4_t mins;                                ///< w is always 0 for the SSE box tests
+	vec4_t maxs;
+	int parent;                                 ///< next free node while on the free list
+	int children[2];                            ///< WORLD_NULL_NODE for leaves
+	int height;                                 ///< 0 for leaves
+	int entityNum;                              ///< leaves only
+} worldNode_t;
 
 /**
- * @brief SV_SectorList_f
+ * @struct worldStats_t
+ * @brief Query cost counters, reset by SV_SectorList_f()
  */
-void SV_SectorList_f(void)
+typedef struct
 {
-	int           i, c;
-	worldSector_t *sec;
-	svEntity_t    *ent;
+	int queries;
+	int nodeTests;                              ///< node boxes tested
+	int candidates;                             ///< leaves that passed the box test
+	int entityClips;                            ///< exact clips against entity models
+} worldStats_t;
 
-	for (i = 0 ; i < AREA_NODES ; i++)
-	{
-		sec = &sv_worldSectors[i];
+/**
+ * @struct worldTree_t
+ * @brief
+ */
+typedef struct
+{
+	worldNode_t nodes[WORLD_MAX_NODES];
+	int root;
+	int freeList;
+	int numLeafs;
 
-		c = 0;
-		for (ent = sec->entities ; ent ; ent = ent->nextEntityInWorldSector)
-		{
-			c++;
-		}
+	int inserts;                                ///< leaves (re)inserted since the last sectorlist
+	int moves;                                  ///< relinks that stayed inside their leaf box
+	worldStats_t areaStats;                     ///< SV_AreaEntities()
+	worldStats_t traceStats;                    ///< SV_ClipMoveToEntities() on the main thread
+} worldTree_t;
 
-		Com_Printf("sector %i: %i entities\n", i, c);
-	}
+static worldTree_t sv_world;
+
+#ifdef ETL_SSE
+/**
+ * @brief SV_WorldBoxesOverlap
+ * @param[in] mins1 4 floats
+ * @param[in] maxs1 4 floats
+ * @param[in] mins2 4 floats
+ * @param[in] maxs2 4 floats
+ * @return
+ */
+static ID_INLINE qboolean SV_WorldBoxesOverlap(const float *mins1, const float *maxs1, const float *mins2, const float *maxs2)
+{
+	__m128 out = _mm_or_ps(_mm_cmpgt_ps(_mm_loadu_ps(mins1), _mm_loadu_ps(maxs2)),
+	                       _mm_cmplt_ps(_mm_loadu_ps(maxs1), _mm_loadu_ps(mins2)));
+
+	return (_mm_movemask_ps(out) & 7) == 0;
+}
+#else
+/**
+ * @brief SV_WorldBoxesOverlap
+ * @param[in] mins1
+ * @param[in] maxs1
+ * @param[in] mins2
+ * @param[in] maxs2
+ * @return
+ */
+static ID_INLINE qboolean SV_WorldBoxesOverlap(const float *mins1, const float *maxs1, const float *mins2, const float *maxs2)
+{
+	return !(mins1[0] > maxs2[0] || mins1[1] > maxs2[1] || mins1[2] > maxs2[2]
+	         || maxs1[0] < mins2[0] || maxs1[1] < mins2[1] || maxs1[2] < mins2[2]);
 }
+#endif
 
 /**
- * @brief Builds a uniformly subdivided tree for the given world size
- * @param[in] depth
+ * @brief Half the surface area of a box, the insert cost metric
  * @param[in] mins
  * @param[in] maxs
  * @return
  */
-worldSector_t *SV_CreateworldSector(int depth, vec3_t mins, vec3_t maxs)
+static float SV_WorldArea(const float *mins, const float *maxs)
+{
+	float dx = maxs[0] - mins[0];
+	float dy = maxs[1] - mins[1];
+	float dz = maxs[2] - mins[2];
+
+	return dx * dy + dy * dz + dz * dx;
+}
+
+/**
+ * @brief Fit a node around its children
+ * @param[in,out] node
+ */
+static void SV_WorldFitNode(worldNode_t *node)
+{
+	const worldNode_t *a = &sv_world.nodes[node->children[0]];
+	const worldNode_t *b = &sv_world.nodes[node->children[1]];
+	int               i;
+
+	for (i = 0; i < 3; i++)
+	{
+		node->mins[i] = MIN(a->mins[i], b->mins[i]);
+		node->maxs[i] = MAX(a->maxs[i], b->maxs[i]);
+	}
+	node->height = 1 + MAX(a->height, b->height);
+}
+
+/**
+ * @brief SV_WorldAllocNode
+ * @return
+ */
+static int SV_WorldAllocNode(void)
+{
+	int         index = sv_world.freeList;
+	worldNode_t *node;
+
+	if (index == WORLD_NULL_NODE)
+	{
+		Com_Error(ERR_DROP, "SV_WorldAllocNode: out of nodes");
+	}
+
+	node              = &sv_world.nodes[index];
+	sv_world.freeList = node->parent;
+
+	Com_Memset(node, 0, sizeof(*node));
+	node->entityNum = -1;
+
+	return index;
+}
+
+/**
+ * @brief SV_WorldFreeNode
+ * @param[in] index
+ */
+static void SV_WorldFreeNode(int index)
+{
+	sv_world.nodes[index].parent = sv_world.freeList;
+	sv_world.nodes[index].height = -1;
+	sv_world.freeList            = index;
+}
+
+/**
+ * @brief Put a node where another one was in its parent
+ * @param[in] parent
+ * @param[in] oldChild
+ * @param[in] newChild
+ */
+static void SV_WorldReplaceChild(int parent, int oldChild, int newChild)
+{
+	worldNode_t *node;
+
+	sv_world.nodes[newChild].parent = parent;
+
+	if (parent == WORLD_NULL_NODE)
+	{
+		sv_world.root = newChild;
+		return;
+	}
+
+	node = &sv_world.nodes[parent];
+	if (node->children[0] == oldChild)
+	{
+		node->children[0] = newChild;
+	}
+	else
+	{
+		node->children[1] = newChild;
+	}
+}
+
+/**
+ * @brief Rotate the taller grandchild of node up if the children differ in height by more than one
+ * @param[in] index
+ * @return The node now in the place of index
+ */
+static int SV_WorldBalance(int index)
 {
-	worldSector_t *anode = &sv_worldSectors[sv_numworldSectors];
-	vec3_t        size;
-	vec3_t        mins1, maxs1, mins2, maxs2;
+	worldNode_t *node = &sv_world.nodes[index];
+	worldNode_t *up, *other;
+	int         upSide, iUp, iOther, iKeep, iMove;
+	int         balance;
 
-	sv_numworldSectors++;
+	if (node->height < 2)
+	{
+		return index;
+	}
 
-	if (depth == AREA_DEPTH)
+	balance = sv_world.nodes[node->children[1]].height - sv_world.nodes[node->children[0]].height;
+	if (balance >= -1 && balance <= 1)
 	{
-		anode->axis        = -1;
-		anode->children[0] = anode->children[1] = NULL;
-		return anode;
+		return index;
 	}
 
-	VectorSubtract(maxs, mins, size);
-	if (size[0] > size[1])
+	// the taller child takes the place of node, node keeps its other child
+	// and the shorter of the taller child's children
+	upSide = balance > 0 ? 1 : 0;
+	iUp    = node->children[upSide];
+	up     = &sv_world.nodes[iUp];
+
+	SV_WorldReplaceChild(node->parent, index, iUp);
+
+	if (sv_world.nodes[up->children[0]].height > sv_world.nodes[up->children[1]].height)
 	{
-		anode->axis = 0;
+		iKeep = up->children[0];
+		iMove = up->children[1];
 	}
 	else
 	{
-		anode->axis = 1;
+		iKeep = up->children[1];
+		iMove = up->children[0];
+	}
+
+	iOther                       = index;
+	other                        = node;
+	other->children[upSide]      = iMove;
+	sv_world.nodes[iMove].parent = iOther;
+	SV_WorldFitNode(other);
+
+	up->children[0] = iOther;
+	up->children[1] = iKeep;
+	other->parent   = iUp;
+	SV_WorldFitNode(up);
+
+	return iUp;
+}
+
+/**
+ * @brief Balance and refit from a node up to the root
+ * @param[in] index
+ */
+static void SV_WorldRefit(int index)
+{
+	while (index != WORLD_NULL_NODE)
+	{
+		index = SV_WorldBalance(index);
+		SV_WorldFitNode(&sv_world.nodes[index]);
+		index = sv_world.nodes[index].parent;
+	}
+}
+
+/**
+ * @brief Area added by putting leaf below a node
+ * @param[in] leaf
+ * @param[in] index
+ * @return
+ */
+static float SV_WorldInsertCost(const worldNode_t *leaf, int index)
+{
+	const worldNode_t *node = &sv_world.nodes[index];
+	vec3_t            mins, maxs;
+	int               i;
+
+	for (i = 0; i < 3; i++)
+	{
+		mins[i] = MIN(leaf->mins[i], node->mins[i]);
+		maxs[i] = MAX(leaf->maxs[i], node->maxs[i]);
+	}
+
+	if (!node->height)
+	{
+		return SV_WorldArea(mins, maxs);
+	}
+	return SV_WorldArea(mins, maxs) - SV_WorldArea(node->mins, node->maxs);
+}
+
+/**
+ * @brief SV_WorldInsertLeaf
+ * @param[in] leaf
+ */
+static void SV_WorldInsertLeaf(int leaf)
+{
+	worldNode_t *leafNode = &sv_world.nodes[leaf];
+	worldNode_t *node;
+	int         index, parent, sibling;
+	float       area, combined, cost, inherit, cost0, cost1;
+	vec3_t      mins, maxs;
+	int         i;
+
+	sv_world.inserts++;
+
+	if (sv_world.root == WORLD_NULL_NODE)
+	{
+		sv_world.root    = leaf;
+		leafNode->parent = WORLD_NULL_NODE;
+		return;
+	}
+
+	// walk down to the sibling that makes the tree grow least
+	index = sv_world.root;
+	while (sv_world.nodes[index].height > 0)
+	{
+		node = &sv_world.nodes[index];
+
+		for (i = 0; i < 3; i++)
+		{
+			mins[i] = MIN(leafNode->mins[i], node->mins[i]);
+			maxs[i] = MAX(leafNode->maxs[i], node->maxs[i]);
+		}
+		area     = SV_WorldArea(node->mins, node->maxs);
+		combined = SV_WorldArea(mins, maxs);
+
+		// cost of a new parent for this node and the leaf, and the
+		// minimum cost of pushing the leaf further down
+		cost    = 2 * combined;
+		inherit = 2 * (combined - area);
+		cost0   = SV_WorldInsertCost(leafNode, node->children[0]) + inherit;
+		cost1   = SV_WorldInsertCost(leafNode, node->children[1]) + inherit;
+
+		if (cost < cost0 && cost < cost1)
+		{
+			break;
+		}
+
+		index = cost0 < cost1 ? node->children[0] : node->children[1];
+	}
+	sibling = index;
+
+	// a new parent for the sibling and the leaf
+	parent = SV_WorldAllocNode();
+	SV_WorldReplaceChild(sv_world.nodes[sibling].parent, sibling, parent);
+
+	node              = &sv_world.nodes[parent];
+	node->children[0] = sibling;
+	node->children[1] = leaf;
+
+	sv_world.nodes[sibling].parent = parent;
+	leafNode->parent               = parent;
+
+	SV_WorldRefit(parent);
+}
+
+/**
+ * @brief SV_WorldRemoveLeaf
+ * @param[in] leaf
+ */
+static void SV_WorldRemoveLeaf(int leaf)
+{
+	int parent, grandParent, sibling;
+
+	if (leaf == sv_world.root)
+	{
+		sv_world.root = WORLD_NULL_NODE;
+		return;
+	}
+
+	parent      = sv_world.nodes[leaf].parent;
+	grandParent = sv_world.nodes[parent].parent;
+	sibling     = sv_world.nodes[parent].children[0] == leaf ? sv_world.nodes[parent].children[1] : sv_world.nodes[parent].children[0];
+
+	// the sibling takes the place of the parent
+	SV_WorldReplaceChild(grandParent, parent, sibling);
+	SV_WorldFreeNode(parent);
+
+	SV_WorldRefit(grandParent);
+}
+
+/**
+ * @brief Leaf depth statistics of a subtree
+ * @param[in] index
+ * @param[in] depth
+ * @param[in,out] depthSum
+ * @param[in,out] innerArea
+ */
+static void SV_WorldTreeStats_r(int index, int depth, int *depthSum, float *innerArea)
+{
+	const worldNode_t *node = &sv_world.nodes[index];
+
+	if (!node->height)
+	{
+		*depthSum += depth;
+		return;
 	}
 
-	anode->dist = 0.5f * (maxs[anode->axis] + mins[anode->axis]);
-	VectorCopy(mins, mins1);
-	VectorCopy(mins, mins2);
-	VectorCopy(maxs, maxs1);
-	VectorCopy(maxs, maxs2);
+	*innerArea += SV_WorldArea(node->mins, node->maxs);
+	SV_WorldTreeStats_r(node->children[0], depth + 1, depthSum, innerArea);
+	SV_WorldTreeStats_r(node->children[1], depth + 1, depthSum, innerArea);
+}
+
+/**
+ * @brief SV_WorldPrintStats
+ * @param[in] name
+ * @param[in] stats
+ */
+static void SV_WorldPrintStats(const char *name, const worldStats_t *stats)
+{
+	float queries = stats->queries ? (float)stats->queries : 1.f;
+
+	Com_Printf("%-12s %8i queries  %6.1f node tests  %6.1f candidates  %6.1f clips per query\n", name, stats->queries,
+	           (double)(stats->nodeTests / queries), (double)(stats->candidates / queries), (double)(stats->entityClips / queries));
+}
+
+/**
+ * @brief Prints the shape of the world tree and the query cost since the last call
+ */
+void SV_SectorList_f(void)
+{
+	int   depthSum  = 0;
+	float innerArea = 0;
+	float rootArea;
+
+	if (sv_world.root == WORLD_NULL_NODE)
+	{
+		Com_Printf("world tree: empty\n");
+		return;
+	}
 
-	maxs1[anode->axis] = mins2[anode->axis] = anode->dist;
+	SV_WorldTreeStats_r(sv_world.root, 0, &depthSum, &innerArea);
+	rootArea = SV_WorldArea(sv_world.nodes[sv_world.root].mins, sv_world.nodes[sv_world.root].maxs);
 
-	anode->children[0] = SV_CreateworldSector(depth + 1, mins2, maxs2);
-	anode->children[1] = SV_CreateworldSector(depth + 1, mins1, maxs1);
+	Com_Printf("world tree: %i entities, %i nodes, height %i, %.1f average leaf depth, %.1f area cost\n",
+	           sv_world.numLeafs, sv_world.numLeafs * 2 - 1, sv_world.nodes[sv_world.root].height,
+	           (double)((float)depthSum / sv_world.numLeafs), rootArea > 0 ? (double)(innerArea / rootArea) : 0.0);
+	Com_Printf("%i inserts, %i moves inside the leaf box\n", sv_world.inserts, sv_world.moves);
+	SV_WorldPrintStats("areaentities", &sv_world.areaStats);
+	SV_WorldPrintStats("traces", &sv_world.traceStats);
 
-	return anode;
+	sv_world.inserts = 0;
+	sv_world.moves   = 0;
+	Com_Memset(&sv_world.areaStats, 0, sizeof(sv_world.areaStats));
+	Com_Memset(&sv_world.traceStats, 0, sizeof(sv_world.traceStats));
 }
 
 /**
@@ -160,16 +524,20 @@ worldSector_t *SV_CreateworldSector(int depth, vec3_t mins, vec3_t maxs)
  */
 void SV_ClearWorld(void)
 {
-	clipHandle_t h;
-	vec3_t       mins, maxs;
+	int i;
+
+	Com_Memset(&sv_world, 0, sizeof(sv_world));
 
-	Com_Memset(sv_worldSectors, 0, sizeof(sv_worldSectors));
-	sv_numworldSectors = 0;
+	// node 0 is the null node
+	for (i = WORLD_MAX_NODES - 1; i > WORLD_NULL_NODE; i--)
+	{
+		SV_WorldFreeNode(i);
+	}
 
-	// get world map bounds
-	h = CM_InlineModel(0);
-	CM_ModelBounds(h, mins, maxs);
-	SV_CreateworldSector(0, mins, maxs);
+	for (i = 0; i < MAX_GENTITIES; i++)
+	{
+		sv.svEntities[i].worldNode = WORLD_NULL_NODE;
+	}
 }
 
 /**
@@ -178,37 +546,72 @@ void SV_ClearWorld(void)
  */
 void SV_UnlinkEntity(sharedEntity_t *gEnt)
 {
-	svEntity_t    *ent;
-	svEntity_t    *scan;
-	worldSector_t *ws;
+	svEntity_t *ent;
 
 	ent = SV_SvEntityForGentity(gEnt);
 
 	gEnt->r.linked = qfalse;
 
-	ws = ent->worldSector;
-	if (!ws)
+	if (ent->worldNode == WORLD_NULL_NODE)
 	{
 		return;     // not linked in anywhere
 	}
-	ent->worldSector = NULL;
 
-	if (ws->entities == ent)
-	{
-		ws->entities = ent->nextEntityInWorldSector;
-		return;
-	}
+	SV_WorldRemoveLeaf(ent->worldNode);
+	SV_WorldFreeNode(ent->worldNode);
+	ent->worldNode = WORLD_NULL_NODE;
+	sv_world.numLeafs--;
+}
+
+/**
+ * @brief Put an entity in the tree or move it to its new bounds
+ * @param[in,out] ent
+ * @param[in] gEnt
+ */
+static void SV_WorldLinkEntity(svEntity_t *ent, const sharedEntity_t *gEnt)
+{
+	worldNode_t *leaf;
+	int         i;
 
-	for (scan = ws->entities ; scan ; scan = scan->nextEntityInWorldSector)
+	if (ent->worldNode != WORLD_NULL_NODE)
 	{
-		if (scan->nextEntityInWorldSector == ent)
+		leaf = &sv_world.nodes[ent->worldNode];
+
+		// stay in the leaf while the entity fits and the leaf box isn't much too big
+		for (i = 0; i < 3; i++)
+		{
+			if (gEnt->r.absmin[i] < leaf->mins[i] || gEnt->r.absmax[i] > leaf->maxs[i]
+			    || gEnt->r.absmin[i] - leaf->mins[i] > 4 * WORLD_BOX_MARGIN
+			    || leaf->maxs[i] - gEnt->r.absmax[i] > 4 * WORLD_BOX_MARGIN)
+			{
+				break;
+			}
+		}
+		if (i == 3)
 		{
-			scan->nextEntityInWorldSector = ent->nextEntityInWorldSector;
+			sv_world.moves++;
 			return;
 		}
+
+		SV_WorldRemoveLeaf(ent->worldNode);
+	}
+	else
+	{
+		ent->worldNode = SV_WorldAllocNode();
+		sv_world.numLeafs++;
 	}
 
-	Com_Printf("WARNING: SV_UnlinkEntity: not found in worldSector\n");
+	leaf            = &sv_world.nodes[ent->worldNode];
+	leaf->entityNum = ent - sv.svEntities;
+	leaf->height    = 0;
+	for (i = 0; i < 3; i++)
+	{
+		leaf->mins[i] = gEnt->r.absmin[i] - WORLD_BOX_MARGIN;
+		leaf->maxs[i] = gEnt->r.absmax[i] + WORLD_BOX_MARGIN;
+	}
+	leaf->mins[3] = leaf->maxs[3] = 0;
+
+	SV_WorldInsertLeaf(ent->worldNode);
 }
 
 #define MAX_TOTAL_ENT_LEAFS     128
@@ -219,15 +622,14 @@ void SV_UnlinkEntity(sharedEntity_t *gEnt)
  */
 void SV_LinkEntity(sharedEntity_t *gEnt)
 {
-	worldSector_t *node;
-	int           leafs[MAX_TOTAL_ENT_LEAFS];
-	int           cluster;
-	int           num_leafs;
-	int           i, j, k;
-	int           area;
-	int           lastLeaf;
-	float         *origin, *angles;
-	svEntity_t    *ent;
+	int        leafs[MAX_TOTAL_ENT_LEAFS];
+	int        cluster;
+	int        num_leafs;
+	int        i, j, k;
+	int        area;
+	int        lastLeaf;
+	float      *origin, *angles;
+	svEntity_t *ent;
 
 	ent = SV_SvEntityForGentity(gEnt);
 
@@ -247,11 +649,6 @@ void SV_LinkEntity(sharedEntity_t *gEnt)
 		Com_DPrintf("WARNING: BBOX entity %i (type: %i) is being linked at world origin, this is probably a bug - see /entitylist cmd\n", gEnt->s.number, gEnt->s.eType);
 	}
 
-	if (ent->worldSector)
-	{
-		SV_UnlinkEntity(gEnt);      // unlink from old position
-	}
-
 	// encode the size into the entityState_t for client prediction
 	if (gEnt->r.bmodel)
 	{
@@ -349,6 +746,10 @@ void SV_LinkEntity(sharedEntity_t *gEnt)
 	// entity is outside the world and can be considered unlinked
 	if (!num_leafs)
 	{
+		if (ent->worldNode != WORLD_NULL_NODE)
+		{
+			SV_UnlinkEntity(gEnt);      // unlink from old position
+		}
 		return;
 	}
 
@@ -401,32 +802,8 @@ void SV_LinkEntity(sharedEntity_t *gEnt)
 
 	gEnt->r.linkcount++;
 
-	// find the first world sector node that the ent's box crosses
-	node = sv_worldSectors;
-	while (1)
-	{
-		if (node->axis == -1)
-		{
-			break;
-		}
-		if (gEnt->r.absmin[node->axis] > node->dist)
-		{
-			node = node->children[0];
-		}
-		else if (gEnt->r.absmax[node->axis] < node->dist)
-		{
-			node = node->children[1];
-		}
-		else
-		{
-			break;      // crosses the node
-		}
-	}
-
-	// link it in
-	ent->worldSector             = node;
-	ent->nextEntityInWorldSector = node->entities;
-	node->entities               = ent;
+	// move it in the world tree
+	SV_WorldLinkEntity(ent, gEnt);
 
 	gEnt->r.linked = qtrue;
 }
@@ -440,92 +817,81 @@ bounds.  This does NOT mean that they actually touch in the case of bmodels.
 ============================================================================
 */
 
-typedef struct
-{
-	const float *mins;
-	const float *maxs;
-	int *list;
-	int count, maxcount;
-} areaParms_t;
-
 /**
- * @brief SV_AreaEntities_r
- * @param[in] node
- * @param[in,out] ap
+ * @brief SV_AreaEntities
+ * @param[in] mins
+ * @param[in] maxs
+ * @param[in] entityList
+ * @param[in] maxcount
+ * @return
  */
-void SV_AreaEntities_r(worldSector_t *node, areaParms_t *ap)
+int SV_AreaEntities(const vec3_t mins, const vec3_t maxs, int *entityList, int maxcount)
 {
-	svEntity_t     *check, *next;
-	sharedEntity_t *gcheck;
+	int               stack[WORLD_STACK_SIZE];
+	int               sp = 0, count = 0;
+	vec4_t            boxMins, boxMaxs;
+	const worldNode_t *node;
+	sharedEntity_t    *gcheck;
+	worldStats_t      *stats = &sv_world.areaStats;
+
+	stats->queries++;
+
+	if (sv_world.root == WORLD_NULL_NODE)
+	{
+		return 0;
+	}
+
+	VectorCopy(mins, boxMins);
+	VectorCopy(maxs, boxMaxs);
+	boxMins[3] = boxMaxs[3] = 0;
 
-	for (check = node->entities  ; check ; check = next)
+	stack[sp++] = sv_world.root;
+	while (sp)
 	{
-		next = check->nextEntityInWorldSector;
+		node = &sv_world.nodes[stack[--sp]];
+
+		stats->nodeTests++;
+		if (!SV_WorldBoxesOverlap(node->mins, node->maxs, boxMins, boxMaxs))
+		{
+			continue;
+		}
+
+		if (node->height)
+		{
+			stack[sp++] = node->children[1];
+			stack[sp++] = node->children[0];
+			continue;
+		}
 
-		gcheck = SV_GEntityForSvEntity(check);
+		// the leaf box is grown, check the entity itself
+		gcheck = SV_GentityNum(node->entityNum);
 
 		if (!gcheck->r.linked)
 		{
 			continue;
 		}
 
-		if (gcheck->r.absmin[0] > ap->maxs[0]
-		    || gcheck->r.absmin[1] > ap->maxs[1]
-		    || gcheck->r.absmin[2] > ap->maxs[2]
-		    || gcheck->r.absmax[0] < ap->mins[0]
-		    || gcheck->r.absmax[1] < ap->mins[1]
-		    || gcheck->r.absmax[2] < ap->mins[2])
+		if (gcheck->r.absmin[0] > maxs[0]
+		    || gcheck->r.absmin[1] > maxs[1]
+		    || gcheck->r.absmin[2] > maxs[2]
+		    || gcheck->r.absmax[0] < mins[0]
+		    || gcheck->r.absmax[1] < mins[1]
+		    || gcheck->r.absmax[2] < mins[2])
 		{
 			continue;
 		}
 
-		if (ap->count == ap->maxcount)
+		if (count == maxcount)
 		{
 			Com_Printf("SV_AreaEntities: MAXCOUNT\n");
-			return;
+			break;
 		}
 
-		ap->list[ap->count] = check - sv.svEntities;
-		ap->count++;
+		stats->candidates++;
+		entityList[count++] = node->entityNum;
 	}
 
-	if (node->axis == -1)
-	{
-		return;     // terminal node
-	}
-
-	// recurse down both sides
-	if (ap->maxs[node->axis] > node->dist)
-	{
-		SV_AreaEntities_r(node->children[0], ap);
-	}
-	if (ap->mins[node->axis] < node->dist)
-	{
-		SV_AreaEntities_r(node->children[1], ap);
-	}
-}
-
-/**
- * @brief SV_AreaEntities
- * @param[in] mins
- * @param[in] maxs
- * @param[in] entityList
- * @param[in] maxcount
- * @return
- */
-int SV_AreaEntities(const vec3_t mins, const vec3_t maxs, int *entityList, int maxcount)
-{
-	areaParms_t ap;
-
-	ap.mins     = mins;
-	ap.maxs     = maxs;
-	ap.list     = entityList;
-	ap.count    = 0;
-	ap.maxcount = maxcount;
-
-	SV_AreaEntities_r(sv_worldSectors, &ap);
-
-	return ap.count;
+	return count;
 }
 
 //===========================================================================
@@ -541,6 +907,13 @@ typedef struct
 	int passEntityNum;
 	int contentmask;
 	qboolean capsule;
+	cmTraceContext_t *ctx;              // NULL for the main thread
+
+	// the slabs of a node box grown by the moving box and one unit are
+	// crossed at (nodeMins - sweepLow) * invDir and (nodeMaxs - sweepHigh) * invDir
+	vec4_t sweepLow;
+	vec4_t sweepHigh;
+	vec4_t invDir;
 } moveclip_t;
 
 /**
@@ -596,21 +969,188 @@ void SV_ClipToEntity(trace_t *trace, const vec3_t start, const vec3_t mins, cons
 // FIXME: Copied from cm_local.h
 #define BOX_MODEL_HANDLE        511
 
+#ifdef ETL_SSE
+/**
+ * @brief Fraction of the move where it enters a node box
+ * @param[in] clip
+ * @param[in] node
+ * @return Above 1 if the move misses the box
+ */
+static ID_INLINE float SV_WorldSweepEnter(const moveclip_t *clip, const worldNode_t *node)
+{
+	__m128 inv   = _mm_loadu_ps(clip->invDir);
+	__m128 t1    = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node->mins), _mm_loadu_ps(clip->sweepLow)), inv);
+	__m128 t2    = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node->maxs), _mm_loadu_ps(clip->sweepHigh)), inv);
+	__m128 tNear = _mm_min_ps(t1, t2);
+	__m128 tFar  = _mm_max_ps(t1, t2);
+	float  enter, leave;
+
+	// replace w by x so only the three axes count
+	tNear = _mm_shuffle_ps(tNear, tNear, _MM_SHUFFLE(0, 2, 1, 0));
+	tFar  = _mm_shuffle_ps(tFar, tFar, _MM_SHUFFLE(0, 2, 1, 0));
+
+	tNear = _mm_max_ps(tNear, _mm_shuffle_ps(tNear, tNear, _MM_SHUFFLE(2, 3, 0, 1)));
+	tNear = _mm_max_ps(tNear, _mm_shuffle_ps(tNear, tNear, _MM_SHUFFLE(1, 0, 3, 2)));
+	tFar  = _mm_min_ps(tFar, _mm_shuffle_ps(tFar, tFar, _MM_SHUFFLE(2, 3, 0, 1)));
+	tFar  = _mm_min_ps(tFar, _mm_shuffle_ps(tFar, tFar, _MM_SHUFFLE(1, 0, 3, 2)));
+
+	enter = _mm_cvtss_f32(tNear);
+	leave = _mm_cvtss_f32(tFar);
+
+	return (enter > leave || leave < 0) ? 2.f : enter;
+}
+#else
+/**
+ * @brief Fraction of the move where it enters a node box
+ * @param[in] clip
+ * @param[in] node
+ * @return Above 1 if the move misses the box
+ */
+static ID_INLINE float SV_WorldSweepEnter(const moveclip_t *clip, const worldNode_t *node)
+{
+	float enter = -2.f, leave = 2.f;
+	float t1, t2;
+	int   i;
+
+	for (i = 0; i < 3; i++)
+	{
+		t1 = (node->mins[i] - clip->sweepLow[i]) * clip->invDir[i];
+		t2 = (node->maxs[i] - clip->sweepHigh[i]) * clip->invDir[i];
+		if (t1 > t2)
+		{
+			float t = t1;
+
+			t1 = t2;
+			t2 = t;
+		}
+		enter = MAX(enter, t1);
+		leave = MIN(leave, t2);
+	}
+
+	return (enter > leave || leave < 0) ? 2.f : enter;
+}
+#endif
+
 /**
- * @brief SV_ClipMoveToEntities
+ * @brief Clip the move against one entity
  * @param[in,out] clip
+ * @param[in] entityNum
+ * @param[in] passOwnerNum
+ * @param[in,out] stats NULL if not counted
  */
-void SV_ClipMoveToEntities(moveclip_t *clip)
+static void SV_ClipMoveToEntity(moveclip_t *clip, int entityNum, int passOwnerNum, worldStats_t *stats)
 {
-	int            i, num;
-	int            touchlist[MAX_GENTITIES];
 	sharedEntity_t *touch;
-	int            passOwnerNum;
 	trace_t        trace;
 	clipHandle_t   clipHandle;
 	float          *origin, *angles;
 
-	num = SV_AreaEntities(clip->boxmins, clip->boxmaxs, touchlist, MAX_GENTITIES);
+	touch = SV_GentityNum(entityNum);
+
+	// see if we should ignore this entity
+	if (clip->passEntityNum != ENTITYNUM_NONE)
+	{
+		if (entityNum == clip->passEntityNum)
+		{
+			return;     // don't clip against the pass entity
+		}
+		if (touch->r.ownerNum == clip->passEntityNum)
+		{
+			return;     // don't clip against own missiles
+		}
+		if (touch->r.ownerNum == passOwnerNum)
+		{
+			return;     // don't clip against other missiles from our owner
+		}
+	}
+
+	// if it doesn't have any brushes of a type we
+	// are looking for, ignore it
+	if (!(clip->contentmask & touch->r.contents))
+	{
+		return;
+	}
+
+	// might intersect, so do an exact clip
+	clipHandle = SV_ContextClipHandleForEntity(clip->ctx, touch);
+
+	// non-worldspawn entities must not use world as clip model!
+	if (clipHandle == 0)
+	{
+		return;
+	}
+
+	if (stats)
+	{
+		stats->entityClips++;
+	}
+
+	// If clipping against BBOX, set to correct contents
+	if (clipHandle == BOX_MODEL_HANDLE)
+	{
+		CM_ContextSetTempBoxModelContents(clip->ctx, touch->r.contents);
+	}
+
+	origin = touch->r.currentOrigin;
+	angles = touch->r.currentAngles;
+
+
+	if (!touch->r.bmodel)
+	{
+		angles = vec3_origin;   // boxes don't rotate
+	}
+
+	CM_ContextTransformedBoxTrace(clip->ctx, &trace, clip->start, clip->end,
+	                              clip->mins, clip->maxs, clipHandle, clip->contentmask,
+	                              origin, angles, clip->capsule);
+
+	if (trace.allsolid)
+	{
+		clip->trace.allsolid = qtrue;
+		trace.entityNum      = touch->s.number;
+	}
+	else if (trace.startsolid)
+	{
+		clip->trace.startsolid = qtrue;
+		trace.entityNum        = touch->s.number;
+	}
+
+	if (trace.fraction < clip->trace.fraction)
+	{
+		// make sure we keep a startsolid from a previous trace
+		qboolean oldStart = clip->trace.startsolid;
+
+		trace.entityNum         = touch->s.number;
+		clip->trace             = trace;
+		clip->trace.startsolid |= oldStart;
+	}
+
+	// Reset contents to default
+	if (clipHandle == BOX_MODEL_HANDLE)
+	{
+		CM_ContextSetTempBoxModelContents(clip->ctx, CONTENTS_BODY);
+	}
+}
+
+/**
+ * @brief Walk the world tree along the move, nearer boxes first
+ *
+ * Boxes entered after the fraction the move got clipped to so far are skipped,
+ * nothing in there can clip it any shorter (brushes and boxes stay within
+ * SURFACE_CLIP_EPSILON of their bounds, the node boxes are grown by a unit).
+ *
+ * @param[in,out] clip
+ */
+void SV_ClipMoveToEntities(moveclip_t *clip)
+{
+	int               stack[WORLD_STACK_SIZE];
+	float             stackEnter[WORLD_STACK_SIZE];
+	int               sp = 0;
+	int               i, passOwnerNum;
+	float             enter, enter0, enter1;
+	const worldNode_t *node;
+	sharedEntity_t    *gcheck;
+	worldStats_t      *stats = clip->ctx ? NULL : &sv_world.traceStats;
 
 	if (clip->passEntityNum != ENTITYNUM_NONE)
 	{
@@ -625,91 +1165,111 @@ void SV_ClipMoveToEntities(moveclip_t *clip)
 		passOwnerNum = -1;
 	}
 
-	for (i = 0 ; i < num ; i++)
+	if (stats)
 	{
-		if (clip->trace.allsolid)
-		{
-			return;
-		}
-		touch = SV_GentityNum(touchlist[i]);
+		stats->queries++;
+	}
 
-		// see if we should ignore this entity
-		if (clip->passEntityNum != ENTITYNUM_NONE)
-		{
-			if (touchlist[i] == clip->passEntityNum)
-			{
-				continue;   // don't clip against the pass entity
-			}
-			if (touch->r.ownerNum == clip->passEntityNum)
-			{
-				continue;   // don't clip against own missiles
-			}
-			if (touch->r.ownerNum == passOwnerNum)
-			{
-				continue;   // don't clip against other missiles from our owner
-			}
-		}
+	if (sv_world.root == WORLD_NULL_NODE)
+	{
+		return;
+	}
 
-		// if it doesn't have any brushes of a type we
-		// are looking for, ignore it
-		if (!(clip->contentmask & touch->r.contents))
-		{
-			continue;
-		}
+	for (i = 0; i < 3; i++)
+	{
+		float dir = clip->end[i] - clip->start[i];
 
-		// might intersect, so do an exact clip
-		clipHandle = SV_ClipHandleForEntity(touch);
+		clip->sweepLow[i]  = clip->start[i] - clip->mins[i] + 1;
+		clip->sweepHigh[i] = clip->start[i] - clip->maxs[i] - 1;
+		clip->invDir[i]    = dir != 0.f ? 1.f / dir : 1e30f;
+	}
+	clip->sweepLow[3] = clip->sweepHigh[3] = clip->invDir[3] = 0;
 
-		// non-worldspawn entities must not use world as clip model!
-		if (clipHandle == 0)
-		{
-			continue;
-		}
+	node  = &sv_world.nodes[sv_world.root];
+	enter = SV_WorldSweepEnter(clip, node);
+	if (stats)
+	{
+		stats->nodeTests++;
+	}
+	if (enter > 1.f)
+	{
+		return;
+	}
 
-		// If clipping against BBOX, set to correct contents
-		if (clipHandle == BOX_MODEL_HANDLE)
+	stack[sp]        = sv_world.root;
+	stackEnter[sp++] = enter;
+
+	while (sp)
+	{
+		if (clip->trace.allsolid)
 		{
-			CM_SetTempBoxModelContents(touch->r.contents);
+			return;
 		}
 
-		origin = touch->r.currentOrigin;
-		angles = touch->r.currentAngles;
-
-
-		if (!touch->r.bmodel)
+		sp--;
+		if (stackEnter[sp] > clip->trace.fraction)
 		{
-			angles = vec3_origin;   // boxes don't rotate
+			continue;
 		}
+		node = &sv_world.nodes[stack[sp]];
 
-		CM_TransformedBoxTrace(&trace, clip->start, clip->end,
-		                       clip->mins, clip->maxs, clipHandle, clip->contentmask,
-		                       origin, angles, clip->capsule);
-
-		if (trace.allsolid)
+		if (!node->height)
 		{
-			clip->trace.allsolid = qtrue;
-			trace.entityNum      = touch->s.number;
+			// same candidates as a box query over the whole move
+			gcheck = SV_GentityNum(node->entityNum);
+
+			if (!gcheck->r.linked
+			    || gcheck->r.absmin[0] > clip->boxmaxs[0]
+			    || gcheck->r.absmin[1] > clip->boxmaxs[1]
+			    || gcheck->r.absmin[2] > clip->boxmaxs[2]
+			    || gcheck->r.absmax[0] < clip->boxmins[0]
+			    || gcheck->r.absmax[1] < clip->boxmins[1]
+			    || gcheck->r.absmax[2] < clip->boxmins[2])
+			{
+				continue;
+			}
+
+			if (stats)
+			{
+				stats->candidates++;
+			}
+			SV_ClipMoveToEntity(clip, node->entityNum, passOwnerNum, stats);
+			continue;
 		}
-		else if (trace.startsolid)
+
+		enter0 = SV_WorldSweepEnter(clip, &sv_world.nodes[node->children[0]]);
+		enter1 = SV_WorldSweepEnter(clip, &sv_world.nodes[node->children[1]]);
+		if (stats)
 		{
-			clip->trace.startsolid = qtrue;
-			trace.entityNum        = touch->s.number;
+			stats->nodeTests += 2;
 		}
 
-		if (trace.fraction < clip->trace.fraction)
+		// push the farther child first so the nearer one is popped first
+		if (enter0 > enter1)
 		{
-			// make sure we keep a startsolid from a previous trace
-			qboolean oldStart = clip->trace.startsolid;
-
-			trace.entityNum         = touch->s.number;
-			clip->trace             = trace;
-			clip->trace.startsolid |= oldStart;
+			if (enter0 <= clip->trace.fraction)
+			{
+				stack[sp]        = node->children[0];
+				stackEnter[sp++] = enter0;
+			}
+			if (enter1 <= clip->trace.fraction)
+			{
+				stack[sp]        = node->children[1];
+				stackEnter[sp++] = enter1;
+			}
 		}
-
-		// Reset contents to default
-		if (clipHandle == BOX_MODEL_HANDLE)
+		else
 		{
-			CM_SetTempBoxModelContents(CONTENTS_BODY);
+			if (enter1 <= clip->trace.fraction)
+			{
+				stack[sp]        = node->children[1];
+				stackEnter[sp++] = enter1;
+			}
+			if (enter0 <= clip->trace.fraction)
+			{
+				stack[sp]        = node->children[0];
+				stackEnter[sp++] = enter0;
+			}
 		}
 	}
 }
@@ -718,6 +1278,10 @@ void SV_ClipMoveToEntities(moveclip_t *clip)
  * @brief Moves the given mins/maxs volume through the world from start to end.
  * passEntityNum and entities owned by passEntityNum are explicitly not checked.
  *
+ * Several threads can trace at once, each with its own context, as long as
+ * no entity is linked or unlinked meanwhile.
+ *
+ * @param[in,out] ctx NULL for the main thread
  * @param[out] results
  * @param[in] start
  * @param[in] mins
@@ -727,7 +1291,7 @@ void SV_ClipMoveToEntities(moveclip_t *clip)
  * @param[in] contentmask
  * @param[in] capsule
  */
-void SV_Trace(trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, qboolean capsule)
+void SV_ContextTrace(cmTraceContext_t *ctx, trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, qboolean capsule)
 {
 	moveclip_t clip;
 	int        i;
@@ -744,7 +1308,7 @@ void SV_Trace(trace_t *results, const vec3_t start, const vec3_t mins, const vec
 	Com_Memset(&clip, 0, sizeof(moveclip_t));
 
 	// clip to world
-	CM_BoxTrace(&clip.trace, start, end, mins, maxs, 0, contentmask, capsule);
+	CM_ContextBoxTrace(ctx, &clip.trace, start, end, mins, maxs, 0, contentmask, capsule);
 	clip.trace.entityNum = clip.trace.fraction != 1.0f ? ENTITYNUM_WORLD : ENTITYNUM_NONE;
 	if (clip.trace.fraction == 0.f || passEntityNum == -2)
 	{
@@ -760,6 +1324,7 @@ void SV_Trace(trace_t *results, const vec3_t start, const vec3_t mins, const vec
 	clip.maxs          = maxs;
 	clip.passEntityNum = passEntityNum;
 	clip.capsule       = capsule;
+	clip.ctx           = ctx;
 
 	// create the bounding box of the entire move
 	// we can limit it to the part of the move not
@@ -785,6 +1350,22 @@ void SV_Trace(trace_t *results, const vec3_t start, const vec3_t mins, const vec
 	*results = clip.trace;
 }
 
+/**
+ * @brief SV_Trace
+ * @param[out] results
+ * @param[in] start
+ * @param[in] mins
+ * @param[in] maxs
+ * @param[in] end
+ * @param[in] passEntityNum
+ * @param[in] contentmask
+ * @param[in] capsule
+ */
+void SV_Trace(trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, qboolean capsule)
+{
+	SV_ContextTrace(NULL, results, start, mins, maxs, end, passEntityNum, contentmask, capsule);
+}
+
 /**
  * @brief SV_PointContents
  * @param[in] p
@@ -830,3 +1411,192 @@ int SV_PointContents(const vec3_t p, int passEntityNum)
 
 	return contents;
 }
+
+/*
+============================================================================
+TRACE TEST
+
+Runs the same random traces through the world and its entities on the main
+thread and on the worker pool, each worker with its own trace context, and
+reports any difference.
+============================================================================
+*/
+
+#define TRACETEST_JOBS  64
+
+typedef struct
+{
+	vec3_t start, end;
+	vec3_t mins, maxs;
+	int contentmask;
+	qboolean capsule;
+	trace_t serial;                     // main thread result
+	trace_t threaded;                   // worker result
+} traceTestCase_t;
+
+static traceTestCase_t  *sv_traceTestCases;
+static int              sv_traceTestCount;
+static cmTraceContext_t *sv_traceTestContexts[TRACETEST_JOBS];
+
+/**
+ * @brief Trace every TRACETEST_JOBS'th case through the context of the job
+ * @param[in] index
+ */
+static void SV_TraceTestJob(int index)
+{
+	traceTestCase_t *tc;
+	int             i;
+
+	for (i = index; i < sv_traceTestCount; i += TRACETEST_JOBS)
+	{
+		tc = &sv_traceTestCases[i];
+		SV_ContextTrace(sv_traceTestContexts[index], &tc->threaded, tc->start, tc->mins, tc->maxs, tc->end,
+		                ENTITYNUM_NONE, tc->contentmask, tc->capsule);
+	}
+}
+
+/**
+ * @brief SV_TracesEqual
+ * @param[in] a
+ * @param[in] b
+ * @return
+ */
+static qboolean SV_TracesEqual(const trace_t *a, const trace_t *b)
+{
+	return a->allsolid == b->allsolid && a->startsolid == b->startsolid
+	       && a->fraction == b->fraction && VectorCompare(a->endpos, b->endpos)
+	       && VectorCompare(a->plane.normal, b->plane.normal) && a->plane.dist == b->plane.dist
+	       && a->surfaceFlags == b->surfaceFlags && a->contents == b->contents
+	       && a->entityNum == b->entityNum;
+}
+
+/**
+ * @brief Compare threaded traces against serial ones on the loaded map
+ *
+ * Usage: tracetest [count] [threads]
+ * The threads are only used when sv_snapshotThreads didn't start a pool.
+ */
+void SV_TraceTest_f(void)
+{
+	static const vec3_t playerMins = { -18, -18, -24 };
+	static const vec3_t playerMaxs = { 18, 18, 48 };
+	vec3_t              worldMins, worldMaxs;
+	traceTestCase_t     *tc;
+	int                 count, threads, i, j, mismatches = 0;
+	int                 serialTime, threadedTime;
+	qboolean            ownPool = qfalse;
+
+	if (!com_sv_running->integer || sv.state != SS_GAME)
+	{
+		Com_Printf("Server is not running.\n");
+		return;
+	}
+
+	count   = Cmd_Argc() > 1 ? Q_atoi(Cmd_Argv(1)) : 100000;
+	threads = Cmd_Argc() > 2 ? Q_atoi(Cmd_Argv(2)) : 4;
+	if (count <= 0)
+	{
+		Com_Printf("Usage: tracetest [count] [threads]\n");
+		return;
+	}
+
+	sv_traceTestCases = Com_Allocate(count * sizeof(*sv_traceTestCases));
+	if (!sv_traceTestCases)
+	{
+		Com_Printf("tracetest: out of memory\n");
+		return;
+	}
+	sv_traceTestCount = count;
+
+	// points, player boxes and odd boxes all over the map, some of them position tests
+	CM_ModelBounds(CM_InlineModel(0), worldMins, worldMaxs);
+	for (i = 0; i < count; i++)
+	{
+		tc = &sv_traceTestCases[i];
+
+		for (j = 0; j < 3; j++)
+		{
+			tc->start[j] = worldMins[j] + random() * (worldMaxs[j] - worldMins[j]);
+			tc->end[j]   = (i & 7) ? worldMins[j] + random() * (worldMaxs[j] - worldMins[j]) : tc->start[j];
+		}
+
+		switch (i % 3)
+		{
+		case 0:
+			VectorClear(tc->mins);
+			VectorClear(tc->maxs);
+			break;
+		case 1:
+			VectorCopy(playerMins, tc->mins);
+			VectorCopy(playerMaxs, tc->maxs);
+			break;
+		default:
+			for (j = 0; j < 3; j++)
+			{
+				tc->mins[j] = -random() * 32;
+				tc->maxs[j] = random() * 32;
+			}
+			break;
+		}
+
+		tc->contentmask = (i & 1) ? MASK_SHOT : MASK_PLAYERSOLID;
+		tc->capsule     = (i % 5) == 0;
+	}
+
+	serialTime = Sys_Milliseconds();
+	for (i = 0; i < count; i++)
+	{
+		tc = &sv_traceTestCases[i];
+		SV_Trace(&tc->serial, tc->start, tc->mins, tc->maxs, tc->end, ENTITYNUM_NONE, tc->contentmask, tc->capsule);
+	}
+	serialTime = Sys_Milliseconds() - serialTime;
+
+	if (!SV_NumJobThreads() && threads > 0)
+	{
+		SV_InitJobs(threads);
+		ownPool = qtrue;
+	}
+	for (i = 0; i < TRACETEST_JOBS; i++)
+	{
+		sv_traceTestContexts[i] = CM_CreateTraceContext();
+	}
+
+	threadedTime = Sys_Milliseconds();
+	SV_RunJobs(SV_TraceTestJob, TRACETEST_JOBS);
+	threadedTime = Sys_Milliseconds() - threadedTime;
+
+	for (i = 0; i < TRACETEST_JOBS; i++)
+	{
+		CM_FreeTraceContext(sv_traceTestContexts[i]);
+		sv_traceTestContexts[i] = NULL;
+	}
+	threads = SV_NumJobThreads();
+	if (ownPool)
+	{
+		// let sv_snapshotThreads bring back its own pool
+		SV_ShutdownJobs();
+		sv_snapshotThreads->modified = qtrue;
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		tc = &sv_traceTestCases[i];
+		if (SV_TracesEqual(&tc->serial, &tc->threaded))
+		{
+			continue;
+		}
+
+		if (++mismatches <= 10)
+		{
+			Com_Printf("trace %i: serial %f ent %i, threaded %f ent %i\n", i,
+			           (double)tc->serial.fraction, tc->serial.entityNum, (double)tc->threaded.fraction, tc->threaded.entityNum);
+		}
+	}
+
+	Com_Printf("%i traces: serial %i msec, %i threads %i msec, %i mismatches\n",
+	           count, serialTime, threads + 1, threadedTime, mismatches);
+
+	Com_Dealloc(sv_traceTestCases);
+	sv_traceTestCases = NULL;
+	sv_traceTestCount = 0;
+}